@@ -0,0 +1,169 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/*
+ * Activity benchmark: 256K IPv4 neighbours, each the next hop of one
+ * /24 route. A quarter of the routes see traffic through
+ * oes_api_router_uc_route_lookup, then the neighbour activity is
+ * collected once with GET_ACTIVITY per neighbour and once with a
+ * single harvest, and the route activity with a harvest.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_api_router.h"
+
+#define BENCH_NEIGHS      (256 * 1024)
+#define BENCH_ACTIVE_EVERY 4            /* one route in four sees traffic */
+
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* neighbour i is 172.16.0.0 + i, next hop of route 10.0.0.0/24 + i */
+static void
+bench_neigh(unsigned int i, struct oes_ip_addr *ip_p)
+{
+    memset(ip_p, 0, sizeof(*ip_p));
+    ip_p->version = OES_IPV4;
+    ip_p->addr.ipv4.s_addr = htonl(0xac100000 + i);
+}
+
+static void
+bench_route(unsigned int i, struct oes_ip_prefix *key_p)
+{
+    memset(key_p, 0, sizeof(*key_p));
+    key_p->prefix.version = OES_IPV4;
+    key_p->prefix.addr.ipv4.s_addr = htonl(0x0a000000 + (i << 8));
+    key_p->prefix_len = 24;
+}
+
+/* traffic to the active routes, returns the lookup rate */
+static double
+bench_traffic(unsigned int vrid)
+{
+    struct oes_uc_route_lookup_data lookup;
+    struct oes_ip_addr              dst;
+    unsigned int                    i;
+    double                          start;
+
+    memset(&dst, 0, sizeof(dst));
+    dst.version = OES_IPV4;
+    start = bench_now();
+    for (i = 0; i < BENCH_NEIGHS; i += BENCH_ACTIVE_EVERY) {
+        dst.addr.ipv4.s_addr = htonl(0x0a000000 + (i << 8) + 1);
+        oes_api_router_uc_route_lookup(vrid, &dst, i, &lookup);
+    }
+    return BENCH_NEIGHS / BENCH_ACTIVE_EVERY / (bench_now() - start);
+}
+
+int
+main(void)
+{
+    struct oes_router_attributes attr = { 1, 1, OES_ROUTER_ACTION_TRAP, OES_ROUTER_ACTION_TRAP };
+    static struct oes_ip_addr    neigh_keys[BENCH_NEIGHS];
+    static struct oes_ip_prefix  route_keys[BENCH_NEIGHS];
+    struct ether_addr            mac = { { 0x00, 0x02, 0xc9, 0x00, 0x00, 0x01 } };
+    struct oes_uc_route_data     route;
+    struct oes_neigh_data        data;
+    struct oes_ip_prefix         key;
+    struct oes_ip_addr           ip;
+    unsigned short               one;
+    unsigned int                 vrid, i, cnt, active = 0;
+    double                       start, elapsed, rate;
+
+    oes_api_router_set(OES_ACCESS_CMD_ADD, &vrid, &attr, NULL);
+    memset(&data, 0, sizeof(data));
+    data.mac_addr = &mac;
+    data.action = OES_ROUTER_ACTION_FORWARD;
+    memset(&route, 0, sizeof(route));
+    route.action = OES_ROUTER_ACTION_FORWARD;
+    route.next_hop_list = &ip;
+    route.next_hop_cnt = 1;
+    for (i = 0; i < BENCH_NEIGHS; i++) {
+        bench_neigh(i, &ip);
+        data.rif = i % 256;
+        bench_route(i, &key);
+        if ((oes_api_router_neigh_set(OES_ACCESS_CMD_ADD, vrid, &ip, &data, NULL) != OES_STATUS_SUCCESS) ||
+            (oes_api_router_uc_route_set(OES_ACCESS_CMD_ADD, vrid, &key, &route, NULL) != OES_STATUS_SUCCESS)) {
+            printf("add of neighbour/route %u failed\n", i);
+            return 1;
+        }
+    }
+
+    rate = bench_traffic(vrid);
+    printf("lookup   %u routes hit at %.2f M lookups/s\n", BENCH_NEIGHS / BENCH_ACTIVE_EVERY, rate / 1e6);
+
+    data.mac_addr = NULL;
+    start = bench_now();
+    for (i = 0; i < BENCH_NEIGHS; i++) {
+        bench_neigh(i, &ip);
+        one = 1;
+        oes_api_router_neigh_get(OES_ACCESS_CMD_GET_ACTIVITY, vrid, &ip, &data, &one, NULL);
+        active += data.activity;
+    }
+    elapsed = bench_now() - start;
+    printf("per-call %u GET_ACTIVITY calls in %.3f ms, %u active\n", BENCH_NEIGHS, elapsed * 1e3, active);
+
+    bench_traffic(vrid);
+    start = bench_now();
+    cnt = BENCH_NEIGHS;
+    oes_api_router_neigh_activity_harvest(vrid, 1, neigh_keys, &cnt, NULL);
+    elapsed = bench_now() - start;
+    printf("harvest  %u neighbours in %.3f ms, %u active\n", BENCH_NEIGHS, elapsed * 1e3, cnt);
+
+    start = bench_now();
+    cnt = BENCH_NEIGHS;
+    oes_api_router_neigh_activity_harvest(vrid, 0, neigh_keys, &cnt, NULL);
+    elapsed = bench_now() - start;
+    printf("harvest  %u neighbours in %.3f ms, %u inactive\n", BENCH_NEIGHS, elapsed * 1e3, cnt);
+
+    start = bench_now();
+    cnt = BENCH_NEIGHS;
+    oes_api_router_uc_route_activity_harvest(vrid, 1, route_keys, &cnt, NULL);
+    elapsed = bench_now() - start;
+    printf("harvest  %u routes in %.3f ms, %u active\n", BENCH_NEIGHS, elapsed * 1e3, cnt);
+
+    oes_api_router_uc_route_set(OES_ACCESS_CMD_DELETE_ALL, vrid, NULL, NULL, NULL);
+    oes_api_router_neigh_set(OES_ACCESS_CMD_DELETE_ALL, vrid, NULL, NULL, NULL);
+    oes_api_router_set(OES_ACCESS_CMD_DELETE, &vrid, NULL, NULL);
+    return 0;
+}
@@ -0,0 +1,189 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Route batch benchmark: loads a synthesized full IPv4 table (~1M
+ * prefixes, 16 next hops) one oes_api_router_uc_route_set call per
+ * prefix and again through oes_api_router_uc_route_batch_set, then
+ * replays churn batches mixing withdraws, announces and next hop
+ * changes. Also times the rollback of a batch failing on its last op.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_api_router.h"
+
+#define BENCH_PREFIXES    1000000
+#define BENCH_NHS         16
+#define BENCH_BATCH       65536
+#define BENCH_CHURN       300000
+
+static unsigned long long bench_rand_state = 88172645463325252ULL;
+
+static unsigned int
+bench_rand(void)
+{
+    bench_rand_state ^= bench_rand_state << 13;
+    bench_rand_state ^= bench_rand_state >> 7;
+    bench_rand_state ^= bench_rand_state << 17;
+    return (unsigned int)bench_rand_state;
+}
+
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* rough shape of a BGP table: mostly /24, then /16-/23, few long */
+static void
+bench_prefix(struct oes_ip_prefix *key_p)
+{
+    unsigned int r = bench_rand() % 1000;
+    unsigned int len = (r < 600) ? 24 : (r < 950) ? 16 + bench_rand() % 8 : 25 + bench_rand() % 8;
+    unsigned int ip = (1 + bench_rand() % 223) << 24 | (bench_rand() & 0xffffff);
+
+    memset(key_p, 0, sizeof(*key_p));
+    key_p->prefix.version = OES_IPV4;
+    key_p->prefix.addr.ipv4.s_addr = htonl(ip & (0xffffffffU << (32 - len)));
+    key_p->prefix_len = len;
+}
+
+static void
+bench_op(struct oes_uc_route_op *op_p,
+         enum oes_access_cmd access_cmd,
+         const struct oes_ip_prefix *key_p,
+         struct oes_ip_addr *next_hop_p)
+{
+    op_p->access_cmd = access_cmd;
+    op_p->key = *key_p;
+    op_p->data.action = OES_ROUTER_ACTION_FORWARD;
+    op_p->data.next_hop_list = next_hop_p;
+    op_p->data.next_hop_cnt = 1;
+    op_p->data.activity = 0;
+    op_p->ecmp_params_p = NULL;
+}
+
+/* applies ops in BENCH_BATCH sized batches, returns updates per second */
+static double
+bench_apply(unsigned int vrid, const struct oes_uc_route_op *ops_p, unsigned int cnt)
+{
+    unsigned int i, failed;
+    double       start = bench_now();
+
+    for (i = 0; i < cnt; i += BENCH_BATCH) {
+        if (oes_api_router_uc_route_batch_set(vrid, &ops_p[i], (cnt - i < BENCH_BATCH) ? cnt - i : BENCH_BATCH,
+                                              &failed, NULL) != OES_STATUS_SUCCESS) {
+            printf("batch at %u failed on op %u\n", i, i + failed);
+            exit(1);
+        }
+    }
+    return cnt / (bench_now() - start);
+}
+
+int
+main(void)
+{
+    struct oes_router_attributes attr = { 1, 1, OES_ROUTER_ACTION_TRAP, OES_ROUTER_ACTION_TRAP };
+    struct oes_ip_prefix        *keys_p = malloc(BENCH_PREFIXES * sizeof(*keys_p));
+    struct oes_uc_route_op      *ops_p = malloc(BENCH_PREFIXES * sizeof(*ops_p));
+    struct oes_ip_addr           next_hop[BENCH_NHS];
+    struct oes_uc_route_data     data;
+    unsigned int                 vrid, i, j, k, failed;
+    double                       start, elapsed, rate;
+
+    oes_api_router_set(OES_ACCESS_CMD_ADD, &vrid, &attr, NULL);
+    memset(next_hop, 0, sizeof(next_hop));
+    for (i = 0; i < BENCH_NHS; i++) {
+        next_hop[i].version = OES_IPV4;
+        next_hop[i].addr.ipv4.s_addr = htonl(0xc0a80001 + i);
+    }
+    for (i = 0; i < BENCH_PREFIXES; i++) {
+        bench_prefix(&keys_p[i]);
+    }
+
+    memset(&data, 0, sizeof(data));
+    data.action = OES_ROUTER_ACTION_FORWARD;
+    data.next_hop_cnt = 1;
+    start = bench_now();
+    for (i = 0; i < BENCH_PREFIXES; i++) {
+        data.next_hop_list = &next_hop[i % BENCH_NHS];
+        oes_api_router_uc_route_set(OES_ACCESS_CMD_ADD, vrid, &keys_p[i], &data, NULL);
+    }
+    elapsed = bench_now() - start;
+    printf("per-call %u prefixes in %.3f s (%.2f M updates/s)\n", BENCH_PREFIXES, elapsed,
+           BENCH_PREFIXES / elapsed / 1e6);
+    oes_api_router_uc_route_set(OES_ACCESS_CMD_DELETE_ALL, vrid, NULL, NULL, NULL);
+
+    for (i = 0; i < BENCH_PREFIXES; i++) {
+        bench_op(&ops_p[i], OES_ACCESS_CMD_ADD, &keys_p[i], &next_hop[i % BENCH_NHS]);
+    }
+    rate = bench_apply(vrid, ops_p, BENCH_PREFIXES);
+    printf("batch    %u prefixes in batches of %u (%.2f M updates/s)\n", BENCH_PREFIXES, BENCH_BATCH,
+           rate / 1e6);
+
+    /* churn: a third withdrawn, re-announced later in the stream, a third moved */
+    for (k = 0; k + 3 <= BENCH_CHURN;) {
+        j = bench_rand() % BENCH_PREFIXES;
+        bench_op(&ops_p[k++], OES_ACCESS_CMD_DELETE, &keys_p[j], NULL);
+        bench_op(&ops_p[k++], OES_ACCESS_CMD_ADD, &keys_p[j], &next_hop[bench_rand() % BENCH_NHS]);
+        bench_op(&ops_p[k++], OES_ACCESS_CMD_EDIT, &keys_p[bench_rand() % BENCH_PREFIXES],
+                 &next_hop[bench_rand() % BENCH_NHS]);
+    }
+    rate = bench_apply(vrid, ops_p, k);
+    printf("churn    %u withdraw/announce/move ops (%.2f M updates/s)\n", k, rate / 1e6);
+
+    /* one bad op at the end of a full batch: everything before it is undone */
+    for (i = 0; i < BENCH_BATCH - 1; i++) {
+        bench_op(&ops_p[i], OES_ACCESS_CMD_EDIT, &keys_p[bench_rand() % BENCH_PREFIXES],
+                 &next_hop[i % BENCH_NHS]);
+    }
+    bench_prefix(&ops_p[i].key);
+    ops_p[i].key.prefix_len = 33;
+    start = bench_now();
+    oes_api_router_uc_route_batch_set(vrid, ops_p, BENCH_BATCH, &failed, NULL);
+    elapsed = bench_now() - start;
+    printf("rollback batch of %u failing on op %u in %.3f ms\n", BENCH_BATCH, failed, elapsed * 1e3);
+
+    oes_api_router_uc_route_set(OES_ACCESS_CMD_DELETE_ALL, vrid, NULL, NULL, NULL);
+    oes_api_router_set(OES_ACCESS_CMD_DELETE, &vrid, NULL, NULL);
+    free(keys_p);
+    free(ops_p);
+    return 0;
+}
@@ -0,0 +1,352 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * BGP churn benchmark: loads a synthesized full table (~900K IPv4 and
+ * 150K IPv6 prefixes over 32 next hops) into one vrid, then replays
+ * update streams through oes_api_router_uc_route_set and
+ * oes_api_router_neigh_set while a second thread runs
+ * oes_api_router_uc_route_lookup:
+ *  - peer resets: bursts withdrawing a slice of the table, followed by
+ *    its re-announcement over another next hop
+ *  - path changes: single prefixes moving to another next hop
+ *  - next hop flaps: a neighbour going away and coming back, which
+ *    demotes and promotes every route over it
+ * Reports ops/s and per call latency percentiles for every stream, the
+ * lookup rate idle and under churn, and the peak RSS.
+ * Run with "make bench_churn".
+ */
+
+#include <sys/types.h>
+#include <sys/resource.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_api_router.h"
+
+#define BENCH_PREFIXES4   900000
+#define BENCH_PREFIXES6   150000
+#define BENCH_NHS         32
+#define BENCH_BATCH       65536
+#define BENCH_BURSTS      40
+#define BENCH_BURST       10000         /* prefixes of one peer reset */
+#define BENCH_MOVES       300000
+#define BENCH_FLAPS       2000
+#define BENCH_ADDRS       65536         /* lookup working set */
+#define BENCH_IDLE_SEC    0.5
+
+static unsigned long long bench_rand_state = 88172645463325252ULL;
+static int                bench_stop;
+static unsigned long long bench_lookups;
+static unsigned int       bench_vrid;
+static struct oes_ip_addr bench_addrs[BENCH_ADDRS];
+
+static unsigned int
+bench_rand(void)
+{
+    bench_rand_state ^= bench_rand_state << 13;
+    bench_rand_state ^= bench_rand_state >> 7;
+    bench_rand_state ^= bench_rand_state << 17;
+    return (unsigned int)bench_rand_state;
+}
+
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* rough shape of a BGP table: mostly /24, then /16-/23, few long */
+static void
+bench_prefix4(struct oes_ip_prefix *key_p)
+{
+    unsigned int r = bench_rand() % 1000;
+    unsigned int len = (r < 600) ? 24 : (r < 950) ? 16 + bench_rand() % 8 : 25 + bench_rand() % 8;
+    unsigned int ip = (1 + bench_rand() % 223) << 24 | (bench_rand() & 0xffffff);
+
+    memset(key_p, 0, sizeof(*key_p));
+    key_p->prefix.version = OES_IPV4;
+    key_p->prefix.addr.ipv4.s_addr = htonl(ip & (0xffffffffU << (32 - len)));
+    key_p->prefix_len = len;
+}
+
+/* mostly /48, then /32-/44, a few /56 and /64, under 2000::/3 */
+static void
+bench_prefix6(struct oes_ip_prefix *key_p)
+{
+    unsigned int r = bench_rand() % 100;
+    unsigned int len = (r < 55) ? 48 : (r < 90) ? 32 + (bench_rand() % 4) * 4 : 56 + (bench_rand() % 2) * 8;
+    unsigned int i;
+
+    memset(key_p, 0, sizeof(*key_p));
+    key_p->prefix.version = OES_IPV6;
+    key_p->prefix.addr.ipv6.s6_addr[0] = 0x20 | (bench_rand() & 0x1f);
+    for (i = 1; i < 8; i++) {
+        key_p->prefix.addr.ipv6.s6_addr[i] = bench_rand();
+    }
+    for (i = len; i < 64; i++) {
+        key_p->prefix.addr.ipv6.s6_addr[i / 8] &= ~(0x80 >> (i % 8));
+    }
+    key_p->prefix_len = len;
+}
+
+static int
+bench_prefix_cmp(const void *a, const void *b)
+{
+    return memcmp(a, b, sizeof(struct oes_ip_prefix));
+}
+
+static int
+bench_lat_cmp(const void *a, const void *b)
+{
+    unsigned int x = *(const unsigned int *)a;
+    unsigned int y = *(const unsigned int *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* prints the rate and latency percentiles of cnt calls, lat_p in ns */
+static void
+bench_report(const char *name_p, unsigned int *lat_p, unsigned int cnt, double elapsed)
+{
+    qsort(lat_p, cnt, sizeof(*lat_p), bench_lat_cmp);
+    printf("%-8s %u calls, %.2f M ops/s, latency p50 %.2f us p99 %.2f us p99.9 %.2f us max %.1f us\n",
+           name_p, cnt, cnt / elapsed / 1e6, lat_p[cnt / 2] / 1e3, lat_p[cnt / 100 * 99] / 1e3,
+           lat_p[cnt / 1000 * 999] / 1e3, lat_p[cnt - 1] / 1e3);
+}
+
+static void *
+bench_lookup(void *arg_p)
+{
+    struct oes_uc_route_lookup_data data;
+    unsigned long long              cnt = 0;
+
+    while (!__atomic_load_n(&bench_stop, __ATOMIC_RELAXED)) {
+        oes_api_router_uc_route_lookup(bench_vrid, &bench_addrs[cnt % BENCH_ADDRS], (unsigned int)cnt, &data);
+        if ((++cnt & 1023) == 0) {
+            __atomic_store_n(&bench_lookups, cnt, __ATOMIC_RELAXED);
+        }
+    }
+    __atomic_store_n(&bench_lookups, cnt, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+/* lookups done by the lookup thread so far */
+static unsigned long long
+bench_lookups_get(void)
+{
+    return __atomic_load_n(&bench_lookups, __ATOMIC_RELAXED);
+}
+
+int
+main(void)
+{
+    struct oes_router_attributes attr = { 1, 1, OES_ROUTER_ACTION_TRAP, OES_ROUTER_ACTION_TRAP };
+    struct ether_addr            mac = { { 0x00, 0x02, 0xc9, 0x00, 0x00, 0x01 } };
+    unsigned int                 cnt = BENCH_PREFIXES4 + BENCH_PREFIXES6;
+    struct oes_ip_prefix        *keys_p = malloc(cnt * sizeof(*keys_p));
+    struct oes_uc_route_op      *ops_p = malloc(BENCH_BATCH * sizeof(*ops_p));
+    unsigned int                *lat_p = malloc(BENCH_BURSTS * BENCH_BURST * 2 * sizeof(*lat_p));
+    struct oes_ip_addr           nhs[BENCH_NHS];
+    struct oes_uc_route_data     data;
+    struct oes_neigh_data        neigh;
+    struct oes_ip_prefix         tmp;
+    struct rusage                usage;
+    pthread_t                    lookup_tid;
+    unsigned long long           lookups, churn_lookups = 0;
+    unsigned int                 i, j, k, n, first, failed, lat_cnt;
+    double                       start, call, elapsed, churn_time = 0;
+
+    if ((keys_p == NULL) || (ops_p == NULL) || (lat_p == NULL)) {
+        printf("out of memory\n");
+        return 1;
+    }
+    for (i = 0; i < cnt; i++) {
+        if (i < BENCH_PREFIXES4) {
+            bench_prefix4(&keys_p[i]);
+        } else {
+            bench_prefix6(&keys_p[i]);
+        }
+    }
+    /* unique prefixes, in random order: peers are slices of the table */
+    qsort(keys_p, cnt, sizeof(*keys_p), bench_prefix_cmp);
+    for (i = 1, n = 1; i < cnt; i++) {
+        if (bench_prefix_cmp(&keys_p[i], &keys_p[n - 1])) {
+            keys_p[n++] = keys_p[i];
+        }
+    }
+    cnt = n;
+    for (i = cnt; i-- > 1;) {
+        j = bench_rand() % (i + 1);
+        tmp = keys_p[i];
+        keys_p[i] = keys_p[j];
+        keys_p[j] = tmp;
+    }
+    for (i = 0; i < BENCH_ADDRS; i++) {
+        bench_addrs[i] = keys_p[bench_rand() % cnt].prefix;
+    }
+
+    memset(nhs, 0, sizeof(nhs));
+    for (i = 0; i < BENCH_NHS; i++) {
+        nhs[i].version = OES_IPV4;
+        nhs[i].addr.ipv4.s_addr = htonl(0xc0a80001 + i);
+    }
+    memset(&data, 0, sizeof(data));
+    data.action = OES_ROUTER_ACTION_FORWARD;
+    data.next_hop_cnt = 1;
+    memset(&neigh, 0, sizeof(neigh));
+    neigh.mac_addr = &mac;
+    neigh.action = OES_ROUTER_ACTION_FORWARD;
+
+    oes_api_router_set(OES_ACCESS_CMD_ADD, &bench_vrid, &attr, NULL);
+    for (i = 0; i < BENCH_NHS; i++) {
+        neigh.rif = i;
+        oes_api_router_neigh_set(OES_ACCESS_CMD_ADD, bench_vrid, &nhs[i], &neigh, NULL);
+    }
+
+    start = bench_now();
+    for (i = 0; i < cnt; i += BENCH_BATCH) {
+        n = (cnt - i < BENCH_BATCH) ? cnt - i : BENCH_BATCH;
+        for (j = 0; j < n; j++) {
+            memset(&ops_p[j], 0, sizeof(ops_p[j]));
+            ops_p[j].access_cmd = OES_ACCESS_CMD_ADD;
+            ops_p[j].key = keys_p[i + j];
+            ops_p[j].data = data;
+            ops_p[j].data.next_hop_list = &nhs[(i + j) % BENCH_NHS];
+        }
+        if (oes_api_router_uc_route_batch_set(bench_vrid, ops_p, n, &failed, NULL) != OES_STATUS_SUCCESS) {
+            printf("load batch at %u failed on op %u\n", i, i + failed);
+            return 1;
+        }
+    }
+    elapsed = bench_now() - start;
+    printf("load     %u unique prefixes in %.3f s (%.2f M routes/s)\n", cnt, elapsed, cnt / elapsed / 1e6);
+
+    pthread_create(&lookup_tid, NULL, bench_lookup, NULL);
+    start = bench_now();
+    lookups = bench_lookups_get();
+    while (bench_now() - start < BENCH_IDLE_SEC) {
+        sched_yield();
+    }
+    elapsed = bench_now() - start;
+    printf("lookup   idle %.2f M lookups/s\n", (bench_lookups_get() - lookups) / elapsed / 1e6);
+
+    /* peer resets: withdraw a slice, announce it back over another next hop */
+    lat_cnt = 0;
+    lookups = bench_lookups_get();
+    start = bench_now();
+    for (k = 0; k < BENCH_BURSTS; k++) {
+        first = bench_rand() % (cnt - BENCH_BURST);
+        for (i = first; i < first + BENCH_BURST; i++) {
+            call = bench_now();
+            if (oes_api_router_uc_route_set(OES_ACCESS_CMD_DELETE, bench_vrid, &keys_p[i], NULL, NULL) !=
+                OES_STATUS_SUCCESS) {
+                printf("withdraw of prefix %u failed\n", i);
+                return 1;
+            }
+            lat_p[lat_cnt++] = (bench_now() - call) * 1e9;
+        }
+        data.next_hop_list = &nhs[k % BENCH_NHS];
+        for (i = first; i < first + BENCH_BURST; i++) {
+            call = bench_now();
+            if (oes_api_router_uc_route_set(OES_ACCESS_CMD_ADD, bench_vrid, &keys_p[i], &data, NULL) !=
+                OES_STATUS_SUCCESS) {
+                printf("announce of prefix %u failed\n", i);
+                return 1;
+            }
+            lat_p[lat_cnt++] = (bench_now() - call) * 1e9;
+        }
+    }
+    elapsed = bench_now() - start;
+    churn_time += elapsed;
+    churn_lookups += bench_lookups_get() - lookups;
+    bench_report("reset", lat_p, lat_cnt, elapsed);
+
+    /* path changes: random prefixes moving to another next hop */
+    lat_cnt = 0;
+    lookups = bench_lookups_get();
+    start = bench_now();
+    for (k = 0; k < BENCH_MOVES; k++) {
+        data.next_hop_list = &nhs[bench_rand() % BENCH_NHS];
+        call = bench_now();
+        if (oes_api_router_uc_route_set(OES_ACCESS_CMD_EDIT, bench_vrid, &keys_p[bench_rand() % cnt], &data,
+                                        NULL) != OES_STATUS_SUCCESS) {
+            printf("move %u failed\n", k);
+            return 1;
+        }
+        lat_p[lat_cnt++] = (bench_now() - call) * 1e9;
+    }
+    elapsed = bench_now() - start;
+    churn_time += elapsed;
+    churn_lookups += bench_lookups_get() - lookups;
+    bench_report("move", lat_p, lat_cnt, elapsed);
+
+    /* next hop flaps: each flips the ~1/32 of the table routed over it */
+    lat_cnt = 0;
+    lookups = bench_lookups_get();
+    start = bench_now();
+    for (k = 0; k < BENCH_FLAPS; k++) {
+        i = bench_rand() % BENCH_NHS;
+        neigh.rif = i;
+        call = bench_now();
+        oes_api_router_neigh_set(OES_ACCESS_CMD_DELETE, bench_vrid, &nhs[i], NULL, NULL);
+        lat_p[lat_cnt++] = (bench_now() - call) * 1e9;
+        call = bench_now();
+        oes_api_router_neigh_set(OES_ACCESS_CMD_ADD, bench_vrid, &nhs[i], &neigh, NULL);
+        lat_p[lat_cnt++] = (bench_now() - call) * 1e9;
+    }
+    elapsed = bench_now() - start;
+    churn_time += elapsed;
+    churn_lookups += bench_lookups_get() - lookups;
+    bench_report("flap", lat_p, lat_cnt, elapsed);
+
+    __atomic_store_n(&bench_stop, 1, __ATOMIC_RELAXED);
+    pthread_join(lookup_tid, NULL);
+    printf("lookup   under churn %.2f M lookups/s\n", churn_lookups / churn_time / 1e6);
+
+    getrusage(RUSAGE_SELF, &usage);
+    printf("rss      peak %.1f MB\n", usage.ru_maxrss / 1024.0);
+
+    oes_api_router_uc_route_set(OES_ACCESS_CMD_DELETE_ALL, bench_vrid, NULL, NULL, NULL);
+    oes_api_router_neigh_set(OES_ACCESS_CMD_DELETE_ALL, bench_vrid, NULL, NULL, NULL);
+    oes_api_router_set(OES_ACCESS_CMD_DELETE, &bench_vrid, NULL, NULL);
+    free(keys_p);
+    free(ops_p);
+    free(lat_p);
+    return 0;
+}
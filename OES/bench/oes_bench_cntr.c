@@ -0,0 +1,187 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Router interface counter benchmark. Times counting through
+ * oes_api_router_interface_cntr_count against a shared atomic add per
+ * field, then runs counting threads while a reader read-clears every
+ * counter in a loop, and checks that the cleared and final counts add
+ * up to exactly what was counted.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_api_router.h"
+
+#define BENCH_RIFS        256
+#define BENCH_COUNTS      (32 * 1024 * 1024)
+#define BENCH_THREADS     4
+#define BENCH_PKT_BYTES   64
+
+struct bench_thread {
+    unsigned int vrid;
+    unsigned int counts;
+};
+
+static struct oes_router_cntr bench_shared[BENCH_RIFS];
+static int                    bench_stop;
+
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void *
+bench_counter(void *arg_p)
+{
+    struct bench_thread *thread_p = arg_p;
+    unsigned int         i;
+
+    for (i = 0; i < thread_p->counts; i++) {
+        oes_api_router_interface_cntr_count(thread_p->vrid, i % BENCH_RIFS,
+                                            (i & 1) ? OES_ROUTER_CNTR_EGRESS_UNICAST :
+                                            OES_ROUTER_CNTR_INGRESS_UNICAST, 1, BENCH_PKT_BYTES);
+    }
+    return NULL;
+}
+
+/* read-clears every counter until stopped, accumulating what it cleared */
+static void *
+bench_reader(void *arg_p)
+{
+    struct bench_thread   *thread_p = arg_p;
+    struct oes_router_cntr cntr;
+    unsigned int           rif;
+
+    thread_p->counts = 0;
+    while (!__atomic_load_n(&bench_stop, __ATOMIC_RELAXED)) {
+        for (rif = 0; rif < BENCH_RIFS; rif++) {
+            oes_api_router_interface_cntr_get(OES_ACCESS_CMD_READ_CLEAR, thread_p->vrid, rif, &cntr, NULL);
+            bench_shared[rif].router_ingress_unicast_packets += cntr.router_ingress_unicast_packets;
+            bench_shared[rif].router_egress_unicast_packets += cntr.router_egress_unicast_packets;
+            bench_shared[rif].router_egress_unicast_bytes += cntr.router_egress_unicast_bytes;
+        }
+        thread_p->counts++;
+    }
+    return NULL;
+}
+
+int
+main(void)
+{
+    struct oes_router_attributes attr = { 1, 1, OES_ROUTER_ACTION_TRAP, OES_ROUTER_ACTION_TRAP };
+    struct bench_thread          threads[BENCH_THREADS], reader;
+    pthread_t                    tids[BENCH_THREADS], reader_tid;
+    struct oes_router_cntr       cntr;
+    unsigned long long           packets = 0, bytes = 0, expected;
+    unsigned int                 vrid, rif, i, t;
+    double                       start, elapsed;
+
+    oes_api_router_set(OES_ACCESS_CMD_ADD, &vrid, &attr, NULL);
+    for (rif = 0; rif < BENCH_RIFS; rif++) {
+        oes_api_router_interface_cntr_enable_set(OES_ACCESS_CMD_ADD, vrid, rif, NULL);
+    }
+
+    threads[0].vrid = vrid;
+    threads[0].counts = BENCH_COUNTS;
+    start = bench_now();
+    bench_counter(&threads[0]);
+    elapsed = bench_now() - start;
+    printf("count    %u per-thread slab counts in %.3f s (%.1f M/s)\n", BENCH_COUNTS, elapsed,
+           BENCH_COUNTS / elapsed / 1e6);
+
+    start = bench_now();
+    for (i = 0; i < BENCH_COUNTS; i++) {
+        rif = i % BENCH_RIFS;
+        if (i & 1) {
+            __atomic_fetch_add(&bench_shared[rif].router_egress_unicast_packets, 1, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&bench_shared[rif].router_egress_unicast_bytes, BENCH_PKT_BYTES, __ATOMIC_RELAXED);
+        } else {
+            __atomic_fetch_add(&bench_shared[rif].router_ingress_unicast_packets, 1, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&bench_shared[rif].router_ingress_unicast_bytes, BENCH_PKT_BYTES, __ATOMIC_RELAXED);
+        }
+    }
+    elapsed = bench_now() - start;
+    printf("count    %u shared atomic counts in %.3f s (%.1f M/s)\n", BENCH_COUNTS, elapsed,
+           BENCH_COUNTS / elapsed / 1e6);
+
+    start = bench_now();
+    for (i = 0; i < 1000; i++) {
+        oes_api_router_interface_cntr_get(OES_ACCESS_CMD_READ_CLEAR, vrid, i % BENCH_RIFS, &cntr, NULL);
+    }
+    elapsed = bench_now() - start;
+    printf("read     read-clear in %.2f us\n", elapsed / 1000 * 1e6);
+
+    /* start from zero, then count from several threads under a clearing reader */
+    for (rif = 0; rif < BENCH_RIFS; rif++) {
+        oes_api_router_interface_cntr_get(OES_ACCESS_CMD_READ_CLEAR, vrid, rif, &cntr, NULL);
+    }
+    memset(bench_shared, 0, sizeof(bench_shared));
+    reader.vrid = vrid;
+    pthread_create(&reader_tid, NULL, bench_reader, &reader);
+    start = bench_now();
+    for (t = 0; t < BENCH_THREADS; t++) {
+        threads[t].vrid = vrid;
+        threads[t].counts = BENCH_COUNTS / BENCH_THREADS;
+        pthread_create(&tids[t], NULL, bench_counter, &threads[t]);
+    }
+    for (t = 0; t < BENCH_THREADS; t++) {
+        pthread_join(tids[t], NULL);
+    }
+    elapsed = bench_now() - start;
+    __atomic_store_n(&bench_stop, 1, __ATOMIC_RELAXED);
+    pthread_join(reader_tid, NULL);
+    for (rif = 0; rif < BENCH_RIFS; rif++) {
+        oes_api_router_interface_cntr_get(OES_ACCESS_CMD_READ_CLEAR, vrid, rif, &cntr, NULL);
+        packets += bench_shared[rif].router_ingress_unicast_packets + cntr.router_ingress_unicast_packets +
+                   bench_shared[rif].router_egress_unicast_packets + cntr.router_egress_unicast_packets;
+        bytes += bench_shared[rif].router_egress_unicast_bytes + cntr.router_egress_unicast_bytes;
+    }
+    expected = (unsigned long long)BENCH_COUNTS / BENCH_THREADS * BENCH_THREADS;
+    printf("threads  %u counters x %u in %.3f s (%.1f M/s), %u clear passes, %s\n", BENCH_THREADS,
+           BENCH_COUNTS / BENCH_THREADS, elapsed, expected / elapsed / 1e6, reader.counts,
+           ((packets == expected) && (bytes == expected / 2 * BENCH_PKT_BYTES)) ? "exact" : "MISMATCH");
+
+    for (rif = 0; rif < BENCH_RIFS; rif++) {
+        oes_api_router_interface_cntr_enable_set(OES_ACCESS_CMD_DELETE, vrid, rif, NULL);
+    }
+    oes_api_router_set(OES_ACCESS_CMD_DELETE, &vrid, NULL, NULL);
+    return (packets == expected) ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * ECMP hash benchmark: hashes batches of parsed IPv4/IPv6 flows with
+ * every field enabled, reports packets per second for hashing and for
+ * member selection, and the spread of 1M flows over 16 members.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_router_ecmp.h"
+
+#define BENCH_FLOWS       (1 << 20)
+#define BENCH_BATCH       256
+#define BENCH_ROUNDS      64
+#define BENCH_MEMBERS     16
+
+static unsigned long long bench_rand_state = 88172645463325252ULL;
+
+static unsigned int
+bench_rand(void)
+{
+    bench_rand_state ^= bench_rand_state << 13;
+    bench_rand_state ^= bench_rand_state >> 7;
+    bench_rand_state ^= bench_rand_state << 17;
+    return (unsigned int)bench_rand_state;
+}
+
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void
+bench_flow(struct oes_ecmp_flow *flow_p)
+{
+    unsigned int i;
+
+    memset(flow_p, 0, sizeof(*flow_p));
+    flow_p->version = (bench_rand() % 4) ? OES_IPV4 : OES_IPV6;
+    if (flow_p->version == OES_IPV4) {
+        /* a few thousand clients talking to a few servers */
+        flow_p->src_ip[0] = 10;
+        flow_p->src_ip[2] = bench_rand() % 16;
+        flow_p->src_ip[3] = bench_rand();
+        flow_p->dst_ip[0] = 192;
+        flow_p->dst_ip[1] = 168;
+        flow_p->dst_ip[3] = bench_rand() % 8;
+    } else {
+        for (i = 0; i < 16; i++) {
+            flow_p->src_ip[i] = (i < 6) ? 0x20 + i : bench_rand();
+            flow_p->dst_ip[i] = (i < 15) ? 0x20 + i : bench_rand() % 8;
+        }
+        flow_p->flow_label = bench_rand() & 0xfffff;
+    }
+    flow_p->ip_proto = (bench_rand() % 3) ? 6 : 17;
+    flow_p->src_port = 1024 + bench_rand() % 64512;
+    flow_p->dst_port = (bench_rand() % 2) ? 443 : 80;
+    flow_p->tc = bench_rand() % 4;
+}
+
+int
+main(void)
+{
+    struct oes_router_ecmp_hash_fields fields = { 1, 1, 1, 1, 1, 1, 1 };
+    struct oes_ecmp_hasher             hasher;
+    struct oes_ecmp_flow              *flows_p = malloc(BENCH_FLOWS * sizeof(*flows_p));
+    unsigned int                      *out_p = malloc(BENCH_FLOWS * sizeof(*out_p));
+    unsigned int                       load[BENCH_MEMBERS] = { 0 };
+    unsigned int                       i, round, min, max;
+    unsigned long long                 sum = 0;
+    double                             start, elapsed;
+
+    for (i = 0; i < BENCH_FLOWS; i++) {
+        bench_flow(&flows_p[i]);
+    }
+    oes_ecmp_hasher_init(&hasher, &fields, 0x4f455321);
+
+    /* one L1 resident batch, as a forwarding loop would see it */
+    start = bench_now();
+    for (round = 0; round < BENCH_FLOWS / BENCH_BATCH * BENCH_ROUNDS / 16; round++) {
+        oes_ecmp_hash_bulk(&hasher, &flows_p[(round % 64) * BENCH_BATCH], out_p, BENCH_BATCH);
+        sum += out_p[round % BENCH_BATCH];
+    }
+    elapsed = bench_now() - start;
+    printf("hash     batch of %u, %.1f Mpps\n", BENCH_BATCH,
+           (double)round * BENCH_BATCH / elapsed / 1e6);
+
+    start = bench_now();
+    for (round = 0; round < BENCH_FLOWS / BENCH_BATCH * BENCH_ROUNDS / 16; round++) {
+        oes_ecmp_select_bulk(&hasher, &flows_p[(round % 64) * BENCH_BATCH], BENCH_MEMBERS,
+                             out_p, BENCH_BATCH);
+        sum += out_p[round % BENCH_BATCH];
+    }
+    elapsed = bench_now() - start;
+    printf("select   batch of %u over %u members, %.1f Mpps\n", BENCH_BATCH, BENCH_MEMBERS,
+           (double)round * BENCH_BATCH / elapsed / 1e6);
+
+    start = bench_now();
+    for (round = 0; round < BENCH_ROUNDS / 16; round++) {
+        oes_ecmp_select_bulk(&hasher, flows_p, BENCH_MEMBERS, out_p, BENCH_FLOWS);
+        sum += out_p[round];
+    }
+    elapsed = bench_now() - start;
+    printf("select   %u flows streamed from memory, %.1f Mpps\n", BENCH_FLOWS,
+           (double)round * BENCH_FLOWS / elapsed / 1e6);
+
+    for (i = 0; i < BENCH_FLOWS; i++) {
+        load[out_p[i]]++;
+    }
+    min = max = load[0];
+    for (i = 1; i < BENCH_MEMBERS; i++) {
+        min = (load[i] < min) ? load[i] : min;
+        max = (load[i] > max) ? load[i] : max;
+    }
+    printf("spread   %u flows over %u members, min %.2f%% max %.2f%% (ideal %.2f%%)  [%llx]\n",
+           BENCH_FLOWS, BENCH_MEMBERS, 100.0 * min / BENCH_FLOWS, 100.0 * max / BENCH_FLOWS,
+           100.0 / BENCH_MEMBERS, sum & 0xf);
+
+    free(flows_p);
+    free(out_p);
+    return 0;
+}
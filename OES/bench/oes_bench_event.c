@@ -0,0 +1,208 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Event channel benchmark: for every notify mode, a producer thread
+ * sends port events at a fixed rate (0 = as fast as possible) and the
+ * consumer receives them with oes_api_event_recv. Reports consumer and
+ * producer CPU time per event and the send to receive latency.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_api_event.h"
+
+#define BENCH_EVENTS      100000
+#define BENCH_BUSY_USEC   50
+#define BENCH_END_SEQ     BENCH_EVENTS  /* sequence number of the end of run marker */
+#define BENCH_END_USEC    100           /* marker resend interval */
+
+struct bench_run {
+    int                 fd;
+    unsigned int        rate;      /**< events per second, 0 = unpaced */
+    unsigned long long *send_ns;   /**< send time per sequence number */
+    unsigned long long  producer_cpu_ns;
+    int                 stopped;   /**< consumer got the end marker */
+};
+
+static unsigned long long
+bench_now_ns(clockid_t clock)
+{
+    struct timespec ts;
+
+    clock_gettime(clock, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int
+bench_cmp_ull(const void *a, const void *b)
+{
+    unsigned long long x = *(const unsigned long long *)a;
+    unsigned long long y = *(const unsigned long long *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void *
+bench_producer(void *arg)
+{
+    struct bench_run     *run_p = arg;
+    struct oes_event_info event_info;
+    unsigned long long    cpu_start = bench_now_ns(CLOCK_THREAD_CPUTIME_ID);
+    unsigned long long    start = bench_now_ns(CLOCK_MONOTONIC);
+    struct timespec       due;
+    unsigned long long    due_ns;
+    unsigned int          seq;
+
+    memset(&event_info, 0, sizeof(event_info));
+    event_info.event_id = OES_EVENT_ID_PORT;
+    for (seq = 0; seq < BENCH_EVENTS; seq++) {
+        if (run_p->rate) {
+            due_ns = start + (unsigned long long)seq * 1000000000ULL / run_p->rate;
+            due.tv_sec = due_ns / 1000000000ULL;
+            due.tv_nsec = due_ns % 1000000000ULL;
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL);
+        } else if ((seq & 1023) == 0) {
+            sched_yield();
+        }
+        event_info.event_info.port_event.log_port = seq;
+        run_p->send_ns[seq] = bench_now_ns(CLOCK_MONOTONIC);
+        oes_event_send(0, &event_info);
+    }
+    run_p->producer_cpu_ns = bench_now_ns(CLOCK_THREAD_CPUTIME_ID) - cpu_start;
+
+    /* a full ring drops events, the marker included: resend it until it gets through */
+    event_info.event_info.port_event.log_port = BENCH_END_SEQ;
+    while (!__atomic_load_n(&run_p->stopped, __ATOMIC_ACQUIRE)) {
+        oes_event_send(0, &event_info);
+        usleep(BENCH_END_USEC);
+    }
+    return NULL;
+}
+
+static int
+bench_mode(const char *name, enum oes_event_notify_mode mode, unsigned int rate)
+{
+    struct oes_event_fd_params params = { mode, BENCH_BUSY_USEC };
+    struct oes_event_info      event_info;
+    struct bench_run           run;
+    pthread_t                  producer;
+    unsigned long long        *lat_ns = malloc(BENCH_EVENTS * sizeof(*lat_ns));
+    unsigned long long         cpu_start, cpu_ns, wall_start, wall_ns;
+    unsigned int               rcvd = 0;
+
+    memset(&run, 0, sizeof(run));
+    run.rate = rate;
+    run.send_ns = calloc(BENCH_EVENTS, sizeof(*run.send_ns));
+    if ((lat_ns == NULL) || (run.send_ns == NULL)) {
+        printf("%s: allocation of %u samples failed\n", name, BENCH_EVENTS);
+        free(run.send_ns);
+        free(lat_ns);
+        return 1;
+    }
+    if (oes_api_event_fd_set(OES_ACCESS_CMD_CREATE, &run.fd, &params) != OES_STATUS_SUCCESS) {
+        printf("%s: channel create failed\n", name);
+        free(run.send_ns);
+        free(lat_ns);
+        return 1;
+    }
+    if (oes_api_event_register_set(OES_ACCESS_CMD_ADD, 0, OES_EVENT_ID_PORT, run.fd,
+                                   NULL) != OES_STATUS_SUCCESS) {
+        printf("%s: port event registration failed\n", name);
+        oes_api_event_fd_set(OES_ACCESS_CMD_DESTROY, &run.fd, NULL);
+        free(run.send_ns);
+        free(lat_ns);
+        return 1;
+    }
+
+    cpu_start = bench_now_ns(CLOCK_THREAD_CPUTIME_ID);
+    wall_start = bench_now_ns(CLOCK_MONOTONIC);
+    pthread_create(&producer, NULL, bench_producer, &run);
+    /* events after the marker are marker resends, what never came was dropped */
+    while (oes_api_event_recv(run.fd, &event_info, NULL) == OES_STATUS_SUCCESS) {
+        unsigned int seq = event_info.event_info.port_event.log_port;
+
+        if (seq == BENCH_END_SEQ) {
+            break;
+        }
+        lat_ns[rcvd++] = bench_now_ns(CLOCK_MONOTONIC) - run.send_ns[seq];
+    }
+    cpu_ns = bench_now_ns(CLOCK_THREAD_CPUTIME_ID) - cpu_start;
+    wall_ns = bench_now_ns(CLOCK_MONOTONIC) - wall_start;
+    __atomic_store_n(&run.stopped, 1, __ATOMIC_RELEASE);
+    pthread_join(producer, NULL);
+
+    if (rcvd == 0) {
+        /* every event was dropped, there is no per event cost or latency to report */
+        printf("%-8s %9u %9u %10s %10.0f %9s %9s %9.1f\n",
+               name, rate, BENCH_EVENTS, "-", (double)run.producer_cpu_ns / BENCH_EVENTS,
+               "-", "-", 0.0);
+    } else {
+        qsort(lat_ns, rcvd, sizeof(*lat_ns), bench_cmp_ull);
+        printf("%-8s %9u %9u %10.0f %10.0f %9.1f %9.1f %9.1f\n",
+               name, rate, BENCH_EVENTS - rcvd,
+               (double)cpu_ns / rcvd, (double)run.producer_cpu_ns / BENCH_EVENTS,
+               lat_ns[rcvd / 2] / 1000.0, lat_ns[rcvd * 99 / 100] / 1000.0,
+               rcvd * 1000.0 / wall_ns);
+    }
+
+    oes_api_event_fd_set(OES_ACCESS_CMD_DESTROY, &run.fd, NULL);
+    free(run.send_ns);
+    free(lat_ns);
+    return 0;
+}
+
+int
+main(void)
+{
+    static const unsigned int rates[] = { 10000, 200000, 0 };
+    unsigned int              i;
+
+    printf("%u events per run, hybrid busy poll %u usec, rate 0 = unpaced\n",
+           BENCH_EVENTS, BENCH_BUSY_USEC);
+    printf("%-8s %9s %9s %10s %10s %9s %9s %9s\n", "mode", "rate/s", "dropped",
+           "rx ns/ev", "tx ns/ev", "p50 us", "p99 us", "Mev/s");
+    for (i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        if (bench_mode("every", OES_EVENT_NOTIFY_EVERY_EVENT, rates[i]) ||
+            bench_mode("edge", OES_EVENT_NOTIFY_EDGE, rates[i]) ||
+            bench_mode("hybrid", OES_EVENT_NOTIFY_HYBRID, rates[i])) {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,172 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * VLAN flood set benchmark: 4094 VLANs on 64 trunk ports and 8 LAGs of
+ * 4 members, the VLANs spread over 16 MSTIs. Reports the flood lookup
+ * rate, and the cost of the changes that recompute flood sets: a port
+ * state change in an MSTI, a LAG member leaving, a distributor toggle
+ * and a port joining one VLAN.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_api_lag.h"
+#include "oes_api_stp.h"
+#include "oes_api_vlan.h"
+
+#define BENCH_BR          1
+#define BENCH_PORTS       64
+#define BENCH_LAGS        8
+#define BENCH_LAG_SIZE    4             /* LAG members are ports 100 and up */
+#define BENCH_MSTIS       16
+#define BENCH_VIDS        4094
+#define BENCH_LOOKUPS     (8 * 1024 * 1024)
+#define BENCH_CHANGES     1000
+
+static unsigned long long bench_rand_state = 88172645463325252ULL;
+
+static unsigned int
+bench_rand(void)
+{
+    bench_rand_state ^= bench_rand_state << 13;
+    bench_rand_state ^= bench_rand_state >> 7;
+    bench_rand_state ^= bench_rand_state << 17;
+    return (unsigned int)bench_rand_state;
+}
+
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int
+main(void)
+{
+    struct oes_vlan_port ports[BENCH_PORTS + BENCH_LAGS];
+    unsigned long        lag_ports[BENCH_LAGS], members[BENCH_LAG_SIZE], member;
+    unsigned long long   set[OES_BITMAP_WORDS(OES_MAX_PORTS)], acc = 0;
+    unsigned short       per_msti = BENCH_VIDS / BENCH_MSTIS, vid;
+    unsigned int         i, j, cnt = 0;
+    double               start, elapsed;
+
+    for (i = 0; i < BENCH_LAGS; i++) {
+        oes_api_lag_port_group_set(OES_ACCESS_CMD_CREATE, BENCH_BR, &lag_ports[i], NULL, 0, NULL);
+        for (j = 0; j < BENCH_LAG_SIZE; j++) {
+            members[j] = 100 + i * BENCH_LAG_SIZE + j;
+        }
+        oes_api_lag_port_group_set(OES_ACCESS_CMD_ADD, BENCH_BR, &lag_ports[i], members, BENCH_LAG_SIZE, NULL);
+        ports[BENCH_PORTS + i].log_port = lag_ports[i];
+        ports[BENCH_PORTS + i].tagging = OES_VLAN_TAGGED_MEMBER;
+    }
+    for (i = 0; i < BENCH_PORTS; i++) {
+        ports[i].log_port = i;
+        ports[i].tagging = OES_VLAN_TAGGED_MEMBER;
+    }
+    for (i = 1; i <= BENCH_MSTIS; i++) {
+        oes_api_stp_msti_set(OES_ACCESS_CMD_ADD, BENCH_BR, i, NULL);
+        oes_api_stp_msti_vlan_range_set(OES_ACCESS_CMD_ADD, BENCH_BR, i, 1 + (i - 1) * per_msti,
+                                        i * per_msti, NULL);
+    }
+    start = bench_now();
+    oes_api_vlan_ports_range_set(OES_ACCESS_CMD_ADD, BENCH_BR, 1, BENCH_VIDS, ports, BENCH_PORTS + BENCH_LAGS, NULL);
+    elapsed = bench_now() - start;
+    printf("members  %u ports and %u LAGs x %u VLANs with flood sets in %.3f ms\n", BENCH_PORTS, BENCH_LAGS,
+           BENCH_VIDS, elapsed * 1e3);
+
+    oes_vlan_flood_lookup(BENCH_BR, 1, OES_VLAN_FLOOD_TYPE_BC, set);
+    for (i = 0; i < OES_BITMAP_WORDS(OES_MAX_PORTS); i++) {
+        cnt += __builtin_popcountll(set[i]);
+    }
+    if (cnt != BENCH_PORTS + BENCH_LAGS) {
+        printf("vid 1 floods to %u ports, expected %u\n", cnt, BENCH_PORTS + BENCH_LAGS);
+        return 1;
+    }
+
+    start = bench_now();
+    for (i = 0; i < BENCH_LOOKUPS; i++) {
+        oes_vlan_flood_lookup(BENCH_BR, 1 + bench_rand() % BENCH_VIDS, OES_VLAN_FLOOD_TYPE_BC, set);
+        acc += set[0];
+    }
+    elapsed = bench_now() - start;
+    printf("lookup   %u flood lookups in %.3f s (%.2f M/s, %llx)\n", BENCH_LOOKUPS, elapsed,
+           BENCH_LOOKUPS / elapsed / 1e6, acc & 0xf);
+
+    start = bench_now();
+    for (i = 0; i < BENCH_CHANGES; i++) {
+        oes_api_stp_msti_port_state_set(BENCH_BR, 1 + i % BENCH_MSTIS, i % BENCH_PORTS,
+                                        (i / BENCH_MSTIS) % 2 ? OES_MSTP_INST_PORT_STATE_FORWARDING :
+                                        OES_MSTP_INST_PORT_STATE_DISCARDING, NULL);
+    }
+    elapsed = bench_now() - start;
+    printf("stp      port state change (%u VLANs recomputed) in %.1f us\n", per_msti,
+           elapsed * 1e6 / BENCH_CHANGES);
+
+    start = bench_now();
+    for (i = 0; i < BENCH_CHANGES; i++) {
+        member = 100 + (i % BENCH_LAGS) * BENCH_LAG_SIZE;
+        oes_api_lag_port_distributor_set(BENCH_BR, lag_ports[i % BENCH_LAGS], member,
+                                         (i / BENCH_LAGS) % 2 ? OES_DISTRIBUTOR_ENABLE :
+                                         OES_DISTRIBUTOR_DISABLE, NULL);
+    }
+    elapsed = bench_now() - start;
+    printf("lag      distributor toggle (%u VLANs recomputed) in %.1f us\n", BENCH_VIDS,
+           elapsed * 1e6 / BENCH_CHANGES);
+
+    start = bench_now();
+    for (i = 0; i < BENCH_CHANGES; i++) {
+        member = 100 + (i % BENCH_LAGS) * BENCH_LAG_SIZE + 1;
+        oes_api_lag_port_group_set((i / BENCH_LAGS) % 2 ? OES_ACCESS_CMD_ADD : OES_ACCESS_CMD_DELETE, BENCH_BR,
+                                   &lag_ports[i % BENCH_LAGS], &member, 1, NULL);
+    }
+    elapsed = bench_now() - start;
+    printf("lag      member leave/join (%u VLANs recomputed) in %.1f us\n", BENCH_VIDS,
+           elapsed * 1e6 / BENCH_CHANGES);
+
+    start = bench_now();
+    for (i = 0; i < BENCH_CHANGES; i++) {
+        vid = 1 + bench_rand() % BENCH_VIDS;
+        ports[0].log_port = BENCH_PORTS + i % 32;
+        oes_api_vlan_ports_set((i / 32) % 2 ? OES_ACCESS_CMD_DELETE : OES_ACCESS_CMD_ADD, BENCH_BR, vid,
+                               ports, 1, NULL);
+    }
+    elapsed = bench_now() - start;
+    printf("vlan     port join/leave (1 VLAN recomputed) in %.1f us\n", elapsed * 1e6 / BENCH_CHANGES);
+    return 0;
+}
@@ -0,0 +1,165 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * L3 check benchmark: TTL and MTU checks through
+ * oes_api_router_l3_check_batch over 256 router interfaces, in batches
+ * of 64. Traffic passing the checks gives the main path rate, which
+ * should hold with one packet in a thousand failing a check at random.
+ * One packet in four failing shows the cost of the fast path branch
+ * mispredicting.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_api_router.h"
+
+#define BENCH_RIFS        256
+#define BENCH_PKTS        (64 * 1024)
+#define BENCH_ROUNDS      128
+#define BENCH_BATCH       64
+
+static unsigned long long bench_rand_state = 88172645463325252ULL;
+
+static unsigned int
+bench_rand(void)
+{
+    bench_rand_state ^= bench_rand_state << 13;
+    bench_rand_state ^= bench_rand_state >> 7;
+    bench_rand_state ^= bench_rand_state << 17;
+    return (unsigned int)bench_rand_state;
+}
+
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned short bench_mtus[BENCH_RIFS];   /* MTU of rifs[i] */
+
+static void
+bench_traffic(struct oes_router_l3_pkt *pkts, unsigned int rifs[], unsigned int error_every)
+{
+    struct oes_router_l3_pkt *pkt_p;
+    unsigned int              i, n;
+
+    for (i = 0; i < BENCH_PKTS; i++) {
+        pkt_p = &pkts[i];
+        memset(pkt_p, 0, sizeof(*pkt_p));
+        n = bench_rand() % BENCH_RIFS;
+        pkt_p->action = OES_ROUTER_ACTION_FORWARD;
+        pkt_p->egress_rif = rifs[n];
+        pkt_p->ttl = 2 + bench_rand() % 254;
+        pkt_p->l3_len = 64 + bench_rand() % (bench_mtus[n] - 63);
+        if (error_every && (bench_rand() % error_every == 0)) {
+            switch (bench_rand() % 3) {
+            case 0:
+                pkt_p->ttl = 0;
+                break;
+
+            case 1:
+                pkt_p->ttl = 1;
+                break;
+
+            default:
+                pkt_p->l3_len = bench_mtus[n] + 1 + bench_rand() % 64;
+                break;
+            }
+        }
+    }
+}
+
+static void
+bench_run(const char *name, unsigned int vrid, const struct oes_router_l3_pkt *pkts)
+{
+    struct oes_router_l3_pkt work[BENCH_BATCH];
+    unsigned int             round, i, j, errors = 0;
+    double                   start, elapsed;
+
+    start = bench_now();
+    for (round = 0; round < BENCH_ROUNDS; round++) {
+        for (i = 0; i < BENCH_PKTS; i += BENCH_BATCH) {
+            memcpy(work, &pkts[i], sizeof(work));
+            oes_api_router_l3_check_batch(vrid, work, BENCH_BATCH);
+            for (j = 0; j < BENCH_BATCH; j++) {
+                errors += work[j].l3_error;
+            }
+        }
+    }
+    elapsed = bench_now() - start;
+    printf("%-10s %u packets in %.3f s (%.1f M/s, %u failing a check)\n", name,
+           BENCH_PKTS * BENCH_ROUNDS, elapsed, BENCH_PKTS * BENCH_ROUNDS / elapsed / 1e6, errors);
+}
+
+int
+main(void)
+{
+    struct oes_router_attributes       attr = { 1, 1, OES_ROUTER_ACTION_TRAP, OES_ROUTER_ACTION_TRAP };
+    static struct oes_router_l3_pkt    clean[BENCH_PKTS], rare[BENCH_PKTS], mixed[BENCH_PKTS];
+    struct oes_l3_interface_attributes ifc_attr;
+    struct oes_l3_interface            ifc;
+    unsigned int                       rifs[BENCH_RIFS];
+    unsigned int                       vrid, i;
+
+    oes_api_router_set(OES_ACCESS_CMD_ADD, &vrid, &attr, NULL);
+    memset(&ifc_attr, 0, sizeof(ifc_attr));
+    memset(&ifc, 0, sizeof(ifc));
+    ifc.type = OES_INTERFACE_TYPE_ROUTER_PORT;
+    for (i = 0; i < BENCH_RIFS; i++) {
+        ifc.ifc.port.port = i;
+        ifc_attr.mtu = (i % 2) ? 9000 : 1500;
+        if (oes_api_router_interface_set(OES_ACCESS_CMD_ADD, vrid, &rifs[i], &ifc, &ifc_attr,
+                                         NULL) != OES_STATUS_SUCCESS) {
+            printf("add of rif %u failed\n", i);
+            return 1;
+        }
+        bench_mtus[i] = ifc_attr.mtu;
+    }
+    bench_traffic(clean, rifs, 0);
+    bench_traffic(rare, rifs, 1000);
+    bench_traffic(mixed, rifs, 4);
+
+    bench_run("clean", vrid, clean);
+    bench_run("1/1000", vrid, rare);
+    bench_run("1/4", vrid, mixed);
+
+    oes_api_router_interface_set(OES_ACCESS_CMD_DELETE_ALL, vrid, NULL, NULL, NULL, NULL);
+    oes_api_router_set(OES_ACCESS_CMD_DELETE, &vrid, NULL, NULL);
+    return 0;
+}
@@ -0,0 +1,196 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Batch FIB lookup benchmark: loads 1M IPv4 and 200K IPv6 routes over a
+ * few hundred next hop groups, then resolves random destinations under
+ * them through oes_api_router_uc_route_lookup_batch, one address per
+ * call and in batches of BENCH_BATCH.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_api_router.h"
+
+#define BENCH_PREFIXES4   1000000
+#define BENCH_PREFIXES6   200000
+#define BENCH_NEXT_HOPS   64
+#define BENCH_LOOKUPS     (1 << 22)
+#define BENCH_BATCH       64
+
+static unsigned long long bench_rand_state = 88172645463325252ULL;
+
+static unsigned int
+bench_rand(void)
+{
+    bench_rand_state ^= bench_rand_state << 13;
+    bench_rand_state ^= bench_rand_state >> 7;
+    bench_rand_state ^= bench_rand_state << 17;
+    return (unsigned int)bench_rand_state;
+}
+
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* mostly /24, then /16-/23, a few longer */
+static void
+bench_prefix4(struct oes_ip_prefix *key_p)
+{
+    unsigned int r = bench_rand() % 100;
+    unsigned int len = (r < 60) ? 24 : (r < 95) ? 16 + bench_rand() % 8 : 25 + bench_rand() % 8;
+    unsigned int ip = (1 + bench_rand() % 223) << 24 | (bench_rand() & 0xffffff);
+
+    key_p->prefix.version = OES_IPV4;
+    key_p->prefix.addr.ipv4.s_addr = htonl(ip & (0xffffffffU << (32 - len)));
+    key_p->prefix_len = len;
+}
+
+/* /32 to /48 under 2001::/16 and 2a00::/16, mostly /48 */
+static void
+bench_prefix6(struct oes_ip_prefix *key_p)
+{
+    unsigned int len = (bench_rand() % 100 < 60) ? 48 : 32 + bench_rand() % 16;
+    unsigned int i;
+
+    memset(key_p, 0, sizeof(*key_p));
+    key_p->prefix.version = OES_IPV6;
+    key_p->prefix.addr.ipv6.s6_addr[0] = (bench_rand() & 1) ? 0x20 : 0x2a;
+    key_p->prefix.addr.ipv6.s6_addr[1] = (key_p->prefix.addr.ipv6.s6_addr[0] == 0x20) ? 0x01 : 0x00;
+    for (i = 2; i < 6; i++) {
+        key_p->prefix.addr.ipv6.s6_addr[i] = bench_rand();
+    }
+    if (len < 48) {
+        key_p->prefix.addr.ipv6.s6_addr[len / 8] &= (unsigned char)(0xff << (8 - len % 8));
+        for (i = len / 8 + 1; i < 6; i++) {
+            key_p->prefix.addr.ipv6.s6_addr[i] = 0;
+        }
+    }
+    key_p->prefix_len = len;
+}
+
+/* a random address under a prefix */
+static void
+bench_addr(const struct oes_ip_prefix *key_p, struct oes_ip_addr *ip_p)
+{
+    unsigned int i;
+
+    *ip_p = key_p->prefix;
+    if (ip_p->version == OES_IPV4) {
+        ip_p->addr.ipv4.s_addr |= htonl(bench_rand() & (unsigned int)((1ULL << (32 - key_p->prefix_len)) - 1));
+    } else {
+        for (i = 6; i < 16; i++) {
+            ip_p->addr.ipv6.s6_addr[i] = bench_rand();
+        }
+    }
+}
+
+static void
+bench_run(const char *name, unsigned int vrid, const struct oes_ip_addr *ips_p, unsigned int batch)
+{
+    static struct oes_uc_route_batch_lookup_data datas[BENCH_BATCH];
+    unsigned int                                 i, j, found = 0;
+    double                                       start, elapsed;
+
+    start = bench_now();
+    for (i = 0; i < BENCH_LOOKUPS; i += batch) {
+        oes_api_router_uc_route_lookup_batch(vrid, &ips_p[i], datas, batch);
+        for (j = 0; j < batch; j++) {
+            found += datas[j].found;
+        }
+    }
+    elapsed = bench_now() - start;
+    printf("%s %u lookups in batches of %2u in %.3f s (%.2f M/s, %u found)\n", name, BENCH_LOOKUPS,
+           batch, elapsed, BENCH_LOOKUPS / elapsed / 1e6, found);
+}
+
+int
+main(void)
+{
+    struct oes_router_attributes attr = { 1, 1, OES_ROUTER_ACTION_TRAP, OES_ROUTER_ACTION_TRAP };
+    struct oes_ip_prefix        *keys4_p = malloc(BENCH_PREFIXES4 * sizeof(*keys4_p));
+    struct oes_ip_prefix        *keys6_p = malloc(BENCH_PREFIXES6 * sizeof(*keys6_p));
+    struct oes_ip_addr          *ips4_p = malloc(BENCH_LOOKUPS * sizeof(*ips4_p));
+    struct oes_ip_addr          *ips6_p = malloc(BENCH_LOOKUPS * sizeof(*ips6_p));
+    struct oes_ip_addr           next_hops[BENCH_NEXT_HOPS + 4];
+    struct oes_uc_route_data     data;
+    unsigned int                 vrid, i;
+
+    oes_api_router_set(OES_ACCESS_CMD_ADD, &vrid, &attr, NULL);
+    memset(next_hops, 0, sizeof(next_hops));
+    for (i = 0; i < BENCH_NEXT_HOPS + 4; i++) {
+        next_hops[i].version = OES_IPV4;
+        next_hops[i].addr.ipv4.s_addr = htonl(0x0a000001 + i);
+    }
+    memset(&data, 0, sizeof(data));
+    data.action = OES_ROUTER_ACTION_FORWARD;
+
+    /* routes spread over BENCH_NEXT_HOPS * 4 groups of 1-4 next hops */
+    for (i = 0; i < BENCH_PREFIXES4 + BENCH_PREFIXES6; i++) {
+        struct oes_ip_prefix *key_p = (i < BENCH_PREFIXES4) ? &keys4_p[i] : &keys6_p[i - BENCH_PREFIXES4];
+
+        if (i < BENCH_PREFIXES4) {
+            bench_prefix4(key_p);
+        } else {
+            bench_prefix6(key_p);
+        }
+        data.next_hop_list = &next_hops[bench_rand() % BENCH_NEXT_HOPS];
+        data.next_hop_cnt = 1 + bench_rand() % 4;
+        oes_api_router_uc_route_set(OES_ACCESS_CMD_ADD, vrid, key_p, &data, NULL);
+    }
+    for (i = 0; i < BENCH_LOOKUPS; i++) {
+        bench_addr(&keys4_p[bench_rand() % BENCH_PREFIXES4], &ips4_p[i]);
+        bench_addr(&keys6_p[bench_rand() % BENCH_PREFIXES6], &ips6_p[i]);
+    }
+
+    bench_run("ipv4", vrid, ips4_p, 1);
+    bench_run("ipv4", vrid, ips4_p, BENCH_BATCH);
+    bench_run("ipv6", vrid, ips6_p, 1);
+    bench_run("ipv6", vrid, ips6_p, BENCH_BATCH);
+
+    oes_api_router_uc_route_set(OES_ACCESS_CMD_DELETE_ALL, vrid, NULL, NULL, NULL);
+    oes_api_router_set(OES_ACCESS_CMD_DELETE, &vrid, NULL, NULL);
+    free(keys4_p);
+    free(keys6_p);
+    free(ips4_p);
+    free(ips6_p);
+    return 0;
+}
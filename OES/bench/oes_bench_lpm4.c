@@ -0,0 +1,178 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * IPv4 FIB benchmark: loads a synthesized full table (~1M prefixes,
+ * internet like length distribution) through oes_api_router_uc_route_set,
+ * then measures batch lookups on the DIR-24-8 engine and route churn.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_api_router.h"
+#include "oes_router_lpm4.h"
+
+#define BENCH_PREFIXES    1000000
+#define BENCH_LOOKUPS     (1 << 24)
+#define BENCH_BATCH       64
+#define BENCH_CHURN       200000
+
+static unsigned long long bench_rand_state = 88172645463325252ULL;
+
+static unsigned int
+bench_rand(void)
+{
+    bench_rand_state ^= bench_rand_state << 13;
+    bench_rand_state ^= bench_rand_state >> 7;
+    bench_rand_state ^= bench_rand_state << 17;
+    return (unsigned int)bench_rand_state;
+}
+
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* rough shape of a BGP table: mostly /24, then /16-/23, few short and long */
+static unsigned int
+bench_prefix_len(void)
+{
+    unsigned int r = bench_rand() % 1000;
+
+    if (r < 600) {
+        return 24;
+    }
+    if (r < 750) {
+        return 22 + bench_rand() % 2;
+    }
+    if (r < 950) {
+        return 16 + bench_rand() % 6;
+    }
+    if (r < 955) {
+        return 8 + bench_rand() % 8;
+    }
+    return 25 + bench_rand() % 8;
+}
+
+static void
+bench_prefix(struct oes_ip_prefix *key_p)
+{
+    unsigned int len = bench_prefix_len();
+    unsigned int ip = (1 + bench_rand() % 223) << 24 | (bench_rand() & 0xffffff);
+
+    key_p->prefix.version = OES_IPV4;
+    key_p->prefix.addr.ipv4.s_addr = htonl(ip & (0xffffffffU << (32 - len)));
+    key_p->prefix_len = len;
+}
+
+int
+main(void)
+{
+    struct oes_router_attributes attr = { 1, 1, OES_ROUTER_ACTION_TRAP, OES_ROUTER_ACTION_TRAP };
+    struct oes_ip_prefix        *keys_p = malloc(BENCH_PREFIXES * sizeof(*keys_p));
+    struct oes_ip_addr           next_hop[4];
+    struct oes_uc_route_data     data;
+    struct oes_lpm4             *lpm_p;
+    unsigned int                *ips_p = malloc(BENCH_LOOKUPS * sizeof(*ips_p));
+    unsigned int                 nhs[BENCH_BATCH];
+    unsigned int                 vrid, i, j, hits = 0;
+    double                       start, elapsed;
+
+    oes_api_router_set(OES_ACCESS_CMD_ADD, &vrid, &attr, NULL);
+    memset(next_hop, 0, sizeof(next_hop));
+    for (i = 0; i < 4; i++) {
+        next_hop[i].version = OES_IPV4;
+        next_hop[i].addr.ipv4.s_addr = htonl(0x0a000001 + i);
+    }
+    memset(&data, 0, sizeof(data));
+    data.action = OES_ROUTER_ACTION_FORWARD;
+    data.next_hop_list = next_hop;
+
+    for (i = 0; i < BENCH_PREFIXES; i++) {
+        bench_prefix(&keys_p[i]);
+    }
+    start = bench_now();
+    for (i = 0; i < BENCH_PREFIXES; i++) {
+        data.next_hop_cnt = 1 + i % 4;
+        oes_api_router_uc_route_set(OES_ACCESS_CMD_ADD, vrid, &keys_p[i], &data, NULL);
+    }
+    elapsed = bench_now() - start;
+    printf("load     %u prefixes in %.3f s (%.2f M routes/s)\n",
+           BENCH_PREFIXES, elapsed, BENCH_PREFIXES / elapsed / 1e6);
+
+    /* the engine is reached directly: the API layer has no lookup yet */
+    lpm_p = oes_lpm4_create();
+    for (i = 0; i < BENCH_PREFIXES; i++) {
+        oes_lpm4_add(lpm_p, ntohl(keys_p[i].prefix.addr.ipv4.s_addr), keys_p[i].prefix_len, i);
+    }
+    for (i = 0; i < BENCH_LOOKUPS; i++) {
+        ips_p[i] = bench_rand();
+    }
+    start = bench_now();
+    for (i = 0; i < BENCH_LOOKUPS; i += BENCH_BATCH) {
+        oes_lpm4_lookup_bulk(lpm_p, &ips_p[i], nhs, BENCH_BATCH);
+        for (j = 0; j < BENCH_BATCH; j++) {
+            hits += (nhs[j] != OES_LPM4_NO_NEXT_HOP);
+        }
+    }
+    elapsed = bench_now() - start;
+    printf("lookup   %u random addresses in %.3f s (%.1f M lookups/s, %.1f%% hit, %u tbl8 groups)\n",
+           BENCH_LOOKUPS, elapsed, BENCH_LOOKUPS / elapsed / 1e6,
+           100.0 * hits / BENCH_LOOKUPS, lpm_p->tbl8_used);
+
+    start = bench_now();
+    for (i = 0; i < BENCH_CHURN; i++) {
+        oes_api_router_uc_route_set(OES_ACCESS_CMD_DELETE, vrid, &keys_p[i], NULL, NULL);
+    }
+    for (i = 0; i < BENCH_CHURN; i++) {
+        data.next_hop_cnt = 1;
+        oes_api_router_uc_route_set(OES_ACCESS_CMD_ADD, vrid, &keys_p[i], &data, NULL);
+    }
+    elapsed = bench_now() - start;
+    printf("churn    %u withdraw + %u announce in %.3f s (%.2f M ops/s)\n",
+           BENCH_CHURN, BENCH_CHURN, elapsed, 2.0 * BENCH_CHURN / elapsed / 1e6);
+
+    oes_api_router_uc_route_set(OES_ACCESS_CMD_DELETE_ALL, vrid, NULL, NULL, NULL);
+    oes_api_router_set(OES_ACCESS_CMD_DELETE, &vrid, NULL, NULL);
+    oes_lpm4_destroy(lpm_p);
+    free(keys_p);
+    free(ips_p);
+    return 0;
+}
@@ -0,0 +1,220 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * IPv6 FIB benchmark: builds a synthesized 200K prefix table shaped
+ * like today's global table (mostly /48, then /32, /44, /40, /29 and a
+ * few /56-/64 under a few thousand allocations), then reports memory
+ * per prefix, lookup rate and update rate of the tree bitmap engine.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_api_router.h"
+#include "oes_router_lpm6.h"
+
+#define BENCH_PREFIXES    200000
+#define BENCH_ALLOCS      12000
+#define BENCH_LOOKUPS     (1 << 22)
+#define BENCH_BATCH       64
+#define BENCH_CHURN       100000
+
+static unsigned long long bench_rand_state = 88172645463325252ULL;
+
+static unsigned int
+bench_rand(void)
+{
+    bench_rand_state ^= bench_rand_state << 13;
+    bench_rand_state ^= bench_rand_state >> 7;
+    bench_rand_state ^= bench_rand_state << 17;
+    return (unsigned int)bench_rand_state;
+}
+
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned int
+bench_prefix_len(void)
+{
+    unsigned int r = bench_rand() % 100;
+
+    if (r < 48) {
+        return 48;
+    }
+    if (r < 63) {
+        return 32;
+    }
+    if (r < 71) {
+        return 44;
+    }
+    if (r < 76) {
+        return 40;
+    }
+    if (r < 79) {
+        return 29;
+    }
+    if (r < 82) {
+        return 36;
+    }
+    if (r < 94) {
+        return 33 + bench_rand() % 15;
+    }
+    if (r < 98) {
+        return 56;
+    }
+    return 64;
+}
+
+static void
+bench_mask(unsigned char *addr, unsigned int len)
+{
+    unsigned int i;
+
+    for (i = 0; i < 16; i++) {
+        if (len >= 8 * (i + 1)) {
+            continue;
+        }
+        addr[i] &= (len > 8 * i) ? (unsigned char)(0xff << (8 - (len - 8 * i))) : 0;
+    }
+}
+
+int
+main(void)
+{
+    static const unsigned short tops[] = { 0x2001, 0x2400, 0x2401, 0x2402, 0x2403, 0x2404,
+                                           0x2600, 0x2601, 0x2602, 0x2603, 0x2604, 0x2605,
+                                           0x2800, 0x2801, 0x2a00, 0x2a01, 0x2a02, 0x2a03,
+                                           0x2a04, 0x2a05, 0x2a06, 0x2a0a, 0x2a0b, 0x2c0f };
+    struct oes_router_attributes attr = { 1, 1, OES_ROUTER_ACTION_TRAP, OES_ROUTER_ACTION_TRAP };
+    struct oes_ip_prefix        *keys_p = calloc(BENCH_PREFIXES, sizeof(*keys_p));
+    unsigned char              (*allocs_p)[16] = calloc(BENCH_ALLOCS, 16);
+    unsigned char              (*addrs_p)[16] = malloc((size_t)BENCH_LOOKUPS * 16);
+    struct oes_ip_addr           next_hop;
+    struct oes_uc_route_data     data;
+    struct oes_lpm6             *lpm_p;
+    unsigned int                 nhs[BENCH_BATCH];
+    unsigned int                 vrid, i, j, len, hits = 0;
+    double                       start, elapsed;
+
+    for (i = 0; i < BENCH_ALLOCS; i++) {
+        unsigned short top = tops[bench_rand() % (sizeof(tops) / sizeof(tops[0]))];
+
+        allocs_p[i][0] = top >> 8;
+        allocs_p[i][1] = top & 0xff;
+        allocs_p[i][2] = bench_rand();
+        allocs_p[i][3] = bench_rand() & 0xf8;
+    }
+    for (i = 0; i < BENCH_PREFIXES; i++) {
+        unsigned char *addr = keys_p[i].prefix.addr.ipv6.s6_addr;
+
+        len = bench_prefix_len();
+        memcpy(addr, allocs_p[bench_rand() % BENCH_ALLOCS], 16);
+        for (j = (len < 32) ? 3 : 4; j < 8; j++) {
+            /* subnets cluster at the low end of an allocation */
+            addr[j] = (j < 6) ? bench_rand() % 8 : bench_rand();
+        }
+        bench_mask(addr, len);
+        keys_p[i].prefix.version = OES_IPV6;
+        keys_p[i].prefix_len = len;
+    }
+
+    oes_api_router_set(OES_ACCESS_CMD_ADD, &vrid, &attr, NULL);
+    memset(&next_hop, 0, sizeof(next_hop));
+    next_hop.version = OES_IPV6;
+    next_hop.addr.ipv6.s6_addr[15] = 1;
+    memset(&data, 0, sizeof(data));
+    data.action = OES_ROUTER_ACTION_FORWARD;
+    data.next_hop_list = &next_hop;
+    data.next_hop_cnt = 1;
+    start = bench_now();
+    for (i = 0; i < BENCH_PREFIXES; i++) {
+        oes_api_router_uc_route_set(OES_ACCESS_CMD_ADD, vrid, &keys_p[i], &data, NULL);
+    }
+    elapsed = bench_now() - start;
+    printf("load     %u prefixes through the API in %.3f s (%.2f M routes/s)\n",
+           BENCH_PREFIXES, elapsed, BENCH_PREFIXES / elapsed / 1e6);
+
+    lpm_p = oes_lpm6_create();
+    start = bench_now();
+    for (i = 0; i < BENCH_PREFIXES; i++) {
+        oes_lpm6_add(lpm_p, keys_p[i].prefix.addr.ipv6.s6_addr, keys_p[i].prefix_len, i);
+    }
+    elapsed = bench_now() - start;
+    printf("build    %u unique prefixes in %.3f s, %llu bytes (%.1f bytes/prefix), %u nodes\n",
+           lpm_p->rules_cnt, elapsed, oes_lpm6_mem_size(lpm_p),
+           (double)oes_lpm6_mem_size(lpm_p) / lpm_p->rules_cnt, lpm_p->nodes_cnt);
+
+    for (i = 0; i < BENCH_LOOKUPS; i++) {
+        memcpy(addrs_p[i], keys_p[bench_rand() % BENCH_PREFIXES].prefix.addr.ipv6.s6_addr, 16);
+        for (j = 8; j < 16; j++) {
+            addrs_p[i][j] = bench_rand();
+        }
+    }
+    start = bench_now();
+    for (i = 0; i < BENCH_LOOKUPS; i += BENCH_BATCH) {
+        oes_lpm6_lookup_bulk(lpm_p, &addrs_p[i], nhs, BENCH_BATCH);
+        for (j = 0; j < BENCH_BATCH; j++) {
+            hits += (nhs[j] != OES_LPM6_NO_NEXT_HOP);
+        }
+    }
+    elapsed = bench_now() - start;
+    printf("lookup   %u addresses in %.3f s (%.1f M lookups/s, %.1f%% hit)\n",
+           BENCH_LOOKUPS, elapsed, BENCH_LOOKUPS / elapsed / 1e6, 100.0 * hits / BENCH_LOOKUPS);
+
+    start = bench_now();
+    for (i = 0; i < BENCH_CHURN; i++) {
+        oes_lpm6_delete(lpm_p, keys_p[i].prefix.addr.ipv6.s6_addr, keys_p[i].prefix_len);
+    }
+    for (i = 0; i < BENCH_CHURN; i++) {
+        oes_lpm6_add(lpm_p, keys_p[i].prefix.addr.ipv6.s6_addr, keys_p[i].prefix_len, i);
+    }
+    elapsed = bench_now() - start;
+    printf("update   %u delete + %u add in %.3f s (%.2f M updates/s)\n",
+           BENCH_CHURN, BENCH_CHURN, elapsed, 2.0 * BENCH_CHURN / elapsed / 1e6);
+
+    oes_api_router_uc_route_set(OES_ACCESS_CMD_DELETE_ALL, vrid, NULL, NULL, NULL);
+    oes_api_router_set(OES_ACCESS_CMD_DELETE, &vrid, NULL, NULL);
+    oes_lpm6_destroy(lpm_p);
+    free(keys_p);
+    free(allocs_p);
+    free(addrs_p);
+    return 0;
+}
@@ -0,0 +1,194 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Multicast route benchmark: 32K mroutes, 4K groups with one (*,G) route
+ * and seven (S,G) routes each, using 64 distinct egress rif lists.
+ * Reports add and lookup rates for (S,G) hits and (*,G) fallbacks, the
+ * rate of egress rif add/delete on loaded routes, and the table memory
+ * with shared egress rif sets.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_api_router.h"
+#include "oes_router_mc.h"
+
+#define BENCH_GROUPS      4096
+#define BENCH_SOURCES     7             /* (S,G) routes per group, plus (*,G) */
+#define BENCH_ROUTES      (BENCH_GROUPS * (BENCH_SOURCES + 1))
+#define BENCH_RIF_SETS    64
+#define BENCH_SET_RIFS    8
+#define BENCH_INGRESS     16
+#define BENCH_LOOKUPS     (4 * 1024 * 1024)
+
+static unsigned long long bench_rand_state = 88172645463325252ULL;
+
+static unsigned int
+bench_rand(void)
+{
+    bench_rand_state ^= bench_rand_state << 13;
+    bench_rand_state ^= bench_rand_state >> 7;
+    bench_rand_state ^= bench_rand_state << 17;
+    return (unsigned int)bench_rand_state;
+}
+
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* route i: group i / 8 on ingress rif group % 16, source i % 8 (0 is *,G) */
+static void
+bench_route(unsigned int i, struct oes_ip_addr *group_p, struct oes_ip_addr *source_p, unsigned int *rif_p)
+{
+    unsigned int group = i / (BENCH_SOURCES + 1);
+
+    memset(group_p, 0, sizeof(*group_p));
+    memset(source_p, 0, sizeof(*source_p));
+    group_p->version = OES_IPV4;
+    group_p->addr.ipv4.s_addr = htonl(0xe8000000 | group);
+    source_p->version = OES_IPV4;
+    if (i % (BENCH_SOURCES + 1)) {
+        source_p->addr.ipv4.s_addr = htonl(0x0a000000 | (group << 4) | (i % (BENCH_SOURCES + 1)));
+    }
+    *rif_p = group % BENCH_INGRESS;
+}
+
+/* egress rif list set of route i */
+static void
+bench_rifs(unsigned int i, unsigned int *rif_list_p)
+{
+    unsigned int set = (i * 2654435761U) % BENCH_RIF_SETS, r;
+
+    for (r = 0; r < BENCH_SET_RIFS; r++) {
+        rif_list_p[r] = BENCH_INGRESS + set * BENCH_SET_RIFS + r;
+    }
+}
+
+int
+main(void)
+{
+    struct oes_router_attributes    attr = { 1, 1, OES_ROUTER_ACTION_TRAP, OES_ROUTER_ACTION_TRAP };
+    struct oes_mc_route_lookup_data lookup_data;
+    struct oes_mc_route_data        data;
+    struct oes_mc_route_key         key;
+    struct oes_ip_addr              group, source;
+    struct oes_mc_table             table;
+    struct oes_mc_key               mc_key;
+    unsigned long long              rifs[OES_MC_RIF_WORDS];
+    unsigned int                    rif_list[BENCH_SET_RIFS], extra_rif;
+    unsigned int                    vrid, rif, i, r, idx, hits = 0, star_g = 0;
+    double                          start, elapsed;
+
+    oes_api_router_set(OES_ACCESS_CMD_ADD, &vrid, &attr, NULL);
+    memset(&data, 0, sizeof(data));
+    data.action.action = OES_ROUTER_ACTION_FORWARD;
+    data.rif_list = rif_list;
+    data.rif_cnt = BENCH_SET_RIFS;
+    key.mc_gruop_ip = &group;
+    key.sender_ip = &source;
+
+    start = bench_now();
+    for (i = 0; i < BENCH_ROUTES; i++) {
+        bench_route(i, &group, &source, &key.ingress_rif);
+        bench_rifs(i, rif_list);
+        if (oes_api_router_mc_route_set(OES_ACCESS_CMD_ADD, vrid, &key, &data, NULL) != OES_STATUS_SUCCESS) {
+            printf("add of mroute %u failed\n", i);
+            return 1;
+        }
+    }
+    elapsed = bench_now() - start;
+    printf("add      %u mroutes in %.3f s (%.2f M/s)\n", BENCH_ROUTES, elapsed,
+           BENCH_ROUTES / elapsed / 1e6);
+
+    /* half the packets come from a source without an (S,G) route */
+    start = bench_now();
+    for (i = 0; i < BENCH_LOOKUPS; i++) {
+        bench_route(bench_rand() % BENCH_ROUTES, &group, &source, &rif);
+        if (source.addr.ipv4.s_addr == 0) {
+            source.addr.ipv4.s_addr = htonl(0x0b000001);
+        }
+        if (oes_api_router_mc_route_lookup(vrid, &group, &source, rif, &lookup_data) == OES_STATUS_SUCCESS) {
+            hits++;
+            star_g += lookup_data.star_g;
+        }
+    }
+    elapsed = bench_now() - start;
+    printf("lookup   %u packets in %.3f s (%.2f M/s, %u hits, %u (*,G) fallbacks)\n", BENCH_LOOKUPS,
+           elapsed, BENCH_LOOKUPS / elapsed / 1e6, hits, star_g);
+
+    start = bench_now();
+    for (i = 0; i < BENCH_ROUTES; i++) {
+        bench_route(i, &group, &source, &key.ingress_rif);
+        extra_rif = BENCH_INGRESS + BENCH_RIF_SETS * BENCH_SET_RIFS + i % 64;
+        oes_api_router_mc_egress_rif_set(OES_ACCESS_CMD_ADD, vrid, &key, &extra_rif, 1, NULL);
+        oes_api_router_mc_egress_rif_set(OES_ACCESS_CMD_DELETE, vrid, &key, &extra_rif, 1, NULL);
+    }
+    elapsed = bench_now() - start;
+    printf("egress   %u rif add+delete pairs in %.3f s (%.2f M/s)\n", BENCH_ROUTES, elapsed,
+           BENCH_ROUTES / elapsed / 1e6);
+
+    start = bench_now();
+    oes_api_router_mc_route_set(OES_ACCESS_CMD_DELETE_ALL, vrid, NULL, NULL, NULL);
+    elapsed = bench_now() - start;
+    printf("flush    %u mroutes in %.1f us\n", BENCH_ROUTES, elapsed * 1e6);
+    oes_api_router_set(OES_ACCESS_CMD_DELETE, &vrid, NULL, NULL);
+
+    oes_mc_table_init(&table);
+    for (i = 0; i < BENCH_ROUTES; i++) {
+        bench_route(i, &group, &source, &rif);
+        bench_rifs(i, rif_list);
+        memset(rifs, 0, sizeof(rifs));
+        for (r = 0; r < BENCH_SET_RIFS; r++) {
+            OES_BITMAP_SET(rifs, rif_list[r]);
+        }
+        oes_mc_key_set(&mc_key, &group, &source, rif);
+        if ((oes_mc_add(&table, &mc_key, &idx) != OES_STATUS_SUCCESS) ||
+            (oes_mc_oifs_set(&table, idx, rifs) != OES_STATUS_SUCCESS)) {
+            printf("table add of mroute %u failed\n", i);
+            return 1;
+        }
+    }
+    printf("memory   %u mroutes, %u egress rif sets, %.1f MB (%.0f bytes per mroute)\n",
+           table.cnt, table.oifs_cnt, oes_mc_mem_size(&table) / 1e6,
+           (double)oes_mc_mem_size(&table) / table.cnt);
+    oes_mc_table_deinit(&table);
+    return 0;
+}
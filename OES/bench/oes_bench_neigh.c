@@ -0,0 +1,164 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Neighbour table benchmark: 256K IPv4/IPv6 neighbours over 256 router
+ * interfaces, loaded through oes_api_router_neigh_set. Reports add,
+ * exact get and full table paging rates, and the cost of deleting the
+ * neighbours of one interface.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_api_router.h"
+
+#define BENCH_NEIGHS      (256 * 1024)
+#define BENCH_IPV6_EVERY  4             /* one IPv6 neighbour in four */
+#define BENCH_RIFS        256
+#define BENCH_PAGE        256
+
+static unsigned long long bench_rand_state = 88172645463325252ULL;
+
+static unsigned int
+bench_rand(void)
+{
+    bench_rand_state ^= bench_rand_state << 13;
+    bench_rand_state ^= bench_rand_state >> 7;
+    bench_rand_state ^= bench_rand_state << 17;
+    return (unsigned int)bench_rand_state;
+}
+
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* neighbour i sits on rif i % BENCH_RIFS */
+static void
+bench_neigh(unsigned int i, struct oes_ip_addr *ip_p)
+{
+    memset(ip_p, 0, sizeof(*ip_p));
+    if (i % BENCH_IPV6_EVERY == 0) {
+        ip_p->version = OES_IPV6;
+        ip_p->addr.ipv6.s6_addr[0] = 0x20;
+        ip_p->addr.ipv6.s6_addr[1] = 0x01;
+        ip_p->addr.ipv6.s6_addr[7] = i % BENCH_RIFS;
+        ip_p->addr.ipv6.s6_addr[13] = i >> 16;
+        ip_p->addr.ipv6.s6_addr[14] = i >> 8;
+        ip_p->addr.ipv6.s6_addr[15] = i;
+    } else {
+        ip_p->version = OES_IPV4;
+        ip_p->addr.ipv4.s_addr = htonl(0x0a000000 | i);
+    }
+}
+
+int
+main(void)
+{
+    struct oes_router_attributes attr = { 1, 1, OES_ROUTER_ACTION_TRAP, OES_ROUTER_ACTION_TRAP };
+    static struct oes_ip_addr    keys[BENCH_PAGE];
+    static struct oes_neigh_data datas[BENCH_PAGE];
+    struct ether_addr            mac = { { 0x00, 0x02, 0xc9, 0x00, 0x00, 0x01 } };
+    struct oes_neigh_data        data;
+    struct oes_ip_addr           ip;
+    unsigned short               cnt;
+    unsigned int                 vrid, i, total, found = 0;
+    double                       start, elapsed;
+
+    oes_api_router_set(OES_ACCESS_CMD_ADD, &vrid, &attr, NULL);
+    memset(&data, 0, sizeof(data));
+    data.mac_addr = &mac;
+    data.action = OES_ROUTER_ACTION_FORWARD;
+
+    start = bench_now();
+    for (i = 0; i < BENCH_NEIGHS; i++) {
+        bench_neigh(i, &ip);
+        data.rif = i % BENCH_RIFS;
+        if (oes_api_router_neigh_set(OES_ACCESS_CMD_ADD, vrid, &ip, &data, NULL) != OES_STATUS_SUCCESS) {
+            printf("add of neighbour %u failed\n", i);
+            return 1;
+        }
+    }
+    elapsed = bench_now() - start;
+    printf("add      %u neighbours in %.3f s (%.2f M/s)\n", BENCH_NEIGHS, elapsed,
+           BENCH_NEIGHS / elapsed / 1e6);
+
+    start = bench_now();
+    for (i = 0; i < BENCH_NEIGHS; i++) {
+        bench_neigh(bench_rand() % BENCH_NEIGHS, &ip);
+        cnt = 1;
+        datas[0].mac_addr = NULL;
+        found += (oes_api_router_neigh_get(OES_ACCESS_CMD_GET, vrid, &ip, datas, &cnt, NULL) ==
+                  OES_STATUS_SUCCESS);
+    }
+    elapsed = bench_now() - start;
+    printf("get      %u exact gets in %.3f s (%.2f M/s, %u found)\n", BENCH_NEIGHS, elapsed,
+           BENCH_NEIGHS / elapsed / 1e6, found);
+
+    memset(datas, 0, sizeof(datas));
+    start = bench_now();
+    cnt = BENCH_PAGE;
+    oes_api_router_neigh_get(OES_ACCESS_CMD_GET_FIRST, vrid, keys, datas, &cnt, NULL);
+    for (total = cnt; cnt == BENCH_PAGE; total += cnt) {
+        keys[0] = keys[BENCH_PAGE - 1];
+        oes_api_router_neigh_get(OES_ACCESS_CMD_GET_NEXT, vrid, keys, datas, &cnt, NULL);
+    }
+    elapsed = bench_now() - start;
+    printf("page     %u neighbours in pages of %u in %.3f s (%.2f M/s)\n", total, BENCH_PAGE,
+           elapsed, total / elapsed / 1e6);
+
+    data.rif = 7;
+    start = bench_now();
+    oes_api_router_neigh_set(OES_ACCESS_CMD_DELETE_ALL, vrid, NULL, &data, NULL);
+    elapsed = bench_now() - start;
+    printf("flush    rif %u (%u neighbours) in %.1f us\n", data.rif, BENCH_NEIGHS / BENCH_RIFS,
+           elapsed * 1e6);
+
+    start = bench_now();
+    for (i = 0; i < BENCH_NEIGHS; i++) {
+        bench_neigh(i, &ip);
+        oes_api_router_neigh_set(OES_ACCESS_CMD_DELETE, vrid, &ip, NULL, NULL);
+    }
+    elapsed = bench_now() - start;
+    printf("delete   %u neighbours in %.3f s (%.2f M/s)\n", BENCH_NEIGHS, elapsed,
+           BENCH_NEIGHS / elapsed / 1e6);
+
+    oes_api_router_set(OES_ACCESS_CMD_DELETE, &vrid, NULL, NULL);
+    return 0;
+}
@@ -0,0 +1,172 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Next hop group benchmark: 1M routes spread over 500 distinct ECMP
+ * sets. Compares the heap used by per-route next hop copies with the
+ * heap used by interned groups plus 8 byte route records, and times
+ * interning and an in-place group update.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_router_activity.h"
+#include "oes_router_nhg.h"
+
+#define BENCH_ROUTES      1000000
+#define BENCH_SETS        500
+#define BENCH_MAX_NH      16
+
+/* the route record layout before next hop groups */
+struct bench_route_copy {
+    enum oes_router_action  action;
+    unsigned short          next_hop_cnt;
+    unsigned char           activity;
+    struct oes_ip_addr    * next_hop_list;
+    unsigned int            next_free;
+};
+
+struct bench_route_nhg {
+    unsigned int  nhg_id;
+    unsigned char action;
+    unsigned char activity;
+};
+
+static unsigned long long bench_rand_state = 88172645463325252ULL;
+
+static unsigned int
+bench_rand(void)
+{
+    bench_rand_state ^= bench_rand_state << 13;
+    bench_rand_state ^= bench_rand_state >> 7;
+    bench_rand_state ^= bench_rand_state << 17;
+    return (unsigned int)bench_rand_state;
+}
+
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static size_t
+bench_heap(void)
+{
+    return mallinfo2().uordblks;
+}
+
+int
+main(void)
+{
+    static struct oes_ip_addr sets[BENCH_SETS][BENCH_MAX_NH];
+    static unsigned short     set_cnt[BENCH_SETS];
+    struct bench_route_copy  *copies_p;
+    struct bench_route_nhg   *routes_p;
+    struct oes_nhg_table      nhgs;
+    struct oes_ip_addr        shuffled[BENCH_MAX_NH];
+    unsigned int              i, j, s;
+    size_t                    heap, copy_bytes, nhg_bytes;
+    double                    start, elapsed;
+
+    for (s = 0; s < BENCH_SETS; s++) {
+        set_cnt[s] = 2 + bench_rand() % (BENCH_MAX_NH - 1);
+        for (j = 0; j < set_cnt[s]; j++) {
+            memset(&sets[s][j], 0, sizeof(sets[s][j]));
+            sets[s][j].version = OES_IPV4;
+            sets[s][j].addr.ipv4.s_addr = htonl(0x0a000000 | (s << 8) | j);
+        }
+    }
+
+    heap = bench_heap();
+    copies_p = calloc(BENCH_ROUTES, sizeof(*copies_p));
+    for (i = 0; i < BENCH_ROUTES; i++) {
+        s = bench_rand() % BENCH_SETS;
+        copies_p[i].action = OES_ROUTER_ACTION_FORWARD;
+        copies_p[i].next_hop_cnt = set_cnt[s];
+        copies_p[i].next_hop_list = malloc(set_cnt[s] * sizeof(struct oes_ip_addr));
+        memcpy(copies_p[i].next_hop_list, sets[s], set_cnt[s] * sizeof(struct oes_ip_addr));
+    }
+    copy_bytes = bench_heap() - heap;
+    for (i = 0; i < BENCH_ROUTES; i++) {
+        free(copies_p[i].next_hop_list);
+    }
+    free(copies_p);
+
+    heap = bench_heap();
+    oes_nhg_table_init(&nhgs, NULL, NULL);
+    routes_p = calloc(BENCH_ROUTES, sizeof(*routes_p));
+    start = bench_now();
+    for (i = 0; i < BENCH_ROUTES; i++) {
+        s = bench_rand() % BENCH_SETS;
+        /* members arrive in any order */
+        for (j = 0; j < set_cnt[s]; j++) {
+            shuffled[j] = sets[s][(j + i) % set_cnt[s]];
+        }
+        routes_p[i].action = OES_ROUTER_ACTION_FORWARD;
+        oes_nhg_get(&nhgs, shuffled, set_cnt[s], &routes_p[i].nhg_id);
+    }
+    elapsed = bench_now() - start;
+    nhg_bytes = bench_heap() - heap;
+
+    printf("copies   %u routes, %u sets: %zu bytes (%.1f bytes/route)\n",
+           BENCH_ROUTES, BENCH_SETS, copy_bytes, (double)copy_bytes / BENCH_ROUTES);
+    printf("groups   %u routes, %u groups: %zu bytes (%.1f bytes/route), %.1fx smaller\n",
+           BENCH_ROUTES, nhgs.cnt, nhg_bytes, (double)nhg_bytes / BENCH_ROUTES,
+           (double)copy_bytes / nhg_bytes);
+    printf("intern   %.2f M routes/s\n", BENCH_ROUTES / elapsed / 1e6);
+
+    start = bench_now();
+    for (s = 1; s <= BENCH_SETS; s++) {
+        const struct oes_nhg *nhg_p = oes_nhg_entry(&nhgs, s);
+
+        memcpy(shuffled, nhg_p->members, nhg_p->cnt * sizeof(*shuffled));
+        oes_nhg_members_set(&nhgs, s, shuffled, nhg_p->cnt - 1);
+    }
+    elapsed = bench_now() - start;
+    printf("update   %u groups shrunk in %.3f ms, repointing %u routes\n",
+           BENCH_SETS, elapsed * 1e3, BENCH_ROUTES);
+
+    for (i = 0; i < BENCH_ROUTES; i++) {
+        oes_nhg_put(&nhgs, routes_p[i].nhg_id);
+    }
+    printf("release  %u groups left\n", nhgs.cnt);
+    oes_nhg_table_deinit(&nhgs);
+    free(routes_p);
+    return 0;
+}
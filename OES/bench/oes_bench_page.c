@@ -0,0 +1,183 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Route paging benchmark: loads a synthesized full table (~900K IPv4
+ * and 150K IPv6 prefixes over 16 next hops), then dumps it through
+ * oes_api_router_uc_route_get GET_FIRST/GET_NEXT in pages of 256, and
+ * times single pages resumed from random keys all over the table. A
+ * page should cost the same at the start and at the end of the table.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_api_router.h"
+
+#define BENCH_PREFIXES4   900000
+#define BENCH_PREFIXES6   150000
+#define BENCH_NHS         16
+#define BENCH_PAGE        256
+#define BENCH_PAGE_NHS    4             /* next hop room per route */
+#define BENCH_RESUMES     10000
+
+static unsigned long long bench_rand_state = 88172645463325252ULL;
+
+static unsigned int
+bench_rand(void)
+{
+    bench_rand_state ^= bench_rand_state << 13;
+    bench_rand_state ^= bench_rand_state >> 7;
+    bench_rand_state ^= bench_rand_state << 17;
+    return (unsigned int)bench_rand_state;
+}
+
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* rough shape of a BGP table: mostly /24, then /16-/23, few long */
+static void
+bench_prefix4(struct oes_ip_prefix *key_p)
+{
+    unsigned int r = bench_rand() % 1000;
+    unsigned int len = (r < 600) ? 24 : (r < 950) ? 16 + bench_rand() % 8 : 25 + bench_rand() % 8;
+    unsigned int ip = (1 + bench_rand() % 223) << 24 | (bench_rand() & 0xffffff);
+
+    memset(key_p, 0, sizeof(*key_p));
+    key_p->prefix.version = OES_IPV4;
+    key_p->prefix.addr.ipv4.s_addr = htonl(ip & (0xffffffffU << (32 - len)));
+    key_p->prefix_len = len;
+}
+
+/* mostly /48, then /32-/44, a few /56 and /64, under 2000::/3 */
+static void
+bench_prefix6(struct oes_ip_prefix *key_p)
+{
+    unsigned int r = bench_rand() % 100;
+    unsigned int len = (r < 55) ? 48 : (r < 90) ? 32 + (bench_rand() % 4) * 4 : 56 + (bench_rand() % 2) * 8;
+    unsigned int i;
+
+    memset(key_p, 0, sizeof(*key_p));
+    key_p->prefix.version = OES_IPV6;
+    key_p->prefix.addr.ipv6.s6_addr[0] = 0x20 | (bench_rand() & 0x1f);
+    for (i = 1; i < 8; i++) {
+        key_p->prefix.addr.ipv6.s6_addr[i] = bench_rand();
+    }
+    for (i = len; i < 64; i++) {
+        key_p->prefix.addr.ipv6.s6_addr[i / 8] &= ~(0x80 >> (i % 8));
+    }
+    key_p->prefix_len = len;
+}
+
+int
+main(void)
+{
+    struct oes_router_attributes    attr = { 1, 1, OES_ROUTER_ACTION_TRAP, OES_ROUTER_ACTION_TRAP };
+    unsigned int                    cnt = BENCH_PREFIXES4 + BENCH_PREFIXES6;
+    struct oes_ip_prefix           *keys_p = malloc(cnt * sizeof(*keys_p));
+    static struct oes_ip_prefix     page[BENCH_PAGE];
+    static struct oes_uc_route_data datas[BENCH_PAGE];
+    static struct oes_ip_addr       page_nhs[BENCH_PAGE][BENCH_PAGE_NHS];
+    struct oes_ip_addr              nhs[BENCH_NHS];
+    struct oes_uc_route_data        data;
+    enum oes_access_cmd             cmd;
+    unsigned short                  page_cnt;
+    unsigned int                    vrid, i, j, total;
+    double                          start, elapsed;
+
+    if (keys_p == NULL) {
+        printf("out of memory\n");
+        return 1;
+    }
+    oes_api_router_set(OES_ACCESS_CMD_ADD, &vrid, &attr, NULL);
+    memset(nhs, 0, sizeof(nhs));
+    for (i = 0; i < BENCH_NHS; i++) {
+        nhs[i].version = OES_IPV4;
+        nhs[i].addr.ipv4.s_addr = htonl(0xc0a80001 + i);
+    }
+    memset(&data, 0, sizeof(data));
+    data.action = OES_ROUTER_ACTION_FORWARD;
+    data.next_hop_cnt = 1;
+    for (i = 0; i < cnt; i++) {
+        if (i < BENCH_PREFIXES4) {
+            bench_prefix4(&keys_p[i]);
+        } else {
+            bench_prefix6(&keys_p[i]);
+        }
+        data.next_hop_list = &nhs[i % BENCH_NHS];
+        oes_api_router_uc_route_set(OES_ACCESS_CMD_ADD, vrid, &keys_p[i], &data, NULL);
+    }
+
+    start = bench_now();
+    page_cnt = BENCH_PAGE;
+    for (total = 0, cmd = OES_ACCESS_CMD_GET_FIRST; page_cnt == BENCH_PAGE; total += page_cnt) {
+        for (i = 0; i < BENCH_PAGE; i++) {
+            datas[i].next_hop_list = page_nhs[i];
+            datas[i].next_hop_cnt = BENCH_PAGE_NHS;
+        }
+        page_cnt = BENCH_PAGE;
+        oes_api_router_uc_route_get(cmd, vrid, page, datas, &page_cnt, NULL);
+        page[0] = page[BENCH_PAGE - 1];
+        cmd = OES_ACCESS_CMD_GET_NEXT;
+    }
+    elapsed = bench_now() - start;
+    printf("dump     %u routes in pages of %u in %.3f s (%.2f M routes/s)\n", total, BENCH_PAGE,
+           elapsed, total / elapsed / 1e6);
+
+    start = bench_now();
+    for (j = 0; j < BENCH_RESUMES; j++) {
+        for (i = 0; i < BENCH_PAGE; i++) {
+            datas[i].next_hop_list = page_nhs[i];
+            datas[i].next_hop_cnt = BENCH_PAGE_NHS;
+        }
+        page[0] = keys_p[bench_rand() % cnt];
+        page_cnt = BENCH_PAGE;
+        oes_api_router_uc_route_get(OES_ACCESS_CMD_GET_NEXT, vrid, page, datas, &page_cnt, NULL);
+    }
+    elapsed = bench_now() - start;
+    printf("resume   %u pages of %u from random keys, %.2f us per page\n", BENCH_RESUMES, BENCH_PAGE,
+           elapsed / BENCH_RESUMES * 1e6);
+
+    oes_api_router_uc_route_set(OES_ACCESS_CMD_DELETE_ALL, vrid, NULL, NULL, NULL);
+    oes_api_router_set(OES_ACCESS_CMD_DELETE, &vrid, NULL, NULL);
+    free(keys_p);
+    return 0;
+}
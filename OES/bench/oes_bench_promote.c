@@ -0,0 +1,144 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/*
+ * Route promotion benchmark: 100K IPv4 routes per next hop, added as
+ * FORWARD before their neighbours exist. Compares the neighbour
+ * add/delete that promotes and demotes them in place with re-pushing
+ * every route with a new action.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_api_router.h"
+
+#define BENCH_ROUTES_PER_NH  (100 * 1000)
+#define BENCH_NHS            4
+
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* route i is a /24 through next hop i % BENCH_NHS */
+static void
+bench_route(unsigned int i, struct oes_ip_prefix *key_p)
+{
+    memset(key_p, 0, sizeof(*key_p));
+    key_p->prefix.version = OES_IPV4;
+    key_p->prefix.addr.ipv4.s_addr = htonl(0x10000000 + (i << 8));
+    key_p->prefix_len = 24;
+}
+
+static enum oes_router_action
+bench_action(unsigned int vrid, unsigned int i)
+{
+    struct oes_uc_route_data data;
+    struct oes_ip_prefix     key;
+    unsigned short           cnt = 1;
+
+    bench_route(i, &key);
+    memset(&data, 0, sizeof(data));
+    oes_api_router_uc_route_get(OES_ACCESS_CMD_GET, vrid, &key, &data, &cnt, NULL);
+    return data.action;
+}
+
+int
+main(void)
+{
+    struct oes_router_attributes attr = { 1, 1, OES_ROUTER_ACTION_TRAP, OES_ROUTER_ACTION_TRAP };
+    struct ether_addr            mac = { { 0x00, 0x02, 0xc9, 0x00, 0x00, 0x01 } };
+    struct oes_ip_addr           nhs[BENCH_NHS];
+    struct oes_uc_route_data     route;
+    struct oes_neigh_data        neigh;
+    struct oes_ip_prefix         key;
+    unsigned int                 vrid, i;
+    double                       start, elapsed;
+
+    oes_api_router_set(OES_ACCESS_CMD_ADD, &vrid, &attr, NULL);
+    memset(nhs, 0, sizeof(nhs));
+    for (i = 0; i < BENCH_NHS; i++) {
+        nhs[i].version = OES_IPV4;
+        nhs[i].addr.ipv4.s_addr = htonl(0xc0a80001 + i);
+    }
+    memset(&route, 0, sizeof(route));
+    route.action = OES_ROUTER_ACTION_FORWARD;
+    route.next_hop_cnt = 1;
+    for (i = 0; i < BENCH_ROUTES_PER_NH * BENCH_NHS; i++) {
+        bench_route(i, &key);
+        route.next_hop_list = &nhs[i % BENCH_NHS];
+        if (oes_api_router_uc_route_set(OES_ACCESS_CMD_ADD, vrid, &key, &route, NULL) != OES_STATUS_SUCCESS) {
+            printf("add of route %u failed\n", i);
+            return 1;
+        }
+    }
+    printf("routes   %u over %u next hops, unresolved route acts as %s\n",
+           BENCH_ROUTES_PER_NH * BENCH_NHS, BENCH_NHS,
+           bench_action(vrid, 0) == OES_ROUTER_ACTION_TRAP ? "TRAP" : "not TRAP");
+
+    memset(&neigh, 0, sizeof(neigh));
+    neigh.mac_addr = &mac;
+    neigh.action = OES_ROUTER_ACTION_FORWARD;
+    start = bench_now();
+    oes_api_router_neigh_set(OES_ACCESS_CMD_ADD, vrid, &nhs[0], &neigh, NULL);
+    elapsed = bench_now() - start;
+    printf("promote  %u routes by neighbour add in %.1f us, route acts as %s\n", BENCH_ROUTES_PER_NH,
+           elapsed * 1e6, bench_action(vrid, 0) == OES_ROUTER_ACTION_FORWARD ? "FORWARD" : "not FORWARD");
+
+    start = bench_now();
+    oes_api_router_neigh_set(OES_ACCESS_CMD_DELETE, vrid, &nhs[0], NULL, NULL);
+    elapsed = bench_now() - start;
+    printf("demote   %u routes by neighbour delete in %.1f us, route acts as %s\n", BENCH_ROUTES_PER_NH,
+           elapsed * 1e6, bench_action(vrid, 0) == OES_ROUTER_ACTION_TRAP ? "TRAP" : "not TRAP");
+
+    /* what the caller had to do before: set every route again */
+    start = bench_now();
+    for (i = 0; i < BENCH_ROUTES_PER_NH * BENCH_NHS; i += BENCH_NHS) {
+        bench_route(i, &key);
+        route.next_hop_list = &nhs[0];
+        oes_api_router_uc_route_set(OES_ACCESS_CMD_EDIT, vrid, &key, &route, NULL);
+    }
+    elapsed = bench_now() - start;
+    printf("re-push  %u routes in %.1f us\n", BENCH_ROUTES_PER_NH, elapsed * 1e6);
+
+    oes_api_router_uc_route_set(OES_ACCESS_CMD_DELETE_ALL, vrid, NULL, NULL, NULL);
+    oes_api_router_set(OES_ACCESS_CMD_DELETE, &vrid, NULL, NULL);
+    return 0;
+}
@@ -0,0 +1,211 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Resilient ECMP benchmark: 1M flows over a 16 next hop group. Reports
+ * the share of flows that change next hop when one next hop is lost,
+ * for modulo, multiply-shift and resilient hashing, then when a next
+ * hop is added back and buckets migrate to it in paced rounds.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_router_activity.h"
+#include "oes_router_ecmp.h"
+#include "oes_router_nhg.h"
+
+#define BENCH_FLOWS       (1 << 20)
+#define BENCH_MEMBERS     16
+#define BENCH_BUCKETS     4096
+#define BENCH_LOST        7
+#define BENCH_PACE        32            /* bucket moves per round */
+#define BENCH_ACTIVE      2048          /* flows sending in a round */
+
+static unsigned long long bench_rand_state = 88172645463325252ULL;
+
+static unsigned int
+bench_rand(void)
+{
+    bench_rand_state ^= bench_rand_state << 13;
+    bench_rand_state ^= bench_rand_state >> 7;
+    bench_rand_state ^= bench_rand_state << 17;
+    return (unsigned int)bench_rand_state;
+}
+
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* next hop of every flow, as the last address byte, leaving bucket activity as it was */
+static void
+bench_resolve(const struct oes_nhg *nhg_p,
+              const unsigned int *hash_p,
+              unsigned char *next_hop_p)
+{
+    unsigned long long activity[BENCH_BUCKETS / 64];
+    unsigned int       i;
+
+    if (nhg_p->res_bucket_cnt) {
+        memcpy(activity, nhg_p->res_activity, sizeof(activity));
+    }
+    for (i = 0; i < BENCH_FLOWS; i++) {
+        next_hop_p[i] = ((unsigned char *)&nhg_p->members[oes_nhg_member(nhg_p, hash_p[i])].addr.ipv4)[3];
+    }
+    if (nhg_p->res_bucket_cnt) {
+        memcpy(nhg_p->res_activity, activity, sizeof(activity));
+    }
+}
+
+static double
+bench_moved(const unsigned char *before_p,
+            const unsigned char *after_p)
+{
+    unsigned int i, moved = 0;
+
+    for (i = 0; i < BENCH_FLOWS; i++) {
+        moved += (before_p[i] != after_p[i]);
+    }
+    return 100.0 * moved / BENCH_FLOWS;
+}
+
+int
+main(void)
+{
+    struct oes_router_ecmp_hash_fields fields = { 1, 1, 1, 1, 1, 1, 1 };
+    struct oes_ecmp_hasher             hasher;
+    struct oes_ecmp_flow               flow;
+    struct oes_nhg_table               nhgs;
+    struct oes_ip_addr                 next_hops[BENCH_MEMBERS + 1];
+    unsigned int                      *hash_p = malloc(BENCH_FLOWS * sizeof(*hash_p));
+    unsigned char                     *before_p = malloc(BENCH_FLOWS);
+    unsigned char                     *after_p = malloc(BENCH_FLOWS);
+    unsigned int                       i, j, plain, full, degraded, restored, moves, round;
+    int                                forced;
+    double                             start;
+
+    oes_ecmp_hasher_init(&hasher, &fields, 0x4f455321);
+    memset(&flow, 0, sizeof(flow));
+    flow.version = OES_IPV4;
+    flow.ip_proto = 6;
+    for (i = 0; i < BENCH_FLOWS; i++) {
+        flow.src_ip[0] = 10;
+        flow.src_ip[3] = bench_rand();
+        flow.dst_ip[0] = 192;
+        flow.dst_ip[3] = bench_rand() % 8;
+        flow.src_port = bench_rand();
+        flow.dst_port = 443;
+        hash_p[i] = oes_ecmp_hash(&hasher, &flow);
+    }
+    memset(next_hops, 0, sizeof(next_hops));
+    for (i = 0; i <= BENCH_MEMBERS; i++) {
+        next_hops[i].version = OES_IPV4;
+        next_hops[i].addr.ipv4.s_addr = htonl(0x0a000100 | (i + 1));
+    }
+    oes_nhg_table_init(&nhgs, NULL, NULL);
+
+    /* lose one next hop */
+    for (i = 0; i < BENCH_FLOWS; i++) {
+        before_p[i] = 1 + hash_p[i] % BENCH_MEMBERS;
+        j = hash_p[i] % (BENCH_MEMBERS - 1);
+        after_p[i] = 1 + j + (j >= BENCH_LOST);
+    }
+    printf("loss     1 of %u next hops, ideal %.2f%% of flows moved\n", BENCH_MEMBERS,
+           100.0 / BENCH_MEMBERS);
+    printf("  modulo          %6.2f%% moved\n", bench_moved(before_p, after_p));
+
+    oes_nhg_get(&nhgs, next_hops, BENCH_MEMBERS, &full);
+    bench_resolve(oes_nhg_entry(&nhgs, full), hash_p, before_p);
+    memmove(&next_hops[BENCH_LOST], &next_hops[BENCH_LOST + 1],
+            (BENCH_MEMBERS - BENCH_LOST) * sizeof(next_hops[0]));
+    oes_nhg_get(&nhgs, next_hops, BENCH_MEMBERS - 1, &plain);
+    bench_resolve(oes_nhg_entry(&nhgs, plain), hash_p, after_p);
+    printf("  multiply-shift  %6.2f%% moved\n", bench_moved(before_p, after_p));
+    oes_nhg_put(&nhgs, full);
+    oes_nhg_put(&nhgs, plain);
+
+    memset(&next_hops[BENCH_MEMBERS - 1], 0, 2 * sizeof(next_hops[0]));
+    for (i = 0; i <= BENCH_MEMBERS; i++) {
+        next_hops[i].version = OES_IPV4;
+        next_hops[i].addr.ipv4.s_addr = htonl(0x0a000100 | (i + 1));
+    }
+    oes_nhg_res_get(&nhgs, next_hops, BENCH_MEMBERS, BENCH_BUCKETS, OES_NHG_NONE, &full);
+    bench_resolve(oes_nhg_entry(&nhgs, full), hash_p, before_p);
+    memmove(&next_hops[BENCH_LOST], &next_hops[BENCH_LOST + 1],
+            (BENCH_MEMBERS - BENCH_LOST) * sizeof(next_hops[0]));
+    start = bench_now();
+    oes_nhg_res_get(&nhgs, next_hops, BENCH_MEMBERS - 1, BENCH_BUCKETS, full, &degraded);
+    printf("  resilient       %6.2f%% moved (%u buckets, group rebuilt in %.1f us)\n",
+           bench_moved(before_p, (bench_resolve(oes_nhg_entry(&nhgs, degraded), hash_p, after_p), after_p)),
+           BENCH_BUCKETS, (bench_now() - start) * 1e6);
+    oes_nhg_put(&nhgs, full);
+
+    /* a new next hop joins, buckets move to it BENCH_PACE at a time */
+    memcpy(before_p, after_p, BENCH_FLOWS);
+    next_hops[BENCH_MEMBERS - 1].version = OES_IPV4;
+    next_hops[BENCH_MEMBERS - 1].addr.ipv4.s_addr = htonl(0x0a000100 | (BENCH_MEMBERS + 1));
+    oes_nhg_res_get(&nhgs, next_hops, BENCH_MEMBERS, BENCH_BUCKETS, degraded, &restored);
+    oes_nhg_put(&nhgs, degraded);
+    printf("add      1 next hop to %u, ideal %.2f%% of flows moved, %u bucket moves per round, "
+           "%u flows active per round\n", BENCH_MEMBERS - 1, 100.0 / BENCH_MEMBERS,
+           BENCH_PACE, BENCH_ACTIVE);
+    for (round = 1;; round++) {
+        for (i = 0; i < BENCH_ACTIVE; i++) {
+            oes_nhg_member(oes_nhg_entry(&nhgs, restored), hash_p[bench_rand() % BENCH_FLOWS]);
+        }
+        moves = oes_nhg_res_rebalance(&nhgs, restored, BENCH_PACE, 0);
+        forced = !moves;
+        if (forced) {
+            moves = oes_nhg_res_rebalance(&nhgs, restored, BENCH_PACE, 1);
+        }
+        bench_resolve(oes_nhg_entry(&nhgs, restored), hash_p, after_p);
+        printf("  round %2u        %6.2f%% moved so far, %u buckets moved%s\n", round,
+               bench_moved(before_p, after_p), moves, forced ? " (forced)" : "");
+        if (!moves) {
+            break;
+        }
+    }
+
+    oes_nhg_put(&nhgs, restored);
+    oes_nhg_table_deinit(&nhgs);
+    free(hash_p);
+    free(before_p);
+    free(after_p);
+    return 0;
+}
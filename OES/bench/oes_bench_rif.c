@@ -0,0 +1,157 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Router interface benchmark: ingress rif resolution through
+ * oes_api_router_interface_lookup with 64 router interfaces, and with
+ * 4096 (router ports and VLAN interfaces over 16 bridges) carrying 60K
+ * extra router MACs. Neither lookup searches, so the difference between
+ * the two is cache misses on the larger tables.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_api_router.h"
+
+#define BENCH_BRIDGES     16
+#define BENCH_MACS        15            /* extra router MACs per rif in the large setup */
+#define BENCH_LOOKUPS     (4 * 1024 * 1024)
+
+static unsigned long long bench_rand_state = 88172645463325252ULL;
+
+static unsigned int
+bench_rand(void)
+{
+    bench_rand_state ^= bench_rand_state << 13;
+    bench_rand_state ^= bench_rand_state >> 7;
+    bench_rand_state ^= bench_rand_state << 17;
+    return (unsigned int)bench_rand_state;
+}
+
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* rif i sits on port i below OES_MAX_PORTS, then on VLANs spread over the bridges */
+static void
+bench_ifc(unsigned int i, struct oes_l3_interface *ifc_p)
+{
+    memset(ifc_p, 0, sizeof(*ifc_p));
+    if (i < OES_MAX_PORTS) {
+        ifc_p->type = OES_INTERFACE_TYPE_ROUTER_PORT;
+        ifc_p->ifc.port.port = i;
+    } else {
+        ifc_p->type = OES_INTERFACE_TYPE_VLAN;
+        ifc_p->ifc.vlan.br_id = i % BENCH_BRIDGES;
+        ifc_p->ifc.vlan.vlan = 1 + i / BENCH_BRIDGES;
+    }
+}
+
+static void
+bench_mac(unsigned int rif, unsigned int n, struct ether_addr *mac_p)
+{
+    mac_p->ether_addr_octet[0] = 0x00;
+    mac_p->ether_addr_octet[1] = 0x02;
+    mac_p->ether_addr_octet[2] = n;
+    mac_p->ether_addr_octet[3] = 0xc9;
+    mac_p->ether_addr_octet[4] = rif >> 8;
+    mac_p->ether_addr_octet[5] = rif;
+}
+
+static void
+bench_run(unsigned int vrid, unsigned int rif_cnt, unsigned int mac_cnt)
+{
+    static struct oes_l3_interface      ifcs[4096];
+    static struct ether_addr            macs[4096];
+    struct oes_l3_interface_attributes  attr;
+    struct oes_l3_interface_lookup_data data;
+    struct ether_addr                   extra[BENCH_MACS];
+    unsigned int                        i, n, rif, hits = 0;
+    double                              start, elapsed;
+
+    start = bench_now();
+    for (i = 0; i < rif_cnt; i++) {
+        bench_ifc(i, &ifcs[i]);
+        bench_mac(i, 0, &attr.mac_addr);
+        attr.mtu = 1500;
+        if (oes_api_router_interface_set(OES_ACCESS_CMD_ADD, vrid, &rif, &ifcs[i], &attr,
+                                         NULL) != OES_STATUS_SUCCESS) {
+            printf("add of rif %u failed\n", i);
+            exit(1);
+        }
+        for (n = 0; n < mac_cnt; n++) {
+            bench_mac(i, n + 1, &extra[n]);
+        }
+        if (oes_api_router_interface_mac_set(OES_ACCESS_CMD_ADD, vrid, rif, extra, mac_cnt,
+                                             NULL) != OES_STATUS_SUCCESS) {
+            printf("add of rif %u MACs failed\n", i);
+            exit(1);
+        }
+        /* look up the last extra MAC, or the attribute MAC */
+        bench_mac(i, mac_cnt, &macs[i]);
+    }
+    elapsed = bench_now() - start;
+    printf("add      %u rifs with %u MACs each in %.1f ms\n", rif_cnt, mac_cnt + 1, elapsed * 1e3);
+
+    start = bench_now();
+    for (i = 0; i < BENCH_LOOKUPS; i++) {
+        n = bench_rand() % rif_cnt;
+        oes_api_router_interface_lookup(&ifcs[n], &macs[n], &data);
+        hits += data.router_mac;
+    }
+    elapsed = bench_now() - start;
+    printf("lookup   %u over %u rifs in %.3f s (%.2f M/s, %u router MAC hits)\n", BENCH_LOOKUPS,
+           rif_cnt, elapsed, BENCH_LOOKUPS / elapsed / 1e6, hits);
+
+    oes_api_router_interface_set(OES_ACCESS_CMD_DELETE_ALL, vrid, NULL, NULL, NULL, NULL);
+}
+
+int
+main(void)
+{
+    struct oes_router_attributes attr = { 1, 1, OES_ROUTER_ACTION_TRAP, OES_ROUTER_ACTION_TRAP };
+    unsigned int                 vrid;
+
+    oes_api_router_set(OES_ACCESS_CMD_ADD, &vrid, &attr, NULL);
+    bench_run(vrid, 64, 0);
+    bench_run(vrid, 4096, BENCH_MACS);
+    oes_api_router_set(OES_ACCESS_CMD_DELETE, &vrid, NULL, NULL);
+    return 0;
+}
@@ -0,0 +1,235 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Warm boot benchmark: loads a synthesized full table (~900K IPv4 and
+ * 150K IPv6 prefixes over 500 ECMP sets of 64 neighbours) into one
+ * vrid, saves it with oes_api_router_fib_snapshot_save and restores it
+ * into a second vrid with oes_api_router_fib_snapshot_restore.
+ * Reports the load, save and restore times and the image size, then
+ * checks both routers give the same lookup results. The image goes to
+ * the path given as argument, /tmp/oes_bench_snapshot.img by default.
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_api_router.h"
+
+#define BENCH_PREFIXES4   900000
+#define BENCH_PREFIXES6   150000
+#define BENCH_NHS         64
+#define BENCH_SETS        500
+#define BENCH_SET_MAX     8
+#define BENCH_BATCH       65536
+#define BENCH_ADDRS       65536
+#define BENCH_PATH        "/tmp/oes_bench_snapshot.img"
+
+static unsigned long long bench_rand_state = 88172645463325252ULL;
+
+static unsigned int
+bench_rand(void)
+{
+    bench_rand_state ^= bench_rand_state << 13;
+    bench_rand_state ^= bench_rand_state >> 7;
+    bench_rand_state ^= bench_rand_state << 17;
+    return (unsigned int)bench_rand_state;
+}
+
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* rough shape of a BGP table: mostly /24, then /16-/23, few long */
+static void
+bench_prefix4(struct oes_ip_prefix *key_p)
+{
+    unsigned int r = bench_rand() % 1000;
+    unsigned int len = (r < 600) ? 24 : (r < 950) ? 16 + bench_rand() % 8 : 25 + bench_rand() % 8;
+    unsigned int ip = (1 + bench_rand() % 223) << 24 | (bench_rand() & 0xffffff);
+
+    memset(key_p, 0, sizeof(*key_p));
+    key_p->prefix.version = OES_IPV4;
+    key_p->prefix.addr.ipv4.s_addr = htonl(ip & (0xffffffffU << (32 - len)));
+    key_p->prefix_len = len;
+}
+
+/* mostly /48, then /32-/44, a few /56 and /64, under 2000::/3 */
+static void
+bench_prefix6(struct oes_ip_prefix *key_p)
+{
+    unsigned int r = bench_rand() % 100;
+    unsigned int len = (r < 55) ? 48 : (r < 90) ? 32 + (bench_rand() % 4) * 4 : 56 + (bench_rand() % 2) * 8;
+    unsigned int i;
+
+    memset(key_p, 0, sizeof(*key_p));
+    key_p->prefix.version = OES_IPV6;
+    key_p->prefix.addr.ipv6.s6_addr[0] = 0x20 | (bench_rand() & 0x1f);
+    for (i = 1; i < 8; i++) {
+        key_p->prefix.addr.ipv6.s6_addr[i] = bench_rand();
+    }
+    for (i = len; i < 64; i++) {
+        key_p->prefix.addr.ipv6.s6_addr[i / 8] &= ~(0x80 >> (i % 8));
+    }
+    key_p->prefix_len = len;
+}
+
+int
+main(int argc, char *argv[])
+{
+    struct oes_router_attributes           attr = { 1, 1, OES_ROUTER_ACTION_TRAP, OES_ROUTER_ACTION_TRAP };
+    struct ether_addr                      mac = { { 0x00, 0x02, 0xc9, 0x00, 0x00, 0x01 } };
+    const char                            *path_p = (argc > 1) ? argv[1] : BENCH_PATH;
+    unsigned int                           cnt = BENCH_PREFIXES4 + BENCH_PREFIXES6;
+    struct oes_uc_route_op                *ops_p = malloc(BENCH_BATCH * sizeof(*ops_p));
+    static struct oes_ip_addr              sets[BENCH_SETS][BENCH_SET_MAX];
+    static unsigned short                  set_cnts[BENCH_SETS];
+    static struct oes_ip_addr              addrs[BENCH_ADDRS];
+    static struct oes_uc_route_batch_lookup_data before[BENCH_ADDRS], after[BENCH_ADDRS];
+    struct oes_ip_addr                     nhs[BENCH_NHS];
+    struct oes_neigh_data                  neigh;
+    struct oes_ip_prefix                   key;
+    struct stat                            st;
+    unsigned int                           vrid, restored_vrid, i, j, n, s, failed, found = 0;
+    oes_status_e                           status;
+    double                                 start, elapsed;
+
+    if (ops_p == NULL) {
+        printf("out of memory\n");
+        return 1;
+    }
+    memset(nhs, 0, sizeof(nhs));
+    for (i = 0; i < BENCH_NHS; i++) {
+        nhs[i].version = OES_IPV4;
+        nhs[i].addr.ipv4.s_addr = htonl(0xc0a80001 + i);
+    }
+    for (s = 0; s < BENCH_SETS; s++) {
+        set_cnts[s] = 1 + bench_rand() % BENCH_SET_MAX;
+        for (j = 0; j < set_cnts[s]; j++) {
+            sets[s][j] = nhs[(s + j * 7) % BENCH_NHS];
+        }
+    }
+    memset(&neigh, 0, sizeof(neigh));
+    neigh.mac_addr = &mac;
+    neigh.action = OES_ROUTER_ACTION_FORWARD;
+
+    oes_api_router_set(OES_ACCESS_CMD_ADD, &vrid, &attr, NULL);
+    for (i = 0; i < BENCH_NHS; i++) {
+        neigh.rif = i;
+        oes_api_router_neigh_set(OES_ACCESS_CMD_ADD, vrid, &nhs[i], &neigh, NULL);
+    }
+
+    /* repeated prefixes just replace their route */
+    start = bench_now();
+    for (i = 0; i < cnt; i += BENCH_BATCH) {
+        n = (cnt - i < BENCH_BATCH) ? cnt - i : BENCH_BATCH;
+        for (j = 0; j < n; j++) {
+            memset(&ops_p[j], 0, sizeof(ops_p[j]));
+            ops_p[j].access_cmd = OES_ACCESS_CMD_ADD;
+            if (i + j < BENCH_PREFIXES4) {
+                bench_prefix4(&ops_p[j].key);
+            } else {
+                bench_prefix6(&ops_p[j].key);
+            }
+            s = bench_rand() % BENCH_SETS;
+            ops_p[j].data.action = OES_ROUTER_ACTION_FORWARD;
+            ops_p[j].data.next_hop_list = sets[s];
+            ops_p[j].data.next_hop_cnt = set_cnts[s];
+        }
+        if (oes_api_router_uc_route_batch_set(vrid, ops_p, n, &failed, NULL) != OES_STATUS_SUCCESS) {
+            printf("load batch at %u failed on op %u\n", i, i + failed);
+            return 1;
+        }
+    }
+    elapsed = bench_now() - start;
+    printf("load     %u prefixes in %.3f s (%.2f M routes/s)\n", cnt, elapsed, cnt / elapsed / 1e6);
+
+    start = bench_now();
+    status = oes_api_router_fib_snapshot_save(vrid, path_p);
+    elapsed = bench_now() - start;
+    if ((status != OES_STATUS_SUCCESS) || (stat(path_p, &st) != 0)) {
+        printf("save to %s failed: %d\n", path_p, status);
+        return 1;
+    }
+    printf("save     in %.3f s, image %.1f MB (%.1f bytes per prefix)\n", elapsed,
+           st.st_size / 1e6, (double)st.st_size / cnt);
+
+    oes_api_router_set(OES_ACCESS_CMD_ADD, &restored_vrid, &attr, NULL);
+    start = bench_now();
+    status = oes_api_router_fib_snapshot_restore(restored_vrid, path_p);
+    elapsed = bench_now() - start;
+    if (status != OES_STATUS_SUCCESS) {
+        printf("restore failed: %d\n", status);
+        return 1;
+    }
+    printf("restore  in %.3f s (%.1f M routes/s)\n", elapsed, cnt / elapsed / 1e6);
+
+    /* half the addresses inside a prefix of the table, half anywhere */
+    for (i = 0; i < BENCH_ADDRS; i++) {
+        if (i & 1) {
+            bench_prefix4(&key);
+        } else {
+            bench_prefix6(&key);
+        }
+        addrs[i] = key.prefix;
+        if (i & 2) {
+            addrs[i].addr.ipv4.s_addr ^= bench_rand();
+        }
+    }
+    oes_api_router_uc_route_lookup_batch(vrid, addrs, before, BENCH_ADDRS);
+    oes_api_router_uc_route_lookup_batch(restored_vrid, addrs, after, BENCH_ADDRS);
+    for (i = 0; i < BENCH_ADDRS; i++) {
+        if ((before[i].found != after[i].found) || (before[i].nhg_id != after[i].nhg_id) ||
+            (before[i].action != after[i].action)) {
+            printf("lookup %u differs after restore\n", i);
+            return 1;
+        }
+        found += before[i].found;
+    }
+    printf("verify   %u lookups match (%u found)\n", BENCH_ADDRS, found);
+
+    unlink(path_p);
+    oes_api_router_uc_route_set(OES_ACCESS_CMD_DELETE_ALL, vrid, NULL, NULL, NULL);
+    oes_api_router_uc_route_set(OES_ACCESS_CMD_DELETE_ALL, restored_vrid, NULL, NULL, NULL);
+    free(ops_p);
+    return 0;
+}
@@ -0,0 +1,183 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * VLAN range benchmark: 64 trunk ports carrying VLANs 1-4094 configured
+ * per VID through oes_api_vlan_port_multi_vlan_set, and as ranges
+ * through oes_api_vlan_ports_range_set, one call per port and one call
+ * for all ports. Then the 4094 VLANs are moved between two MSTIs
+ * through oes_api_stp_msti_vlan_list_set and
+ * oes_api_stp_msti_vlan_range_set, and spread over 64 MSTIs by range.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_api_stp.h"
+#include "oes_api_vlan.h"
+
+#define BENCH_BR          1
+#define BENCH_PORTS       64
+#define BENCH_VID_FIRST   1
+#define BENCH_VID_LAST    4094
+#define BENCH_VIDS        (BENCH_VID_LAST - BENCH_VID_FIRST + 1)
+#define BENCH_MSTIS       64
+#define BENCH_MOVES       100           /* whole-table moves between two MSTIs */
+
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* every port must be a member of every VLAN, or of none */
+static int
+bench_check(unsigned short expect)
+{
+    unsigned short cnt, vid;
+
+    for (vid = BENCH_VID_FIRST; vid <= BENCH_VID_LAST; vid++) {
+        cnt = 0;
+        oes_api_vlan_ports_get(BENCH_BR, vid, NULL, &cnt, NULL);
+        if (cnt != expect) {
+            printf("vid %u has %u members, expected %u\n", vid, cnt, expect);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int
+main(void)
+{
+    static struct oes_port_vlans vlans[BENCH_VIDS];
+    static unsigned short        vids[BENCH_VIDS];
+    struct oes_vlan_port         ports[BENCH_PORTS];
+    unsigned short               per_msti = BENCH_VIDS / BENCH_MSTIS, first, last, i;
+    unsigned long                port;
+    double                       start, elapsed;
+
+    for (i = 0; i < BENCH_VIDS; i++) {
+        vlans[i].vid = BENCH_VID_FIRST + i;
+        vlans[i].tagging = OES_VLAN_TAGGED_MEMBER;
+        vids[i] = BENCH_VID_FIRST + i;
+    }
+    for (port = 0; port < BENCH_PORTS; port++) {
+        ports[port].log_port = port;
+        ports[port].tagging = OES_VLAN_TAGGED_MEMBER;
+    }
+
+    start = bench_now();
+    for (port = 0; port < BENCH_PORTS; port++) {
+        oes_api_vlan_port_multi_vlan_set(OES_ACCESS_CMD_ADD, BENCH_BR, port, vlans, BENCH_VIDS, NULL);
+    }
+    elapsed = bench_now() - start;
+    printf("per vid  %u ports x %u VLANs in %.3f ms\n", BENCH_PORTS, BENCH_VIDS, elapsed * 1e3);
+    if (bench_check(BENCH_PORTS)) {
+        return 1;
+    }
+    oes_api_vlan_ports_range_set(OES_ACCESS_CMD_DELETE, BENCH_BR, BENCH_VID_FIRST, BENCH_VID_LAST,
+                                 ports, BENCH_PORTS, NULL);
+    if (bench_check(0)) {
+        return 1;
+    }
+
+    start = bench_now();
+    for (port = 0; port < BENCH_PORTS; port++) {
+        oes_api_vlan_ports_range_set(OES_ACCESS_CMD_ADD, BENCH_BR, BENCH_VID_FIRST, BENCH_VID_LAST,
+                                     &ports[port], 1, NULL);
+    }
+    elapsed = bench_now() - start;
+    printf("range    %u ports x %u VLANs, a call per port, in %.3f ms\n", BENCH_PORTS, BENCH_VIDS,
+           elapsed * 1e3);
+    if (bench_check(BENCH_PORTS)) {
+        return 1;
+    }
+
+    start = bench_now();
+    oes_api_vlan_ports_range_set(OES_ACCESS_CMD_DELETE, BENCH_BR, BENCH_VID_FIRST, BENCH_VID_LAST,
+                                 ports, BENCH_PORTS, NULL);
+    elapsed = bench_now() - start;
+    printf("range    delete of %u ports x %u VLANs in %.3f ms\n", BENCH_PORTS, BENCH_VIDS, elapsed * 1e3);
+
+    start = bench_now();
+    oes_api_vlan_ports_range_set(OES_ACCESS_CMD_ADD, BENCH_BR, BENCH_VID_FIRST, BENCH_VID_LAST,
+                                 ports, BENCH_PORTS, NULL);
+    elapsed = bench_now() - start;
+    printf("range    %u ports x %u VLANs, one call, in %.3f ms\n", BENCH_PORTS, BENCH_VIDS, elapsed * 1e3);
+    if (bench_check(BENCH_PORTS)) {
+        return 1;
+    }
+
+    for (i = 1; i <= BENCH_MSTIS; i++) {
+        oes_api_stp_msti_set(OES_ACCESS_CMD_ADD, BENCH_BR, i, NULL);
+    }
+    start = bench_now();
+    for (i = 0; i < BENCH_MOVES; i++) {
+        oes_api_stp_msti_vlan_list_set(OES_ACCESS_CMD_ADD, BENCH_BR, 1 + i % 2, vids, BENCH_VIDS, NULL);
+    }
+    elapsed = bench_now() - start;
+    printf("msti     %u VLANs moved between instances per vid in %.1f us\n", BENCH_VIDS,
+           elapsed * 1e6 / BENCH_MOVES);
+
+    start = bench_now();
+    for (i = 0; i < BENCH_MOVES; i++) {
+        oes_api_stp_msti_vlan_range_set(OES_ACCESS_CMD_ADD, BENCH_BR, 1 + i % 2, BENCH_VID_FIRST,
+                                        BENCH_VID_LAST, NULL);
+    }
+    elapsed = bench_now() - start;
+    printf("msti     %u VLANs moved between instances by range in %.1f us\n", BENCH_VIDS,
+           elapsed * 1e6 / BENCH_MOVES);
+
+    start = bench_now();
+    for (i = 0; i < BENCH_MSTIS; i++) {
+        first = BENCH_VID_FIRST + (BENCH_MSTIS - 1 - i) * per_msti;
+        last = first + per_msti - 1;
+        oes_api_stp_msti_vlan_range_set(OES_ACCESS_CMD_ADD, BENCH_BR, i + 1, first, last, NULL);
+    }
+    elapsed = bench_now() - start;
+    printf("msti     %u VLANs spread over %u instances by range in %.1f us\n", per_msti * BENCH_MSTIS,
+           BENCH_MSTIS, elapsed * 1e6);
+
+    i = BENCH_VIDS;
+    oes_api_stp_msti_vlan_list_get(BENCH_BR, 1, vids, &i, NULL);
+    if ((i != per_msti) || (vids[0] != BENCH_VID_FIRST + (BENCH_MSTIS - 1) * per_msti)) {
+        printf("msti 1 has %u VLANs from %u\n", i, vids[0]);
+        return 1;
+    }
+    return 0;
+}
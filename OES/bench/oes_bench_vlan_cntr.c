@@ -0,0 +1,149 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * VLAN counter benchmark: counting through oes_api_vlan_cntr_count on
+ * random VLANs of one thread, then the cost of reading all 4094 VLANs
+ * once BENCH_THREADS threads have each counted on every VLAN, one
+ * oes_api_vlan_cntr_get per VLAN against one oes_api_vlan_cntr_bulk_get.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_api_vlan.h"
+
+#define BENCH_BR          1
+#define BENCH_VID_MAX     4094
+#define BENCH_COUNTS      (16 * 1024 * 1024)
+#define BENCH_THREADS     8
+#define BENCH_READS       20
+
+static unsigned long long bench_rand_state = 88172645463325252ULL;
+
+static unsigned int
+bench_rand(void)
+{
+    bench_rand_state ^= bench_rand_state << 13;
+    bench_rand_state ^= bench_rand_state >> 7;
+    bench_rand_state ^= bench_rand_state << 17;
+    return (unsigned int)bench_rand_state;
+}
+
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static pthread_barrier_t bench_barrier;
+
+/* counts once per VLAN, then stays alive until all threads counted so every one gets its own slab */
+static void *
+bench_thread(void *arg)
+{
+    unsigned int vid;
+
+    for (vid = 1; vid <= BENCH_VID_MAX; vid++) {
+        oes_api_vlan_cntr_count(BENCH_BR, vid, OES_VLAN_CNTR_FLOOD, 1, 64);
+    }
+    pthread_barrier_wait(&bench_barrier);
+    return arg;
+}
+
+int
+main(void)
+{
+    static struct oes_vlan_cntr cntrs[OES_MAX_VLANS];
+    static unsigned short       vids[BENCH_COUNTS];
+    pthread_t                   threads[BENCH_THREADS];
+    unsigned long long          floods = 0;
+    unsigned int                i, r, vid;
+    double                      start, elapsed;
+
+    for (i = 0; i < BENCH_COUNTS; i++) {
+        vids[i] = 1 + bench_rand() % BENCH_VID_MAX;
+    }
+    start = bench_now();
+    for (i = 0; i < BENCH_COUNTS; i++) {
+        oes_api_vlan_cntr_count(BENCH_BR, vids[i], OES_VLAN_CNTR_RX, 1, 64 + (i & 0x3ff));
+    }
+    elapsed = bench_now() - start;
+    printf("count    %u counts on random VLANs in %.3f s (%.1f M/s)\n", BENCH_COUNTS, elapsed,
+           BENCH_COUNTS / elapsed / 1e6);
+
+    pthread_barrier_init(&bench_barrier, NULL, BENCH_THREADS);
+    for (i = 0; i < BENCH_THREADS; i++) {
+        pthread_create(&threads[i], NULL, bench_thread, NULL);
+    }
+    for (i = 0; i < BENCH_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    start = bench_now();
+    for (r = 0; r < BENCH_READS; r++) {
+        for (vid = 1; vid <= BENCH_VID_MAX; vid++) {
+            oes_api_vlan_cntr_get(OES_ACCESS_CMD_READ, BENCH_BR, vid, &cntrs[vid], NULL);
+        }
+    }
+    elapsed = (bench_now() - start) / BENCH_READS;
+    printf("get      %u VLANs one by one over %u slabs in %.1f us\n", BENCH_VID_MAX, BENCH_THREADS + 1,
+           elapsed * 1e6);
+
+    start = bench_now();
+    for (r = 0; r < BENCH_READS; r++) {
+        oes_api_vlan_cntr_bulk_get(OES_ACCESS_CMD_READ, BENCH_BR, cntrs, NULL);
+    }
+    elapsed = (bench_now() - start) / BENCH_READS;
+    printf("bulk     %u VLANs in one call over %u slabs in %.1f us\n", BENCH_VID_MAX, BENCH_THREADS + 1,
+           elapsed * 1e6);
+
+    /* the first clear allocates the bases, time the ones after it */
+    oes_api_vlan_cntr_bulk_get(OES_ACCESS_CMD_READ_CLEAR, BENCH_BR, cntrs, NULL);
+    for (vid = 1; vid <= BENCH_VID_MAX; vid++) {
+        floods += cntrs[vid].flood_packets;
+    }
+    start = bench_now();
+    for (r = 0; r < BENCH_READS; r++) {
+        oes_api_vlan_cntr_bulk_get(OES_ACCESS_CMD_READ_CLEAR, BENCH_BR, cntrs, NULL);
+    }
+    elapsed = (bench_now() - start) / BENCH_READS;
+    printf("clear    %u VLANs read and cleared in one call in %.1f us (%llu floods)\n", BENCH_VID_MAX,
+           elapsed * 1e6, floods);
+    return floods != (unsigned long long)BENCH_THREADS * BENCH_VID_MAX;
+}
@@ -0,0 +1,173 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * VLAN stage benchmark: 64 byte frames through oes_api_vlan_ingress_batch
+ * and oes_api_vlan_egress_batch in bursts of 32, on one core. Half come
+ * tagged on trunk ports and leave tagged through another trunk, half
+ * come untagged on access ports and leave through the access port paired
+ * with them, so every frame is back in its first form after a pass.
+ * Reports the rate against 10G line rate for 64 byte frames.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_api_vlan.h"
+
+#define BENCH_BR          1
+#define BENCH_FRAMES      4096
+#define BENCH_SLOT        128           /* frame buffer, headroom included */
+#define BENCH_HEADROOM    64
+#define BENCH_FRAME_LEN   60            /* 64 on the wire with the FCS */
+#define BENCH_BURST       32
+#define BENCH_PASSES      2000
+#define BENCH_TRUNKS      32            /* ports 0..31 trunk, 32..63 access */
+#define BENCH_VLANS       100           /* VLANs 2..101 */
+#define BENCH_LINE_RATE   14.88         /* Mpps, 10G with 64 byte frames */
+
+static unsigned long long bench_rand_state = 88172645463325252ULL;
+
+static unsigned int
+bench_rand(void)
+{
+    bench_rand_state ^= bench_rand_state << 13;
+    bench_rand_state ^= bench_rand_state >> 7;
+    bench_rand_state ^= bench_rand_state << 17;
+    return (unsigned int)bench_rand_state;
+}
+
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* access ports 32 + 2j and 33 + 2j share VLAN 2 + j */
+static unsigned short
+bench_access_vid(unsigned int port)
+{
+    return 2 + (port - BENCH_TRUNKS) / 2;
+}
+
+static void
+bench_setup(void)
+{
+    struct oes_vlan_port vp;
+    unsigned int         port;
+
+    for (port = 0; port < BENCH_TRUNKS; port++) {
+        vp.log_port = port;
+        vp.tagging = OES_VLAN_TAGGED_MEMBER;
+        oes_api_vlan_ports_range_set(OES_ACCESS_CMD_ADD, BENCH_BR, 2, 1 + BENCH_VLANS, &vp, 1, NULL);
+        oes_api_vlan_port_accptd_frm_types_set(BENCH_BR, port, OES_VLAN_FRAME_TYPES_ALLOW_TAGGED, NULL);
+        oes_api_vlan_ingr_filter_ports_set(BENCH_BR, port, OES_INGR_FILTER_ENABLE, NULL);
+    }
+    for (port = BENCH_TRUNKS; port < 2 * BENCH_TRUNKS; port++) {
+        vp.log_port = port;
+        vp.tagging = OES_VLAN_UNTAGGED_MEMBER;
+        oes_api_vlan_ports_set(OES_ACCESS_CMD_ADD, BENCH_BR, bench_access_vid(port), &vp, 1, NULL);
+        oes_api_vlan_port_pvid_set(OES_ACCESS_CMD_ADD, BENCH_BR, port, bench_access_vid(port), NULL);
+        oes_api_vlan_port_accptd_frm_types_set(BENCH_BR, port, OES_VLAN_FRAME_TYPES_ALLOW_UNTAGGED, NULL);
+        oes_api_vlan_ingr_filter_ports_set(BENCH_BR, port, OES_INGR_FILTER_ENABLE, NULL);
+    }
+}
+
+int
+main(void)
+{
+    static unsigned char       bufs[BENCH_FRAMES][BENCH_SLOT];
+    static struct oes_vlan_pkt pkts[BENCH_FRAMES];
+    static unsigned short      in_port[BENCH_FRAMES], out_port[BENCH_FRAMES];
+    struct oes_vlan_pkt       *burst;
+    unsigned int               pass, i, j, port, vid, len, tags = 0, drops = 0;
+    double                     start, elapsed, mpps;
+
+    bench_setup();
+
+    for (i = 0; i < BENCH_FRAMES; i++) {
+        for (j = 0; j < BENCH_SLOT; j++) {
+            bufs[i][j] = bench_rand();
+        }
+        port = bench_rand() % (2 * BENCH_TRUNKS);
+        len = BENCH_FRAME_LEN;
+        if (port < BENCH_TRUNKS) {
+            vid = 2 + bench_rand() % BENCH_VLANS;
+            bufs[i][BENCH_HEADROOM + 12] = 0x81;
+            bufs[i][BENCH_HEADROOM + 13] = 0x00;
+            bufs[i][BENCH_HEADROOM + 14] = vid >> 8;
+            bufs[i][BENCH_HEADROOM + 15] = vid;
+            out_port[i] = (port + 1) % BENCH_TRUNKS;
+        } else {
+            bufs[i][BENCH_HEADROOM + 12] = 0x08;
+            bufs[i][BENCH_HEADROOM + 13] = 0x00;
+            out_port[i] = port ^ 1;
+        }
+        in_port[i] = port;
+        pkts[i].data = bufs[i] + BENCH_HEADROOM;
+        pkts[i].len = len;
+        pkts[i].headroom = BENCH_HEADROOM;
+    }
+
+    start = bench_now();
+    for (pass = 0; pass < BENCH_PASSES; pass++) {
+        for (i = 0; i < BENCH_FRAMES; i += BENCH_BURST) {
+            burst = &pkts[i];
+            for (j = 0; j < BENCH_BURST; j++) {
+                burst[j].log_port = in_port[i + j];
+            }
+            oes_api_vlan_ingress_batch(BENCH_BR, burst, BENCH_BURST, NULL);
+            for (j = 0; j < BENCH_BURST; j++) {
+                burst[j].log_port = out_port[i + j];
+            }
+            oes_api_vlan_egress_batch(BENCH_BR, burst, BENCH_BURST, NULL);
+        }
+    }
+    elapsed = bench_now() - start;
+    mpps = (double)BENCH_PASSES * BENCH_FRAMES / elapsed / 1e6;
+
+    for (i = 0; i < BENCH_FRAMES; i++) {
+        drops += (pkts[i].drop != OES_VLAN_DROP_NONE);
+        tags += (pkts[i].len == BENCH_FRAME_LEN) && (pkts[i].data[12] == 0x81);
+    }
+    printf("stage    %u frames of %u bytes in bursts of %u in %.3f s\n", BENCH_PASSES * BENCH_FRAMES,
+           BENCH_FRAME_LEN + 4, BENCH_BURST, elapsed);
+    printf("rate     %.2f Mpps ingress and egress, %.1fx 10G line rate (%.2f Mpps)\n", mpps,
+           mpps / BENCH_LINE_RATE, BENCH_LINE_RATE);
+    printf("check    %u drops, %u tagged of %u frames\n", drops, tags, BENCH_FRAMES);
+    return drops != 0;
+}
@@ -0,0 +1,238 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Multi-VRF memory benchmark: loads a template router with a
+ * synthesized full table (~900K IPv4 and 100K IPv6 prefixes), then
+ * clones it into 500 VRFs through oes_api_router_clone, each adding a
+ * few tenant prefixes. Reports resident memory per VRF against the
+ * cost of the template, and the clone rate.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_api_router.h"
+
+#define BENCH_PREFIXES4   900000
+#define BENCH_PREFIXES6   100000
+#define BENCH_NHS         16
+#define BENCH_BATCH       65536
+#define BENCH_VRFS        500
+#define BENCH_TENANT4     10            /* IPv4 tenant prefixes per VRF */
+#define BENCH_TENANT6     2             /* IPv6 tenant prefixes per VRF */
+
+static unsigned long long bench_rand_state = 88172645463325252ULL;
+
+static unsigned int
+bench_rand(void)
+{
+    bench_rand_state ^= bench_rand_state << 13;
+    bench_rand_state ^= bench_rand_state >> 7;
+    bench_rand_state ^= bench_rand_state << 17;
+    return (unsigned int)bench_rand_state;
+}
+
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* resident set size in bytes */
+static double
+bench_rss(void)
+{
+    unsigned long size, resident = 0;
+    FILE         *file_p = fopen("/proc/self/statm", "r");
+
+    if (file_p != NULL) {
+        if (fscanf(file_p, "%lu %lu", &size, &resident) != 2) {
+            resident = 0;
+        }
+        fclose(file_p);
+    }
+    return (double)resident * sysconf(_SC_PAGESIZE);
+}
+
+/* rough shape of a BGP table: mostly /24, then /16-/23, few long */
+static void
+bench_prefix4(struct oes_ip_prefix *key_p)
+{
+    unsigned int r = bench_rand() % 1000;
+    unsigned int len = (r < 600) ? 24 : (r < 950) ? 16 + bench_rand() % 8 : 25 + bench_rand() % 8;
+    unsigned int ip = (11 + bench_rand() % 212) << 24 | (bench_rand() & 0xffffff);
+
+    memset(key_p, 0, sizeof(*key_p));
+    key_p->prefix.version = OES_IPV4;
+    key_p->prefix.addr.ipv4.s_addr = htonl(ip & (0xffffffffU << (32 - len)));
+    key_p->prefix_len = len;
+}
+
+/* /48 and /32-/64 under 2000::/4, as in the global IPv6 table */
+static void
+bench_prefix6(struct oes_ip_prefix *key_p)
+{
+    unsigned int r = bench_rand() % 100;
+    unsigned int len = (r < 50) ? 48 : 32 + (bench_rand() % 5) * 8;
+    unsigned int i;
+
+    memset(key_p, 0, sizeof(*key_p));
+    key_p->prefix.version = OES_IPV6;
+    key_p->prefix.addr.ipv6.s6_addr[0] = 0x20 | (bench_rand() & 0x3);
+    for (i = 1; i < len / 8; i++) {
+        key_p->prefix.addr.ipv6.s6_addr[i] = bench_rand();
+    }
+    key_p->prefix_len = len;
+}
+
+static void
+bench_op(struct oes_uc_route_op *op_p,
+         const struct oes_ip_prefix *key_p,
+         struct oes_ip_addr *next_hop_p)
+{
+    memset(op_p, 0, sizeof(*op_p));
+    op_p->access_cmd = OES_ACCESS_CMD_ADD;
+    op_p->key = *key_p;
+    op_p->data.action = OES_ROUTER_ACTION_FORWARD;
+    op_p->data.next_hop_list = next_hop_p;
+    op_p->data.next_hop_cnt = 1;
+}
+
+int
+main(void)
+{
+    struct oes_router_attributes attr = { 1, 1, OES_ROUTER_ACTION_TRAP, OES_ROUTER_ACTION_TRAP };
+    unsigned int                 cnt = BENCH_PREFIXES4 + BENCH_PREFIXES6;
+    struct oes_uc_route_op      *ops_p = malloc(cnt * sizeof(*ops_p));
+    static unsigned int          vrids[BENCH_VRFS];
+    struct oes_ip_addr           next_hop[BENCH_NHS];
+    struct oes_uc_route_data     data;
+    struct oes_ip_prefix         key;
+    unsigned int                 template_vrid, i, j, failed;
+    double                       rss, template_cost, clone_cost, tenant_cost, start, clone_time = 0;
+
+    memset(next_hop, 0, sizeof(next_hop));
+    for (i = 0; i < BENCH_NHS; i++) {
+        next_hop[i].version = OES_IPV4;
+        next_hop[i].addr.ipv4.s_addr = htonl(0xc0a80001 + i);
+    }
+    for (i = 0; i < cnt; i++) {
+        if (i < BENCH_PREFIXES4) {
+            bench_prefix4(&key);
+        } else {
+            bench_prefix6(&key);
+        }
+        bench_op(&ops_p[i], &key, &next_hop[i % BENCH_NHS]);
+    }
+
+    rss = bench_rss();
+    oes_api_router_set(OES_ACCESS_CMD_ADD, &template_vrid, &attr, NULL);
+    for (i = 0; i < cnt; i += BENCH_BATCH) {
+        if (oes_api_router_uc_route_batch_set(template_vrid, &ops_p[i],
+                                              (cnt - i < BENCH_BATCH) ? cnt - i : BENCH_BATCH,
+                                              &failed, NULL) != OES_STATUS_SUCCESS) {
+            printf("template batch at %u failed on op %u\n", i, i + failed);
+            return 1;
+        }
+    }
+    free(ops_p);
+    template_cost = bench_rss() - rss;
+    printf("template %u prefixes, %.1f MB\n", cnt, template_cost / 1e6);
+
+    memset(&data, 0, sizeof(data));
+    data.action = OES_ROUTER_ACTION_FORWARD;
+    data.next_hop_cnt = 1;
+    rss = bench_rss();
+    for (i = 0; i < BENCH_VRFS; i++) {
+        start = bench_now();
+        if (oes_api_router_clone(template_vrid, &vrids[i], &attr, NULL) != OES_STATUS_SUCCESS) {
+            printf("clone %u failed\n", i);
+            return 1;
+        }
+        clone_time += bench_now() - start;
+    }
+    clone_cost = bench_rss() - rss;
+
+    rss = bench_rss();
+    for (i = 0; i < BENCH_VRFS; i++) {
+        /* 10.<vrf>.<j>.0/24 and 2001:db8:<vrf>:<j>::/64 */
+        for (j = 0; j < BENCH_TENANT4 + BENCH_TENANT6; j++) {
+            memset(&key, 0, sizeof(key));
+            if (j < BENCH_TENANT4) {
+                key.prefix.version = OES_IPV4;
+                key.prefix.addr.ipv4.s_addr = htonl(0x0a000000 | (i << 12) | (j << 8));
+                key.prefix_len = 24;
+            } else {
+                key.prefix.version = OES_IPV6;
+                key.prefix.addr.ipv6.s6_addr[0] = 0x20;
+                key.prefix.addr.ipv6.s6_addr[1] = 0x01;
+                key.prefix.addr.ipv6.s6_addr[2] = 0x0d;
+                key.prefix.addr.ipv6.s6_addr[3] = 0xb8;
+                key.prefix.addr.ipv6.s6_addr[4] = i >> 8;
+                key.prefix.addr.ipv6.s6_addr[5] = i;
+                key.prefix.addr.ipv6.s6_addr[7] = j;
+                key.prefix_len = 64;
+            }
+            data.next_hop_list = &next_hop[j % BENCH_NHS];
+            if (oes_api_router_uc_route_set(OES_ACCESS_CMD_ADD, vrids[i], &key, &data, NULL) !=
+                OES_STATUS_SUCCESS) {
+                printf("tenant prefix %u of vrf %u failed\n", j, i);
+                return 1;
+            }
+        }
+    }
+    tenant_cost = bench_rss() - rss;
+
+    printf("clone    %u VRFs in %.3f s (%.1f us each), %.1f KB/VRF\n", BENCH_VRFS, clone_time,
+           clone_time / BENCH_VRFS * 1e6, clone_cost / BENCH_VRFS / 1e3);
+    printf("tenant   %u+%u prefixes per VRF, %.1f KB/VRF\n", BENCH_TENANT4, BENCH_TENANT6,
+           tenant_cost / BENCH_VRFS / 1e3);
+    printf("total    %.1f KB/VRF at %u VRFs, %.2f%% of the template\n",
+           (clone_cost + tenant_cost) / BENCH_VRFS / 1e3, BENCH_VRFS,
+           (clone_cost + tenant_cost) / BENCH_VRFS / template_cost * 100);
+
+    for (i = 0; i < BENCH_VRFS; i++) {
+        oes_api_router_uc_route_set(OES_ACCESS_CMD_DELETE_ALL, vrids[i], NULL, NULL, NULL);
+        oes_api_router_set(OES_ACCESS_CMD_DELETE, &vrids[i], NULL, NULL);
+    }
+    oes_api_router_uc_route_set(OES_ACCESS_CMD_DELETE_ALL, template_vrid, NULL, NULL, NULL);
+    oes_api_router_set(OES_ACCESS_CMD_DELETE, &template_vrid, NULL, NULL);
+    return 0;
+}
@@ -27,14 +27,261 @@
  */
 
 #include <sys/types.h>
+#include <sys/eventfd.h>
 #include <net/ethernet.h>
 #include <netinet/if_ether.h>
 #include <net/if.h>
 #include <netinet/in.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
 #include "oes_status.h"
 #include "oes_types.h"
 #include "oes_api_event.h"
 
+#define OES_EVENT_MAX_CHANNELS        64
+#define OES_EVENT_MAX_REGISTRATIONS   256
+#define OES_EVENT_RING_SIZE           4096  /**< power of 2 */
+
+/* An event channel is an eventfd plus a ring of pending events. The
+ * eventfd is readable only while the ring is not empty; how often the
+ * producer writes it depends on the channel notify mode. Receivers hold
+ * a reference while they wait, DESTROY marks the channel closing, keeps
+ * the eventfd readable to wake them and frees it once they are gone. */
+struct oes_event_channel {
+    int                        in_use;
+    int                        fd;
+    enum oes_event_notify_mode notify_mode;
+    unsigned int               busy_poll_usec;
+    pthread_mutex_t            lock;
+    unsigned int               head;      /**< next slot to consume */
+    unsigned int               tail;      /**< next slot to produce */
+    unsigned char              signaled;  /**< eventfd counter is non zero */
+    unsigned char              spinning;  /**< HYBRID consumer is busy polling */
+    unsigned char              closing;   /**< DESTROY in progress */
+    unsigned int               refs;      /**< receivers in oes_api_event_recv, under the db lock */
+    unsigned long long         dropped;   /**< events lost on a full ring */
+    struct oes_event_info    * ring;
+};
+
+struct oes_event_registration {
+    int                         in_use;
+    int                         br_id;
+    enum oes_event              event_id;
+    struct oes_event_channel  * channel;
+    unsigned char               has_filter;
+    struct oes_event_filter     filter;
+};
+
+static pthread_mutex_t               oes_event_db_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t                oes_event_db_cond = PTHREAD_COND_INITIALIZER; /**< channel refs dropped */
+static struct oes_event_channel      oes_event_channels[OES_EVENT_MAX_CHANNELS];
+static struct oes_event_registration oes_event_registrations[OES_EVENT_MAX_REGISTRATIONS];
+
+/* caller holds oes_event_db_lock */
+static struct oes_event_channel *
+oes_event_channel_find(const int fd)
+{
+    int i;
+
+    for (i = 0; i < OES_EVENT_MAX_CHANNELS; i++) {
+        if (oes_event_channels[i].in_use && !oes_event_channels[i].closing &&
+            (oes_event_channels[i].fd == fd)) {
+            return &oes_event_channels[i];
+        }
+    }
+    return NULL;
+}
+
+/* caller holds oes_event_db_lock */
+static struct oes_event_registration *
+oes_event_registration_find(const int br_id,
+                            const enum oes_event event_id,
+                            const struct oes_event_channel *channel_p)
+{
+    int i;
+
+    for (i = 0; i < OES_EVENT_MAX_REGISTRATIONS; i++) {
+        struct oes_event_registration *reg_p = &oes_event_registrations[i];
+
+        if (reg_p->in_use && reg_p->br_id == br_id &&
+            reg_p->event_id == event_id && reg_p->channel == channel_p) {
+            return reg_p;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Returns non zero if the event passes the filter. Only the fields the
+ * event actually carries are checked: a FLUSH_ALL passes any port or
+ * vid filter, a port event passes any vid filter.
+ */
+static int
+oes_event_filter_match(const struct oes_event_filter *filter_p,
+                       const struct oes_event_info *event_info_p)
+{
+    const struct oes_event_fdb *fdb_p = &event_info_p->event_info.fdb_event;
+    unsigned long port = 0;
+    unsigned int  vid = 0;
+    int           has_port = 0;
+    int           has_vid = 0;
+
+    switch (event_info_p->event_id) {
+    case OES_EVENT_ID_PORT:
+        port = event_info_p->event_info.port_event.log_port;
+        has_port = 1;
+        break;
+
+    case OES_EVENT_ID_FDB:
+        if (filter_p->enable_fdb_event_type &&
+            !(filter_p->fdb_event_type_mask & (1U << fdb_p->fbd_event_type))) {
+            return 0;
+        }
+        switch (fdb_p->fbd_event_type) {
+        case OES_FDB_EVENT_LEARN:
+        case OES_FDB_EVENT_AGE:
+            port = fdb_p->fdb_event_data.fdb_entry.fdb_entry.log_port;
+            vid = fdb_p->fdb_event_data.fdb_entry.fdb_entry.vid;
+            has_port = has_vid = 1;
+            break;
+        case OES_FDB_EVENT_FLUSH_PORT:
+            port = fdb_p->fdb_event_data.fdb_port.port;
+            has_port = 1;
+            break;
+        case OES_FDB_EVENT_FLUSH_VID:
+            vid = fdb_p->fdb_event_data.fdb_vid.vid;
+            has_vid = 1;
+            break;
+        case OES_FDB_EVENT_FLUSH_PORT_VID:
+            port = fdb_p->fdb_event_data.fdb_port_vid.port;
+            vid = fdb_p->fdb_event_data.fdb_port_vid.vid;
+            has_port = has_vid = 1;
+            break;
+        default:
+            break;
+        }
+        break;
+    }
+
+    if (filter_p->enable_port && has_port &&
+        (port >= OES_MAX_PORTS || !OES_BITMAP_TEST(filter_p->port_bitmap, port))) {
+        return 0;
+    }
+    if (filter_p->enable_vid && has_vid &&
+        (vid >= OES_MAX_VLANS || !OES_BITMAP_TEST(filter_p->vid_bitmap, vid))) {
+        return 0;
+    }
+    return 1;
+}
+
+static void
+oes_event_channel_push(struct oes_event_channel *channel_p,
+                       const struct oes_event_info *event_info_p)
+{
+    unsigned long long one = 1;
+    int                signal = 0;
+
+    pthread_mutex_lock(&channel_p->lock);
+    if (channel_p->tail - channel_p->head == OES_EVENT_RING_SIZE) {
+        channel_p->dropped++;
+        pthread_mutex_unlock(&channel_p->lock);
+        return;
+    }
+    channel_p->ring[channel_p->tail & (OES_EVENT_RING_SIZE - 1)] = *event_info_p;
+    __atomic_store_n(&channel_p->tail, channel_p->tail + 1, __ATOMIC_RELEASE);
+
+    switch (channel_p->notify_mode) {
+    case OES_EVENT_NOTIFY_EVERY_EVENT:
+        signal = 1;
+        break;
+    case OES_EVENT_NOTIFY_EDGE:
+        signal = !channel_p->signaled;
+        break;
+    case OES_EVENT_NOTIFY_HYBRID:
+        /* a spinning consumer sees the tail move, no syscall needed */
+        signal = !channel_p->signaled && !channel_p->spinning;
+        break;
+    }
+    if (signal) {
+        if (write(channel_p->fd, &one, sizeof(one)) != sizeof(one)) {
+            /* counter saturated, fd is readable anyway */
+        }
+        channel_p->signaled = 1;
+    }
+    pthread_mutex_unlock(&channel_p->lock);
+}
+
+/* returns non zero if an event was popped */
+static int
+oes_event_channel_pop(struct oes_event_channel *channel_p,
+                      struct oes_event_info *event_info_p)
+{
+    unsigned long long cnt;
+    int                popped = 0;
+
+    pthread_mutex_lock(&channel_p->lock);
+    if (channel_p->head != channel_p->tail) {
+        *event_info_p = channel_p->ring[channel_p->head & (OES_EVENT_RING_SIZE - 1)];
+        channel_p->head++;
+        popped = 1;
+    }
+    if ((channel_p->head == channel_p->tail) && channel_p->signaled && !channel_p->closing) {
+        /* ring drained: clear the eventfd so the fd stops polling readable */
+        if (read(channel_p->fd, &cnt, sizeof(cnt)) != sizeof(cnt)) {
+            /* already clear (EAGAIN) */
+        }
+        channel_p->signaled = 0;
+    }
+    pthread_mutex_unlock(&channel_p->lock);
+    return popped;
+}
+
+/*
+ * HYBRID mode: poll the ring tail for up to busy_poll_usec. While the
+ * spinning flag is set producers skip the eventfd write. Returns non
+ * zero if an event was popped.
+ */
+static int
+oes_event_channel_busy_poll(struct oes_event_channel *channel_p,
+                            struct oes_event_info *event_info_p)
+{
+    struct timespec start, now;
+    long long       elapsed_nsec;
+    unsigned int    spins = 0;
+
+    pthread_mutex_lock(&channel_p->lock);
+    channel_p->spinning = 1;
+    pthread_mutex_unlock(&channel_p->lock);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (;;) {
+        if ((__atomic_load_n(&channel_p->tail, __ATOMIC_ACQUIRE) != channel_p->head) ||
+            __atomic_load_n(&channel_p->closing, __ATOMIC_RELAXED)) {
+            break;
+        }
+        if ((++spins & 63) == 0) {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            elapsed_nsec = (now.tv_sec - start.tv_sec) * 1000000000LL +
+                           (now.tv_nsec - start.tv_nsec);
+            if (elapsed_nsec >= channel_p->busy_poll_usec * 1000LL) {
+                break;
+            }
+        }
+    }
+
+    /* stop spinning under the lock so a racing producer signals the fd */
+    pthread_mutex_lock(&channel_p->lock);
+    channel_p->spinning = 0;
+    pthread_mutex_unlock(&channel_p->lock);
+
+    return oes_event_channel_pop(channel_p, event_info_p);
+}
+
 /**
  * This function sets the log verbosity level of EVENT  MODULE
  * @param[in]  verbosity_level  - EVENT module verbosity level
@@ -68,10 +315,14 @@ oes_api_event_log_verbosity_level_get(int *verbosity_level_p)
  * This function retrieves the file descriptor of the current open channel
  * used for receiving a event
  *
+ * On CREATE, event_fd_vs_ext may point to a struct
+ * oes_event_fd_params selecting the fd notify mode. NULL selects
+ * OES_EVENT_NOTIFY_EVERY_EVENT.
+ *
  * @param[in] access_cmd - CREATE/DESTROY
  * @param[out] fd_p - file descriptor
  * @param[in,out] event_fd_vs_ext - vendor specific
- *       extention
+ *       extention, struct oes_event_fd_params * or NULL
  *
  * @return OES_STATUS_SUCCESS if operation completes successfully
  * @return OES_STATUS_PARAM_ERROR if any input parameters invalid
@@ -82,18 +333,110 @@ oes_status_e
 oes_api_event_fd_set(const enum oes_access_cmd access_cmd, int *fd_p,
                      void *event_fd_vs_ext)
 {
-    return OES_STATUS_SUCCESS;
+    const struct oes_event_fd_params *params_p = event_fd_vs_ext;
+    struct oes_event_channel         *channel_p = NULL;
+    unsigned long long                one = 1;
+    oes_status_e                      status = OES_STATUS_SUCCESS;
+    int                               i;
+
+    if (fd_p == NULL) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    if ((access_cmd == OES_ACCESS_CMD_CREATE) && (params_p != NULL) &&
+        (params_p->notify_mode > OES_EVENT_NOTIFY_HYBRID)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_mutex_lock(&oes_event_db_lock);
+    switch (access_cmd) {
+    case OES_ACCESS_CMD_CREATE:
+        for (i = 0; i < OES_EVENT_MAX_CHANNELS; i++) {
+            if (!oes_event_channels[i].in_use) {
+                channel_p = &oes_event_channels[i];
+                break;
+            }
+        }
+        if (channel_p == NULL) {
+            status = OES_STATUS_NO_RESOURCES;
+            break;
+        }
+        channel_p->ring = malloc(OES_EVENT_RING_SIZE * sizeof(*channel_p->ring));
+        if (channel_p->ring == NULL) {
+            status = OES_STATUS_NO_MEMORY;
+            break;
+        }
+        channel_p->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (channel_p->fd < 0) {
+            free(channel_p->ring);
+            channel_p->ring = NULL;
+            status = OES_STATUS_ERROR;
+            break;
+        }
+        pthread_mutex_init(&channel_p->lock, NULL);
+        channel_p->head = channel_p->tail = 0;
+        channel_p->signaled = channel_p->spinning = channel_p->closing = 0;
+        channel_p->refs = 0;
+        channel_p->dropped = 0;
+        channel_p->notify_mode = OES_EVENT_NOTIFY_EVERY_EVENT;
+        channel_p->busy_poll_usec = 0;
+        if (params_p != NULL) {
+            channel_p->notify_mode = params_p->notify_mode;
+            channel_p->busy_poll_usec = params_p->busy_poll_usec;
+        }
+        channel_p->in_use = 1;
+        *fd_p = channel_p->fd;
+        break;
+
+    case OES_ACCESS_CMD_DESTROY:
+        channel_p = oes_event_channel_find(*fd_p);
+        if (channel_p == NULL) {
+            status = OES_STATUS_ENTRY_NOT_FOUND;
+            break;
+        }
+        for (i = 0; i < OES_EVENT_MAX_REGISTRATIONS; i++) {
+            if (oes_event_registrations[i].channel == channel_p) {
+                memset(&oes_event_registrations[i], 0, sizeof(oes_event_registrations[i]));
+            }
+        }
+        /* wake the receivers and wait for them to let go of the channel */
+        pthread_mutex_lock(&channel_p->lock);
+        __atomic_store_n(&channel_p->closing, 1, __ATOMIC_RELAXED);
+        if (write(channel_p->fd, &one, sizeof(one)) != sizeof(one)) {
+            /* counter saturated, fd is readable anyway */
+        }
+        pthread_mutex_unlock(&channel_p->lock);
+        while (channel_p->refs) {
+            pthread_cond_wait(&oes_event_db_cond, &oes_event_db_lock);
+        }
+        close(channel_p->fd);
+        pthread_mutex_destroy(&channel_p->lock);
+        free(channel_p->ring);
+        memset(channel_p, 0, sizeof(*channel_p));
+        break;
+
+    default:
+        status = OES_STATUS_CMD_UNSUPPORTED;
+        break;
+    }
+    pthread_mutex_unlock(&oes_event_db_lock);
+
+    return status;
 }
 
 /**
  * Register/DeRegister Events  (Port up /down , FDB event)
  *
- * @param[in] access_cmd - ADD/DELETE    -
+ * A registration may carry a struct oes_event_filter, passed as
+ * event_register_vs_ext on ADD/EDIT. The filter is evaluated
+ * when the event is produced, so events that do not match are
+ * never queued on fd.
+ *
+ * @param[in] access_cmd - ADD/EDIT/DELETE    -
  * @param[in] br_id - Bridge id
  * @param[in] event_id - Event ID.
  * @param[in] fd - The file descriptor for the events to be send.
  * @param[in,out] event_register_vs_ext - vendor specific
- *       extention
+ *       extention, struct oes_event_filter * or NULL
  *
  * @return OES_STATUS_SUCCESS if operation completes successfully
  * @return OES_STATUS_PARAM_ERROR if any input parameters is
@@ -107,7 +450,73 @@ oes_api_event_register_set(const enum oes_access_cmd access_cmd,
                            const int fd,
                            void *event_register_vs_ext)
 {
-    return OES_STATUS_SUCCESS;
+    const struct oes_event_filter *filter_p = event_register_vs_ext;
+    struct oes_event_channel      *channel_p;
+    struct oes_event_registration *reg_p;
+    oes_status_e                   status = OES_STATUS_SUCCESS;
+    int                            i;
+
+    if ((event_id != OES_EVENT_ID_FDB) && (event_id != OES_EVENT_ID_PORT)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_mutex_lock(&oes_event_db_lock);
+    channel_p = oes_event_channel_find(fd);
+    if (channel_p == NULL) {
+        status = OES_STATUS_PARAM_ERROR;
+        goto out;
+    }
+    reg_p = oes_event_registration_find(br_id, event_id, channel_p);
+
+    switch (access_cmd) {
+    case OES_ACCESS_CMD_ADD:
+        if (reg_p != NULL) {
+            status = OES_STATUS_ENTRY_ALREADY_EXISTS;
+            break;
+        }
+        for (i = 0; i < OES_EVENT_MAX_REGISTRATIONS; i++) {
+            if (!oes_event_registrations[i].in_use) {
+                reg_p = &oes_event_registrations[i];
+                break;
+            }
+        }
+        if (reg_p == NULL) {
+            status = OES_STATUS_NO_RESOURCES;
+            break;
+        }
+        reg_p->br_id = br_id;
+        reg_p->event_id = event_id;
+        reg_p->channel = channel_p;
+        /* fall through */
+
+    case OES_ACCESS_CMD_EDIT:
+        if (reg_p == NULL) {
+            status = OES_STATUS_ENTRY_NOT_FOUND;
+            break;
+        }
+        reg_p->has_filter = (filter_p != NULL);
+        if (filter_p != NULL) {
+            reg_p->filter = *filter_p;
+        }
+        reg_p->in_use = 1;
+        break;
+
+    case OES_ACCESS_CMD_DELETE:
+        if (reg_p == NULL) {
+            status = OES_STATUS_ENTRY_NOT_FOUND;
+            break;
+        }
+        memset(reg_p, 0, sizeof(*reg_p));
+        break;
+
+    default:
+        status = OES_STATUS_CMD_UNSUPPORTED;
+        break;
+    }
+
+out:
+    pthread_mutex_unlock(&oes_event_db_lock);
+    return status;
 }
 
 /**
@@ -120,12 +529,98 @@ oes_api_event_register_set(const enum oes_access_cmd access_cmd,
  *@return OES_STATUS_SUCCESS if operation completes successfully
  *@return OES_STATUS_PARAM_ERROR if any input parameters is
  *         invalid
- *@return OES_STATUS_ERROR general error
+ *@return OES_STATUS_ERROR general error, or fd destroyed while
+ *         waiting
  */
 oes_status_e
 oes_api_event_recv(const int fd,
                    struct oes_event_info *event_info_p,
                    void *event_recv_vs_ext)
 {
+    struct oes_event_channel *channel_p;
+    struct pollfd             pfd;
+    oes_status_e              status = OES_STATUS_SUCCESS;
+
+    if (event_info_p == NULL) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    /* the reference keeps DESTROY from freeing the channel under us */
+    pthread_mutex_lock(&oes_event_db_lock);
+    channel_p = oes_event_channel_find(fd);
+    if (channel_p != NULL) {
+        channel_p->refs++;
+    }
+    pthread_mutex_unlock(&oes_event_db_lock);
+    if (channel_p == NULL) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    if (oes_event_channel_pop(channel_p, event_info_p)) {
+        goto out;
+    }
+    if ((channel_p->notify_mode == OES_EVENT_NOTIFY_HYBRID) &&
+        oes_event_channel_busy_poll(channel_p, event_info_p)) {
+        goto out;
+    }
+
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    while (!oes_event_channel_pop(channel_p, event_info_p)) {
+        /* once closing the eventfd is never cleared, so poll cannot miss the wakeup */
+        if (__atomic_load_n(&channel_p->closing, __ATOMIC_RELAXED) ||
+            ((poll(&pfd, 1, -1) < 0) && (errno != EINTR))) {
+            status = OES_STATUS_ERROR;
+            break;
+        }
+    }
+
+out:
+    pthread_mutex_lock(&oes_event_db_lock);
+    if ((--channel_p->refs == 0) && channel_p->closing) {
+        pthread_cond_broadcast(&oes_event_db_cond);
+    }
+    pthread_mutex_unlock(&oes_event_db_lock);
+    return status;
+}
+
+/**
+ * This function delivers an event to every fd registered for
+ * event_info_p->event_id on br_id, after evaluating each
+ * registration filter. It is called by the modules that raise
+ * events (e.g. FDB flush).
+ *
+ *@param[in] br_id - Bridge id
+ *@param[in] event_info_p  - event information
+ *
+ *@return OES_STATUS_SUCCESS if operation completes successfully
+ *@return OES_STATUS_PARAM_ERROR if any input parameters is
+ *         invalid
+ */
+oes_status_e
+oes_event_send(const int br_id,
+               const struct oes_event_info *event_info_p)
+{
+    int i;
+
+    if (event_info_p == NULL) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_mutex_lock(&oes_event_db_lock);
+    for (i = 0; i < OES_EVENT_MAX_REGISTRATIONS; i++) {
+        struct oes_event_registration *reg_p = &oes_event_registrations[i];
+
+        if (!reg_p->in_use || (reg_p->br_id != br_id) ||
+            (reg_p->event_id != event_info_p->event_id)) {
+            continue;
+        }
+        if (reg_p->has_filter && !oes_event_filter_match(&reg_p->filter, event_info_p)) {
+            continue;
+        }
+        oes_event_channel_push(reg_p->channel, event_info_p);
+    }
+    pthread_mutex_unlock(&oes_event_db_lock);
+
     return OES_STATUS_SUCCESS;
 }
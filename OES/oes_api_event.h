@@ -67,10 +67,16 @@ oes_api_event_log_verbosity_level_get(
 * This function retrieves the file descriptor of the current open channel
 * used for receiving a event 
 *  
+* On CREATE, event_fd_vs_ext may point to a struct 
+* oes_event_fd_params selecting how the fd is signaled: on every 
+* event, only on the empty to non empty transition, or 
+* edge signaled with a busy poll of busy_poll_usec in 
+* oes_api_event_recv before it sleeps. NULL selects every event. 
+*  
 * @param[in] access_cmd - CREATE/DESTROY
 * @param[out] fd_p - file descriptor 
 * @param[in,out] event_fd_vs_ext - vendor specific 
- *       extention 
+ *       extention, struct oes_event_fd_params * or NULL
 *
 * @return OES_STATUS_SUCCESS if operation completes successfully
 * @return OES_STATUS_PARAM_ERROR if any input parameters invalid 
@@ -87,17 +93,29 @@ oes_api_event_fd_set(
 
 /**
 * Register/DeRegister Events  (Port up /down , FDB event)
+* 
+* A registration may carry a struct oes_event_filter, passed as 
+* event_register_vs_ext on ADD/EDIT. The filter is evaluated 
+* when the event is produced, so events that do not match are 
+* never queued on fd. A field the event does not carry (e.g. 
+* the port of a FLUSH_ALL) never filters the event out. 
 *
-* @param[in] access_cmd - ADD/DELETE    - 
+* @param[in] access_cmd - ADD/EDIT/DELETE    - 
 * @param[in] br_id - Bridge id 
 * @param[in] event_id - Event ID.
 * @param[in] fd - The file descriptor for the events to be send.
 * @param[in,out] event_register_vs_ext - vendor specific
-*       extention
+*       extention, struct oes_event_filter * or NULL for no
+*       filter
 * 
 * @return OES_STATUS_SUCCESS if operation completes successfully
 * @return OES_STATUS_PARAM_ERROR if any input parameters is 
 *         invalid
+* @return OES_STATUS_ENTRY_ALREADY_EXISTS if ADD of an existing 
+*         registration
+* @return OES_STATUS_ENTRY_NOT_FOUND if EDIT/DELETE of a missing 
+*         registration
+* @return OES_STATUS_NO_RESOURCES if registration table is full
 * @return OES_STATUS_ERROR general error 
 */
 oes_status_e
@@ -112,6 +130,10 @@ oes_api_event_register_set(
 
 /**
 * This API enables the user to receive   Events. 
+* The call blocks until an event is queued on fd. fd becomes 
+* readable (poll/select) while events are pending. A DESTROY
+* of fd wakes the calls waiting on it, which return
+* OES_STATUS_ERROR.
 *
 *@param[in] fd - File descriptor to listen on.
 *@param[out]oes_event_info_p  - event information 
@@ -130,4 +152,27 @@ oes_api_event_recv(
                   void * event_recv_vs_ext
                   );
 
+/************************************************
+ *  Event producer functions
+ ***********************************************/
+
+/**
+* This function delivers an event to every fd registered for 
+* event_info_p->event_id on br_id, after evaluating each 
+* registration filter. It is called by the modules that raise 
+* events (e.g. FDB flush). 
+*
+*@param[in] br_id - Bridge id 
+*@param[in] event_info_p  - event information 
+*
+*@return OES_STATUS_SUCCESS if operation completes successfully 
+*@return OES_STATUS_PARAM_ERROR if any input parameters is 
+*         invalid
+*/
+oes_status_e
+oes_event_send(
+              const int  br_id,
+              const struct oes_event_info * event_info_p
+              );
+
 #endif /* __OES_API_EVENT_H__ */
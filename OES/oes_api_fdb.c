@@ -31,9 +31,41 @@
 #include <netinet/if_ether.h>
 #include <net/if.h>
 #include <netinet/in.h>
+#include <string.h>
 #include "oes_status.h"
 #include "oes_types.h"
 #include "oes_api_fdb.h"
+#include "oes_api_event.h"
+
+/* raises an FDB flush event of the given type towards the event module */
+static void
+oes_fdb_flush_event_send(const int br_id,
+                         const enum oes_fdb_event_type event_type,
+                         const unsigned long log_port,
+                         const unsigned short vid)
+{
+    struct oes_event_info event_info;
+    union oes_fdb_event_data *data_p = &event_info.event_info.fdb_event.fdb_event_data;
+
+    memset(&event_info, 0, sizeof(event_info));
+    event_info.event_id = OES_EVENT_ID_FDB;
+    event_info.event_info.fdb_event.fbd_event_type = event_type;
+    switch (event_type) {
+    case OES_FDB_EVENT_FLUSH_PORT:
+        data_p->fdb_port.port = log_port;
+        break;
+    case OES_FDB_EVENT_FLUSH_VID:
+        data_p->fdb_vid.vid = vid;
+        break;
+    case OES_FDB_EVENT_FLUSH_PORT_VID:
+        data_p->fdb_port_vid.port = log_port;
+        data_p->fdb_port_vid.vid = vid;
+        break;
+    default:
+        break;
+    }
+    oes_event_send(br_id, &event_info);
+}
 
 /**
  * This function sets the log verbosity level of FDB MODULE
@@ -359,6 +391,7 @@ oes_status_e
 oes_api_fdb_uc_flush_set(const int br_id,
                          void *fdb_uc_flush_vs_ext)
 {
+    oes_fdb_flush_event_send(br_id, OES_FDB_EVENT_FLUSH_ALL, 0, 0);
     return OES_STATUS_SUCCESS;
 }
 
@@ -381,6 +414,7 @@ oes_api_fdb_uc_flush_port_set(const int br_id,
                               const unsigned long log_port,
                               void *fdb_uc_flush_port_vs_ext)
 {
+    oes_fdb_flush_event_send(br_id, OES_FDB_EVENT_FLUSH_PORT, log_port, 0);
     return OES_STATUS_SUCCESS;
 }
 
@@ -403,6 +437,7 @@ oes_api_fdb_uc_flush_vid_set(const int br_id,
                              const unsigned short vid,
                              void *fdb_uc_flush_vid_vs_ext)
 {
+    oes_fdb_flush_event_send(br_id, OES_FDB_EVENT_FLUSH_VID, 0, vid);
     return OES_STATUS_SUCCESS;
 }
 
@@ -426,6 +461,7 @@ oes_api_fdb_uc_flush_port_vid_set(const int br_id,
                                   const unsigned long log_port,
                                   void *fdb_uc_flush_port_vid_vs_ext)
 {
+    oes_fdb_flush_event_send(br_id, OES_FDB_EVENT_FLUSH_PORT_VID, log_port, vid);
     return OES_STATUS_SUCCESS;
 }
 
@@ -0,0 +1,513 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_api_lag.h"
+#include "oes_api_vlan.h"
+
+#define OES_LAG_MAX_BRIDGES           4096
+#define OES_LAG_PORT_WORDS            OES_BITMAP_WORDS(OES_MAX_PORTS)
+#define OES_LAG_NONE                  0xff
+
+/*
+ * LAG port groups of a bridge. Group i is the logical port
+ * OES_LAG_PORT_BASE + i; its members are ports below OES_LAG_PORT_BASE,
+ * each in one group at most, collecting and distributing when added.
+ */
+struct oes_lag_group {
+    unsigned char      in_use;
+    unsigned long long members[OES_LAG_PORT_WORDS];
+    unsigned long long collecting[OES_LAG_PORT_WORDS];
+    unsigned long long distributing[OES_LAG_PORT_WORDS];
+};
+
+struct oes_lag_bridge {
+    struct oes_lag_group      groups[OES_LAG_MAX_GROUPS];
+    unsigned char             port_group[OES_LAG_PORT_BASE];   /**< group of each port, or OES_LAG_NONE */
+    struct oes_lag_hash_param hash_param;
+};
+
+static pthread_rwlock_t       oes_lag_lock = PTHREAD_RWLOCK_INITIALIZER;
+static struct oes_lag_bridge *oes_lag_bridges[OES_LAG_MAX_BRIDGES];
+
+/* Returns the bridge, allocating it if create is set, or NULL. */
+static struct oes_lag_bridge *
+oes_lag_bridge_get(const int br_id, int create)
+{
+    struct oes_lag_bridge *br_p;
+
+    if ((br_id < 0) || (br_id >= OES_LAG_MAX_BRIDGES)) {
+        return NULL;
+    }
+    if (!oes_lag_bridges[br_id] && create) {
+        br_p = calloc(1, sizeof(struct oes_lag_bridge));
+        if (!br_p) {
+            return NULL;
+        }
+        memset(br_p->port_group, OES_LAG_NONE, sizeof(br_p->port_group));
+        oes_lag_bridges[br_id] = br_p;
+    }
+    return oes_lag_bridges[br_id];
+}
+
+/* Returns the group of a LAG port, or NULL if it was not created. */
+static struct oes_lag_group *
+oes_lag_group_get(struct oes_lag_bridge *br_p, unsigned long lag_port)
+{
+    if (!br_p || (lag_port < OES_LAG_PORT_BASE) || (lag_port >= OES_MAX_PORTS) ||
+        !br_p->groups[lag_port - OES_LAG_PORT_BASE].in_use) {
+        return NULL;
+    }
+    return &br_p->groups[lag_port - OES_LAG_PORT_BASE];
+}
+
+/* Recomputes the flood sets of the VLANs of a LAG and of ports that joined or left it. */
+static void
+oes_lag_flood_refresh(const int br_id, unsigned long lag_port, const unsigned long long *ports)
+{
+    unsigned long long refresh[OES_LAG_PORT_WORDS];
+
+    if (ports) {
+        memcpy(refresh, ports, sizeof(refresh));
+    } else {
+        memset(refresh, 0, sizeof(refresh));
+    }
+    OES_BITMAP_SET(refresh, lag_port);
+    oes_vlan_flood_ports_refresh(br_id, refresh);
+}
+
+/**
+ * This function sets the log verbosity level of LAG MODULE
+ * @param[in]  verbosity_level  - LAG module verbosity level
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR - Unsupported verbosity_level
+ * @return OES_STATUS_ERROR general error.
+ */
+oes_status_e
+oes_api_lag_log_verbosity_level_set(const int verbosity_level)
+{
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * This function gets the log verbosity level of LAG MODULE
+ * @param[out]  verbosity_level_p  - LAG module verbosity level
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR - Unsupported verbosity_level
+ * @return OES_STATUS_ERROR general error.
+ */
+oes_status_e
+oes_api_lag_log_verbosity_level_get(int *verbosity_level_p)
+{
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * This function CREATEs/DESTROYs a new/existing LAG ports group.
+ * Plus, it ADDs/DELETEs ports to/from an existing LAG ports group.
+ * LAG ports are the logical ports OES_LAG_PORT_BASE and up, their
+ * members the ports below.
+ *
+ * @param[in] access_cmd - CREATE/DESTROY/ADD/DELETE.
+ * @param[in] br_id - Bridge id
+ * @param[in,out] lag_port_p - In: Already created LAG ports group ID.
+ *       Out: Newly created LAG ports group ID.
+ * @param[in] log_port_list_p - List of Logical Ports to ADD/DELETE
+ *       to/from a LAG ports group.
+ * @param[in] port_cnt - Number of Logical Ports to ADD/DELETE
+ * @param[in,out] lag_port_group_vs_ext - vendor specific extention
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR - Parameter is invalid, a port to add
+ *       is in a LAG already or a port to delete is not a member, or the
+ *       group to destroy has members.
+ * @return OES_STATUS_ENTRY_NOT_FOUND - the LAG was not created.
+ * @return OES_STATUS_NO_RESOURCES - all LAG ports are in use.
+ * @return OES_STATUS_CMD_UNSUPPORTED - access_cmd is not supported.
+ */
+oes_status_e
+oes_api_lag_port_group_set(const enum oes_access_cmd access_cmd,
+                           const int br_id,
+                           unsigned long *lag_port_p,
+                           const unsigned long *log_port_list_p,
+                           const unsigned short port_cnt,
+                           void *lag_port_group_vs_ext)
+{
+    unsigned long long     ports[OES_LAG_PORT_WORDS];
+    struct oes_lag_bridge *br_p;
+    struct oes_lag_group  *group_p = NULL;
+    oes_status_e           status = OES_STATUS_SUCCESS;
+    unsigned long          port;
+    unsigned int           i, w;
+
+    if ((br_id < 0) || (br_id >= OES_LAG_MAX_BRIDGES) || !lag_port_p ||
+        (port_cnt && !log_port_list_p)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    memset(ports, 0, sizeof(ports));
+
+    pthread_rwlock_wrlock(&oes_lag_lock);
+    br_p = oes_lag_bridge_get(br_id, access_cmd == OES_ACCESS_CMD_CREATE);
+    if (access_cmd != OES_ACCESS_CMD_CREATE) {
+        group_p = oes_lag_group_get(br_p, *lag_port_p);
+        if (!group_p) {
+            status = OES_STATUS_ENTRY_NOT_FOUND;
+            goto out;
+        }
+    }
+    switch (access_cmd) {
+    case OES_ACCESS_CMD_CREATE:
+        if (!br_p) {
+            status = OES_STATUS_NO_MEMORY;
+            goto out;
+        }
+        for (i = 0; (i < OES_LAG_MAX_GROUPS) && br_p->groups[i].in_use; i++) {
+        }
+        if (i == OES_LAG_MAX_GROUPS) {
+            status = OES_STATUS_NO_RESOURCES;
+            goto out;
+        }
+        memset(&br_p->groups[i], 0, sizeof(br_p->groups[i]));
+        br_p->groups[i].in_use = 1;
+        *lag_port_p = OES_LAG_PORT_BASE + i;
+        break;
+    case OES_ACCESS_CMD_DESTROY:
+        for (w = 0; w < OES_LAG_PORT_WORDS; w++) {
+            if (group_p->members[w]) {
+                status = OES_STATUS_PARAM_ERROR;
+                goto out;
+            }
+        }
+        group_p->in_use = 0;
+        break;
+    case OES_ACCESS_CMD_ADD:
+    case OES_ACCESS_CMD_DELETE:
+        for (i = 0; i < port_cnt; i++) {
+            port = log_port_list_p[i];
+            if ((port >= OES_LAG_PORT_BASE) ||
+                ((access_cmd == OES_ACCESS_CMD_ADD) && (br_p->port_group[port] != OES_LAG_NONE)) ||
+                ((access_cmd == OES_ACCESS_CMD_DELETE) && !OES_BITMAP_TEST(group_p->members, port))) {
+                status = OES_STATUS_PARAM_ERROR;
+                goto out;
+            }
+        }
+        for (i = 0; i < port_cnt; i++) {
+            port = log_port_list_p[i];
+            OES_BITMAP_SET(ports, port);
+            if (access_cmd == OES_ACCESS_CMD_ADD) {
+                br_p->port_group[port] = *lag_port_p - OES_LAG_PORT_BASE;
+                OES_BITMAP_SET(group_p->members, port);
+                OES_BITMAP_SET(group_p->collecting, port);
+                OES_BITMAP_SET(group_p->distributing, port);
+            } else {
+                br_p->port_group[port] = OES_LAG_NONE;
+                OES_BITMAP_CLR(group_p->members, port);
+                OES_BITMAP_CLR(group_p->collecting, port);
+                OES_BITMAP_CLR(group_p->distributing, port);
+            }
+        }
+        break;
+    default:
+        status = OES_STATUS_CMD_UNSUPPORTED;
+        break;
+    }
+out:
+    pthread_rwlock_unlock(&oes_lag_lock);
+    if (status == OES_STATUS_SUCCESS) {
+        oes_lag_flood_refresh(br_id, *lag_port_p, ports);
+    }
+    return status;
+}
+
+/**
+ * This function retrieves an existing LAG's ports group, in port order.
+ * If the output ports list is NULL, only the number of ports in the
+ * LAG's retrieved.
+ *
+ * @param[in] access_cmd - unused.
+ * @param[in] br_id - Bridge id
+ * @param[in] lag_port - Already created LAG ports group ID.
+ * @param[out] log_port_list_p - List of the Logical Ports of the LAG.
+ * @param[in,out] port_cnt_p - In: size of the list. Out: Number of
+ *       Logical Ports retrieved.
+ * @param[in,out] lag_port_group_vs_ext - vendor specific extention
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR - Parameter is invalid.
+ * @return OES_STATUS_ENTRY_NOT_FOUND - the LAG was not created.
+ */
+oes_status_e
+oes_api_lag_port_group_get(const enum oes_access_cmd access_cmd,
+                           const int br_id,
+                           const unsigned long lag_port,
+                           unsigned long *log_port_list_p,
+                           unsigned short *port_cnt_p,
+                           void *lag_port_group_vs_ext)
+{
+    struct oes_lag_group *group_p;
+    unsigned long long    bits;
+    oes_status_e          status = OES_STATUS_SUCCESS;
+    unsigned int          w, cnt = 0;
+
+    if ((br_id < 0) || (br_id >= OES_LAG_MAX_BRIDGES) || !port_cnt_p) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_rwlock_rdlock(&oes_lag_lock);
+    group_p = oes_lag_group_get(oes_lag_bridge_get(br_id, 0), lag_port);
+    if (!group_p) {
+        status = OES_STATUS_ENTRY_NOT_FOUND;
+        goto out;
+    }
+    for (w = 0; w < OES_LAG_PORT_WORDS; w++) {
+        if (!log_port_list_p) {
+            cnt += __builtin_popcountll(group_p->members[w]);
+            continue;
+        }
+        for (bits = group_p->members[w]; bits && (cnt < *port_cnt_p); bits &= bits - 1) {
+            log_port_list_p[cnt++] = w * OES_BITMAP_WORD_BITS + __builtin_ctzll(bits);
+        }
+    }
+    *port_cnt_p = cnt;
+out:
+    pthread_rwlock_unlock(&oes_lag_lock);
+    return status;
+}
+
+/* Sets or clears a member's bit in a per-group member state bitmap. */
+static oes_status_e
+oes_lag_member_state_set(const int br_id,
+                         const unsigned long lag_log_port,
+                         const unsigned long log_port,
+                         const int enable,
+                         const int distributing)
+{
+    struct oes_lag_group *group_p;
+    unsigned long long   *state;
+    oes_status_e          status = OES_STATUS_SUCCESS;
+
+    if ((br_id < 0) || (br_id >= OES_LAG_MAX_BRIDGES) || (log_port >= OES_LAG_PORT_BASE)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_rwlock_wrlock(&oes_lag_lock);
+    group_p = oes_lag_group_get(oes_lag_bridge_get(br_id, 0), lag_log_port);
+    if (!group_p) {
+        status = OES_STATUS_ENTRY_NOT_FOUND;
+        goto out;
+    }
+    if (!OES_BITMAP_TEST(group_p->members, log_port)) {
+        status = OES_STATUS_PARAM_ERROR;
+        goto out;
+    }
+    state = distributing ? group_p->distributing : group_p->collecting;
+    if (enable) {
+        OES_BITMAP_SET(state, log_port);
+    } else {
+        OES_BITMAP_CLR(state, log_port);
+    }
+out:
+    pthread_rwlock_unlock(&oes_lag_lock);
+    if ((status == OES_STATUS_SUCCESS) && distributing) {
+        oes_lag_flood_refresh(br_id, lag_log_port, NULL);
+    }
+    return status;
+}
+
+/**
+ * This function enables/disables collection on a specific LAG port.
+ *
+ * @param[in] br_id - Bridge id
+ * @param[in] lag_log_port - A logical port number representing the LAG ports group
+ * @param[in] log_port - logical port number, a member of the LAG
+ * @param[in] collector_mode - collector mode
+ * @param[in,out] lag_port_collector_vs_ext - vendor specific extention
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR - Parameter is invalid.
+ * @return OES_STATUS_ENTRY_NOT_FOUND - the LAG was not created.
+ */
+oes_status_e
+oes_api_lag_port_collector_set(const int br_id,
+                               const unsigned long lag_log_port,
+                               const unsigned long log_port,
+                               const enum oes_collector_mode collector_mode,
+                               void *lag_port_collector_vs_ext)
+{
+    return oes_lag_member_state_set(br_id, lag_log_port, log_port,
+                                    collector_mode == OES_COLLECTOR_ENABLE, 0);
+}
+
+/**
+ * This function enables/disables distribution on a specific LAG port.
+ * Floods to the LAG leave through its first distributing member.
+ *
+ * @param[in] br_id - Bridge id
+ * @param[in] lag_log_port - A logical port number representing the LAG ports group
+ * @param[in] log_port - logical port number, a member of the LAG
+ * @param[in] distributor_mode - distributor mode
+ * @param[in,out] lag_port_distributor_vs_ext - vendor specific extention
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR - Parameter is invalid.
+ * @return OES_STATUS_ENTRY_NOT_FOUND - the LAG was not created.
+ */
+oes_status_e
+oes_api_lag_port_distributor_set(const int br_id,
+                                 const unsigned long lag_log_port,
+                                 const unsigned long log_port,
+                                 const enum oes_distributor_mode distributor_mode,
+                                 void *lag_port_distributor_vs_ext)
+{
+    return oes_lag_member_state_set(br_id, lag_log_port, log_port,
+                                    distributor_mode == OES_DISTRIBUTOR_ENABLE, 1);
+}
+
+/**
+ * This function configures the flow indicators that impact the LAG
+ * hash distribution function.
+ *
+ * @param[in] br_id - Bridge id
+ * @param[in] lag_hash_param_p - Hash parameters
+ * @param[in,out] lag_hash_vs_ext - vendor specific extention
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR - Parameter is invalid.
+ * @return OES_STATUS_NO_MEMORY - the bridge could not be allocated.
+ */
+oes_status_e
+oes_api_lag_hash_set(const int br_id,
+                     const struct oes_lag_hash_param *lag_hash_param_p,
+                     void *lag_hash_vs_ext)
+{
+    struct oes_lag_bridge *br_p;
+    oes_status_e           status = OES_STATUS_SUCCESS;
+
+    if ((br_id < 0) || (br_id >= OES_LAG_MAX_BRIDGES) || !lag_hash_param_p) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_rwlock_wrlock(&oes_lag_lock);
+    br_p = oes_lag_bridge_get(br_id, 1);
+    if (!br_p) {
+        status = OES_STATUS_NO_MEMORY;
+    } else {
+        br_p->hash_param = *lag_hash_param_p;
+    }
+    pthread_rwlock_unlock(&oes_lag_lock);
+    return status;
+}
+
+/**
+ * This function retrieves the flow indicators that impact the LAG hash
+ * distribution function.
+ *
+ * @param[in] br_id - Bridge id
+ * @param[out] lag_hash_param_p - Hash parameters
+ * @param[in,out] lag_hash_vs_ext - vendor specific extention
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR - Parameter is invalid.
+ */
+oes_status_e
+oes_api_lag_hash_get(const int br_id,
+                     struct oes_lag_hash_param *lag_hash_param_p,
+                     void *lag_hash_vs_ext)
+{
+    struct oes_lag_bridge *br_p;
+
+    if ((br_id < 0) || (br_id >= OES_LAG_MAX_BRIDGES) || !lag_hash_param_p) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_rwlock_rdlock(&oes_lag_lock);
+    br_p = oes_lag_bridge_get(br_id, 0);
+    if (br_p) {
+        *lag_hash_param_p = br_p->hash_param;
+    } else {
+        memset(lag_hash_param_p, 0, sizeof(*lag_hash_param_p));
+    }
+    pthread_rwlock_unlock(&oes_lag_lock);
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * This function returns the LAG state flooding needs: the LAG ports in
+ * use, the ports that are members of a LAG, and per LAG the member a
+ * flood leaves through, the first with distribution enabled.
+ *
+ * @param[in] br_id - Bridge id
+ * @param[out] lag_ports - bitmap of the LAG ports in use
+ * @param[out] lag_members - bitmap of the ports in a LAG
+ * @param[out] designated - per LAG the flood member, OES_MAX_PORTS if none
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR - Parameter is invalid.
+ */
+oes_status_e
+oes_lag_flood_snapshot(const int br_id,
+                       unsigned long long *lag_ports,
+                       unsigned long long *lag_members,
+                       unsigned short *designated)
+{
+    struct oes_lag_bridge *br_p;
+    struct oes_lag_group  *group_p;
+    unsigned int           i, w;
+
+    if ((br_id < 0) || (br_id >= OES_LAG_MAX_BRIDGES)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    memset(lag_ports, 0, OES_LAG_PORT_WORDS * sizeof(*lag_ports));
+    memset(lag_members, 0, OES_LAG_PORT_WORDS * sizeof(*lag_members));
+
+    pthread_rwlock_rdlock(&oes_lag_lock);
+    br_p = oes_lag_bridge_get(br_id, 0);
+    for (i = 0; i < OES_LAG_MAX_GROUPS; i++) {
+        designated[i] = OES_MAX_PORTS;
+        if (!br_p || !br_p->groups[i].in_use) {
+            continue;
+        }
+        group_p = &br_p->groups[i];
+        OES_BITMAP_SET(lag_ports, OES_LAG_PORT_BASE + i);
+        for (w = 0; w < OES_LAG_PORT_WORDS; w++) {
+            lag_members[w] |= group_p->members[w];
+            if ((designated[i] == OES_MAX_PORTS) && group_p->distributing[w]) {
+                designated[i] = w * OES_BITMAP_WORD_BITS + __builtin_ctzll(group_p->distributing[w]);
+            }
+        }
+    }
+    pthread_rwlock_unlock(&oes_lag_lock);
+    return OES_STATUS_SUCCESS;
+}
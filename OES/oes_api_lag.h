@@ -88,7 +88,7 @@ oes_api_lag_port_group_set(
                           const enum oes_access_cmd access_cmd,
                           const int br_id,
                           unsigned long *lag_port_p,
-                          const unsigned long  log_port_list_p,
+                          const unsigned long * log_port_list_p,
                           const unsigned short     port_cnt,
                           void * lag_port_group_vs_ext
                           );
@@ -118,7 +118,7 @@ oes_api_lag_port_group_get(
                           const enum oes_access_cmd access_cmd,
                           const int br_id,
                           const unsigned long  lag_port,
-                          unsigned long  log_port_list_p,
+                          unsigned long * log_port_list_p,
                           unsigned short   * port_cnt_p,
                           void * lag_port_group_vs_ext
                           );
@@ -167,7 +167,7 @@ oes_api_lag_port_distributor_set(
                                 const int br_id,
 	                            const unsigned long lag_log_port,
 	                            const unsigned long log_port,
-	                            const enum oes_collector_mode  distributor_mode,
+	                            const enum oes_distributor_mode  distributor_mode,
                                 void * lag_port_distributor_vs_ext
                                 );
 
@@ -185,7 +185,7 @@ oes_api_lag_port_distributor_set(
 oes_status_e 
 oes_api_lag_hash_set(
                     const int br_id, 
-			        const struct eos_lag_hash_param * lag_hash_param_p,
+			        const struct oes_lag_hash_param * lag_hash_param_p,
                     void * lag_hash_vs_ext
                     );
 
@@ -211,4 +211,27 @@ oes_api_lag_hash_get(
                     );
 
 
+/**
+ *  This function returns the LAG state flooding needs: the LAG
+ *  ports in use, the ports that are members of a LAG, and per
+ *  LAG the member a flood leaves through, the first with
+ *  distribution enabled. It is called by the VLAN module.
+ *
+ * @param[in] br_id - Bridge id
+ * @param[out] lag_ports - bitmap of the LAG ports in use
+ * @param[out] lag_members - bitmap of the ports in a LAG
+ * @param[out] designated - per LAG (lag port - OES_LAG_PORT_BASE)
+ *       the flood member, OES_MAX_PORTS if none
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR - Parameter is invalid.
+ */
+oes_status_e
+oes_lag_flood_snapshot(
+                      const int br_id,
+                      unsigned long long * lag_ports,
+                      unsigned long long * lag_members,
+                      unsigned short * designated
+                      );
+
 #endif /* __OES_API_LAG_H__ */
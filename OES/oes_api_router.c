@@ -0,0 +1,3593 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/if_ether.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_api_router.h"
+#include "oes_router_activity.h"
+#include "oes_router_cntr.h"
+#include "oes_router_ecmp.h"
+#include "oes_router_image.h"
+#include "oes_router_lpm4.h"
+#include "oes_router_l3.h"
+#include "oes_router_lpm6.h"
+#include "oes_router_mc.h"
+#include "oes_router_neigh.h"
+#include "oes_router_nhg.h"
+#include "oes_router_rif.h"
+
+#define OES_ROUTER_MAX_VRID           1024
+#define OES_ROUTER_ROUTE_NONE         0xffffffff
+#define OES_ROUTER_ROUTE_PAGE_BITS    12
+#define OES_ROUTER_ROUTE_PAGE_SIZE    (1 << OES_ROUTER_ROUTE_PAGE_BITS)
+#define OES_ROUTER_ECMP_SEED          0x4f455321
+#define OES_ROUTER_LOOKUP_BATCH       64    /**< addresses per stage of a batch lookup */
+
+#if OES_CNTR_MAX_VRIDS < OES_ROUTER_MAX_VRID
+#error "every vrid needs its interface counters"
+#endif
+#if OES_NHG_NONE != OES_ROUTER_NHG_NONE
+#error "a route without next hops reports OES_ROUTER_NHG_NONE"
+#endif
+#if OES_CNTR_MAX_RIFS < OES_RIF_MAX_RIFS
+#error "every rif needs its counters"
+#endif
+
+/*
+ * A unicast route, indexed by the next hop value stored in the FIB. The
+ * next hops live in a shared group, so a route is 8 bytes. Its activity
+ * bit lives in the vr route_activity bitmap, at the same index.
+ */
+struct oes_router_route {
+    union {
+        unsigned int        nhg_id;         /**< next hop group */
+        unsigned int        next_free;      /**< free list link while unused */
+    };
+    unsigned char           action;         /**< enum oes_router_action */
+    unsigned char           delete_pending; /**< deleted by the batch being applied */
+};
+
+/*
+ * Route records come in pages shared by a vr and its clones
+ * (oes_api_router_clone) until one of them writes to the page.
+ */
+struct oes_router_route_page {
+    unsigned int            refcnt;
+    struct oes_router_route routes[OES_ROUTER_ROUTE_PAGE_SIZE];
+};
+
+/* undo log entry kinds of a route batch */
+#define OES_ROUTER_UNDO_NEW           0     /**< route created, undone by freeing it */
+#define OES_ROUTER_UNDO_FILL          1     /**< route data replaced, old group held until commit */
+#define OES_ROUTER_UNDO_DELETE        2     /**< route marked, freed at commit */
+#define OES_ROUTER_UNDO_UNDELETE      3     /**< deletion mark cleared by a later ADD */
+
+struct oes_router_undo {
+    unsigned int            op_idx;         /**< batch operation, gives the prefix */
+    unsigned int            idx;            /**< route record */
+    unsigned int            old_nhg_id;
+    unsigned char           kind;
+    unsigned char           old_action;
+    unsigned char           old_active;
+};
+
+struct oes_router_vr {
+    unsigned char                      in_use;
+    struct oes_router_attributes       attr;
+    struct oes_router_ecmp_hash_fields ecmp_hash;
+    struct oes_ecmp_hasher             ecmp_hasher;   /**< ecmp_hash compiled */
+    struct oes_l3_checker              l3_checker;    /**< attr TTL actions compiled */
+    pthread_rwlock_t                   lock;      /**< writers: configuration, readers: lookups */
+    struct oes_lpm4                  * fib4;      /**< allocated on the first IPv4 route */
+    struct oes_lpm6                  * fib6;      /**< allocated on the first IPv6 route */
+    struct oes_nhg_table               nhgs;
+    struct oes_neigh_table             neighs;
+    struct oes_mc_table                mcs;
+    struct oes_router_route_page    ** route_pages;
+    unsigned int                       routes_size;     /**< multiple of OES_ROUTER_ROUTE_PAGE_SIZE */
+    unsigned int                       routes_free;
+    unsigned int                       route_cnt;
+    unsigned int                       rif_cnt;   /**< guarded by oes_router_db_lock */
+    unsigned long long               * route_activity;  /**< bit per route record */
+    unsigned long long                 cntr_enabled[OES_BITMAP_WORDS(OES_CNTR_MAX_RIFS)]; /**< read unlocked */
+    struct oes_cntr_block            * cntr_bases[OES_CNTR_MAX_RIFS / OES_CNTR_CHUNK];  /**< guarded by oes_router_cntr_lock */
+};
+
+static pthread_mutex_t      oes_router_db_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct oes_router_vr oes_router_vrs[OES_ROUTER_MAX_VRID];
+
+/* router interfaces of all vrs; taken after oes_router_db_lock, never with a vr lock */
+static pthread_rwlock_t     oes_router_rif_lock = PTHREAD_RWLOCK_INITIALIZER;
+static struct oes_rif_table oes_router_rifs;
+
+/* rif counter bases of all vrs; taken after oes_router_db_lock and a vr lock.
+ * Counter reads take it without the vr lock, never holding up lookups and updates */
+static pthread_rwlock_t     oes_router_cntr_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+/* Returns the virtual router, or NULL if vrid was not added. */
+static struct oes_router_vr *
+oes_router_vr_get(const unsigned int vrid)
+{
+    if ((vrid >= OES_ROUTER_MAX_VRID) || !oes_router_vrs[vrid].in_use) {
+        return NULL;
+    }
+    return &oes_router_vrs[vrid];
+}
+
+/* Returns a route record for reading. */
+static inline struct oes_router_route *
+oes_router_route(const struct oes_router_vr *vr_p, unsigned int idx)
+{
+    return &vr_p->route_pages[idx >> OES_ROUTER_ROUTE_PAGE_BITS]->
+           routes[idx & (OES_ROUTER_ROUTE_PAGE_SIZE - 1)];
+}
+
+static void
+oes_router_route_page_put(struct oes_router_route_page *page_p)
+{
+    if (__atomic_sub_fetch(&page_p->refcnt, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(page_p);
+    }
+}
+
+/*
+ * Returns a route record for writing, copying its page first if
+ * another vr shares it. NULL if out of memory.
+ */
+static struct oes_router_route *
+oes_router_route_own(struct oes_router_vr *vr_p, unsigned int idx)
+{
+    struct oes_router_route_page **page_pp = &vr_p->route_pages[idx >> OES_ROUTER_ROUTE_PAGE_BITS];
+    struct oes_router_route_page  *copy_p;
+
+    if (__atomic_load_n(&(*page_pp)->refcnt, __ATOMIC_ACQUIRE) != 1) {
+        copy_p = malloc(sizeof(*copy_p));
+        if (copy_p == NULL) {
+            return NULL;
+        }
+        memcpy(copy_p->routes, (*page_pp)->routes, sizeof(copy_p->routes));
+        copy_p->refcnt = 1;
+        oes_router_route_page_put(*page_pp);
+        *page_pp = copy_p;
+    }
+    return &(*page_pp)->routes[idx & (OES_ROUTER_ROUTE_PAGE_SIZE - 1)];
+}
+
+/* Allocates a route record, returns OES_ROUTER_ROUTE_NONE if out of memory. */
+static unsigned int
+oes_router_route_alloc(struct oes_router_vr *vr_p)
+{
+    struct oes_router_route_page **pages_p;
+    struct oes_router_route_page  *page_p;
+    struct oes_router_route       *route_p;
+    unsigned int                   size, idx;
+
+    if (vr_p->routes_free == OES_ROUTER_ROUTE_NONE) {
+        /* a page at a time, so growing never copies the records */
+        size = vr_p->routes_size + OES_ROUTER_ROUTE_PAGE_SIZE;
+        if (size > OES_LPM4_MAX_NEXT_HOP + 1) {
+            return OES_ROUTER_ROUTE_NONE;
+        }
+        if (oes_activity_resize(&vr_p->route_activity, vr_p->routes_size, size) != OES_STATUS_SUCCESS) {
+            return OES_ROUTER_ROUTE_NONE;
+        }
+        pages_p = realloc(vr_p->route_pages, (size >> OES_ROUTER_ROUTE_PAGE_BITS) * sizeof(*pages_p));
+        if (pages_p == NULL) {
+            return OES_ROUTER_ROUTE_NONE;
+        }
+        vr_p->route_pages = pages_p;
+        page_p = malloc(sizeof(*page_p));
+        if (page_p == NULL) {
+            return OES_ROUTER_ROUTE_NONE;
+        }
+        page_p->refcnt = 1;
+        vr_p->route_pages[vr_p->routes_size >> OES_ROUTER_ROUTE_PAGE_BITS] = page_p;
+        for (idx = OES_ROUTER_ROUTE_PAGE_SIZE; idx-- > 0;) {
+            page_p->routes[idx].next_free = vr_p->routes_free;
+            vr_p->routes_free = vr_p->routes_size + idx;
+        }
+        vr_p->routes_size = size;
+    }
+    idx = vr_p->routes_free;
+    route_p = oes_router_route_own(vr_p, idx);
+    if (route_p == NULL) {
+        return OES_ROUTER_ROUTE_NONE;
+    }
+    vr_p->routes_free = route_p->next_free;
+    route_p->nhg_id = OES_NHG_NONE;
+    route_p->delete_pending = 0;
+    vr_p->route_cnt++;
+    return idx;
+}
+
+/* The page of the record is already owned (oes_router_route_own). */
+static void
+oes_router_route_free(struct oes_router_vr *vr_p, unsigned int idx)
+{
+    struct oes_router_route *route_p = oes_router_route(vr_p, idx);
+
+    oes_nhg_put(&vr_p->nhgs, route_p->nhg_id);
+    oes_activity_get(vr_p->route_activity, idx, 1);
+    route_p->delete_pending = 0;
+    route_p->next_free = vr_p->routes_free;
+    vr_p->routes_free = idx;
+    vr_p->route_cnt--;
+}
+
+/*
+ * Next hop group resolve callback: a next hop is resolved while a
+ * neighbour forwards to it. Runs under the vr write lock.
+ */
+static int
+oes_router_neigh_resolved(void *ctx_p, const struct oes_ip_addr *next_hop_p)
+{
+    const struct oes_router_vr *vr_p = ctx_p;
+    unsigned int                idx = oes_neigh_find(&vr_p->neighs, next_hop_p);
+
+    return (idx != OES_NEIGH_NONE) &&
+           (vr_p->neighs.entries[idx].action == OES_ROUTER_ACTION_FORWARD);
+}
+
+/*
+ * Copies the route data into a route record, moving it to the group of
+ * its next hops. A resilient group inherits the bucket owners of the
+ * group the route had.
+ */
+static oes_status_e
+oes_router_route_fill(struct oes_router_vr *vr_p,
+                      unsigned int idx,
+                      const struct oes_uc_route_data *data_p,
+                      const struct oes_uc_route_ecmp_params *ecmp_p)
+{
+    struct oes_router_route *route_p = oes_router_route_own(vr_p, idx);
+    unsigned int             nhg_id;
+    oes_status_e             status;
+
+    if (route_p == NULL) {
+        return OES_STATUS_NO_MEMORY;
+    }
+    if ((ecmp_p != NULL) && ecmp_p->resilient_bucket_cnt) {
+        status = oes_nhg_res_get(&vr_p->nhgs, data_p->next_hop_list, data_p->next_hop_cnt,
+                                 ecmp_p->resilient_bucket_cnt, route_p->nhg_id, &nhg_id);
+    } else {
+        status = oes_nhg_get(&vr_p->nhgs, data_p->next_hop_list, data_p->next_hop_cnt, &nhg_id);
+    }
+    if (status != OES_STATUS_SUCCESS) {
+        return status;
+    }
+    oes_nhg_put(&vr_p->nhgs, route_p->nhg_id);
+    route_p->nhg_id = nhg_id;
+    route_p->action = data_p->action;
+    oes_activity_get(vr_p->route_activity, idx, 1);
+    return OES_STATUS_SUCCESS;
+}
+
+/*
+ * Returns the action a route takes on traffic: FORWARD to a next hop
+ * group with no resolved member acts as TRAP, so the CPU sees the
+ * packets that will trigger neighbour resolution.
+ */
+static enum oes_router_action
+oes_router_route_action(const struct oes_router_vr *vr_p,
+                        const struct oes_router_route *route_p)
+{
+    const struct oes_nhg *nhg_p;
+
+    if (route_p->action != OES_ROUTER_ACTION_FORWARD) {
+        return route_p->action;
+    }
+    nhg_p = oes_nhg_entry(&vr_p->nhgs, route_p->nhg_id);
+    if ((nhg_p != NULL) && (nhg_p->resolved_cnt == 0)) {
+        return OES_ROUTER_ACTION_TRAP;
+    }
+    return OES_ROUTER_ACTION_FORWARD;
+}
+
+/*
+ * Copies a route record out. The caller provides next_hop_list with
+ * room for next_hop_cnt entries (or NULL), next_hop_cnt is set to the
+ * number of next hops of the route. Next hops come back sorted and
+ * the action is the effective one (oes_router_route_action).
+ * GET_ACTIVITY clears the activity it reports.
+ */
+static void
+oes_router_route_read(const struct oes_router_vr *vr_p,
+                      unsigned int idx,
+                      struct oes_uc_route_data *data_p,
+                      int clear_activity)
+{
+    const struct oes_router_route *route_p = oes_router_route(vr_p, idx);
+    const struct oes_nhg          *nhg_p = oes_nhg_entry(&vr_p->nhgs, route_p->nhg_id);
+    unsigned short                 cnt = data_p->next_hop_cnt;
+
+    if (nhg_p == NULL) {
+        cnt = 0;
+    } else if (cnt > nhg_p->cnt) {
+        cnt = nhg_p->cnt;
+    }
+    if ((data_p->next_hop_list != NULL) && cnt) {
+        memcpy(data_p->next_hop_list, nhg_p->members, cnt * sizeof(*nhg_p->members));
+    }
+    data_p->next_hop_cnt = nhg_p ? nhg_p->cnt : 0;
+    data_p->action = oes_router_route_action(vr_p, route_p);
+    data_p->activity = oes_activity_get(vr_p->route_activity, idx, clear_activity);
+}
+
+static void
+oes_router_route_flush(struct oes_router_vr *vr_p)
+{
+    unsigned int page;
+
+    if (vr_p->fib4 != NULL) {
+        oes_lpm4_flush(vr_p->fib4);
+    }
+    if (vr_p->fib6 != NULL) {
+        oes_lpm6_flush(vr_p->fib6);
+    }
+    oes_nhg_table_flush(&vr_p->nhgs);
+    for (page = 0; page < vr_p->routes_size >> OES_ROUTER_ROUTE_PAGE_BITS; page++) {
+        oes_router_route_page_put(vr_p->route_pages[page]);
+    }
+    free(vr_p->route_pages);
+    vr_p->route_pages = NULL;
+    free(vr_p->route_activity);
+    vr_p->route_activity = NULL;
+    vr_p->routes_size = 0;
+    vr_p->routes_free = OES_ROUTER_ROUTE_NONE;
+    vr_p->route_cnt = 0;
+}
+
+static int
+oes_router_prefix_valid(const struct oes_ip_prefix *key_p)
+{
+    switch (key_p->prefix.version) {
+    case OES_IPV4:
+        return key_p->prefix_len <= 32;
+    case OES_IPV6:
+        return key_p->prefix_len <= 128;
+    default:
+        return 0;
+    }
+}
+
+/*
+ * Finds the route record of an exact prefix in the FIB of its family.
+ * With probe_p, an IPv4 prefix is probed (oes_lpm4_rule_probe) so that
+ * oes_router_fib_add does not search for it again.
+ */
+static oes_status_e
+oes_router_fib_rule_get(const struct oes_router_vr *vr_p,
+                        const struct oes_ip_prefix *key_p,
+                        struct oes_lpm4_probe *probe_p,
+                        unsigned int *idx_p)
+{
+    if (key_p->prefix.version == OES_IPV4) {
+        if (vr_p->fib4 == NULL) {
+            return OES_STATUS_ENTRY_NOT_FOUND;
+        }
+        if (probe_p != NULL) {
+            return oes_lpm4_rule_probe(vr_p->fib4, ntohl(key_p->prefix.addr.ipv4.s_addr),
+                                       key_p->prefix_len, probe_p, idx_p);
+        }
+        return oes_lpm4_rule_get(vr_p->fib4, ntohl(key_p->prefix.addr.ipv4.s_addr),
+                                 key_p->prefix_len, idx_p);
+    }
+    if (vr_p->fib6 == NULL) {
+        return OES_STATUS_ENTRY_NOT_FOUND;
+    }
+    return oes_lpm6_rule_get(vr_p->fib6, key_p->prefix.addr.ipv6.s6_addr,
+                             key_p->prefix_len, idx_p);
+}
+
+/* probe_p is from oes_router_fib_rule_get with no FIB change since, or NULL */
+static oes_status_e
+oes_router_fib_add(struct oes_router_vr *vr_p,
+                   const struct oes_ip_prefix *key_p,
+                   const struct oes_lpm4_probe *probe_p,
+                   unsigned int idx)
+{
+    if (key_p->prefix.version == OES_IPV4) {
+        if (vr_p->fib4 == NULL) {
+            if ((vr_p->fib4 = oes_lpm4_create()) == NULL) {
+                return OES_STATUS_NO_MEMORY;
+            }
+            /* there was no FIB to probe */
+            probe_p = NULL;
+        }
+        if (probe_p != NULL) {
+            return oes_lpm4_add_probed(vr_p->fib4, probe_p, idx);
+        }
+        return oes_lpm4_add(vr_p->fib4, ntohl(key_p->prefix.addr.ipv4.s_addr),
+                            key_p->prefix_len, idx);
+    }
+    if ((vr_p->fib6 == NULL) && ((vr_p->fib6 = oes_lpm6_create()) == NULL)) {
+        return OES_STATUS_NO_MEMORY;
+    }
+    return oes_lpm6_add(vr_p->fib6, key_p->prefix.addr.ipv6.s6_addr, key_p->prefix_len, idx);
+}
+
+/* Fails only with NO_MEMORY, on a FIB shared with a clone not yet unshared. */
+static oes_status_e
+oes_router_fib_delete(struct oes_router_vr *vr_p,
+                      const struct oes_ip_prefix *key_p)
+{
+    if (key_p->prefix.version == OES_IPV4) {
+        return oes_lpm4_delete(vr_p->fib4, ntohl(key_p->prefix.addr.ipv4.s_addr), key_p->prefix_len);
+    }
+    return oes_lpm6_delete(vr_p->fib6, key_p->prefix.addr.ipv6.s6_addr, key_p->prefix_len);
+}
+
+/* Copies the FIB memory an existing prefix uses if shared, so deleting it cannot fail. */
+static oes_status_e
+oes_router_fib_unshare(struct oes_router_vr *vr_p,
+                       const struct oes_ip_prefix *key_p)
+{
+    if (key_p->prefix.version == OES_IPV4) {
+        return oes_lpm4_unshare(vr_p->fib4, ntohl(key_p->prefix.addr.ipv4.s_addr), key_p->prefix_len);
+    }
+    return oes_lpm6_unshare(vr_p->fib6, key_p->prefix.addr.ipv6.s6_addr, key_p->prefix_len);
+}
+
+/* caller holds the vr write lock */
+static oes_status_e
+oes_router_uc_route_do(struct oes_router_vr *vr_p,
+                       const enum oes_access_cmd access_cmd,
+                       const struct oes_ip_prefix *key_p,
+                       const struct oes_uc_route_data *data_p,
+                       const struct oes_uc_route_ecmp_params *ecmp_p)
+{
+    struct oes_lpm4_probe probe;
+    unsigned int          idx;
+    int                   exists;
+    oes_status_e          status;
+
+    if (!oes_router_prefix_valid(key_p)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    exists = (oes_router_fib_rule_get(vr_p, key_p, &probe, &idx) == OES_STATUS_SUCCESS);
+
+    switch (access_cmd) {
+    case OES_ACCESS_CMD_ADD:
+    case OES_ACCESS_CMD_EDIT:
+        if (exists) {
+            return oes_router_route_fill(vr_p, idx, data_p, ecmp_p);
+        }
+        if (access_cmd == OES_ACCESS_CMD_EDIT) {
+            return OES_STATUS_ENTRY_NOT_FOUND;
+        }
+        idx = oes_router_route_alloc(vr_p);
+        if (idx == OES_ROUTER_ROUTE_NONE) {
+            return OES_STATUS_NO_RESOURCES;
+        }
+        status = oes_router_route_fill(vr_p, idx, data_p, ecmp_p);
+        if (status == OES_STATUS_SUCCESS) {
+            status = oes_router_fib_add(vr_p, key_p, &probe, idx);
+        }
+        if (status != OES_STATUS_SUCCESS) {
+            oes_router_route_free(vr_p, idx);
+        }
+        return status;
+
+    case OES_ACCESS_CMD_DELETE:
+        if (!exists) {
+            return OES_STATUS_ENTRY_NOT_FOUND;
+        }
+        if (oes_router_route_own(vr_p, idx) == NULL) {
+            return OES_STATUS_NO_MEMORY;
+        }
+        status = oes_router_fib_delete(vr_p, key_p);
+        if (status != OES_STATUS_SUCCESS) {
+            return status;
+        }
+        oes_router_route_free(vr_p, idx);
+        return OES_STATUS_SUCCESS;
+
+    default:
+        return OES_STATUS_CMD_UNSUPPORTED;
+    }
+}
+
+/*
+ * Prefetches the FIB memory of the IPv4 ops ahead of op i, so that
+ * their misses overlap the work on the ops before them
+ * (oes_lpm4_prefetch_page).
+ */
+static inline void
+oes_router_fib_prefetch(const struct oes_router_vr *vr_p,
+                        const struct oes_uc_route_op *op_list_p,
+                        unsigned int i,
+                        unsigned int op_cnt)
+{
+    const struct oes_ip_prefix *key_p;
+
+    if (vr_p->fib4 == NULL) {
+        return;
+    }
+    if (i + 2 * OES_LPM4_BULK_PREFETCH < op_cnt) {
+        key_p = &op_list_p[i + 2 * OES_LPM4_BULK_PREFETCH].key;
+        if (key_p->prefix.version == OES_IPV4) {
+            oes_lpm4_prefetch_page(vr_p->fib4, ntohl(key_p->prefix.addr.ipv4.s_addr));
+        }
+    }
+    if (i + OES_LPM4_BULK_PREFETCH < op_cnt) {
+        key_p = &op_list_p[i + OES_LPM4_BULK_PREFETCH].key;
+        if (key_p->prefix.version == OES_IPV4) {
+            oes_lpm4_prefetch_rule(vr_p->fib4, ntohl(key_p->prefix.addr.ipv4.s_addr),
+                                   key_p->prefix_len);
+        }
+    }
+}
+
+/*
+ * Applies the operations of a batch in order, logging how to undo each
+ * one. Deletions only mark their route, so undoing them never needs
+ * memory. Caller holds the vr write lock.
+ */
+static oes_status_e
+oes_router_uc_route_batch_do(struct oes_router_vr *vr_p,
+                             const struct oes_uc_route_op *op_list_p,
+                             unsigned int op_cnt,
+                             struct oes_router_undo *undo_p,
+                             unsigned int *undo_cnt_p,
+                             unsigned int *failed_op_p)
+{
+    const struct oes_uc_route_op *op_p;
+    struct oes_router_undo       *log_p;
+    struct oes_router_route      *route_p;
+    struct oes_lpm4_probe         probe;
+    unsigned int                  i, idx, undo_cnt = 0;
+    int                           found;
+    oes_status_e                  status = OES_STATUS_SUCCESS;
+
+    for (i = 0; i < op_cnt; i++) {
+        op_p = &op_list_p[i];
+        if (!oes_router_prefix_valid(&op_p->key) ||
+            ((op_p->access_cmd != OES_ACCESS_CMD_DELETE) &&
+             (op_p->data.next_hop_cnt && (op_p->data.next_hop_list == NULL)))) {
+            status = OES_STATUS_PARAM_ERROR;
+            break;
+        }
+        oes_router_fib_prefetch(vr_p, op_list_p, i, op_cnt);
+        found = (oes_router_fib_rule_get(vr_p, &op_p->key, &probe, &idx) == OES_STATUS_SUCCESS);
+        log_p = &undo_p[undo_cnt];
+        log_p->op_idx = i;
+        log_p->idx = idx;
+
+        switch (op_p->access_cmd) {
+        case OES_ACCESS_CMD_DELETE:
+            if (!found || oes_router_route(vr_p, idx)->delete_pending) {
+                status = OES_STATUS_ENTRY_NOT_FOUND;
+                break;
+            }
+            /* whatever a clone shares is copied now, commit must not fail */
+            route_p = oes_router_route_own(vr_p, idx);
+            if (route_p == NULL) {
+                status = OES_STATUS_NO_MEMORY;
+                break;
+            }
+            status = oes_router_fib_unshare(vr_p, &op_p->key);
+            if (status != OES_STATUS_SUCCESS) {
+                break;
+            }
+            route_p->delete_pending = 1;
+            log_p->kind = OES_ROUTER_UNDO_DELETE;
+            undo_cnt++;
+            break;
+
+        case OES_ACCESS_CMD_ADD:
+        case OES_ACCESS_CMD_EDIT:
+            if (found && oes_router_route(vr_p, idx)->delete_pending) {
+                if (op_p->access_cmd == OES_ACCESS_CMD_EDIT) {
+                    status = OES_STATUS_ENTRY_NOT_FOUND;
+                    break;
+                }
+                oes_router_route(vr_p, idx)->delete_pending = 0;
+                log_p->kind = OES_ROUTER_UNDO_UNDELETE;
+                log_p = &undo_p[++undo_cnt];
+                log_p->op_idx = i;
+                log_p->idx = idx;
+            }
+            if (found) {
+                log_p->kind = OES_ROUTER_UNDO_FILL;
+                log_p->old_nhg_id = oes_router_route(vr_p, idx)->nhg_id;
+                log_p->old_action = oes_router_route(vr_p, idx)->action;
+                log_p->old_active = oes_activity_get(vr_p->route_activity, idx, 0);
+                oes_nhg_hold(&vr_p->nhgs, log_p->old_nhg_id);
+                status = oes_router_route_fill(vr_p, idx, &op_p->data, op_p->ecmp_params_p);
+                if (status != OES_STATUS_SUCCESS) {
+                    oes_nhg_put(&vr_p->nhgs, log_p->old_nhg_id);
+                    break;
+                }
+                undo_cnt++;
+                break;
+            }
+            if (op_p->access_cmd == OES_ACCESS_CMD_EDIT) {
+                status = OES_STATUS_ENTRY_NOT_FOUND;
+                break;
+            }
+            idx = oes_router_route_alloc(vr_p);
+            if (idx == OES_ROUTER_ROUTE_NONE) {
+                status = OES_STATUS_NO_RESOURCES;
+                break;
+            }
+            status = oes_router_route_fill(vr_p, idx, &op_p->data, op_p->ecmp_params_p);
+            if (status == OES_STATUS_SUCCESS) {
+                status = oes_router_fib_add(vr_p, &op_p->key, &probe, idx);
+            }
+            if (status != OES_STATUS_SUCCESS) {
+                oes_router_route_free(vr_p, idx);
+                break;
+            }
+            log_p->idx = idx;
+            log_p->kind = OES_ROUTER_UNDO_NEW;
+            undo_cnt++;
+            break;
+
+        default:
+            status = OES_STATUS_CMD_UNSUPPORTED;
+            break;
+        }
+        if (status != OES_STATUS_SUCCESS) {
+            break;
+        }
+    }
+    if ((status != OES_STATUS_SUCCESS) && (failed_op_p != NULL)) {
+        *failed_op_p = i;
+    }
+    *undo_cnt_p = undo_cnt;
+    return status;
+}
+
+/* Makes a batch final: frees the deleted routes and the groups the routes left. */
+static void
+oes_router_uc_route_batch_commit(struct oes_router_vr *vr_p,
+                                 const struct oes_uc_route_op *op_list_p,
+                                 const struct oes_router_undo *undo_p,
+                                 unsigned int undo_cnt)
+{
+    unsigned int i;
+
+    for (i = 0; i < undo_cnt; i++) {
+        switch (undo_p[i].kind) {
+        case OES_ROUTER_UNDO_FILL:
+            oes_nhg_put(&vr_p->nhgs, undo_p[i].old_nhg_id);
+            break;
+
+        case OES_ROUTER_UNDO_DELETE:
+            /* a later ADD may have taken the route back */
+            if (oes_router_route(vr_p, undo_p[i].idx)->delete_pending) {
+                oes_router_fib_delete(vr_p, &op_list_p[undo_p[i].op_idx].key);
+                oes_router_route_free(vr_p, undo_p[i].idx);
+            }
+            break;
+        }
+    }
+}
+
+/* Undoes a partly applied batch, newest operation first. */
+static void
+oes_router_uc_route_batch_rollback(struct oes_router_vr *vr_p,
+                                   const struct oes_uc_route_op *op_list_p,
+                                   const struct oes_router_undo *undo_p,
+                                   unsigned int undo_cnt)
+{
+    struct oes_router_route *route_p;
+    unsigned int             i;
+
+    for (i = undo_cnt; i-- > 0;) {
+        route_p = oes_router_route(vr_p, undo_p[i].idx);
+        switch (undo_p[i].kind) {
+        case OES_ROUTER_UNDO_NEW:
+            oes_router_fib_delete(vr_p, &op_list_p[undo_p[i].op_idx].key);
+            oes_router_route_free(vr_p, undo_p[i].idx);
+            break;
+
+        case OES_ROUTER_UNDO_FILL:
+            oes_nhg_put(&vr_p->nhgs, route_p->nhg_id);
+            route_p->nhg_id = undo_p[i].old_nhg_id;
+            route_p->action = undo_p[i].old_action;
+            if (undo_p[i].old_active) {
+                oes_activity_mark(vr_p->route_activity, undo_p[i].idx);
+            }
+            break;
+
+        case OES_ROUTER_UNDO_DELETE:
+            route_p->delete_pending = 0;
+            break;
+
+        case OES_ROUTER_UNDO_UNDELETE:
+            route_p->delete_pending = 1;
+            break;
+        }
+    }
+}
+
+/* Frees everything a vr holds and marks it unused, caller holds oes_router_db_lock. */
+static void
+oes_router_vr_release(struct oes_router_vr *vr_p)
+{
+    unsigned int idx;
+
+    oes_router_route_flush(vr_p);
+    oes_lpm4_destroy(vr_p->fib4);
+    oes_lpm6_destroy(vr_p->fib6);
+    oes_nhg_table_deinit(&vr_p->nhgs);
+    oes_neigh_table_deinit(&vr_p->neighs);
+    oes_mc_table_deinit(&vr_p->mcs);
+    /* counter reads hold no vr lock, wait for those in flight */
+    pthread_rwlock_wrlock(&oes_router_cntr_lock);
+    for (idx = 0; idx < OES_CNTR_MAX_RIFS / OES_CNTR_CHUNK; idx++) {
+        free(vr_p->cntr_bases[idx]);
+    }
+    pthread_rwlock_unlock(&oes_router_cntr_lock);
+    pthread_rwlock_destroy(&vr_p->lock);
+    memset(vr_p, 0, sizeof(*vr_p));
+}
+
+/**
+ * This function sets the log verbosity level of router MODULE
+ * @param[in]  verbosity_level  - router  module verbosity level
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR - Unsupported verbosity_level
+ * @return OES_STATUS_ERROR general error.
+ */
+oes_status_e
+oes_api_router_log_verbosity_level_set(const int verbosity_level)
+{
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * This function gets the log verbosity level of the router
+ * MODULE
+ * @param[out]  verbosity_level_p router  module verbosity level
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR - Unsupported verbosity_level
+ * @return OES_STATUS_ERROR general error.
+ */
+oes_status_e
+oes_api_router_log_verbosity_level_get(int *verbosity_level_p)
+{
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * This function sets the ECMP hash function configuration
+ * parameters.
+ *
+ * @param[in,out] vrid - Virtual router ID
+ * @param[in] ecmp_hash_params_p - ECMP hash configuration.
+ * @param[in,out] router_ecmp_hash_vs_ext- vendor specific
+ *       extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_NULL if parameter is NULL.
+ * @return OES_STATUS_ERROR general error.
+ */
+oes_status_e
+oes_api_router_ecmp_hash_params_set(const unsigned int vrid,
+                                    const struct oes_router_ecmp_hash_fields *ecmp_hash_params_p,
+                                    void *router_ecmp_hash_vs_ext)
+{
+    struct oes_router_vr *vr_p;
+    oes_status_e          status = OES_STATUS_SUCCESS;
+
+    if (ecmp_hash_params_p == NULL) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_mutex_lock(&oes_router_db_lock);
+    vr_p = oes_router_vr_get(vrid);
+    if (vr_p == NULL) {
+        status = OES_STATUS_PARAM_ERROR;
+    } else {
+        pthread_rwlock_wrlock(&vr_p->lock);
+        vr_p->ecmp_hash = *ecmp_hash_params_p;
+        oes_ecmp_hasher_init(&vr_p->ecmp_hasher, &vr_p->ecmp_hash, OES_ROUTER_ECMP_SEED);
+        pthread_rwlock_unlock(&vr_p->lock);
+    }
+    pthread_mutex_unlock(&oes_router_db_lock);
+    return status;
+}
+
+/**
+ * This function gets the ECMP hash function configuration
+ * parameters.
+ *
+ * @param[in,out] vrid - Virtual router ID
+ * @param[out] ecmp_hash_params_p - ECMP hash configuration.
+ * @param[in,out] router_ecmp_hash_vs_ext- vendor specific
+ *       extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_NULL if parameter is NULL.
+ * @return OES_STATUS_ERROR general error.
+ */
+oes_status_e
+oes_api_router_ecmp_hash_params_get(const unsigned int vrid,
+                                    struct oes_router_ecmp_hash_fields *ecmp_hash_params_p,
+                                    void *router_ecmp_hash_vs_ext)
+{
+    struct oes_router_vr *vr_p;
+    oes_status_e          status = OES_STATUS_SUCCESS;
+
+    if (ecmp_hash_params_p == NULL) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_mutex_lock(&oes_router_db_lock);
+    vr_p = oes_router_vr_get(vrid);
+    if (vr_p == NULL) {
+        status = OES_STATUS_PARAM_ERROR;
+    } else {
+        pthread_rwlock_rdlock(&vr_p->lock);
+        *ecmp_hash_params_p = vr_p->ecmp_hash;
+        pthread_rwlock_unlock(&vr_p->lock);
+    }
+    pthread_mutex_unlock(&oes_router_db_lock);
+    return status;
+}
+
+/**
+ *  This function adds/modifies/deletes a virtual router.
+ *  The router ID is allocated and returned to the caller when
+ *  cmd is ADD, otherwise it is given by the caller. All
+ *  interfaces and routes associated with a router must be
+ *  deleted before the router can be deleted as well.
+ *
+ * @param[in] access_cmd - ADD/EDIT/DELETE.
+ * @param[in,out] vrid_p - Virtual router ID
+ * @param[in] router_attr_p - Router attributes.
+ * @param[in,out] router_vs_ext- vendor specific extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_NO_RESOURCES if there are no resources to
+ *         create another router
+ * @return OES_STATUS_ERROR general error.
+ */
+oes_status_e
+oes_api_router_set(const enum oes_access_cmd access_cmd,
+                   unsigned int *vrid_p,
+                   const struct oes_router_attributes *router_attr_p,
+                   void *router_vs_ext)
+{
+    struct oes_router_vr *vr_p = NULL;
+    oes_status_e          status = OES_STATUS_SUCCESS;
+    unsigned int          vrid;
+
+    if ((vrid_p == NULL) ||
+        ((router_attr_p == NULL) && (access_cmd != OES_ACCESS_CMD_DELETE))) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_mutex_lock(&oes_router_db_lock);
+    switch (access_cmd) {
+    case OES_ACCESS_CMD_ADD:
+        for (vrid = 0; vrid < OES_ROUTER_MAX_VRID; vrid++) {
+            if (!oes_router_vrs[vrid].in_use) {
+                vr_p = &oes_router_vrs[vrid];
+                break;
+            }
+        }
+        if (vr_p == NULL) {
+            status = OES_STATUS_NO_RESOURCES;
+            break;
+        }
+        memset(vr_p, 0, sizeof(*vr_p));
+        if (oes_nhg_table_init(&vr_p->nhgs, oes_router_neigh_resolved, vr_p) != OES_STATUS_SUCCESS) {
+            status = OES_STATUS_NO_MEMORY;
+            break;
+        }
+        oes_neigh_table_init(&vr_p->neighs);
+        oes_mc_table_init(&vr_p->mcs);
+        pthread_rwlock_init(&vr_p->lock, NULL);
+        vr_p->attr = *router_attr_p;
+        oes_l3_checker_init(&vr_p->l3_checker, &vr_p->attr);
+        oes_ecmp_hasher_init(&vr_p->ecmp_hasher, &vr_p->ecmp_hash, OES_ROUTER_ECMP_SEED);
+        vr_p->routes_free = OES_ROUTER_ROUTE_NONE;
+        vr_p->in_use = 1;
+        *vrid_p = vrid;
+        break;
+
+    case OES_ACCESS_CMD_EDIT:
+        vr_p = oes_router_vr_get(*vrid_p);
+        if (vr_p == NULL) {
+            status = OES_STATUS_PARAM_ERROR;
+            break;
+        }
+        pthread_rwlock_wrlock(&vr_p->lock);
+        vr_p->attr = *router_attr_p;
+        oes_l3_checker_init(&vr_p->l3_checker, &vr_p->attr);
+        pthread_rwlock_unlock(&vr_p->lock);
+        break;
+
+    case OES_ACCESS_CMD_DELETE:
+        vr_p = oes_router_vr_get(*vrid_p);
+        if (vr_p == NULL) {
+            status = OES_STATUS_PARAM_ERROR;
+            break;
+        }
+        /* wait for in flight readers, none can start without oes_router_db_lock */
+        pthread_rwlock_wrlock(&vr_p->lock);
+        if (vr_p->route_cnt || vr_p->mcs.cnt || vr_p->rif_cnt) {
+            /* routes and interfaces must be deleted first */
+            pthread_rwlock_unlock(&vr_p->lock);
+            status = OES_STATUS_ERROR;
+            break;
+        }
+        pthread_rwlock_unlock(&vr_p->lock);
+        oes_router_vr_release(vr_p);
+        break;
+
+    default:
+        status = OES_STATUS_CMD_UNSUPPORTED;
+        break;
+    }
+    pthread_mutex_unlock(&oes_router_db_lock);
+
+    return status;
+}
+
+/**
+ *  This function gets a virtual router information.
+ *
+ * @param[in] vrid - Virtual router ID
+ * @param[out] router_attr_p - Router attributes.
+ * @param[in,out] router_vs_ext- vendor specific extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_NO_RESOURCES if there are no resources to
+ *         create another router
+ * @return OES_STATUS_ERROR general error.
+ */
+oes_status_e
+oes_api_router_get(const unsigned int vrid,
+                   struct oes_router_attributes *router_attr_p,
+                   void *router_vs_ext)
+{
+    struct oes_router_vr *vr_p;
+    oes_status_e          status = OES_STATUS_SUCCESS;
+
+    if (router_attr_p == NULL) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_mutex_lock(&oes_router_db_lock);
+    vr_p = oes_router_vr_get(vrid);
+    if (vr_p == NULL) {
+        status = OES_STATUS_PARAM_ERROR;
+    } else {
+        *router_attr_p = vr_p->attr;
+    }
+    pthread_mutex_unlock(&oes_router_db_lock);
+    return status;
+}
+
+/**
+ *  This function adds a virtual router whose unicast routes start
+ *  as a copy of those of a template router. The copy shares the
+ *  FIB and route memory of the template until either router
+ *  changes it, so a clone costs memory in proportion to the
+ *  routes it adds, changes or deletes. Neighbours, multicast
+ *  routes and counters are not copied: next hops of the clone
+ *  resolve against its own neighbours.
+ *
+ * @param[in] template_vrid - Virtual router ID to copy
+ * @param[out] vrid_p - Virtual router ID of the clone
+ * @param[in] router_attr_p - Router attributes of the clone.
+ * @param[in,out] router_vs_ext- vendor specific extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_NO_RESOURCES if there are no resources to
+ *         create another router
+ * @return OES_STATUS_NO_MEMORY if out of memory.
+ */
+oes_status_e
+oes_api_router_clone(const unsigned int template_vrid,
+                     unsigned int *vrid_p,
+                     const struct oes_router_attributes *router_attr_p,
+                     void *router_vs_ext)
+{
+    struct oes_router_vr *template_p;
+    struct oes_router_vr *vr_p = NULL;
+    oes_status_e          status = OES_STATUS_SUCCESS;
+    unsigned int          vrid, page, pages;
+
+    if ((vrid_p == NULL) || (router_attr_p == NULL)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_mutex_lock(&oes_router_db_lock);
+    template_p = oes_router_vr_get(template_vrid);
+    if (template_p == NULL) {
+        pthread_mutex_unlock(&oes_router_db_lock);
+        return OES_STATUS_PARAM_ERROR;
+    }
+    for (vrid = 0; vrid < OES_ROUTER_MAX_VRID; vrid++) {
+        if (!oes_router_vrs[vrid].in_use) {
+            vr_p = &oes_router_vrs[vrid];
+            break;
+        }
+    }
+    if (vr_p == NULL) {
+        pthread_mutex_unlock(&oes_router_db_lock);
+        return OES_STATUS_NO_RESOURCES;
+    }
+    pthread_rwlock_rdlock(&template_p->lock);
+
+    memset(vr_p, 0, sizeof(*vr_p));
+    if (oes_nhg_table_clone(&vr_p->nhgs, &template_p->nhgs, oes_router_neigh_resolved,
+                            vr_p) != OES_STATUS_SUCCESS) {
+        pthread_rwlock_unlock(&template_p->lock);
+        pthread_mutex_unlock(&oes_router_db_lock);
+        return OES_STATUS_NO_MEMORY;
+    }
+    oes_neigh_table_init(&vr_p->neighs);
+    oes_mc_table_init(&vr_p->mcs);
+    pthread_rwlock_init(&vr_p->lock, NULL);
+    vr_p->attr = *router_attr_p;
+    oes_l3_checker_init(&vr_p->l3_checker, &vr_p->attr);
+    vr_p->ecmp_hash = template_p->ecmp_hash;
+    oes_ecmp_hasher_init(&vr_p->ecmp_hasher, &vr_p->ecmp_hash, OES_ROUTER_ECMP_SEED);
+    vr_p->routes_free = OES_ROUTER_ROUTE_NONE;
+
+    if (((template_p->fib4 != NULL) && ((vr_p->fib4 = oes_lpm4_clone(template_p->fib4)) == NULL)) ||
+        ((template_p->fib6 != NULL) && ((vr_p->fib6 = oes_lpm6_clone(template_p->fib6)) == NULL))) {
+        status = OES_STATUS_NO_MEMORY;
+    }
+    pages = template_p->routes_size >> OES_ROUTER_ROUTE_PAGE_BITS;
+    if ((status == OES_STATUS_SUCCESS) && pages) {
+        vr_p->route_pages = malloc(pages * sizeof(*vr_p->route_pages));
+        if ((vr_p->route_pages == NULL) ||
+            (oes_activity_resize(&vr_p->route_activity, 0,
+                                 template_p->routes_size) != OES_STATUS_SUCCESS)) {
+            status = OES_STATUS_NO_MEMORY;
+        } else {
+            for (page = 0; page < pages; page++) {
+                vr_p->route_pages[page] = template_p->route_pages[page];
+                __atomic_add_fetch(&vr_p->route_pages[page]->refcnt, 1, __ATOMIC_RELAXED);
+            }
+            vr_p->routes_size = template_p->routes_size;
+            vr_p->routes_free = template_p->routes_free;
+            vr_p->route_cnt = template_p->route_cnt;
+        }
+    }
+    pthread_rwlock_unlock(&template_p->lock);
+
+    if (status != OES_STATUS_SUCCESS) {
+        oes_router_vr_release(vr_p);
+    } else {
+        vr_p->in_use = 1;
+        *vrid_p = vrid;
+    }
+    pthread_mutex_unlock(&oes_router_db_lock);
+    return status;
+}
+
+/*
+ * Image layout of a vr: the structures its sections copy as they are.
+ * An image saved by a build where any of them differs is rejected.
+ */
+#define OES_ROUTER_IMAGE_LAYOUT \
+    ((unsigned int)(OES_ROUTER_ROUTE_PAGE_BITS << 24) | \
+     (unsigned int)(sizeof(struct oes_router_route) << 16) | \
+     (unsigned int)(sizeof(struct oes_neigh_entry) << 8) | \
+     (unsigned int)sizeof(struct oes_nhg))
+
+/*
+ * Image section of a vr. It is followed by the neighbours, the next
+ * hop groups, the route pages and the IPv4 and IPv6 FIBs if present.
+ */
+struct oes_router_image {
+    unsigned int routes_size;
+    unsigned int routes_free;
+    unsigned int route_cnt;
+    unsigned int has_fib4;
+    unsigned int has_fib6;
+    unsigned int pad;
+};
+
+/**
+ *  This function saves the unicast routes, next hop groups and
+ *  neighbours of a virtual router to an image file, for a warm
+ *  restart through oes_api_router_fib_snapshot_restore. The
+ *  image is written next to path and renamed over it once
+ *  complete. Lookups go on while it is written.
+ *
+ * @param[in] vrid - Virtual router ID
+ * @param[in] path - Image file
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_NO_MEMORY if out of memory.
+ * @return OES_STATUS_ERROR if the file could not be written.
+ */
+oes_status_e
+oes_api_router_fib_snapshot_save(const unsigned int vrid,
+                                 const char *path)
+{
+    struct oes_router_image  image;
+    struct oes_image_writer  writer;
+    struct oes_router_vr    *vr_p;
+    unsigned int             page;
+    oes_status_e             status;
+
+    if (path == NULL) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_mutex_lock(&oes_router_db_lock);
+    vr_p = oes_router_vr_get(vrid);
+    if (vr_p == NULL) {
+        pthread_mutex_unlock(&oes_router_db_lock);
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_rwlock_rdlock(&vr_p->lock);
+    pthread_mutex_unlock(&oes_router_db_lock);
+
+    status = oes_image_create(&writer, path);
+    if (status == OES_STATUS_SUCCESS) {
+        memset(&image, 0, sizeof(image));
+        image.routes_size = vr_p->routes_size;
+        image.routes_free = vr_p->routes_free;
+        image.route_cnt = vr_p->route_cnt;
+        image.has_fib4 = (vr_p->fib4 != NULL);
+        image.has_fib6 = (vr_p->fib6 != NULL);
+        oes_image_write(&writer, &image, sizeof(image));
+        oes_neigh_save(&vr_p->neighs, &writer);
+        oes_nhg_save(&vr_p->nhgs, &writer);
+        for (page = 0; page < vr_p->routes_size >> OES_ROUTER_ROUTE_PAGE_BITS; page++) {
+            oes_image_write(&writer, vr_p->route_pages[page]->routes,
+                            sizeof(vr_p->route_pages[page]->routes));
+        }
+        if (vr_p->fib4 != NULL) {
+            oes_lpm4_save(vr_p->fib4, &writer);
+        }
+        if (vr_p->fib6 != NULL) {
+            oes_lpm6_save(vr_p->fib6, &writer);
+        }
+        status = oes_image_close(&writer, path, OES_ROUTER_IMAGE_LAYOUT);
+    }
+    pthread_rwlock_unlock(&vr_p->lock);
+    return status;
+}
+
+/* Loads the route pages of an image into an empty vr. */
+static oes_status_e
+oes_router_route_load(struct oes_router_vr *vr_p,
+                      struct oes_image_reader *reader_p,
+                      const struct oes_router_image *image_p)
+{
+    struct oes_router_route_page *page_p;
+    const void                   *routes_p;
+    unsigned int                  page, pages = image_p->routes_size >> OES_ROUTER_ROUTE_PAGE_BITS;
+
+    if ((image_p->routes_size & (OES_ROUTER_ROUTE_PAGE_SIZE - 1)) ||
+        (image_p->route_cnt > image_p->routes_size)) {
+        return OES_STATUS_ERROR;
+    }
+    if (pages == 0) {
+        return OES_STATUS_SUCCESS;
+    }
+    vr_p->route_pages = calloc(pages, sizeof(*vr_p->route_pages));
+    if ((vr_p->route_pages == NULL) ||
+        (oes_activity_resize(&vr_p->route_activity, 0, image_p->routes_size) != OES_STATUS_SUCCESS)) {
+        return OES_STATUS_NO_MEMORY;
+    }
+    for (page = 0; page < pages; page++) {
+        routes_p = oes_image_read(reader_p, sizeof(page_p->routes));
+        if (routes_p == NULL) {
+            return OES_STATUS_ERROR;
+        }
+        page_p = malloc(sizeof(*page_p));
+        if (page_p == NULL) {
+            return OES_STATUS_NO_MEMORY;
+        }
+        page_p->refcnt = 1;
+        memcpy(page_p->routes, routes_p, sizeof(page_p->routes));
+        vr_p->route_pages[page] = page_p;
+        vr_p->routes_size += OES_ROUTER_ROUTE_PAGE_SIZE;
+    }
+    vr_p->routes_free = image_p->routes_free;
+    vr_p->route_cnt = image_p->route_cnt;
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ *  This function restores the unicast routes, next hop groups
+ *  and neighbours of a virtual router from an image saved by
+ *  oes_api_router_fib_snapshot_save, typically of the same
+ *  vrid before a restart. The router must have no unicast
+ *  routes and no neighbours. The image is mapped and copied
+ *  table by table, with no per route work, and rejected if it
+ *  fails its checksum or was saved by a build with other
+ *  structures. Next hops resolve against the restored
+ *  neighbours; route and bucket activity start cleared. On
+ *  failure the router is left with no unicast routes and no
+ *  neighbours.
+ *
+ * @param[in] vrid - Virtual router ID
+ * @param[in] path - Image file
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_NO_MEMORY if out of memory.
+ * @return OES_STATUS_ERROR if the router is not empty, or the
+ *         image cannot be read or is rejected.
+ */
+oes_status_e
+oes_api_router_fib_snapshot_restore(const unsigned int vrid,
+                                    const char *path)
+{
+    const struct oes_router_image *image_p;
+    struct oes_image_reader        reader;
+    struct oes_nhg_table           nhgs;
+    struct oes_router_vr          *vr_p;
+    oes_status_e                   status;
+
+    if (path == NULL) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_mutex_lock(&oes_router_db_lock);
+    vr_p = oes_router_vr_get(vrid);
+    if (vr_p == NULL) {
+        pthread_mutex_unlock(&oes_router_db_lock);
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_rwlock_wrlock(&vr_p->lock);
+    pthread_mutex_unlock(&oes_router_db_lock);
+
+    if (vr_p->route_cnt || vr_p->neighs.cnt || vr_p->nhgs.cnt) {
+        pthread_rwlock_unlock(&vr_p->lock);
+        return OES_STATUS_ERROR;
+    }
+    status = oes_image_open(&reader, path, OES_ROUTER_IMAGE_LAYOUT);
+    if (status != OES_STATUS_SUCCESS) {
+        pthread_rwlock_unlock(&vr_p->lock);
+        return status;
+    }
+
+    /* start from no tables at all, the image holds every one in use */
+    oes_router_route_flush(vr_p);
+    oes_lpm4_destroy(vr_p->fib4);
+    oes_lpm6_destroy(vr_p->fib6);
+    vr_p->fib4 = NULL;
+    vr_p->fib6 = NULL;
+    oes_neigh_table_deinit(&vr_p->neighs);
+
+    image_p = oes_image_read(&reader, sizeof(*image_p));
+    if (image_p == NULL) {
+        status = OES_STATUS_ERROR;
+    }
+    /* neighbours first, next hop groups resolve against them */
+    if (status == OES_STATUS_SUCCESS) {
+        status = oes_neigh_load(&vr_p->neighs, &reader);
+    }
+    if (status == OES_STATUS_SUCCESS) {
+        status = oes_nhg_load(&nhgs, &reader, oes_router_neigh_resolved, vr_p);
+        if (status == OES_STATUS_SUCCESS) {
+            oes_nhg_table_deinit(&vr_p->nhgs);
+            vr_p->nhgs = nhgs;
+        }
+    }
+    if (status == OES_STATUS_SUCCESS) {
+        status = oes_router_route_load(vr_p, &reader, image_p);
+    }
+    if ((status == OES_STATUS_SUCCESS) && image_p->has_fib4) {
+        status = oes_lpm4_load(&reader, &vr_p->fib4);
+    }
+    if ((status == OES_STATUS_SUCCESS) && image_p->has_fib6) {
+        status = oes_lpm6_load(&reader, &vr_p->fib6);
+    }
+    oes_image_unmap(&reader);
+
+    if (status != OES_STATUS_SUCCESS) {
+        oes_router_route_flush(vr_p);
+        oes_neigh_table_deinit(&vr_p->neighs);
+    }
+    pthread_rwlock_unlock(&vr_p->lock);
+    return status;
+}
+
+/* Router MACs are unicast addresses. */
+static int
+oes_router_mac_valid(const struct ether_addr *mac_p)
+{
+    return !(mac_p->ether_addr_octet[0] & 0x01);
+}
+
+/*
+ * Takes the rif table lock once vrid is known to be in use; a router
+ * keeps its vrid while it has interfaces, so holding this lock is
+ * enough afterwards.
+ */
+static oes_status_e
+oes_router_rif_lock_vr(const unsigned int vrid,
+                       int write)
+{
+    pthread_mutex_lock(&oes_router_db_lock);
+    if (oes_router_vr_get(vrid) == NULL) {
+        pthread_mutex_unlock(&oes_router_db_lock);
+        return OES_STATUS_PARAM_ERROR;
+    }
+    if (write) {
+        pthread_rwlock_wrlock(&oes_router_rif_lock);
+    } else {
+        pthread_rwlock_rdlock(&oes_router_rif_lock);
+    }
+    pthread_mutex_unlock(&oes_router_db_lock);
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ *  This function adds/modifies/deletes/delete_all a router
+ *  interface. A router interface is associated with L2
+ *  interface: a logical port, or a VLAN of a bridge (VLAN IDs
+ *  1 .. 4094), each owned by at most one router interface.
+ *  Router interface IDs are allocated across all virtual
+ *  routers, lowest free first, and are below 4096. ADD enables
+ *  both IP versions. EDIT replaces the attributes, and moves
+ *  the interface to ifc_p unless it is NULL. DELETE_ALL deletes
+ *  every router interface of the virtual router, rif_p and the
+ *  other parameters are ignored.
+ *
+ * @param[in] access_cmd - ADD/EDIT/DELETE/DELETE ALL.
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in,out] rif_p - Router Interface ID.
+ * @param[in] ifc_p - Interface type and parameters e.g.
+ *       vlan,port ...
+ * @param[in] ifc_attr_p - Interface attributes e.g mac address
+ *       mtu ,rpc ... .
+ * @param[in,out] router_interface_vs_ext- vendor specific
+ *       extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if router interface was not added.
+ * @return OES_STATUS_ENTRY_ALREADY_EXISTS if another router
+ *         interface owns the L2 interface.
+ * @return OES_STATUS_NO_RESOURCES if no interface is available to create.
+ * @return OES_STATUS_NO_MEMORY if out of memory.
+ * @return OES_STATUS_ERROR general error.
+ */
+oes_status_e
+oes_api_router_interface_set(const enum oes_access_cmd access_cmd,
+                             const unsigned int vrid,
+                             unsigned int *rif_p,
+                             const struct oes_l3_interface *ifc_p,
+                             const struct oes_l3_interface_attributes *ifc_attr_p,
+                             void *router_interface_vs_ext)
+{
+    struct oes_router_vr *vr_p;
+    struct oes_rif       *rif_rec_p = NULL;
+    oes_status_e          status = OES_STATUS_SUCCESS;
+    unsigned int          rif;
+
+    switch (access_cmd) {
+    case OES_ACCESS_CMD_ADD:
+    case OES_ACCESS_CMD_EDIT:
+        if ((rif_p == NULL) || (ifc_attr_p == NULL) || !oes_router_mac_valid(&ifc_attr_p->mac_addr) ||
+            ((ifc_p == NULL) && (access_cmd == OES_ACCESS_CMD_ADD)) ||
+            ((ifc_p != NULL) && !oes_rif_ifc_valid(ifc_p))) {
+            return OES_STATUS_PARAM_ERROR;
+        }
+        break;
+
+    case OES_ACCESS_CMD_DELETE:
+        if (rif_p == NULL) {
+            return OES_STATUS_PARAM_ERROR;
+        }
+        break;
+
+    case OES_ACCESS_CMD_DELETE_ALL:
+        break;
+
+    default:
+        return OES_STATUS_CMD_UNSUPPORTED;
+    }
+
+    /* held throughout, it guards the interface count of the vr */
+    pthread_mutex_lock(&oes_router_db_lock);
+    vr_p = oes_router_vr_get(vrid);
+    if (vr_p == NULL) {
+        pthread_mutex_unlock(&oes_router_db_lock);
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_rwlock_wrlock(&oes_router_rif_lock);
+
+    if ((access_cmd == OES_ACCESS_CMD_EDIT) || (access_cmd == OES_ACCESS_CMD_DELETE)) {
+        rif_rec_p = oes_rif_get(&oes_router_rifs, vrid, *rif_p);
+        if (rif_rec_p == NULL) {
+            status = OES_STATUS_ENTRY_NOT_FOUND;
+        }
+    }
+    if (status == OES_STATUS_SUCCESS) {
+        switch (access_cmd) {
+        case OES_ACCESS_CMD_ADD:
+            status = oes_rif_add(&oes_router_rifs, vrid, ifc_p, ifc_attr_p, rif_p);
+            if (status == OES_STATUS_SUCCESS) {
+                vr_p->rif_cnt++;
+            }
+            break;
+
+        case OES_ACCESS_CMD_EDIT:
+            if (ifc_p != NULL) {
+                status = oes_rif_ifc_set(&oes_router_rifs, *rif_p, ifc_p);
+            }
+            if (status == OES_STATUS_SUCCESS) {
+                oes_rif_attr_set(&oes_router_rifs, *rif_p, ifc_attr_p);
+            }
+            break;
+
+        case OES_ACCESS_CMD_DELETE:
+            oes_rif_delete(&oes_router_rifs, *rif_p);
+            vr_p->rif_cnt--;
+            break;
+
+        default:
+            for (rif = 0; vr_p->rif_cnt && (rif < OES_RIF_MAX_RIFS); rif++) {
+                if (oes_rif_get(&oes_router_rifs, vrid, rif) != NULL) {
+                    oes_rif_delete(&oes_router_rifs, rif);
+                    vr_p->rif_cnt--;
+                }
+            }
+            break;
+        }
+    }
+
+    pthread_rwlock_unlock(&oes_router_rif_lock);
+    pthread_mutex_unlock(&oes_router_db_lock);
+    return status;
+}
+
+/**
+ * This function gets a router interface information.
+ *
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] rif - Router Interface ID.
+ * @param[out] ifc - Interface type and parameters
+ * @param[out] ifc_attr - Interface attributes
+ * @param[in,out] router_interface_vs_ext- vendor specific
+ *       extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if router interface was not added.
+ * @return OES_STATUS_ERROR general error.
+ */
+oes_status_e
+oes_api_router_interface_get(const unsigned int vrid,
+                             const unsigned int rif,
+                             struct oes_l3_interface *ifc_p,
+                             struct oes_l3_interface_attributes *ifc_attr_p,
+                             void *router_interface_vs_ext)
+{
+    const struct oes_rif *rif_rec_p;
+    oes_status_e          status;
+
+    if ((ifc_p == NULL) || (ifc_attr_p == NULL)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    status = oes_router_rif_lock_vr(vrid, 0);
+    if (status != OES_STATUS_SUCCESS) {
+        return status;
+    }
+
+    rif_rec_p = oes_rif_get(&oes_router_rifs, vrid, rif);
+    if (rif_rec_p == NULL) {
+        status = OES_STATUS_ENTRY_NOT_FOUND;
+    } else {
+        *ifc_p = rif_rec_p->ifc;
+        *ifc_attr_p = rif_rec_p->attr;
+    }
+
+    pthread_rwlock_unlock(&oes_router_rif_lock);
+    return status;
+}
+
+/**
+ *  This function sets admin state of a router interface. Admin state is set per
+ *  IP version.
+ *
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] rif - Router Interface ID.
+ * @param[in] admin_state_p - Admin state.
+ * @param[in,out] router_interface_state_vs_ext- vendor specific
+ *       extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if router interface was not added.
+ * @return OES_STATUS_ERROR general error.
+ */
+oes_status_e
+oes_api_router_interface_state_set(const unsigned int vrid,
+                                   const unsigned int rif,
+                                   const struct oes_l3_interface_admin_state *admin_state_p,
+                                   void *router_interface_state_vs_ext)
+{
+    struct oes_rif *rif_rec_p;
+    oes_status_e    status;
+
+    if (admin_state_p == NULL) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    status = oes_router_rif_lock_vr(vrid, 1);
+    if (status != OES_STATUS_SUCCESS) {
+        return status;
+    }
+
+    rif_rec_p = oes_rif_get(&oes_router_rifs, vrid, rif);
+    if (rif_rec_p == NULL) {
+        status = OES_STATUS_ENTRY_NOT_FOUND;
+    } else {
+        rif_rec_p->state = *admin_state_p;
+    }
+
+    pthread_rwlock_unlock(&oes_router_rif_lock);
+    return status;
+}
+
+/**
+ *  This function gets admin state of a router interface.
+ *
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] rif - Router Interface ID.
+ * @param[out] admin_state_p - Admin state.
+ * @param[in,out] router_interface_state_vs_ext- vendor specific
+ *       extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if router interface was not added.
+ * @return OES_STATUS_ERROR general error.
+ */
+oes_status_e
+oes_api_router_interface_state_get(const unsigned int vrid,
+                                   const unsigned int rif,
+                                   struct oes_l3_interface_admin_state *admin_state_p,
+                                   void *router_interface_state_vs_ext)
+{
+    const struct oes_rif *rif_rec_p;
+    oes_status_e          status;
+
+    if (admin_state_p == NULL) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    status = oes_router_rif_lock_vr(vrid, 0);
+    if (status != OES_STATUS_SUCCESS) {
+        return status;
+    }
+
+    rif_rec_p = oes_rif_get(&oes_router_rifs, vrid, rif);
+    if (rif_rec_p == NULL) {
+        status = OES_STATUS_ENTRY_NOT_FOUND;
+    } else {
+        *admin_state_p = rif_rec_p->state;
+    }
+
+    pthread_rwlock_unlock(&oes_router_rif_lock);
+    return status;
+}
+
+/**
+ *  This function adds/deletes a MAC address from a router interface.
+ *  The router interface answers to these MACs besides the MAC of
+ *  its attributes. Adding a MAC it has is a no-op; DELETE fails,
+ *  deleting nothing, unless it has every MAC of the list.
+ *  DELETE_ALL ignores the list.
+ *
+ * @param[in] access_cmd - ADD/DELETE/DELETE_ALL.
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] rif - Router Interface ID.
+ * @param[in] mac_addr_list_p - MAC addresses array.
+ * @param[in] mac_cnt - MAC addresses array size.
+ * @param[in,out] router_interface_mac_vs_ext- vendor specific
+ *       extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if the router interface was
+ *         not added, or DELETE finds a MAC it does not have.
+ * @return OES_STATUS_NO_RESOURCES if ADD exceeds the MACs of all
+ *         router interfaces.
+ * @return OES_STATUS_NO_MEMORY if out of memory.
+ * @return OES_STATUS_ERROR general error.
+ */
+oes_status_e
+oes_api_router_interface_mac_set(const enum oes_access_cmd access_cmd,
+                                 const unsigned int vrid,
+                                 const unsigned int rif,
+                                 const struct ether_addr *mac_addr_list_p,
+                                 const unsigned short mac_cnt,
+                                 void *router_interface_mac_vs_ext)
+{
+    oes_status_e   status;
+    unsigned int   idx;
+    unsigned short i;
+
+    switch (access_cmd) {
+    case OES_ACCESS_CMD_ADD:
+    case OES_ACCESS_CMD_DELETE:
+        if ((mac_cnt != 0) && (mac_addr_list_p == NULL)) {
+            return OES_STATUS_PARAM_ERROR;
+        }
+        for (i = 0; i < mac_cnt; i++) {
+            if (!oes_router_mac_valid(&mac_addr_list_p[i])) {
+                return OES_STATUS_PARAM_ERROR;
+            }
+        }
+        break;
+
+    case OES_ACCESS_CMD_DELETE_ALL:
+        break;
+
+    default:
+        return OES_STATUS_CMD_UNSUPPORTED;
+    }
+    status = oes_router_rif_lock_vr(vrid, 1);
+    if (status != OES_STATUS_SUCCESS) {
+        return status;
+    }
+
+    if (oes_rif_get(&oes_router_rifs, vrid, rif) == NULL) {
+        status = OES_STATUS_ENTRY_NOT_FOUND;
+    } else if (access_cmd == OES_ACCESS_CMD_ADD) {
+        /* reserve first, so the list goes in whole or not at all */
+        for (i = 0, idx = 0; i < mac_cnt; i++) {
+            idx += (oes_rif_mac_find(&oes_router_rifs, rif, &mac_addr_list_p[i]) == OES_RIF_MAC_NONE);
+        }
+        status = oes_rif_mac_reserve(&oes_router_rifs, idx);
+        for (i = 0; (status == OES_STATUS_SUCCESS) && (i < mac_cnt); i++) {
+            oes_rif_mac_add(&oes_router_rifs, rif, &mac_addr_list_p[i]);
+        }
+    } else if (access_cmd == OES_ACCESS_CMD_DELETE) {
+        for (i = 0; i < mac_cnt; i++) {
+            if (oes_rif_mac_find(&oes_router_rifs, rif, &mac_addr_list_p[i]) == OES_RIF_MAC_NONE) {
+                status = OES_STATUS_ENTRY_NOT_FOUND;
+                break;
+            }
+        }
+        for (i = 0; (status == OES_STATUS_SUCCESS) && (i < mac_cnt); i++) {
+            /* a MAC listed twice is gone the second time */
+            idx = oes_rif_mac_find(&oes_router_rifs, rif, &mac_addr_list_p[i]);
+
+            if (idx != OES_RIF_MAC_NONE) {
+                oes_rif_mac_delete(&oes_router_rifs, idx);
+            }
+        }
+    } else {
+        oes_rif_mac_flush(&oes_router_rifs, rif);
+    }
+
+    pthread_rwlock_unlock(&oes_router_rif_lock);
+    return status;
+}
+
+/**
+ *  This function gets MAC address of a router interface: the
+ *  MACs added by oes_api_router_interface_mac_set. With
+ *  *mac_cnt_p 0 it only returns their number.
+ *
+ * @param[in] access_cmd - GET.
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] rif - Router Interface ID.
+ * @param[out] mac_addr_list_p - MAC addresses array .
+ * @param[in,out] mac_cnt_p - MAC addresses array size .
+ * @param[in,out] router_interface_mac_vs_ext- vendor specific
+ *       extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_PARAM_EXCEEDS_RANGE if the array is too small,
+ *         *mac_cnt_p is set to the number of MACs.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if router interface was not added.
+ * @return OES_STATUS_ERROR general error.
+ */
+oes_status_e
+oes_api_router_interface_mac_get(const enum oes_access_cmd access_cmd,
+                                 const unsigned int vrid,
+                                 const unsigned int rif,
+                                 struct ether_addr *mac_addr_list_p,
+                                 unsigned short *mac_cnt_p,
+                                 void *router_interface_mac_vs_ext)
+{
+    const struct oes_rif *rif_rec_p;
+    oes_status_e          status;
+    unsigned int          idx, i = 0;
+
+    if (access_cmd != OES_ACCESS_CMD_GET) {
+        return OES_STATUS_CMD_UNSUPPORTED;
+    }
+    if ((mac_cnt_p == NULL) || ((*mac_cnt_p != 0) && (mac_addr_list_p == NULL))) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    status = oes_router_rif_lock_vr(vrid, 0);
+    if (status != OES_STATUS_SUCCESS) {
+        return status;
+    }
+
+    rif_rec_p = oes_rif_get(&oes_router_rifs, vrid, rif);
+    if (rif_rec_p == NULL) {
+        status = OES_STATUS_ENTRY_NOT_FOUND;
+    } else {
+        if ((*mac_cnt_p != 0) && (*mac_cnt_p < rif_rec_p->mac_cnt)) {
+            status = OES_STATUS_PARAM_EXCEEDS_RANGE;
+        } else if (*mac_cnt_p != 0) {
+            for (idx = rif_rec_p->mac_head; idx != OES_RIF_MAC_NONE;
+                 idx = oes_router_rifs.macs[idx].rif_next) {
+                mac_addr_list_p[i++] = oes_router_rifs.macs[idx].mac;
+            }
+        }
+        *mac_cnt_p = rif_rec_p->mac_cnt;
+    }
+
+    pthread_rwlock_unlock(&oes_router_rif_lock);
+    return status;
+}
+
+/**
+ *  This function resolves the ingress router interface of a
+ *  packet in the software forwarding path: the router interface
+ *  owning the L2 interface the packet came in on, and whether
+ *  its destination MAC is a router MAC of that interface. Both
+ *  are direct lookups, independent of the number of router
+ *  interfaces and MACs.
+ *
+ * @param[in] ifc_p - L2 interface the packet came in on
+ * @param[in] dst_mac_p - packet destination MAC
+ * @param[out] lookup_data_p - virtual router, router interface,
+ *       router MAC match and admin state
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if no router interface owns
+ *         the L2 interface.
+ */
+oes_status_e
+oes_api_router_interface_lookup(const struct oes_l3_interface *ifc_p,
+                                const struct ether_addr *dst_mac_p,
+                                struct oes_l3_interface_lookup_data *lookup_data_p)
+{
+    const struct oes_rif *rif_rec_p;
+    unsigned int          rif;
+
+    if ((ifc_p == NULL) || (dst_mac_p == NULL) || (lookup_data_p == NULL) ||
+        !oes_rif_ifc_valid(ifc_p)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_rwlock_rdlock(&oes_router_rif_lock);
+    rif = oes_rif_find(&oes_router_rifs, ifc_p);
+    if (rif == OES_ROUTER_RIF_INVALID) {
+        pthread_rwlock_unlock(&oes_router_rif_lock);
+        return OES_STATUS_ENTRY_NOT_FOUND;
+    }
+    rif_rec_p = &oes_router_rifs.rifs[rif];
+    lookup_data_p->vrid = rif_rec_p->vrid;
+    lookup_data_p->rif = rif;
+    lookup_data_p->router_mac = oes_rif_mac_match(&oes_router_rifs, rif, dst_mac_p);
+    lookup_data_p->admin_state = rif_rec_p->state;
+    pthread_rwlock_unlock(&oes_router_rif_lock);
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ *  This function adds/modifies/deletes/delete_all a neighbour
+ *  information. The neighbour information associate an IP
+ *  address to a MAC address. The neighbour IP addresses are
+ *  learned via ARP/ND discovery at the control protocols layer,
+ *  the interface that the neighbours are associated with is
+ *  derived from the IP interface configuration. When calling
+ *  with DELETE command, rif parameter is ignored. At DELETE_ALL
+ *  operation the neighbours associated with the router
+ *  interface parameter will be deleted in case it is valid, in
+ *  case rif is invalid , all neighbours will be deleted.
+ *  (rif OES_ROUTER_RIF_INVALID or a NULL neigh_data_p).
+ *
+ * @param[in] access_cmd - ADD/EDIT/DELETE/DELETE_ALL.
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] neigh_key_p - neigh IP address.
+ * @param[in] neigh_data_p- neigh data including rif,mac address
+ *       , action(TRAP/DROP/FORWARD) ,activity
+ * @param[in,out] router_neigh_vs_ext- vendor specific extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_NO_RESOURCES if no neighbour entry is available to create.
+ * @return OES_STATUS_ERROR general error.
+ */
+oes_status_e
+oes_api_router_neigh_set(const enum oes_access_cmd access_cmd,
+                         const unsigned int vrid,
+                         const struct oes_ip_addr *neigh_key_p,
+                         const struct oes_neigh_data *neigh_data_p,
+                         void *router_neigh_vs_ext)
+{
+    struct oes_router_vr   *vr_p;
+    struct oes_neigh_entry *entry_p;
+    oes_status_e            status = OES_STATUS_SUCCESS;
+    unsigned int            idx;
+
+    if (access_cmd != OES_ACCESS_CMD_DELETE_ALL) {
+        if (neigh_key_p == NULL) {
+            return OES_STATUS_PARAM_ERROR;
+        }
+        if ((access_cmd != OES_ACCESS_CMD_DELETE) &&
+            ((neigh_data_p == NULL) || (neigh_data_p->mac_addr == NULL))) {
+            return OES_STATUS_PARAM_ERROR;
+        }
+    }
+
+    pthread_mutex_lock(&oes_router_db_lock);
+    vr_p = oes_router_vr_get(vrid);
+    if (vr_p == NULL) {
+        pthread_mutex_unlock(&oes_router_db_lock);
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_rwlock_wrlock(&vr_p->lock);
+    pthread_mutex_unlock(&oes_router_db_lock);
+
+    switch (access_cmd) {
+    case OES_ACCESS_CMD_ADD:
+        status = oes_neigh_add(&vr_p->neighs, neigh_key_p, neigh_data_p->rif, &idx);
+        if (status != OES_STATUS_SUCCESS) {
+            break;
+        }
+        entry_p = &vr_p->neighs.entries[idx];
+        entry_p->mac = *neigh_data_p->mac_addr;
+        entry_p->action = neigh_data_p->action;
+        oes_nhg_neigh_update(&vr_p->nhgs, neigh_key_p,
+                             entry_p->action == OES_ROUTER_ACTION_FORWARD);
+        break;
+
+    case OES_ACCESS_CMD_EDIT:
+        idx = oes_neigh_find(&vr_p->neighs, neigh_key_p);
+        if (idx == OES_NEIGH_NONE) {
+            status = OES_STATUS_ENTRY_NOT_FOUND;
+            break;
+        }
+        status = oes_neigh_rif_set(&vr_p->neighs, idx, neigh_data_p->rif);
+        if (status != OES_STATUS_SUCCESS) {
+            break;
+        }
+        entry_p = &vr_p->neighs.entries[idx];
+        entry_p->mac = *neigh_data_p->mac_addr;
+        entry_p->action = neigh_data_p->action;
+        oes_nhg_neigh_update(&vr_p->nhgs, neigh_key_p,
+                             entry_p->action == OES_ROUTER_ACTION_FORWARD);
+        break;
+
+    case OES_ACCESS_CMD_DELETE:
+        idx = oes_neigh_find(&vr_p->neighs, neigh_key_p);
+        if (idx == OES_NEIGH_NONE) {
+            status = OES_STATUS_ENTRY_NOT_FOUND;
+            break;
+        }
+        oes_nhg_neigh_update(&vr_p->nhgs, neigh_key_p, 0);
+        oes_neigh_delete(&vr_p->neighs, idx);
+        break;
+
+    case OES_ACCESS_CMD_DELETE_ALL:
+        if ((neigh_data_p == NULL) || (neigh_data_p->rif == OES_ROUTER_RIF_INVALID)) {
+            for (idx = 0; idx < vr_p->neighs.size; idx++) {
+                if (vr_p->neighs.entries[idx].prio) {
+                    oes_nhg_neigh_update(&vr_p->nhgs, &vr_p->neighs.entries[idx].ip, 0);
+                }
+            }
+            oes_neigh_flush(&vr_p->neighs);
+            break;
+        }
+        while ((idx = oes_neigh_rif_first(&vr_p->neighs, neigh_data_p->rif)) != OES_NEIGH_NONE) {
+            oes_nhg_neigh_update(&vr_p->nhgs, &vr_p->neighs.entries[idx].ip, 0);
+            oes_neigh_delete(&vr_p->neighs, idx);
+        }
+        break;
+
+    default:
+        status = OES_STATUS_CMD_UNSUPPORTED;
+        break;
+    }
+
+    pthread_rwlock_unlock(&vr_p->lock);
+    return status;
+}
+
+/*
+ * Copies a neighbour out. mac_addr, if not NULL, is filled in place.
+ * GET_ACTIVITY clears the activity it reports.
+ */
+static void
+oes_router_neigh_read(struct oes_neigh_table *neighs_p,
+                      unsigned int idx,
+                      struct oes_ip_addr *key_p,
+                      struct oes_neigh_data *data_p,
+                      int clear_activity)
+{
+    const struct oes_neigh_entry *entry_p = &neighs_p->entries[idx];
+
+    *key_p = entry_p->ip;
+    data_p->rif = entry_p->rif;
+    if (data_p->mac_addr != NULL) {
+        *data_p->mac_addr = entry_p->mac;
+    }
+    data_p->action = entry_p->action;
+    data_p->activity = oes_activity_get(neighs_p->activity, idx, clear_activity);
+}
+
+/**
+ *  This function gets/get activity a neighbour information.
+ *  function can receive four types of input:
+ *     1) get information for specific  neigh
+ *      user should inserts  sepecific neigh as the first
+ *      neigh_key element in the neigh_key array , neigh_cnt
+ *      should be equal to 1, access_cmd should be
+ *      OES_ACCESS_CMD_GET
+ *
+ *     2) get neigh  activity information for specific neigh
+ *      user should inserts sepecific neigh as the first
+ *      neigh_key element in the neigh_key array , neigh_cnt
+ *      should be equal to 1, access_cmd should be
+ *      OES_ACCESS_CMD_GET_ACTIVITY
+ *
+ *   - 3) get a list of first n neighs ,user
+ *      should provide an empty  neigh_key array array
+ *      neigh_cnt should be equal to n,access_cmd should be
+ *      OES_ACCESS_CMD_GET_FIRST
+ *
+ *   - 4) get a list of n  neighs  which comes after
+ *      certain neigh(it does not have to exist) user should
+ *      insert the certain neigh as the first neigh_key element
+ *      in the neigh_key array , neigh_cnt should be equal to n,
+ *      OES_ACCESS_CMD_GET_NEXT
+ *
+ *  The mac_addr of each data element, if not NULL, receives the
+ *  neighbour MAC. GET_ACTIVITY clears the activity it returns.
+ *  neigh_cnt returns the number of neighbours filled.
+ *
+ * @param[in] access_cmd - GET/GET_NEXT/GET_FIRST/GET_ACTIVITY
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in,out] neigh_key_list_p - neigh IP address array
+ * @param[out] neigh_data_list_p- neigh data  array , each neigh
+ *       data element includes rif,mac address ,
+ *       action(TRAP/DROP/FORWARD) ,activity
+ * @param[in,out] neigh_cnt_p - array size
+ * @param[in,out] router_neigh_vs_ext- vendor specific extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if neighbour was not added.
+ * @return OES_STATUS_ERROR general error.
+ */
+oes_status_e
+oes_api_router_neigh_get(const enum oes_access_cmd access_cmd,
+                         const unsigned int vrid,
+                         struct oes_ip_addr *neigh_key_list_p,
+                         struct oes_neigh_data *neigh_data_list_p,
+                         unsigned short *neigh_cnt_p,
+                         void *router_neigh_vs_ext)
+{
+    struct oes_router_vr *vr_p;
+    oes_status_e          status = OES_STATUS_SUCCESS;
+    unsigned int          idx;
+    unsigned short        cnt = 0;
+
+    if ((neigh_key_list_p == NULL) || (neigh_data_list_p == NULL) || (neigh_cnt_p == NULL) ||
+        (*neigh_cnt_p == 0)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_mutex_lock(&oes_router_db_lock);
+    vr_p = oes_router_vr_get(vrid);
+    if (vr_p == NULL) {
+        pthread_mutex_unlock(&oes_router_db_lock);
+        return OES_STATUS_PARAM_ERROR;
+    }
+    /* activity bits are cleared atomically, GET_ACTIVITY only reads the table */
+    pthread_rwlock_rdlock(&vr_p->lock);
+    pthread_mutex_unlock(&oes_router_db_lock);
+
+    switch (access_cmd) {
+    case OES_ACCESS_CMD_GET:
+    case OES_ACCESS_CMD_GET_ACTIVITY:
+        idx = oes_neigh_find(&vr_p->neighs, neigh_key_list_p);
+        if (idx == OES_NEIGH_NONE) {
+            status = OES_STATUS_ENTRY_NOT_FOUND;
+            break;
+        }
+        oes_router_neigh_read(&vr_p->neighs, idx, neigh_key_list_p, neigh_data_list_p,
+                              access_cmd == OES_ACCESS_CMD_GET_ACTIVITY);
+        cnt = 1;
+        break;
+
+    case OES_ACCESS_CMD_GET_FIRST:
+    case OES_ACCESS_CMD_GET_NEXT:
+        idx = (access_cmd == OES_ACCESS_CMD_GET_FIRST) ?
+              oes_neigh_first(&vr_p->neighs) : oes_neigh_next(&vr_p->neighs, neigh_key_list_p);
+        while ((idx != OES_NEIGH_NONE) && (cnt < *neigh_cnt_p)) {
+            oes_router_neigh_read(&vr_p->neighs, idx, &neigh_key_list_p[cnt],
+                                  &neigh_data_list_p[cnt], 0);
+            idx = oes_neigh_next(&vr_p->neighs, &neigh_key_list_p[cnt]);
+            cnt++;
+        }
+        break;
+
+    default:
+        status = OES_STATUS_CMD_UNSUPPORTED;
+        break;
+    }
+
+    pthread_rwlock_unlock(&vr_p->lock);
+    *neigh_cnt_p = cnt;
+    return status;
+}
+
+/**
+ *  This function harvests the activity of every neighbour of a
+ *  virtual router in one pass. It returns the neighbours that were
+ *  hit by oes_api_router_uc_route_lookup since the previous
+ *  harvest (active = 1), or the ones that were not (active = 0),
+ *  and clears the activity of all neighbours. Neighbour aging
+ *  calls it once per interval instead of GET_ACTIVITY per
+ *  neighbour.
+ *
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] active - 1 for the active set, 0 for the inactive set
+ * @param[out] neigh_key_list_p - neigh IP address array
+ * @param[in,out] neigh_cnt_p - array size, returns the number of
+ *       neighbours in the set
+ * @param[in,out] router_neigh_vs_ext- vendor specific extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_PARAM_EXCEEDS_RANGE if the set does not fit
+ *         the array, neigh_cnt_p returns its size and no activity
+ *         is cleared.
+ * @return OES_STATUS_NO_MEMORY if out of memory.
+ */
+oes_status_e
+oes_api_router_neigh_activity_harvest(const unsigned int vrid,
+                                      const int active,
+                                      struct oes_ip_addr *neigh_key_list_p,
+                                      unsigned int *neigh_cnt_p,
+                                      void *router_neigh_vs_ext)
+{
+    struct oes_router_vr *vr_p;
+    unsigned long long   *snapshot_p, bits;
+    oes_status_e          status = OES_STATUS_SUCCESS;
+    unsigned int          size, w, idx, set_cnt, cnt = 0;
+
+    if ((neigh_key_list_p == NULL) || (neigh_cnt_p == NULL)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_mutex_lock(&oes_router_db_lock);
+    vr_p = oes_router_vr_get(vrid);
+    if (vr_p == NULL) {
+        pthread_mutex_unlock(&oes_router_db_lock);
+        return OES_STATUS_PARAM_ERROR;
+    }
+    /* lookups keep marking while the bitmap is swapped out word by word */
+    pthread_rwlock_rdlock(&vr_p->lock);
+    pthread_mutex_unlock(&oes_router_db_lock);
+
+    size = vr_p->neighs.size;
+    snapshot_p = malloc((OES_ACTIVITY_WORDS(size) + 1) * sizeof(*snapshot_p));
+    if (snapshot_p == NULL) {
+        pthread_rwlock_unlock(&vr_p->lock);
+        return OES_STATUS_NO_MEMORY;
+    }
+    set_cnt = oes_activity_harvest(vr_p->neighs.activity, snapshot_p, size);
+    if (!active) {
+        set_cnt = vr_p->neighs.cnt - set_cnt;
+    }
+    if (set_cnt > *neigh_cnt_p) {
+        oes_activity_restore(vr_p->neighs.activity, snapshot_p, size);
+        status = OES_STATUS_PARAM_EXCEEDS_RANGE;
+    } else {
+        for (w = 0; w < OES_ACTIVITY_WORDS(size); w++) {
+            for (bits = active ? snapshot_p[w] : ~snapshot_p[w]; bits; bits &= bits - 1) {
+                idx = w * 64 + __builtin_ctzll(bits);
+                if ((idx < size) && vr_p->neighs.entries[idx].prio) {
+                    neigh_key_list_p[cnt++] = vr_p->neighs.entries[idx].ip;
+                }
+            }
+        }
+    }
+
+    pthread_rwlock_unlock(&vr_p->lock);
+    free(snapshot_p);
+    *neigh_cnt_p = (status == OES_STATUS_SUCCESS) ? cnt : set_cnt;
+    return status;
+}
+
+/**
+ *  This function adds/deletes an unicast route into the routing
+ *  table. The route is composed of network address and next hop
+ *  array which may contains more than one entry for ECMP. In
+ *  case the neigh, entry is not known yet,the route will be
+ *  added with action TRAP . Upon neigh entry resolved and
+ *  configured, the route can be modified into FORWARD. A route
+ *  added with FORWARD while none of its next hops has a
+ *  forwarding neigh entry acts (and reads back) as TRAP, and
+ *  turns to FORWARD by itself once oes_api_router_neigh_set
+ *  resolves one of them, without the route being set again.
+ *  Calling with SET cmd will replace all next hop entries
+ *  associated with the route. (If the route does not exist, it will be
+ *  created).
+ *
+ * @param[in] access_cmd - ADD/DELETE/DELETE ALL .
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] uc_route_key_p - IP network address+prefix len
+ * @param[in] uc_route_data_p - routing table data including
+ *       action(tarp,drop,forward),next-hop list
+ * @param[in,out] router_uc_route_vs_ext- vendor specific
+ *       extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_NO_RESOURCES if no routes is available to create.
+ * @return OES_STATUS_ERROR general error.
+ */
+oes_status_e
+oes_api_router_uc_route_set(const enum oes_access_cmd access_cmd,
+                            const unsigned int vrid,
+                            const struct oes_ip_prefix *uc_route_key_p,
+                            const struct oes_uc_route_data *uc_route_data_p,
+                            void *router_uc_route_vs_ext)
+{
+    struct oes_router_vr *vr_p;
+    oes_status_e          status;
+
+    if (access_cmd != OES_ACCESS_CMD_DELETE_ALL) {
+        if (uc_route_key_p == NULL) {
+            return OES_STATUS_PARAM_ERROR;
+        }
+        if ((access_cmd != OES_ACCESS_CMD_DELETE) &&
+            ((uc_route_data_p == NULL) ||
+             (uc_route_data_p->next_hop_cnt && (uc_route_data_p->next_hop_list == NULL)))) {
+            return OES_STATUS_PARAM_ERROR;
+        }
+    }
+
+    pthread_mutex_lock(&oes_router_db_lock);
+    vr_p = oes_router_vr_get(vrid);
+    if (vr_p == NULL) {
+        pthread_mutex_unlock(&oes_router_db_lock);
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_rwlock_wrlock(&vr_p->lock);
+    pthread_mutex_unlock(&oes_router_db_lock);
+
+    if (access_cmd == OES_ACCESS_CMD_DELETE_ALL) {
+        oes_router_route_flush(vr_p);
+        status = OES_STATUS_SUCCESS;
+    } else {
+        status = oes_router_uc_route_do(vr_p, access_cmd, uc_route_key_p, uc_route_data_p,
+                                        router_uc_route_vs_ext);
+    }
+
+    pthread_rwlock_unlock(&vr_p->lock);
+    return status;
+}
+
+/**
+ *  This function applies a batch of unicast route operations
+ *  atomically: lookups of the virtual router see the FIB either
+ *  before or after the whole batch, and a failing operation leaves
+ *  the FIB as it was. Operations apply in order, ADD creates or
+ *  replaces a route, EDIT replaces an existing one and DELETE
+ *  removes one. A batch costs one lock round trip, so loading a
+ *  full table takes a few large batches instead of a call per
+ *  prefix.
+ *
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] uc_route_op_list_p - operations
+ * @param[in] uc_route_op_cnt - number of operations
+ * @param[out] failed_op_p - index of the operation that failed,
+ *       may be NULL
+ * @param[in,out] router_uc_route_vs_ext- vendor specific
+ *       extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if an EDIT or DELETE targets
+ *         a missing route.
+ * @return OES_STATUS_NO_RESOURCES if no routes is available to create.
+ * @return OES_STATUS_NO_MEMORY if out of memory.
+ */
+oes_status_e
+oes_api_router_uc_route_batch_set(const unsigned int vrid,
+                                  const struct oes_uc_route_op *uc_route_op_list_p,
+                                  const unsigned int uc_route_op_cnt,
+                                  unsigned int *failed_op_p,
+                                  void *router_uc_route_vs_ext)
+{
+    struct oes_router_undo *undo_p;
+    struct oes_router_vr   *vr_p;
+    unsigned int            undo_cnt;
+    oes_status_e            status;
+
+    if ((uc_route_op_list_p == NULL) && uc_route_op_cnt) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    /* an ADD reviving a route deleted earlier in the batch logs two entries */
+    undo_p = malloc(2 * (unsigned long)uc_route_op_cnt * sizeof(*undo_p) + 1);
+    if (undo_p == NULL) {
+        return OES_STATUS_NO_MEMORY;
+    }
+
+    pthread_mutex_lock(&oes_router_db_lock);
+    vr_p = oes_router_vr_get(vrid);
+    if (vr_p == NULL) {
+        pthread_mutex_unlock(&oes_router_db_lock);
+        free(undo_p);
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_rwlock_wrlock(&vr_p->lock);
+    pthread_mutex_unlock(&oes_router_db_lock);
+
+    status = oes_router_uc_route_batch_do(vr_p, uc_route_op_list_p, uc_route_op_cnt,
+                                          undo_p, &undo_cnt, failed_op_p);
+    if (status == OES_STATUS_SUCCESS) {
+        oes_router_uc_route_batch_commit(vr_p, uc_route_op_list_p, undo_p, undo_cnt);
+    } else {
+        oes_router_uc_route_batch_rollback(vr_p, uc_route_op_list_p, undo_p, undo_cnt);
+    }
+
+    pthread_rwlock_unlock(&vr_p->lock);
+    free(undo_p);
+    return status;
+}
+
+/* FIB walk context of a route page, see oes_api_router_uc_route_get */
+struct oes_router_route_walk {
+    const struct oes_router_vr * vr_p;
+    struct oes_ip_prefix       * key_list_p;
+    struct oes_uc_route_data   * data_list_p;
+    unsigned short               cnt;
+    unsigned short               max;
+};
+
+static int
+oes_router_route_walk_v4(void *ctx_p, unsigned int ip, unsigned int depth, unsigned int next_hop)
+{
+    struct oes_router_route_walk *walk_p = ctx_p;
+    struct oes_ip_prefix         *key_p = &walk_p->key_list_p[walk_p->cnt];
+
+    memset(key_p, 0, sizeof(*key_p));
+    key_p->prefix.version = OES_IPV4;
+    key_p->prefix.addr.ipv4.s_addr = htonl(ip);
+    key_p->prefix_len = depth;
+    oes_router_route_read(walk_p->vr_p, next_hop, &walk_p->data_list_p[walk_p->cnt], 0);
+    return ++walk_p->cnt == walk_p->max;
+}
+
+static int
+oes_router_route_walk_v6(void *ctx_p, const unsigned char *addr, unsigned int depth,
+                         unsigned int next_hop)
+{
+    struct oes_router_route_walk *walk_p = ctx_p;
+    struct oes_ip_prefix         *key_p = &walk_p->key_list_p[walk_p->cnt];
+
+    key_p->prefix.version = OES_IPV6;
+    memcpy(key_p->prefix.addr.ipv6.s6_addr, addr, sizeof(key_p->prefix.addr.ipv6.s6_addr));
+    key_p->prefix_len = depth;
+    oes_router_route_read(walk_p->vr_p, next_hop, &walk_p->data_list_p[walk_p->cnt], 0);
+    return ++walk_p->cnt == walk_p->max;
+}
+
+/*
+ * Fills a page of routes in (version, address, length) order, from the
+ * first route or from the one after key_p. The FIBs resume the walk
+ * with a search, so paging through the table costs the size of the
+ * pages, and next hops go straight to the arrays of the caller.
+ */
+static void
+oes_router_route_walk(struct oes_router_route_walk *walk_p,
+                      const struct oes_ip_prefix *key_p)
+{
+    static const unsigned char zero[16];
+    const struct oes_router_vr *vr_p = walk_p->vr_p;
+    struct oes_ip_prefix        from;
+
+    if (key_p == NULL) {
+        memset(&from, 0, sizeof(from));
+        from.prefix.version = OES_IPV4;
+    } else {
+        /* the key is overwritten by the first route */
+        from = *key_p;
+        from.prefix_len++;
+    }
+    if ((from.prefix.version == OES_IPV4) && (vr_p->fib4 != NULL)) {
+        oes_lpm4_walk_from(vr_p->fib4, ntohl(from.prefix.addr.ipv4.s_addr), from.prefix_len,
+                           oes_router_route_walk_v4, walk_p);
+    }
+    if ((walk_p->cnt == walk_p->max) || (vr_p->fib6 == NULL)) {
+        return;
+    }
+    if (from.prefix.version == OES_IPV4) {
+        oes_lpm6_walk_from(vr_p->fib6, zero, 0, oes_router_route_walk_v6, walk_p);
+    } else {
+        oes_lpm6_walk_from(vr_p->fib6, from.prefix.addr.ipv6.s6_addr, from.prefix_len,
+                           oes_router_route_walk_v6, walk_p);
+    }
+}
+
+/**
+ * This function gets unicast route entires from the SDK The
+ * function can receive three types of input:
+ *     1) get information for specific  unicast route,user
+ *      should insert the certain unicast route as the first
+ *      uc_route_key element in the uc_route_key array ,
+ *      uc_route_cnt should be equal to 1,
+ *      access_cmd should be OES_ACCESS_CMD_GET
+ *
+ *   - 2) get a list of first n unicast routes ,user
+ *      should provide an empty uc_route_key  array uc_route_cnt
+ *      should be equal to n,access_cmd should be
+ *      OES_ACCESS_CMD_GET_FIRST
+ *
+ *   - 3) get a list of n  unicast routes which comes after
+ *      certain unicast route (it does not have to exist) user
+ *      should insert the certain unicast route as the first
+ *      uc_route_key element in the uc_route_key array ,
+ *      uc_route_cnt should be equal to n,
+ *      access_cmd should be OES_ACCESS_CMD_GET_NEXT
+ *
+ *  OES_ACCESS_CMD_GET_ACTIVITY gets a specific route as GET does
+ *  and clears the activity it returns.
+ *
+ *  Routes are ordered by IP version (IPv4 first), then by network
+ *  address, then by prefix length. A page costs its size whatever
+ *  the size of the table. The next_hop_list of each data element,
+ *  if not NULL, receives up to next_hop_cnt next hops, and
+ *  next_hop_cnt returns the number of next hops of the route.
+ *  uc_route_cnt returns the number of routes filled.
+ *
+ * @param[in] access_cmd - GET/GET NEXT/GET FIRST/GET ACTIVITY.
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in,out] uc_route_key_list_p  - IP network
+ *       address+prefix len array
+ * @param[out] uc_route_data_list_p - routing table data
+ *       including action(tarp,drop,forward),next-hop list array
+ * @param[in,out] uc_route_cnt_p - array size
+ * @param[in,out] router_uc_route_vs_ext- vendor specific
+ *       extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if GET finds no such route.
+ * @return OES_STATUS_ERROR general error.
+ */
+oes_status_e
+oes_api_router_uc_route_get(const enum oes_access_cmd access_cmd,
+                            const unsigned int vrid,
+                            struct oes_ip_prefix *uc_route_key_list_p,
+                            struct oes_uc_route_data *uc_route_data_list_p,
+                            unsigned short *uc_route_cnt_p,
+                            void *router_uc_route_vs_ext)
+{
+    struct oes_router_route_walk walk;
+    struct oes_router_vr        *vr_p;
+    oes_status_e                 status = OES_STATUS_SUCCESS;
+    unsigned int                 idx;
+
+    if ((uc_route_key_list_p == NULL) || (uc_route_data_list_p == NULL) ||
+        (uc_route_cnt_p == NULL) || (*uc_route_cnt_p == 0)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    if ((access_cmd != OES_ACCESS_CMD_GET_FIRST) && !oes_router_prefix_valid(uc_route_key_list_p)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_mutex_lock(&oes_router_db_lock);
+    vr_p = oes_router_vr_get(vrid);
+    if (vr_p == NULL) {
+        pthread_mutex_unlock(&oes_router_db_lock);
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_rwlock_rdlock(&vr_p->lock);
+    pthread_mutex_unlock(&oes_router_db_lock);
+
+    switch (access_cmd) {
+    case OES_ACCESS_CMD_GET:
+    case OES_ACCESS_CMD_GET_ACTIVITY:
+        status = oes_router_fib_rule_get(vr_p, uc_route_key_list_p, NULL, &idx);
+        if (status == OES_STATUS_SUCCESS) {
+            oes_router_route_read(vr_p, idx, uc_route_data_list_p,
+                                  access_cmd == OES_ACCESS_CMD_GET_ACTIVITY);
+            *uc_route_cnt_p = 1;
+        }
+        break;
+
+    case OES_ACCESS_CMD_GET_FIRST:
+    case OES_ACCESS_CMD_GET_NEXT:
+        walk.vr_p = vr_p;
+        walk.key_list_p = uc_route_key_list_p;
+        walk.data_list_p = uc_route_data_list_p;
+        walk.cnt = 0;
+        walk.max = *uc_route_cnt_p;
+        oes_router_route_walk(&walk, (access_cmd == OES_ACCESS_CMD_GET_NEXT) ?
+                              uc_route_key_list_p : NULL);
+        *uc_route_cnt_p = walk.cnt;
+        break;
+
+    default:
+        status = OES_STATUS_CMD_UNSUPPORTED;
+        break;
+    }
+
+    pthread_rwlock_unlock(&vr_p->lock);
+    return status;
+}
+
+/* FIB walk context of a route activity harvest */
+struct oes_router_harvest {
+    const unsigned long long * snapshot_p;
+    int                        active;
+    struct oes_ip_prefix     * key_list_p;
+    unsigned int               cnt;
+};
+
+static int
+oes_router_harvest_match(const struct oes_router_harvest *harvest_p, unsigned int idx)
+{
+    return (int)((harvest_p->snapshot_p[idx / 64] >> (idx % 64)) & 1) == harvest_p->active;
+}
+
+static void
+oes_router_harvest_v4(void *ctx_p, unsigned int ip, unsigned int depth, unsigned int next_hop)
+{
+    struct oes_router_harvest *harvest_p = ctx_p;
+    struct oes_ip_prefix      *key_p;
+
+    if (oes_router_harvest_match(harvest_p, next_hop)) {
+        key_p = &harvest_p->key_list_p[harvest_p->cnt++];
+        memset(key_p, 0, sizeof(*key_p));
+        key_p->prefix.version = OES_IPV4;
+        key_p->prefix.addr.ipv4.s_addr = htonl(ip);
+        key_p->prefix_len = depth;
+    }
+}
+
+static void
+oes_router_harvest_v6(void *ctx_p, const unsigned char *addr, unsigned int depth, unsigned int next_hop)
+{
+    struct oes_router_harvest *harvest_p = ctx_p;
+    struct oes_ip_prefix      *key_p;
+
+    if (oes_router_harvest_match(harvest_p, next_hop)) {
+        key_p = &harvest_p->key_list_p[harvest_p->cnt++];
+        key_p->prefix.version = OES_IPV6;
+        memcpy(key_p->prefix.addr.ipv6.s6_addr, addr, sizeof(key_p->prefix.addr.ipv6.s6_addr));
+        key_p->prefix_len = depth;
+    }
+}
+
+/**
+ *  This function harvests the activity of every unicast route of a
+ *  virtual router in one pass. It returns the routes that were hit
+ *  by oes_api_router_uc_route_lookup since the previous harvest
+ *  (active = 1), or the ones that were not (active = 0), and
+ *  clears the activity of all routes.
+ *
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] active - 1 for the active set, 0 for the inactive set
+ * @param[out] uc_route_key_list_p - IP network address+prefix len
+ *       array
+ * @param[in,out] uc_route_cnt_p - array size, returns the number
+ *       of routes in the set
+ * @param[in,out] router_uc_route_vs_ext- vendor specific
+ *       extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_PARAM_EXCEEDS_RANGE if the set does not fit
+ *         the array, uc_route_cnt_p returns its size and no
+ *         activity is cleared.
+ * @return OES_STATUS_NO_MEMORY if out of memory.
+ */
+oes_status_e
+oes_api_router_uc_route_activity_harvest(const unsigned int vrid,
+                                         const int active,
+                                         struct oes_ip_prefix *uc_route_key_list_p,
+                                         unsigned int *uc_route_cnt_p,
+                                         void *router_uc_route_vs_ext)
+{
+    struct oes_router_harvest harvest;
+    struct oes_router_vr     *vr_p;
+    unsigned long long       *snapshot_p;
+    oes_status_e              status = OES_STATUS_SUCCESS;
+    unsigned int              size, set_cnt;
+
+    if ((uc_route_key_list_p == NULL) || (uc_route_cnt_p == NULL)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_mutex_lock(&oes_router_db_lock);
+    vr_p = oes_router_vr_get(vrid);
+    if (vr_p == NULL) {
+        pthread_mutex_unlock(&oes_router_db_lock);
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_rwlock_rdlock(&vr_p->lock);
+    pthread_mutex_unlock(&oes_router_db_lock);
+
+    size = vr_p->routes_size;
+    snapshot_p = malloc((OES_ACTIVITY_WORDS(size) + 1) * sizeof(*snapshot_p));
+    if (snapshot_p == NULL) {
+        pthread_rwlock_unlock(&vr_p->lock);
+        return OES_STATUS_NO_MEMORY;
+    }
+    set_cnt = oes_activity_harvest(vr_p->route_activity, snapshot_p, size);
+    if (!active) {
+        set_cnt = vr_p->route_cnt - set_cnt;
+    }
+    if (set_cnt > *uc_route_cnt_p) {
+        oes_activity_restore(vr_p->route_activity, snapshot_p, size);
+        status = OES_STATUS_PARAM_EXCEEDS_RANGE;
+    } else {
+        /* route records do not keep their prefix, the FIBs map it back */
+        harvest.snapshot_p = snapshot_p;
+        harvest.active = !!active;
+        harvest.key_list_p = uc_route_key_list_p;
+        harvest.cnt = 0;
+        if (vr_p->fib4 != NULL) {
+            oes_lpm4_walk(vr_p->fib4, oes_router_harvest_v4, &harvest);
+        }
+        if (vr_p->fib6 != NULL) {
+            oes_lpm6_walk(vr_p->fib6, oes_router_harvest_v6, &harvest);
+        }
+        set_cnt = harvest.cnt;
+    }
+
+    pthread_rwlock_unlock(&vr_p->lock);
+    free(snapshot_p);
+    *uc_route_cnt_p = set_cnt;
+    return status;
+}
+
+/**
+ *  This function runs the software forwarding lookup for one
+ *  destination: longest prefix match, effective route action,
+ *  ECMP member for the flow and its neighbour. It marks the route
+ *  and the neighbour active. A FORWARD route reports the action of
+ *  the neighbour, or TRAP if the member has no neighbour yet.
+ *
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] dst_ip_p - destination address
+ * @param[in] flow_hash - hash of the flow fields, picks the ECMP
+ *       member
+ * @param[out] lookup_data_p - forwarding decision
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if no route matches.
+ */
+oes_status_e
+oes_api_router_uc_route_lookup(const unsigned int vrid,
+                               const struct oes_ip_addr *dst_ip_p,
+                               const unsigned int flow_hash,
+                               struct oes_uc_route_lookup_data *lookup_data_p)
+{
+    const struct oes_router_route *route_p;
+    const struct oes_neigh_entry  *entry_p;
+    const struct oes_nhg          *nhg_p;
+    struct oes_router_vr          *vr_p;
+    unsigned int                   idx;
+    int                            found;
+
+    if ((dst_ip_p == NULL) || (lookup_data_p == NULL) ||
+        ((dst_ip_p->version != OES_IPV4) && (dst_ip_p->version != OES_IPV6))) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_mutex_lock(&oes_router_db_lock);
+    vr_p = oes_router_vr_get(vrid);
+    if (vr_p == NULL) {
+        pthread_mutex_unlock(&oes_router_db_lock);
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_rwlock_rdlock(&vr_p->lock);
+    pthread_mutex_unlock(&oes_router_db_lock);
+
+    if (dst_ip_p->version == OES_IPV4) {
+        found = (vr_p->fib4 != NULL) &&
+                oes_lpm4_lookup(vr_p->fib4, ntohl(dst_ip_p->addr.ipv4.s_addr), &idx);
+    } else {
+        found = (vr_p->fib6 != NULL) &&
+                oes_lpm6_lookup(vr_p->fib6, dst_ip_p->addr.ipv6.s6_addr, &idx);
+    }
+    if (!found) {
+        pthread_rwlock_unlock(&vr_p->lock);
+        return OES_STATUS_ENTRY_NOT_FOUND;
+    }
+
+    route_p = oes_router_route(vr_p, idx);
+    oes_activity_mark(vr_p->route_activity, idx);
+    memset(lookup_data_p, 0, sizeof(*lookup_data_p));
+    lookup_data_p->action = oes_router_route_action(vr_p, route_p);
+    lookup_data_p->rif = OES_ROUTER_RIF_INVALID;
+    nhg_p = oes_nhg_entry(&vr_p->nhgs, route_p->nhg_id);
+    if (nhg_p != NULL) {
+        lookup_data_p->next_hop = nhg_p->members[oes_nhg_member(nhg_p, flow_hash)];
+    }
+    if (lookup_data_p->action == OES_ROUTER_ACTION_FORWARD) {
+        idx = oes_neigh_find(&vr_p->neighs, &lookup_data_p->next_hop);
+        if (idx == OES_NEIGH_NONE) {
+            /* the group resolves through other members, this one still needs ARP/ND */
+            lookup_data_p->action = OES_ROUTER_ACTION_TRAP;
+        } else {
+            entry_p = &vr_p->neighs.entries[idx];
+            oes_activity_mark(vr_p->neighs.activity, idx);
+            lookup_data_p->action = entry_p->action;
+            lookup_data_p->rif = entry_p->rif;
+            lookup_data_p->mac_addr = entry_p->mac;
+        }
+    }
+
+    pthread_rwlock_unlock(&vr_p->lock);
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ *  This function looks up a batch of destinations in the FIB of a
+ *  virtual router: longest prefix match, next hop group and
+ *  effective route action per address, as
+ *  oes_api_router_uc_route_lookup does before picking an ECMP
+ *  member. Routes that match are marked active. The virtual
+ *  router is locked once per call, and the FIB, route and group
+ *  reads of the batch are prefetched ahead of their use, so a
+ *  batch costs much less per address than single lookups.
+ *
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] dst_ip_list_p - destination addresses, IPv4 and IPv6
+ *       may be mixed
+ * @param[out] lookup_data_list_p - FIB decision per address, found
+ *       is 0 if no route matches
+ * @param[in] cnt - number of addresses
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ */
+oes_status_e
+oes_api_router_uc_route_lookup_batch(const unsigned int vrid,
+                                     const struct oes_ip_addr *dst_ip_list_p,
+                                     struct oes_uc_route_batch_lookup_data *lookup_data_list_p,
+                                     const unsigned int cnt)
+{
+    unsigned int                           ips4[OES_ROUTER_LOOKUP_BATCH];
+    unsigned char                          addrs6[OES_ROUTER_LOOKUP_BATCH][16];
+    unsigned int                           nhs[OES_ROUTER_LOOKUP_BATCH];
+    unsigned char                          pos4[OES_ROUTER_LOOKUP_BATCH];
+    unsigned char                          pos6[OES_ROUTER_LOOKUP_BATCH];
+    unsigned int                           idxs[OES_ROUTER_LOOKUP_BATCH];
+    const struct oes_router_route         *route_p;
+    struct oes_uc_route_batch_lookup_data *data_p;
+    struct oes_router_vr                  *vr_p;
+    unsigned int                           i, j, n, n4, n6;
+
+    if ((cnt != 0) && ((dst_ip_list_p == NULL) || (lookup_data_list_p == NULL))) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    for (i = 0; i < cnt; i++) {
+        if ((dst_ip_list_p[i].version != OES_IPV4) && (dst_ip_list_p[i].version != OES_IPV6)) {
+            return OES_STATUS_PARAM_ERROR;
+        }
+    }
+
+    pthread_mutex_lock(&oes_router_db_lock);
+    vr_p = oes_router_vr_get(vrid);
+    if (vr_p == NULL) {
+        pthread_mutex_unlock(&oes_router_db_lock);
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_rwlock_rdlock(&vr_p->lock);
+    pthread_mutex_unlock(&oes_router_db_lock);
+
+    for (i = 0; i < cnt; i += n) {
+        n = (cnt - i < OES_ROUTER_LOOKUP_BATCH) ? cnt - i : OES_ROUTER_LOOKUP_BATCH;
+
+        /* FIB stage: each engine resolves its addresses in one bulk call */
+        n4 = n6 = 0;
+        for (j = 0; j < n; j++) {
+            idxs[j] = OES_ROUTER_ROUTE_NONE;
+            if (dst_ip_list_p[i + j].version == OES_IPV4) {
+                ips4[n4] = ntohl(dst_ip_list_p[i + j].addr.ipv4.s_addr);
+                pos4[n4++] = j;
+            } else {
+                memcpy(addrs6[n6], dst_ip_list_p[i + j].addr.ipv6.s6_addr, sizeof(addrs6[n6]));
+                pos6[n6++] = j;
+            }
+        }
+        if (n4 && (vr_p->fib4 != NULL)) {
+            oes_lpm4_lookup_bulk(vr_p->fib4, ips4, nhs, n4);
+            for (j = 0; j < n4; j++) {
+                if (nhs[j] != OES_LPM4_NO_NEXT_HOP) {
+                    idxs[pos4[j]] = nhs[j];
+                }
+            }
+        }
+        if (n6 && (vr_p->fib6 != NULL)) {
+            oes_lpm6_lookup_bulk(vr_p->fib6, (const unsigned char (*)[16])addrs6, nhs, n6);
+            for (j = 0; j < n6; j++) {
+                if (nhs[j] != OES_LPM6_NO_NEXT_HOP) {
+                    idxs[pos6[j]] = nhs[j];
+                }
+            }
+        }
+
+        /* route stage: records are read once all of them are on their way */
+        for (j = 0; j < n; j++) {
+            if (idxs[j] != OES_ROUTER_ROUTE_NONE) {
+                __builtin_prefetch(oes_router_route(vr_p, idxs[j]));
+            }
+        }
+        for (j = 0; j < n; j++) {
+            data_p = &lookup_data_list_p[i + j];
+            if (idxs[j] == OES_ROUTER_ROUTE_NONE) {
+                memset(data_p, 0, sizeof(*data_p));
+                continue;
+            }
+            route_p = oes_router_route(vr_p, idxs[j]);
+            data_p->found = 1;
+            data_p->nhg_id = route_p->nhg_id;
+            data_p->action = route_p->action;
+            if ((route_p->action == OES_ROUTER_ACTION_FORWARD) && (route_p->nhg_id != OES_NHG_NONE)) {
+                __builtin_prefetch(oes_nhg_entry(&vr_p->nhgs, route_p->nhg_id));
+            }
+            oes_activity_mark(vr_p->route_activity, idxs[j]);
+        }
+
+        /* group stage: FORWARD needs a resolved member */
+        for (j = 0; j < n; j++) {
+            data_p = &lookup_data_list_p[i + j];
+            if (data_p->found && (data_p->action == OES_ROUTER_ACTION_FORWARD)) {
+                data_p->action = oes_router_route_action(vr_p, oes_router_route(vr_p, idxs[j]));
+            }
+        }
+    }
+
+    pthread_rwlock_unlock(&vr_p->lock);
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ *  This function runs the TTL and MTU checks of the software
+ *  forwarding path on a batch of packets. Forwarded packets
+ *  (FORWARD or MIRROR) with TTL 0 or 1 take the ttl_0_action or
+ *  ttl_1_action of the virtual router, trapped as
+ *  OES_PACKET_L3_TTLERROR unless that action is FORWARD. Forwarded
+ *  packets longer than the MTU of their egress router interface
+ *  are trapped as OES_PACKET_L3_MTUERROR, an MTU of 0 does not
+ *  limit. Forwarded packets to a router interface that does not
+ *  exist are dropped, and those passing the checks have their TTL
+ *  decremented. Other actions are left as they are, and their
+ *  egress router interface is ignored. Packets passing the checks
+ *  take a single branch, and those failing one are classified by
+ *  a table load, so rare errors leave the main path rate as is.
+ *
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in,out] pkt_list_p - packets: forwarding action, TTL,
+ *       IP length and egress router interface in, action, TTL
+ *       and trap out
+ * @param[in] cnt - number of packets
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid,
+ *         such as a forwarded packet with an egress router
+ *         interface out of range. No packet is then changed.
+ */
+oes_status_e
+oes_api_router_l3_check_batch(const unsigned int vrid,
+                              struct oes_router_l3_pkt *pkt_list_p,
+                              const unsigned int cnt)
+{
+    struct oes_l3_checker  checker;
+    struct oes_router_vr  *vr_p;
+    unsigned int           i;
+
+    if ((cnt != 0) && (pkt_list_p == NULL)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    for (i = 0; i < cnt; i++) {
+        if (((unsigned int)pkt_list_p[i].action > OES_ROUTER_ACTION_FORWARD) ||
+            ((pkt_list_p[i].action != OES_ROUTER_ACTION_DROP) &&
+             (pkt_list_p[i].action != OES_ROUTER_ACTION_TRAP) &&
+             (pkt_list_p[i].egress_rif >= OES_RIF_MAX_RIFS))) {
+            return OES_STATUS_PARAM_ERROR;
+        }
+    }
+
+    /* the checker only changes under oes_router_db_lock, a copy lets
+     * the batch run under the rif lock alone */
+    pthread_mutex_lock(&oes_router_db_lock);
+    vr_p = oes_router_vr_get(vrid);
+    if (vr_p == NULL) {
+        pthread_mutex_unlock(&oes_router_db_lock);
+        return OES_STATUS_PARAM_ERROR;
+    }
+    checker = vr_p->l3_checker;
+    pthread_rwlock_rdlock(&oes_router_rif_lock);
+    pthread_mutex_unlock(&oes_router_db_lock);
+
+    oes_l3_check_bulk(&checker, &oes_router_rifs, pkt_list_p, cnt);
+
+    pthread_rwlock_unlock(&oes_router_rif_lock);
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ *  This function moves buckets of resilient ECMP groups toward
+ *  an even share per next hop. At most max_moves buckets move
+ *  per call, taken first from buckets no flow used since the
+ *  previous call, so calling it periodically paces the
+ *  migration of flows to new next hops.
+ *
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] max_moves - bucket move budget of this call
+ * @param[in] force - move buckets even if flows use them
+ * @param[out] moved_cnt_p - number of buckets moved
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ */
+oes_status_e
+oes_api_router_ecmp_rebalance(const unsigned int vrid,
+                              const unsigned int max_moves,
+                              const int force,
+                              unsigned int *moved_cnt_p)
+{
+    struct oes_router_vr *vr_p;
+    unsigned int          id, moved = 0;
+
+    if (moved_cnt_p == NULL) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_mutex_lock(&oes_router_db_lock);
+    vr_p = oes_router_vr_get(vrid);
+    if (vr_p == NULL) {
+        pthread_mutex_unlock(&oes_router_db_lock);
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_rwlock_wrlock(&vr_p->lock);
+    pthread_mutex_unlock(&oes_router_db_lock);
+
+    for (id = 1; (id < vr_p->nhgs.size) && (moved < max_moves); id++) {
+        if (vr_p->nhgs.groups[id].refcnt && vr_p->nhgs.groups[id].res_bucket_cnt) {
+            moved += oes_nhg_res_rebalance(&vr_p->nhgs, id, max_moves - moved, force);
+        }
+    }
+
+    pthread_rwlock_unlock(&vr_p->lock);
+    *moved_cnt_p = moved;
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ *  This function allocates/deallocates a router interface
+ *  counter. Counters exist for rifs 0 .. 4095 and start from
+ *  zero when allocated. They count the traffic reported by
+ *  oes_api_router_interface_cntr_count.
+ *
+ * @param[in] access_cmd - ADD /DELETE .
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] rif - Router Interface ID.
+ * @param[in,out] router_cntr_alloc_vs_ext- vendor specific
+ *       extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR f any input parameter is
+ *         invalid.
+ * @return OES_STATUS_ENTRY_ALREADY_EXISTS if ADD finds the counter
+ *         allocated.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if DELETE finds no counter.
+ * @return OES_STATUS_NO_RESOURCES if no counter is available to
+ *         create.
+ * @return OES_STATUS_ERROR general error.
+ */
+oes_status_e
+oes_api_router_interface_cntr_enable_set(const enum oes_access_cmd access_cmd,
+                                         const unsigned int vrid,
+                                         const unsigned int rif,
+                                         void *router_interface_cntr_vs_ext)
+{
+    struct oes_cntr_block **chunk_pp;
+    struct oes_router_vr   *vr_p;
+    oes_status_e            status = OES_STATUS_SUCCESS;
+
+    if ((access_cmd != OES_ACCESS_CMD_ADD) && (access_cmd != OES_ACCESS_CMD_DELETE)) {
+        return OES_STATUS_CMD_UNSUPPORTED;
+    }
+    if (rif >= OES_CNTR_MAX_RIFS) {
+        return OES_STATUS_NO_RESOURCES;
+    }
+
+    pthread_mutex_lock(&oes_router_db_lock);
+    vr_p = oes_router_vr_get(vrid);
+    if (vr_p == NULL) {
+        pthread_mutex_unlock(&oes_router_db_lock);
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_rwlock_wrlock(&vr_p->lock);
+    pthread_mutex_unlock(&oes_router_db_lock);
+    pthread_rwlock_wrlock(&oes_router_cntr_lock);
+
+    if (access_cmd == OES_ACCESS_CMD_DELETE) {
+        if (!OES_BITMAP_TEST(vr_p->cntr_enabled, rif)) {
+            status = OES_STATUS_ENTRY_NOT_FOUND;
+        } else {
+            __atomic_fetch_and(&vr_p->cntr_enabled[rif / OES_BITMAP_WORD_BITS],
+                               ~(1ULL << (rif % OES_BITMAP_WORD_BITS)), __ATOMIC_RELAXED);
+        }
+        pthread_rwlock_unlock(&oes_router_cntr_lock);
+        pthread_rwlock_unlock(&vr_p->lock);
+        return status;
+    }
+
+    chunk_pp = &vr_p->cntr_bases[rif / OES_CNTR_CHUNK];
+    if (OES_BITMAP_TEST(vr_p->cntr_enabled, rif)) {
+        status = OES_STATUS_ENTRY_ALREADY_EXISTS;
+    } else if ((*chunk_pp == NULL) &&
+               ((*chunk_pp = calloc(OES_CNTR_CHUNK, sizeof(**chunk_pp))) == NULL)) {
+        status = OES_STATUS_NO_MEMORY;
+    } else {
+        /* start from zero, the slabs keep what the rif counted before */
+        oes_cntr_sum(vrid, rif, (*chunk_pp)[rif % OES_CNTR_CHUNK].v);
+        __atomic_fetch_or(&vr_p->cntr_enabled[rif / OES_BITMAP_WORD_BITS],
+                          1ULL << (rif % OES_BITMAP_WORD_BITS), __ATOMIC_RELAXED);
+    }
+
+    pthread_rwlock_unlock(&oes_router_cntr_lock);
+    pthread_rwlock_unlock(&vr_p->lock);
+    return status;
+}
+
+/**
+ * This function reads router interface counter.
+ * READ_CLEAR returns the counts since the previous clear and
+ * restarts them; traffic counted meanwhile is returned by exactly
+ * one read.
+ *
+ * @param[in] access_cmd - READ/READ CLEAR.
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] rif - Router Interface ID.
+ * @param[out]cntr_p - Router Interface counter extension
+ * @param[in,out] router_cntr_alloc_vs_ext- vendor specific
+ *       extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_CMD_UNSUPPORTED if access command isn't supported.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if the rif counter is not
+ *         allocated.
+ * @return OES_STATUS_ERROR general error.
+ */
+oes_status_e
+oes_api_router_interface_cntr_get(const enum oes_access_cmd access_cmd,
+                                  const unsigned int vrid,
+                                  const unsigned int rif,
+                                  struct oes_router_cntr *cntr_p,
+                                  void *router_interface_cntr_vs_ext)
+{
+    unsigned long long    sums[OES_CNTR_FIELDS], *base_p;
+    unsigned long long    values[OES_CNTR_FIELDS];
+    struct oes_router_vr *vr_p;
+    unsigned int          i;
+
+    if ((access_cmd != OES_ACCESS_CMD_READ) && (access_cmd != OES_ACCESS_CMD_READ_CLEAR)) {
+        return OES_STATUS_CMD_UNSUPPORTED;
+    }
+    if ((cntr_p == NULL) || (rif >= OES_CNTR_MAX_RIFS)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_mutex_lock(&oes_router_db_lock);
+    vr_p = oes_router_vr_get(vrid);
+    if (vr_p == NULL) {
+        pthread_mutex_unlock(&oes_router_db_lock);
+        return OES_STATUS_PARAM_ERROR;
+    }
+    /* a clear moves the base, serialize it with other readers; the vr lock is left to lookups */
+    if (access_cmd == OES_ACCESS_CMD_READ_CLEAR) {
+        pthread_rwlock_wrlock(&oes_router_cntr_lock);
+    } else {
+        pthread_rwlock_rdlock(&oes_router_cntr_lock);
+    }
+    pthread_mutex_unlock(&oes_router_db_lock);
+
+    if (!OES_BITMAP_TEST(vr_p->cntr_enabled, rif)) {
+        pthread_rwlock_unlock(&oes_router_cntr_lock);
+        return OES_STATUS_ENTRY_NOT_FOUND;
+    }
+    base_p = vr_p->cntr_bases[rif / OES_CNTR_CHUNK][rif % OES_CNTR_CHUNK].v;
+    oes_cntr_sum(vrid, rif, sums);
+    for (i = 0; i < OES_CNTR_FIELDS; i++) {
+        values[i] = sums[i] - base_p[i];
+    }
+    if (access_cmd == OES_ACCESS_CMD_READ_CLEAR) {
+        memcpy(base_p, sums, sizeof(sums));
+    }
+
+    pthread_rwlock_unlock(&oes_router_cntr_lock);
+    memcpy(cntr_p, values, sizeof(*cntr_p));
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * This function counts traffic of the software forwarding path
+ * on a router interface. It takes no lock and no shared atomic:
+ * each thread counts into its own cache line aligned counter
+ * blocks, summed by oes_api_router_interface_cntr_get. Traffic of
+ * a rif without an enabled counter is not counted.
+ *
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] rif - Router Interface ID.
+ * @param[in] cntr_type - direction, unicast or multicast
+ * @param[in] packets - packets to count
+ * @param[in] bytes - bytes to count
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if the rif counter is not enabled.
+ */
+oes_status_e
+oes_api_router_interface_cntr_count(const unsigned int vrid,
+                                    const unsigned int rif,
+                                    const enum oes_router_cntr_type cntr_type,
+                                    const unsigned int packets,
+                                    const unsigned long long bytes)
+{
+    if ((vrid >= OES_ROUTER_MAX_VRID) || (rif >= OES_CNTR_MAX_RIFS) ||
+        ((cntr_type != OES_ROUTER_CNTR_INGRESS_UNICAST) && (cntr_type != OES_ROUTER_CNTR_INGRESS_MULTICAST) &&
+         (cntr_type != OES_ROUTER_CNTR_EGRESS_UNICAST) && (cntr_type != OES_ROUTER_CNTR_EGRESS_MULTICAST))) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    if (!((__atomic_load_n(&oes_router_vrs[vrid].cntr_enabled[rif / OES_BITMAP_WORD_BITS], __ATOMIC_RELAXED) >>
+           (rif % OES_BITMAP_WORD_BITS)) & 1)) {
+        return OES_STATUS_ENTRY_NOT_FOUND;
+    }
+    oes_cntr_add(vrid, rif, cntr_type, packets, bytes);
+    return OES_STATUS_SUCCESS;
+}
+
+/* Validates and normalizes an API multicast route key. */
+static oes_status_e
+oes_router_mc_key_get(const struct oes_mc_route_key *mc_key_p,
+                      struct oes_mc_key *key_p)
+{
+    if (mc_key_p == NULL) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    return oes_mc_key_set(key_p, mc_key_p->mc_gruop_ip, mc_key_p->sender_ip, mc_key_p->ingress_rif);
+}
+
+/* Sets (add != 0) or clears the bits of a rif list in an egress bitmap. */
+static oes_status_e
+oes_router_mc_rifs_apply(unsigned long long *rifs,
+                         const unsigned int *rif_list_p,
+                         const unsigned short rif_cnt,
+                         int add)
+{
+    unsigned short i;
+
+    if ((rif_cnt != 0) && (rif_list_p == NULL)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    for (i = 0; i < rif_cnt; i++) {
+        if (rif_list_p[i] >= OES_ROUTER_MC_MAX_RIFS) {
+            return OES_STATUS_PARAM_ERROR;
+        }
+    }
+    for (i = 0; i < rif_cnt; i++) {
+        if (add) {
+            OES_BITMAP_SET(rifs, rif_list_p[i]);
+        } else {
+            OES_BITMAP_CLR(rifs, rif_list_p[i]);
+        }
+    }
+    return OES_STATUS_SUCCESS;
+}
+
+/* Lists up to max_cnt rifs of an egress set in ascending order. */
+static void
+oes_router_mc_rifs_list(const struct oes_mc_oifs *oifs_p,
+                        unsigned int *rif_list_p,
+                        unsigned int max_cnt)
+{
+    unsigned long long word;
+    unsigned int       w, cnt = 0;
+
+    for (w = 0; (w < OES_MC_RIF_WORDS) && (cnt < max_cnt); w++) {
+        for (word = oifs_p->rifs[w]; word && (cnt < max_cnt); word &= word - 1) {
+            rif_list_p[cnt++] = w * OES_BITMAP_WORD_BITS + __builtin_ctzll(word);
+        }
+    }
+}
+
+/*
+ * Copies a multicast route out. The key addresses and the rif list are
+ * filled in place if not NULL; rif_cnt gives the rif list size and
+ * returns the number of egress rifs of the route.
+ */
+static void
+oes_router_mc_read(const struct oes_mc_table *mcs_p,
+                   unsigned int idx,
+                   struct oes_mc_route_key *mc_key_p,
+                   struct oes_mc_route_data *data_p)
+{
+    const struct oes_mc_route *route_p = &mcs_p->routes[idx];
+    const struct oes_mc_oifs  *oifs_p = oes_mc_oifs_get(mcs_p, idx);
+
+    if (mc_key_p->mc_gruop_ip != NULL) {
+        *mc_key_p->mc_gruop_ip = route_p->key.group;
+    }
+    if (mc_key_p->sender_ip != NULL) {
+        *mc_key_p->sender_ip = route_p->key.source;
+    }
+    mc_key_p->ingress_rif = route_p->key.ingress_rif;
+    data_p->action = route_p->action;
+    if (data_p->rif_list != NULL) {
+        oes_router_mc_rifs_list(oifs_p, data_p->rif_list, data_p->rif_cnt);
+    }
+    data_p->rif_cnt = oifs_p->cnt;
+}
+
+/**
+ *  This function adds/ deletes a multicast route into/from the
+ *  MC routing table.
+ *  ADD of an existing route and EDIT replace its action and
+ *  egress rif list. Routes with the same egress rifs share one
+ *  egress rif set.
+ *
+ * @param[in] access_cmd - ADD/EDIT/DELETE/DELETE_ALL
+ *              DELETE_ALL command deletes all multicast routes associated
+ *              with vrid.
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] mc_route_key_p - group ip, sender IP, ingress rif
+ *       (in order to configure *.G rule sender IP should be
+ *       0.0.0.0)
+ * @param[in] mc_route_data_p -mc route action , egress rif list
+ * @param[in,out] router_mc_route_vs_ext- vendor specific
+ *       extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_NO_RESOURCES if no routes is available to create.
+ * @return OES_STATUS_ERROR general error.
+ */
+oes_status_e
+oes_api_router_mc_route_set(const enum oes_access_cmd access_cmd,
+                            const unsigned int vrid,
+                            const struct oes_mc_route_key *mc_route_key_p,
+                            const struct oes_mc_route_data *mc_route_data_p,
+                            void *router_mc_route_vs_ext)
+{
+    unsigned long long    rifs[OES_MC_RIF_WORDS];
+    struct oes_router_vr *vr_p;
+    struct oes_mc_key     key;
+    oes_status_e          status = OES_STATUS_SUCCESS;
+    unsigned int          idx;
+    int                   added = 0;
+
+    if (access_cmd != OES_ACCESS_CMD_DELETE_ALL) {
+        status = oes_router_mc_key_get(mc_route_key_p, &key);
+        if (status != OES_STATUS_SUCCESS) {
+            return status;
+        }
+    }
+    if ((access_cmd == OES_ACCESS_CMD_ADD) || (access_cmd == OES_ACCESS_CMD_EDIT)) {
+        if (mc_route_data_p == NULL) {
+            return OES_STATUS_PARAM_ERROR;
+        }
+        memset(rifs, 0, sizeof(rifs));
+        status = oes_router_mc_rifs_apply(rifs, mc_route_data_p->rif_list, mc_route_data_p->rif_cnt, 1);
+        if (status != OES_STATUS_SUCCESS) {
+            return status;
+        }
+    }
+
+    pthread_mutex_lock(&oes_router_db_lock);
+    vr_p = oes_router_vr_get(vrid);
+    if (vr_p == NULL) {
+        pthread_mutex_unlock(&oes_router_db_lock);
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_rwlock_wrlock(&vr_p->lock);
+    pthread_mutex_unlock(&oes_router_db_lock);
+
+    switch (access_cmd) {
+    case OES_ACCESS_CMD_ADD:
+    case OES_ACCESS_CMD_EDIT:
+        idx = oes_mc_find(&vr_p->mcs, &key);
+        if (idx == OES_MC_NONE) {
+            if (access_cmd == OES_ACCESS_CMD_EDIT) {
+                status = OES_STATUS_ENTRY_NOT_FOUND;
+                break;
+            }
+            status = oes_mc_add(&vr_p->mcs, &key, &idx);
+            if (status != OES_STATUS_SUCCESS) {
+                break;
+            }
+            added = 1;
+        }
+        status = oes_mc_oifs_set(&vr_p->mcs, idx, rifs);
+        if (status != OES_STATUS_SUCCESS) {
+            if (added) {
+                oes_mc_delete(&vr_p->mcs, idx);
+            }
+            break;
+        }
+        vr_p->mcs.routes[idx].action = mc_route_data_p->action;
+        break;
+
+    case OES_ACCESS_CMD_DELETE:
+        idx = oes_mc_find(&vr_p->mcs, &key);
+        if (idx == OES_MC_NONE) {
+            status = OES_STATUS_ENTRY_NOT_FOUND;
+            break;
+        }
+        oes_mc_delete(&vr_p->mcs, idx);
+        break;
+
+    case OES_ACCESS_CMD_DELETE_ALL:
+        oes_mc_flush(&vr_p->mcs);
+        break;
+
+    default:
+        status = OES_STATUS_CMD_UNSUPPORTED;
+        break;
+    }
+
+    pthread_rwlock_unlock(&vr_p->lock);
+    return status;
+}
+
+/**
+ *  This function gets a multicast route from the MC routing table.
+ *  function can receive three types of input:
+ *     1) get information for specific multicast route,user
+ *      should insert the certain multicast route as the first
+ *      mc_route_key element in the mc_route_key array ,
+ *      mc_route_cnt should be equal to 1,
+ *      access_cmd should be OES_ACCESS_CMD_GET
+ *
+ *   - 2) get a list of first n multicast routes ,user
+ *      should provide an empty mc_route_key  array mc_route_cnt
+ *      should be equal to n,access_cmd should be
+ *      OES_ACCESS_CMD_GET_FIRST
+ *
+ *   - 3) get a list of n  multicast routes which comes after
+ *      certain multicast route (it does not have to exist) user
+ *      should insert the certain multicast route as the first
+ *      mc_route_key element in the mc_route_key array ,
+ *      mc_route_cnt should be equal to n,
+ *       access_cmd should be OES_ACCESS_CMD_GET_NEXT
+ *
+ *  The mc_gruop_ip and sender_ip of each key element, if not
+ *  NULL, receive the route addresses. The rif_list of each data
+ *  element, if not NULL, receives up to rif_cnt egress rifs, and
+ *  rif_cnt returns the number of egress rifs of the route.
+ *  mc_route_cnt returns the number of routes filled.
+ *
+ * @param[in] access_cmd - GET/GET_NEXT/GET_FIRST
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] mc_route_key_list_p  - array of mc_route_key each
+ *       mc_route_key  element includes group IP, sender IP,
+ *       ingress rif (in order to configure
+ *       *.G rule sender IP should be 0.0.0.0)
+ * @param[out] mc_route_data_list_p  -array of mc_route_data
+ *       each mc_route_data element includes mc route action ,
+ *       egress rif list
+ * @param[in,out] mc_route_cnt_p  - array size
+ * @param[in,out] router_mc_route_vs_ext- vendor specific
+ *       extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERORR if any input parameter is
+ *         invalid.
+ * @return OES_STATUS_NOT_FOUND if mc route is not found
+ * @return OES_STATUS_ERROR general error.
+ */
+oes_status_e
+oes_api_router_mc_route_get(const enum oes_access_cmd access_cmd,
+                            const unsigned int vrid,
+                            struct oes_mc_route_key *mc_route_key_list_p,
+                            struct oes_mc_route_data *mc_route_data_list_p,
+                            unsigned short *mc_route_cnt_p,
+                            void *router_mc_route_vs_ext)
+{
+    struct oes_router_vr *vr_p;
+    struct oes_mc_key     key;
+    oes_status_e          status = OES_STATUS_SUCCESS;
+    unsigned int          idx;
+    unsigned short        cnt = 0;
+
+    if ((mc_route_key_list_p == NULL) || (mc_route_data_list_p == NULL) || (mc_route_cnt_p == NULL) ||
+        (*mc_route_cnt_p == 0)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    if (access_cmd != OES_ACCESS_CMD_GET_FIRST) {
+        status = oes_router_mc_key_get(mc_route_key_list_p, &key);
+        if (status != OES_STATUS_SUCCESS) {
+            return status;
+        }
+    }
+
+    pthread_mutex_lock(&oes_router_db_lock);
+    vr_p = oes_router_vr_get(vrid);
+    if (vr_p == NULL) {
+        pthread_mutex_unlock(&oes_router_db_lock);
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_rwlock_rdlock(&vr_p->lock);
+    pthread_mutex_unlock(&oes_router_db_lock);
+
+    switch (access_cmd) {
+    case OES_ACCESS_CMD_GET:
+        idx = oes_mc_find(&vr_p->mcs, &key);
+        if (idx == OES_MC_NONE) {
+            status = OES_STATUS_ENTRY_NOT_FOUND;
+            break;
+        }
+        oes_router_mc_read(&vr_p->mcs, idx, mc_route_key_list_p, mc_route_data_list_p);
+        cnt = 1;
+        break;
+
+    case OES_ACCESS_CMD_GET_FIRST:
+    case OES_ACCESS_CMD_GET_NEXT:
+        idx = (access_cmd == OES_ACCESS_CMD_GET_FIRST) ?
+              oes_mc_first(&vr_p->mcs) : oes_mc_next(&vr_p->mcs, &key);
+        while ((idx != OES_MC_NONE) && (cnt < *mc_route_cnt_p)) {
+            oes_router_mc_read(&vr_p->mcs, idx, &mc_route_key_list_p[cnt], &mc_route_data_list_p[cnt]);
+            idx = oes_mc_next(&vr_p->mcs, &vr_p->mcs.routes[idx].key);
+            cnt++;
+        }
+        break;
+
+    default:
+        status = OES_STATUS_CMD_UNSUPPORTED;
+        break;
+    }
+
+    pthread_rwlock_unlock(&vr_p->lock);
+    *mc_route_cnt_p = cnt;
+    return status;
+}
+
+/**
+ *  This function adds/deletes an egress l3 interfaces to/from
+ *  multicast route.
+ *
+ * @param[in] access_cmd - ADD/DELETE
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] mc_route_key_p  -  mc_route_key  element includes
+ *       group IP, sender IP, ingress rif (in order to configure
+ * @param[in] rif_list_p  -array of egress rif
+ * @param[in] rif_cnt  -egress rif array size
+ * @param[in,out] router_mc_egress_rif_vs_ext- vendor specific
+ *       extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_NO_RESOURCES if no routes is available to create.
+ * @return OES_STATUS_ERROR general error.
+ */
+oes_status_e
+oes_api_router_mc_egress_rif_set(const enum oes_access_cmd access_cmd,
+                                 const unsigned int vrid,
+                                 const struct oes_mc_route_key *mc_route_key_p,
+                                 const unsigned int *rif_list_p,
+                                 const unsigned short rif_cnt,
+                                 void *router_mc_egress_rif_vs_ext)
+{
+    unsigned long long    rifs[OES_MC_RIF_WORDS];
+    struct oes_router_vr *vr_p;
+    struct oes_mc_key     key;
+    oes_status_e          status;
+    unsigned int          idx;
+
+    if ((access_cmd != OES_ACCESS_CMD_ADD) && (access_cmd != OES_ACCESS_CMD_DELETE)) {
+        return OES_STATUS_CMD_UNSUPPORTED;
+    }
+    status = oes_router_mc_key_get(mc_route_key_p, &key);
+    if (status != OES_STATUS_SUCCESS) {
+        return status;
+    }
+    memset(rifs, 0, sizeof(rifs));
+    status = oes_router_mc_rifs_apply(rifs, rif_list_p, rif_cnt, 1);
+    if (status != OES_STATUS_SUCCESS) {
+        return status;
+    }
+
+    pthread_mutex_lock(&oes_router_db_lock);
+    vr_p = oes_router_vr_get(vrid);
+    if (vr_p == NULL) {
+        pthread_mutex_unlock(&oes_router_db_lock);
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_rwlock_wrlock(&vr_p->lock);
+    pthread_mutex_unlock(&oes_router_db_lock);
+
+    idx = oes_mc_find(&vr_p->mcs, &key);
+    if (idx == OES_MC_NONE) {
+        status = OES_STATUS_ENTRY_NOT_FOUND;
+    } else {
+        memcpy(rifs, oes_mc_oifs_get(&vr_p->mcs, idx)->rifs, sizeof(rifs));
+        oes_router_mc_rifs_apply(rifs, rif_list_p, rif_cnt, access_cmd == OES_ACCESS_CMD_ADD);
+        status = oes_mc_oifs_set(&vr_p->mcs, idx, rifs);
+    }
+
+    pthread_rwlock_unlock(&vr_p->lock);
+    return status;
+}
+
+/**
+ *  This function get a list of  egress l3 interfaces from
+ *  multicast route. When egress_rif_num is 0 , the API will
+ *  return a counter of the number of egress rifs , and rif_list
+ *  will remain empty.
+ *
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] mc_route_key_p  -  mc_route_key  element includs
+ *       group ip, sender IP, ingress rif (in oredr to configure
+ * @param[out] rif_list_p  -array of egress rif
+ * @param[in,out] rif_cnt_p  -egress rif array size
+ * @param[in,out] router_mc_egress_rif_vs_ext- vendor specific
+ *       extension
+ *
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_CMD_UNSUPPORTED if access command isn't supported.
+ * @return OES_STATUS_PARAM_EXCEEDS_RANGE if the rifs do not fit
+ *         rif_list, rif_cnt_p returns their number.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_NO_RESOURCES if no routes is available to create.
+ * @return OES_STATUS_ERROR general error.
+ */
+oes_status_e
+oes_api_router_mc_egress_rif_get(const unsigned int vrid,
+                                 const struct oes_mc_route_key *mc_route_key_p,
+                                 unsigned int *rif_list_p,
+                                 unsigned short *rif_cnt_p,
+                                 void *router_mc_egress_rif_vs_ext)
+{
+    const struct oes_mc_oifs *oifs_p;
+    struct oes_router_vr     *vr_p;
+    struct oes_mc_key         key;
+    oes_status_e              status;
+    unsigned int              idx;
+
+    if ((rif_cnt_p == NULL) || ((*rif_cnt_p != 0) && (rif_list_p == NULL))) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    status = oes_router_mc_key_get(mc_route_key_p, &key);
+    if (status != OES_STATUS_SUCCESS) {
+        return status;
+    }
+
+    pthread_mutex_lock(&oes_router_db_lock);
+    vr_p = oes_router_vr_get(vrid);
+    if (vr_p == NULL) {
+        pthread_mutex_unlock(&oes_router_db_lock);
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_rwlock_rdlock(&vr_p->lock);
+    pthread_mutex_unlock(&oes_router_db_lock);
+
+    idx = oes_mc_find(&vr_p->mcs, &key);
+    if (idx == OES_MC_NONE) {
+        status = OES_STATUS_ENTRY_NOT_FOUND;
+    } else {
+        oifs_p = oes_mc_oifs_get(&vr_p->mcs, idx);
+        if ((*rif_cnt_p != 0) && (*rif_cnt_p < oifs_p->cnt)) {
+            status = OES_STATUS_PARAM_EXCEEDS_RANGE;
+        } else if (*rif_cnt_p != 0) {
+            oes_router_mc_rifs_list(oifs_p, rif_list_p, oifs_p->cnt);
+        }
+        *rif_cnt_p = oifs_p->cnt;
+    }
+
+    pthread_rwlock_unlock(&vr_p->lock);
+    return status;
+}
+
+/**
+ *  This function looks up the multicast route forwarding a packet
+ *  in the software forwarding path: the (S,G) route of its sender
+ *  if there is one, else the (*,G) route of its group, both with
+ *  the ingress rif the packet came in on.
+ *
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] mc_group_ip_p - packet destination group
+ * @param[in] sender_ip_p - packet source
+ * @param[in] ingress_rif - rif the packet came in on
+ * @param[out] lookup_data_p - route action and egress rif bitmap
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if no route matches.
+ */
+oes_status_e
+oes_api_router_mc_route_lookup(const unsigned int vrid,
+                               const struct oes_ip_addr *mc_group_ip_p,
+                               const struct oes_ip_addr *sender_ip_p,
+                               const unsigned int ingress_rif,
+                               struct oes_mc_route_lookup_data *lookup_data_p)
+{
+    static const struct oes_ip_addr any;
+    const struct oes_mc_route      *route_p;
+    const struct oes_mc_oifs       *oifs_p;
+    struct oes_router_vr           *vr_p;
+    struct oes_mc_key               key;
+    unsigned int                    idx;
+
+    if ((sender_ip_p == NULL) || (lookup_data_p == NULL) ||
+        (oes_mc_key_set(&key, mc_group_ip_p, sender_ip_p, ingress_rif) != OES_STATUS_SUCCESS)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_mutex_lock(&oes_router_db_lock);
+    vr_p = oes_router_vr_get(vrid);
+    if (vr_p == NULL) {
+        pthread_mutex_unlock(&oes_router_db_lock);
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_rwlock_rdlock(&vr_p->lock);
+    pthread_mutex_unlock(&oes_router_db_lock);
+
+    idx = oes_mc_lookup(&vr_p->mcs, &key);
+    if (idx == OES_MC_NONE) {
+        pthread_rwlock_unlock(&vr_p->lock);
+        return OES_STATUS_ENTRY_NOT_FOUND;
+    }
+    route_p = &vr_p->mcs.routes[idx];
+    oifs_p = oes_mc_oifs_get(&vr_p->mcs, idx);
+    lookup_data_p->action = route_p->action;
+    lookup_data_p->star_g = !memcmp(&route_p->key.source.addr, &any.addr, sizeof(any.addr));
+    lookup_data_p->rif_cnt = oifs_p->cnt;
+    memcpy(lookup_data_p->egress_rifs, oifs_p->rifs, sizeof(lookup_data_p->egress_rifs));
+
+    pthread_rwlock_unlock(&vr_p->lock);
+    return OES_STATUS_SUCCESS;
+}
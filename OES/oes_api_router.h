@@ -153,10 +153,95 @@ oes_api_router_get(
                   );
 
 
+/**
+ *  This function adds a virtual router whose unicast routes start
+ *  as a copy of those of a template router. The copy shares the
+ *  FIB and route memory of the template until either router
+ *  changes it, so a clone costs memory in proportion to the
+ *  routes it adds, changes or deletes. Neighbours, multicast
+ *  routes and counters are not copied: next hops of the clone
+ *  resolve against its own neighbours.
+ *  
+ * @param[in] template_vrid - Virtual router ID to copy
+ * @param[out] vrid_p - Virtual router ID of the clone
+ * @param[in] router_attr_p - Router attributes of the clone. 
+ * @param[in,out] router_vs_ext- vendor specific extension 
+ *  
+ * @return OES_STATUS_SUCCESS if operation completes successfully. 
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid. 
+ * @return OES_STATUS_NO_RESOURCES if there are no resources to
+ *         create another router
+ * @return OES_STATUS_NO_MEMORY if out of memory.
+ */
+oes_status_e
+oes_api_router_clone(
+                    const unsigned int   template_vrid,
+                    unsigned int  * vrid_p,
+                    const struct oes_router_attributes * router_attr_p,
+                    void * router_vs_ext
+                    );
+
+/**
+ *  This function saves the unicast routes, next hop groups and
+ *  neighbours of a virtual router to an image file, for a warm
+ *  restart through oes_api_router_fib_snapshot_restore. The
+ *  image is written next to path and renamed over it once
+ *  complete. Lookups go on while it is written.
+ *
+ * @param[in] vrid - Virtual router ID
+ * @param[in] path - Image file
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_NO_MEMORY if out of memory.
+ * @return OES_STATUS_ERROR if the file could not be written.
+ */
+oes_status_e
+oes_api_router_fib_snapshot_save(
+                    const unsigned int   vrid,
+                    const char * path
+                    );
+
+/**
+ *  This function restores the unicast routes, next hop groups
+ *  and neighbours of a virtual router from an image saved by
+ *  oes_api_router_fib_snapshot_save, typically of the same
+ *  vrid before a restart. The router must have no unicast
+ *  routes and no neighbours. The image is mapped and copied
+ *  table by table, with no per route work, and rejected if it
+ *  fails its checksum or was saved by a build with other
+ *  structures. Next hops resolve against the restored
+ *  neighbours; route and bucket activity start cleared. On
+ *  failure the router is left with no unicast routes and no
+ *  neighbours.
+ *
+ * @param[in] vrid - Virtual router ID
+ * @param[in] path - Image file
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_NO_MEMORY if out of memory.
+ * @return OES_STATUS_ERROR if the router is not empty, or the
+ *         image cannot be read or is rejected.
+ */
+oes_status_e
+oes_api_router_fib_snapshot_restore(
+                    const unsigned int   vrid,
+                    const char * path
+                    );
+
+
 /**
  *  This function adds/modifies/deletes/delete_all a router
  *  interface. A router interface is associated with L2
- *  interface.
+ *  interface: a logical port, or a VLAN of a bridge (VLAN IDs
+ *  1 .. 4094), each owned by at most one router interface.
+ *  Router interface IDs are allocated across all virtual
+ *  routers, lowest free first, and are below 4096. ADD enables
+ *  both IP versions. EDIT replaces the attributes, and moves
+ *  the interface to ifc_p unless it is NULL. DELETE_ALL deletes
+ *  every router interface of the virtual router, rif_p and the
+ *  other parameters are ignored.
  * 
  * @param[in] access_cmd - ADD/EDIT/DELETE/DELETE ALL.
  * @param[in] vrid - Virtual Router ID. 
@@ -171,7 +256,10 @@ oes_api_router_get(
  * @return OES_STATUS_SUCCESS if operation completes successfully. 
  * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
  * @return OES_STATUS_ENTRY_NOT_FOUND if router interface was not added.
+ * @return OES_STATUS_ENTRY_ALREADY_EXISTS if another router
+ *         interface owns the L2 interface.
  * @return OES_STATUS_NO_RESOURCES if no interface is available to create. 
+ * @return OES_STATUS_NO_MEMORY if out of memory.
  * @return OES_STATUS_ERROR general error.
  */
 oes_status_e
@@ -249,7 +337,7 @@ oes_api_router_interface_state_set(
  * @return OES_STATUS_ERROR general error.
  */
 oes_status_e
-oes_api_router_interface_state_set(
+oes_api_router_interface_state_get(
                                   const unsigned int   vrid,
                                   const unsigned int   rif,
                                   struct oes_l3_interface_admin_state * admin_state_p,
@@ -259,6 +347,10 @@ oes_api_router_interface_state_set(
 
 /**
  *  This function adds/deletes a MAC address from a router interface.
+ *  The router interface answers to these MACs besides the MAC of
+ *  its attributes. Adding a MAC it has is a no-op; DELETE fails,
+ *  deleting nothing, unless it has every MAC of the list.
+ *  DELETE_ALL ignores the list.
  * 
  * @param[in] access_cmd - ADD/DELETE/DELETE_ALL. 
  * @param[in] vrid - Virtual Router ID. 
@@ -270,6 +362,11 @@ oes_api_router_interface_state_set(
  *  
  * @return OES_STATUS_SUCCESS if operation completes successfully. 
  * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if the router interface was
+ *         not added, or DELETE finds a MAC it does not have.
+ * @return OES_STATUS_NO_RESOURCES if ADD exceeds the MACs of all
+ *         router interfaces.
+ * @return OES_STATUS_NO_MEMORY if out of memory.
  * @return OES_STATUS_ERROR general error.
  */
 oes_status_e
@@ -283,9 +380,11 @@ oes_api_router_interface_mac_set(
                                 );
 
 /**
- *  This function gets MAC address of a router interface.
+ *  This function gets MAC address of a router interface: the
+ *  MACs added by oes_api_router_interface_mac_set. With
+ *  *mac_cnt_p 0 it only returns their number.
  * 
- * @param[in] access_cmd - ADD/DELETE/DELETE_ALL. 
+ * @param[in] access_cmd - GET. 
  * @param[in] vrid - Virtual Router ID. 
  * @param[in] rif - Router Interface ID.
  * @param[out] mac_addr_list_p - MAC addresses array .
@@ -295,6 +394,9 @@ oes_api_router_interface_mac_set(
  *
  * @return OES_STATUS_SUCCESS if operation completes successfully. 
  * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_PARAM_EXCEEDS_RANGE if the array is too small,
+ *         *mac_cnt_p is set to the number of MACs.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if router interface was not added.
  * @return OES_STATUS_ERROR general error.
  */
 oes_status_e
@@ -307,6 +409,31 @@ oes_api_router_interface_mac_get(
                                 void * router_interface_mac_vs_ext
                                 );
 
+/**
+ *  This function resolves the ingress router interface of a
+ *  packet in the software forwarding path: the router interface
+ *  owning the L2 interface the packet came in on, and whether
+ *  its destination MAC is a router MAC of that interface. Both
+ *  are direct lookups, independent of the number of router
+ *  interfaces and MACs.
+ * 
+ * @param[in] ifc_p - L2 interface the packet came in on
+ * @param[in] dst_mac_p - packet destination MAC
+ * @param[out] lookup_data_p - virtual router, router interface,
+ *       router MAC match and admin state
+ *  
+ * @return OES_STATUS_SUCCESS if operation completes successfully. 
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if no router interface owns
+ *         the L2 interface.
+ */
+oes_status_e
+oes_api_router_interface_lookup(
+                               const struct oes_l3_interface * ifc_p,
+                               const struct ether_addr * dst_mac_p,
+                               struct oes_l3_interface_lookup_data * lookup_data_p
+                               );
+
 /**
  *  This function adds/modifies/deletes/delete_all a neighbour
  *  information. The neighbour information associate an IP
@@ -318,6 +445,7 @@ oes_api_router_interface_mac_get(
  *  operation the neighbours associated with the router
  *  interface parameter will be deleted in case it is valid, in
  *  case rif is invalid , all neighbours will be deleted.
+ *  (rif OES_ROUTER_RIF_INVALID or a NULL neigh_data_p).
  * 
  * @param[in] access_cmd - ADD/EDIT/DELETE/DELETE_ALL.
  * @param[in] vrid - Virtual Router ID. 
@@ -366,6 +494,10 @@ oes_api_router_neigh_set(
  *      insert the certain neigh as the first neigh_key element
  *      in the neigh_key array , neigh_cnt should be equal to n,
  *      OES_ACCESS_CMD_GET_NEXT
+ *
+ *  The mac_addr of each data element, if not NULL, receives the
+ *  neighbour MAC. GET_ACTIVITY clears the activity it returns.
+ *  neigh_cnt returns the number of neighbours filled.
  * 
  * @param[in] access_cmd - GET/GET_NEXT/GET_FIRST/GET_ACTIVITY 
  * @param[in] vrid - Virtual Router ID.
@@ -392,16 +524,59 @@ oes_api_router_neigh_get(
                         void * router_neigh_vs_ext
                         );
 
+/**
+ *  This function harvests the activity of every neighbour of a
+ *  virtual router in one pass. It returns the neighbours that were
+ *  hit by oes_api_router_uc_route_lookup since the previous
+ *  harvest (active = 1), or the ones that were not (active = 0),
+ *  and clears the activity of all neighbours. Neighbour aging
+ *  calls it once per interval instead of GET_ACTIVITY per
+ *  neighbour.
+ *
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] active - 1 for the active set, 0 for the inactive set
+ * @param[out] neigh_key_list_p - neigh IP address array
+ * @param[in,out] neigh_cnt_p - array size, returns the number of
+ *       neighbours in the set
+ * @param[in,out] router_neigh_vs_ext- vendor specific extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_PARAM_EXCEEDS_RANGE if the set does not fit
+ *         the array, neigh_cnt_p returns its size and no activity
+ *         is cleared.
+ * @return OES_STATUS_NO_MEMORY if out of memory.
+ */
+oes_status_e
+oes_api_router_neigh_activity_harvest(
+                        const unsigned int   vrid,
+                        const int   active,
+                        struct oes_ip_addr  * neigh_key_list_p,
+                        unsigned int  * neigh_cnt_p,
+                        void * router_neigh_vs_ext
+                        );
+
 /**
  *  This function adds/deletes an unicast route into the routing
  *  table. The route is composed of network address and next hop
  *  array which may contains more than one entry for ECMP. In
  *  case the neigh, entry is not known yet,the route will be
  *  added with action TRAP . Upon neigh entry resolved and
- *  configured, the route can be modified into FORWARD. Calling
- *  with SET cmd will replace all next hop entries associated
- *  with the route. (If the route does not exist, it will be
+ *  configured, the route can be modified into FORWARD. A route
+ *  added with FORWARD while none of its next hops has a
+ *  forwarding neigh entry acts (and reads back) as TRAP, and
+ *  turns to FORWARD by itself once oes_api_router_neigh_set
+ *  resolves one of them, without the route being set again.
+ *  Calling with SET cmd will replace all next hop entries
+ *  associated with the route. (If the route does not exist, it will be
  *  created).
+ *
+ *  On ADD/EDIT, router_uc_route_vs_ext may point to a struct
+ *  oes_uc_route_ecmp_params asking for resilient hashing: flows
+ *  map to a fixed set of buckets and a next hop removed from the
+ *  list only moves the flows of its own buckets. Next hops added
+ *  to the list take over buckets through
+ *  oes_api_router_ecmp_rebalance.
  *  
  * @param[in] access_cmd - ADD/DELETE/DELETE ALL .
  * @param[in] vrid - Virtual Router ID.
@@ -409,7 +584,7 @@ oes_api_router_neigh_get(
  * @param[in] uc_route_data_p - routing table data including 
  *       action(tarp,drop,forward),next-hop list
  * @param[in,out] router_uc_route_vs_ext- vendor specific 
- *       extension
+ *       extension, struct oes_uc_route_ecmp_params * or NULL
  *  
  * @return OES_STATUS_SUCCESS if operation completes successfully. 
  * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
@@ -426,6 +601,40 @@ oes_api_router_uc_route_set(
                            void * router_uc_route_vs_ext
                            );
 
+/**
+ *  This function applies a batch of unicast route operations
+ *  atomically: lookups of the virtual router see the FIB either
+ *  before or after the whole batch, and a failing operation leaves
+ *  the FIB as it was. Operations apply in order, ADD creates or
+ *  replaces a route, EDIT replaces an existing one and DELETE
+ *  removes one. A batch costs one lock round trip, so loading a
+ *  full table takes a few large batches instead of a call per
+ *  prefix.
+ *
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] uc_route_op_list_p - operations
+ * @param[in] uc_route_op_cnt - number of operations
+ * @param[out] failed_op_p - index of the operation that failed,
+ *       may be NULL
+ * @param[in,out] router_uc_route_vs_ext- vendor specific
+ *       extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if an EDIT or DELETE targets
+ *         a missing route.
+ * @return OES_STATUS_NO_RESOURCES if no routes is available to create.
+ * @return OES_STATUS_NO_MEMORY if out of memory.
+ */
+oes_status_e
+oes_api_router_uc_route_batch_set(
+                           const unsigned int   vrid,
+                           const struct oes_uc_route_op * uc_route_op_list_p,
+                           const unsigned int   uc_route_op_cnt,
+                           unsigned int * failed_op_p,
+                           void * router_uc_route_vs_ext
+                           );
+
 /**
  * This function gets unicast route entires from the SDK The 
  * function can receive three types of input: 
@@ -446,8 +655,18 @@ oes_api_router_uc_route_set(
  *      uc_route_key element in the uc_route_key array ,
  *      uc_route_cnt should be equal to n,
  *      access_cmd should be OES_ACCESS_CMD_GET_NEXT
+ *
+ *  OES_ACCESS_CMD_GET_ACTIVITY gets a specific route as GET does
+ *  and clears the activity it returns.
+ *
+ *  Routes are ordered by IP version (IPv4 first), then by network
+ *  address, then by prefix length. A page costs its size whatever
+ *  the size of the table. The next_hop_list of each data element,
+ *  if not NULL, receives up to next_hop_cnt next hops, and
+ *  next_hop_cnt returns the number of next hops of the route.
+ *  uc_route_cnt returns the number of routes filled.
  *  
- * @param[in] access_cmd - GET/GET NEXT/GET FIRST.
+ * @param[in] access_cmd - GET/GET NEXT/GET FIRST/GET ACTIVITY.
  * @param[in] vrid - Virtual Router ID.
  * @param[in,out] uc_route_key_list_p  - IP network 
  *       address+prefix len array
@@ -459,6 +678,7 @@ oes_api_router_uc_route_set(
  *  
  * @return OES_STATUS_SUCCESS if operation completes successfully. 
  * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if GET finds no such route.
  * @return OES_STATUS_ERROR general error.
  */
 oes_status_e 
@@ -471,10 +691,154 @@ oes_api_router_uc_route_get(
                            void * router_uc_route_vs_ext
                            );
 
+/**
+ *  This function harvests the activity of every unicast route of a
+ *  virtual router in one pass. It returns the routes that were hit
+ *  by oes_api_router_uc_route_lookup since the previous harvest
+ *  (active = 1), or the ones that were not (active = 0), and
+ *  clears the activity of all routes.
+ *
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] active - 1 for the active set, 0 for the inactive set
+ * @param[out] uc_route_key_list_p - IP network address+prefix len
+ *       array
+ * @param[in,out] uc_route_cnt_p - array size, returns the number
+ *       of routes in the set
+ * @param[in,out] router_uc_route_vs_ext- vendor specific
+ *       extension
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_PARAM_EXCEEDS_RANGE if the set does not fit
+ *         the array, uc_route_cnt_p returns its size and no
+ *         activity is cleared.
+ * @return OES_STATUS_NO_MEMORY if out of memory.
+ */
+oes_status_e
+oes_api_router_uc_route_activity_harvest(
+                           const unsigned int   vrid,
+                           const int   active,
+                           struct oes_ip_prefix * uc_route_key_list_p,
+                           unsigned int * uc_route_cnt_p,
+                           void * router_uc_route_vs_ext
+                           );
+
+/**
+ *  This function runs the software forwarding lookup for one
+ *  destination: longest prefix match, effective route action,
+ *  ECMP member for the flow and its neighbour. It marks the route
+ *  and the neighbour active. A FORWARD route reports the action of
+ *  the neighbour, or TRAP if the member has no neighbour yet.
+ *
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] dst_ip_p - destination address
+ * @param[in] flow_hash - hash of the flow fields, picks the ECMP
+ *       member
+ * @param[out] lookup_data_p - forwarding decision
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if no route matches.
+ */
+oes_status_e
+oes_api_router_uc_route_lookup(
+                           const unsigned int   vrid,
+                           const struct oes_ip_addr * dst_ip_p,
+                           const unsigned int   flow_hash,
+                           struct oes_uc_route_lookup_data * lookup_data_p
+                           );
+
+/**
+ *  This function looks up a batch of destinations in the FIB of a
+ *  virtual router: longest prefix match, next hop group and
+ *  effective route action per address, as
+ *  oes_api_router_uc_route_lookup does before picking an ECMP
+ *  member. Routes that match are marked active. The virtual
+ *  router is locked once per call, and the FIB, route and group
+ *  reads of the batch are prefetched ahead of their use, so a
+ *  batch costs much less per address than single lookups.
+ *
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] dst_ip_list_p - destination addresses, IPv4 and IPv6
+ *       may be mixed
+ * @param[out] lookup_data_list_p - FIB decision per address, found
+ *       is 0 if no route matches
+ * @param[in] cnt - number of addresses
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ */
+oes_status_e
+oes_api_router_uc_route_lookup_batch(
+                           const unsigned int   vrid,
+                           const struct oes_ip_addr * dst_ip_list_p,
+                           struct oes_uc_route_batch_lookup_data * lookup_data_list_p,
+                           const unsigned int   cnt
+                           );
+
+
+/**
+ *  This function runs the TTL and MTU checks of the software
+ *  forwarding path on a batch of packets. Forwarded packets
+ *  (FORWARD or MIRROR) with TTL 0 or 1 take the ttl_0_action or
+ *  ttl_1_action of the virtual router, trapped as
+ *  OES_PACKET_L3_TTLERROR unless that action is FORWARD. Forwarded
+ *  packets longer than the MTU of their egress router interface
+ *  are trapped as OES_PACKET_L3_MTUERROR, an MTU of 0 does not
+ *  limit. Forwarded packets to a router interface that does not
+ *  exist are dropped, and those passing the checks have their TTL
+ *  decremented. Other actions are left as they are, and their
+ *  egress router interface is ignored. Packets passing the checks
+ *  take a single branch, and those failing one are classified by
+ *  a table load, so rare errors leave the main path rate as is.
+ *
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in,out] pkt_list_p - packets: forwarding action, TTL,
+ *       IP length and egress router interface in, action, TTL
+ *       and trap out
+ * @param[in] cnt - number of packets
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid,
+ *         such as a forwarded packet with an egress router
+ *         interface out of range. No packet is then changed.
+ */
+oes_status_e
+oes_api_router_l3_check_batch(
+                           const unsigned int   vrid,
+                           struct oes_router_l3_pkt * pkt_list_p,
+                           const unsigned int   cnt
+                           );
+
+
+/**
+ *  This function moves buckets of resilient ECMP groups toward
+ *  an even share per next hop. At most max_moves buckets move
+ *  per call, taken first from buckets no flow used since the
+ *  previous call, so calling it periodically paces the
+ *  migration of flows to new next hops.
+ *
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] max_moves - bucket move budget of this call
+ * @param[in] force - move buckets even if flows use them
+ * @param[out] moved_cnt_p - number of buckets moved
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ */
+oes_status_e
+oes_api_router_ecmp_rebalance(
+                           const unsigned int   vrid,
+                           const unsigned int   max_moves,
+                           const int   force,
+                           unsigned int * moved_cnt_p
+                           );
 
 /**
  *  This function allocates/deallocates a router interface
- *  counter.
+ *  counter. Counters exist for rifs 0 .. 4095 and start from
+ *  zero when allocated. They count the traffic reported by
+ *  oes_api_router_interface_cntr_count.
  *
  * @param[in] access_cmd - ADD /DELETE . 
  * @param[in] vrid - Virtual Router ID. 
@@ -485,6 +849,9 @@ oes_api_router_uc_route_get(
  * @return OES_STATUS_SUCCESS if operation completes successfully
  * @return OES_STATUS_PARAM_ERROR f any input parameter is 
  *         invalid.
+ * @return OES_STATUS_ENTRY_ALREADY_EXISTS if ADD finds the counter
+ *         allocated.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if DELETE finds no counter.
  * @return OES_STATUS_NO_RESOURCES if no counter is available to 
  *         create.
  * @return OES_STATUS_ERROR general error.
@@ -497,7 +864,10 @@ oes_api_router_interface_cntr_enable_set(
                                         void * router_interface_cntr_vs_ext
                                         );
 /**
- * This function reads router interface counter 
+ * This function reads router interface counter.
+ * READ_CLEAR returns the counts since the previous clear and
+ * restarts them; traffic counted meanwhile is returned by exactly
+ * one read.
  *
  * @param[in] access_cmd - READ/READ CLEAR. 
  * @param[in] vrid - Virtual Router ID. 
@@ -508,6 +878,9 @@ oes_api_router_interface_cntr_enable_set(
  *
  * @return OES_STATUS_SUCCESS if operation completes successfully. 
  * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid. 
+ * @return OES_STATUS_CMD_UNSUPPORTED if access command isn't supported.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if the rif counter is not
+ *         allocated.
  * @return OES_STATUS_ERROR general error.
  */
 
@@ -520,12 +893,41 @@ oes_api_router_interface_cntr_get(
                                  void * router_interface_cntr_vs_ext
                                  );
 
+/**
+ * This function counts traffic of the software forwarding path
+ * on a router interface. It takes no lock and no shared atomic:
+ * each thread counts into its own cache line aligned counter
+ * blocks, summed by oes_api_router_interface_cntr_get. Traffic of
+ * a rif without an enabled counter is not counted.
+ *
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] rif - Router Interface ID.
+ * @param[in] cntr_type - direction, unicast or multicast
+ * @param[in] packets - packets to count
+ * @param[in] bytes - bytes to count
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if the rif counter is not enabled.
+ */
+oes_status_e
+oes_api_router_interface_cntr_count(
+                                 const unsigned int vrid,
+                                 const unsigned int rif,
+                                 const enum oes_router_cntr_type cntr_type,
+                                 const unsigned int packets,
+                                 const unsigned long long bytes
+                                 );
+
 
 /**
 *  This function adds/ deletes a multicast route into/from the
 *  MC routing table.
+*  ADD of an existing route and EDIT replace its action and
+*  egress rif list. Routes with the same egress rifs share one
+*  egress rif set.
 * 
-* @param[in] access_cmd - ADD/DELETE/DELETE_ALL
+* @param[in] access_cmd - ADD/EDIT/DELETE/DELETE_ALL
 *       	   DELETE_ALL command deletes all multicast routes associated
 *       	   with vrid.
 * @param[in] vrid - Virtual Router ID.
@@ -573,7 +975,13 @@ oes_api_router_mc_route_set(
  *      mc_route_cnt should be equal to n,
 *       access_cmd should be OES_ACCESS_CMD_GET_NEXT
 *  
-* @param[in] access_cmd - GET/GET_NEXT/GET_FIRST/GET_ACTIVITY 
+*  The mc_gruop_ip and sender_ip of each key element, if not
+*  NULL, receive the route addresses. The rif_list of each data
+*  element, if not NULL, receives up to rif_cnt egress rifs, and
+*  rif_cnt returns the number of egress rifs of the route.
+*  mc_route_cnt returns the number of routes filled.
+*
+* @param[in] access_cmd - GET/GET_NEXT/GET_FIRST 
 * @param[in] vrid - Virtual Router ID. 
 * @param[in] mc_route_key_list_p  - array of mc_route_key each 
 *       mc_route_key  element includes group IP, sender IP,
@@ -598,7 +1006,7 @@ oes_api_router_mc_route_get(
                            const enum oes_access_cmd access_cmd,
                            const unsigned int   vrid,
                            struct oes_mc_route_key * mc_route_key_list_p,
-                           struct oes_mc_rout e_data * mc_route_data_list_p,
+                           struct oes_mc_route_data * mc_route_data_list_p,
                            unsigned short  * mc_route_cnt_p,
                            void * router_mc_route_vs_ext
                            );
@@ -650,7 +1058,8 @@ oes_api_router_mc_egress_rif_set(
 *
 * @return OES_STATUS_SUCCESS if operation completes successfully.
 * @return OES_STATUS_CMD_UNSUPPORTED if access command isn't supported.
-* @return OES_STATUS_PARAM_EXCEEDS_RANGE if parameters exceed range.
+* @return OES_STATUS_PARAM_EXCEEDS_RANGE if the rifs do not fit
+*         rif_list, rif_cnt_p returns their number.
 * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
 * @return OES_STATUS_NO_RESOURCES if no routes is available to create.
 * @return OES_STATUS_ERROR general error.
@@ -665,5 +1074,30 @@ oes_api_router_mc_egress_rif_get(
                                 void * router_mc_egress_rif_vs_ext
                                 );
 
+/**
+ *  This function looks up the multicast route forwarding a packet
+ *  in the software forwarding path: the (S,G) route of its sender
+ *  if there is one, else the (*,G) route of its group, both with
+ *  the ingress rif the packet came in on.
+ *
+ * @param[in] vrid - Virtual Router ID.
+ * @param[in] mc_group_ip_p - packet destination group
+ * @param[in] sender_ip_p - packet source
+ * @param[in] ingress_rif - rif the packet came in on
+ * @param[out] lookup_data_p - route action and egress rif bitmap
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully.
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid.
+ * @return OES_STATUS_ENTRY_NOT_FOUND if no route matches.
+ */
+oes_status_e
+oes_api_router_mc_route_lookup(
+                                const unsigned int  vrid,
+                                const struct oes_ip_addr * mc_group_ip_p,
+                                const struct oes_ip_addr * sender_ip_p,
+                                const unsigned int  ingress_rif,
+                                struct oes_mc_route_lookup_data * lookup_data_p
+                                );
+
 
 #endif /* __OES_API_ROUTER_H__ */
@@ -0,0 +1,627 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_api_stp.h"
+#include "oes_api_vlan.h"
+#include "oes_vlan_member.h"
+
+#define OES_STP_MAX_BRIDGES           4096
+#define OES_STP_CIST                  0
+
+/*
+ * Spanning tree state of a bridge. Instance 0 is the CIST, which holds
+ * the VLANs not mapped to an MSTI. A port state is two bits, learning
+ * and forwarding, kept as port bitmaps per instance so the ports a VLAN
+ * may forward to are one row. Ports forward until told otherwise, as
+ * with spanning tree off.
+ */
+struct oes_stp_bridge {
+    enum oes_stp_mode  mode;
+    unsigned long long msti_in_use[OES_BITMAP_WORDS(OES_STP_MAX_MSTI + 1)];  /**< the CIST is always in use */
+    unsigned char      vid_msti[OES_MAX_VLANS];                              /**< instance of each VLAN */
+    unsigned long long msti_vlans[OES_STP_MAX_MSTI + 1][OES_VLAN_VID_WORDS];  /**< VLANs of each instance */
+    unsigned long long learning[OES_STP_MAX_MSTI + 1][OES_VLAN_PORT_WORDS];   /**< ports learning or forwarding */
+    unsigned long long forwarding[OES_STP_MAX_MSTI + 1][OES_VLAN_PORT_WORDS]; /**< ports forwarding */
+};
+
+static pthread_rwlock_t       oes_stp_lock = PTHREAD_RWLOCK_INITIALIZER;
+static struct oes_stp_bridge *oes_stp_bridges[OES_STP_MAX_BRIDGES];
+
+static void
+oes_stp_msti_ports_reset(struct oes_stp_bridge *br_p, unsigned int inst_id)
+{
+    memset(br_p->learning[inst_id], 0xff, sizeof(br_p->learning[inst_id]));
+    memset(br_p->forwarding[inst_id], 0xff, sizeof(br_p->forwarding[inst_id]));
+}
+
+/* Returns the bridge, allocating it if create is set, or NULL. */
+static struct oes_stp_bridge *
+oes_stp_bridge_get(const int br_id, int create)
+{
+    struct oes_stp_bridge *br_p;
+
+    if ((br_id < 0) || (br_id >= OES_STP_MAX_BRIDGES)) {
+        return NULL;
+    }
+    if (!oes_stp_bridges[br_id] && create) {
+        br_p = calloc(1, sizeof(struct oes_stp_bridge));
+        if (!br_p) {
+            return NULL;
+        }
+        br_p->mode = OES_STP_MODE_MSTP;
+        OES_BITMAP_SET(br_p->msti_in_use, OES_STP_CIST);
+        oes_vlan_bitmap_range_set(br_p->msti_vlans[OES_STP_CIST], OES_VLAN_VID_MIN, OES_VLAN_VID_MAX);
+        oes_stp_msti_ports_reset(br_p, OES_STP_CIST);
+        oes_stp_bridges[br_id] = br_p;
+    }
+    return oes_stp_bridges[br_id];
+}
+
+static inline int
+oes_stp_msti_in_use(const struct oes_stp_bridge *br_p, unsigned int inst_id)
+{
+    return (inst_id <= OES_STP_MAX_MSTI) && OES_BITMAP_TEST(br_p->msti_in_use, inst_id);
+}
+
+/* Maps a VLAN to an instance, taking it from the one it was mapped to. */
+static void
+oes_stp_vlan_map(struct oes_stp_bridge *br_p, unsigned int vid, unsigned int inst_id)
+{
+    OES_BITMAP_CLR(br_p->msti_vlans[br_p->vid_msti[vid]], vid);
+    OES_BITMAP_SET(br_p->msti_vlans[inst_id], vid);
+    br_p->vid_msti[vid] = inst_id;
+}
+
+/* Maps VLANs vid_first to vid_last to an instance, a word at a time. */
+static void
+oes_stp_vlan_range_map(struct oes_stp_bridge *br_p,
+                       unsigned int            vid_first,
+                       unsigned int            vid_last,
+                       unsigned int            inst_id)
+{
+    unsigned int i;
+
+    for (i = 0; i <= OES_STP_MAX_MSTI; i++) {
+        if ((i != inst_id) && OES_BITMAP_TEST(br_p->msti_in_use, i)) {
+            oes_vlan_bitmap_range_clear(br_p->msti_vlans[i], vid_first, vid_last);
+        }
+    }
+    oes_vlan_bitmap_range_set(br_p->msti_vlans[inst_id], vid_first, vid_last);
+    memset(&br_p->vid_msti[vid_first], inst_id, vid_last - vid_first + 1);
+}
+
+/* Returns the VLANs of an instance within vid_first to vid_last to the CIST. */
+static void
+oes_stp_vlan_range_unmap(struct oes_stp_bridge *br_p,
+                         unsigned int            vid_first,
+                         unsigned int            vid_last,
+                         unsigned int            inst_id)
+{
+    unsigned long long range[OES_VLAN_VID_WORDS], moved;
+    unsigned int       w;
+
+    memset(range, 0, sizeof(range));
+    oes_vlan_bitmap_range_set(range, vid_first, vid_last);
+    for (w = vid_first / OES_BITMAP_WORD_BITS; w <= vid_last / OES_BITMAP_WORD_BITS; w++) {
+        moved = br_p->msti_vlans[inst_id][w] & range[w];
+        br_p->msti_vlans[inst_id][w] &= ~moved;
+        br_p->msti_vlans[OES_STP_CIST][w] |= moved;
+        for (; moved; moved &= moved - 1) {
+            br_p->vid_msti[w * OES_BITMAP_WORD_BITS + __builtin_ctzll(moved)] = OES_STP_CIST;
+        }
+    }
+}
+
+/**
+ * This function sets the log verbosity level of STP MODULE
+ *
+ * @param[in]  verbosity_level  - stp module verbosity level
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully
+ * @return OES_STATUS_ERROR - Unexpected SDK error
+ * @return OES_STATUS_PARAM_ERROR - Unsupported verbosity_level
+ */
+oes_status_e
+oes_api_stp_log_verbosity_level_set(const int verbosity_level)
+{
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * This function gets the log verbosity level of STP MODULE
+ *
+ * @param[out]  verbosity_level_p  - stp module verbosity level
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully
+ * @return OES_STATUS_ERROR - Unexpected SDK error
+ * @return OES_STATUS_PARAM_ERROR - Unsupported verbosity_level
+ */
+oes_status_e
+oes_api_stp_log_verbosity_level_get(int *verbosity_level_p)
+{
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * This function Sets the Switch STP Activation mode(RSTP/MSTP)
+ *
+ * @param[in] br_id - bridge ID
+ * @param[in] mode - STP Activation mode, OES_STP_MODE_MSTP (default)
+ *       or OES_STP_MODE_RSTP
+ * @param[in,out] stp_mode_vs_ext - STP mode vendor extensions pointer
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR - Parameters out of range
+ * @return OES_STATUS_NO_MEMORY - the bridge could not be allocated
+ */
+oes_status_e
+oes_api_stp_mode_set(const int br_id,
+                     const enum oes_stp_mode mode,
+                     void *stp_mode_vs_ext)
+{
+    struct oes_stp_bridge *br_p;
+    oes_status_e           status = OES_STATUS_SUCCESS;
+
+    if ((br_id < 0) || (br_id >= OES_STP_MAX_BRIDGES) || ((unsigned int)mode > OES_STP_MODE_RSTP)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_rwlock_wrlock(&oes_stp_lock);
+    br_p = oes_stp_bridge_get(br_id, 1);
+    if (!br_p) {
+        status = OES_STATUS_NO_MEMORY;
+    } else {
+        br_p->mode = mode;
+    }
+    pthread_rwlock_unlock(&oes_stp_lock);
+    return status;
+}
+
+/**
+ * This function Retrieves the Switch STP Activation state (RSTP/MSTP).
+ *
+ * @param[in] br_id - bridge ID
+ * @param[out] mode_p - STP Activation state.
+ * @param[in,out] stp_mode_vs_ext - STP mode vendor extensions pointer
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR - Parameter error
+ */
+oes_status_e
+oes_api_stp_mode_get(const int br_id,
+                     enum oes_stp_mode *mode_p,
+                     void *stp_mode_vs_ext)
+{
+    struct oes_stp_bridge *br_p;
+
+    if ((br_id < 0) || (br_id >= OES_STP_MAX_BRIDGES) || !mode_p) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_rwlock_rdlock(&oes_stp_lock);
+    br_p = oes_stp_bridge_get(br_id, 0);
+    *mode_p = br_p ? br_p->mode : OES_STP_MODE_MSTP;
+    pthread_rwlock_unlock(&oes_stp_lock);
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * This function Adds/Deletes an MSTP Instance to/from the Switch. A
+ * new instance has no VLANs and all its ports forwarding; the VLANs
+ * of a deleted instance return to the CIST.
+ *
+ * @param[in] access_cmd - ADD/DELETE
+ * @param[in] br_id - bridge ID
+ * @param[in] inst_id - MSTP Instance ID to add/delete. Ranges <1-64>.
+ * @param[in,out] stp_msti_vs_ext - STP mode vendor extensions pointer
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR - Parameter error
+ * @return OES_STATUS_ENTRY_ALREADY_EXISTS - ADD of an instance in use
+ * @return OES_STATUS_ENTRY_NOT_FOUND - DELETE of an instance not in use
+ * @return OES_STATUS_CMD_UNSUPPORTED - access_cmd is not supported
+ * @return OES_STATUS_NO_MEMORY - the bridge could not be allocated
+ */
+oes_status_e
+oes_api_stp_msti_set(enum oes_access_cmd access_cmd,
+                     const int br_id,
+                     const unsigned short inst_id,
+                     void *stp_msti_vs_ext)
+{
+    unsigned long long     vids[OES_VLAN_VID_WORDS];
+    struct oes_stp_bridge *br_p;
+    oes_status_e           status = OES_STATUS_SUCCESS;
+    int                    refresh = 0;
+
+    if ((access_cmd != OES_ACCESS_CMD_ADD) && (access_cmd != OES_ACCESS_CMD_DELETE)) {
+        return OES_STATUS_CMD_UNSUPPORTED;
+    }
+    if ((br_id < 0) || (br_id >= OES_STP_MAX_BRIDGES) || (inst_id < 1) || (inst_id > OES_STP_MAX_MSTI)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_rwlock_wrlock(&oes_stp_lock);
+    br_p = oes_stp_bridge_get(br_id, access_cmd == OES_ACCESS_CMD_ADD);
+    if (!br_p) {
+        status = (access_cmd == OES_ACCESS_CMD_ADD) ? OES_STATUS_NO_MEMORY : OES_STATUS_ENTRY_NOT_FOUND;
+    } else if (access_cmd == OES_ACCESS_CMD_ADD) {
+        if (oes_stp_msti_in_use(br_p, inst_id)) {
+            status = OES_STATUS_ENTRY_ALREADY_EXISTS;
+        } else {
+            OES_BITMAP_SET(br_p->msti_in_use, inst_id);
+            oes_stp_msti_ports_reset(br_p, inst_id);
+        }
+    } else if (!oes_stp_msti_in_use(br_p, inst_id)) {
+        status = OES_STATUS_ENTRY_NOT_FOUND;
+    } else {
+        memcpy(vids, br_p->msti_vlans[inst_id], sizeof(vids));
+        oes_stp_vlan_range_unmap(br_p, OES_VLAN_VID_MIN, OES_VLAN_VID_MAX, inst_id);
+        OES_BITMAP_CLR(br_p->msti_in_use, inst_id);
+        refresh = 1;
+    }
+    pthread_rwlock_unlock(&oes_stp_lock);
+    if (refresh) {
+        oes_vlan_flood_vids_refresh(br_id, vids);
+    }
+    return status;
+}
+
+/**
+ * This function Adds/Deletes a mapping between a list of VLANs to the
+ * MSTP Instance. Added VLANs leave the instance they were mapped to,
+ * deleted VLANs of the instance return to the CIST.
+ *
+ * @param[in] access_cmd - ADD/DELETE
+ * @param[in] br_id - bridge ID
+ * @param[in] inst_id - MSTP Instance ID. Ranges <1-64>.
+ * @param[in] vlan_list_p - List of VLANs to Map/Unmap.
+ * @param[in] vlan_num - Number of VLANs to Map/Unmap. Ranges <1-4094>.
+ * @param[in,out] stp_msti_vlan_vs_ext - vendor specific extention
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR - Parameter error
+ * @return OES_STATUS_ENTRY_NOT_FOUND - inst_id was not added
+ * @return OES_STATUS_CMD_UNSUPPORTED - access_cmd is not supported
+ */
+oes_status_e
+oes_api_stp_msti_vlan_list_set(enum oes_access_cmd access_cmd,
+                               const int br_id,
+                               const unsigned char inst_id,
+                               const unsigned short *vlan_list_p,
+                               const unsigned short vlan_num,
+                               void *stp_msti_vlan_vs_ext)
+{
+    unsigned long long     vids[OES_VLAN_VID_WORDS];
+    struct oes_stp_bridge *br_p;
+    oes_status_e           status = OES_STATUS_SUCCESS;
+    unsigned int           i, vid;
+
+    if ((access_cmd != OES_ACCESS_CMD_ADD) && (access_cmd != OES_ACCESS_CMD_DELETE)) {
+        return OES_STATUS_CMD_UNSUPPORTED;
+    }
+    if ((br_id < 0) || (br_id >= OES_STP_MAX_BRIDGES) || (inst_id < 1) || (inst_id > OES_STP_MAX_MSTI) ||
+        (vlan_num && !vlan_list_p)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    memset(vids, 0, sizeof(vids));
+    for (i = 0; i < vlan_num; i++) {
+        if ((vlan_list_p[i] < OES_VLAN_VID_MIN) || (vlan_list_p[i] > OES_VLAN_VID_MAX)) {
+            return OES_STATUS_PARAM_ERROR;
+        }
+        OES_BITMAP_SET(vids, vlan_list_p[i]);
+    }
+
+    pthread_rwlock_wrlock(&oes_stp_lock);
+    br_p = oes_stp_bridge_get(br_id, 0);
+    if (!br_p || !oes_stp_msti_in_use(br_p, inst_id)) {
+        status = OES_STATUS_ENTRY_NOT_FOUND;
+        goto out;
+    }
+    for (i = 0; i < vlan_num; i++) {
+        vid = vlan_list_p[i];
+        if (access_cmd == OES_ACCESS_CMD_ADD) {
+            oes_stp_vlan_map(br_p, vid, inst_id);
+        } else if (br_p->vid_msti[vid] == inst_id) {
+            oes_stp_vlan_map(br_p, vid, OES_STP_CIST);
+        }
+    }
+out:
+    pthread_rwlock_unlock(&oes_stp_lock);
+    if (status == OES_STATUS_SUCCESS) {
+        oes_vlan_flood_vids_refresh(br_id, vids);
+    }
+    return status;
+}
+
+/**
+ * This function Adds/Deletes a mapping between the VLANs vid_first to
+ * vid_last and the MSTP Instance. The instance bitmaps are filled and
+ * cleared a word at a time.
+ *
+ * @param[in] access_cmd - ADD/DELETE
+ * @param[in] br_id - bridge ID
+ * @param[in] inst_id - MSTP Instance ID. Ranges <1-64>.
+ * @param[in] vid_first - first VLAN of the range. Ranges <1-4094>.
+ * @param[in] vid_last - last VLAN of the range. Ranges <1-4094>.
+ * @param[in,out] stp_msti_vlan_vs_ext - vendor specific extention
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR - Parameter error
+ * @return OES_STATUS_ENTRY_NOT_FOUND - inst_id was not added
+ * @return OES_STATUS_CMD_UNSUPPORTED - access_cmd is not supported
+ */
+oes_status_e
+oes_api_stp_msti_vlan_range_set(enum oes_access_cmd access_cmd,
+                                const int br_id,
+                                const unsigned char inst_id,
+                                const unsigned short vid_first,
+                                const unsigned short vid_last,
+                                void *stp_msti_vlan_vs_ext)
+{
+    unsigned long long     vids[OES_VLAN_VID_WORDS];
+    struct oes_stp_bridge *br_p;
+    oes_status_e           status = OES_STATUS_SUCCESS;
+
+    if ((access_cmd != OES_ACCESS_CMD_ADD) && (access_cmd != OES_ACCESS_CMD_DELETE)) {
+        return OES_STATUS_CMD_UNSUPPORTED;
+    }
+    if ((br_id < 0) || (br_id >= OES_STP_MAX_BRIDGES) || (inst_id < 1) || (inst_id > OES_STP_MAX_MSTI) ||
+        (vid_first < OES_VLAN_VID_MIN) || (vid_last > OES_VLAN_VID_MAX) || (vid_first > vid_last)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_rwlock_wrlock(&oes_stp_lock);
+    br_p = oes_stp_bridge_get(br_id, 0);
+    if (!br_p || !oes_stp_msti_in_use(br_p, inst_id)) {
+        status = OES_STATUS_ENTRY_NOT_FOUND;
+    } else if (access_cmd == OES_ACCESS_CMD_ADD) {
+        oes_stp_vlan_range_map(br_p, vid_first, vid_last, inst_id);
+    } else {
+        oes_stp_vlan_range_unmap(br_p, vid_first, vid_last, inst_id);
+    }
+    pthread_rwlock_unlock(&oes_stp_lock);
+    if (status == OES_STATUS_SUCCESS) {
+        memset(vids, 0, sizeof(vids));
+        oes_vlan_bitmap_range_set(vids, vid_first, vid_last);
+        oes_vlan_flood_vids_refresh(br_id, vids);
+    }
+    return status;
+}
+
+/**
+ * This function Retrieves the list of VLANs in the MSTP Instance, in
+ * order. If the list (array) is NULL, only the number of VLANs is
+ * retrieved.
+ *
+ * @param[in] br_id - bridge ID
+ * @param[in] inst_id - MSTP Instance ID. Ranges <1-64>, 0 for the CIST.
+ * @param[in,out] vlan_list_p - VLANs array.
+ * @param[in,out] vlan_num_p - In: Size of VLANs array. Out: number of
+ *       VLANs retrieved.
+ * @param[in,out] stp_msti_vlan_vs_ext - vendor specific extention
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR - Parameter error
+ * @return OES_STATUS_ENTRY_NOT_FOUND - inst_id was not added
+ */
+oes_status_e
+oes_api_stp_msti_vlan_list_get(const int br_id,
+                               const unsigned char inst_id,
+                               unsigned short *vlan_list_p,
+                               unsigned short *vlan_num_p,
+                               void *stp_msti_vlan_vs_ext)
+{
+    struct oes_stp_bridge *br_p;
+    unsigned long long     bits;
+    oes_status_e           status = OES_STATUS_SUCCESS;
+    unsigned int           w, cnt = 0;
+
+    if ((br_id < 0) || (br_id >= OES_STP_MAX_BRIDGES) || (inst_id > OES_STP_MAX_MSTI) || !vlan_num_p) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_rwlock_rdlock(&oes_stp_lock);
+    br_p = oes_stp_bridge_get(br_id, 0);
+    if (!br_p) {
+        if (inst_id != OES_STP_CIST) {
+            status = OES_STATUS_ENTRY_NOT_FOUND;
+        } else if (!vlan_list_p) {
+            *vlan_num_p = OES_VLAN_VID_MAX - OES_VLAN_VID_MIN + 1;
+        } else {
+            for (; (cnt < *vlan_num_p) && (cnt <= OES_VLAN_VID_MAX - OES_VLAN_VID_MIN); cnt++) {
+                vlan_list_p[cnt] = OES_VLAN_VID_MIN + cnt;
+            }
+            *vlan_num_p = cnt;
+        }
+        goto out;
+    }
+    if (!oes_stp_msti_in_use(br_p, inst_id)) {
+        status = OES_STATUS_ENTRY_NOT_FOUND;
+        goto out;
+    }
+    for (w = 0; w < OES_VLAN_VID_WORDS; w++) {
+        if (!vlan_list_p) {
+            cnt += __builtin_popcountll(br_p->msti_vlans[inst_id][w]);
+            continue;
+        }
+        for (bits = br_p->msti_vlans[inst_id][w]; bits && (cnt < *vlan_num_p); bits &= bits - 1) {
+            vlan_list_p[cnt++] = w * OES_BITMAP_WORD_BITS + __builtin_ctzll(bits);
+        }
+    }
+    *vlan_num_p = cnt;
+out:
+    pthread_rwlock_unlock(&oes_stp_lock);
+    return status;
+}
+
+/**
+ * This function Sets the MSTP Port State for a given Instance.
+ *
+ * @param[in] br_id - bridge ID
+ * @param[in] inst_id - MSTP Instance ID. Ranges <1-64>, 0 for the CIST.
+ * @param[in] port_id - Port ID (whose STP state to set).
+ * @param[in] port_state - MSTP Port State: OES_MSTP_INST_PORT_STATE_DISCARDING,
+ *       OES_MSTP_INST_PORT_STATE_LEARNING or OES_MSTP_INST_PORT_STATE_FORWARDING
+ * @param[in,out] stp_msti_port_vs_ext - vendor specific extention
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR - Parameter error
+ * @return OES_STATUS_ENTRY_NOT_FOUND - inst_id was not added
+ * @return OES_STATUS_NO_MEMORY - the bridge could not be allocated
+ */
+oes_status_e
+oes_api_stp_msti_port_state_set(const int br_id,
+                                const unsigned char inst_id,
+                                const unsigned long port_id,
+                                const enum oes_mstp_inst_port_state port_state,
+                                void *stp_msti_port_vs_ext)
+{
+    unsigned long long     vids[OES_VLAN_VID_WORDS];
+    struct oes_stp_bridge *br_p;
+    oes_status_e           status = OES_STATUS_SUCCESS;
+
+    if ((br_id < 0) || (br_id >= OES_STP_MAX_BRIDGES) || (inst_id > OES_STP_MAX_MSTI) ||
+        (port_id >= OES_MAX_PORTS) || ((unsigned int)port_state > OES_MSTP_INST_PORT_STATE_FORWARDING)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_rwlock_wrlock(&oes_stp_lock);
+    br_p = oes_stp_bridge_get(br_id, inst_id == OES_STP_CIST);
+    if (!br_p) {
+        status = (inst_id == OES_STP_CIST) ? OES_STATUS_NO_MEMORY : OES_STATUS_ENTRY_NOT_FOUND;
+        goto out;
+    }
+    if (!oes_stp_msti_in_use(br_p, inst_id)) {
+        status = OES_STATUS_ENTRY_NOT_FOUND;
+        goto out;
+    }
+    OES_BITMAP_CLR(br_p->learning[inst_id], port_id);
+    OES_BITMAP_CLR(br_p->forwarding[inst_id], port_id);
+    if (port_state != OES_MSTP_INST_PORT_STATE_DISCARDING) {
+        OES_BITMAP_SET(br_p->learning[inst_id], port_id);
+    }
+    if (port_state == OES_MSTP_INST_PORT_STATE_FORWARDING) {
+        OES_BITMAP_SET(br_p->forwarding[inst_id], port_id);
+    }
+    memcpy(vids, br_p->msti_vlans[inst_id], sizeof(vids));
+out:
+    pthread_rwlock_unlock(&oes_stp_lock);
+    if (status == OES_STATUS_SUCCESS) {
+        oes_vlan_flood_vids_refresh(br_id, vids);
+    }
+    return status;
+}
+
+/**
+ * This function Retrieves the MSTP Port State for a given Instance.
+ *
+ * @param[in] br_id - bridge ID.
+ * @param[in] inst_id - MSTP Instance ID. Ranges <1-64>, 0 for the CIST.
+ * @param[in] port_id - Port ID (whose STP state to retrieve).
+ * @param[out] port_state_p - MSTP Port State.
+ * @param[in,out] stp_msti_port_vs_ext - vendor specific extention
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR - Parameter error
+ * @return OES_STATUS_ENTRY_NOT_FOUND - inst_id was not added
+ */
+oes_status_e
+oes_api_stp_msti_port_state_get(const int br_id,
+                                const unsigned char inst_id,
+                                const unsigned long port_id,
+                                enum oes_mstp_inst_port_state *port_state_p,
+                                void *stp_msti_port_vs_ext)
+{
+    struct oes_stp_bridge *br_p;
+    oes_status_e           status = OES_STATUS_SUCCESS;
+
+    if ((br_id < 0) || (br_id >= OES_STP_MAX_BRIDGES) || (inst_id > OES_STP_MAX_MSTI) ||
+        (port_id >= OES_MAX_PORTS) || !port_state_p) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_rwlock_rdlock(&oes_stp_lock);
+    br_p = oes_stp_bridge_get(br_id, 0);
+    if (!br_p) {
+        if (inst_id == OES_STP_CIST) {
+            *port_state_p = OES_MSTP_INST_PORT_STATE_FORWARDING;
+        } else {
+            status = OES_STATUS_ENTRY_NOT_FOUND;
+        }
+    } else if (!oes_stp_msti_in_use(br_p, inst_id)) {
+        status = OES_STATUS_ENTRY_NOT_FOUND;
+    } else if (OES_BITMAP_TEST(br_p->forwarding[inst_id], port_id)) {
+        *port_state_p = OES_MSTP_INST_PORT_STATE_FORWARDING;
+    } else if (OES_BITMAP_TEST(br_p->learning[inst_id], port_id)) {
+        *port_state_p = OES_MSTP_INST_PORT_STATE_LEARNING;
+    } else {
+        *port_state_p = OES_MSTP_INST_PORT_STATE_DISCARDING;
+    }
+    pthread_rwlock_unlock(&oes_stp_lock);
+    return status;
+}
+
+/**
+ * This function returns the state flooding needs: the MSTP Instance of
+ * each VLAN and the forwarding ports of each instance.
+ *
+ * @param[in] br_id - bridge ID.
+ * @param[out] vid_msti - OES_MAX_VLANS instance IDs, 0 for the CIST.
+ * @param[out] forwarding - OES_STP_MAX_MSTI + 1 port bitmaps.
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR - Parameter error
+ */
+oes_status_e
+oes_stp_forwarding_snapshot(const int br_id,
+                            unsigned char *vid_msti,
+                            unsigned long long (*forwarding)[OES_VLAN_PORT_WORDS])
+{
+    struct oes_stp_bridge *br_p;
+
+    if ((br_id < 0) || (br_id >= OES_STP_MAX_BRIDGES)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_rwlock_rdlock(&oes_stp_lock);
+    br_p = oes_stp_bridge_get(br_id, 0);
+    if (br_p) {
+        memcpy(vid_msti, br_p->vid_msti, sizeof(br_p->vid_msti));
+        memcpy(forwarding, br_p->forwarding, sizeof(br_p->forwarding));
+    } else {
+        memset(vid_msti, OES_STP_CIST, OES_MAX_VLANS);
+        memset(forwarding[OES_STP_CIST], 0xff, sizeof(forwarding[OES_STP_CIST]));
+    }
+    pthread_rwlock_unlock(&oes_stp_lock);
+    return OES_STATUS_SUCCESS;
+}
@@ -154,6 +154,35 @@ oes_api_stp_msti_vlan_list_set(
                               void * stp_msti_vlan_vs_ext
                               );
 
+/** 
+ *This function Adds/Deletes a mapping between the VLANs 
+ *vid_first to vid_last and the MSTP Instance in a single command. 
+ *Added VLANs leave the instance they were mapped to, deleted VLANs
+ *return to the CIST. 
+ *
+ * @param[in] access_cmd - ADD/DELETE
+ * @param[in] br_id 
+ * @param[in] inst_id - MSTP Instance ID. Ranges <1-64>.
+ * @param[in] vid_first - first VLAN of the range. Ranges <1-4094>.
+ * @param[in] vid_last - last VLAN of the range. Ranges <1-4094>.
+ * @param[in.out] stp_msti_vlan_vs_ext - vendor specific
+ *       extention
+ * 
+ * @return OES_STATUS_SUCCESS - Operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR - Parameter error
+ * @return OES_STATUS_ENTRY_NOT_FOUND - inst_id was not added
+ * @return OES_STATUS_CMD_UNSUPPORTED - access_cmd is not supported
+ */
+oes_status_e
+oes_api_stp_msti_vlan_range_set(
+                               enum oes_access_cmd access_cmd, 
+                               const int br_id, 
+                               const unsigned char inst_id, 
+                               const unsigned short vid_first,
+                               const unsigned short vid_last, 
+                               void * stp_msti_vlan_vs_ext
+                               );
+
 /**
  * This function Retrieves a list of VLANs in the MSTP Instance from the SDK.
  * If the list (array) is NULL, only the number of VLANs is retrieved. 
@@ -231,5 +260,24 @@ oes_api_stp_msti_port_state_get(
                                );
 
 
+/**
+ * This function returns the state flooding needs: the MSTP Instance
+ * of each VLAN and the forwarding ports of each instance. It is
+ * called by the VLAN module.
+ *
+ * @param[in] br_id - bridge ID.
+ * @param[out] vid_msti - OES_MAX_VLANS instance IDs, 0 for the CIST.
+ * @param[out] forwarding - OES_STP_MAX_MSTI + 1 port bitmaps.
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR - Parameter error
+ */
+oes_status_e
+oes_stp_forwarding_snapshot(
+                           const int br_id,
+                           unsigned char * vid_msti,
+                           unsigned long long (*forwarding)[OES_BITMAP_WORDS(OES_MAX_PORTS)]
+                           );
+
 
 #endif /* __OES_API_STP_H__ */
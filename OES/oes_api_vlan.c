@@ -0,0 +1,1436 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_api_lag.h"
+#include "oes_api_stp.h"
+#include "oes_api_vlan.h"
+#include "oes_vlan_cntr.h"
+#include "oes_vlan_member.h"
+#include "oes_vlan_flood.h"
+#include "oes_vlan_stage.h"
+
+#define OES_VLAN_MAX_BRIDGES          4096
+#define OES_VLAN_DEFAULT_VID          1
+
+struct oes_vlan_bridge {
+    struct oes_vlan_members    members;
+    struct oes_vlan_flood      flood;
+    struct oes_vlan_port_stage stage[OES_MAX_PORTS];
+    unsigned short             default_vid;
+};
+
+/* writers: configuration, readers: the forwarding path */
+static pthread_rwlock_t        oes_vlan_lock = PTHREAD_RWLOCK_INITIALIZER;
+static struct oes_vlan_bridge *oes_vlan_bridges[OES_VLAN_MAX_BRIDGES];
+
+/* counter sums at the last clear per bridge, NULL before; apart from the
+ * vlan lock so counter reads never hold up the forwarding path */
+static pthread_rwlock_t        oes_vlan_cntr_lock = PTHREAD_RWLOCK_INITIALIZER;
+static unsigned long long     *oes_vlan_cntr_bases[OES_VLAN_MAX_BRIDGES];
+
+/* membership of a bridge never configured */
+static const struct oes_vlan_members oes_vlan_members_none;
+
+static struct oes_vlan_bridge *
+oes_vlan_bridge_alloc(void)
+{
+    struct oes_vlan_bridge *br_p;
+    unsigned int            port;
+
+    br_p = calloc(1, sizeof(struct oes_vlan_bridge));
+    if (!br_p) {
+        return NULL;
+    }
+    br_p->default_vid = OES_VLAN_DEFAULT_VID;
+    for (port = 0; port < OES_MAX_PORTS; port++) {
+        oes_vlan_port_stage_init(&br_p->stage[port], br_p->default_vid);
+    }
+    return br_p;
+}
+
+/* Returns the bridge, allocating it if create is set, or NULL. */
+static struct oes_vlan_bridge *
+oes_vlan_bridge_get(const int br_id, int create)
+{
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES)) {
+        return NULL;
+    }
+    if (!oes_vlan_bridges[br_id] && create) {
+        oes_vlan_bridges[br_id] = oes_vlan_bridge_alloc();
+    }
+    return oes_vlan_bridges[br_id];
+}
+
+/* Returns the settings of a port, allocating the bridge if create is set, or NULL. */
+static struct oes_vlan_port_stage *
+oes_vlan_port_stage_get(const int br_id, const unsigned long log_port, int create)
+{
+    struct oes_vlan_bridge *br_p;
+
+    if (log_port >= OES_MAX_PORTS) {
+        return NULL;
+    }
+    br_p = oes_vlan_bridge_get(br_id, create);
+    return br_p ? &br_p->stage[log_port] : NULL;
+}
+
+/* Copies the settings of a port, the defaults if its bridge has none. */
+static void
+oes_vlan_port_stage_read(const int br_id, const unsigned long log_port, struct oes_vlan_port_stage *port_p)
+{
+    struct oes_vlan_port_stage *stage_p;
+
+    pthread_rwlock_rdlock(&oes_vlan_lock);
+    stage_p = oes_vlan_port_stage_get(br_id, log_port, 0);
+    if (stage_p) {
+        *port_p = *stage_p;
+    } else {
+        oes_vlan_port_stage_init(port_p, OES_VLAN_DEFAULT_VID);
+    }
+    pthread_rwlock_unlock(&oes_vlan_lock);
+}
+
+/* Returns the OES_MAX_VLANS counter bases of a bridge, allocating them if create is set, or NULL. */
+static unsigned long long *
+oes_vlan_cntr_bases_get(const int br_id, int create)
+{
+    if (!oes_vlan_cntr_bases[br_id] && create) {
+        oes_vlan_cntr_bases[br_id] = calloc(OES_MAX_VLANS * OES_VLAN_CNTR_FIELDS, sizeof(unsigned long long));
+    }
+    return oes_vlan_cntr_bases[br_id];
+}
+
+/* Recomputes the flood sets of VLANs, with the vlan lock held for writing. */
+static void
+oes_vlan_flood_update(const int br_id, struct oes_vlan_bridge *br_p, const unsigned long long *vids)
+{
+    struct oes_vlan_flood_inputs inputs;
+
+    oes_stp_forwarding_snapshot(br_id, inputs.vid_msti, inputs.forwarding);
+    oes_lag_flood_snapshot(br_id, inputs.lag_ports, inputs.lag_members, inputs.designated);
+    memset(inputs.lag_range, 0, sizeof(inputs.lag_range));
+    oes_vlan_bitmap_range_set(inputs.lag_range, OES_LAG_PORT_BASE, OES_MAX_PORTS - 1);
+    oes_vlan_flood_compute(&br_p->flood, &br_p->members, &inputs, vids);
+}
+
+static inline int
+oes_vlan_vid_valid(unsigned int vid)
+{
+    return (vid >= OES_VLAN_VID_MIN) && (vid <= OES_VLAN_VID_MAX);
+}
+
+static inline int
+oes_vlan_tagging_valid(enum oes_vlan_tagging tagging)
+{
+    return (unsigned int)tagging <= OES_VLAN_PRIO_TAGGED_MEMBER;
+}
+
+static inline int
+oes_vlan_ports_any(const unsigned long long *ports)
+{
+    unsigned int w;
+
+    for (w = 0; w < OES_VLAN_PORT_WORDS; w++) {
+        if (ports[w]) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * This function sets the log verbosity level of vlan MODULE
+ * @param[in]  verbosity_level  - vlan module verbosity level
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully
+ * @return OES_STATUS_ERROR - Unexpected SDK error
+ * @return OES_STATUS_PARAM_ERROR - Unsupported verbosity_level
+ */
+oes_status_e
+oes_api_vlan_log_verbosity_level_set(const int verbosity_level)
+{
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * This function gets the log verbosity level of vlan MODULE
+ * @param[out]  verbosity_level_p  - vlan module verbosity level
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully
+ * @return OES_STATUS_ERROR - Unexpected SDK error
+ * @return OES_STATUS_PARAM_ERROR - Unsupported verbosity_level
+ */
+oes_status_e
+oes_api_vlan_log_verbosity_level_get(int *verbosity_level_p)
+{
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * This function sets the VLAN member ports. ADD of a port that is a
+ * member already changes its tagging. The list is checked as a whole
+ * before anything changes.
+ *
+ * @param[in] access_cmd - ADD / DELETE / DELETE_ALL
+ * @param[in] br_id - bridge ID
+ * @param[in] vid - VLAN id
+ * @param[in] vlan_port_list_p - a pointer to array of port list
+ *       structure. In case of "delete all" command, port_cnt = 0 and
+ *       vlan_port_list_p = NULL are applicable
+ * @param[in] port_cnt - number of ports in a port list
+ * @param[in,out] vlan_port_vs_ext - vlan port vendor extension pointer
+ *
+ * @return OES_STATUS_SUCCESS - Operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR - br_id, vid or a port in the list is invalid
+ * @return OES_STATUS_CMD_UNSUPPORTED - access_cmd is not supported
+ * @return OES_STATUS_NO_MEMORY - the bridge could not be allocated
+ */
+oes_status_e
+oes_api_vlan_ports_set(const enum oes_access_cmd access_cmd,
+                       const int br_id,
+                       const unsigned short vid,
+                       const struct oes_vlan_port *vlan_port_list_p,
+                       const unsigned short port_cnt,
+                       void *vlan_port_vs_ext)
+{
+    unsigned long long      vids[OES_VLAN_VID_WORDS];
+    struct oes_vlan_bridge *br_p;
+    oes_status_e            status = OES_STATUS_SUCCESS;
+    unsigned int            i;
+
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || !oes_vlan_vid_valid(vid)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    switch (access_cmd) {
+    case OES_ACCESS_CMD_ADD:
+    case OES_ACCESS_CMD_DELETE:
+        if (port_cnt && !vlan_port_list_p) {
+            return OES_STATUS_PARAM_ERROR;
+        }
+        for (i = 0; i < port_cnt; i++) {
+            if ((vlan_port_list_p[i].log_port >= OES_MAX_PORTS) ||
+                ((access_cmd == OES_ACCESS_CMD_ADD) &&
+                 !oes_vlan_tagging_valid(vlan_port_list_p[i].tagging))) {
+                return OES_STATUS_PARAM_ERROR;
+            }
+        }
+        break;
+    case OES_ACCESS_CMD_DELETE_ALL:
+        break;
+    default:
+        return OES_STATUS_CMD_UNSUPPORTED;
+    }
+
+    pthread_rwlock_wrlock(&oes_vlan_lock);
+    br_p = oes_vlan_bridge_get(br_id, access_cmd == OES_ACCESS_CMD_ADD);
+    if (!br_p) {
+        status = (access_cmd == OES_ACCESS_CMD_ADD) ? OES_STATUS_NO_MEMORY : OES_STATUS_SUCCESS;
+        goto out;
+    }
+    switch (access_cmd) {
+    case OES_ACCESS_CMD_ADD:
+        for (i = 0; i < port_cnt; i++) {
+            oes_vlan_member_set(&br_p->members, vid, vlan_port_list_p[i].log_port,
+                                vlan_port_list_p[i].tagging);
+        }
+        break;
+    case OES_ACCESS_CMD_DELETE:
+        for (i = 0; i < port_cnt; i++) {
+            oes_vlan_member_clear(&br_p->members, vid, vlan_port_list_p[i].log_port);
+        }
+        break;
+    default:
+        oes_vlan_members_clear_vid(&br_p->members, vid);
+        break;
+    }
+    memset(vids, 0, sizeof(vids));
+    OES_BITMAP_SET(vids, vid);
+    oes_vlan_flood_update(br_id, br_p, vids);
+out:
+    pthread_rwlock_unlock(&oes_vlan_lock);
+    return status;
+}
+
+/**
+ * This function gets the VLAN member ports, in port order.
+ *
+ * @param[in] br_id - bridge ID
+ * @param[in] vid - VLAN id
+ * @param[in,out] vlan_port_list_p - a pointer to array of vlan port list
+ *       structure. If it is NULL, port_cnt_p is filled with the number
+ *       of member ports
+ * @param[in,out] port_cnt_p - in: size of the list, out: number of
+ *       ports returned
+ * @param[in,out] vlan_port_vs_ext - vlan port vendor extension pointer
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ */
+oes_status_e
+oes_api_vlan_ports_get(const int br_id,
+                       const unsigned short vid,
+                       struct oes_vlan_port *vlan_port_list_p,
+                       unsigned short *port_cnt_p,
+                       void *vlan_port_vs_ext)
+{
+    struct oes_vlan_bridge *br_p;
+    unsigned long long      bits;
+    unsigned int            w, port, cnt = 0;
+
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || !oes_vlan_vid_valid(vid) || !port_cnt_p) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_rwlock_rdlock(&oes_vlan_lock);
+    br_p = oes_vlan_bridge_get(br_id, 0);
+    if (!br_p) {
+        *port_cnt_p = 0;
+    } else if (!vlan_port_list_p) {
+        *port_cnt_p = oes_vlan_members_count(&br_p->members, vid);
+    } else {
+        for (w = 0; w < OES_VLAN_PORT_WORDS; w++) {
+            for (bits = br_p->members.vlan_ports[vid][w]; bits && (cnt < *port_cnt_p); bits &= bits - 1) {
+                port = w * OES_BITMAP_WORD_BITS + __builtin_ctzll(bits);
+                vlan_port_list_p[cnt].log_port = port;
+                vlan_port_list_p[cnt].tagging = oes_vlan_tagging_get(&br_p->members, vid, port);
+                cnt++;
+            }
+        }
+        *port_cnt_p = cnt;
+    }
+    pthread_rwlock_unlock(&oes_vlan_lock);
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * This function sets the VLANs list to a port in a single command.
+ * The list is checked as a whole before anything changes.
+ *
+ * @param[in] access_cmd - OES_ACCESS_CMD_ADD - Add list of VLANs to port
+ *                         OES_ACCESS_CMD_DELETE - Remove a list VLANs from port
+ * @param[in] br_id - bridge ID
+ * @param[in] log_port - logical port
+ * @param[in] vlan_list_p - pointer to a list of VLAN,tagged value tuples
+ * @param[in] vlan_cnt - size of VLANs list
+ * @param[in,out] vlan_list_vs_ext - vlan list vendor extension pointer
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_CMD_UNSUPPORTED - access_cmd is not supported
+ * @return OES_STATUS_NO_MEMORY - the bridge could not be allocated
+ */
+oes_status_e
+oes_api_vlan_port_multi_vlan_set(const enum oes_access_cmd access_cmd,
+                                 const int br_id,
+                                 const unsigned long log_port,
+                                 const struct oes_port_vlans *vlan_list_p,
+                                 const unsigned short vlan_cnt,
+                                 void *vlan_list_vs_ext)
+{
+    unsigned long long      vids[OES_VLAN_VID_WORDS];
+    struct oes_vlan_bridge *br_p;
+    oes_status_e            status = OES_STATUS_SUCCESS;
+    unsigned int            i;
+
+    if ((access_cmd != OES_ACCESS_CMD_ADD) && (access_cmd != OES_ACCESS_CMD_DELETE)) {
+        return OES_STATUS_CMD_UNSUPPORTED;
+    }
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || (log_port >= OES_MAX_PORTS) ||
+        (vlan_cnt && !vlan_list_p)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    memset(vids, 0, sizeof(vids));
+    for (i = 0; i < vlan_cnt; i++) {
+        if (!oes_vlan_vid_valid(vlan_list_p[i].vid) ||
+            ((access_cmd == OES_ACCESS_CMD_ADD) && !oes_vlan_tagging_valid(vlan_list_p[i].tagging))) {
+            return OES_STATUS_PARAM_ERROR;
+        }
+        OES_BITMAP_SET(vids, vlan_list_p[i].vid);
+    }
+
+    pthread_rwlock_wrlock(&oes_vlan_lock);
+    br_p = oes_vlan_bridge_get(br_id, access_cmd == OES_ACCESS_CMD_ADD);
+    if (!br_p) {
+        status = (access_cmd == OES_ACCESS_CMD_ADD) ? OES_STATUS_NO_MEMORY : OES_STATUS_SUCCESS;
+        goto out;
+    }
+    for (i = 0; i < vlan_cnt; i++) {
+        if (access_cmd == OES_ACCESS_CMD_ADD) {
+            oes_vlan_member_set(&br_p->members, vlan_list_p[i].vid, log_port, vlan_list_p[i].tagging);
+        } else {
+            oes_vlan_member_clear(&br_p->members, vlan_list_p[i].vid, log_port);
+        }
+    }
+    oes_vlan_flood_update(br_id, br_p, vids);
+out:
+    pthread_rwlock_unlock(&oes_vlan_lock);
+    return status;
+}
+
+/**
+ * This function adds ports to, or removes them from, every VLAN of the
+ * range vid_first to vid_last in a single command. The ports are
+ * grouped by tagging into port bitmaps, each applied to the range with
+ * word-wide operations.
+ *
+ * @param[in] access_cmd - OES_ACCESS_CMD_ADD - Add the ports to the VLANs
+ *                         OES_ACCESS_CMD_DELETE - Remove the ports from the VLANs
+ * @param[in] br_id - bridge ID
+ * @param[in] vid_first - first VLAN id of the range
+ * @param[in] vid_last - last VLAN id of the range
+ * @param[in] vlan_port_list_p - a pointer to array of port list structure.
+ *       The tagging is ignored by delete
+ * @param[in] port_cnt - number of ports in a port list
+ * @param[in,out] vlan_range_vs_ext - vlan range vendor extension pointer
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_CMD_UNSUPPORTED - access_cmd is not supported
+ * @return OES_STATUS_NO_MEMORY - the bridge could not be allocated
+ */
+oes_status_e
+oes_api_vlan_ports_range_set(const enum oes_access_cmd access_cmd,
+                             const int br_id,
+                             const unsigned short vid_first,
+                             const unsigned short vid_last,
+                             const struct oes_vlan_port *vlan_port_list_p,
+                             const unsigned short port_cnt,
+                             void *vlan_range_vs_ext)
+{
+    unsigned long long      ports[OES_VLAN_PRIO_TAGGED_MEMBER + 1][OES_VLAN_PORT_WORDS];
+    unsigned long long      vids[OES_VLAN_VID_WORDS];
+    struct oes_vlan_bridge *br_p;
+    oes_status_e            status = OES_STATUS_SUCCESS;
+    unsigned int            i, t;
+
+    if ((access_cmd != OES_ACCESS_CMD_ADD) && (access_cmd != OES_ACCESS_CMD_DELETE)) {
+        return OES_STATUS_CMD_UNSUPPORTED;
+    }
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || !oes_vlan_vid_valid(vid_first) ||
+        !oes_vlan_vid_valid(vid_last) || (vid_first > vid_last) || (port_cnt && !vlan_port_list_p)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    memset(ports, 0, sizeof(ports));
+    for (i = 0; i < port_cnt; i++) {
+        t = (access_cmd == OES_ACCESS_CMD_ADD) ? vlan_port_list_p[i].tagging : OES_VLAN_TAGGED_MEMBER;
+        if ((vlan_port_list_p[i].log_port >= OES_MAX_PORTS) || !oes_vlan_tagging_valid(t)) {
+            return OES_STATUS_PARAM_ERROR;
+        }
+        OES_BITMAP_SET(ports[t], vlan_port_list_p[i].log_port);
+    }
+
+    pthread_rwlock_wrlock(&oes_vlan_lock);
+    br_p = oes_vlan_bridge_get(br_id, access_cmd == OES_ACCESS_CMD_ADD);
+    if (!br_p) {
+        status = (access_cmd == OES_ACCESS_CMD_ADD) ? OES_STATUS_NO_MEMORY : OES_STATUS_SUCCESS;
+        goto out;
+    }
+    if (access_cmd == OES_ACCESS_CMD_DELETE) {
+        oes_vlan_members_range_clear(&br_p->members, vid_first, vid_last, ports[OES_VLAN_TAGGED_MEMBER]);
+    } else {
+        for (t = OES_VLAN_TAGGED_MEMBER; t <= OES_VLAN_PRIO_TAGGED_MEMBER; t++) {
+            if (oes_vlan_ports_any(ports[t])) {
+                oes_vlan_members_range_set(&br_p->members, vid_first, vid_last, ports[t], t);
+            }
+        }
+    }
+    memset(vids, 0, sizeof(vids));
+    oes_vlan_bitmap_range_set(vids, vid_first, vid_last);
+    oes_vlan_flood_update(br_id, br_p, vids);
+out:
+    pthread_rwlock_unlock(&oes_vlan_lock);
+    return status;
+}
+
+/**
+ * This function enables/ disables ingress VLAN filtering on port. The
+ * VLAN membership is defined in oes_vlan_ports_set API
+ *
+ * @param[in] br_id - bridge ID
+ * @param[in] log_port - logical port number
+ * @param[in] ingress_filter_state - port ingress vlan filter state (enable/disable)
+ * @param[in,out] vlan_filter_vs_ext - vlan filter vendor extension pointer
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_NO_MEMORY - the bridge could not be allocated
+ */
+oes_status_e
+oes_api_vlan_ingr_filter_ports_set(const int br_id,
+                                   const unsigned long log_port,
+                                   const enum oes_ingr_filter_mode ingress_filter_state,
+                                   void *vlan_filter_vs_ext)
+{
+    struct oes_vlan_port_stage *port_p;
+    oes_status_e                status = OES_STATUS_SUCCESS;
+
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || (log_port >= OES_MAX_PORTS) ||
+        ((unsigned int)ingress_filter_state > OES_INGR_FILTER_ENABLE)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_rwlock_wrlock(&oes_vlan_lock);
+    port_p = oes_vlan_port_stage_get(br_id, log_port, 1);
+    if (port_p) {
+        port_p->ingr_filter = ingress_filter_state;
+    } else {
+        status = OES_STATUS_NO_MEMORY;
+    }
+    pthread_rwlock_unlock(&oes_vlan_lock);
+    return status;
+}
+
+/**
+ * This function retrieves ingress VLAN filtering on a port.
+ *
+ * @param[in] br_id - bridge ID
+ * @param[in] log_port - logical port number
+ * @param[out] ingress_filter_state_p - a pointer to port ingress vlan filter state
+ * @param[in,out] vlan_filter_vs_ext - vlan filter vendor extension pointer
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_ERROR - Unexpected SDK error
+ */
+oes_status_e
+oes_api_vlan_ingr_filter_ports_get(const int br_id,
+                                   const unsigned long log_port,
+                                   enum oes_ingr_filter_mode *ingress_filter_state_p,
+                                   void *vlan_filter_vs_ext)
+{
+    struct oes_vlan_port_stage port;
+
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || (log_port >= OES_MAX_PORTS) || !ingress_filter_state_p) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    oes_vlan_port_stage_read(br_id, log_port, &port);
+    *ingress_filter_state_p = port.ingr_filter;
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * This function sets port's default VLAN ID. The PVID is set to
+ * untagged packets that ingress on the port.
+ *
+ * @param[in] access_cmd - ADD / DELETE (return PVID to default)
+ * @param[in] br_id - bridge id
+ * @param[in] log_port - logical port number
+ * @param[in] pvid - Port VLAN ID
+ * @param[in,out] port_pvid_vs_ext - port pvid vendor extension pointer
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_NO_MEMORY - the bridge could not be allocated
+ */
+oes_status_e
+oes_api_vlan_port_pvid_set(const enum oes_access_cmd access_cmd,
+                           const int br_id,
+                           const unsigned long log_port,
+                           const unsigned short pvid,
+                           void *port_pvid_vs_ext)
+{
+    struct oes_vlan_port_stage *port_p;
+    oes_status_e                status = OES_STATUS_SUCCESS;
+
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || (log_port >= OES_MAX_PORTS)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    switch (access_cmd) {
+    case OES_ACCESS_CMD_ADD:
+        if (!oes_vlan_vid_valid(pvid)) {
+            return OES_STATUS_PARAM_ERROR;
+        }
+        break;
+    case OES_ACCESS_CMD_DELETE:
+        break;
+    default:
+        return OES_STATUS_CMD_UNSUPPORTED;
+    }
+
+    pthread_rwlock_wrlock(&oes_vlan_lock);
+    port_p = oes_vlan_port_stage_get(br_id, log_port, access_cmd == OES_ACCESS_CMD_ADD);
+    if (!port_p) {
+        status = (access_cmd == OES_ACCESS_CMD_ADD) ? OES_STATUS_NO_MEMORY : OES_STATUS_SUCCESS;
+        goto out;
+    }
+    if (access_cmd == OES_ACCESS_CMD_ADD) {
+        port_p->pvid_cfg = pvid;
+        port_p->pvid = pvid;
+    } else {
+        port_p->pvid_cfg = 0;
+        port_p->pvid = oes_vlan_bridges[br_id]->default_vid;
+    }
+out:
+    pthread_rwlock_unlock(&oes_vlan_lock);
+    return status;
+}
+
+/**
+ * This function retrieves port's default VLAN ID.
+ *
+ * @param[in] br_id - bridge ID
+ * @param[in] log_port - logical port number
+ * @param[out] pvid_p - Port VLAN ID
+ * @param[in,out] port_pvid_vs_ext - port pvid vendor extension pointer
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_ERROR - Unexpected SDK error
+ */
+oes_status_e
+oes_api_vlan_port_pvid_get(const int br_id,
+                           const unsigned long log_port,
+                           unsigned short *pvid_p,
+                           void *port_pvid_vs_ext)
+{
+    struct oes_vlan_port_stage port;
+
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || (log_port >= OES_MAX_PORTS) || !pvid_p) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    oes_vlan_port_stage_read(br_id, log_port, &port);
+    *pvid_p = port.pvid;
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * This function sets port's accepted frame types.
+ *
+ * @param[in] br_id - bridge ID
+ * @param[in] log_port - logical port number
+ * @param[in] accptd_frm_types - allow_tagged, allow_untagged, allow_prio_tagged
+ * @param[in,out] accptd_frm_types_vs_ext - accepted frame types vendor extension pointer
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_NO_MEMORY - the bridge could not be allocated
+ */
+oes_status_e
+oes_api_vlan_port_accptd_frm_types_set(const int br_id,
+                                       const unsigned long log_port,
+                                       const enum oes_vlan_frame_types accptd_frm_types,
+                                       void *accptd_frm_types_vs_ext)
+{
+    struct oes_vlan_port_stage *port_p;
+    oes_status_e                status = OES_STATUS_SUCCESS;
+
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || (log_port >= OES_MAX_PORTS) ||
+        ((unsigned int)accptd_frm_types > OES_VLAN_FRAME_TYPES_ALLOW_ALL)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_rwlock_wrlock(&oes_vlan_lock);
+    port_p = oes_vlan_port_stage_get(br_id, log_port, 1);
+    if (port_p) {
+        port_p->frame_types = accptd_frm_types;
+    } else {
+        status = OES_STATUS_NO_MEMORY;
+    }
+    pthread_rwlock_unlock(&oes_vlan_lock);
+    return status;
+}
+
+/**
+ * This function retrieves port's accepted frame types.
+ *
+ * @param[in] br_id - bridge ID
+ * @param[in] log_port - logical port number
+ * @param[out] accptd_frm_types_p - the accepted frame types
+ * @param[in,out] accptd_frm_types_vs_ext - accepted frame types vendor extension pointer
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_ERROR - Unexpected SDK error
+ */
+oes_status_e
+oes_api_vlan_port_accptd_frm_types_get(const int br_id,
+                                       const unsigned long log_port,
+                                       enum oes_vlan_frame_types *accptd_frm_types_p,
+                                       void *accptd_frm_types_vs_ext)
+{
+    struct oes_vlan_port_stage port;
+
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || (log_port >= OES_MAX_PORTS) || !accptd_frm_types_p) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    oes_vlan_port_stage_read(br_id, log_port, &port);
+    *accptd_frm_types_p = port.frame_types;
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * This function sets the virtual switch default VLAN ID.
+ *
+ * @param[in] br_id - bridge  ID
+ * @param[in] default_vid - switch default VLAN id
+ * @param[in,out] default_vid_vs_ext - default VID vendor extension pointer
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_NO_MEMORY - the bridge could not be allocated
+ */
+oes_status_e
+oes_api_vlan_default_vid_set(const int br_id,
+                             const unsigned short default_vid,
+                             void *default_vid_vs_ext)
+{
+    struct oes_vlan_bridge *br_p;
+    oes_status_e            status = OES_STATUS_SUCCESS;
+    unsigned int            port;
+
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || !oes_vlan_vid_valid(default_vid)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_rwlock_wrlock(&oes_vlan_lock);
+    br_p = oes_vlan_bridge_get(br_id, 1);
+    if (!br_p) {
+        status = OES_STATUS_NO_MEMORY;
+        goto out;
+    }
+    br_p->default_vid = default_vid;
+    for (port = 0; port < OES_MAX_PORTS; port++) {
+        if (!br_p->stage[port].pvid_cfg) {
+            br_p->stage[port].pvid = default_vid;
+        }
+    }
+out:
+    pthread_rwlock_unlock(&oes_vlan_lock);
+    return status;
+}
+
+/**
+ * This function reads the virtual switch default VLAN ID.
+ *
+ * @param[in] br_id - bridge ID
+ * @param[out] default_vid_p - switch default VLAN id
+ * @param[in,out] default_vid_vs_ext - default VID vendor extension pointer
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_ERROR - Unexpected SDK error
+ */
+oes_status_e
+oes_api_vlan_default_vid_get(const int br_id,
+                             unsigned short *default_vid_p,
+                             void *default_vid_vs_ext)
+{
+    struct oes_vlan_bridge *br_p;
+
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || !default_vid_p) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_rwlock_rdlock(&oes_vlan_lock);
+    br_p = oes_vlan_bridge_get(br_id, 0);
+    *default_vid_p = br_p ? br_p->default_vid : OES_VLAN_DEFAULT_VID;
+    pthread_rwlock_unlock(&oes_vlan_lock);
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * This function set flood mode to flood or prune bridged packets. A
+ * pruned flood type floods to no port.
+ *
+ * @param[in] br_id - bridge ID
+ * @param[in] vid - filtering DB id
+ * @param[in] flood_type - unknown_uc/ unreg_mc/broadcast
+ * @param[in] flood_cmd - flood/ prune
+ * @param[in,out] vlan_flood_vs_ext - vlan flood vendor extension pointer
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_ERROR - Unexpected SDK error
+ */
+oes_status_e
+oes_api_vlan_flood_mode_set(const int br_id,
+                            const unsigned short vid,
+                            const enum oes_vlan_flood_type flood_type,
+                            const enum oes_vlan_flood_cmd flood_cmd,
+                            void *vlan_flood_vs_ext)
+{
+    unsigned long long      vids[OES_VLAN_VID_WORDS];
+    struct oes_vlan_bridge *br_p;
+    oes_status_e            status = OES_STATUS_SUCCESS;
+
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || !oes_vlan_vid_valid(vid) ||
+        ((unsigned int)flood_type >= OES_VLAN_FLOOD_TYPES) || ((unsigned int)flood_cmd > OES_VLAN_FLOOD_CMD_PRUNE)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_rwlock_wrlock(&oes_vlan_lock);
+    br_p = oes_vlan_bridge_get(br_id, 1);
+    if (!br_p) {
+        status = OES_STATUS_NO_MEMORY;
+        goto out;
+    }
+    if (flood_cmd == OES_VLAN_FLOOD_CMD_PRUNE) {
+        br_p->flood.pruned[vid] |= 1 << flood_type;
+    } else {
+        br_p->flood.pruned[vid] &= ~(1 << flood_type);
+    }
+    memset(vids, 0, sizeof(vids));
+    OES_BITMAP_SET(vids, vid);
+    oes_vlan_flood_update(br_id, br_p, vids);
+out:
+    pthread_rwlock_unlock(&oes_vlan_lock);
+    return status;
+}
+
+/**
+ * This function get the vlan flood mode
+ *
+ * @param[in] br_id - bridge ID
+ * @param[in] vid - filtering DB id
+ * @param[in] flood_type - unknown_uc/ unreg_mc/broadcast
+ * @param[out] flood_cmd_p - pointer to return the command (flood/ prune)
+ * @param[in,out] vlan_flood_vs_ext - vlan flood vendor extension pointer
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_ERROR - Unexpected SDK error
+ */
+oes_status_e
+oes_api_vlan_flood_mode_get(const int br_id,
+                            const unsigned short vid,
+                            const enum oes_vlan_flood_type flood_type,
+                            enum oes_vlan_flood_cmd *flood_cmd_p,
+                            void *vlan_flood_vs_ext)
+{
+    struct oes_vlan_bridge *br_p;
+
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || !oes_vlan_vid_valid(vid) ||
+        ((unsigned int)flood_type >= OES_VLAN_FLOOD_TYPES) || !flood_cmd_p) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_rwlock_rdlock(&oes_vlan_lock);
+    br_p = oes_vlan_bridge_get(br_id, 0);
+    *flood_cmd_p = (br_p && (br_p->flood.pruned[vid] & (1 << flood_type))) ?
+                   OES_VLAN_FLOOD_CMD_PRUNE : OES_VLAN_FLOOD_CMD_FLOOD;
+    pthread_rwlock_unlock(&oes_vlan_lock);
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * This function set per vlan flood ports for unregistered MC, broadcast
+ * and unknown unicast. Floods leave through the member ports in the
+ * list only; an empty list floods to all members.
+ *
+ * @param[in] br_id - bridge ID
+ * @param[in] vid - filtering DB id
+ * @param[in] log_port_list_p - a pointer to a port list, port can be LAG or physical port.
+ * @param[in] port_cnt - sizeof port list
+ * @param[in,out] vlan_flood_vs_ext - vlan flood vendor extension pointer
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_ERROR - Unexpected SDK error
+ */
+oes_status_e
+oes_api_vlan_flood_ports_set(const int br_id,
+                             const unsigned short vid,
+                             const unsigned long *log_port_list_p,
+                             const unsigned short port_cnt,
+                             void *vlan_flood_vs_ext)
+{
+    unsigned long long      ports[OES_VLAN_PORT_WORDS], vids[OES_VLAN_VID_WORDS];
+    struct oes_vlan_bridge *br_p;
+    oes_status_e            status = OES_STATUS_SUCCESS;
+    unsigned int            i;
+
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || !oes_vlan_vid_valid(vid) ||
+        (port_cnt && !log_port_list_p)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    memset(ports, 0, sizeof(ports));
+    for (i = 0; i < port_cnt; i++) {
+        if (log_port_list_p[i] >= OES_MAX_PORTS) {
+            return OES_STATUS_PARAM_ERROR;
+        }
+        OES_BITMAP_SET(ports, log_port_list_p[i]);
+    }
+
+    pthread_rwlock_wrlock(&oes_vlan_lock);
+    br_p = oes_vlan_bridge_get(br_id, 1);
+    if (!br_p) {
+        status = OES_STATUS_NO_MEMORY;
+        goto out;
+    }
+    memcpy(br_p->flood.flood_ports[vid], ports, sizeof(ports));
+    if (port_cnt) {
+        OES_BITMAP_SET(br_p->flood.restricted, vid);
+    } else {
+        OES_BITMAP_CLR(br_p->flood.restricted, vid);
+    }
+    memset(vids, 0, sizeof(vids));
+    OES_BITMAP_SET(vids, vid);
+    oes_vlan_flood_update(br_id, br_p, vids);
+out:
+    pthread_rwlock_unlock(&oes_vlan_lock);
+    return status;
+}
+
+/**
+ * This function get per vlan flood ports
+ *
+ * @param[in] br_id - bridge ID
+ * @param[in] vid - filtering DB id
+ * @param[out] log_port_list_p - a pointer to a port list, port can be LAG or physical port.
+ *       If it is NULL, port_cnt_p is filled with the number of flood ports
+ * @param[in,out] port_cnt_p - in: size of the list, out: number of ports returned
+ * @param[in,out] vlan_flood_vs_ext - vlan flood vendor extension pointer
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_ERROR - Unexpected SDK error
+ */
+oes_status_e
+oes_api_vlan_flood_ports_get(const int br_id,
+                             const unsigned short vid,
+                             unsigned long *log_port_list_p,
+                             unsigned short *port_cnt_p,
+                             void *vlan_flood_vs_ext)
+{
+    struct oes_vlan_bridge *br_p;
+    unsigned long long      bits;
+    unsigned int            w, cnt = 0;
+
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || !oes_vlan_vid_valid(vid) || !port_cnt_p) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_rwlock_rdlock(&oes_vlan_lock);
+    br_p = oes_vlan_bridge_get(br_id, 0);
+    for (w = 0; br_p && (w < OES_VLAN_PORT_WORDS); w++) {
+        if (!log_port_list_p) {
+            cnt += __builtin_popcountll(br_p->flood.flood_ports[vid][w]);
+            continue;
+        }
+        for (bits = br_p->flood.flood_ports[vid][w]; bits && (cnt < *port_cnt_p); bits &= bits - 1) {
+            log_port_list_p[cnt++] = w * OES_BITMAP_WORD_BITS + __builtin_ctzll(bits);
+        }
+    }
+    *port_cnt_p = cnt;
+    pthread_rwlock_unlock(&oes_vlan_lock);
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * This function set Q-in-Q mode of port
+ *
+ * @param[in] br_id - bridge ID
+ * @param[in] log_port - logical port id
+ * @param[in] qinq_mode - mode: Q-in-Q enabled/disabled
+ * @param[in,out] qinq_mode_vs_ext - qinq mode vendor extension pointer
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_NO_MEMORY - the bridge could not be allocated
+ */
+oes_status_e
+oes_api_vlan_qinq_mode_set(const int br_id,
+                           const unsigned long log_port,
+                           const enum oes_qinq_mode qinq_mode,
+                           void *qinq_mode_vs_ext)
+{
+    struct oes_vlan_port_stage *port_p;
+    oes_status_e                status = OES_STATUS_SUCCESS;
+
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || (log_port >= OES_MAX_PORTS) ||
+        ((unsigned int)qinq_mode > OES_QINQ_MODE_ENABLED)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_rwlock_wrlock(&oes_vlan_lock);
+    port_p = oes_vlan_port_stage_get(br_id, log_port, 1);
+    if (port_p) {
+        port_p->qinq = qinq_mode;
+    } else {
+        status = OES_STATUS_NO_MEMORY;
+    }
+    pthread_rwlock_unlock(&oes_vlan_lock);
+    return status;
+}
+
+/**
+ * This function retrieves Q-in-Q mode of port
+ *
+ * @param[in] br_id - bridge ID
+ * @param[in] log_port - logical port id
+ * @param[out] qinq_mode_p - the retrieved mode
+ * @param[in,out] qinq_mode_vs_ext - qinq mode vendor extension pointer
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_ERROR - Unexpected SDK error
+ */
+oes_status_e
+oes_api_vlan_qinq_mode_get(const int br_id,
+                           const unsigned long log_port,
+                           enum oes_qinq_mode *qinq_mode_p,
+                           void *qinq_mode_vs_ext)
+{
+    struct oes_vlan_port_stage port;
+
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || (log_port >= OES_MAX_PORTS) || !qinq_mode_p) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    oes_vlan_port_stage_read(br_id, log_port, &port);
+    *qinq_mode_p = port.qinq;
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * The function sets which priority should be taken for the outer tag
+ * (when Q-in-Q is enabled): the port's default priority, or the inner
+ * tag's priority
+ *
+ * @param[in] br_id - bridge ID
+ * @param[in] log_port - logical port id
+ * @param[in] prio_mode - mode: default/inner priority
+ * @param[in,out] qinq_prio_mode_vs_ext - qinq prio mode vendor extension pointer
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_NO_MEMORY - the bridge could not be allocated
+ */
+oes_status_e
+oes_api_vlan_qinq_outer_prio_mode_set(const int br_id,
+                                      const unsigned long log_port,
+                                      const enum oes_qinq_outer_prio_mode prio_mode,
+                                      void *qinq_prio_mode_vs_ext)
+{
+    struct oes_vlan_port_stage *port_p;
+    oes_status_e                status = OES_STATUS_SUCCESS;
+
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || (log_port >= OES_MAX_PORTS) ||
+        ((unsigned int)prio_mode > OES_QINQ_OUTER_PRIO_MODE_INNER)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_rwlock_wrlock(&oes_vlan_lock);
+    port_p = oes_vlan_port_stage_get(br_id, log_port, 1);
+    if (port_p) {
+        port_p->outer_prio = prio_mode;
+    } else {
+        status = OES_STATUS_NO_MEMORY;
+    }
+    pthread_rwlock_unlock(&oes_vlan_lock);
+    return status;
+}
+
+/**
+ * This function retrieves port's Q-in-Q outer tag priority mode
+ *
+ * @param[in] br_id - bridge ID
+ * @param[in] log_port - logical port id
+ * @param[out] qinq_prio_mode_p - the retrieved mode
+ * @param[in,out] qinq_prio_mode_vs_ext - qinq prio mode vendor extension pointer
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_ERROR - Unexpected SDK error
+ */
+oes_status_e
+oes_api_vlan_qinq_outer_prio_mode_get(const int br_id,
+                                      const unsigned long log_port,
+                                      enum oes_qinq_outer_prio_mode *qinq_prio_mode_p,
+                                      void *qinq_prio_mode_vs_ext)
+{
+    struct oes_vlan_port_stage port;
+
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || (log_port >= OES_MAX_PORTS) || !qinq_prio_mode_p) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    oes_vlan_port_stage_read(br_id, log_port, &port);
+    *qinq_prio_mode_p = port.outer_prio;
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * This function runs the VLAN ingress stage on a burst of frames
+ * received on the bridge. Each frame is classified to a VLAN and
+ * priority by its first tag and the PVID, accepted frame types, ingress
+ * filter and Q-in-Q settings of its port. The tag of a frame that is
+ * not dropped is popped in place, except on Q-in-Q ports, where all
+ * frames go to the PVID with their tags kept. Frames not dropped are
+ * counted in the rx counters of their VLAN.
+ *
+ * @param[in] br_id - bridge ID
+ * @param[in,out] pkt_list_p - frames: data, len, headroom and ingress
+ *       log_port in, vid, pcp and drop reason out
+ * @param[in] pkt_cnt - number of frames
+ * @param[in,out] vlan_stage_vs_ext - vlan stage vendor extension pointer
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ */
+oes_status_e
+oes_api_vlan_ingress_batch(const int br_id,
+                           struct oes_vlan_pkt *pkt_list_p,
+                           const unsigned int pkt_cnt,
+                           void *vlan_stage_vs_ext)
+{
+    struct oes_vlan_port_stage defaults[OES_MAX_PORTS];
+    struct oes_vlan_bridge    *br_p;
+    unsigned int               i;
+
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || (pkt_cnt && !pkt_list_p)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    for (i = 0; i < pkt_cnt; i++) {
+        if (!pkt_list_p[i].data || (pkt_list_p[i].log_port >= OES_MAX_PORTS)) {
+            return OES_STATUS_PARAM_ERROR;
+        }
+    }
+
+    pthread_rwlock_rdlock(&oes_vlan_lock);
+    br_p = oes_vlan_bridges[br_id];
+    if (br_p) {
+        oes_vlan_ingress_bulk(br_id, br_p->stage, &br_p->members, pkt_list_p, pkt_cnt);
+    } else {
+        for (i = 0; i < OES_MAX_PORTS; i++) {
+            oes_vlan_port_stage_init(&defaults[i], OES_VLAN_DEFAULT_VID);
+        }
+        oes_vlan_ingress_bulk(br_id, defaults, &oes_vlan_members_none, pkt_list_p, pkt_cnt);
+    }
+    pthread_rwlock_unlock(&oes_vlan_lock);
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * This function runs the VLAN egress stage on a burst of frames,
+ * untagged as the ingress stage leaves them. A frame whose egress port
+ * is not a member of its VLAN is dropped; one leaving through a tagged
+ * or priority tagged member gets a tag pushed in place, into its
+ * headroom. Frames sent are counted in the tx counters of their VLAN.
+ *
+ * @param[in] br_id - bridge ID
+ * @param[in,out] pkt_list_p - frames: data, len, headroom, egress
+ *       log_port, vid and pcp in, drop reason out
+ * @param[in] pkt_cnt - number of frames
+ * @param[in,out] vlan_stage_vs_ext - vlan stage vendor extension pointer
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ */
+oes_status_e
+oes_api_vlan_egress_batch(const int br_id,
+                          struct oes_vlan_pkt *pkt_list_p,
+                          const unsigned int pkt_cnt,
+                          void *vlan_stage_vs_ext)
+{
+    struct oes_vlan_bridge *br_p;
+    unsigned int            i;
+
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || (pkt_cnt && !pkt_list_p)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    for (i = 0; i < pkt_cnt; i++) {
+        if (!pkt_list_p[i].data || (pkt_list_p[i].log_port >= OES_MAX_PORTS) ||
+            (pkt_list_p[i].vid >= OES_MAX_VLANS) || (pkt_list_p[i].pcp > 7)) {
+            return OES_STATUS_PARAM_ERROR;
+        }
+    }
+
+    pthread_rwlock_rdlock(&oes_vlan_lock);
+    br_p = oes_vlan_bridges[br_id];
+    oes_vlan_egress_bulk(br_id, br_p ? &br_p->members : &oes_vlan_members_none, pkt_list_p, pkt_cnt);
+    pthread_rwlock_unlock(&oes_vlan_lock);
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * This function reads the counters of a VLAN. READ_CLEAR returns the
+ * counts since the previous clear and restarts them; traffic counted
+ * meanwhile is returned by exactly one read.
+ *
+ * @param[in] access_cmd - READ / READ_CLEAR
+ * @param[in] br_id - bridge ID
+ * @param[in] vid - VLAN id
+ * @param[out] cntr_p - VLAN counters
+ * @param[in,out] vlan_cntr_vs_ext - vlan counter vendor extension pointer
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_CMD_UNSUPPORTED if access command isn't supported
+ * @return OES_STATUS_NO_MEMORY - the counter bases could not be allocated
+ */
+oes_status_e
+oes_api_vlan_cntr_get(const enum oes_access_cmd access_cmd,
+                      const int br_id,
+                      const unsigned short vid,
+                      struct oes_vlan_cntr *cntr_p,
+                      void *vlan_cntr_vs_ext)
+{
+    unsigned long long sums[OES_VLAN_CNTR_FIELDS], values[OES_VLAN_CNTR_FIELDS], *base_p;
+    oes_status_e       status = OES_STATUS_SUCCESS;
+    unsigned int       i;
+
+    if ((access_cmd != OES_ACCESS_CMD_READ) && (access_cmd != OES_ACCESS_CMD_READ_CLEAR)) {
+        return OES_STATUS_CMD_UNSUPPORTED;
+    }
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || !oes_vlan_vid_valid(vid) || !cntr_p) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    /* a clear moves the base, serialize it with other readers */
+    if (access_cmd == OES_ACCESS_CMD_READ_CLEAR) {
+        pthread_rwlock_wrlock(&oes_vlan_cntr_lock);
+    } else {
+        pthread_rwlock_rdlock(&oes_vlan_cntr_lock);
+    }
+    base_p = oes_vlan_cntr_bases_get(br_id, access_cmd == OES_ACCESS_CMD_READ_CLEAR);
+    if (!base_p && (access_cmd == OES_ACCESS_CMD_READ_CLEAR)) {
+        status = OES_STATUS_NO_MEMORY;
+        goto out;
+    }
+    oes_vlan_cntr_sum(br_id, vid, sums);
+    for (i = 0; i < OES_VLAN_CNTR_FIELDS; i++) {
+        values[i] = sums[i] - (base_p ? base_p[vid * OES_VLAN_CNTR_FIELDS + i] : 0);
+    }
+    if (access_cmd == OES_ACCESS_CMD_READ_CLEAR) {
+        memcpy(&base_p[vid * OES_VLAN_CNTR_FIELDS], sums, sizeof(sums));
+    }
+    memcpy(cntr_p, values, sizeof(*cntr_p));
+out:
+    pthread_rwlock_unlock(&oes_vlan_cntr_lock);
+    return status;
+}
+
+/**
+ * This function reads the counters of all VLANs of a bridge in one
+ * pass, into a dense array indexed by VID. READ_CLEAR clears them all
+ * at once, as oes_api_vlan_cntr_get does for one VLAN.
+ *
+ * @param[in] access_cmd - READ / READ_CLEAR
+ * @param[in] br_id - bridge ID
+ * @param[out] cntr_list_p - OES_MAX_VLANS VLAN counters, by VID
+ * @param[in,out] vlan_cntr_vs_ext - vlan counter vendor extension pointer
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_CMD_UNSUPPORTED if access command isn't supported
+ * @return OES_STATUS_NO_MEMORY - the counter bases could not be allocated
+ */
+oes_status_e
+oes_api_vlan_cntr_bulk_get(const enum oes_access_cmd access_cmd,
+                           const int br_id,
+                           struct oes_vlan_cntr *cntr_list_p,
+                           void *vlan_cntr_vs_ext)
+{
+    unsigned long long *values = (unsigned long long *)cntr_list_p, *base_p;
+    oes_status_e        status = OES_STATUS_SUCCESS;
+    unsigned int        i;
+
+    if ((access_cmd != OES_ACCESS_CMD_READ) && (access_cmd != OES_ACCESS_CMD_READ_CLEAR)) {
+        return OES_STATUS_CMD_UNSUPPORTED;
+    }
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || !cntr_list_p) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    if (access_cmd == OES_ACCESS_CMD_READ_CLEAR) {
+        pthread_rwlock_wrlock(&oes_vlan_cntr_lock);
+    } else {
+        pthread_rwlock_rdlock(&oes_vlan_cntr_lock);
+    }
+    base_p = oes_vlan_cntr_bases_get(br_id, access_cmd == OES_ACCESS_CMD_READ_CLEAR);
+    if (!base_p && (access_cmd == OES_ACCESS_CMD_READ_CLEAR)) {
+        status = OES_STATUS_NO_MEMORY;
+        goto out;
+    }
+    oes_vlan_cntr_sum_all(br_id, values);
+    if (base_p) {
+        /* values turn from sums to counts, the base of a clear back to the sums */
+        for (i = 0; i < OES_MAX_VLANS * OES_VLAN_CNTR_FIELDS; i++) {
+            values[i] -= base_p[i];
+        }
+        if (access_cmd == OES_ACCESS_CMD_READ_CLEAR) {
+            for (i = 0; i < OES_MAX_VLANS * OES_VLAN_CNTR_FIELDS; i++) {
+                base_p[i] += values[i];
+            }
+        }
+    }
+out:
+    pthread_rwlock_unlock(&oes_vlan_cntr_lock);
+    return status;
+}
+
+/**
+ * This function counts traffic of the software forwarding path on a
+ * VLAN, floods in particular; the VLAN stage counts rx and tx itself.
+ * It takes no lock and no shared atomic: each thread counts into its
+ * own cache line aligned counter blocks, summed on read.
+ *
+ * @param[in] br_id - bridge ID
+ * @param[in] vid - VLAN id
+ * @param[in] cntr_type - rx, tx or flood
+ * @param[in] packets - packets to count
+ * @param[in] bytes - bytes to count
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ */
+oes_status_e
+oes_api_vlan_cntr_count(const int br_id,
+                        const unsigned short vid,
+                        const enum oes_vlan_cntr_type cntr_type,
+                        const unsigned int packets,
+                        const unsigned long long bytes)
+{
+    struct oes_vlan_cntr_block **chunks_p;
+
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || !oes_vlan_vid_valid(vid) ||
+        ((cntr_type != OES_VLAN_CNTR_RX) && (cntr_type != OES_VLAN_CNTR_TX) &&
+         (cntr_type != OES_VLAN_CNTR_FLOOD))) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    chunks_p = oes_vlan_cntr_chunks(br_id);
+    oes_vlan_cntr_add(&chunks_p, br_id, vid, cntr_type, packets, bytes);
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * This function returns the ports a flood of a VLAN and flood type
+ * leaves through, a copy of the precomputed set.
+ *
+ * @param[in] br_id - bridge ID
+ * @param[in] vid - VLAN id
+ * @param[in] flood_type - unknown_uc/ unreg_mc/broadcast
+ * @param[out] ports - port bitmap of OES_BITMAP_WORDS(OES_MAX_PORTS) words
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ */
+oes_status_e
+oes_vlan_flood_lookup(const int br_id,
+                      const unsigned short vid,
+                      const enum oes_vlan_flood_type flood_type,
+                      unsigned long long *ports)
+{
+    struct oes_vlan_bridge *br_p;
+
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || (vid >= OES_MAX_VLANS) ||
+        ((unsigned int)flood_type >= OES_VLAN_FLOOD_TYPES)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_rwlock_rdlock(&oes_vlan_lock);
+    br_p = oes_vlan_bridges[br_id];
+    if (br_p) {
+        memcpy(ports, oes_vlan_flood_set(&br_p->flood, vid, flood_type), OES_VLAN_PORT_WORDS * sizeof(*ports));
+    } else {
+        memset(ports, 0, OES_VLAN_PORT_WORDS * sizeof(*ports));
+    }
+    pthread_rwlock_unlock(&oes_vlan_lock);
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * This function recomputes the flood sets of VLANs after a change of
+ * their spanning tree state.
+ *
+ * @param[in] br_id - bridge ID
+ * @param[in] vids - bitmap of the VLANs, OES_BITMAP_WORDS(OES_MAX_VLANS) words
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ */
+oes_status_e
+oes_vlan_flood_vids_refresh(const int br_id,
+                            const unsigned long long *vids)
+{
+    struct oes_vlan_bridge *br_p;
+
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || !vids) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_rwlock_wrlock(&oes_vlan_lock);
+    br_p = oes_vlan_bridge_get(br_id, 0);
+    if (br_p) {
+        oes_vlan_flood_update(br_id, br_p, vids);
+    }
+    pthread_rwlock_unlock(&oes_vlan_lock);
+    return OES_STATUS_SUCCESS;
+}
+
+/**
+ * This function recomputes the flood sets of the VLANs of ports after a
+ * change of their LAG state.
+ *
+ * @param[in] br_id - bridge ID
+ * @param[in] ports - bitmap of the ports, OES_BITMAP_WORDS(OES_MAX_PORTS) words
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ */
+oes_status_e
+oes_vlan_flood_ports_refresh(const int br_id,
+                             const unsigned long long *ports)
+{
+    unsigned long long      vids[OES_VLAN_VID_WORDS], bits;
+    struct oes_vlan_bridge *br_p;
+    unsigned int            w, v, port;
+
+    if ((br_id < 0) || (br_id >= OES_VLAN_MAX_BRIDGES) || !ports) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+
+    pthread_rwlock_wrlock(&oes_vlan_lock);
+    br_p = oes_vlan_bridge_get(br_id, 0);
+    if (br_p) {
+        memset(vids, 0, sizeof(vids));
+        for (w = 0; w < OES_VLAN_PORT_WORDS; w++) {
+            for (bits = ports[w]; bits; bits &= bits - 1) {
+                port = w * OES_BITMAP_WORD_BITS + __builtin_ctzll(bits);
+                for (v = 0; v < OES_VLAN_VID_WORDS; v++) {
+                    vids[v] |= br_p->members.port_vlans[port][v];
+                }
+            }
+        }
+        oes_vlan_flood_update(br_id, br_p, vids);
+    }
+    pthread_rwlock_unlock(&oes_vlan_lock);
+    return OES_STATUS_SUCCESS;
+}
@@ -142,6 +142,40 @@ oes_api_vlan_port_multi_vlan_set(
                                 void * vlan_list_vs_ext
                                 );
 
+/**
+*  This function adds ports to, or removes them from, every VLAN
+*  of the range vid_first to vid_last in a single command, e.g. a
+*  trunk port carrying VLANs 2-4094.
+*  
+* @param[in] access_cmd -  OES_ACCESS_CMD_ADD - Add the ports to
+*                          the VLANs OES_ACCESS_CMD_DELETE - Remove
+*                          the ports from the VLANs
+* @param[in] br_id - bridge ID 
+* @param[in] vid_first - first VLAN id of the range
+* @param[in] vid_last - last VLAN id of the range
+* @param[in] vlan_port_list_p - a pointer to array of port list 
+*       structure, as in oes_api_vlan_ports_set. The tagging is
+*       ignored by delete
+* @param[in] port_cnt - number of ports in a port list 
+* @param[in,out] vlan_range_vs_ext - vlan range vendor extension
+*       pointer
+* 
+* @return OES_STATUS_SUCCESS if operation completes successfully
+* @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+* @return OES_STATUS_CMD_UNSUPPORTED - access_cmd is not supported
+* @return OES_STATUS_NO_MEMORY - the bridge could not be allocated
+*/
+oes_status_e 
+oes_api_vlan_ports_range_set(
+                            const enum oes_access_cmd access_cmd,
+                            const int br_id, 
+                            const unsigned short vid_first,
+                            const unsigned short vid_last,
+                            const struct oes_vlan_port * vlan_port_list_p,
+                            const unsigned short port_cnt,
+                            void * vlan_range_vs_ext
+                            );
+
 /**
 * This function enables/ disables ingress VLAN filtering on 
 *   port. The VLAN membership is defined in oes_vlan_ports_set
@@ -327,7 +361,7 @@ oes_api_vlan_default_vid_get(
 
 /**
  *  This function set flood mode to flood or proon
- *  bridged packets
+ *  bridged packets. A pruned flood type floods to no port
  *  
  * @param[in] br_id - bridge ID 
  * @param[in] vid 	- filtering DB id
@@ -375,7 +409,8 @@ oes_api_vlan_flood_mode_get(
 
 /**
 *   This function set per vlan flood ports for unregistered MC
-*   broadcast and unknown unicast
+*   broadcast and unknown unicast. Floods leave through the member
+*   ports in the list only; an empty list floods to all members
  *  
  * @param[in] br_id - bridge ID 
 *  @param[in] vid 	- filtering DB id
@@ -506,6 +541,201 @@ oes_api_vlan_qinq_outer_prio_mode_get(
                                      void * qinq_prio_mode_vs_ext
                                      );
 
+/**
+ *  This function runs the VLAN ingress stage on a burst of 
+ *  frames received on the bridge. Each frame is classified to a
+ *  VLAN and priority by its first tag and the PVID, accepted
+ *  frame types, ingress filter and Q-in-Q settings of its port.
+ *  The tag of a frame that is not dropped is popped in place,
+ *  except on Q-in-Q ports, where all frames go to the PVID with
+ *  their tags kept. Frames not dropped are counted in the rx
+ *  counters of their VLAN.
+ *
+ * @param[in] br_id - bridge ID 
+ * @param[in,out] pkt_list_p - frames: data, len, headroom and 
+ *       ingress log_port in, vid, pcp and drop reason out
+ * @param[in] pkt_cnt - number of frames
+ * @param[in,out] vlan_stage_vs_ext - vlan stage vendor extension
+ *       pointer
+ * 
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ */
+oes_status_e
+oes_api_vlan_ingress_batch(
+                          const int br_id, 
+                          struct oes_vlan_pkt * pkt_list_p,
+                          const unsigned int pkt_cnt,
+                          void * vlan_stage_vs_ext
+                          );
+
+/**
+ *  This function runs the VLAN egress stage on a burst of 
+ *  frames, untagged as the ingress stage leaves them. A frame 
+ *  whose egress port is not a member of its VLAN is dropped;
+ *  one leaving through a tagged or priority tagged member gets
+ *  a tag pushed in place, into its headroom. Frames sent are 
+ *  counted in the tx counters of their VLAN.
+ *
+ * @param[in] br_id - bridge ID 
+ * @param[in,out] pkt_list_p - frames: data, len, headroom, 
+ *       egress log_port, vid and pcp in, drop reason out
+ * @param[in] pkt_cnt - number of frames
+ * @param[in,out] vlan_stage_vs_ext - vlan stage vendor extension
+ *       pointer
+ * 
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ */
+oes_status_e
+oes_api_vlan_egress_batch(
+                         const int br_id, 
+                         struct oes_vlan_pkt * pkt_list_p,
+                         const unsigned int pkt_cnt,
+                         void * vlan_stage_vs_ext
+                         );
+
+/**
+ *  This function reads the counters of a VLAN. READ_CLEAR 
+ *  returns the counts since the previous clear and restarts 
+ *  them; traffic counted meanwhile is returned by exactly one 
+ *  read.
+ *
+ * @param[in] access_cmd - READ / READ_CLEAR
+ * @param[in] br_id - bridge ID 
+ * @param[in] vid - VLAN id
+ * @param[out] cntr_p - VLAN counters
+ * @param[in,out] vlan_cntr_vs_ext - vlan counter vendor 
+ *       extension pointer
+ * 
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_CMD_UNSUPPORTED if access command isn't 
+ *         supported
+ * @return OES_STATUS_NO_MEMORY - the counter bases could not be 
+ *         allocated
+ */
+oes_status_e
+oes_api_vlan_cntr_get(
+                     const enum oes_access_cmd access_cmd,
+                     const int br_id, 
+                     const unsigned short vid,
+                     struct oes_vlan_cntr * cntr_p,
+                     void * vlan_cntr_vs_ext
+                     );
+
+/**
+ *  This function reads the counters of all VLANs of a bridge 
+ *  in one pass, into a dense array indexed by VID. READ_CLEAR 
+ *  clears them all at once, as oes_api_vlan_cntr_get does for 
+ *  one VLAN.
+ *
+ * @param[in] access_cmd - READ / READ_CLEAR
+ * @param[in] br_id - bridge ID 
+ * @param[out] cntr_list_p - OES_MAX_VLANS VLAN counters, by VID
+ * @param[in,out] vlan_cntr_vs_ext - vlan counter vendor 
+ *       extension pointer
+ * 
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_CMD_UNSUPPORTED if access command isn't 
+ *         supported
+ * @return OES_STATUS_NO_MEMORY - the counter bases could not be 
+ *         allocated
+ */
+oes_status_e
+oes_api_vlan_cntr_bulk_get(
+                          const enum oes_access_cmd access_cmd,
+                          const int br_id, 
+                          struct oes_vlan_cntr * cntr_list_p,
+                          void * vlan_cntr_vs_ext
+                          );
+
+/**
+ *  This function counts traffic of the software forwarding path
+ *  on a VLAN, floods in particular; the VLAN stage counts rx and
+ *  tx itself. It takes no lock and no shared atomic: each thread
+ *  counts into its own cache line aligned counter blocks, summed
+ *  on read.
+ *
+ * @param[in] br_id - bridge ID 
+ * @param[in] vid - VLAN id
+ * @param[in] cntr_type - rx, tx or flood
+ * @param[in] packets - packets to count
+ * @param[in] bytes - bytes to count
+ * 
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ */
+oes_status_e
+oes_api_vlan_cntr_count(
+                       const int br_id, 
+                       const unsigned short vid,
+                       const enum oes_vlan_cntr_type cntr_type,
+                       const unsigned int packets,
+                       const unsigned long long bytes
+                       );
+
+/**
+ *  This function returns the ports a flood of a VLAN and flood
+ *  type leaves through, a precomputed set of the members allowed
+ *  by the VLAN flood ports and flood mode, forwarding in the
+ *  VLAN's spanning tree instance, with one member per LAG. It
+ *  is called by the software forwarding path.
+ *
+ * @param[in] br_id - bridge ID 
+ * @param[in] vid - VLAN id
+ * @param[in] flood_type - unknown_uc/ unreg_mc/broadcast
+ * @param[out] ports - port bitmap of 
+ *       OES_BITMAP_WORDS(OES_MAX_PORTS) words
+ * 
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ */
+oes_status_e
+oes_vlan_flood_lookup(
+                     const int br_id, 
+                     const unsigned short vid,
+                     const enum oes_vlan_flood_type flood_type,
+                     unsigned long long * ports
+                     );
+
+/**
+ *  This function recomputes the flood sets of VLANs after a
+ *  change of their spanning tree state. It is called by the STP
+ *  module.
+ *
+ * @param[in] br_id - bridge ID 
+ * @param[in] vids - bitmap of the VLANs, 
+ *       OES_BITMAP_WORDS(OES_MAX_VLANS) words
+ * 
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ */
+oes_status_e
+oes_vlan_flood_vids_refresh(
+                           const int br_id, 
+                           const unsigned long long * vids
+                           );
+
+/**
+ *  This function recomputes the flood sets of the VLANs of 
+ *  ports after a change of their LAG state. It is called by the
+ *  LAG module.
+ *
+ * @param[in] br_id - bridge ID 
+ * @param[in] ports - bitmap of the ports, 
+ *       OES_BITMAP_WORDS(OES_MAX_PORTS) words
+ * 
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ */
+oes_status_e
+oes_vlan_flood_ports_refresh(
+                            const int br_id, 
+                            const unsigned long long * ports
+                            );
+
 
 #endif /* __OES_API_VLAN_H__ */
 
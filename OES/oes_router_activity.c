@@ -0,0 +1,85 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "oes_status.h"
+#include "oes_router_activity.h"
+
+oes_status_e
+oes_activity_resize(unsigned long long **bitmap_pp,
+                    unsigned int old_cnt,
+                    unsigned int new_cnt)
+{
+    unsigned long long *bitmap_p;
+    unsigned int        old_words = OES_ACTIVITY_WORDS(old_cnt);
+    unsigned int        new_words = OES_ACTIVITY_WORDS(new_cnt);
+
+    if (new_words == old_words) {
+        return OES_STATUS_SUCCESS;
+    }
+    bitmap_p = realloc(*bitmap_pp, new_words * sizeof(*bitmap_p));
+    if (bitmap_p == NULL) {
+        return OES_STATUS_NO_MEMORY;
+    }
+    if (new_words > old_words) {
+        memset(&bitmap_p[old_words], 0, (new_words - old_words) * sizeof(*bitmap_p));
+    }
+    *bitmap_pp = bitmap_p;
+    return OES_STATUS_SUCCESS;
+}
+
+unsigned int
+oes_activity_harvest(unsigned long long *bitmap_p,
+                     unsigned long long *snapshot_p,
+                     unsigned int cnt)
+{
+    unsigned int i, active = 0;
+
+    for (i = 0; i < OES_ACTIVITY_WORDS(cnt); i++) {
+        /* lookups may mark concurrently, whatever lands after the swap counts next time */
+        snapshot_p[i] = __atomic_load_n(&bitmap_p[i], __ATOMIC_RELAXED) ?
+                        __atomic_exchange_n(&bitmap_p[i], 0, __ATOMIC_RELAXED) : 0;
+        active += __builtin_popcountll(snapshot_p[i]);
+    }
+    return active;
+}
+
+void
+oes_activity_restore(unsigned long long *bitmap_p,
+                     const unsigned long long *snapshot_p,
+                     unsigned int cnt)
+{
+    unsigned int i;
+
+    for (i = 0; i < OES_ACTIVITY_WORDS(cnt); i++) {
+        if (snapshot_p[i]) {
+            __atomic_fetch_or(&bitmap_p[i], snapshot_p[i], __ATOMIC_RELAXED);
+        }
+    }
+}
@@ -0,0 +1,131 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef __OES_ROUTER_ACTIVITY_H__
+#define __OES_ROUTER_ACTIVITY_H__
+
+/************************************************
+ *  Activity bitmaps
+ *
+ *  One bit per table slot, set by the software lookup path while it
+ *  holds the table read lock and cleared by configuration, by
+ *  GET_ACTIVITY or by a harvest. Setting skips the atomic write once
+ *  the bit is set, so entries hit by many readers do not bounce their
+ *  cache line. A harvest swaps whole words out, 64 slots per access.
+ ***********************************************/
+
+#define OES_ACTIVITY_WORDS(cnt)       (((cnt) + 63) / 64)
+
+/**
+ * This function marks a slot active.
+ *
+ * @param[in] bitmap_p - activity bitmap
+ * @param[in] idx - slot
+ */
+static inline void
+oes_activity_mark(unsigned long long * bitmap_p,
+                  unsigned int idx)
+{
+    unsigned long long *word_p = &bitmap_p[idx / 64];
+    unsigned long long  bit = 1ULL << (idx % 64);
+
+    if (!(__atomic_load_n(word_p, __ATOMIC_RELAXED) & bit)) {
+        __atomic_fetch_or(word_p, bit, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * This function reads the activity of a slot, and clears it if asked.
+ *
+ * @param[in] bitmap_p - activity bitmap
+ * @param[in] idx - slot
+ * @param[in] clear - clear the activity
+ *
+ * @return 1 if the slot was active, 0 otherwise
+ */
+static inline int
+oes_activity_get(unsigned long long * bitmap_p,
+                 unsigned int idx,
+                 int clear)
+{
+    unsigned long long *word_p = &bitmap_p[idx / 64];
+    unsigned long long  bit = 1ULL << (idx % 64);
+
+    if (!(__atomic_load_n(word_p, __ATOMIC_RELAXED) & bit)) {
+        return 0;
+    }
+    if (clear) {
+        __atomic_fetch_and(word_p, ~bit, __ATOMIC_RELAXED);
+    }
+    return 1;
+}
+
+/**
+ * This function resizes a bitmap, slots past the old count start
+ * inactive.
+ *
+ * @param[in,out] bitmap_pp - activity bitmap, may be NULL when old_cnt is 0
+ * @param[in] old_cnt - current number of slots
+ * @param[in] new_cnt - new number of slots
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_NO_MEMORY if out of memory, the bitmap is unchanged
+ */
+oes_status_e
+oes_activity_resize(unsigned long long ** bitmap_pp,
+                    unsigned int old_cnt,
+                    unsigned int new_cnt);
+
+/**
+ * This function moves the activity of every slot into a snapshot and
+ * clears it.
+ *
+ * @param[in] bitmap_p - activity bitmap
+ * @param[out] snapshot_p - OES_ACTIVITY_WORDS(cnt) words
+ * @param[in] cnt - number of slots
+ *
+ * @return number of active slots in the snapshot
+ */
+unsigned int
+oes_activity_harvest(unsigned long long * bitmap_p,
+                     unsigned long long * snapshot_p,
+                     unsigned int cnt);
+
+/**
+ * This function puts the activity of a snapshot back, keeping any
+ * activity marked since the harvest.
+ *
+ * @param[in] bitmap_p - activity bitmap
+ * @param[in] snapshot_p - snapshot taken by oes_activity_harvest
+ * @param[in] cnt - number of slots
+ */
+void
+oes_activity_restore(unsigned long long * bitmap_p,
+                     const unsigned long long * snapshot_p,
+                     unsigned int cnt);
+
+#endif /* __OES_ROUTER_ACTIVITY_H__ */
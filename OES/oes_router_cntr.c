@@ -0,0 +1,145 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_router_cntr.h"
+
+__thread struct oes_cntr_slab * oes_cntr_slab_self;
+
+static pthread_mutex_t       oes_cntr_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct oes_cntr_slab *oes_cntr_slabs;
+static pthread_key_t         oes_cntr_key;
+static pthread_once_t        oes_cntr_once = PTHREAD_ONCE_INIT;
+
+/* thread exit, the slab keeps its counts for the next thread */
+static void
+oes_cntr_slab_release(void *slab_p)
+{
+    pthread_mutex_lock(&oes_cntr_lock);
+    ((struct oes_cntr_slab *)slab_p)->in_use = 0;
+    pthread_mutex_unlock(&oes_cntr_lock);
+}
+
+static void
+oes_cntr_key_create(void)
+{
+    pthread_key_create(&oes_cntr_key, oes_cntr_slab_release);
+}
+
+/* Gives the calling thread a released slab, or a new one. */
+static struct oes_cntr_slab *
+oes_cntr_slab_register(void)
+{
+    struct oes_cntr_slab *slab_p;
+
+    pthread_once(&oes_cntr_once, oes_cntr_key_create);
+    pthread_mutex_lock(&oes_cntr_lock);
+    for (slab_p = oes_cntr_slabs; (slab_p != NULL) && slab_p->in_use; slab_p = slab_p->next) {
+    }
+    if (slab_p == NULL) {
+        slab_p = calloc(1, sizeof(*slab_p));
+        if (slab_p == NULL) {
+            pthread_mutex_unlock(&oes_cntr_lock);
+            return NULL;
+        }
+        slab_p->next = oes_cntr_slabs;
+        oes_cntr_slabs = slab_p;
+    }
+    slab_p->in_use = 1;
+    pthread_mutex_unlock(&oes_cntr_lock);
+    pthread_setspecific(oes_cntr_key, slab_p);
+    oes_cntr_slab_self = slab_p;
+    return slab_p;
+}
+
+struct oes_cntr_block *
+oes_cntr_block_get(unsigned int vrid,
+                   unsigned int rif)
+{
+    struct oes_cntr_slab   *slab_p = oes_cntr_slab_self;
+    struct oes_cntr_block **chunks_p, *chunk_p;
+
+    if (slab_p == NULL) {
+        slab_p = oes_cntr_slab_register();
+        if (slab_p == NULL) {
+            return NULL;
+        }
+    }
+    chunks_p = slab_p->chunks[vrid];
+    if (chunks_p == NULL) {
+        chunks_p = calloc(OES_CNTR_MAX_RIFS / OES_CNTR_CHUNK, sizeof(*chunks_p));
+        if (chunks_p == NULL) {
+            return NULL;
+        }
+        /* readers walk the slab without the owner, publish initialized memory */
+        __atomic_store_n(&slab_p->chunks[vrid], chunks_p, __ATOMIC_RELEASE);
+    }
+    chunk_p = chunks_p[rif / OES_CNTR_CHUNK];
+    if (chunk_p == NULL) {
+        if (posix_memalign((void **)&chunk_p, sizeof(*chunk_p), OES_CNTR_CHUNK * sizeof(*chunk_p))) {
+            return NULL;
+        }
+        memset(chunk_p, 0, OES_CNTR_CHUNK * sizeof(*chunk_p));
+        __atomic_store_n(&chunks_p[rif / OES_CNTR_CHUNK], chunk_p, __ATOMIC_RELEASE);
+    }
+    return &chunk_p[rif % OES_CNTR_CHUNK];
+}
+
+void
+oes_cntr_sum(unsigned int vrid,
+             unsigned int rif,
+             unsigned long long *v)
+{
+    const struct oes_cntr_slab *slab_p;
+    struct oes_cntr_block     **chunks_p, *chunk_p;
+    unsigned int                i;
+
+    memset(v, 0, OES_CNTR_FIELDS * sizeof(*v));
+    pthread_mutex_lock(&oes_cntr_lock);
+    for (slab_p = oes_cntr_slabs; slab_p != NULL; slab_p = slab_p->next) {
+        chunks_p = __atomic_load_n(&slab_p->chunks[vrid], __ATOMIC_ACQUIRE);
+        if (chunks_p == NULL) {
+            continue;
+        }
+        chunk_p = __atomic_load_n(&chunks_p[rif / OES_CNTR_CHUNK], __ATOMIC_ACQUIRE);
+        if (chunk_p == NULL) {
+            continue;
+        }
+        for (i = 0; i < OES_CNTR_FIELDS; i++) {
+            v[i] += __atomic_load_n(&chunk_p[rif % OES_CNTR_CHUNK].v[i], __ATOMIC_RELAXED);
+        }
+    }
+    pthread_mutex_unlock(&oes_cntr_lock);
+}
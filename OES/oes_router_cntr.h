@@ -0,0 +1,126 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __OES_ROUTER_CNTR_H__
+#define __OES_ROUTER_CNTR_H__
+
+/************************************************
+ *  Router interface counters
+ *
+ *  Every thread that counts owns a slab, and only that thread writes
+ *  it: an increment is a plain load and store to its own cache line,
+ *  never a locked instruction. A slab holds one 64 byte block per
+ *  (vrid, rif), laid out like struct oes_router_cntr and allocated 64
+ *  blocks at a time on first use. Readers sum the blocks of all slabs.
+ *
+ *  Counters only grow, so read-and-clear is done by the reader keeping
+ *  the sum it cleared at as a base; an increment racing with a read is
+ *  either in that sum or in the next one, never lost or counted twice.
+ *  Slabs outlive their threads and are handed to the next thread that
+ *  registers, so sums never go back.
+ ***********************************************/
+
+#define OES_CNTR_MAX_VRIDS            1024
+#define OES_CNTR_MAX_RIFS             4096
+#define OES_CNTR_CHUNK                64          /**< blocks per allocation */
+#define OES_CNTR_FIELDS               8           /**< fields of struct oes_router_cntr */
+
+struct oes_cntr_block {
+    unsigned long long v[OES_CNTR_FIELDS];        /**< indexed by enum oes_router_cntr_type */
+} __attribute__((aligned(64)));
+
+struct oes_cntr_slab {
+    struct oes_cntr_block ** chunks[OES_CNTR_MAX_VRIDS]; /**< chunk table per vrid, NULL until used */
+    struct oes_cntr_slab   * next;                /**< all slabs */
+    int                      in_use;              /**< owned by a live thread */
+};
+
+extern __thread struct oes_cntr_slab * oes_cntr_slab_self;
+
+/**
+ * This function returns the block of the calling thread for a counter,
+ * registering the thread and allocating on first use.
+ *
+ * @param[in] vrid - virtual router, below OES_CNTR_MAX_VRIDS
+ * @param[in] rif - router interface, below OES_CNTR_MAX_RIFS
+ *
+ * @return block, or NULL if out of memory
+ */
+struct oes_cntr_block *
+oes_cntr_block_get(unsigned int vrid,
+                   unsigned int rif);
+
+/**
+ * This function counts traffic in the slab of the calling thread.
+ *
+ * @param[in] vrid - virtual router, below OES_CNTR_MAX_VRIDS
+ * @param[in] rif - router interface, below OES_CNTR_MAX_RIFS
+ * @param[in] type - direction and cast
+ * @param[in] packets - packets
+ * @param[in] bytes - bytes
+ */
+static inline void
+oes_cntr_add(unsigned int vrid,
+             unsigned int rif,
+             enum oes_router_cntr_type type,
+             unsigned int packets,
+             unsigned long long bytes)
+{
+    struct oes_cntr_slab   *slab_p = oes_cntr_slab_self;
+    struct oes_cntr_block **chunks_p, *block_p;
+    unsigned long long     *v;
+
+    if ((slab_p != NULL) && ((chunks_p = slab_p->chunks[vrid]) != NULL) &&
+        (chunks_p[rif / OES_CNTR_CHUNK] != NULL)) {
+        block_p = &chunks_p[rif / OES_CNTR_CHUNK][rif % OES_CNTR_CHUNK];
+    } else {
+        block_p = oes_cntr_block_get(vrid, rif);
+        if (block_p == NULL) {
+            return;
+        }
+    }
+    /* only this thread writes the block, readers may load it at any time */
+    v = block_p->v;
+    __atomic_store_n(&v[type], __atomic_load_n(&v[type], __ATOMIC_RELAXED) + packets, __ATOMIC_RELAXED);
+    __atomic_store_n(&v[type + 2], __atomic_load_n(&v[type + 2], __ATOMIC_RELAXED) + bytes,
+                     __ATOMIC_RELAXED);
+}
+
+/**
+ * This function sums a counter over all slabs.
+ *
+ * @param[in] vrid - virtual router, below OES_CNTR_MAX_VRIDS
+ * @param[in] rif - router interface, below OES_CNTR_MAX_RIFS
+ * @param[out] v - OES_CNTR_FIELDS sums
+ */
+void
+oes_cntr_sum(unsigned int vrid,
+             unsigned int rif,
+             unsigned long long * v);
+
+#endif /* __OES_ROUTER_CNTR_H__ */
@@ -0,0 +1,239 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <stddef.h>
+#include <string.h>
+#include <nmmintrin.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_router_ecmp.h"
+
+#define OES_ECMP_CRC32C_POLY          0x82f63b78    /* reflected */
+
+_Static_assert(sizeof(struct oes_ecmp_flow) == OES_ECMP_FLOW_WORDS * sizeof(unsigned long long),
+               "oes_ecmp_flow must be six 64-bit words");
+
+static unsigned int oes_ecmp_crc32c_table[256];
+static int          oes_ecmp_have_sse42 = -1;
+
+/* Sets the mask bytes of one flow field. */
+static void
+oes_ecmp_mask_field(struct oes_ecmp_hasher *hasher_p,
+                    size_t offset,
+                    size_t size)
+{
+    memset((unsigned char *)hasher_p->mask + offset, 0xff, size);
+}
+
+static void
+oes_ecmp_crc32c_table_init(void)
+{
+    unsigned int i, bit, crc;
+
+    for (i = 0; i < 256; i++) {
+        crc = i;
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ ((crc & 1) ? OES_ECMP_CRC32C_POLY : 0);
+        }
+        oes_ecmp_crc32c_table[i] = crc;
+    }
+}
+
+static inline unsigned long long
+oes_ecmp_flow_word(const struct oes_ecmp_flow *flow_p,
+                   unsigned int word)
+{
+    unsigned long long value;
+
+    memcpy(&value, (const unsigned char *)flow_p + word * sizeof(value), sizeof(value));
+    return value;
+}
+
+/* spreads the CRC over the high bits used by oes_ecmp_member */
+static inline unsigned int
+oes_ecmp_finalize(unsigned int crc)
+{
+    crc ^= crc >> 16;
+    crc *= 0x85ebca6b;
+    crc ^= crc >> 13;
+    return crc;
+}
+
+static unsigned int
+oes_ecmp_hash_soft(const struct oes_ecmp_hasher *hasher_p,
+                   const struct oes_ecmp_flow *flow_p)
+{
+    unsigned long long word;
+    unsigned int       crc = hasher_p->seed;
+    unsigned int       i, byte;
+
+    for (i = 0; i < OES_ECMP_FLOW_WORDS; i++) {
+        word = oes_ecmp_flow_word(flow_p, i) & hasher_p->mask[i];
+        for (byte = 0; byte < 8; byte++) {
+            crc = oes_ecmp_crc32c_table[(crc ^ word) & 0xff] ^ (crc >> 8);
+            word >>= 8;
+        }
+    }
+    return oes_ecmp_finalize(crc);
+}
+
+__attribute__((target("sse4.2")))
+static inline unsigned int
+oes_ecmp_hash_sse42(const struct oes_ecmp_hasher *hasher_p,
+                    const struct oes_ecmp_flow *flow_p)
+{
+    unsigned long long crc = hasher_p->seed;
+    unsigned int       i;
+
+    for (i = 0; i < OES_ECMP_FLOW_WORDS; i++) {
+        crc = _mm_crc32_u64(crc, oes_ecmp_flow_word(flow_p, i) & hasher_p->mask[i]);
+    }
+    return oes_ecmp_finalize((unsigned int)crc);
+}
+
+/* four flows at a time, so their CRC chains overlap in the pipeline */
+__attribute__((target("sse4.2")))
+static void
+oes_ecmp_hash_bulk_sse42(const struct oes_ecmp_hasher *hasher_p,
+                         const struct oes_ecmp_flow *flow_list_p,
+                         unsigned int *hash_list_p,
+                         unsigned int cnt)
+{
+    const struct oes_ecmp_flow *f_p;
+    unsigned long long          c0, c1, c2, c3, mask;
+    unsigned int                i, word;
+
+    for (i = 0; i + 4 <= cnt; i += 4) {
+        f_p = &flow_list_p[i];
+        c0 = c1 = c2 = c3 = hasher_p->seed;
+        for (word = 0; word < OES_ECMP_FLOW_WORDS; word++) {
+            mask = hasher_p->mask[word];
+            c0 = _mm_crc32_u64(c0, oes_ecmp_flow_word(&f_p[0], word) & mask);
+            c1 = _mm_crc32_u64(c1, oes_ecmp_flow_word(&f_p[1], word) & mask);
+            c2 = _mm_crc32_u64(c2, oes_ecmp_flow_word(&f_p[2], word) & mask);
+            c3 = _mm_crc32_u64(c3, oes_ecmp_flow_word(&f_p[3], word) & mask);
+        }
+        hash_list_p[i] = oes_ecmp_finalize((unsigned int)c0);
+        hash_list_p[i + 1] = oes_ecmp_finalize((unsigned int)c1);
+        hash_list_p[i + 2] = oes_ecmp_finalize((unsigned int)c2);
+        hash_list_p[i + 3] = oes_ecmp_finalize((unsigned int)c3);
+    }
+    for (; i < cnt; i++) {
+        hash_list_p[i] = oes_ecmp_hash_sse42(hasher_p, &flow_list_p[i]);
+    }
+}
+
+static int
+oes_ecmp_sse42(void)
+{
+    if (oes_ecmp_have_sse42 < 0) {
+        __builtin_cpu_init();
+        oes_ecmp_have_sse42 = __builtin_cpu_supports("sse4.2");
+        if (!oes_ecmp_have_sse42) {
+            oes_ecmp_crc32c_table_init();
+        }
+    }
+    return oes_ecmp_have_sse42;
+}
+
+void
+oes_ecmp_hasher_init(struct oes_ecmp_hasher *hasher_p,
+                     const struct oes_router_ecmp_hash_fields *fields_p,
+                     unsigned int seed)
+{
+    memset(hasher_p, 0, sizeof(*hasher_p));
+    hasher_p->seed = seed;
+    oes_ecmp_mask_field(hasher_p, offsetof(struct oes_ecmp_flow, version), 1);
+    if (fields_p->enable_src_ip) {
+        oes_ecmp_mask_field(hasher_p, offsetof(struct oes_ecmp_flow, src_ip), 16);
+    }
+    if (fields_p->enable_dst_ip) {
+        oes_ecmp_mask_field(hasher_p, offsetof(struct oes_ecmp_flow, dst_ip), 16);
+    }
+    if (fields_p->enable_tc) {
+        oes_ecmp_mask_field(hasher_p, offsetof(struct oes_ecmp_flow, tc), 1);
+    }
+    if (fields_p->enable_flow_label) {
+        oes_ecmp_mask_field(hasher_p, offsetof(struct oes_ecmp_flow, flow_label), 4);
+    }
+    if (fields_p->enable_tcp_udp) {
+        oes_ecmp_mask_field(hasher_p, offsetof(struct oes_ecmp_flow, ip_proto), 1);
+    }
+    if (fields_p->enable_udp_src_port) {
+        oes_ecmp_mask_field(hasher_p, offsetof(struct oes_ecmp_flow, src_port), 2);
+    }
+    if (fields_p->enable_dst_src_port) {
+        oes_ecmp_mask_field(hasher_p, offsetof(struct oes_ecmp_flow, dst_port), 2);
+    }
+    oes_ecmp_sse42();
+}
+
+unsigned int
+oes_ecmp_hash(const struct oes_ecmp_hasher *hasher_p,
+              const struct oes_ecmp_flow *flow_p)
+{
+    if (oes_ecmp_sse42()) {
+        return oes_ecmp_hash_sse42(hasher_p, flow_p);
+    }
+    return oes_ecmp_hash_soft(hasher_p, flow_p);
+}
+
+void
+oes_ecmp_hash_bulk(const struct oes_ecmp_hasher *hasher_p,
+                   const struct oes_ecmp_flow *flow_list_p,
+                   unsigned int *hash_list_p,
+                   unsigned int cnt)
+{
+    unsigned int i;
+
+    if (oes_ecmp_sse42()) {
+        oes_ecmp_hash_bulk_sse42(hasher_p, flow_list_p, hash_list_p, cnt);
+        return;
+    }
+    for (i = 0; i < cnt; i++) {
+        hash_list_p[i] = oes_ecmp_hash_soft(hasher_p, &flow_list_p[i]);
+    }
+}
+
+void
+oes_ecmp_select_bulk(const struct oes_ecmp_hasher *hasher_p,
+                     const struct oes_ecmp_flow *flow_list_p,
+                     unsigned int member_cnt,
+                     unsigned int *member_list_p,
+                     unsigned int cnt)
+{
+    unsigned int i;
+
+    oes_ecmp_hash_bulk(hasher_p, flow_list_p, member_list_p, cnt);
+    for (i = 0; i < cnt; i++) {
+        member_list_p[i] = oes_ecmp_member(member_list_p[i], member_cnt);
+    }
+}
@@ -0,0 +1,143 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __OES_ROUTER_ECMP_H__
+#define __OES_ROUTER_ECMP_H__
+
+/************************************************
+ *  ECMP hash engine
+ *
+ *  A flow is the parsed header fields ECMP may hash on, laid out as
+ *  six 64-bit words. The enabled fields of struct
+ *  oes_router_ecmp_hash_fields are compiled into a mask over those
+ *  words, so hashing a flow is six AND + CRC32C steps with no per
+ *  field branches. CRC32C uses the SSE4.2 instruction when the CPU has
+ *  it and a table otherwise, both give the same hash. A hash maps to
+ *  one of n group members by multiply and shift, without a division.
+ ***********************************************/
+
+#define OES_ECMP_FLOW_WORDS           6
+
+/*
+ * Parsed header fields of a packet. IPv4 addresses sit in the first 4
+ * bytes of src_ip/dst_ip in network order, the rest is zero. Ports are
+ * in host order.
+ */
+struct oes_ecmp_flow {
+    unsigned char  src_ip[16];
+    unsigned char  dst_ip[16];
+    unsigned int   flow_label;       /**< IPv6 only, 20 bits */
+    unsigned short src_port;         /**< TCP/UDP source port */
+    unsigned short dst_port;         /**< TCP/UDP destination port */
+    unsigned char  tc;               /**< IPv4 TOS / IPv6 traffic class */
+    unsigned char  ip_proto;         /**< L4 protocol */
+    unsigned char  version;          /**< enum oes_ip_version */
+    unsigned char  reserved[5];
+};
+
+struct oes_ecmp_hasher {
+    unsigned long long mask[OES_ECMP_FLOW_WORDS];
+    unsigned int       seed;
+};
+
+/**
+ * This function compiles an ECMP hash configuration. Field mapping:
+ * enable_src_ip/enable_dst_ip - source/destination address,
+ * enable_tc - traffic class, enable_flow_label - IPv6 flow label,
+ * enable_tcp_udp - L4 protocol, enable_udp_src_port - L4 source port,
+ * enable_dst_src_port - L4 destination port. The IP version is
+ * always hashed.
+ *
+ * @param[out] hasher_p - compiled hasher
+ * @param[in] fields_p - enabled fields
+ * @param[in] seed - hash seed, so routers sharing a path can hash differently
+ */
+void
+oes_ecmp_hasher_init(struct oes_ecmp_hasher * hasher_p,
+                     const struct oes_router_ecmp_hash_fields * fields_p,
+                     unsigned int seed);
+
+/**
+ * This function hashes one flow.
+ *
+ * @param[in] hasher_p - compiled hasher
+ * @param[in] flow_p - flow
+ *
+ * @return 32-bit hash
+ */
+unsigned int
+oes_ecmp_hash(const struct oes_ecmp_hasher * hasher_p,
+              const struct oes_ecmp_flow * flow_p);
+
+/**
+ * This function hashes a batch of flows.
+ *
+ * @param[in] hasher_p - compiled hasher
+ * @param[in] flow_list_p - flows
+ * @param[out] hash_list_p - hash per flow
+ * @param[in] cnt - number of flows
+ */
+void
+oes_ecmp_hash_bulk(const struct oes_ecmp_hasher * hasher_p,
+                   const struct oes_ecmp_flow * flow_list_p,
+                   unsigned int * hash_list_p,
+                   unsigned int cnt);
+
+/**
+ * This function maps a hash to a member of an n member group.
+ *
+ * @param[in] hash - flow hash
+ * @param[in] member_cnt - group size, at least 1
+ *
+ * @return member index
+ */
+static inline unsigned int
+oes_ecmp_member(unsigned int hash,
+                unsigned int member_cnt)
+{
+    return (unsigned int)(((unsigned long long)hash * member_cnt) >> 32);
+}
+
+/**
+ * This function hashes a batch of flows and maps each to a member of
+ * an n member group.
+ *
+ * @param[in] hasher_p - compiled hasher
+ * @param[in] flow_list_p - flows
+ * @param[in] member_cnt - group size, at least 1
+ * @param[out] member_list_p - member index per flow
+ * @param[in] cnt - number of flows
+ */
+void
+oes_ecmp_select_bulk(const struct oes_ecmp_hasher * hasher_p,
+                     const struct oes_ecmp_flow * flow_list_p,
+                     unsigned int member_cnt,
+                     unsigned int * member_list_p,
+                     unsigned int cnt);
+
+#endif /* __OES_ROUTER_ECMP_H__ */
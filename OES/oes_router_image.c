@@ -0,0 +1,215 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "oes_status.h"
+#include "oes_router_image.h"
+
+#define OES_IMAGE_TMP_SUFFIX          ".tmp"
+#define OES_IMAGE_CHECKSUM_MUL        0x9e3779b97f4a7c15ULL
+
+unsigned long long
+oes_image_checksum(unsigned long long checksum,
+                   const void *data_p,
+                   size_t size)
+{
+    const unsigned char *byte_p = data_p;
+    unsigned long long   word;
+    size_t               i;
+
+    /* sections written from arrays of shorter types may be unaligned */
+    for (i = 0; i < size; i += OES_IMAGE_ALIGN) {
+        memcpy(&word, byte_p + i, sizeof(word));
+        checksum = (checksum + word) * OES_IMAGE_CHECKSUM_MUL;
+        checksum = (checksum << 27) | (checksum >> 37);
+    }
+    return checksum;
+}
+
+oes_status_e
+oes_image_create(struct oes_image_writer *writer_p,
+                 const char *path_p)
+{
+    struct oes_image_header header;
+
+    memset(writer_p, 0, sizeof(*writer_p));
+    writer_p->tmp_path_p = malloc(strlen(path_p) + sizeof(OES_IMAGE_TMP_SUFFIX));
+    if (writer_p->tmp_path_p == NULL) {
+        return OES_STATUS_NO_MEMORY;
+    }
+    strcpy(writer_p->tmp_path_p, path_p);
+    strcat(writer_p->tmp_path_p, OES_IMAGE_TMP_SUFFIX);
+    writer_p->file_p = fopen(writer_p->tmp_path_p, "wb");
+    if (writer_p->file_p == NULL) {
+        free(writer_p->tmp_path_p);
+        return OES_STATUS_ERROR;
+    }
+    /* the header goes in last, once the checksum is known */
+    memset(&header, 0, sizeof(header));
+    writer_p->failed = (fwrite(&header, sizeof(header), 1, writer_p->file_p) != 1);
+    return OES_STATUS_SUCCESS;
+}
+
+void
+oes_image_write(struct oes_image_writer *writer_p,
+                const void *data_p,
+                size_t size)
+{
+    unsigned long long tail = 0;
+    size_t             body = size & ~(size_t)(OES_IMAGE_ALIGN - 1);
+
+    if (writer_p->failed || (size == 0)) {
+        return;
+    }
+    if (fwrite(data_p, 1, size, writer_p->file_p) != size) {
+        writer_p->failed = 1;
+        return;
+    }
+    writer_p->checksum = oes_image_checksum(writer_p->checksum, data_p, body);
+    if (size != body) {
+        memcpy(&tail, (const unsigned char *)data_p + body, size - body);
+        if (fwrite((const unsigned char *)&tail + (size - body), 1, OES_IMAGE_ALIGN - (size - body),
+                   writer_p->file_p) != OES_IMAGE_ALIGN - (size - body)) {
+            writer_p->failed = 1;
+            return;
+        }
+        writer_p->checksum = oes_image_checksum(writer_p->checksum, &tail, sizeof(tail));
+    }
+    writer_p->size += body + (size != body) * OES_IMAGE_ALIGN;
+}
+
+void
+oes_image_fail(struct oes_image_writer *writer_p)
+{
+    writer_p->failed = 1;
+}
+
+oes_status_e
+oes_image_close(struct oes_image_writer *writer_p,
+                const char *path_p,
+                unsigned int layout)
+{
+    struct oes_image_header header;
+    int                     failed = writer_p->failed;
+
+    if (!failed) {
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, OES_IMAGE_MAGIC, sizeof(OES_IMAGE_MAGIC));
+        header.version = OES_IMAGE_VERSION;
+        header.layout = layout;
+        header.size = writer_p->size;
+        header.checksum = writer_p->checksum;
+        failed = (fseek(writer_p->file_p, 0, SEEK_SET) != 0) ||
+                 (fwrite(&header, sizeof(header), 1, writer_p->file_p) != 1) ||
+                 (fflush(writer_p->file_p) != 0) ||
+                 (fsync(fileno(writer_p->file_p)) != 0);
+    }
+    failed |= (fclose(writer_p->file_p) != 0);
+    failed = failed || (rename(writer_p->tmp_path_p, path_p) != 0);
+    if (failed) {
+        unlink(writer_p->tmp_path_p);
+    }
+    free(writer_p->tmp_path_p);
+    memset(writer_p, 0, sizeof(*writer_p));
+    return failed ? OES_STATUS_ERROR : OES_STATUS_SUCCESS;
+}
+
+oes_status_e
+oes_image_open(struct oes_image_reader *reader_p,
+               const char *path_p,
+               unsigned int layout)
+{
+    const struct oes_image_header *header_p;
+    struct stat                    st;
+    void                          *map_p;
+    int                            fd;
+
+    memset(reader_p, 0, sizeof(*reader_p));
+    fd = open(path_p, O_RDONLY);
+    if (fd < 0) {
+        return OES_STATUS_ERROR;
+    }
+    if ((fstat(fd, &st) != 0) || (st.st_size < (off_t)sizeof(*header_p))) {
+        close(fd);
+        return OES_STATUS_ERROR;
+    }
+    /* sections are read once, in order */
+    map_p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (map_p == MAP_FAILED) {
+        return OES_STATUS_ERROR;
+    }
+    madvise(map_p, st.st_size, MADV_SEQUENTIAL);
+    reader_p->map_p = map_p;
+    reader_p->map_size = st.st_size;
+    reader_p->off = sizeof(*header_p);
+
+    header_p = map_p;
+    if (memcmp(header_p->magic, OES_IMAGE_MAGIC, sizeof(OES_IMAGE_MAGIC)) ||
+        (header_p->version != OES_IMAGE_VERSION) || (header_p->layout != layout) ||
+        (header_p->size != reader_p->map_size - sizeof(*header_p)) ||
+        (header_p->size % OES_IMAGE_ALIGN) ||
+        (oes_image_checksum(0, reader_p->map_p + sizeof(*header_p), header_p->size) !=
+         header_p->checksum)) {
+        oes_image_unmap(reader_p);
+        return OES_STATUS_ERROR;
+    }
+    return OES_STATUS_SUCCESS;
+}
+
+const void *
+oes_image_read(struct oes_image_reader *reader_p,
+               size_t size)
+{
+    const void        *data_p;
+    unsigned long long padded = (size + OES_IMAGE_ALIGN - 1) & ~(unsigned long long)(OES_IMAGE_ALIGN - 1);
+
+    if (reader_p->failed || (padded > reader_p->map_size - reader_p->off)) {
+        reader_p->failed = 1;
+        return NULL;
+    }
+    data_p = reader_p->map_p + reader_p->off;
+    reader_p->off += padded;
+    return data_p;
+}
+
+void
+oes_image_unmap(struct oes_image_reader *reader_p)
+{
+    if (reader_p->map_p != NULL) {
+        munmap((void *)reader_p->map_p, reader_p->map_size);
+    }
+    memset(reader_p, 0, sizeof(*reader_p));
+}
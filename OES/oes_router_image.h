@@ -0,0 +1,179 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __OES_ROUTER_IMAGE_H__
+#define __OES_ROUTER_IMAGE_H__
+
+/************************************************
+ *  Router images
+ *
+ *  A router image is a file holding the tables of a vr for a warm
+ *  restart: a header, then the sections the tables write one after the
+ *  other. Sections hold indexes, never pointers, and each starts on an
+ *  OES_IMAGE_ALIGN boundary, so a table loads straight from a read only
+ *  mapping of the file. The header carries a checksum of all sections
+ *  and a layout value given by the caller, which changes with the
+ *  structures the sections copy; an image failing either is rejected.
+ *  Hash tables are saved as they are, their hashes being unseeded.
+ *  Bump OES_IMAGE_VERSION when the sections or those hashes change.
+ *
+ *  Writing goes to a temporary file renamed over the image at the end,
+ *  so an existing image stays whole until the new one is.
+ ***********************************************/
+
+#define OES_IMAGE_MAGIC               "OESRIMG"
+#define OES_IMAGE_VERSION             1
+#define OES_IMAGE_ALIGN               8
+
+struct oes_image_header {
+    char               magic[8];
+    unsigned int       version;
+    unsigned int       layout;
+    unsigned long long size;              /**< bytes after the header */
+    unsigned long long checksum;          /**< of the bytes after the header */
+};
+
+struct oes_image_writer {
+    FILE             * file_p;
+    char             * tmp_path_p;
+    unsigned long long size;
+    unsigned long long checksum;
+    int                failed;
+};
+
+struct oes_image_reader {
+    const unsigned char * map_p;          /**< the whole file */
+    unsigned long long    map_size;
+    unsigned long long    off;            /**< next section */
+    int                   failed;
+};
+
+/**
+ * This function starts writing an image.
+ *
+ * @param[out] writer_p - writer
+ * @param[in] path_p - image file
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_NO_MEMORY if out of memory
+ * @return OES_STATUS_ERROR if the temporary file could not be created
+ */
+oes_status_e
+oes_image_create(struct oes_image_writer * writer_p,
+                 const char * path_p);
+
+/**
+ * This function appends a section, padded to OES_IMAGE_ALIGN. Errors
+ * are reported by oes_image_close.
+ *
+ * @param[in] writer_p - writer
+ * @param[in] data_p - section
+ * @param[in] size - section size in bytes
+ */
+void
+oes_image_write(struct oes_image_writer * writer_p,
+                const void * data_p,
+                size_t size);
+
+/**
+ * This function marks a write as failed, for sections that could not
+ * be built. oes_image_close then drops the image.
+ *
+ * @param[in] writer_p - writer
+ */
+void
+oes_image_fail(struct oes_image_writer * writer_p);
+
+/**
+ * This function completes an image: writes its header and renames it
+ * over path_p, or drops it if a write failed.
+ *
+ * @param[in] writer_p - writer
+ * @param[in] path_p - image file, as given to oes_image_create
+ * @param[in] layout - layout of the sections
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_ERROR if a write failed
+ */
+oes_status_e
+oes_image_close(struct oes_image_writer * writer_p,
+                const char * path_p,
+                unsigned int layout);
+
+/**
+ * This function maps an image and checks its header and checksum.
+ *
+ * @param[out] reader_p - reader, at the first section
+ * @param[in] path_p - image file
+ * @param[in] layout - layout the sections must have
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_ERROR if the file cannot be mapped, or is not an
+ *       image of this layout, or fails its checksum
+ */
+oes_status_e
+oes_image_open(struct oes_image_reader * reader_p,
+               const char * path_p,
+               unsigned int layout);
+
+/**
+ * This function returns the next section of an image.
+ *
+ * @param[in] reader_p - reader
+ * @param[in] size - section size in bytes
+ *
+ * @return the section, or NULL if the image is shorter. reader_p is
+ *       then marked failed.
+ */
+const void *
+oes_image_read(struct oes_image_reader * reader_p,
+               size_t size);
+
+/**
+ * This function unmaps an image.
+ *
+ * @param[in] reader_p - reader
+ */
+void
+oes_image_unmap(struct oes_image_reader * reader_p);
+
+/**
+ * This function folds 64 bit words into a checksum.
+ *
+ * @param[in] checksum - checksum so far, 0 to start
+ * @param[in] data_p - words
+ * @param[in] size - size in bytes, a multiple of OES_IMAGE_ALIGN
+ *
+ * @return the new checksum
+ */
+unsigned long long
+oes_image_checksum(unsigned long long checksum,
+                   const void * data_p,
+                   size_t size);
+
+#endif /* __OES_ROUTER_IMAGE_H__ */
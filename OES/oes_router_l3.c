@@ -0,0 +1,118 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <string.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_router_rif.h"
+#include "oes_router_l3.h"
+
+static int
+oes_l3_forwards(unsigned int action)
+{
+    return (action == OES_ROUTER_ACTION_FORWARD) || (action == OES_ROUTER_ACTION_MIRROR);
+}
+
+void
+oes_l3_checker_init(struct oes_l3_checker *checker_p,
+                    const struct oes_router_attributes *attr_p)
+{
+    struct oes_l3_verdict *verdict_p;
+    unsigned int           idx, action, ttl;
+
+    memset(checker_p, 0, sizeof(*checker_p));
+    for (idx = 0; idx < OES_L3_VERDICTS; idx++) {
+        verdict_p = &checker_p->verdicts[idx];
+        action = idx & 3;
+        ttl = (idx >> OES_L3_IDX_TTL_SHIFT) & 3;
+        verdict_p->action = action;
+        if (!oes_l3_forwards(action)) {
+            continue;
+        }
+        if (idx & OES_L3_IDX_NO_RIF) {
+            verdict_p->action = OES_ROUTER_ACTION_DROP;
+            continue;
+        }
+        if (ttl < 2) {
+            verdict_p->action = ttl ? attr_p->ttl_1_action : attr_p->ttl_0_action;
+            if (verdict_p->action != OES_ROUTER_ACTION_FORWARD) {
+                verdict_p->l3_error = 1;
+                verdict_p->trap_id = OES_PACKET_L3_TTLERROR;
+                continue;
+            }
+            /* forwarded as is, a TTL of 0 is not decremented */
+            verdict_p->action = action;
+        }
+        if (idx & OES_L3_IDX_MTU) {
+            verdict_p->action = OES_ROUTER_ACTION_TRAP;
+            verdict_p->l3_error = 1;
+            verdict_p->trap_id = OES_PACKET_L3_MTUERROR;
+            continue;
+        }
+        verdict_p->ttl_dec = (ttl != 0);
+    }
+}
+
+void
+oes_l3_check_bulk(const struct oes_l3_checker *checker_p,
+                  const struct oes_rif_table *rifs_p,
+                  struct oes_router_l3_pkt *pkt_list_p,
+                  unsigned int cnt)
+{
+    const struct oes_l3_verdict *verdict_p;
+    struct oes_router_l3_pkt    *pkt_p;
+    unsigned int                 i, limit, ttl, idx;
+
+    for (i = 0; i < cnt; i++) {
+        pkt_p = &pkt_list_p[i];
+        /* only forwarded packets need an egress rif in range, the
+         * verdict of the others ignores what the mask reads */
+        limit = rifs_p->l3_limits[pkt_p->egress_rif & (OES_RIF_MAX_RIFS - 1)];
+        ttl = pkt_p->ttl;
+
+        /* the one branch, taken by all but the rare packets failing a check */
+        if ((pkt_p->action == OES_ROUTER_ACTION_FORWARD) & (ttl >= 2) & (pkt_p->l3_len < limit)) {
+            pkt_p->ttl = ttl - 1;
+            pkt_p->l3_error = 0;
+            continue;
+        }
+
+        idx = pkt_p->action |
+              (((ttl < 2) ? ttl : 2) << OES_L3_IDX_TTL_SHIFT) |
+              ((pkt_p->l3_len >= limit) ? OES_L3_IDX_MTU : 0) |
+              (limit ? 0 : OES_L3_IDX_NO_RIF);
+        verdict_p = &checker_p->verdicts[idx];
+        pkt_p->action = verdict_p->action;
+        pkt_p->trap_id = verdict_p->trap_id;
+        pkt_p->l3_error = verdict_p->l3_error;
+        pkt_p->ttl -= verdict_p->ttl_dec;
+    }
+}
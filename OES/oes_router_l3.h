@@ -0,0 +1,97 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __OES_ROUTER_L3_H__
+#define __OES_ROUTER_L3_H__
+
+/************************************************
+ *  L3 forwarding checks
+ *
+ *  TTL and MTU checks of the software forwarding path. Packets
+ *  forwarded with a TTL above 1 that fit the MTU of their egress rif
+ *  take a single branch, comparing the length against the l3_limits
+ *  word of the rif table. The outcome of any other packet depends only
+ *  on its action, whether its TTL is 0, 1 or more, whether it exceeds
+ *  the MTU and whether the rif exists. Those select one of
+ *  OES_L3_VERDICTS entries of a table compiled from the router
+ *  attributes, so the error classes cost a table load rather than a
+ *  chain of branches.
+ ***********************************************/
+
+#define OES_L3_VERDICTS               64
+
+#define OES_L3_IDX_TTL_SHIFT          2     /**< action in bits 0-1, then TTL 0 / 1 / more */
+#define OES_L3_IDX_MTU                0x10  /**< exceeds the egress rif MTU */
+#define OES_L3_IDX_NO_RIF             0x20  /**< egress rif not in use */
+
+struct oes_l3_verdict {
+    unsigned char action;            /**< enum oes_router_action */
+    unsigned char l3_error;          /**< a check set the action */
+    unsigned char trap_id;           /**< enum oes_l3_packet, when l3_error */
+    unsigned char ttl_dec;           /**< TTL to subtract */
+};
+
+struct oes_rif_table;
+
+struct oes_l3_checker {
+    struct oes_l3_verdict verdicts[OES_L3_VERDICTS];
+};
+
+/**
+ * This function compiles the TTL actions of a router. A packet
+ * forwarded (FORWARD or MIRROR) with TTL 0 or 1 takes the ttl_0_action
+ * or ttl_1_action, trapped as OES_PACKET_L3_TTLERROR, unless that
+ * action is FORWARD. A forwarded packet longer than a non zero MTU of
+ * its egress rif is trapped as OES_PACKET_L3_MTUERROR. A forwarded
+ * packet whose egress rif does not exist is dropped. Forwarded packets
+ * passing the checks have their TTL decremented, other actions are
+ * left as they are.
+ *
+ * @param[out] checker_p - compiled checks
+ * @param[in] attr_p - router attributes
+ */
+void
+oes_l3_checker_init(struct oes_l3_checker * checker_p,
+                    const struct oes_router_attributes * attr_p);
+
+/**
+ * This function runs the checks on a batch of packets.
+ *
+ * @param[in] checker_p - compiled checks
+ * @param[in] rifs_p - router interfaces, for the egress MTU
+ * @param[in,out] pkt_list_p - packets, forwarded ones with an egress
+ *       rif below OES_RIF_MAX_RIFS
+ * @param[in] cnt - number of packets
+ */
+void
+oes_l3_check_bulk(const struct oes_l3_checker * checker_p,
+                  const struct oes_rif_table * rifs_p,
+                  struct oes_router_l3_pkt * pkt_list_p,
+                  unsigned int cnt);
+
+#endif /* __OES_ROUTER_L3_H__ */
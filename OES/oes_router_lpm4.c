@@ -0,0 +1,1147 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sys/mman.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "oes_status.h"
+#include "oes_router_image.h"
+#include "oes_router_lpm4.h"
+
+#define OES_LPM4_TBL8_MIN_GROUPS      4
+#define OES_LPM4_RULES_MIN_SIZE       16
+#define OES_LPM4_TBL8_NONE            0xffffffff
+#define OES_LPM4_ARENA_BYTES          (2 << 20)   /**< one huge page */
+
+#define OES_LPM4_ENTRY(depth, nh) \
+    (OES_LPM4_ENTRY_VALID | ((unsigned int)(depth) << OES_LPM4_ENTRY_DEPTH_SHIFT) | (nh))
+#define OES_LPM4_ENTRY_DEPTH(entry) \
+    (((entry) >> OES_LPM4_ENTRY_DEPTH_SHIFT) & OES_LPM4_ENTRY_DEPTH_MASK)
+#define OES_LPM4_PAGE(ip)             ((ip) >> (32 - OES_LPM4_PAGE_DEPTH))
+
+/* image section of a table, followed by its short rules and its pages */
+struct oes_lpm4_image {
+    unsigned int rules_cnt;
+    unsigned int tbl8_used;
+    unsigned int depth_cnt[33];
+    unsigned int short_size;
+    unsigned int short_cnt;
+    unsigned int page_cnt;
+};
+
+/* image section of a page, followed by its starts, tbl24, tbl8 groups and rules */
+struct oes_lpm4_page_image {
+    unsigned int p;
+    unsigned int tbl8_groups;
+    unsigned int tbl8_free;
+    unsigned int tbl8_used;
+    unsigned int rules_size;
+    unsigned int rules_cnt;
+};
+
+/* every page of an empty table, never written */
+static struct oes_lpm4_page oes_lpm4_empty_page = { .tbl8_free = OES_LPM4_TBL8_NONE };
+
+/*
+ * Pages are carved from huge page aligned arenas: lookups are spread
+ * over the whole table, spare the TLB. Freed pages are kept for reuse
+ * by any table.
+ */
+static pthread_mutex_t       oes_lpm4_arena_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct oes_lpm4_page *oes_lpm4_arena_free;   /**< linked through their rules.rules */
+static unsigned char        *oes_lpm4_arena_next;
+static unsigned char        *oes_lpm4_arena_end;
+
+static inline unsigned int
+oes_lpm4_mask(unsigned int depth)
+{
+    return depth ? 0xffffffffU << (32 - depth) : 0;
+}
+
+static inline unsigned int
+oes_lpm4_rule_hash(unsigned int ip, unsigned int depth)
+{
+    unsigned long long key = ((unsigned long long)ip << 6) | depth;
+
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return (unsigned int)key;
+}
+
+/* returns the slot holding (ip, depth), or the empty slot ending its probe */
+static unsigned int
+oes_lpm4_rule_slot(const struct oes_lpm4_rules *rules_p, unsigned int ip, unsigned int depth)
+{
+    unsigned int mask = rules_p->size - 1;
+    unsigned int slot = oes_lpm4_rule_hash(ip, depth) & mask;
+
+    while (rules_p->rules[slot].used &&
+           ((rules_p->rules[slot].ip != ip) || (rules_p->rules[slot].depth != depth))) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/* returns the rule (ip, depth), NULL if there is none */
+static struct oes_lpm4_rule *
+oes_lpm4_rule_find(const struct oes_lpm4_rules *rules_p, unsigned int ip, unsigned int depth)
+{
+    unsigned int slot;
+
+    if (rules_p->cnt == 0) {
+        return NULL;
+    }
+    slot = oes_lpm4_rule_slot(rules_p, ip, depth);
+    return rules_p->rules[slot].used ? &rules_p->rules[slot] : NULL;
+}
+
+static oes_status_e
+oes_lpm4_rules_resize(struct oes_lpm4_rules *rules_p, unsigned int size)
+{
+    struct oes_lpm4_rule *old_p = rules_p->rules;
+    unsigned int          old_size = rules_p->size;
+    unsigned int          i, slot;
+
+    rules_p->rules = calloc(size, sizeof(*rules_p->rules));
+    if (rules_p->rules == NULL) {
+        rules_p->rules = old_p;
+        return OES_STATUS_NO_MEMORY;
+    }
+    rules_p->size = size;
+    for (i = 0; i < old_size; i++) {
+        if (old_p[i].used) {
+            slot = oes_lpm4_rule_slot(rules_p, old_p[i].ip, old_p[i].depth);
+            rules_p->rules[slot] = old_p[i];
+        }
+    }
+    free(old_p);
+    return OES_STATUS_SUCCESS;
+}
+
+/* Makes room for rule (ip, depth), moving *slot_p to its free slot if the table grows. */
+static oes_status_e
+oes_lpm4_rules_reserve(struct oes_lpm4_rules *rules_p, unsigned int *slot_p,
+                       unsigned int ip, unsigned int depth)
+{
+    if ((rules_p->cnt + 1) * 4 <= rules_p->size * 3) {
+        return OES_STATUS_SUCCESS;
+    }
+    if (oes_lpm4_rules_resize(rules_p, rules_p->size ? rules_p->size * 2 :
+                              OES_LPM4_RULES_MIN_SIZE) != OES_STATUS_SUCCESS) {
+        return OES_STATUS_NO_MEMORY;
+    }
+    *slot_p = oes_lpm4_rule_slot(rules_p, ip, depth);
+    return OES_STATUS_SUCCESS;
+}
+
+static oes_status_e
+oes_lpm4_rules_copy(struct oes_lpm4_rules *dst_p, const struct oes_lpm4_rules *src_p)
+{
+    *dst_p = *src_p;
+    if (src_p->size == 0) {
+        return OES_STATUS_SUCCESS;
+    }
+    dst_p->rules = malloc(src_p->size * sizeof(*src_p->rules));
+    if (dst_p->rules == NULL) {
+        memset(dst_p, 0, sizeof(*dst_p));
+        return OES_STATUS_NO_MEMORY;
+    }
+    memcpy(dst_p->rules, src_p->rules, src_p->size * sizeof(*src_p->rules));
+    return OES_STATUS_SUCCESS;
+}
+
+/* backward shift deletion keeps linear probe chains intact */
+static void
+oes_lpm4_rule_remove(struct oes_lpm4_rules *rules_p, unsigned int slot)
+{
+    unsigned int mask = rules_p->size - 1;
+    unsigned int next = slot, home;
+
+    rules_p->cnt--;
+    for (;;) {
+        rules_p->rules[slot].used = 0;
+        for (;;) {
+            next = (next + 1) & mask;
+            if (!rules_p->rules[next].used) {
+                return;
+            }
+            home = oes_lpm4_rule_hash(rules_p->rules[next].ip, rules_p->rules[next].depth) & mask;
+            /* move next back unless its home lies cyclically in (slot, next] */
+            if ((slot <= next) ? ((home <= slot) || (home > next)) :
+                                 ((home <= slot) && (home > next))) {
+                break;
+            }
+        }
+        rules_p->rules[slot] = rules_p->rules[next];
+        slot = next;
+    }
+}
+
+/* the rules holding a prefix: the table's for short prefixes, its page's for the others */
+static inline struct oes_lpm4_rules *
+oes_lpm4_rules_of(const struct oes_lpm4 *lpm_p, unsigned int ip, unsigned int depth)
+{
+    if (depth < OES_LPM4_PAGE_DEPTH) {
+        return (struct oes_lpm4_rules *)&lpm_p->short_rules;
+    }
+    return &lpm_p->pages[OES_LPM4_PAGE(ip)]->rules;
+}
+
+/* Returns an uninitialized page, NULL if out of memory. */
+static struct oes_lpm4_page *
+oes_lpm4_page_alloc(void)
+{
+    struct oes_lpm4_page *page_p = NULL;
+    unsigned char        *map_p;
+    uintptr_t             head;
+
+    pthread_mutex_lock(&oes_lpm4_arena_lock);
+    if (oes_lpm4_arena_free != NULL) {
+        page_p = oes_lpm4_arena_free;
+        oes_lpm4_arena_free = (struct oes_lpm4_page *)page_p->rules.rules;
+    } else {
+        if (oes_lpm4_arena_end - oes_lpm4_arena_next < (ptrdiff_t)sizeof(*page_p)) {
+            map_p = mmap(NULL, 2 * OES_LPM4_ARENA_BYTES, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (map_p == MAP_FAILED) {
+                pthread_mutex_unlock(&oes_lpm4_arena_lock);
+                return NULL;
+            }
+            /* keep the aligned huge page, give back the rest */
+            head = -(uintptr_t)map_p & (OES_LPM4_ARENA_BYTES - 1);
+            if (head) {
+                munmap(map_p, head);
+            }
+            munmap(map_p + head + OES_LPM4_ARENA_BYTES, OES_LPM4_ARENA_BYTES - head);
+            oes_lpm4_arena_next = map_p + head;
+            oes_lpm4_arena_end = oes_lpm4_arena_next + OES_LPM4_ARENA_BYTES;
+            madvise(oes_lpm4_arena_next, OES_LPM4_ARENA_BYTES, MADV_HUGEPAGE);
+        }
+        page_p = (struct oes_lpm4_page *)oes_lpm4_arena_next;
+        oes_lpm4_arena_next += sizeof(*page_p);
+    }
+    pthread_mutex_unlock(&oes_lpm4_arena_lock);
+    return page_p;
+}
+
+static void
+oes_lpm4_page_free(struct oes_lpm4_page *page_p)
+{
+    pthread_mutex_lock(&oes_lpm4_arena_lock);
+    page_p->rules.rules = (struct oes_lpm4_rule *)oes_lpm4_arena_free;
+    oes_lpm4_arena_free = page_p;
+    pthread_mutex_unlock(&oes_lpm4_arena_lock);
+}
+
+static void
+oes_lpm4_page_put(struct oes_lpm4_page *page_p)
+{
+    if (page_p == &oes_lpm4_empty_page) {
+        return;
+    }
+    if (__atomic_sub_fetch(&page_p->refcnt, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(page_p->tbl8);
+        free(page_p->rules.rules);
+        oes_lpm4_page_free(page_p);
+    }
+}
+
+/*
+ * Returns page p ready to be written, copying it first if another
+ * table shares it. NULL if out of memory. Only a clone of this table
+ * can raise the count of a page it holds alone, and cloning excludes
+ * writing, so a count of 1 stays 1.
+ */
+static struct oes_lpm4_page *
+oes_lpm4_page_own(struct oes_lpm4 *lpm_p, unsigned int p)
+{
+    struct oes_lpm4_page *page_p = lpm_p->pages[p];
+    struct oes_lpm4_page *copy_p;
+
+    if ((page_p != &oes_lpm4_empty_page) &&
+        (__atomic_load_n(&page_p->refcnt, __ATOMIC_ACQUIRE) == 1)) {
+        return page_p;
+    }
+    copy_p = oes_lpm4_page_alloc();
+    if (copy_p == NULL) {
+        return NULL;
+    }
+    memcpy(copy_p, page_p, sizeof(*copy_p));
+    copy_p->refcnt = 1;
+    copy_p->tbl8 = NULL;
+    if (page_p->tbl8_groups) {
+        copy_p->tbl8 = malloc((size_t)page_p->tbl8_groups * OES_LPM4_TBL8_GROUP_ENTRIES *
+                              sizeof(*copy_p->tbl8));
+        if (copy_p->tbl8 == NULL) {
+            oes_lpm4_page_free(copy_p);
+            return NULL;
+        }
+        memcpy(copy_p->tbl8, page_p->tbl8, (size_t)page_p->tbl8_groups *
+               OES_LPM4_TBL8_GROUP_ENTRIES * sizeof(*copy_p->tbl8));
+    }
+    if (oes_lpm4_rules_copy(&copy_p->rules, &page_p->rules) != OES_STATUS_SUCCESS) {
+        free(copy_p->tbl8);
+        oes_lpm4_page_free(copy_p);
+        return NULL;
+    }
+    lpm_p->pages[p] = copy_p;
+    oes_lpm4_page_put(page_p);
+    return copy_p;
+}
+
+/* Owns the pages of the tbl24 range of a prefix, see oes_lpm4_page_own. */
+static oes_status_e
+oes_lpm4_pages_own(struct oes_lpm4 *lpm_p, unsigned int ip, unsigned int depth)
+{
+    unsigned int p = OES_LPM4_PAGE(ip);
+    unsigned int last = p;
+
+    if (depth < OES_LPM4_PAGE_DEPTH) {
+        last = p + (1U << (OES_LPM4_PAGE_DEPTH - depth)) - 1;
+    }
+    for (; p <= last; p++) {
+        if (oes_lpm4_page_own(lpm_p, p) == NULL) {
+            return OES_STATUS_NO_MEMORY;
+        }
+    }
+    return OES_STATUS_SUCCESS;
+}
+
+static unsigned int
+oes_lpm4_tbl8_alloc(struct oes_lpm4 *lpm_p, struct oes_lpm4_page *page_p)
+{
+    unsigned int *tbl8_p;
+    unsigned int  groups, group;
+
+    if (page_p->tbl8_free == OES_LPM4_TBL8_NONE) {
+        /* at most one group per tbl24 entry, the page never runs out */
+        groups = page_p->tbl8_groups ? page_p->tbl8_groups * 2 : OES_LPM4_TBL8_MIN_GROUPS;
+        tbl8_p = realloc(page_p->tbl8, (size_t)groups * OES_LPM4_TBL8_GROUP_ENTRIES *
+                         sizeof(*tbl8_p));
+        if (tbl8_p == NULL) {
+            return OES_LPM4_TBL8_NONE;
+        }
+        page_p->tbl8 = tbl8_p;
+        for (group = groups; group-- > page_p->tbl8_groups;) {
+            page_p->tbl8[group * OES_LPM4_TBL8_GROUP_ENTRIES] = page_p->tbl8_free;
+            page_p->tbl8_free = group;
+        }
+        page_p->tbl8_groups = groups;
+    }
+    group = page_p->tbl8_free;
+    page_p->tbl8_free = page_p->tbl8[group * OES_LPM4_TBL8_GROUP_ENTRIES];
+    page_p->tbl8_used++;
+    lpm_p->tbl8_used++;
+    return group;
+}
+
+static void
+oes_lpm4_tbl8_free(struct oes_lpm4 *lpm_p, struct oes_lpm4_page *page_p, unsigned int group)
+{
+    page_p->tbl8[group * OES_LPM4_TBL8_GROUP_ENTRIES] = page_p->tbl8_free;
+    page_p->tbl8_free = group;
+    page_p->tbl8_used--;
+    lpm_p->tbl8_used--;
+}
+
+/*
+ * Writes new_entry over every entry of [first, first + cnt) owned by a
+ * prefix no longer than depth, i.e. not overridden by a longer one.
+ */
+static inline void
+oes_lpm4_range_add(unsigned int *tbl_p, unsigned int first, unsigned int cnt,
+                   unsigned int depth, unsigned int new_entry)
+{
+    unsigned int i, entry;
+
+    for (i = first; i < first + cnt; i++) {
+        entry = tbl_p[i];
+        if (!(entry & OES_LPM4_ENTRY_VALID) || (OES_LPM4_ENTRY_DEPTH(entry) <= depth)) {
+            tbl_p[i] = new_entry;
+        }
+    }
+}
+
+/* Writes new_entry over every entry of the range owned by exactly depth. */
+static inline void
+oes_lpm4_range_del(unsigned int *tbl_p, unsigned int first, unsigned int cnt,
+                   unsigned int depth, unsigned int new_entry)
+{
+    unsigned int i, entry;
+
+    for (i = first; i < first + cnt; i++) {
+        entry = tbl_p[i];
+        if ((entry & OES_LPM4_ENTRY_VALID) && (OES_LPM4_ENTRY_DEPTH(entry) == depth)) {
+            tbl_p[i] = new_entry;
+        }
+    }
+}
+
+/* Folds a tbl8 group back into its tbl24 entry once it holds a single /24 or shorter value. */
+static void
+oes_lpm4_tbl8_try_collapse(struct oes_lpm4 *lpm_p, struct oes_lpm4_page *page_p,
+                           unsigned int tbl24_idx)
+{
+    unsigned int  group = page_p->tbl24[tbl24_idx] & OES_LPM4_ENTRY_NH_MASK;
+    unsigned int *tbl8_p = &page_p->tbl8[group * OES_LPM4_TBL8_GROUP_ENTRIES];
+    unsigned int  first = tbl8_p[0];
+    unsigned int  i;
+
+    if ((first & OES_LPM4_ENTRY_VALID) && (OES_LPM4_ENTRY_DEPTH(first) > 24)) {
+        return;
+    }
+    for (i = 1; i < OES_LPM4_TBL8_GROUP_ENTRIES; i++) {
+        if (tbl8_p[i] != first) {
+            return;
+        }
+    }
+    page_p->tbl24[tbl24_idx] = first;
+    oes_lpm4_tbl8_free(lpm_p, page_p, group);
+}
+
+/* shortest prefix of OES_LPM4_PAGE_DEPTH bits or more starting at tbl24 entry idx of a page */
+static inline unsigned int
+oes_lpm4_block_depth(unsigned int idx)
+{
+    return idx ? 24 - __builtin_ctz(idx) : OES_LPM4_PAGE_DEPTH;
+}
+
+/*
+ * Tells whether a rule of page p starts in its tbl24 entry idx. Rules
+ * over 24 bits keep the entry pointing to a tbl8 group, see
+ * oes_lpm4_tbl8_try_collapse, shorter ones start at the entry itself.
+ */
+static int
+oes_lpm4_block_used(const struct oes_lpm4 *lpm_p, unsigned int p, unsigned int idx)
+{
+    const struct oes_lpm4_page *page_p = lpm_p->pages[p];
+    unsigned int                ip = (p << (32 - OES_LPM4_PAGE_DEPTH)) | (idx << 8);
+    unsigned int                depth;
+
+    if (page_p->tbl24[idx] & OES_LPM4_ENTRY_EXT) {
+        return 1;
+    }
+    for (depth = oes_lpm4_block_depth(idx); depth <= 24; depth++) {
+        if (lpm_p->depth_cnt[depth] && (oes_lpm4_rule_find(&page_p->rules, ip, depth) != NULL)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+struct oes_lpm4 *
+oes_lpm4_create(void)
+{
+    struct oes_lpm4 *lpm_p = calloc(1, sizeof(*lpm_p));
+    unsigned int     p;
+
+    if (lpm_p == NULL) {
+        return NULL;
+    }
+    for (p = 0; p < OES_LPM4_PAGES; p++) {
+        lpm_p->pages[p] = &oes_lpm4_empty_page;
+    }
+    return lpm_p;
+}
+
+struct oes_lpm4 *
+oes_lpm4_clone(const struct oes_lpm4 *lpm_p)
+{
+    struct oes_lpm4 *clone_p = malloc(sizeof(*clone_p));
+    unsigned int     p;
+
+    if (clone_p == NULL) {
+        return NULL;
+    }
+    memcpy(clone_p, lpm_p, sizeof(*clone_p));
+    if (oes_lpm4_rules_copy(&clone_p->short_rules, &lpm_p->short_rules) != OES_STATUS_SUCCESS) {
+        free(clone_p);
+        return NULL;
+    }
+    for (p = 0; p < OES_LPM4_PAGES; p++) {
+        if (clone_p->pages[p] != &oes_lpm4_empty_page) {
+            __atomic_add_fetch(&clone_p->pages[p]->refcnt, 1, __ATOMIC_RELAXED);
+        }
+    }
+    return clone_p;
+}
+
+void
+oes_lpm4_destroy(struct oes_lpm4 *lpm_p)
+{
+    if (lpm_p == NULL) {
+        return;
+    }
+    oes_lpm4_flush(lpm_p);
+    free(lpm_p);
+}
+
+void
+oes_lpm4_flush(struct oes_lpm4 *lpm_p)
+{
+    unsigned int p;
+
+    for (p = 0; p < OES_LPM4_PAGES; p++) {
+        oes_lpm4_page_put(lpm_p->pages[p]);
+        lpm_p->pages[p] = &oes_lpm4_empty_page;
+    }
+    free(lpm_p->short_rules.rules);
+    memset(&lpm_p->short_rules, 0, sizeof(lpm_p->short_rules));
+    lpm_p->rules_cnt = 0;
+    lpm_p->tbl8_used = 0;
+    memset(lpm_p->depth_cnt, 0, sizeof(lpm_p->depth_cnt));
+}
+
+/* the tbl24 entry and start bit an update of the prefix writes */
+static inline void
+oes_lpm4_prefetch_entry(const struct oes_lpm4 *lpm_p, unsigned int ip, unsigned int depth)
+{
+    const struct oes_lpm4_page *page_p = lpm_p->pages[OES_LPM4_PAGE(ip)];
+    unsigned int                idx = (ip >> 8) & (OES_LPM4_PAGE_ENTRIES - 1);
+
+    __builtin_prefetch(&page_p->tbl24[idx]);
+    if (depth >= OES_LPM4_PAGE_DEPTH) {
+        __builtin_prefetch(&page_p->starts[idx / 64]);
+    }
+}
+
+/*
+ * Adds rule (ip, depth), ip masked, at the slot oes_lpm4_rule_slot
+ * gives on its rules as they are, 0 while they are empty. A copied page
+ * keeps the slots of its rules, only a resize moves them.
+ */
+static oes_status_e
+oes_lpm4_add_slot(struct oes_lpm4 *lpm_p,
+                  unsigned int ip,
+                  unsigned int depth,
+                  unsigned int slot,
+                  unsigned int next_hop)
+{
+    unsigned int           entry = OES_LPM4_ENTRY(depth, next_hop);
+    struct oes_lpm4_rules *rules_p = oes_lpm4_rules_of(lpm_p, ip, depth);
+    struct oes_lpm4_page  *page_p;
+    unsigned int           idx, group, i;
+
+    if (rules_p->size && rules_p->rules[slot].used && (rules_p->rules[slot].next_hop == next_hop)) {
+        return OES_STATUS_SUCCESS;
+    }
+
+    /* copying shared pages changes nothing visible, failing after it is fine */
+    if (oes_lpm4_pages_own(lpm_p, ip, depth) != OES_STATUS_SUCCESS) {
+        return OES_STATUS_NO_MEMORY;
+    }
+    rules_p = oes_lpm4_rules_of(lpm_p, ip, depth);
+    if (!rules_p->size || !rules_p->rules[slot].used) {
+        if (oes_lpm4_rules_reserve(rules_p, &slot, ip, depth) != OES_STATUS_SUCCESS) {
+            return OES_STATUS_NO_MEMORY;
+        }
+    }
+
+    if (depth <= 24) {
+        idx = ip >> 8;
+        for (i = idx; i < idx + (1U << (24 - depth)); i++) {
+            page_p = lpm_p->pages[i / OES_LPM4_PAGE_ENTRIES];
+            if (page_p->tbl24[i % OES_LPM4_PAGE_ENTRIES] & OES_LPM4_ENTRY_EXT) {
+                group = page_p->tbl24[i % OES_LPM4_PAGE_ENTRIES] & OES_LPM4_ENTRY_NH_MASK;
+                oes_lpm4_range_add(page_p->tbl8, group * OES_LPM4_TBL8_GROUP_ENTRIES,
+                                   OES_LPM4_TBL8_GROUP_ENTRIES, depth, entry);
+            } else {
+                oes_lpm4_range_add(page_p->tbl24, i % OES_LPM4_PAGE_ENTRIES, 1, depth, entry);
+            }
+        }
+    } else {
+        page_p = lpm_p->pages[OES_LPM4_PAGE(ip)];
+        idx = (ip >> 8) % OES_LPM4_PAGE_ENTRIES;
+        if (!(page_p->tbl24[idx] & OES_LPM4_ENTRY_EXT)) {
+            group = oes_lpm4_tbl8_alloc(lpm_p, page_p);
+            if (group == OES_LPM4_TBL8_NONE) {
+                return OES_STATUS_NO_MEMORY;
+            }
+            for (i = 0; i < OES_LPM4_TBL8_GROUP_ENTRIES; i++) {
+                page_p->tbl8[group * OES_LPM4_TBL8_GROUP_ENTRIES + i] = page_p->tbl24[idx];
+            }
+            page_p->tbl24[idx] = OES_LPM4_ENTRY_VALID | OES_LPM4_ENTRY_EXT | group;
+        }
+        group = page_p->tbl24[idx] & OES_LPM4_ENTRY_NH_MASK;
+        oes_lpm4_range_add(page_p->tbl8, group * OES_LPM4_TBL8_GROUP_ENTRIES + (ip & 0xff),
+                           1U << (32 - depth), depth, entry);
+    }
+
+    if (!rules_p->rules[slot].used) {
+        rules_p->rules[slot].ip = ip;
+        rules_p->rules[slot].depth = depth;
+        rules_p->rules[slot].used = 1;
+        rules_p->cnt++;
+        lpm_p->rules_cnt++;
+        lpm_p->depth_cnt[depth]++;
+        if (depth >= OES_LPM4_PAGE_DEPTH) {
+            idx = (ip >> 8) % OES_LPM4_PAGE_ENTRIES;
+            lpm_p->pages[OES_LPM4_PAGE(ip)]->starts[idx / 64] |= 1ULL << (idx % 64);
+        }
+    }
+    rules_p->rules[slot].next_hop = next_hop;
+    return OES_STATUS_SUCCESS;
+}
+
+oes_status_e
+oes_lpm4_add(struct oes_lpm4 *lpm_p,
+             unsigned int ip,
+             unsigned int depth,
+             unsigned int next_hop)
+{
+    struct oes_lpm4_rules *rules_p;
+
+    if ((depth > 32) || (next_hop > OES_LPM4_MAX_NEXT_HOP)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    ip &= oes_lpm4_mask(depth);
+    oes_lpm4_prefetch_entry(lpm_p, ip, depth);
+    rules_p = oes_lpm4_rules_of(lpm_p, ip, depth);
+    return oes_lpm4_add_slot(lpm_p, ip, depth,
+                             rules_p->size ? oes_lpm4_rule_slot(rules_p, ip, depth) : 0, next_hop);
+}
+
+oes_status_e
+oes_lpm4_add_probed(struct oes_lpm4 *lpm_p,
+                    const struct oes_lpm4_probe *probe_p,
+                    unsigned int next_hop)
+{
+    const struct oes_lpm4_rules *rules_p = oes_lpm4_rules_of(lpm_p, probe_p->ip, probe_p->depth);
+    unsigned int                 slot = probe_p->slot;
+
+    if (next_hop > OES_LPM4_MAX_NEXT_HOP) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    if (rules_p->size != probe_p->size) {
+        slot = rules_p->size ? oes_lpm4_rule_slot(rules_p, probe_p->ip, probe_p->depth) : 0;
+    }
+    return oes_lpm4_add_slot(lpm_p, probe_p->ip, probe_p->depth, slot, next_hop);
+}
+
+oes_status_e
+oes_lpm4_unshare(struct oes_lpm4 *lpm_p,
+                 unsigned int ip,
+                 unsigned int depth)
+{
+    if (depth > 32) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    return oes_lpm4_pages_own(lpm_p, ip & oes_lpm4_mask(depth), depth);
+}
+
+oes_status_e
+oes_lpm4_delete(struct oes_lpm4 *lpm_p,
+                unsigned int ip,
+                unsigned int depth)
+{
+    unsigned int           parent_entry = 0;
+    struct oes_lpm4_rules *rules_p;
+    struct oes_lpm4_rule  *parent_p;
+    struct oes_lpm4_page  *page_p;
+    unsigned int           parent_depth, idx, group, i;
+
+    if (depth > 32) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    ip &= oes_lpm4_mask(depth);
+    if (oes_lpm4_rule_find(oes_lpm4_rules_of(lpm_p, ip, depth), ip, depth) == NULL) {
+        return OES_STATUS_ENTRY_NOT_FOUND;
+    }
+    if (oes_lpm4_pages_own(lpm_p, ip, depth) != OES_STATUS_SUCCESS) {
+        return OES_STATUS_NO_MEMORY;
+    }
+    rules_p = oes_lpm4_rules_of(lpm_p, ip, depth);
+    oes_lpm4_rule_remove(rules_p, oes_lpm4_rule_slot(rules_p, ip, depth));
+    lpm_p->rules_cnt--;
+    lpm_p->depth_cnt[depth]--;
+
+    /* the covering prefix takes back the addresses */
+    for (parent_depth = depth; parent_depth-- > 0;) {
+        if (lpm_p->depth_cnt[parent_depth] == 0) {
+            continue;
+        }
+        parent_p = oes_lpm4_rule_find(oes_lpm4_rules_of(lpm_p, ip, parent_depth),
+                                      ip & oes_lpm4_mask(parent_depth), parent_depth);
+        if (parent_p != NULL) {
+            parent_entry = OES_LPM4_ENTRY(parent_depth, parent_p->next_hop);
+            break;
+        }
+    }
+
+    if (depth <= 24) {
+        idx = ip >> 8;
+        for (i = idx; i < idx + (1U << (24 - depth)); i++) {
+            page_p = lpm_p->pages[i / OES_LPM4_PAGE_ENTRIES];
+            if (page_p->tbl24[i % OES_LPM4_PAGE_ENTRIES] & OES_LPM4_ENTRY_EXT) {
+                group = page_p->tbl24[i % OES_LPM4_PAGE_ENTRIES] & OES_LPM4_ENTRY_NH_MASK;
+                oes_lpm4_range_del(page_p->tbl8, group * OES_LPM4_TBL8_GROUP_ENTRIES,
+                                   OES_LPM4_TBL8_GROUP_ENTRIES, depth, parent_entry);
+                oes_lpm4_tbl8_try_collapse(lpm_p, page_p, i % OES_LPM4_PAGE_ENTRIES);
+            } else {
+                oes_lpm4_range_del(page_p->tbl24, i % OES_LPM4_PAGE_ENTRIES, 1, depth, parent_entry);
+            }
+        }
+    } else {
+        page_p = lpm_p->pages[OES_LPM4_PAGE(ip)];
+        idx = (ip >> 8) % OES_LPM4_PAGE_ENTRIES;
+        group = page_p->tbl24[idx] & OES_LPM4_ENTRY_NH_MASK;
+        oes_lpm4_range_del(page_p->tbl8, group * OES_LPM4_TBL8_GROUP_ENTRIES + (ip & 0xff),
+                           1U << (32 - depth), depth, parent_entry);
+        oes_lpm4_tbl8_try_collapse(lpm_p, page_p, idx);
+    }
+
+    idx = (ip >> 8) % OES_LPM4_PAGE_ENTRIES;
+    if ((depth >= OES_LPM4_PAGE_DEPTH) && !oes_lpm4_block_used(lpm_p, OES_LPM4_PAGE(ip), idx)) {
+        lpm_p->pages[OES_LPM4_PAGE(ip)]->starts[idx / 64] &= ~(1ULL << (idx % 64));
+    }
+    return OES_STATUS_SUCCESS;
+}
+
+oes_status_e
+oes_lpm4_rule_get(const struct oes_lpm4 *lpm_p,
+                  unsigned int ip,
+                  unsigned int depth,
+                  unsigned int *next_hop_p)
+{
+    const struct oes_lpm4_rule *rule_p;
+
+    if (depth > 32) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    ip &= oes_lpm4_mask(depth);
+    rule_p = oes_lpm4_rule_find(oes_lpm4_rules_of(lpm_p, ip, depth), ip, depth);
+    if (rule_p == NULL) {
+        return OES_STATUS_ENTRY_NOT_FOUND;
+    }
+    *next_hop_p = rule_p->next_hop;
+    return OES_STATUS_SUCCESS;
+}
+
+oes_status_e
+oes_lpm4_rule_probe(const struct oes_lpm4 *lpm_p,
+                    unsigned int ip,
+                    unsigned int depth,
+                    struct oes_lpm4_probe *probe_p,
+                    unsigned int *next_hop_p)
+{
+    const struct oes_lpm4_rules *rules_p;
+
+    if (depth > 32) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    ip &= oes_lpm4_mask(depth);
+    /* an add goes on to the tbl24 entry, have it come in with the rule */
+    oes_lpm4_prefetch_entry(lpm_p, ip, depth);
+    rules_p = oes_lpm4_rules_of(lpm_p, ip, depth);
+    probe_p->ip = ip;
+    probe_p->depth = depth;
+    probe_p->size = rules_p->size;
+    probe_p->slot = 0;
+    if (rules_p->size == 0) {
+        return OES_STATUS_ENTRY_NOT_FOUND;
+    }
+    probe_p->slot = oes_lpm4_rule_slot(rules_p, ip, depth);
+    if (!rules_p->rules[probe_p->slot].used) {
+        return OES_STATUS_ENTRY_NOT_FOUND;
+    }
+    *next_hop_p = rules_p->rules[probe_p->slot].next_hop;
+    return OES_STATUS_SUCCESS;
+}
+
+/* the rule slot comes from the page header, so the header goes first */
+void
+oes_lpm4_prefetch_page(const struct oes_lpm4 *lpm_p,
+                       unsigned int ip)
+{
+    const struct oes_lpm4_page *page_p = lpm_p->pages[OES_LPM4_PAGE(ip)];
+
+    __builtin_prefetch(&page_p->rules);
+    __builtin_prefetch(&page_p->tbl24[(ip >> 8) & (OES_LPM4_PAGE_ENTRIES - 1)]);
+}
+
+void
+oes_lpm4_prefetch_rule(const struct oes_lpm4 *lpm_p,
+                       unsigned int ip,
+                       unsigned int depth)
+{
+    const struct oes_lpm4_rules *rules_p;
+
+    if (depth > 32) {
+        return;
+    }
+    ip &= oes_lpm4_mask(depth);
+    rules_p = oes_lpm4_rules_of(lpm_p, ip, depth);
+    if (rules_p->size) {
+        __builtin_prefetch(&rules_p->rules[oes_lpm4_rule_hash(ip, depth) & (rules_p->size - 1)]);
+    }
+    if (depth >= OES_LPM4_PAGE_DEPTH) {
+        __builtin_prefetch(&lpm_p->pages[OES_LPM4_PAGE(ip)]->
+                           starts[((ip >> 8) & (OES_LPM4_PAGE_ENTRIES - 1)) / 64]);
+    }
+}
+
+/*
+ * Lookups are independent, so the CPU overlaps their misses on its own
+ * within its reorder window; prefetching the tbl24 entry a fixed
+ * distance ahead extends the overlap past it.
+ */
+void
+oes_lpm4_lookup_bulk(const struct oes_lpm4 *lpm_p,
+                     const unsigned int *ip_list_p,
+                     unsigned int *next_hop_list_p,
+                     unsigned int cnt)
+{
+    unsigned int i, ip, nh;
+
+    for (i = 0; i < cnt; i++) {
+        if (i + OES_LPM4_BULK_PREFETCH < cnt) {
+            ip = ip_list_p[i + OES_LPM4_BULK_PREFETCH];
+            __builtin_prefetch(&lpm_p->pages[ip >> (32 - OES_LPM4_PAGE_DEPTH)]->
+                               tbl24[(ip >> 8) & (OES_LPM4_PAGE_ENTRIES - 1)]);
+        }
+        next_hop_list_p[i] = oes_lpm4_lookup(lpm_p, ip_list_p[i], &nh) ? nh : OES_LPM4_NO_NEXT_HOP;
+    }
+}
+
+static void
+oes_lpm4_rules_walk(const struct oes_lpm4_rules *rules_p,
+                    oes_lpm4_walk_fn fn,
+                    void *ctx_p)
+{
+    unsigned int slot;
+
+    for (slot = 0; slot < rules_p->size; slot++) {
+        if (rules_p->rules[slot].used) {
+            fn(ctx_p, rules_p->rules[slot].ip, rules_p->rules[slot].depth,
+               rules_p->rules[slot].next_hop);
+        }
+    }
+}
+
+void
+oes_lpm4_walk(const struct oes_lpm4 *lpm_p,
+              oes_lpm4_walk_fn fn,
+              void *ctx_p)
+{
+    unsigned int p;
+
+    oes_lpm4_rules_walk(&lpm_p->short_rules, fn, ctx_p);
+    for (p = 0; p < OES_LPM4_PAGES; p++) {
+        oes_lpm4_rules_walk(&lpm_p->pages[p]->rules, fn, ctx_p);
+    }
+}
+
+static inline unsigned long long
+oes_lpm4_walk_key(unsigned int ip, unsigned int depth)
+{
+    return ((unsigned long long)ip << 6) | depth;
+}
+
+/* calls fn on rule (ip, depth) if there is one and it is not ordered before from */
+static inline int
+oes_lpm4_walk_rule(const struct oes_lpm4 *lpm_p, const struct oes_lpm4_rules *rules_p,
+                   unsigned int ip, unsigned int depth, unsigned long long from,
+                   oes_lpm4_walk_from_fn fn, void *ctx_p)
+{
+    const struct oes_lpm4_rule *rule_p;
+
+    if (!lpm_p->depth_cnt[depth] || (oes_lpm4_walk_key(ip, depth) < from)) {
+        return 0;
+    }
+    rule_p = oes_lpm4_rule_find(rules_p, ip, depth);
+    return (rule_p != NULL) && fn(ctx_p, ip, depth, rule_p->next_hop);
+}
+
+/* Walks the rules starting in tbl24 entry idx of page p, returns non-zero once fn stops. */
+static int
+oes_lpm4_walk_block(const struct oes_lpm4 *lpm_p, unsigned int p, unsigned int idx,
+                    unsigned long long from, oes_lpm4_walk_from_fn fn, void *ctx_p)
+{
+    const struct oes_lpm4_page *page_p = lpm_p->pages[p];
+    unsigned int                ip = (p << (32 - OES_LPM4_PAGE_DEPTH)) | (idx << 8);
+    const unsigned int         *tbl8_p;
+    unsigned int                depth, max_depth, i;
+
+    for (depth = oes_lpm4_block_depth(idx); depth <= 24; depth++) {
+        if (oes_lpm4_walk_rule(lpm_p, &page_p->rules, ip, depth, from, fn, ctx_p)) {
+            return 1;
+        }
+    }
+    if (!(page_p->tbl24[idx] & OES_LPM4_ENTRY_EXT)) {
+        return 0;
+    }
+    /* a rule starting at ip + i covers entry i, so it is no longer than the entry's depth */
+    tbl8_p = &page_p->tbl8[(page_p->tbl24[idx] & OES_LPM4_ENTRY_NH_MASK) * OES_LPM4_TBL8_GROUP_ENTRIES];
+    for (i = 0; i < OES_LPM4_TBL8_GROUP_ENTRIES; i++) {
+        max_depth = (tbl8_p[i] & OES_LPM4_ENTRY_VALID) ? OES_LPM4_ENTRY_DEPTH(tbl8_p[i]) : 0;
+        for (depth = i ? 32 - __builtin_ctz(i) : 25; depth <= max_depth; depth++) {
+            if ((depth > 24) &&
+                oes_lpm4_walk_rule(lpm_p, &page_p->rules, ip + i, depth, from, fn, ctx_p)) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+void
+oes_lpm4_walk_from(const struct oes_lpm4 *lpm_p,
+                   unsigned int ip,
+                   unsigned int depth,
+                   oes_lpm4_walk_from_fn fn,
+                   void *ctx_p)
+{
+    const struct oes_lpm4_page *page_p;
+    unsigned long long          from = oes_lpm4_walk_key(ip, depth);
+    unsigned long long          bits;
+    unsigned int                p, first, word, short_depth;
+
+    for (p = OES_LPM4_PAGE(ip); p < OES_LPM4_PAGES; p++) {
+        page_p = lpm_p->pages[p];
+        first = (p == OES_LPM4_PAGE(ip)) ? (ip >> 8) % OES_LPM4_PAGE_ENTRIES : 0;
+        /* prefixes shorter than a page start at a page and come first in it */
+        if ((first == 0) && lpm_p->short_rules.cnt) {
+            for (short_depth = p ? OES_LPM4_PAGE_DEPTH - __builtin_ctz(p) : 0;
+                 short_depth < OES_LPM4_PAGE_DEPTH; short_depth++) {
+                if (oes_lpm4_walk_rule(lpm_p, &lpm_p->short_rules, p << (32 - OES_LPM4_PAGE_DEPTH),
+                                       short_depth, from, fn, ctx_p)) {
+                    return;
+                }
+            }
+        }
+        if (page_p->rules.cnt == 0) {
+            continue;
+        }
+        for (word = first / 64; word < OES_LPM4_PAGE_ENTRIES / 64; word++) {
+            bits = page_p->starts[word];
+            if (word == first / 64) {
+                bits &= ~0ULL << (first % 64);
+            }
+            for (; bits; bits &= bits - 1) {
+                if (oes_lpm4_walk_block(lpm_p, p, word * 64 + __builtin_ctzll(bits), from, fn, ctx_p)) {
+                    return;
+                }
+            }
+        }
+    }
+}
+
+unsigned long long
+oes_lpm4_mem_size(const struct oes_lpm4 *lpm_p)
+{
+    const struct oes_lpm4_page *page_p;
+    unsigned long long          size = sizeof(*lpm_p) +
+                                       lpm_p->short_rules.size * sizeof(struct oes_lpm4_rule);
+    unsigned int                p;
+
+    for (p = 0; p < OES_LPM4_PAGES; p++) {
+        page_p = lpm_p->pages[p];
+        if (page_p == &oes_lpm4_empty_page) {
+            continue;
+        }
+        size += (sizeof(*page_p) +
+                 (unsigned long long)page_p->tbl8_groups * OES_LPM4_TBL8_GROUP_ENTRIES *
+                 sizeof(*page_p->tbl8) +
+                 page_p->rules.size * sizeof(*page_p->rules.rules)) /
+                __atomic_load_n(&page_p->refcnt, __ATOMIC_RELAXED);
+    }
+    return size;
+}
+
+void
+oes_lpm4_save(const struct oes_lpm4 *lpm_p,
+              struct oes_image_writer *writer_p)
+{
+    const struct oes_lpm4_page *page_p;
+    struct oes_lpm4_page_image  page_image;
+    struct oes_lpm4_image       image;
+    unsigned int                p;
+
+    memset(&image, 0, sizeof(image));
+    image.rules_cnt = lpm_p->rules_cnt;
+    image.tbl8_used = lpm_p->tbl8_used;
+    memcpy(image.depth_cnt, lpm_p->depth_cnt, sizeof(image.depth_cnt));
+    image.short_size = lpm_p->short_rules.size;
+    image.short_cnt = lpm_p->short_rules.cnt;
+    for (p = 0; p < OES_LPM4_PAGES; p++) {
+        image.page_cnt += (lpm_p->pages[p] != &oes_lpm4_empty_page);
+    }
+    oes_image_write(writer_p, &image, sizeof(image));
+    oes_image_write(writer_p, lpm_p->short_rules.rules,
+                    (size_t)image.short_size * sizeof(struct oes_lpm4_rule));
+
+    for (p = 0; p < OES_LPM4_PAGES; p++) {
+        page_p = lpm_p->pages[p];
+        if (page_p == &oes_lpm4_empty_page) {
+            continue;
+        }
+        memset(&page_image, 0, sizeof(page_image));
+        page_image.p = p;
+        page_image.tbl8_groups = page_p->tbl8_groups;
+        page_image.tbl8_free = page_p->tbl8_free;
+        page_image.tbl8_used = page_p->tbl8_used;
+        page_image.rules_size = page_p->rules.size;
+        page_image.rules_cnt = page_p->rules.cnt;
+        oes_image_write(writer_p, &page_image, sizeof(page_image));
+        oes_image_write(writer_p, page_p->starts, sizeof(page_p->starts));
+        oes_image_write(writer_p, page_p->tbl24, sizeof(page_p->tbl24));
+        oes_image_write(writer_p, page_p->tbl8, (size_t)page_p->tbl8_groups *
+                        OES_LPM4_TBL8_GROUP_ENTRIES * sizeof(*page_p->tbl8));
+        oes_image_write(writer_p, page_p->rules.rules,
+                        (size_t)page_p->rules.size * sizeof(*page_p->rules.rules));
+    }
+}
+
+/* Copies the next image section, of size bytes, to a malloc'ed array, NULL if size is 0. */
+static oes_status_e
+oes_lpm4_load_array(struct oes_image_reader *reader_p, size_t size, void **array_pp)
+{
+    const void *data_p = oes_image_read(reader_p, size);
+
+    *array_pp = NULL;
+    if (data_p == NULL) {
+        return OES_STATUS_ERROR;
+    }
+    if (size == 0) {
+        return OES_STATUS_SUCCESS;
+    }
+    *array_pp = malloc(size);
+    if (*array_pp == NULL) {
+        return OES_STATUS_NO_MEMORY;
+    }
+    memcpy(*array_pp, data_p, size);
+    return OES_STATUS_SUCCESS;
+}
+
+/* a rule table from an image: open addressing needs a power of two size and a free slot */
+static inline int
+oes_lpm4_rules_image_valid(unsigned int size, unsigned int cnt)
+{
+    return ((size & (size - 1)) == 0) && ((unsigned long long)cnt * 4 <= (unsigned long long)size * 3);
+}
+
+/* the tbl8 bookkeeping of a page from an image, tbl24 entries included */
+static int
+oes_lpm4_page_image_valid(const struct oes_lpm4_page_image *page_image_p, const unsigned int *tbl24_p)
+{
+    unsigned int i;
+
+    if ((page_image_p->tbl8_groups > OES_LPM4_PAGE_ENTRIES) ||
+        (page_image_p->tbl8_used > page_image_p->tbl8_groups) ||
+        ((page_image_p->tbl8_free >= page_image_p->tbl8_groups) &&
+         (page_image_p->tbl8_free != OES_LPM4_TBL8_NONE)) ||
+        !oes_lpm4_rules_image_valid(page_image_p->rules_size, page_image_p->rules_cnt)) {
+        return 0;
+    }
+    for (i = 0; i < OES_LPM4_PAGE_ENTRIES; i++) {
+        if ((tbl24_p[i] & OES_LPM4_ENTRY_EXT) &&
+            ((tbl24_p[i] & OES_LPM4_ENTRY_NH_MASK) >= page_image_p->tbl8_groups)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+oes_status_e
+oes_lpm4_load(struct oes_image_reader *reader_p,
+              struct oes_lpm4 **lpm_pp)
+{
+    const struct oes_lpm4_page_image *page_image_p;
+    const struct oes_lpm4_image      *image_p;
+    struct oes_lpm4_page             *page_p;
+    struct oes_lpm4                  *lpm_p;
+    const void                       *starts_p, *tbl24_p;
+    unsigned int                      i;
+    oes_status_e                      status;
+
+    *lpm_pp = NULL;
+    image_p = oes_image_read(reader_p, sizeof(*image_p));
+    if ((image_p == NULL) || !oes_lpm4_rules_image_valid(image_p->short_size, image_p->short_cnt)) {
+        return OES_STATUS_ERROR;
+    }
+    lpm_p = oes_lpm4_create();
+    if (lpm_p == NULL) {
+        return OES_STATUS_NO_MEMORY;
+    }
+    lpm_p->rules_cnt = image_p->rules_cnt;
+    lpm_p->tbl8_used = image_p->tbl8_used;
+    memcpy(lpm_p->depth_cnt, image_p->depth_cnt, sizeof(lpm_p->depth_cnt));
+    lpm_p->short_rules.size = image_p->short_size;
+    lpm_p->short_rules.cnt = image_p->short_cnt;
+    status = oes_lpm4_load_array(reader_p, (size_t)image_p->short_size * sizeof(struct oes_lpm4_rule),
+                                 (void **)&lpm_p->short_rules.rules);
+
+    for (i = 0; (status == OES_STATUS_SUCCESS) && (i < image_p->page_cnt); i++) {
+        page_image_p = oes_image_read(reader_p, sizeof(*page_image_p));
+        starts_p = oes_image_read(reader_p, sizeof(page_p->starts));
+        tbl24_p = oes_image_read(reader_p, sizeof(page_p->tbl24));
+        if ((tbl24_p == NULL) || (page_image_p->p >= OES_LPM4_PAGES) ||
+            (lpm_p->pages[page_image_p->p] != &oes_lpm4_empty_page) ||
+            !oes_lpm4_page_image_valid(page_image_p, tbl24_p)) {
+            status = OES_STATUS_ERROR;
+            break;
+        }
+        page_p = oes_lpm4_page_alloc();
+        if (page_p == NULL) {
+            status = OES_STATUS_NO_MEMORY;
+            break;
+        }
+        page_p->refcnt = 1;
+        page_p->tbl8_groups = page_image_p->tbl8_groups;
+        page_p->tbl8_free = page_image_p->tbl8_free;
+        page_p->tbl8_used = page_image_p->tbl8_used;
+        page_p->rules.size = page_image_p->rules_size;
+        page_p->rules.cnt = page_image_p->rules_cnt;
+        memcpy(page_p->starts, starts_p, sizeof(page_p->starts));
+        memcpy(page_p->tbl24, tbl24_p, sizeof(page_p->tbl24));
+        status = oes_lpm4_load_array(reader_p, (size_t)page_p->tbl8_groups *
+                                     OES_LPM4_TBL8_GROUP_ENTRIES * sizeof(*page_p->tbl8),
+                                     (void **)&page_p->tbl8);
+        if (status == OES_STATUS_SUCCESS) {
+            status = oes_lpm4_load_array(reader_p, (size_t)page_p->rules.size *
+                                         sizeof(*page_p->rules.rules),
+                                         (void **)&page_p->rules.rules);
+        } else {
+            page_p->rules.rules = NULL;
+        }
+        /* the table owns the page from here, destroy frees what was loaded */
+        lpm_p->pages[page_image_p->p] = page_p;
+    }
+
+    if (status != OES_STATUS_SUCCESS) {
+        oes_lpm4_destroy(lpm_p);
+        return status;
+    }
+    *lpm_pp = lpm_p;
+    return OES_STATUS_SUCCESS;
+}
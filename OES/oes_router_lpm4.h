@@ -0,0 +1,401 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __OES_ROUTER_LPM4_H__
+#define __OES_ROUTER_LPM4_H__
+
+/************************************************
+ *  IPv4 longest prefix match engine (DIR-24-8)
+ *
+ *  tbl24 holds one entry per /24. An entry either carries the next
+ *  hop of the longest prefix (depth <= 24) covering it, or points to a
+ *  256 entry tbl8 group resolving the last octet. The rules table keeps
+ *  every (prefix, depth) exactly, for get and for restoring the
+ *  covering prefix on delete. All addresses are in host byte order.
+ *
+ *  tbl24 is cut into pages of one /12 each. A page also holds the tbl8
+ *  groups its entries point to and the rules of the prefixes of 12 bits
+ *  or more inside it, so it is a self contained subtree of the table.
+ *  Tables made by oes_lpm4_clone share their pages and copy a page only
+ *  before changing it, so a clone costs the pages it differs in. Pages
+ *  no prefix reaches point to a common empty page. A lookup is a read
+ *  of the 32KB page directory, which stays cache resident, plus at most
+ *  one tbl24 and one tbl8 read.
+ *
+ *  Rules are hashed. For ordered walks a page also marks the tbl24
+ *  entries its rules start in. The rules of a marked entry are found
+ *  by probing the depths a prefix starting there can have, the depths
+ *  in its tbl8 group telling which prefixes over 24 bits to try.
+ ***********************************************/
+
+#define OES_LPM4_TBL24_ENTRIES        (1 << 24)
+#define OES_LPM4_TBL8_GROUP_ENTRIES   256
+#define OES_LPM4_PAGE_DEPTH           12            /**< a page covers a /12 */
+#define OES_LPM4_PAGES                (1 << OES_LPM4_PAGE_DEPTH)
+#define OES_LPM4_PAGE_ENTRIES         (OES_LPM4_TBL24_ENTRIES / OES_LPM4_PAGES)
+#define OES_LPM4_MAX_NEXT_HOP         0x00ffffff
+#define OES_LPM4_NO_NEXT_HOP          0x01000000    /**< bulk lookup miss */
+#define OES_LPM4_BULK_PREFETCH        16            /**< bulk lookup prefetch distance */
+
+#define OES_LPM4_ENTRY_VALID          0x80000000
+#define OES_LPM4_ENTRY_EXT            0x40000000    /**< tbl24 entry points to a tbl8 group */
+#define OES_LPM4_ENTRY_DEPTH_SHIFT    24
+#define OES_LPM4_ENTRY_DEPTH_MASK     0x3f
+#define OES_LPM4_ENTRY_NH_MASK        0x00ffffff
+
+struct oes_lpm4_rule {
+    unsigned int  ip;
+    unsigned int  next_hop;
+    unsigned char depth;
+    unsigned char used;
+};
+
+/* open addressing hash on (ip, depth) */
+struct oes_lpm4_rules {
+    struct oes_lpm4_rule * rules;
+    unsigned int           size;             /**< power of 2, 0 while empty */
+    unsigned int           cnt;
+};
+
+struct oes_lpm4_page {
+    unsigned int           refcnt;           /**< tables sharing the page */
+    unsigned int           tbl8_groups;      /**< allocated tbl8 groups */
+    unsigned int           tbl8_free;        /**< free group list head, linked through entry 0 */
+    unsigned int           tbl8_used;
+    unsigned int         * tbl8;             /**< groups of this page, indexed from 0 */
+    struct oes_lpm4_rules  rules;            /**< prefixes of OES_LPM4_PAGE_DEPTH bits or more */
+    unsigned long long     starts[OES_LPM4_PAGE_ENTRIES / 64]; /**< bit per tbl24 entry a rule starts in */
+    unsigned int           tbl24[OES_LPM4_PAGE_ENTRIES];
+};
+
+/* walk callback: prefix in host byte order, depth and next hop of one rule */
+typedef void (*oes_lpm4_walk_fn)(void * ctx_p, unsigned int ip, unsigned int depth, unsigned int next_hop);
+
+/* ordered walk callback: as oes_lpm4_walk_fn, returns non-zero to stop the walk */
+typedef int (*oes_lpm4_walk_from_fn)(void * ctx_p, unsigned int ip, unsigned int depth,
+                                     unsigned int next_hop);
+
+/* where oes_lpm4_rule_probe found a prefix, or where it would go */
+struct oes_lpm4_probe {
+    unsigned int           ip;               /**< prefix, host bits cleared */
+    unsigned int           depth;
+    unsigned int           slot;             /**< rule slot */
+    unsigned int           size;             /**< size of the rules probed */
+};
+
+struct oes_lpm4 {
+    struct oes_lpm4_page * pages[OES_LPM4_PAGES];
+    struct oes_lpm4_rules  short_rules;      /**< prefixes shorter than OES_LPM4_PAGE_DEPTH */
+    unsigned int           rules_cnt;
+    unsigned int           tbl8_used;        /**< tbl8 groups over all pages */
+    unsigned int           depth_cnt[33];    /**< rules per depth, to skip empty depths */
+};
+
+/**
+ * This function allocates an empty IPv4 LPM table.
+ *
+ * @return the table, or NULL if out of memory
+ */
+struct oes_lpm4 *
+oes_lpm4_create(void);
+
+/**
+ * This function frees an IPv4 LPM table.
+ *
+ * @param[in] lpm_p - LPM table
+ */
+void
+oes_lpm4_destroy(struct oes_lpm4 * lpm_p);
+
+/**
+ * This function makes a table holding the same prefixes as lpm_p. The
+ * two share every page until one of them changes it.
+ *
+ * @param[in] lpm_p - LPM table to copy
+ *
+ * @return the new table, or NULL if out of memory
+ */
+struct oes_lpm4 *
+oes_lpm4_clone(const struct oes_lpm4 * lpm_p);
+
+/**
+ * This function adds a prefix or replaces its next hop.
+ *
+ * @param[in] lpm_p - LPM table
+ * @param[in] ip - prefix, host bits are ignored
+ * @param[in] depth - prefix length (0-32)
+ * @param[in] next_hop - next hop, up to OES_LPM4_MAX_NEXT_HOP
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_NO_MEMORY if a table could not grow
+ */
+oes_status_e
+oes_lpm4_add(struct oes_lpm4 * lpm_p,
+             unsigned int ip,
+             unsigned int depth,
+             unsigned int next_hop);
+
+/**
+ * This function adds a prefix or replaces its next hop at the place
+ * oes_lpm4_rule_probe found for it, without searching again. The table
+ * must not have changed since the probe.
+ *
+ * @param[in] lpm_p - LPM table
+ * @param[in] probe_p - probe of the prefix
+ * @param[in] next_hop - next hop, up to OES_LPM4_MAX_NEXT_HOP
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_NO_MEMORY if a table could not grow
+ */
+oes_status_e
+oes_lpm4_add_probed(struct oes_lpm4 * lpm_p,
+                    const struct oes_lpm4_probe * probe_p,
+                    unsigned int next_hop);
+
+/**
+ * This function deletes a prefix. Addresses it covered fall back to
+ * the longest remaining prefix covering them.
+ *
+ * @param[in] lpm_p - LPM table
+ * @param[in] ip - prefix, host bits are ignored
+ * @param[in] depth - prefix length (0-32)
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_ENTRY_NOT_FOUND if the prefix is not in the table
+ * @return OES_STATUS_NO_MEMORY if a shared page could not be copied,
+ *       see oes_lpm4_unshare
+ */
+oes_status_e
+oes_lpm4_delete(struct oes_lpm4 * lpm_p,
+                unsigned int ip,
+                unsigned int depth);
+
+/**
+ * This function copies the pages a prefix spans that are shared with
+ * another table. Until the table is cloned again, deleting the prefix
+ * then cannot fail.
+ *
+ * @param[in] lpm_p - LPM table
+ * @param[in] ip - prefix, host bits are ignored
+ * @param[in] depth - prefix length (0-32)
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_NO_MEMORY if out of memory
+ */
+oes_status_e
+oes_lpm4_unshare(struct oes_lpm4 * lpm_p,
+                 unsigned int ip,
+                 unsigned int depth);
+
+/**
+ * This function deletes all prefixes.
+ *
+ * @param[in] lpm_p - LPM table
+ */
+void
+oes_lpm4_flush(struct oes_lpm4 * lpm_p);
+
+/**
+ * This function gets the next hop of an exact prefix.
+ *
+ * @param[in] lpm_p - LPM table
+ * @param[in] ip - prefix, host bits are ignored
+ * @param[in] depth - prefix length (0-32)
+ * @param[out] next_hop_p - next hop
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_ENTRY_NOT_FOUND if the prefix is not in the table
+ */
+oes_status_e
+oes_lpm4_rule_get(const struct oes_lpm4 * lpm_p,
+                  unsigned int ip,
+                  unsigned int depth,
+                  unsigned int * next_hop_p);
+
+/**
+ * This function gets the next hop of an exact prefix as
+ * oes_lpm4_rule_get does, and records where the prefix is or would go
+ * for oes_lpm4_add_probed.
+ *
+ * @param[in] lpm_p - LPM table
+ * @param[in] ip - prefix, host bits are ignored
+ * @param[in] depth - prefix length (0-32)
+ * @param[out] probe_p - place of the prefix
+ * @param[out] next_hop_p - next hop, set if the prefix is found
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_ENTRY_NOT_FOUND if the prefix is not in the table
+ */
+oes_status_e
+oes_lpm4_rule_probe(const struct oes_lpm4 * lpm_p,
+                    unsigned int ip,
+                    unsigned int depth,
+                    struct oes_lpm4_probe * probe_p,
+                    unsigned int * next_hop_p);
+
+/**
+ * These functions prefetch what an update of a prefix reads: its page
+ * header and tbl24 entry, then its rule slot, which needs the header.
+ * A caller with updates queued prefetches the page of one
+ * 2 * OES_LPM4_BULK_PREFETCH updates ahead and the rule of the one
+ * OES_LPM4_BULK_PREFETCH ahead.
+ *
+ * @param[in] lpm_p - LPM table
+ * @param[in] ip - prefix, host bits are ignored
+ * @param[in] depth - prefix length (0-32)
+ */
+void
+oes_lpm4_prefetch_page(const struct oes_lpm4 * lpm_p,
+                       unsigned int ip);
+
+void
+oes_lpm4_prefetch_rule(const struct oes_lpm4 * lpm_p,
+                       unsigned int ip,
+                       unsigned int depth);
+
+/**
+ * This function looks up the longest prefix matching ip.
+ *
+ * @param[in] lpm_p - LPM table
+ * @param[in] ip - address
+ * @param[out] next_hop_p - next hop of the matching prefix
+ *
+ * @return 1 on a match, 0 otherwise
+ */
+static inline int
+oes_lpm4_lookup(const struct oes_lpm4 * lpm_p,
+                unsigned int ip,
+                unsigned int * next_hop_p)
+{
+    const struct oes_lpm4_page *page_p = lpm_p->pages[ip >> (32 - OES_LPM4_PAGE_DEPTH)];
+    unsigned int                entry = page_p->tbl24[(ip >> 8) & (OES_LPM4_PAGE_ENTRIES - 1)];
+
+    if (entry & OES_LPM4_ENTRY_EXT) {
+        entry = page_p->tbl8[(entry & OES_LPM4_ENTRY_NH_MASK) * OES_LPM4_TBL8_GROUP_ENTRIES +
+                             (ip & 0xff)];
+    }
+    *next_hop_p = entry & OES_LPM4_ENTRY_NH_MASK;
+    return (entry & OES_LPM4_ENTRY_VALID) != 0;
+}
+
+/**
+ * This function looks up a batch of addresses. Misses return
+ * OES_LPM4_NO_NEXT_HOP in next_hop_list_p. The tbl24 entry of the
+ * address OES_LPM4_BULK_PREFETCH places ahead is prefetched.
+ *
+ * @param[in] lpm_p - LPM table
+ * @param[in] ip_list_p - addresses
+ * @param[out] next_hop_list_p - next hop per address
+ * @param[in] cnt - number of addresses
+ */
+void
+oes_lpm4_lookup_bulk(const struct oes_lpm4 * lpm_p,
+                     const unsigned int * ip_list_p,
+                     unsigned int * next_hop_list_p,
+                     unsigned int cnt);
+
+/**
+ * This function calls fn once per prefix, in no particular order. The
+ * table must not change during the walk.
+ *
+ * @param[in] lpm_p - LPM table
+ * @param[in] fn - callback
+ * @param[in] ctx_p - callback context
+ */
+void
+oes_lpm4_walk(const struct oes_lpm4 * lpm_p,
+              oes_lpm4_walk_fn fn,
+              void * ctx_p);
+
+/**
+ * This function calls fn per prefix in order of address, then of
+ * length, starting at the first prefix not ordered before (ip, depth),
+ * until fn returns non-zero. (ip, depth) does not have to be in the
+ * table and its host bits are kept, depth may be 33. The walk starts
+ * without searching, so it can be resumed from the last prefix it
+ * returned at no cost in the size of the table. The table must not
+ * change during the walk.
+ *
+ * @param[in] lpm_p - LPM table
+ * @param[in] ip - start address
+ * @param[in] depth - start prefix length (0-33)
+ * @param[in] fn - callback
+ * @param[in] ctx_p - callback context
+ */
+void
+oes_lpm4_walk_from(const struct oes_lpm4 * lpm_p,
+                   unsigned int ip,
+                   unsigned int depth,
+                   oes_lpm4_walk_from_fn fn,
+                   void * ctx_p);
+
+/**
+ * This function returns the memory used by the table, in bytes. A page
+ * shared by several tables is split evenly between them.
+ *
+ * @param[in] lpm_p - LPM table
+ */
+unsigned long long
+oes_lpm4_mem_size(const struct oes_lpm4 * lpm_p);
+
+struct oes_image_writer;
+struct oes_image_reader;
+
+/**
+ * This function writes a table to an image: the table, then each page
+ * prefixes reach with its tbl8 groups and rules.
+ *
+ * @param[in] lpm_p - LPM table
+ * @param[in] writer_p - image writer
+ */
+void
+oes_lpm4_save(const struct oes_lpm4 * lpm_p,
+              struct oes_image_writer * writer_p);
+
+/**
+ * This function makes a table from an image written by oes_lpm4_save.
+ * Memory is allocated per page, not per prefix.
+ *
+ * @param[in] reader_p - image reader
+ * @param[out] lpm_pp - the new table
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_ERROR if the image is inconsistent
+ * @return OES_STATUS_NO_MEMORY if out of memory
+ */
+oes_status_e
+oes_lpm4_load(struct oes_image_reader * reader_p,
+              struct oes_lpm4 ** lpm_pp);
+
+#endif /* __OES_ROUTER_LPM4_H__ */
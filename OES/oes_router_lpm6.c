@@ -0,0 +1,1494 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <endian.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "oes_status.h"
+#include "oes_router_image.h"
+#include "oes_router_lpm6.h"
+
+#define OES_LPM6_POOL_NONE            0      /**< element 0 of each pool is never handed out */
+#define OES_LPM6_CHUNK_BITS           16
+#define OES_LPM6_CHUNK_SIZE           (1 << OES_LPM6_CHUNK_BITS)
+#define OES_LPM6_MAX_CHUNKS           4096
+#define OES_LPM6_MAX_LEVELS           ((128 - OES_LPM6_ROOT_BITS) / OES_LPM6_STRIDE + 1)
+#define OES_LPM6_IMAGE_BUF            1024   /**< elements buffered per image write */
+
+#define OES_LPM6_ENTRY(depth, nh) \
+    (OES_LPM6_ENTRY_VALID | ((unsigned int)(depth) << OES_LPM6_ENTRY_DEPTH_SHIFT) | (nh))
+#define OES_LPM6_ENTRY_DEPTH(entry) \
+    (((entry) >> OES_LPM6_ENTRY_DEPTH_SHIFT) & OES_LPM6_ENTRY_DEPTH_MASK)
+
+/*
+ * Array of fixed size elements handed out in blocks of 1..64 elements.
+ * It grows a chunk at a time and a block never crosses chunks, so
+ * blocks stay in place while other tables read them.
+ */
+struct oes_lpm6_pool {
+    unsigned char * chunks[OES_LPM6_MAX_CHUNKS];
+    unsigned int  * refs[OES_LPM6_MAX_CHUNKS];   /**< references per block, at its first element */
+    unsigned int    elem_size;
+    unsigned int    chunk_cnt;
+    unsigned int    used;            /**< high water mark */
+    unsigned int    in_use;          /**< elements in live blocks */
+    unsigned int    free_head[65];   /**< free blocks per block size */
+};
+
+static pthread_mutex_t      oes_lpm6_lock = PTHREAD_MUTEX_INITIALIZER; /**< serializes table changes */
+static unsigned int         oes_lpm6_tables;        /**< the pools go with the last table */
+static struct oes_lpm6_pool oes_lpm6_nodes = { .elem_size = sizeof(struct oes_lpm6_node), .used = 1 };
+static struct oes_lpm6_pool oes_lpm6_results = { .elem_size = sizeof(unsigned int), .used = 1 };
+static struct oes_lpm6_page oes_lpm6_empty_page;    /**< every page of an empty table, never written */
+
+#define OES_LPM6_ELEM(pool_p, idx) \
+    ((pool_p)->chunks[(idx) >> OES_LPM6_CHUNK_BITS] + \
+     (size_t)((idx) & (OES_LPM6_CHUNK_SIZE - 1)) * (pool_p)->elem_size)
+#define OES_LPM6_REF(pool_p, idx) \
+    ((pool_p)->refs[(idx) >> OES_LPM6_CHUNK_BITS][(idx) & (OES_LPM6_CHUNK_SIZE - 1)])
+#define OES_LPM6_NODE(idx) \
+    ((struct oes_lpm6_node *)oes_lpm6_nodes.chunks[(idx) >> OES_LPM6_CHUNK_BITS] + \
+     ((idx) & (OES_LPM6_CHUNK_SIZE - 1)))
+#define OES_LPM6_RESULT(idx) \
+    ((unsigned int *)oes_lpm6_results.chunks[(idx) >> OES_LPM6_CHUNK_BITS] + \
+     ((idx) & (OES_LPM6_CHUNK_SIZE - 1)))
+
+typedef unsigned __int128 oes_lpm6_key_t;
+
+static inline oes_lpm6_key_t
+oes_lpm6_key(const unsigned char *addr)
+{
+    unsigned long long hi, lo;
+
+    memcpy(&hi, addr, sizeof(hi));
+    memcpy(&lo, addr + sizeof(hi), sizeof(lo));
+    return ((oes_lpm6_key_t)be64toh(hi) << 64) | be64toh(lo);
+}
+
+static inline oes_lpm6_key_t
+oes_lpm6_mask(unsigned int depth)
+{
+    return depth ? ~(oes_lpm6_key_t)0 << (128 - depth) : 0;
+}
+
+/* the OES_LPM6_STRIDE bits of key starting at bit off, bits past 128 read 0 */
+static inline unsigned int
+oes_lpm6_chunk(oes_lpm6_key_t key, unsigned int off)
+{
+    if (off + OES_LPM6_STRIDE <= 128) {
+        return (unsigned int)(key >> (128 - OES_LPM6_STRIDE - off)) & 63;
+    }
+    return (unsigned int)(key << (off - (128 - OES_LPM6_STRIDE))) & 63;
+}
+
+/* internal bitmap positions of every prefix of chunk c (lengths 0-5) */
+static inline unsigned long long
+oes_lpm6_match_mask(unsigned int c)
+{
+    return 1ULL |
+           (1ULL << (1 + (c >> 5))) |
+           (1ULL << (3 + (c >> 4))) |
+           (1ULL << (7 + (c >> 3))) |
+           (1ULL << (15 + (c >> 2))) |
+           (1ULL << (31 + (c >> 1)));
+}
+
+static inline unsigned int
+oes_lpm6_rank(unsigned long long bitmap, unsigned int bit)
+{
+    return __builtin_popcountll(bitmap & ((1ULL << bit) - 1));
+}
+
+static void
+oes_lpm6_pool_free(struct oes_lpm6_pool *pool_p, unsigned int idx, unsigned int cnt)
+{
+    memcpy(OES_LPM6_ELEM(pool_p, idx), &pool_p->free_head[cnt], sizeof(unsigned int));
+    pool_p->free_head[cnt] = idx;
+    pool_p->in_use -= cnt;
+}
+
+/*
+ * Returns the first element of a block of cnt elements holding one
+ * reference, OES_LPM6_POOL_NONE if out of memory.
+ */
+static unsigned int
+oes_lpm6_pool_alloc(struct oes_lpm6_pool *pool_p, unsigned int cnt)
+{
+    unsigned char *chunk_p;
+    unsigned int  *refs_p;
+    unsigned int   idx, left;
+
+    idx = pool_p->free_head[cnt];
+    if (idx != OES_LPM6_POOL_NONE) {
+        memcpy(&pool_p->free_head[cnt], OES_LPM6_ELEM(pool_p, idx), sizeof(unsigned int));
+    } else {
+        left = OES_LPM6_CHUNK_SIZE - (pool_p->used & (OES_LPM6_CHUNK_SIZE - 1));
+        if (left < cnt) {
+            /* the tail of the chunk is too short, keep it as a smaller free block */
+            pool_p->in_use += left;
+            oes_lpm6_pool_free(pool_p, pool_p->used, left);
+            pool_p->used += left;
+        }
+        if ((pool_p->used >> OES_LPM6_CHUNK_BITS) == pool_p->chunk_cnt) {
+            if (pool_p->chunk_cnt == OES_LPM6_MAX_CHUNKS) {
+                return OES_LPM6_POOL_NONE;
+            }
+            chunk_p = malloc((size_t)OES_LPM6_CHUNK_SIZE * pool_p->elem_size);
+            refs_p = malloc(OES_LPM6_CHUNK_SIZE * sizeof(*refs_p));
+            if ((chunk_p == NULL) || (refs_p == NULL)) {
+                free(chunk_p);
+                free(refs_p);
+                return OES_LPM6_POOL_NONE;
+            }
+            pool_p->chunks[pool_p->chunk_cnt] = chunk_p;
+            pool_p->refs[pool_p->chunk_cnt] = refs_p;
+            pool_p->chunk_cnt++;
+        }
+        idx = pool_p->used;
+        pool_p->used += cnt;
+    }
+    OES_LPM6_REF(pool_p, idx) = 1;
+    pool_p->in_use += cnt;
+    return idx;
+}
+
+/* Frees every chunk, once no table is left. */
+static void
+oes_lpm6_pool_release(struct oes_lpm6_pool *pool_p)
+{
+    unsigned int i;
+
+    for (i = 0; i < pool_p->chunk_cnt; i++) {
+        free(pool_p->chunks[i]);
+        free(pool_p->refs[i]);
+    }
+    pool_p->chunk_cnt = 0;
+    pool_p->used = 1;
+    pool_p->in_use = 0;
+    memset(pool_p->free_head, 0, sizeof(pool_p->free_head));
+}
+
+/* Takes a reference on the blocks a new copy of a node points to. */
+static void
+oes_lpm6_node_hold(const struct oes_lpm6_node *node_p)
+{
+    if (node_p->external) {
+        OES_LPM6_REF(&oes_lpm6_nodes, node_p->child_base)++;
+    }
+    if (node_p->internal) {
+        OES_LPM6_REF(&oes_lpm6_results, node_p->result_base)++;
+    }
+}
+
+static void
+oes_lpm6_results_put(unsigned int base, unsigned int cnt)
+{
+    if (--OES_LPM6_REF(&oes_lpm6_results, base) == 0) {
+        oes_lpm6_pool_free(&oes_lpm6_results, base, cnt);
+    }
+}
+
+/* Drops a reference on a node block, freeing the subtree only it held with the last one. */
+static void
+oes_lpm6_nodes_put(unsigned int base, unsigned int cnt)
+{
+    const struct oes_lpm6_node *node_p;
+    unsigned int                i;
+
+    if (--OES_LPM6_REF(&oes_lpm6_nodes, base)) {
+        return;
+    }
+    for (i = 0; i < cnt; i++) {
+        node_p = OES_LPM6_NODE(base + i);
+        if (node_p->external) {
+            oes_lpm6_nodes_put(node_p->child_base, __builtin_popcountll(node_p->external));
+        }
+        if (node_p->internal) {
+            oes_lpm6_results_put(node_p->result_base, __builtin_popcountll(node_p->internal));
+        }
+    }
+    oes_lpm6_pool_free(&oes_lpm6_nodes, base, cnt);
+}
+
+/*
+ * Makes the block at *base_p, of cnt elements, private to table lpm_p
+ * about to write it: a block shared with other tables is replaced by a
+ * copy. Returns 0 if out of memory. A table never cloned holds its
+ * blocks alone and skips the reference counts.
+ */
+static int
+oes_lpm6_block_own(const struct oes_lpm6 *lpm_p, struct oes_lpm6_pool *pool_p,
+                   unsigned int *base_p, unsigned int cnt)
+{
+    unsigned int base = *base_p;
+    unsigned int copy, i;
+
+    if (!lpm_p->shared || (OES_LPM6_REF(pool_p, base) == 1)) {
+        return 1;
+    }
+    copy = oes_lpm6_pool_alloc(pool_p, cnt);
+    if (copy == OES_LPM6_POOL_NONE) {
+        return 0;
+    }
+    memcpy(OES_LPM6_ELEM(pool_p, copy), OES_LPM6_ELEM(pool_p, base), (size_t)cnt * pool_p->elem_size);
+    if (pool_p == &oes_lpm6_nodes) {
+        for (i = 0; i < cnt; i++) {
+            oes_lpm6_node_hold(OES_LPM6_NODE(copy + i));
+        }
+    }
+    OES_LPM6_REF(pool_p, base)--;
+    *base_p = copy;
+    return 1;
+}
+
+/*
+ * Returns a copy of the block [base, base + cnt) with a zeroed element
+ * opened at rank, and drops the old block from table lpm_p.
+ * OES_LPM6_POOL_NONE if out of memory.
+ */
+static unsigned int
+oes_lpm6_block_insert(const struct oes_lpm6 *lpm_p, struct oes_lpm6_pool *pool_p,
+                      unsigned int base, unsigned int cnt, unsigned int rank)
+{
+    unsigned int elem_size = pool_p->elem_size;
+    unsigned int new_base, i;
+
+    new_base = oes_lpm6_pool_alloc(pool_p, cnt + 1);
+    if (new_base == OES_LPM6_POOL_NONE) {
+        return OES_LPM6_POOL_NONE;
+    }
+    if (rank) {
+        memcpy(OES_LPM6_ELEM(pool_p, new_base), OES_LPM6_ELEM(pool_p, base), (size_t)rank * elem_size);
+    }
+    memset(OES_LPM6_ELEM(pool_p, new_base + rank), 0, elem_size);
+    if (cnt - rank) {
+        memcpy(OES_LPM6_ELEM(pool_p, new_base + rank + 1), OES_LPM6_ELEM(pool_p, base + rank),
+               (size_t)(cnt - rank) * elem_size);
+    }
+    if (cnt == 0) {
+        return new_base;
+    }
+    if (!lpm_p->shared || (OES_LPM6_REF(pool_p, base) == 1)) {
+        /* the copy takes over the references of the old block */
+        oes_lpm6_pool_free(pool_p, base, cnt);
+    } else {
+        OES_LPM6_REF(pool_p, base)--;
+        for (i = 0; (pool_p == &oes_lpm6_nodes) && (i <= cnt); i++) {
+            oes_lpm6_node_hold(OES_LPM6_NODE(new_base + i));
+        }
+    }
+    return new_base;
+}
+
+/*
+ * Closes the element at rank of a private block in place, so deletion
+ * never allocates. Returns the base, OES_LPM6_POOL_NONE once empty.
+ */
+static unsigned int
+oes_lpm6_block_remove(struct oes_lpm6_pool *pool_p, unsigned int base,
+                      unsigned int cnt, unsigned int rank)
+{
+    memmove(OES_LPM6_ELEM(pool_p, base + rank), OES_LPM6_ELEM(pool_p, base + rank + 1),
+            (size_t)(cnt - rank - 1) * pool_p->elem_size);
+    oes_lpm6_pool_free(pool_p, base + cnt - 1, 1);
+    return (cnt == 1) ? OES_LPM6_POOL_NONE : base;
+}
+
+static void
+oes_lpm6_page_put(struct oes_lpm6_page *page_p)
+{
+    unsigned int s;
+
+    if ((page_p == &oes_lpm6_empty_page) || --page_p->refcnt) {
+        return;
+    }
+    for (s = 0; s < OES_LPM6_PAGE_SLOTS; s++) {
+        if (page_p->root_node[s] != OES_LPM6_POOL_NONE) {
+            oes_lpm6_nodes_put(page_p->root_node[s], 1);
+        }
+    }
+    free(page_p);
+}
+
+/* Returns page p ready to be written, copying it first if shared. NULL if out of memory. */
+static struct oes_lpm6_page *
+oes_lpm6_page_own(struct oes_lpm6 *lpm_p, unsigned int p)
+{
+    struct oes_lpm6_page *page_p = lpm_p->pages[p];
+    struct oes_lpm6_page *copy_p;
+    unsigned int          s;
+
+    if ((page_p != &oes_lpm6_empty_page) && (page_p->refcnt == 1)) {
+        return page_p;
+    }
+    copy_p = malloc(sizeof(*copy_p));
+    if (copy_p == NULL) {
+        return NULL;
+    }
+    memcpy(copy_p, page_p, sizeof(*copy_p));
+    copy_p->refcnt = 1;
+    for (s = 0; s < OES_LPM6_PAGE_SLOTS; s++) {
+        if (copy_p->root_node[s] != OES_LPM6_POOL_NONE) {
+            OES_LPM6_REF(&oes_lpm6_nodes, copy_p->root_node[s])++;
+        }
+    }
+    oes_lpm6_page_put(page_p);
+    lpm_p->pages[p] = copy_p;
+    return copy_p;
+}
+
+/* the next hop + 1 slot of a prefix of up to 16 bits, in the table or its page */
+static inline unsigned int *
+oes_lpm6_short_rule(const struct oes_lpm6 *lpm_p, unsigned int top, unsigned int depth)
+{
+    if (depth < OES_LPM6_PAGE_DEPTH) {
+        return (unsigned int *)&lpm_p->short_rules[(1U << depth) - 1 +
+                                                   (top >> (OES_LPM6_ROOT_BITS - depth))];
+    }
+    return &lpm_p->pages[top / OES_LPM6_PAGE_SLOTS]->short_rules[
+        (1U << (depth - OES_LPM6_PAGE_DEPTH)) - 1 +
+        ((top % OES_LPM6_PAGE_SLOTS) >> (OES_LPM6_ROOT_BITS - depth))];
+}
+
+/* Owns the pages a prefix of up to 16 bits is expanded into. */
+static oes_status_e
+oes_lpm6_short_own(struct oes_lpm6 *lpm_p, unsigned int top, unsigned int depth)
+{
+    unsigned int p;
+
+    for (p = top / OES_LPM6_PAGE_SLOTS;
+         p <= (top + (1U << (OES_LPM6_ROOT_BITS - depth)) - 1) / OES_LPM6_PAGE_SLOTS; p++) {
+        if (oes_lpm6_page_own(lpm_p, p) == NULL) {
+            return OES_STATUS_NO_MEMORY;
+        }
+    }
+    return OES_STATUS_SUCCESS;
+}
+
+struct oes_lpm6 *
+oes_lpm6_create(void)
+{
+    struct oes_lpm6 *lpm_p = calloc(1, sizeof(*lpm_p));
+    unsigned int     p;
+
+    if (lpm_p == NULL) {
+        return NULL;
+    }
+    for (p = 0; p < OES_LPM6_PAGES; p++) {
+        lpm_p->pages[p] = &oes_lpm6_empty_page;
+    }
+    pthread_mutex_lock(&oes_lpm6_lock);
+    oes_lpm6_tables++;
+    pthread_mutex_unlock(&oes_lpm6_lock);
+    return lpm_p;
+}
+
+struct oes_lpm6 *
+oes_lpm6_clone(struct oes_lpm6 *lpm_p)
+{
+    struct oes_lpm6 *clone_p = malloc(sizeof(*clone_p));
+    unsigned int     p;
+
+    if (clone_p == NULL) {
+        return NULL;
+    }
+    pthread_mutex_lock(&oes_lpm6_lock);
+    lpm_p->shared = 1;
+    memcpy(clone_p, lpm_p, sizeof(*clone_p));
+    for (p = 0; p < OES_LPM6_PAGES; p++) {
+        if (clone_p->pages[p] != &oes_lpm6_empty_page) {
+            clone_p->pages[p]->refcnt++;
+        }
+    }
+    oes_lpm6_tables++;
+    pthread_mutex_unlock(&oes_lpm6_lock);
+    return clone_p;
+}
+
+/* caller holds oes_lpm6_lock */
+static void
+oes_lpm6_flush_locked(struct oes_lpm6 *lpm_p)
+{
+    unsigned int p;
+
+    for (p = 0; p < OES_LPM6_PAGES; p++) {
+        oes_lpm6_page_put(lpm_p->pages[p]);
+        lpm_p->pages[p] = &oes_lpm6_empty_page;
+    }
+    memset(lpm_p->short_rules, 0, sizeof(lpm_p->short_rules));
+    lpm_p->rules_cnt = 0;
+    lpm_p->nodes_cnt = 0;
+    lpm_p->shared = 0;
+}
+
+void
+oes_lpm6_destroy(struct oes_lpm6 *lpm_p)
+{
+    if (lpm_p == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&oes_lpm6_lock);
+    oes_lpm6_flush_locked(lpm_p);
+    if (--oes_lpm6_tables == 0) {
+        oes_lpm6_pool_release(&oes_lpm6_nodes);
+        oes_lpm6_pool_release(&oes_lpm6_results);
+    }
+    pthread_mutex_unlock(&oes_lpm6_lock);
+    free(lpm_p);
+}
+
+void
+oes_lpm6_flush(struct oes_lpm6 *lpm_p)
+{
+    pthread_mutex_lock(&oes_lpm6_lock);
+    oes_lpm6_flush_locked(lpm_p);
+    pthread_mutex_unlock(&oes_lpm6_lock);
+}
+
+/* prefixes of up to 16 bits are expanded into the root table, as tbl24 in DIR-24-8 */
+static oes_status_e
+oes_lpm6_short_add(struct oes_lpm6 *lpm_p, unsigned int top,
+                   unsigned int depth, unsigned int next_hop)
+{
+    unsigned int          entry = OES_LPM6_ENTRY(depth, next_hop);
+    struct oes_lpm6_page *page_p;
+    unsigned int         *rule_p;
+    unsigned int          i, old;
+
+    if (oes_lpm6_short_own(lpm_p, top, depth) != OES_STATUS_SUCCESS) {
+        return OES_STATUS_NO_MEMORY;
+    }
+    rule_p = oes_lpm6_short_rule(lpm_p, top, depth);
+    if (*rule_p == 0) {
+        lpm_p->rules_cnt++;
+    }
+    *rule_p = next_hop + 1;
+    for (i = top; i < top + (1U << (OES_LPM6_ROOT_BITS - depth)); i++) {
+        page_p = lpm_p->pages[i / OES_LPM6_PAGE_SLOTS];
+        old = page_p->root_entry[i % OES_LPM6_PAGE_SLOTS];
+        if (!(old & OES_LPM6_ENTRY_VALID) || (OES_LPM6_ENTRY_DEPTH(old) <= depth)) {
+            page_p->root_entry[i % OES_LPM6_PAGE_SLOTS] = entry;
+        }
+    }
+    return OES_STATUS_SUCCESS;
+}
+
+static oes_status_e
+oes_lpm6_short_delete(struct oes_lpm6 *lpm_p, unsigned int top, unsigned int depth)
+{
+    unsigned int          parent_entry = 0;
+    struct oes_lpm6_page *page_p;
+    unsigned int          parent_depth, parent_rule, i, old;
+
+    if (*oes_lpm6_short_rule(lpm_p, top, depth) == 0) {
+        return OES_STATUS_ENTRY_NOT_FOUND;
+    }
+    if (oes_lpm6_short_own(lpm_p, top, depth) != OES_STATUS_SUCCESS) {
+        return OES_STATUS_NO_MEMORY;
+    }
+    *oes_lpm6_short_rule(lpm_p, top, depth) = 0;
+    lpm_p->rules_cnt--;
+
+    for (parent_depth = depth; parent_depth-- > 0;) {
+        parent_rule = *oes_lpm6_short_rule(lpm_p, top, parent_depth);
+        if (parent_rule) {
+            parent_entry = OES_LPM6_ENTRY(parent_depth, parent_rule - 1);
+            break;
+        }
+    }
+    for (i = top; i < top + (1U << (OES_LPM6_ROOT_BITS - depth)); i++) {
+        page_p = lpm_p->pages[i / OES_LPM6_PAGE_SLOTS];
+        old = page_p->root_entry[i % OES_LPM6_PAGE_SLOTS];
+        if ((old & OES_LPM6_ENTRY_VALID) && (OES_LPM6_ENTRY_DEPTH(old) == depth)) {
+            page_p->root_entry[i % OES_LPM6_PAGE_SLOTS] = parent_entry;
+        }
+    }
+    return OES_STATUS_SUCCESS;
+}
+
+/* position of a prefix of depth in the internal bitmap of the node starting at off */
+static inline unsigned int
+oes_lpm6_internal_pos(oes_lpm6_key_t key, unsigned int off, unsigned int depth)
+{
+    unsigned int len = depth - off;
+
+    return (1U << len) - 1 + (len ? oes_lpm6_chunk(key, off) >> (OES_LPM6_STRIDE - len) : 0);
+}
+
+/* caller holds oes_lpm6_lock */
+static oes_status_e
+oes_lpm6_add_locked(struct oes_lpm6 *lpm_p, oes_lpm6_key_t key,
+                    unsigned int depth, unsigned int next_hop)
+{
+    struct oes_lpm6_node *node_p;
+    struct oes_lpm6_page *page_p;
+    unsigned int         *slot_p;
+    unsigned int          top, node, off, c, pos, rank, cnt, base;
+
+    top = (unsigned int)(key >> (128 - OES_LPM6_ROOT_BITS));
+    if (depth <= OES_LPM6_ROOT_BITS) {
+        return oes_lpm6_short_add(lpm_p, top, depth, next_hop);
+    }
+
+    /* shared memory is copied on the way down; a copy changes nothing visible */
+    page_p = oes_lpm6_page_own(lpm_p, top / OES_LPM6_PAGE_SLOTS);
+    if (page_p == NULL) {
+        return OES_STATUS_NO_MEMORY;
+    }
+    slot_p = &page_p->root_node[top % OES_LPM6_PAGE_SLOTS];
+    if (*slot_p == OES_LPM6_POOL_NONE) {
+        node = oes_lpm6_pool_alloc(&oes_lpm6_nodes, 1);
+        if (node == OES_LPM6_POOL_NONE) {
+            return OES_STATUS_NO_MEMORY;
+        }
+        memset(OES_LPM6_NODE(node), 0, sizeof(struct oes_lpm6_node));
+        *slot_p = node;
+        lpm_p->nodes_cnt++;
+    } else if (!oes_lpm6_block_own(lpm_p, &oes_lpm6_nodes, slot_p, 1)) {
+        return OES_STATUS_NO_MEMORY;
+    }
+    node = *slot_p;
+
+    for (off = OES_LPM6_ROOT_BITS; depth - off >= OES_LPM6_STRIDE; off += OES_LPM6_STRIDE) {
+        c = oes_lpm6_chunk(key, off);
+        node_p = OES_LPM6_NODE(node);
+        rank = oes_lpm6_rank(node_p->external, c);
+        cnt = __builtin_popcountll(node_p->external);
+        if (!((node_p->external >> c) & 1)) {
+            base = oes_lpm6_block_insert(lpm_p, &oes_lpm6_nodes, node_p->child_base, cnt, rank);
+            if (base == OES_LPM6_POOL_NONE) {
+                return OES_STATUS_NO_MEMORY;
+            }
+            node_p->child_base = base;
+            node_p->external |= 1ULL << c;
+            lpm_p->nodes_cnt++;
+        } else if (!oes_lpm6_block_own(lpm_p, &oes_lpm6_nodes, &node_p->child_base, cnt)) {
+            return OES_STATUS_NO_MEMORY;
+        }
+        node = node_p->child_base + rank;
+    }
+
+    node_p = OES_LPM6_NODE(node);
+    pos = oes_lpm6_internal_pos(key, off, depth);
+    rank = oes_lpm6_rank(node_p->internal, pos);
+    cnt = __builtin_popcountll(node_p->internal);
+    if (!((node_p->internal >> pos) & 1)) {
+        base = oes_lpm6_block_insert(lpm_p, &oes_lpm6_results, node_p->result_base, cnt, rank);
+        if (base == OES_LPM6_POOL_NONE) {
+            return OES_STATUS_NO_MEMORY;
+        }
+        node_p->result_base = base;
+        node_p->internal |= 1ULL << pos;
+        lpm_p->rules_cnt++;
+    } else if (!oes_lpm6_block_own(lpm_p, &oes_lpm6_results, &node_p->result_base, cnt)) {
+        return OES_STATUS_NO_MEMORY;
+    }
+    *OES_LPM6_RESULT(node_p->result_base + rank) = next_hop;
+    return OES_STATUS_SUCCESS;
+}
+
+oes_status_e
+oes_lpm6_add(struct oes_lpm6 *lpm_p,
+             const unsigned char *addr,
+             unsigned int depth,
+             unsigned int next_hop)
+{
+    oes_status_e status;
+
+    if ((depth > 128) || (next_hop > OES_LPM6_MAX_NEXT_HOP)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_mutex_lock(&oes_lpm6_lock);
+    status = oes_lpm6_add_locked(lpm_p, oes_lpm6_key(addr) & oes_lpm6_mask(depth), depth, next_hop);
+    pthread_mutex_unlock(&oes_lpm6_lock);
+    return status;
+}
+
+/* Finds the node holding a prefix longer than 16 bits, OES_LPM6_POOL_NONE if absent. */
+static unsigned int
+oes_lpm6_rule_node(const struct oes_lpm6 *lpm_p, oes_lpm6_key_t key, unsigned int depth,
+                   unsigned int *off_p)
+{
+    const struct oes_lpm6_node *node_p;
+    unsigned int                top = (unsigned int)(key >> (128 - OES_LPM6_ROOT_BITS));
+    unsigned int                node, off, c;
+
+    node = lpm_p->pages[top / OES_LPM6_PAGE_SLOTS]->root_node[top % OES_LPM6_PAGE_SLOTS];
+    if (node == OES_LPM6_POOL_NONE) {
+        return OES_LPM6_POOL_NONE;
+    }
+    for (off = OES_LPM6_ROOT_BITS; depth - off >= OES_LPM6_STRIDE; off += OES_LPM6_STRIDE) {
+        c = oes_lpm6_chunk(key, off);
+        node_p = OES_LPM6_NODE(node);
+        if (!((node_p->external >> c) & 1)) {
+            return OES_LPM6_POOL_NONE;
+        }
+        node = node_p->child_base + oes_lpm6_rank(node_p->external, c);
+    }
+    if (!((OES_LPM6_NODE(node)->internal >> oes_lpm6_internal_pos(key, off, depth)) & 1)) {
+        return OES_LPM6_POOL_NONE;
+    }
+    *off_p = off;
+    return node;
+}
+
+/* Owns the page and every block on the path to an existing prefix longer than 16 bits. */
+static oes_status_e
+oes_lpm6_path_own(struct oes_lpm6 *lpm_p, oes_lpm6_key_t key, unsigned int depth)
+{
+    struct oes_lpm6_node *node_p;
+    struct oes_lpm6_page *page_p;
+    unsigned int          top = (unsigned int)(key >> (128 - OES_LPM6_ROOT_BITS));
+    unsigned int         *base_p;
+    unsigned int          node, off, c;
+
+    page_p = oes_lpm6_page_own(lpm_p, top / OES_LPM6_PAGE_SLOTS);
+    if (page_p == NULL) {
+        return OES_STATUS_NO_MEMORY;
+    }
+    base_p = &page_p->root_node[top % OES_LPM6_PAGE_SLOTS];
+    if (!oes_lpm6_block_own(lpm_p, &oes_lpm6_nodes, base_p, 1)) {
+        return OES_STATUS_NO_MEMORY;
+    }
+    node = *base_p;
+    for (off = OES_LPM6_ROOT_BITS; depth - off >= OES_LPM6_STRIDE; off += OES_LPM6_STRIDE) {
+        c = oes_lpm6_chunk(key, off);
+        node_p = OES_LPM6_NODE(node);
+        if (!oes_lpm6_block_own(lpm_p, &oes_lpm6_nodes, &node_p->child_base,
+                                __builtin_popcountll(node_p->external))) {
+            return OES_STATUS_NO_MEMORY;
+        }
+        node = node_p->child_base + oes_lpm6_rank(node_p->external, c);
+    }
+    node_p = OES_LPM6_NODE(node);
+    if (!oes_lpm6_block_own(lpm_p, &oes_lpm6_results, &node_p->result_base,
+                            __builtin_popcountll(node_p->internal))) {
+        return OES_STATUS_NO_MEMORY;
+    }
+    return OES_STATUS_SUCCESS;
+}
+
+/* caller holds oes_lpm6_lock */
+static oes_status_e
+oes_lpm6_unshare_locked(struct oes_lpm6 *lpm_p, oes_lpm6_key_t key, unsigned int depth)
+{
+    unsigned int top = (unsigned int)(key >> (128 - OES_LPM6_ROOT_BITS));
+    unsigned int off;
+
+    if (depth <= OES_LPM6_ROOT_BITS) {
+        if (*oes_lpm6_short_rule(lpm_p, top, depth) == 0) {
+            return OES_STATUS_ENTRY_NOT_FOUND;
+        }
+        return oes_lpm6_short_own(lpm_p, top, depth);
+    }
+    if (oes_lpm6_rule_node(lpm_p, key, depth, &off) == OES_LPM6_POOL_NONE) {
+        return OES_STATUS_ENTRY_NOT_FOUND;
+    }
+    /* the path to an existing prefix of a table never cloned is its own */
+    if (!lpm_p->shared) {
+        return OES_STATUS_SUCCESS;
+    }
+    return oes_lpm6_path_own(lpm_p, key, depth);
+}
+
+oes_status_e
+oes_lpm6_unshare(struct oes_lpm6 *lpm_p,
+                 const unsigned char *addr,
+                 unsigned int depth)
+{
+    oes_status_e status;
+
+    if (depth > 128) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_mutex_lock(&oes_lpm6_lock);
+    status = oes_lpm6_unshare_locked(lpm_p, oes_lpm6_key(addr) & oes_lpm6_mask(depth), depth);
+    pthread_mutex_unlock(&oes_lpm6_lock);
+    return status;
+}
+
+/* caller holds oes_lpm6_lock */
+static oes_status_e
+oes_lpm6_delete_locked(struct oes_lpm6 *lpm_p, oes_lpm6_key_t key, unsigned int depth)
+{
+    struct oes_lpm6_node *node_p;
+    struct oes_lpm6_page *page_p;
+    unsigned int          path_node[OES_LPM6_MAX_LEVELS];
+    unsigned int          path_chunk[OES_LPM6_MAX_LEVELS];
+    unsigned int          top, node, off, c, pos, level = 0;
+    oes_status_e          status;
+
+    top = (unsigned int)(key >> (128 - OES_LPM6_ROOT_BITS));
+    if (depth <= OES_LPM6_ROOT_BITS) {
+        return oes_lpm6_short_delete(lpm_p, top, depth);
+    }
+    /* with the path private, the removal below never allocates */
+    status = oes_lpm6_unshare_locked(lpm_p, key, depth);
+    if (status != OES_STATUS_SUCCESS) {
+        return status;
+    }
+
+    page_p = lpm_p->pages[top / OES_LPM6_PAGE_SLOTS];
+    node = page_p->root_node[top % OES_LPM6_PAGE_SLOTS];
+    for (off = OES_LPM6_ROOT_BITS; depth - off >= OES_LPM6_STRIDE; off += OES_LPM6_STRIDE) {
+        c = oes_lpm6_chunk(key, off);
+        node_p = OES_LPM6_NODE(node);
+        path_node[level] = node;
+        path_chunk[level] = c;
+        level++;
+        node = node_p->child_base + oes_lpm6_rank(node_p->external, c);
+    }
+
+    node_p = OES_LPM6_NODE(node);
+    pos = oes_lpm6_internal_pos(key, off, depth);
+    node_p->result_base = oes_lpm6_block_remove(&oes_lpm6_results, node_p->result_base,
+                                                __builtin_popcountll(node_p->internal),
+                                                oes_lpm6_rank(node_p->internal, pos));
+    node_p->internal &= ~(1ULL << pos);
+    lpm_p->rules_cnt--;
+
+    /* prune the nodes left empty, bottom up */
+    while ((node_p->internal == 0) && (node_p->external == 0)) {
+        lpm_p->nodes_cnt--;
+        if (level == 0) {
+            oes_lpm6_pool_free(&oes_lpm6_nodes, node, 1);
+            page_p->root_node[top % OES_LPM6_PAGE_SLOTS] = OES_LPM6_POOL_NONE;
+            break;
+        }
+        level--;
+        node = path_node[level];
+        c = path_chunk[level];
+        node_p = OES_LPM6_NODE(node);
+        node_p->child_base = oes_lpm6_block_remove(&oes_lpm6_nodes, node_p->child_base,
+                                                   __builtin_popcountll(node_p->external),
+                                                   oes_lpm6_rank(node_p->external, c));
+        node_p->external &= ~(1ULL << c);
+    }
+    return OES_STATUS_SUCCESS;
+}
+
+oes_status_e
+oes_lpm6_delete(struct oes_lpm6 *lpm_p,
+                const unsigned char *addr,
+                unsigned int depth)
+{
+    oes_status_e status;
+
+    if (depth > 128) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    pthread_mutex_lock(&oes_lpm6_lock);
+    status = oes_lpm6_delete_locked(lpm_p, oes_lpm6_key(addr) & oes_lpm6_mask(depth), depth);
+    pthread_mutex_unlock(&oes_lpm6_lock);
+    return status;
+}
+
+oes_status_e
+oes_lpm6_rule_get(const struct oes_lpm6 *lpm_p,
+                  const unsigned char *addr,
+                  unsigned int depth,
+                  unsigned int *next_hop_p)
+{
+    oes_lpm6_key_t              key;
+    const struct oes_lpm6_node *node_p;
+    unsigned int                top, node, off, pos, rule;
+
+    if (depth > 128) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    key = oes_lpm6_key(addr) & oes_lpm6_mask(depth);
+    top = (unsigned int)(key >> (128 - OES_LPM6_ROOT_BITS));
+    if (depth <= OES_LPM6_ROOT_BITS) {
+        rule = *oes_lpm6_short_rule(lpm_p, top, depth);
+        if (rule == 0) {
+            return OES_STATUS_ENTRY_NOT_FOUND;
+        }
+        *next_hop_p = rule - 1;
+        return OES_STATUS_SUCCESS;
+    }
+
+    node = oes_lpm6_rule_node(lpm_p, key, depth, &off);
+    if (node == OES_LPM6_POOL_NONE) {
+        return OES_STATUS_ENTRY_NOT_FOUND;
+    }
+    node_p = OES_LPM6_NODE(node);
+    pos = oes_lpm6_internal_pos(key, off, depth);
+    *next_hop_p = *OES_LPM6_RESULT(node_p->result_base + oes_lpm6_rank(node_p->internal, pos));
+    return OES_STATUS_SUCCESS;
+}
+
+int
+oes_lpm6_lookup(const struct oes_lpm6 *lpm_p,
+                const unsigned char *addr,
+                unsigned int *next_hop_p)
+{
+    oes_lpm6_key_t              key = oes_lpm6_key(addr);
+    const struct oes_lpm6_node *node_p;
+    unsigned long long          match;
+    unsigned int                top = (unsigned int)(key >> (128 - OES_LPM6_ROOT_BITS));
+    const struct oes_lpm6_page *page_p = lpm_p->pages[top / OES_LPM6_PAGE_SLOTS];
+    unsigned int                entry = page_p->root_entry[top % OES_LPM6_PAGE_SLOTS];
+    unsigned int                node = page_p->root_node[top % OES_LPM6_PAGE_SLOTS];
+    unsigned int                off = OES_LPM6_ROOT_BITS;
+    unsigned int                c, pos;
+    int                         found = (entry & OES_LPM6_ENTRY_VALID) != 0;
+
+    *next_hop_p = entry & OES_LPM6_ENTRY_NH_MASK;
+    while (node != OES_LPM6_POOL_NONE) {
+        node_p = OES_LPM6_NODE(node);
+        c = oes_lpm6_chunk(key, off);
+        match = node_p->internal & oes_lpm6_match_mask(c);
+        if (match) {
+            /* longer prefixes sit at higher positions */
+            pos = 63 - __builtin_clzll(match);
+            *next_hop_p = *OES_LPM6_RESULT(node_p->result_base +
+                                           oes_lpm6_rank(node_p->internal, pos));
+            found = 1;
+        }
+        if (!((node_p->external >> c) & 1)) {
+            break;
+        }
+        node = node_p->child_base + oes_lpm6_rank(node_p->external, c);
+        off += OES_LPM6_STRIDE;
+    }
+    return found;
+}
+
+/*
+ * The addresses of a group walk their trees in lockstep, one level per
+ * round: a round prefetches the next node of every address still
+ * walking, so their cache misses overlap. Results are only read once
+ * every walk of the group is done.
+ */
+void
+oes_lpm6_lookup_bulk(const struct oes_lpm6 *lpm_p,
+                     const unsigned char (*addr_list_p)[16],
+                     unsigned int *next_hop_list_p,
+                     unsigned int cnt)
+{
+    oes_lpm6_key_t              keys[OES_LPM6_BULK_GROUP];
+    const struct oes_lpm6_page *pages[OES_LPM6_BULK_GROUP];
+    unsigned int                nodes[OES_LPM6_BULK_GROUP];
+    unsigned int                results[OES_LPM6_BULK_GROUP];
+    unsigned char               walking[OES_LPM6_BULK_GROUP];
+    const struct oes_lpm6_node *node_p;
+    unsigned long long          match;
+    unsigned int                i, j, n, top, entry, c, off, active;
+
+    for (i = 0; i < cnt; i += n) {
+        n = (cnt - i < OES_LPM6_BULK_GROUP) ? cnt - i : OES_LPM6_BULK_GROUP;
+        for (j = 0; j < n; j++) {
+            keys[j] = oes_lpm6_key(addr_list_p[i + j]);
+            top = (unsigned int)(keys[j] >> (128 - OES_LPM6_ROOT_BITS));
+            pages[j] = lpm_p->pages[top / OES_LPM6_PAGE_SLOTS];
+            __builtin_prefetch(&pages[j]->root_entry[top % OES_LPM6_PAGE_SLOTS]);
+            __builtin_prefetch(&pages[j]->root_node[top % OES_LPM6_PAGE_SLOTS]);
+        }
+        active = 0;
+        for (j = 0; j < n; j++) {
+            top = (unsigned int)(keys[j] >> (128 - OES_LPM6_ROOT_BITS)) % OES_LPM6_PAGE_SLOTS;
+            entry = pages[j]->root_entry[top];
+            next_hop_list_p[i + j] = (entry & OES_LPM6_ENTRY_VALID) ?
+                                     (entry & OES_LPM6_ENTRY_NH_MASK) : OES_LPM6_NO_NEXT_HOP;
+            results[j] = OES_LPM6_POOL_NONE;
+            nodes[j] = pages[j]->root_node[top];
+            walking[j] = (nodes[j] != OES_LPM6_POOL_NONE);
+            if (walking[j]) {
+                __builtin_prefetch(OES_LPM6_NODE(nodes[j]));
+                active++;
+            }
+        }
+        for (off = OES_LPM6_ROOT_BITS; active; off += OES_LPM6_STRIDE) {
+            for (j = 0; j < n; j++) {
+                if (!walking[j]) {
+                    continue;
+                }
+                node_p = OES_LPM6_NODE(nodes[j]);
+                c = oes_lpm6_chunk(keys[j], off);
+                match = node_p->internal & oes_lpm6_match_mask(c);
+                if (match) {
+                    /* longer prefixes sit at higher positions */
+                    results[j] = node_p->result_base +
+                                 oes_lpm6_rank(node_p->internal, 63 - __builtin_clzll(match));
+                }
+                if ((node_p->external >> c) & 1) {
+                    nodes[j] = node_p->child_base + oes_lpm6_rank(node_p->external, c);
+                    __builtin_prefetch(OES_LPM6_NODE(nodes[j]));
+                } else {
+                    walking[j] = 0;
+                    active--;
+                    if (results[j] != OES_LPM6_POOL_NONE) {
+                        __builtin_prefetch(OES_LPM6_RESULT(results[j]));
+                    }
+                }
+            }
+        }
+        for (j = 0; j < n; j++) {
+            if (results[j] != OES_LPM6_POOL_NONE) {
+                next_hop_list_p[i + j] = *OES_LPM6_RESULT(results[j]);
+            }
+        }
+    }
+}
+
+static inline void
+oes_lpm6_addr(oes_lpm6_key_t key, unsigned char *addr)
+{
+    unsigned long long hi = htobe64((unsigned long long)(key >> 64));
+    unsigned long long lo = htobe64((unsigned long long)key);
+
+    memcpy(addr, &hi, sizeof(hi));
+    memcpy(addr + sizeof(hi), &lo, sizeof(lo));
+}
+
+static void
+oes_lpm6_walk_fn_call(oes_lpm6_walk_fn fn, void *ctx_p, oes_lpm6_key_t key,
+                      unsigned int depth, unsigned int next_hop)
+{
+    unsigned char addr[16];
+
+    oes_lpm6_addr(key, addr);
+    fn(ctx_p, addr, depth, next_hop);
+}
+
+/* visits the prefixes of the node starting at bit off, then its children */
+static void
+oes_lpm6_walk_node(unsigned int node, oes_lpm6_key_t key, unsigned int off,
+                   oes_lpm6_walk_fn fn, void *ctx_p)
+{
+    const struct oes_lpm6_node *node_p = OES_LPM6_NODE(node);
+    unsigned long long          bits;
+    unsigned int                pos, len, rank = 0, c;
+
+    for (bits = node_p->internal; bits; bits &= bits - 1, rank++) {
+        pos = __builtin_ctzll(bits);
+        len = 31 - __builtin_clz(pos + 1);
+        oes_lpm6_walk_fn_call(fn, ctx_p,
+                              key | ((oes_lpm6_key_t)(pos + 1 - (1U << len)) << (128 - off - len)),
+                              off + len, *OES_LPM6_RESULT(node_p->result_base + rank));
+    }
+    rank = 0;
+    for (bits = node_p->external; bits; bits &= bits - 1, rank++) {
+        c = __builtin_ctzll(bits);
+        /* the last level covers bits past 128, which read as 0 */
+        oes_lpm6_walk_node(node_p->child_base + rank,
+                           key | ((off + OES_LPM6_STRIDE <= 128) ?
+                                  (oes_lpm6_key_t)c << (128 - off - OES_LPM6_STRIDE) :
+                                  (oes_lpm6_key_t)c >> (off + OES_LPM6_STRIDE - 128)),
+                           off + OES_LPM6_STRIDE, fn, ctx_p);
+    }
+}
+
+void
+oes_lpm6_walk(const struct oes_lpm6 *lpm_p,
+              oes_lpm6_walk_fn fn,
+              void *ctx_p)
+{
+    unsigned int depth, top, rule, node;
+
+    for (depth = 0; depth <= OES_LPM6_ROOT_BITS; depth++) {
+        for (top = 0; top < OES_LPM6_ROOT_ENTRIES; top += 1U << (OES_LPM6_ROOT_BITS - depth)) {
+            rule = *oes_lpm6_short_rule(lpm_p, top, depth);
+            if (rule) {
+                oes_lpm6_walk_fn_call(fn, ctx_p, (oes_lpm6_key_t)top << (128 - OES_LPM6_ROOT_BITS),
+                                      depth, rule - 1);
+            }
+        }
+    }
+    for (top = 0; top < OES_LPM6_ROOT_ENTRIES; top++) {
+        node = lpm_p->pages[top / OES_LPM6_PAGE_SLOTS]->root_node[top % OES_LPM6_PAGE_SLOTS];
+        if (node != OES_LPM6_POOL_NONE) {
+            oes_lpm6_walk_node(node, (oes_lpm6_key_t)top << (128 - OES_LPM6_ROOT_BITS),
+                               OES_LPM6_ROOT_BITS, fn, ctx_p);
+        }
+    }
+}
+
+/* prefix (key, depth) is not ordered before (from, from_depth) */
+static inline int
+oes_lpm6_walk_reached(oes_lpm6_key_t key, unsigned int depth,
+                      oes_lpm6_key_t from, unsigned int from_depth)
+{
+    return (key > from) || ((key == from) && (depth >= from_depth));
+}
+
+static inline int
+oes_lpm6_walk_from_call(oes_lpm6_walk_from_fn fn, void *ctx_p, oes_lpm6_key_t key,
+                        unsigned int depth, unsigned int next_hop)
+{
+    unsigned char addr[16];
+
+    oes_lpm6_addr(key, addr);
+    return fn(ctx_p, addr, depth, next_hop);
+}
+
+/*
+ * Ordered walk of the node starting at bit off. In order, the prefixes
+ * of the node starting at chunk value c come shortest first, before
+ * the child under c. Children ending before from are skipped, so only
+ * the path to from is searched. Returns non-zero once fn stops.
+ */
+static int
+oes_lpm6_walk_node_from(unsigned int node, oes_lpm6_key_t key, unsigned int off,
+                        oes_lpm6_key_t from, unsigned int from_depth,
+                        oes_lpm6_walk_from_fn fn, void *ctx_p)
+{
+    const struct oes_lpm6_node *node_p = OES_LPM6_NODE(node);
+    unsigned long long          starts = node_p->external;
+    unsigned long long          bits;
+    oes_lpm6_key_t              sub_key;
+    unsigned int                pos, len, c;
+
+    for (bits = node_p->internal; bits; bits &= bits - 1) {
+        pos = __builtin_ctzll(bits);
+        len = 31 - __builtin_clz(pos + 1);
+        starts |= 1ULL << ((pos + 1 - (1U << len)) << (OES_LPM6_STRIDE - len));
+    }
+    for (; starts; starts &= starts - 1) {
+        c = __builtin_ctzll(starts);
+        for (len = 0; len < OES_LPM6_STRIDE; len++) {
+            pos = (1U << len) - 1 + (c >> (OES_LPM6_STRIDE - len));
+            if ((c & ((1U << (OES_LPM6_STRIDE - len)) - 1)) || !((node_p->internal >> pos) & 1)) {
+                continue;
+            }
+            sub_key = key | ((oes_lpm6_key_t)(c >> (OES_LPM6_STRIDE - len)) << (128 - off - len));
+            if (oes_lpm6_walk_reached(sub_key, off + len, from, from_depth) &&
+                oes_lpm6_walk_from_call(fn, ctx_p, sub_key, off + len,
+                                        *OES_LPM6_RESULT(node_p->result_base +
+                                                         oes_lpm6_rank(node_p->internal, pos)))) {
+                return 1;
+            }
+        }
+        if (!((node_p->external >> c) & 1)) {
+            continue;
+        }
+        /* nodes with children start at most at bit 118 */
+        sub_key = key | ((oes_lpm6_key_t)c << (128 - off - OES_LPM6_STRIDE));
+        if ((sub_key | ~oes_lpm6_mask(off + OES_LPM6_STRIDE)) < from) {
+            continue;
+        }
+        if (oes_lpm6_walk_node_from(node_p->child_base + oes_lpm6_rank(node_p->external, c),
+                                    sub_key, off + OES_LPM6_STRIDE, from, from_depth,
+                                    fn, ctx_p)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void
+oes_lpm6_walk_from(const struct oes_lpm6 *lpm_p,
+                   const unsigned char *addr,
+                   unsigned int depth,
+                   oes_lpm6_walk_from_fn fn,
+                   void *ctx_p)
+{
+    oes_lpm6_key_t              from = oes_lpm6_key(addr);
+    oes_lpm6_key_t              key;
+    const struct oes_lpm6_page *page_p;
+    unsigned int                top, len, rule, node;
+
+    for (top = (unsigned int)(from >> (128 - OES_LPM6_ROOT_BITS)); top < OES_LPM6_ROOT_ENTRIES; top++) {
+        key = (oes_lpm6_key_t)top << (128 - OES_LPM6_ROOT_BITS);
+        /* prefixes of up to 16 bits starting at top, then the tree of the slot */
+        for (len = top ? OES_LPM6_ROOT_BITS - __builtin_ctz(top) : 0; len <= OES_LPM6_ROOT_BITS; len++) {
+            rule = *oes_lpm6_short_rule(lpm_p, top, len);
+            if (rule && oes_lpm6_walk_reached(key, len, from, depth) &&
+                oes_lpm6_walk_from_call(fn, ctx_p, key, len, rule - 1)) {
+                return;
+            }
+        }
+        page_p = lpm_p->pages[top / OES_LPM6_PAGE_SLOTS];
+        node = page_p->root_node[top % OES_LPM6_PAGE_SLOTS];
+        if ((node != OES_LPM6_POOL_NONE) &&
+            ((key | ~oes_lpm6_mask(OES_LPM6_ROOT_BITS)) >= from) &&
+            oes_lpm6_walk_node_from(node, key, OES_LPM6_ROOT_BITS, from, depth, fn, ctx_p)) {
+            return;
+        }
+        if (page_p == &oes_lpm6_empty_page) {
+            /* the rest of the page holds nothing, only its first slot can start a shorter prefix */
+            top |= OES_LPM6_PAGE_SLOTS - 1;
+        }
+    }
+}
+
+/* bytes of a node block and of what it points to, share being this table's part of its parent */
+static double
+oes_lpm6_nodes_mem_size(unsigned int base, unsigned int cnt, double share)
+{
+    const struct oes_lpm6_node *node_p;
+    double                      size;
+    unsigned int                i, results;
+
+    share /= OES_LPM6_REF(&oes_lpm6_nodes, base);
+    size = share * cnt * (sizeof(*node_p) + sizeof(unsigned int));
+    for (i = 0; i < cnt; i++) {
+        node_p = OES_LPM6_NODE(base + i);
+        if (node_p->external) {
+            size += oes_lpm6_nodes_mem_size(node_p->child_base,
+                                            __builtin_popcountll(node_p->external), share);
+        }
+        if (node_p->internal) {
+            results = __builtin_popcountll(node_p->internal);
+            size += share / OES_LPM6_REF(&oes_lpm6_results, node_p->result_base) *
+                    results * 2 * sizeof(unsigned int);
+        }
+    }
+    return size;
+}
+
+unsigned long long
+oes_lpm6_mem_size(const struct oes_lpm6 *lpm_p)
+{
+    const struct oes_lpm6_page *page_p;
+    double                      size = sizeof(*lpm_p);
+    double                      share;
+    unsigned int                p, s;
+
+    pthread_mutex_lock(&oes_lpm6_lock);
+    for (p = 0; p < OES_LPM6_PAGES; p++) {
+        page_p = lpm_p->pages[p];
+        if (page_p == &oes_lpm6_empty_page) {
+            continue;
+        }
+        share = 1.0 / page_p->refcnt;
+        size += share * sizeof(*page_p);
+        for (s = 0; s < OES_LPM6_PAGE_SLOTS; s++) {
+            if (page_p->root_node[s] != OES_LPM6_POOL_NONE) {
+                size += oes_lpm6_nodes_mem_size(page_p->root_node[s], 1, share);
+            }
+        }
+    }
+    pthread_mutex_unlock(&oes_lpm6_lock);
+    return (unsigned long long)size;
+}
+
+/*
+ * Image section of a table. It is followed by the short rules, the
+ * nodes, the results and one oes_lpm6_page_image per page in use. Nodes
+ * are numbered from 1 in breadth first order, roots first, so every
+ * block stays contiguous; bases and root slots hold those numbers.
+ */
+struct oes_lpm6_image {
+    unsigned int rules_cnt;
+    unsigned int nodes_cnt;
+    unsigned int image_nodes;        /**< including the unused node 0 */
+    unsigned int image_results;
+    unsigned int page_cnt;
+    unsigned int pad;
+};
+
+struct oes_lpm6_page_image {
+    unsigned int         p;
+    unsigned int         pad;
+    struct oes_lpm6_page page;
+};
+
+/* breadth first order of the nodes of a table being saved */
+struct oes_lpm6_save {
+    unsigned int * order_p;          /**< pool index per image node */
+    unsigned int   size;
+    unsigned int   cnt;
+};
+
+static int
+oes_lpm6_save_push(struct oes_lpm6_save *save_p, unsigned int base, unsigned int cnt)
+{
+    unsigned int *order_p;
+    unsigned int  size;
+
+    if (save_p->cnt + cnt > save_p->size) {
+        size = save_p->size ? save_p->size * 2 : OES_LPM6_IMAGE_BUF;
+        order_p = realloc(save_p->order_p, size * sizeof(*order_p));
+        if (order_p == NULL) {
+            return 0;
+        }
+        save_p->order_p = order_p;
+        save_p->size = size;
+    }
+    while (cnt--) {
+        save_p->order_p[save_p->cnt++] = base++;
+    }
+    return 1;
+}
+
+void
+oes_lpm6_save(const struct oes_lpm6 *lpm_p,
+              struct oes_image_writer *writer_p)
+{
+    struct oes_lpm6_node        nodes[OES_LPM6_IMAGE_BUF];
+    unsigned int                results[OES_LPM6_IMAGE_BUF];
+    struct oes_lpm6_page_image  page_image;
+    struct oes_lpm6_save        save;
+    struct oes_lpm6_image       image;
+    const struct oes_lpm6_node *node_p;
+    unsigned int                p, s, i, n, cnt, child_next, result_next, root_next;
+    int                         ok = 1;
+
+    memset(&save, 0, sizeof(save));
+    memset(&image, 0, sizeof(image));
+    pthread_mutex_lock(&oes_lpm6_lock);
+
+    /* node 0 stands for none, then the roots, then their descendants level by level */
+    ok = oes_lpm6_save_push(&save, OES_LPM6_POOL_NONE, 1);
+    for (p = 0; ok && (p < OES_LPM6_PAGES); p++) {
+        if (lpm_p->pages[p] == &oes_lpm6_empty_page) {
+            continue;
+        }
+        image.page_cnt++;
+        for (s = 0; ok && (s < OES_LPM6_PAGE_SLOTS); s++) {
+            if (lpm_p->pages[p]->root_node[s] != OES_LPM6_POOL_NONE) {
+                ok = oes_lpm6_save_push(&save, lpm_p->pages[p]->root_node[s], 1);
+            }
+        }
+    }
+    for (i = 1; ok && (i < save.cnt); i++) {
+        node_p = OES_LPM6_NODE(save.order_p[i]);
+        if (node_p->external) {
+            ok = oes_lpm6_save_push(&save, node_p->child_base, __builtin_popcountll(node_p->external));
+        }
+        image.image_results += __builtin_popcountll(node_p->internal);
+    }
+    if (!ok) {
+        pthread_mutex_unlock(&oes_lpm6_lock);
+        free(save.order_p);
+        oes_image_fail(writer_p);
+        return;
+    }
+
+    image.rules_cnt = lpm_p->rules_cnt;
+    image.nodes_cnt = lpm_p->nodes_cnt;
+    image.image_nodes = save.cnt;
+    oes_image_write(writer_p, &image, sizeof(image));
+    oes_image_write(writer_p, lpm_p->short_rules, sizeof(lpm_p->short_rules));
+
+    /* blocks were pushed in node order, so replaying the counts renumbers them */
+    root_next = 1;
+    child_next = 1;
+    for (p = 0; p < OES_LPM6_PAGES; p++) {
+        for (s = 0; (lpm_p->pages[p] != &oes_lpm6_empty_page) && (s < OES_LPM6_PAGE_SLOTS); s++) {
+            child_next += (lpm_p->pages[p]->root_node[s] != OES_LPM6_POOL_NONE);
+        }
+    }
+    result_next = 0;
+    memset(nodes, 0, sizeof(nodes[0]));
+    for (i = 0, n = 1; i < save.cnt; i++) {
+        if (i) {
+            nodes[n] = *OES_LPM6_NODE(save.order_p[i]);
+            if (nodes[n].external) {
+                nodes[n].child_base = child_next;
+                child_next += __builtin_popcountll(nodes[n].external);
+            }
+            if (nodes[n].internal) {
+                nodes[n].result_base = result_next;
+                result_next += __builtin_popcountll(nodes[n].internal);
+            }
+            n++;
+        }
+        if ((n == OES_LPM6_IMAGE_BUF) || (i == save.cnt - 1)) {
+            oes_image_write(writer_p, nodes, n * sizeof(nodes[0]));
+            n = 0;
+        }
+    }
+    for (i = 1, n = 0; i < save.cnt; i++) {
+        node_p = OES_LPM6_NODE(save.order_p[i]);
+        cnt = __builtin_popcountll(node_p->internal);
+        if (n + cnt > OES_LPM6_IMAGE_BUF) {
+            oes_image_write(writer_p, results, n * sizeof(results[0]));
+            n = 0;
+        }
+        if (cnt) {
+            memcpy(&results[n], OES_LPM6_RESULT(node_p->result_base), cnt * sizeof(results[0]));
+            n += cnt;
+        }
+    }
+    oes_image_write(writer_p, results, n * sizeof(results[0]));
+
+    for (p = 0; p < OES_LPM6_PAGES; p++) {
+        if (lpm_p->pages[p] == &oes_lpm6_empty_page) {
+            continue;
+        }
+        memset(&page_image, 0, sizeof(page_image));
+        page_image.p = p;
+        page_image.page = *lpm_p->pages[p];
+        page_image.page.refcnt = 1;
+        for (s = 0; s < OES_LPM6_PAGE_SLOTS; s++) {
+            if (page_image.page.root_node[s] != OES_LPM6_POOL_NONE) {
+                page_image.page.root_node[s] = root_next++;
+            }
+        }
+        oes_image_write(writer_p, &page_image, sizeof(page_image));
+    }
+    pthread_mutex_unlock(&oes_lpm6_lock);
+    free(save.order_p);
+}
+
+/* image arrays of a table being loaded */
+struct oes_lpm6_load {
+    const struct oes_lpm6_node * nodes_p;
+    unsigned int                 node_cnt;
+    const unsigned int         * results_p;
+    unsigned int                 result_cnt;
+    oes_status_e                 status;
+};
+
+/*
+ * Copies the image block [image_base, image_base + cnt) and its
+ * subtree into the pools. Returns the new block, or OES_LPM6_POOL_NONE
+ * with load_p->status set. Caller holds oes_lpm6_lock.
+ */
+static unsigned int
+oes_lpm6_load_block(struct oes_lpm6_load *load_p, unsigned int image_base, unsigned int cnt,
+                    unsigned int level)
+{
+    const struct oes_lpm6_node *image_p;
+    struct oes_lpm6_node       *node_p;
+    unsigned int                base, child, result, results, i;
+
+    if ((level >= OES_LPM6_MAX_LEVELS) || (image_base == OES_LPM6_POOL_NONE) ||
+        (image_base > load_p->node_cnt) || (cnt > load_p->node_cnt - image_base)) {
+        load_p->status = OES_STATUS_ERROR;
+        return OES_LPM6_POOL_NONE;
+    }
+    base = oes_lpm6_pool_alloc(&oes_lpm6_nodes, cnt);
+    if (base == OES_LPM6_POOL_NONE) {
+        load_p->status = OES_STATUS_NO_MEMORY;
+        return OES_LPM6_POOL_NONE;
+    }
+    /* linked one by one, so putting the block frees exactly what was loaded */
+    memset(OES_LPM6_NODE(base), 0, cnt * sizeof(*node_p));
+    for (i = 0; i < cnt; i++) {
+        image_p = &load_p->nodes_p[image_base + i];
+        node_p = OES_LPM6_NODE(base + i);
+        if (image_p->external) {
+            child = oes_lpm6_load_block(load_p, image_p->child_base,
+                                        __builtin_popcountll(image_p->external), level + 1);
+            if (child == OES_LPM6_POOL_NONE) {
+                oes_lpm6_nodes_put(base, cnt);
+                return OES_LPM6_POOL_NONE;
+            }
+            node_p->child_base = child;
+            node_p->external = image_p->external;
+        }
+        if (image_p->internal) {
+            results = __builtin_popcountll(image_p->internal);
+            if ((image_p->result_base > load_p->result_cnt) ||
+                (results > load_p->result_cnt - image_p->result_base)) {
+                load_p->status = OES_STATUS_ERROR;
+                oes_lpm6_nodes_put(base, cnt);
+                return OES_LPM6_POOL_NONE;
+            }
+            result = oes_lpm6_pool_alloc(&oes_lpm6_results, results);
+            if (result == OES_LPM6_POOL_NONE) {
+                load_p->status = OES_STATUS_NO_MEMORY;
+                oes_lpm6_nodes_put(base, cnt);
+                return OES_LPM6_POOL_NONE;
+            }
+            memcpy(OES_LPM6_RESULT(result), &load_p->results_p[image_p->result_base],
+                   results * sizeof(unsigned int));
+            node_p->result_base = result;
+            node_p->internal = image_p->internal;
+        }
+    }
+    return base;
+}
+
+oes_status_e
+oes_lpm6_load(struct oes_image_reader *reader_p,
+              struct oes_lpm6 **lpm_pp)
+{
+    const struct oes_lpm6_page_image *page_image_p;
+    const struct oes_lpm6_image      *image_p;
+    const unsigned int               *short_rules_p;
+    struct oes_lpm6_page             *page_p;
+    struct oes_lpm6_load              load;
+    struct oes_lpm6                  *lpm_p;
+    unsigned int                      i, s, root;
+
+    *lpm_pp = NULL;
+    image_p = oes_image_read(reader_p, sizeof(*image_p));
+    short_rules_p = oes_image_read(reader_p, sizeof(lpm_p->short_rules));
+    if ((short_rules_p == NULL) || (image_p->image_nodes == 0)) {
+        return OES_STATUS_ERROR;
+    }
+    memset(&load, 0, sizeof(load));
+    load.nodes_p = oes_image_read(reader_p, (size_t)image_p->image_nodes * sizeof(*load.nodes_p));
+    load.node_cnt = image_p->image_nodes;
+    load.results_p = oes_image_read(reader_p, (size_t)image_p->image_results * sizeof(*load.results_p));
+    load.result_cnt = image_p->image_results;
+    if (reader_p->failed) {
+        return OES_STATUS_ERROR;
+    }
+    lpm_p = oes_lpm6_create();
+    if (lpm_p == NULL) {
+        return OES_STATUS_NO_MEMORY;
+    }
+    memcpy(lpm_p->short_rules, short_rules_p, sizeof(lpm_p->short_rules));
+    lpm_p->rules_cnt = image_p->rules_cnt;
+    lpm_p->nodes_cnt = image_p->nodes_cnt;
+    load.status = OES_STATUS_SUCCESS;
+
+    pthread_mutex_lock(&oes_lpm6_lock);
+    for (i = 0; (load.status == OES_STATUS_SUCCESS) && (i < image_p->page_cnt); i++) {
+        page_image_p = oes_image_read(reader_p, sizeof(*page_image_p));
+        if ((page_image_p == NULL) || (page_image_p->p >= OES_LPM6_PAGES) ||
+            (lpm_p->pages[page_image_p->p] != &oes_lpm6_empty_page)) {
+            load.status = OES_STATUS_ERROR;
+            break;
+        }
+        page_p = malloc(sizeof(*page_p));
+        if (page_p == NULL) {
+            load.status = OES_STATUS_NO_MEMORY;
+            break;
+        }
+        memcpy(page_p, &page_image_p->page, sizeof(*page_p));
+        page_p->refcnt = 1;
+        memset(page_p->root_node, 0, sizeof(page_p->root_node));
+        lpm_p->pages[page_image_p->p] = page_p;
+        for (s = 0; s < OES_LPM6_PAGE_SLOTS; s++) {
+            if (page_image_p->page.root_node[s] == OES_LPM6_POOL_NONE) {
+                continue;
+            }
+            root = oes_lpm6_load_block(&load, page_image_p->page.root_node[s], 1, 0);
+            if (root == OES_LPM6_POOL_NONE) {
+                break;
+            }
+            page_p->root_node[s] = root;
+        }
+    }
+    pthread_mutex_unlock(&oes_lpm6_lock);
+
+    if (load.status != OES_STATUS_SUCCESS) {
+        oes_lpm6_destroy(lpm_p);
+        return load.status;
+    }
+    *lpm_pp = lpm_p;
+    return OES_STATUS_SUCCESS;
+}
@@ -0,0 +1,315 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __OES_ROUTER_LPM6_H__
+#define __OES_ROUTER_LPM6_H__
+
+/************************************************
+ *  IPv6 longest prefix match engine (tree bitmap)
+ *
+ *  The first 16 bits index a direct root table. Prefixes of up to 16
+ *  bits are expanded into its entries, longer ones live in a tree
+ *  bitmap of 6 bit stride nodes hanging off each root slot. A node
+ *  keeps the prefixes ending inside its stride in a 63 bit internal
+ *  bitmap and its children in a 64 bit external bitmap. Both child
+ *  nodes and results are packed in blocks indexed by popcount, so a
+ *  /48 resolves in 6 node visits and a /64 in 9. Nodes and results
+ *  live in index based pools, never referenced by pointer.
+ *
+ *  Tables made by oes_lpm6_clone share memory and copy it only before
+ *  changing it. The root table is cut into pages of one /8 each, and
+ *  the pools are common to all tables, with a reference count per
+ *  block. Changing a prefix copies its page and the shared blocks on
+ *  the path to it, so a clone costs the paths it differs in. Pool
+ *  blocks never move; table changes are serialized by a lock of the
+ *  module, lookups take none.
+ ***********************************************/
+
+#define OES_LPM6_STRIDE               6
+#define OES_LPM6_ROOT_BITS            16
+#define OES_LPM6_ROOT_ENTRIES         (1 << OES_LPM6_ROOT_BITS)
+#define OES_LPM6_PAGE_DEPTH           8             /**< a page covers a /8 */
+#define OES_LPM6_PAGES                (1 << OES_LPM6_PAGE_DEPTH)
+#define OES_LPM6_PAGE_SLOTS           (OES_LPM6_ROOT_ENTRIES / OES_LPM6_PAGES)
+#define OES_LPM6_MAX_NEXT_HOP         0x00ffffff
+#define OES_LPM6_NO_NEXT_HOP          0x01000000    /**< bulk lookup miss */
+#define OES_LPM6_BULK_GROUP           16            /**< bulk lookups walking in lockstep */
+
+#define OES_LPM6_ENTRY_VALID          0x80000000
+#define OES_LPM6_ENTRY_DEPTH_SHIFT    24
+#define OES_LPM6_ENTRY_DEPTH_MASK     0x1f
+#define OES_LPM6_ENTRY_NH_MASK        0x00ffffff
+
+struct oes_lpm6_node {
+    unsigned long long internal;     /**< bit (1 << len) - 1 + value per prefix ending here */
+    unsigned long long external;     /**< bit per child */
+    unsigned int       child_base;   /**< first child in the node pool */
+    unsigned int       result_base;  /**< first next hop in the result pool */
+};
+
+struct oes_lpm6_page {
+    unsigned int refcnt;                                    /**< tables sharing the page */
+    unsigned int root_entry[OES_LPM6_PAGE_SLOTS];           /**< expanded prefixes of up to 16 bits */
+    unsigned int root_node[OES_LPM6_PAGE_SLOTS];            /**< tree per root slot, 0 = none */
+    unsigned int short_rules[2 * OES_LPM6_PAGE_SLOTS - 1];  /**< next hop + 1 per prefix of 8-16 bits */
+};
+
+/* walk callback: prefix as 16 bytes in network order, depth and next hop of one rule */
+typedef void (*oes_lpm6_walk_fn)(void * ctx_p, const unsigned char * addr, unsigned int depth,
+                                 unsigned int next_hop);
+
+/* ordered walk callback: as oes_lpm6_walk_fn, returns non-zero to stop the walk */
+typedef int (*oes_lpm6_walk_from_fn)(void * ctx_p, const unsigned char * addr, unsigned int depth,
+                                     unsigned int next_hop);
+
+struct oes_lpm6 {
+    struct oes_lpm6_page * pages[OES_LPM6_PAGES];
+    unsigned int           short_rules[OES_LPM6_PAGES - 1]; /**< next hop + 1 per prefix under 8 bits */
+    unsigned int           rules_cnt;
+    unsigned int           nodes_cnt;
+    unsigned int           shared;           /**< cloned, or a clone: blocks may have other holders */
+};
+
+/**
+ * This function allocates an empty IPv6 LPM table.
+ *
+ * @return the table, or NULL if out of memory
+ */
+struct oes_lpm6 *
+oes_lpm6_create(void);
+
+/**
+ * This function frees an IPv6 LPM table.
+ *
+ * @param[in] lpm_p - LPM table
+ */
+void
+oes_lpm6_destroy(struct oes_lpm6 * lpm_p);
+
+/**
+ * This function makes a table holding the same prefixes as lpm_p. The
+ * two share every page and tree block until one of them changes it.
+ * Until then lpm_p counts the holders of the blocks it changes, which
+ * a table never cloned skips. The caller excludes changes to lpm_p.
+ *
+ * @param[in] lpm_p - LPM table to copy
+ *
+ * @return the new table, or NULL if out of memory
+ */
+struct oes_lpm6 *
+oes_lpm6_clone(struct oes_lpm6 * lpm_p);
+
+/**
+ * This function adds a prefix or replaces its next hop.
+ *
+ * @param[in] lpm_p - LPM table
+ * @param[in] addr - prefix, 16 bytes in network order, host bits
+ *       are ignored
+ * @param[in] depth - prefix length (0-128)
+ * @param[in] next_hop - next hop, up to OES_LPM6_MAX_NEXT_HOP
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_NO_MEMORY if a pool could not grow
+ */
+oes_status_e
+oes_lpm6_add(struct oes_lpm6 * lpm_p,
+             const unsigned char * addr,
+             unsigned int depth,
+             unsigned int next_hop);
+
+/**
+ * This function deletes a prefix.
+ *
+ * @param[in] lpm_p - LPM table
+ * @param[in] addr - prefix, 16 bytes in network order
+ * @param[in] depth - prefix length (0-128)
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_ENTRY_NOT_FOUND if the prefix is not in the table
+ * @return OES_STATUS_NO_MEMORY if shared memory could not be copied,
+ *       see oes_lpm6_unshare
+ */
+oes_status_e
+oes_lpm6_delete(struct oes_lpm6 * lpm_p,
+                const unsigned char * addr,
+                unsigned int depth);
+
+/**
+ * This function copies the page and the tree blocks on the path to a
+ * prefix that are shared with another table. Until the table is
+ * cloned again, deleting the prefix then cannot fail.
+ *
+ * @param[in] lpm_p - LPM table
+ * @param[in] addr - prefix, 16 bytes in network order
+ * @param[in] depth - prefix length (0-128)
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_ENTRY_NOT_FOUND if the prefix is not in the table
+ * @return OES_STATUS_NO_MEMORY if out of memory
+ */
+oes_status_e
+oes_lpm6_unshare(struct oes_lpm6 * lpm_p,
+                 const unsigned char * addr,
+                 unsigned int depth);
+
+/**
+ * This function deletes all prefixes.
+ *
+ * @param[in] lpm_p - LPM table
+ */
+void
+oes_lpm6_flush(struct oes_lpm6 * lpm_p);
+
+/**
+ * This function gets the next hop of an exact prefix.
+ *
+ * @param[in] lpm_p - LPM table
+ * @param[in] addr - prefix, 16 bytes in network order
+ * @param[in] depth - prefix length (0-128)
+ * @param[out] next_hop_p - next hop
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_ENTRY_NOT_FOUND if the prefix is not in the table
+ */
+oes_status_e
+oes_lpm6_rule_get(const struct oes_lpm6 * lpm_p,
+                  const unsigned char * addr,
+                  unsigned int depth,
+                  unsigned int * next_hop_p);
+
+/**
+ * This function looks up the longest prefix matching addr.
+ *
+ * @param[in] lpm_p - LPM table
+ * @param[in] addr - address, 16 bytes in network order
+ * @param[out] next_hop_p - next hop of the matching prefix
+ *
+ * @return 1 on a match, 0 otherwise
+ */
+int
+oes_lpm6_lookup(const struct oes_lpm6 * lpm_p,
+                const unsigned char * addr,
+                unsigned int * next_hop_p);
+
+/**
+ * This function looks up a batch of addresses. Misses return
+ * OES_LPM6_NO_NEXT_HOP in next_hop_list_p. OES_LPM6_BULK_GROUP
+ * addresses walk their trees together, with the node reads of each
+ * level prefetched, so a batch costs far less than as many
+ * oes_lpm6_lookup calls once the table is out of cache.
+ *
+ * @param[in] lpm_p - LPM table
+ * @param[in] addr_list_p - addresses, 16 bytes each
+ * @param[out] next_hop_list_p - next hop per address
+ * @param[in] cnt - number of addresses
+ */
+void
+oes_lpm6_lookup_bulk(const struct oes_lpm6 * lpm_p,
+                     const unsigned char (* addr_list_p)[16],
+                     unsigned int * next_hop_list_p,
+                     unsigned int cnt);
+
+/**
+ * This function calls fn once per prefix, in no particular order. The
+ * table must not change during the walk.
+ *
+ * @param[in] lpm_p - LPM table
+ * @param[in] fn - callback
+ * @param[in] ctx_p - callback context
+ */
+void
+oes_lpm6_walk(const struct oes_lpm6 * lpm_p,
+              oes_lpm6_walk_fn fn,
+              void * ctx_p);
+
+/**
+ * This function calls fn per prefix in order of address, then of
+ * length, starting at the first prefix not ordered before (addr,
+ * depth), until fn returns non-zero. (addr, depth) does not have to be
+ * in the table and its host bits are kept, depth may be 129. Finding
+ * the start only searches the path to it, so a walk can be resumed
+ * from the last prefix it returned at no cost in the size of the
+ * table. The table must not change during the walk.
+ *
+ * @param[in] lpm_p - LPM table
+ * @param[in] addr - start address, 16 bytes in network order
+ * @param[in] depth - start prefix length (0-129)
+ * @param[in] fn - callback
+ * @param[in] ctx_p - callback context
+ */
+void
+oes_lpm6_walk_from(const struct oes_lpm6 * lpm_p,
+                   const unsigned char * addr,
+                   unsigned int depth,
+                   oes_lpm6_walk_from_fn fn,
+                   void * ctx_p);
+
+/**
+ * This function returns the memory used by the table, in bytes. Memory
+ * shared by several tables is split evenly between them.
+ *
+ * @param[in] lpm_p - LPM table
+ */
+unsigned long long
+oes_lpm6_mem_size(const struct oes_lpm6 * lpm_p);
+
+struct oes_image_writer;
+struct oes_image_reader;
+
+/**
+ * This function writes a table to an image: the table, the tree nodes
+ * and results renumbered into two arrays, then each page in use.
+ *
+ * @param[in] lpm_p - LPM table
+ * @param[in] writer_p - image writer, failed if out of memory
+ */
+void
+oes_lpm6_save(const struct oes_lpm6 * lpm_p,
+              struct oes_image_writer * writer_p);
+
+/**
+ * This function makes a table from an image written by oes_lpm6_save.
+ * Memory is allocated per page and per tree block from the pools, not
+ * per prefix.
+ *
+ * @param[in] reader_p - image reader
+ * @param[out] lpm_pp - the new table
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_ERROR if the image is inconsistent
+ * @return OES_STATUS_NO_MEMORY if out of memory
+ */
+oes_status_e
+oes_lpm6_load(struct oes_image_reader * reader_p,
+              struct oes_lpm6 ** lpm_pp);
+
+#endif /* __OES_ROUTER_LPM6_H__ */
@@ -0,0 +1,643 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <stdlib.h>
+#include <string.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_router_mc.h"
+
+#define OES_MC_MIN_SIZE               1024
+#define OES_MC_OIFS_MIN_SIZE          64
+
+#define OES_MC_ROUTE(table_p, idx)    (&(table_p)->routes[(idx)])
+
+static const struct oes_mc_oifs oes_mc_oifs_empty;
+
+static int
+oes_mc_addr_is_zero(const struct oes_ip_addr *ip_p)
+{
+    static const struct in6_addr zero;
+
+    if (ip_p->version == OES_IPV4) {
+        return ip_p->addr.ipv4.s_addr == 0;
+    }
+    return !memcmp(&ip_p->addr.ipv6, &zero, sizeof(zero));
+}
+
+static void
+oes_mc_addr_set(struct oes_ip_addr *dst_p,
+                const struct oes_ip_addr *src_p)
+{
+    memset(dst_p, 0, sizeof(*dst_p));
+    dst_p->version = src_p->version;
+    if (src_p->version == OES_IPV4) {
+        dst_p->addr.ipv4 = src_p->addr.ipv4;
+    } else {
+        dst_p->addr.ipv6 = src_p->addr.ipv6;
+    }
+}
+
+/* by group (IPv4 first), then source, then ingress rif. Both keys are normalized. */
+static int
+oes_mc_key_cmp(const struct oes_mc_key *a_p,
+               const struct oes_mc_key *b_p)
+{
+    int cmp;
+
+    if (a_p->group.version != b_p->group.version) {
+        return (a_p->group.version < b_p->group.version) ? -1 : 1;
+    }
+    cmp = memcmp(&a_p->group.addr, &b_p->group.addr, sizeof(a_p->group.addr));
+    if (cmp) {
+        return cmp;
+    }
+    cmp = memcmp(&a_p->source.addr, &b_p->source.addr, sizeof(a_p->source.addr));
+    if (cmp) {
+        return cmp;
+    }
+    if (a_p->ingress_rif != b_p->ingress_rif) {
+        return (a_p->ingress_rif < b_p->ingress_rif) ? -1 : 1;
+    }
+    return 0;
+}
+
+/* (S,G) and (*,G) of one group and ingress rif hash alike */
+static unsigned int
+oes_mc_bucket(const struct oes_mc_table *table_p,
+              const struct oes_mc_key *key_p)
+{
+    unsigned int words[4], hash = (key_p->group.version * 0x9e3779b9U) ^ key_p->ingress_rif;
+    unsigned int i;
+
+    memcpy(words, &key_p->group.addr, sizeof(words));
+    for (i = 0; i < 4; i++) {
+        hash = (hash ^ words[i]) * 0x85ebca6bU;
+        hash ^= hash >> 15;
+    }
+    return hash & (table_p->bucket_cnt - 1);
+}
+
+static void
+oes_mc_hash_unlink(struct oes_mc_table *table_p,
+                   unsigned int idx)
+{
+    unsigned int *link_p = &table_p->buckets[oes_mc_bucket(table_p, &table_p->routes[idx].key)];
+
+    while (*link_p != idx) {
+        link_p = &table_p->routes[*link_p].hash_next;
+    }
+    *link_p = table_p->routes[idx].hash_next;
+}
+
+/*
+ * Doubles the chain heads once the table holds more than one route per
+ * bucket, rechaining every route in use. Returns 1 if it rechained.
+ */
+static int
+oes_mc_buckets_grow(struct oes_mc_table *table_p)
+{
+    unsigned int *buckets_p, size, idx, b;
+
+    if (table_p->cnt <= table_p->bucket_cnt) {
+        return 0;
+    }
+    size = table_p->bucket_cnt ? table_p->bucket_cnt * 2 : OES_MC_MIN_SIZE;
+    buckets_p = malloc(size * sizeof(*buckets_p));
+    if (buckets_p == NULL) {
+        /* longer chains, still correct */
+        return 0;
+    }
+    memset(buckets_p, 0xff, size * sizeof(*buckets_p));
+    free(table_p->buckets);
+    table_p->buckets = buckets_p;
+    table_p->bucket_cnt = size;
+    for (idx = 0; idx < table_p->size; idx++) {
+        if (table_p->routes[idx].prio) {
+            b = oes_mc_bucket(table_p, &table_p->routes[idx].key);
+            table_p->routes[idx].hash_next = table_p->buckets[b];
+            table_p->buckets[b] = idx;
+        }
+    }
+    return 1;
+}
+
+static unsigned int
+oes_mc_treap_insert(struct oes_mc_table *table_p,
+                    unsigned int root,
+                    unsigned int idx)
+{
+    struct oes_mc_route *root_p, *child_p;
+    unsigned int         child;
+
+    if (root == OES_MC_NONE) {
+        return idx;
+    }
+    root_p = OES_MC_ROUTE(table_p, root);
+    if (oes_mc_key_cmp(&OES_MC_ROUTE(table_p, idx)->key, &root_p->key) < 0) {
+        child = root_p->left = oes_mc_treap_insert(table_p, root_p->left, idx);
+        child_p = OES_MC_ROUTE(table_p, child);
+        if (child_p->prio > root_p->prio) {
+            /* rotate right */
+            root_p->left = child_p->right;
+            child_p->right = root;
+            return child;
+        }
+    } else {
+        child = root_p->right = oes_mc_treap_insert(table_p, root_p->right, idx);
+        child_p = OES_MC_ROUTE(table_p, child);
+        if (child_p->prio > root_p->prio) {
+            /* rotate left */
+            root_p->right = child_p->left;
+            child_p->left = root;
+            return child;
+        }
+    }
+    return root;
+}
+
+static unsigned int
+oes_mc_treap_merge(struct oes_mc_table *table_p,
+                   unsigned int a,
+                   unsigned int b)
+{
+    if (a == OES_MC_NONE) {
+        return b;
+    }
+    if (b == OES_MC_NONE) {
+        return a;
+    }
+    if (OES_MC_ROUTE(table_p, a)->prio > OES_MC_ROUTE(table_p, b)->prio) {
+        OES_MC_ROUTE(table_p, a)->right = oes_mc_treap_merge(table_p, OES_MC_ROUTE(table_p, a)->right, b);
+        return a;
+    }
+    OES_MC_ROUTE(table_p, b)->left = oes_mc_treap_merge(table_p, a, OES_MC_ROUTE(table_p, b)->left);
+    return b;
+}
+
+static unsigned int
+oes_mc_treap_remove(struct oes_mc_table *table_p,
+                    unsigned int root,
+                    unsigned int idx)
+{
+    struct oes_mc_route *root_p = OES_MC_ROUTE(table_p, root);
+
+    if (root == idx) {
+        return oes_mc_treap_merge(table_p, root_p->left, root_p->right);
+    }
+    if (oes_mc_key_cmp(&OES_MC_ROUTE(table_p, idx)->key, &root_p->key) < 0) {
+        root_p->left = oes_mc_treap_remove(table_p, root_p->left, idx);
+    } else {
+        root_p->right = oes_mc_treap_remove(table_p, root_p->right, idx);
+    }
+    return root;
+}
+
+/* Takes a route off the free list, growing the array if needed. */
+static unsigned int
+oes_mc_alloc(struct oes_mc_table *table_p)
+{
+    struct oes_mc_route *routes_p;
+    unsigned int         size, idx;
+
+    if (table_p->free_head == OES_MC_NONE) {
+        size = table_p->size ? table_p->size * 2 : OES_MC_MIN_SIZE;
+        if (size > OES_MC_MAX_ROUTES) {
+            return OES_MC_NONE;
+        }
+        routes_p = realloc(table_p->routes, size * sizeof(*routes_p));
+        if (routes_p == NULL) {
+            return OES_MC_NONE;
+        }
+        table_p->routes = routes_p;
+        memset(&routes_p[table_p->size], 0, (size - table_p->size) * sizeof(*routes_p));
+        for (idx = size; idx-- > table_p->size;) {
+            routes_p[idx].hash_next = table_p->free_head;
+            table_p->free_head = idx;
+        }
+        table_p->size = size;
+    }
+    idx = table_p->free_head;
+    table_p->free_head = table_p->routes[idx].hash_next;
+    return idx;
+}
+
+/* xorshift, never 0 so a set prio marks the route in use */
+static unsigned int
+oes_mc_prio(struct oes_mc_table *table_p)
+{
+    do {
+        table_p->prio_state ^= table_p->prio_state << 13;
+        table_p->prio_state ^= table_p->prio_state >> 17;
+        table_p->prio_state ^= table_p->prio_state << 5;
+    } while (table_p->prio_state == 0);
+    return table_p->prio_state;
+}
+
+static unsigned int
+oes_mc_oifs_hash(const unsigned long long *rifs)
+{
+    unsigned long long hash = 0x9e3779b97f4a7c15ULL;
+    unsigned int       i;
+
+    for (i = 0; i < OES_MC_RIF_WORDS; i++) {
+        hash = (hash ^ rifs[i]) * 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+    }
+    return (unsigned int)hash;
+}
+
+static void
+oes_mc_oifs_link(struct oes_mc_table *table_p,
+                 unsigned int id)
+{
+    unsigned int b = table_p->oifs[id].hash & (table_p->oifs_bucket_cnt - 1);
+
+    table_p->oifs[id].next = table_p->oifs_buckets[b];
+    table_p->oifs_buckets[b] = id;
+}
+
+static void
+oes_mc_oifs_unlink(struct oes_mc_table *table_p,
+                   unsigned int id)
+{
+    unsigned int *link_p = &table_p->oifs_buckets[table_p->oifs[id].hash & (table_p->oifs_bucket_cnt - 1)];
+
+    while (*link_p != id) {
+        link_p = &table_p->oifs[*link_p].next;
+    }
+    *link_p = table_p->oifs[id].next;
+}
+
+static unsigned int
+oes_mc_oifs_find(const struct oes_mc_table *table_p,
+                 const unsigned long long *rifs,
+                 unsigned int hash)
+{
+    unsigned int id;
+
+    if (table_p->oifs_bucket_cnt == 0) {
+        return OES_MC_NONE;
+    }
+    for (id = table_p->oifs_buckets[hash & (table_p->oifs_bucket_cnt - 1)]; id != OES_MC_NONE;
+         id = table_p->oifs[id].next) {
+        if ((table_p->oifs[id].hash == hash) &&
+            !memcmp(table_p->oifs[id].rifs, rifs, sizeof(table_p->oifs[id].rifs))) {
+            return id;
+        }
+    }
+    return OES_MC_NONE;
+}
+
+/*
+ * Takes a set off the free list, growing the pool and the chain heads
+ * together so there is a bucket per set. Set 0 stays unused.
+ */
+static unsigned int
+oes_mc_oifs_alloc(struct oes_mc_table *table_p)
+{
+    struct oes_mc_oifs *oifs_p;
+    unsigned int       *buckets_p, size, id;
+
+    if (table_p->oifs_free == OES_MC_NONE) {
+        size = table_p->oifs_size ? table_p->oifs_size * 2 : OES_MC_OIFS_MIN_SIZE;
+        if (size > OES_MC_MAX_ROUTES) {
+            return OES_MC_NONE;
+        }
+        oifs_p = realloc(table_p->oifs, size * sizeof(*oifs_p));
+        if (oifs_p == NULL) {
+            return OES_MC_NONE;
+        }
+        table_p->oifs = oifs_p;
+        buckets_p = malloc(size * sizeof(*buckets_p));
+        if (buckets_p == NULL) {
+            return OES_MC_NONE;
+        }
+        memset(buckets_p, 0xff, size * sizeof(*buckets_p));
+        free(table_p->oifs_buckets);
+        table_p->oifs_buckets = buckets_p;
+        table_p->oifs_bucket_cnt = size;
+        for (id = 1; id < table_p->oifs_size; id++) {
+            if (oifs_p[id].refcnt) {
+                oes_mc_oifs_link(table_p, id);
+            }
+        }
+        memset(&oifs_p[table_p->oifs_size], 0, (size - table_p->oifs_size) * sizeof(*oifs_p));
+        for (id = size; id-- > (table_p->oifs_size ? table_p->oifs_size : 1);) {
+            oifs_p[id].next = table_p->oifs_free;
+            table_p->oifs_free = id;
+        }
+        table_p->oifs_size = size;
+    }
+    id = table_p->oifs_free;
+    table_p->oifs_free = table_p->oifs[id].next;
+    table_p->oifs_cnt++;
+    return id;
+}
+
+static void
+oes_mc_oifs_put(struct oes_mc_table *table_p,
+                unsigned int id)
+{
+    if ((id == OES_MC_OIFS_EMPTY) || --table_p->oifs[id].refcnt) {
+        return;
+    }
+    oes_mc_oifs_unlink(table_p, id);
+    table_p->oifs[id].next = table_p->oifs_free;
+    table_p->oifs_free = id;
+    table_p->oifs_cnt--;
+}
+
+static void
+oes_mc_oifs_fill(struct oes_mc_oifs *oifs_p,
+                 const unsigned long long *rifs,
+                 unsigned int hash)
+{
+    unsigned int i;
+
+    memcpy(oifs_p->rifs, rifs, sizeof(oifs_p->rifs));
+    oifs_p->hash = hash;
+    oifs_p->cnt = 0;
+    for (i = 0; i < OES_MC_RIF_WORDS; i++) {
+        oifs_p->cnt += __builtin_popcountll(rifs[i]);
+    }
+}
+
+void
+oes_mc_table_init(struct oes_mc_table *table_p)
+{
+    memset(table_p, 0, sizeof(*table_p));
+    table_p->free_head = OES_MC_NONE;
+    table_p->root = OES_MC_NONE;
+    table_p->prio_state = 2463534242U;
+    table_p->oifs_free = OES_MC_NONE;
+}
+
+void
+oes_mc_table_deinit(struct oes_mc_table *table_p)
+{
+    free(table_p->routes);
+    free(table_p->buckets);
+    free(table_p->oifs);
+    free(table_p->oifs_buckets);
+    oes_mc_table_init(table_p);
+}
+
+void
+oes_mc_flush(struct oes_mc_table *table_p)
+{
+    oes_mc_table_deinit(table_p);
+}
+
+oes_status_e
+oes_mc_key_set(struct oes_mc_key *key_p,
+               const struct oes_ip_addr *group_p,
+               const struct oes_ip_addr *source_p,
+               unsigned int ingress_rif)
+{
+    if (group_p == NULL) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    if (group_p->version == OES_IPV4) {
+        if ((ntohl(group_p->addr.ipv4.s_addr) & 0xf0000000) != 0xe0000000) {
+            return OES_STATUS_PARAM_ERROR;
+        }
+    } else if ((group_p->version != OES_IPV6) || (group_p->addr.ipv6.s6_addr[0] != 0xff)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    memset(key_p, 0, sizeof(*key_p));
+    oes_mc_addr_set(&key_p->group, group_p);
+    key_p->source.version = group_p->version;
+    key_p->ingress_rif = ingress_rif;
+    if ((source_p == NULL) ||
+        (((source_p->version == OES_IPV4) || (source_p->version == OES_IPV6)) &&
+         oes_mc_addr_is_zero(source_p))) {
+        return OES_STATUS_SUCCESS;
+    }
+    if (source_p->version != group_p->version) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    oes_mc_addr_set(&key_p->source, source_p);
+    return OES_STATUS_SUCCESS;
+}
+
+oes_status_e
+oes_mc_add(struct oes_mc_table *table_p,
+           const struct oes_mc_key *key_p,
+           unsigned int *idx_p)
+{
+    struct oes_mc_route *route_p;
+    unsigned int         idx, b;
+
+    if (oes_mc_find(table_p, key_p) != OES_MC_NONE) {
+        return OES_STATUS_ENTRY_ALREADY_EXISTS;
+    }
+    idx = oes_mc_alloc(table_p);
+    if (idx == OES_MC_NONE) {
+        return (table_p->size >= OES_MC_MAX_ROUTES) ? OES_STATUS_NO_RESOURCES : OES_STATUS_NO_MEMORY;
+    }
+    route_p = OES_MC_ROUTE(table_p, idx);
+    route_p->key = *key_p;
+    route_p->oifs_id = OES_MC_OIFS_EMPTY;
+    route_p->prio = oes_mc_prio(table_p);
+    table_p->cnt++;
+    if (!oes_mc_buckets_grow(table_p)) {
+        if (table_p->bucket_cnt == 0) {
+            table_p->cnt--;
+            memset(route_p, 0, sizeof(*route_p));
+            route_p->hash_next = table_p->free_head;
+            table_p->free_head = idx;
+            return OES_STATUS_NO_MEMORY;
+        }
+        b = oes_mc_bucket(table_p, &route_p->key);
+        route_p->hash_next = table_p->buckets[b];
+        table_p->buckets[b] = idx;
+    }
+    route_p->left = OES_MC_NONE;
+    route_p->right = OES_MC_NONE;
+    table_p->root = oes_mc_treap_insert(table_p, table_p->root, idx);
+    *idx_p = idx;
+    return OES_STATUS_SUCCESS;
+}
+
+void
+oes_mc_delete(struct oes_mc_table *table_p,
+              unsigned int idx)
+{
+    struct oes_mc_route *route_p = OES_MC_ROUTE(table_p, idx);
+
+    table_p->root = oes_mc_treap_remove(table_p, table_p->root, idx);
+    oes_mc_hash_unlink(table_p, idx);
+    oes_mc_oifs_put(table_p, route_p->oifs_id);
+    memset(route_p, 0, sizeof(*route_p));
+    route_p->hash_next = table_p->free_head;
+    table_p->free_head = idx;
+    table_p->cnt--;
+}
+
+unsigned int
+oes_mc_find(const struct oes_mc_table *table_p,
+            const struct oes_mc_key *key_p)
+{
+    unsigned int idx;
+
+    if (table_p->cnt == 0) {
+        return OES_MC_NONE;
+    }
+    for (idx = table_p->buckets[oes_mc_bucket(table_p, key_p)]; idx != OES_MC_NONE;
+         idx = table_p->routes[idx].hash_next) {
+        if (!oes_mc_key_cmp(&table_p->routes[idx].key, key_p)) {
+            return idx;
+        }
+    }
+    return OES_MC_NONE;
+}
+
+unsigned int
+oes_mc_lookup(const struct oes_mc_table *table_p,
+              const struct oes_mc_key *key_p)
+{
+    const struct oes_mc_route *route_p;
+    unsigned int               idx, star_g = OES_MC_NONE;
+
+    if (table_p->cnt == 0) {
+        return OES_MC_NONE;
+    }
+    for (idx = table_p->buckets[oes_mc_bucket(table_p, key_p)]; idx != OES_MC_NONE;
+         idx = route_p->hash_next) {
+        route_p = &table_p->routes[idx];
+        if ((route_p->key.ingress_rif != key_p->ingress_rif) ||
+            (route_p->key.group.version != key_p->group.version) ||
+            memcmp(&route_p->key.group.addr, &key_p->group.addr, sizeof(key_p->group.addr))) {
+            continue;
+        }
+        if (!memcmp(&route_p->key.source.addr, &key_p->source.addr, sizeof(key_p->source.addr))) {
+            return idx;
+        }
+        if (oes_mc_addr_is_zero(&route_p->key.source)) {
+            star_g = idx;
+        }
+    }
+    return star_g;
+}
+
+unsigned int
+oes_mc_first(const struct oes_mc_table *table_p)
+{
+    unsigned int idx = table_p->root;
+
+    if (idx == OES_MC_NONE) {
+        return OES_MC_NONE;
+    }
+    while (table_p->routes[idx].left != OES_MC_NONE) {
+        idx = table_p->routes[idx].left;
+    }
+    return idx;
+}
+
+unsigned int
+oes_mc_next(const struct oes_mc_table *table_p,
+            const struct oes_mc_key *key_p)
+{
+    unsigned int idx = table_p->root, next = OES_MC_NONE;
+
+    while (idx != OES_MC_NONE) {
+        if (oes_mc_key_cmp(&table_p->routes[idx].key, key_p) > 0) {
+            next = idx;
+            idx = table_p->routes[idx].left;
+        } else {
+            idx = table_p->routes[idx].right;
+        }
+    }
+    return next;
+}
+
+oes_status_e
+oes_mc_oifs_set(struct oes_mc_table *table_p,
+                unsigned int idx,
+                const unsigned long long *rifs)
+{
+    struct oes_mc_route *route_p = OES_MC_ROUTE(table_p, idx);
+    unsigned int         old_id = route_p->oifs_id, id, hash, i;
+
+    for (i = 0; (i < OES_MC_RIF_WORDS) && !rifs[i]; i++) {
+    }
+    if (i == OES_MC_RIF_WORDS) {
+        oes_mc_oifs_put(table_p, old_id);
+        route_p->oifs_id = OES_MC_OIFS_EMPTY;
+        return OES_STATUS_SUCCESS;
+    }
+    hash = oes_mc_oifs_hash(rifs);
+    id = oes_mc_oifs_find(table_p, rifs, hash);
+    if (id == old_id) {
+        return OES_STATUS_SUCCESS;
+    }
+    if (id != OES_MC_NONE) {
+        table_p->oifs[id].refcnt++;
+    } else if ((old_id != OES_MC_OIFS_EMPTY) && (table_p->oifs[old_id].refcnt == 1)) {
+        /* the route owns its set, edit it without allocating */
+        oes_mc_oifs_unlink(table_p, old_id);
+        oes_mc_oifs_fill(&table_p->oifs[old_id], rifs, hash);
+        oes_mc_oifs_link(table_p, old_id);
+        return OES_STATUS_SUCCESS;
+    } else {
+        id = oes_mc_oifs_alloc(table_p);
+        if (id == OES_MC_NONE) {
+            return OES_STATUS_NO_MEMORY;
+        }
+        oes_mc_oifs_fill(&table_p->oifs[id], rifs, hash);
+        table_p->oifs[id].refcnt = 1;
+        oes_mc_oifs_link(table_p, id);
+    }
+    oes_mc_oifs_put(table_p, old_id);
+    route_p->oifs_id = id;
+    return OES_STATUS_SUCCESS;
+}
+
+const struct oes_mc_oifs *
+oes_mc_oifs_get(const struct oes_mc_table *table_p,
+                unsigned int idx)
+{
+    unsigned int id = table_p->routes[idx].oifs_id;
+
+    return (id == OES_MC_OIFS_EMPTY) ? &oes_mc_oifs_empty : &table_p->oifs[id];
+}
+
+unsigned long long
+oes_mc_mem_size(const struct oes_mc_table *table_p)
+{
+    return sizeof(*table_p) +
+           (unsigned long long)table_p->size * sizeof(*table_p->routes) +
+           (unsigned long long)table_p->bucket_cnt * sizeof(*table_p->buckets) +
+           (unsigned long long)table_p->oifs_size * sizeof(*table_p->oifs) +
+           (unsigned long long)table_p->oifs_bucket_cnt * sizeof(*table_p->oifs_buckets);
+}
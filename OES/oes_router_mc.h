@@ -0,0 +1,257 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __OES_ROUTER_MC_H__
+#define __OES_ROUTER_MC_H__
+
+/************************************************
+ *  Multicast route table
+ *
+ *  Routes live in one array and are keyed by (group, source, ingress
+ *  rif), a zero source being the (*,G) route. The hash covers the
+ *  group and ingress rif only, so the (S,G) routes of a group and its
+ *  (*,G) route share a chain: a lookup walks that one chain and
+ *  returns the exact source if present, else the (*,G) route it
+ *  passed. A treap ordered by key serves GET_FIRST/GET_NEXT paging.
+ *
+ *  Egress rif sets are bitmaps interned into a reference counted pool,
+ *  so routes with the same outgoing interfaces point to one set. Set 0
+ *  (OES_MC_OIFS_EMPTY) is the empty set and is never allocated.
+ *  Changing the egress rifs of a route moves it to another set, or
+ *  rewrites its set in place when no other route shares it; the route
+ *  record itself never moves.
+ ***********************************************/
+
+#define OES_MC_NONE                   0xffffffff
+#define OES_MC_MAX_ROUTES             (1 << 20)
+#define OES_MC_OIFS_EMPTY             0
+#define OES_MC_RIF_WORDS              OES_BITMAP_WORDS(OES_ROUTER_MC_MAX_RIFS)
+
+/* normalized route key, unused address bytes zeroed */
+struct oes_mc_key {
+    struct oes_ip_addr group;
+    struct oes_ip_addr source;            /**< zero for (*,G), same version as group */
+    unsigned int       ingress_rif;
+};
+
+/* egress rif set */
+struct oes_mc_oifs {
+    unsigned int       refcnt;            /**< 0 while on the free list */
+    unsigned int       hash;
+    unsigned int       next;              /**< hash chain, or free list link */
+    unsigned int       cnt;               /**< rifs in the set */
+    unsigned long long rifs[OES_MC_RIF_WORDS];
+};
+
+struct oes_mc_route {
+    struct oes_mc_key           key;
+    struct oes_mc_router_action action;
+    unsigned int                oifs_id;  /**< egress rif set */
+    unsigned int                hash_next;/**< hash chain, or free list link */
+    unsigned int                left;     /**< treap children */
+    unsigned int                right;
+    unsigned int                prio;     /**< treap heap priority, 0 while free */
+};
+
+struct oes_mc_table {
+    struct oes_mc_route * routes;
+    unsigned int          size;
+    unsigned int          free_head;
+    unsigned int          cnt;
+    unsigned int        * buckets;        /**< hash chain heads */
+    unsigned int          bucket_cnt;     /**< power of 2 */
+    unsigned int          root;           /**< treap root */
+    unsigned int          prio_state;
+    struct oes_mc_oifs  * oifs;           /**< indexed by set ID */
+    unsigned int          oifs_size;
+    unsigned int          oifs_free;
+    unsigned int          oifs_cnt;       /**< sets in use */
+    unsigned int        * oifs_buckets;
+    unsigned int          oifs_bucket_cnt;/**< power of 2 */
+};
+
+/**
+ * This function initializes an empty multicast route table.
+ *
+ * @param[out] table_p - table
+ */
+void
+oes_mc_table_init(struct oes_mc_table * table_p);
+
+/**
+ * This function releases the table memory.
+ *
+ * @param[in] table_p - table
+ */
+void
+oes_mc_table_deinit(struct oes_mc_table * table_p);
+
+/**
+ * This function deletes every route.
+ *
+ * @param[in] table_p - table
+ */
+void
+oes_mc_flush(struct oes_mc_table * table_p);
+
+/**
+ * This function validates and normalizes an API route key. The group
+ * must be a multicast address. A NULL or all zero sender gives the
+ * (*,G) key, any other sender must be of the group IP version.
+ *
+ * @param[out] key_p - normalized key
+ * @param[in] group_p - group address
+ * @param[in] source_p - sender address, may be NULL
+ * @param[in] ingress_rif - ingress router interface
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ */
+oes_status_e
+oes_mc_key_set(struct oes_mc_key * key_p,
+               const struct oes_ip_addr * group_p,
+               const struct oes_ip_addr * source_p,
+               unsigned int ingress_rif);
+
+/**
+ * This function adds a route with an empty egress rif set.
+ *
+ * @param[in] table_p - table
+ * @param[in] key_p - normalized key
+ * @param[out] idx_p - route index
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_ENTRY_ALREADY_EXISTS if the key is in the table
+ * @return OES_STATUS_NO_MEMORY if out of memory
+ * @return OES_STATUS_NO_RESOURCES if the table is full
+ */
+oes_status_e
+oes_mc_add(struct oes_mc_table * table_p,
+           const struct oes_mc_key * key_p,
+           unsigned int * idx_p);
+
+/**
+ * This function deletes a route, releasing its egress rif set.
+ *
+ * @param[in] table_p - table
+ * @param[in] idx - route index
+ */
+void
+oes_mc_delete(struct oes_mc_table * table_p,
+              unsigned int idx);
+
+/**
+ * This function finds the route of a key.
+ *
+ * @param[in] table_p - table
+ * @param[in] key_p - normalized key
+ *
+ * @return route index, or OES_MC_NONE
+ */
+unsigned int
+oes_mc_find(const struct oes_mc_table * table_p,
+            const struct oes_mc_key * key_p);
+
+/**
+ * This function finds the route forwarding a packet: the (S,G) route
+ * of its source if there is one, else the (*,G) route of its group.
+ * Both come from the same hash chain walk.
+ *
+ * @param[in] table_p - table
+ * @param[in] key_p - normalized packet key
+ *
+ * @return route index, or OES_MC_NONE
+ */
+unsigned int
+oes_mc_lookup(const struct oes_mc_table * table_p,
+              const struct oes_mc_key * key_p);
+
+/**
+ * This function returns the first route in key order.
+ *
+ * @param[in] table_p - table
+ *
+ * @return route index, or OES_MC_NONE if the table is empty
+ */
+unsigned int
+oes_mc_first(const struct oes_mc_table * table_p);
+
+/**
+ * This function returns the first route ordered after a key, which
+ * does not have to be in the table.
+ *
+ * @param[in] table_p - table
+ * @param[in] key_p - normalized key to resume after
+ *
+ * @return route index, or OES_MC_NONE at the end
+ */
+unsigned int
+oes_mc_next(const struct oes_mc_table * table_p,
+            const struct oes_mc_key * key_p);
+
+/**
+ * This function sets the egress rifs of a route. The route moves to
+ * the set holding these rifs if one exists. Otherwise its own set is
+ * rewritten in place if no other route uses it, or a new set is
+ * allocated.
+ *
+ * @param[in] table_p - table
+ * @param[in] idx - route index
+ * @param[in] rifs - bitmap of OES_ROUTER_MC_MAX_RIFS bits
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_NO_MEMORY if out of memory, the route keeps its set
+ */
+oes_status_e
+oes_mc_oifs_set(struct oes_mc_table * table_p,
+                unsigned int idx,
+                const unsigned long long * rifs);
+
+/**
+ * This function returns the egress rif set of a route.
+ *
+ * @param[in] table_p - table
+ * @param[in] idx - route index
+ *
+ * @return the set, valid until the route or its set changes
+ */
+const struct oes_mc_oifs *
+oes_mc_oifs_get(const struct oes_mc_table * table_p,
+                unsigned int idx);
+
+/**
+ * This function returns the heap used by the table.
+ *
+ * @param[in] table_p - table
+ *
+ * @return bytes
+ */
+unsigned long long
+oes_mc_mem_size(const struct oes_mc_table * table_p);
+
+#endif /* __OES_ROUTER_MC_H__ */
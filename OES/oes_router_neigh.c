@@ -0,0 +1,564 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_router_activity.h"
+#include "oes_router_image.h"
+#include "oes_router_neigh.h"
+
+#define OES_NEIGH_MIN_SIZE            1024
+
+#define OES_NEIGH_ENTRY(table_p, idx) (&(table_p)->entries[(idx)])
+
+static void
+oes_neigh_key_set(struct oes_ip_addr *dst_p,
+                  const struct oes_ip_addr *src_p)
+{
+    memset(dst_p, 0, sizeof(*dst_p));
+    dst_p->version = src_p->version;
+    if (src_p->version == OES_IPV4) {
+        dst_p->addr.ipv4 = src_p->addr.ipv4;
+    } else {
+        dst_p->addr.ipv6 = src_p->addr.ipv6;
+    }
+}
+
+/* IPv4 before IPv6, then by address in network order. Both keys are normalized. */
+static int
+oes_neigh_key_cmp(const struct oes_ip_addr *a_p,
+                  const struct oes_ip_addr *b_p)
+{
+    if (a_p->version != b_p->version) {
+        return (a_p->version < b_p->version) ? -1 : 1;
+    }
+    return memcmp(&a_p->addr, &b_p->addr, sizeof(a_p->addr));
+}
+
+static unsigned int
+oes_neigh_hash(const struct oes_ip_addr *key_p)
+{
+    unsigned int words[4], hash = key_p->version * 0x9e3779b9U;
+    unsigned int i;
+
+    memcpy(words, &key_p->addr, sizeof(words));
+    for (i = 0; i < 4; i++) {
+        hash = (hash ^ words[i]) * 0x85ebca6bU;
+        hash ^= hash >> 15;
+    }
+    return hash;
+}
+
+static unsigned int
+oes_neigh_bucket(const struct oes_neigh_table *table_p,
+                 const struct oes_ip_addr *key_p)
+{
+    return oes_neigh_hash(key_p) & (table_p->bucket_cnt - 1);
+}
+
+static void
+oes_neigh_hash_unlink(struct oes_neigh_table *table_p,
+                      unsigned int idx)
+{
+    unsigned int *link_p = &table_p->buckets[oes_neigh_bucket(table_p, &table_p->entries[idx].ip)];
+
+    while (*link_p != idx) {
+        link_p = &table_p->entries[*link_p].hash_next;
+    }
+    *link_p = table_p->entries[idx].hash_next;
+}
+
+/*
+ * Doubles the chain heads once the table holds more than one entry per
+ * bucket, rechaining every entry in use. Returns 1 if it rechained.
+ */
+static int
+oes_neigh_buckets_grow(struct oes_neigh_table *table_p)
+{
+    unsigned int *buckets_p, size, idx, b;
+
+    if (table_p->cnt <= table_p->bucket_cnt) {
+        return 0;
+    }
+    size = table_p->bucket_cnt ? table_p->bucket_cnt * 2 : OES_NEIGH_MIN_SIZE;
+    buckets_p = malloc(size * sizeof(*buckets_p));
+    if (buckets_p == NULL) {
+        /* longer chains, still correct */
+        return 0;
+    }
+    memset(buckets_p, 0xff, size * sizeof(*buckets_p));
+    free(table_p->buckets);
+    table_p->buckets = buckets_p;
+    table_p->bucket_cnt = size;
+    for (idx = 0; idx < table_p->size; idx++) {
+        if (table_p->entries[idx].prio) {
+            b = oes_neigh_bucket(table_p, &table_p->entries[idx].ip);
+            table_p->entries[idx].hash_next = table_p->buckets[b];
+            table_p->buckets[b] = idx;
+        }
+    }
+    return 1;
+}
+
+static unsigned int
+oes_neigh_treap_insert(struct oes_neigh_table *table_p,
+                       unsigned int root,
+                       unsigned int idx)
+{
+    struct oes_neigh_entry *root_p, *child_p;
+    unsigned int            child;
+
+    if (root == OES_NEIGH_NONE) {
+        return idx;
+    }
+    root_p = OES_NEIGH_ENTRY(table_p, root);
+    if (oes_neigh_key_cmp(&OES_NEIGH_ENTRY(table_p, idx)->ip, &root_p->ip) < 0) {
+        child = root_p->left = oes_neigh_treap_insert(table_p, root_p->left, idx);
+        child_p = OES_NEIGH_ENTRY(table_p, child);
+        if (child_p->prio > root_p->prio) {
+            /* rotate right */
+            root_p->left = child_p->right;
+            child_p->right = root;
+            return child;
+        }
+    } else {
+        child = root_p->right = oes_neigh_treap_insert(table_p, root_p->right, idx);
+        child_p = OES_NEIGH_ENTRY(table_p, child);
+        if (child_p->prio > root_p->prio) {
+            /* rotate left */
+            root_p->right = child_p->left;
+            child_p->left = root;
+            return child;
+        }
+    }
+    return root;
+}
+
+static unsigned int
+oes_neigh_treap_merge(struct oes_neigh_table *table_p,
+                      unsigned int a,
+                      unsigned int b)
+{
+    if (a == OES_NEIGH_NONE) {
+        return b;
+    }
+    if (b == OES_NEIGH_NONE) {
+        return a;
+    }
+    if (OES_NEIGH_ENTRY(table_p, a)->prio > OES_NEIGH_ENTRY(table_p, b)->prio) {
+        OES_NEIGH_ENTRY(table_p, a)->right = oes_neigh_treap_merge(table_p, OES_NEIGH_ENTRY(table_p, a)->right, b);
+        return a;
+    }
+    OES_NEIGH_ENTRY(table_p, b)->left = oes_neigh_treap_merge(table_p, a, OES_NEIGH_ENTRY(table_p, b)->left);
+    return b;
+}
+
+static unsigned int
+oes_neigh_treap_remove(struct oes_neigh_table *table_p,
+                       unsigned int root,
+                       unsigned int idx)
+{
+    struct oes_neigh_entry *root_p = OES_NEIGH_ENTRY(table_p, root);
+
+    if (root == idx) {
+        return oes_neigh_treap_merge(table_p, root_p->left, root_p->right);
+    }
+    if (oes_neigh_key_cmp(&OES_NEIGH_ENTRY(table_p, idx)->ip, &root_p->ip) < 0) {
+        root_p->left = oes_neigh_treap_remove(table_p, root_p->left, idx);
+    } else {
+        root_p->right = oes_neigh_treap_remove(table_p, root_p->right, idx);
+    }
+    return root;
+}
+
+static oes_status_e
+oes_neigh_rif_link(struct oes_neigh_table *table_p,
+                   unsigned int idx,
+                   unsigned int rif)
+{
+    struct oes_neigh_entry *entry_p;
+    unsigned int           *heads_p, cnt;
+
+    if (rif >= OES_NEIGH_MAX_RIFS) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    if (rif >= table_p->rif_cnt) {
+        for (cnt = table_p->rif_cnt ? table_p->rif_cnt : 64; cnt <= rif; cnt *= 2) {
+        }
+        heads_p = realloc(table_p->rif_heads, cnt * sizeof(*heads_p));
+        if (heads_p == NULL) {
+            return OES_STATUS_NO_MEMORY;
+        }
+        memset(&heads_p[table_p->rif_cnt], 0xff, (cnt - table_p->rif_cnt) * sizeof(*heads_p));
+        table_p->rif_heads = heads_p;
+        table_p->rif_cnt = cnt;
+    }
+    entry_p = OES_NEIGH_ENTRY(table_p, idx);
+    entry_p->rif = rif;
+    entry_p->rif_prev = OES_NEIGH_NONE;
+    entry_p->rif_next = table_p->rif_heads[rif];
+    if (entry_p->rif_next != OES_NEIGH_NONE) {
+        OES_NEIGH_ENTRY(table_p, entry_p->rif_next)->rif_prev = idx;
+    }
+    table_p->rif_heads[rif] = idx;
+    return OES_STATUS_SUCCESS;
+}
+
+static void
+oes_neigh_rif_unlink(struct oes_neigh_table *table_p,
+                     unsigned int idx)
+{
+    struct oes_neigh_entry *entry_p = OES_NEIGH_ENTRY(table_p, idx);
+
+    if (entry_p->rif_prev == OES_NEIGH_NONE) {
+        table_p->rif_heads[entry_p->rif] = entry_p->rif_next;
+    } else {
+        OES_NEIGH_ENTRY(table_p, entry_p->rif_prev)->rif_next = entry_p->rif_next;
+    }
+    if (entry_p->rif_next != OES_NEIGH_NONE) {
+        OES_NEIGH_ENTRY(table_p, entry_p->rif_next)->rif_prev = entry_p->rif_prev;
+    }
+}
+
+/* Takes an entry off the free list, growing the array if needed. */
+static unsigned int
+oes_neigh_alloc(struct oes_neigh_table *table_p)
+{
+    struct oes_neigh_entry *entries_p;
+    unsigned int            size, idx;
+
+    if (table_p->free_head == OES_NEIGH_NONE) {
+        size = table_p->size ? table_p->size * 2 : OES_NEIGH_MIN_SIZE;
+        if (size > OES_NEIGH_MAX_ENTRIES) {
+            return OES_NEIGH_NONE;
+        }
+        if (oes_activity_resize(&table_p->activity, table_p->size, size) != OES_STATUS_SUCCESS) {
+            return OES_NEIGH_NONE;
+        }
+        entries_p = realloc(table_p->entries, size * sizeof(*entries_p));
+        if (entries_p == NULL) {
+            return OES_NEIGH_NONE;
+        }
+        table_p->entries = entries_p;
+        memset(&entries_p[table_p->size], 0, (size - table_p->size) * sizeof(*entries_p));
+        for (idx = size; idx-- > table_p->size;) {
+            entries_p[idx].hash_next = table_p->free_head;
+            table_p->free_head = idx;
+        }
+        table_p->size = size;
+    }
+    idx = table_p->free_head;
+    table_p->free_head = table_p->entries[idx].hash_next;
+    return idx;
+}
+
+/* xorshift, never 0 so a set prio marks the entry in use */
+static unsigned int
+oes_neigh_prio(struct oes_neigh_table *table_p)
+{
+    do {
+        table_p->prio_state ^= table_p->prio_state << 13;
+        table_p->prio_state ^= table_p->prio_state >> 17;
+        table_p->prio_state ^= table_p->prio_state << 5;
+    } while (table_p->prio_state == 0);
+    return table_p->prio_state;
+}
+
+void
+oes_neigh_table_init(struct oes_neigh_table *table_p)
+{
+    memset(table_p, 0, sizeof(*table_p));
+    table_p->free_head = OES_NEIGH_NONE;
+    table_p->root = OES_NEIGH_NONE;
+    table_p->prio_state = 2463534242U;
+}
+
+void
+oes_neigh_table_deinit(struct oes_neigh_table *table_p)
+{
+    free(table_p->entries);
+    free(table_p->buckets);
+    free(table_p->rif_heads);
+    free(table_p->activity);
+    oes_neigh_table_init(table_p);
+}
+
+void
+oes_neigh_flush(struct oes_neigh_table *table_p)
+{
+    oes_neigh_table_deinit(table_p);
+}
+
+oes_status_e
+oes_neigh_add(struct oes_neigh_table *table_p,
+              const struct oes_ip_addr *ip_p,
+              unsigned int rif,
+              unsigned int *idx_p)
+{
+    struct oes_neigh_entry *entry_p;
+    unsigned int            idx, b;
+    oes_status_e            status;
+
+    if (((ip_p->version != OES_IPV4) && (ip_p->version != OES_IPV6)) ||
+        (rif >= OES_NEIGH_MAX_RIFS)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    if (oes_neigh_find(table_p, ip_p) != OES_NEIGH_NONE) {
+        return OES_STATUS_ENTRY_ALREADY_EXISTS;
+    }
+    idx = oes_neigh_alloc(table_p);
+    if (idx == OES_NEIGH_NONE) {
+        return (table_p->size >= OES_NEIGH_MAX_ENTRIES) ? OES_STATUS_NO_RESOURCES : OES_STATUS_NO_MEMORY;
+    }
+    entry_p = OES_NEIGH_ENTRY(table_p, idx);
+    oes_neigh_key_set(&entry_p->ip, ip_p);
+    entry_p->prio = oes_neigh_prio(table_p);
+    table_p->cnt++;
+    if (!oes_neigh_buckets_grow(table_p)) {
+        if (table_p->bucket_cnt == 0) {
+            status = OES_STATUS_NO_MEMORY;
+            goto err;
+        }
+        b = oes_neigh_bucket(table_p, &entry_p->ip);
+        entry_p->hash_next = table_p->buckets[b];
+        table_p->buckets[b] = idx;
+    }
+    status = oes_neigh_rif_link(table_p, idx, rif);
+    if (status != OES_STATUS_SUCCESS) {
+        oes_neigh_hash_unlink(table_p, idx);
+        goto err;
+    }
+    entry_p->left = OES_NEIGH_NONE;
+    entry_p->right = OES_NEIGH_NONE;
+    table_p->root = oes_neigh_treap_insert(table_p, table_p->root, idx);
+    *idx_p = idx;
+    return OES_STATUS_SUCCESS;
+
+err:
+    table_p->cnt--;
+    memset(entry_p, 0, sizeof(*entry_p));
+    entry_p->hash_next = table_p->free_head;
+    table_p->free_head = idx;
+    return status;
+}
+
+oes_status_e
+oes_neigh_rif_set(struct oes_neigh_table *table_p,
+                  unsigned int idx,
+                  unsigned int rif)
+{
+    unsigned int old_rif = OES_NEIGH_ENTRY(table_p, idx)->rif;
+    oes_status_e status;
+
+    if (rif >= OES_NEIGH_MAX_RIFS) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    if (rif == old_rif) {
+        return OES_STATUS_SUCCESS;
+    }
+    oes_neigh_rif_unlink(table_p, idx);
+    status = oes_neigh_rif_link(table_p, idx, rif);
+    if (status != OES_STATUS_SUCCESS) {
+        /* the old head slot exists, relinking cannot fail */
+        oes_neigh_rif_link(table_p, idx, old_rif);
+    }
+    return status;
+}
+
+void
+oes_neigh_delete(struct oes_neigh_table *table_p,
+                 unsigned int idx)
+{
+    struct oes_neigh_entry *entry_p = OES_NEIGH_ENTRY(table_p, idx);
+
+    table_p->root = oes_neigh_treap_remove(table_p, table_p->root, idx);
+    oes_neigh_rif_unlink(table_p, idx);
+    oes_neigh_hash_unlink(table_p, idx);
+    oes_activity_get(table_p->activity, idx, 1);
+    memset(entry_p, 0, sizeof(*entry_p));
+    entry_p->hash_next = table_p->free_head;
+    table_p->free_head = idx;
+    table_p->cnt--;
+}
+
+unsigned int
+oes_neigh_find(const struct oes_neigh_table *table_p,
+               const struct oes_ip_addr *ip_p)
+{
+    struct oes_ip_addr key;
+    unsigned int       idx;
+
+    if (table_p->cnt == 0) {
+        return OES_NEIGH_NONE;
+    }
+    oes_neigh_key_set(&key, ip_p);
+    for (idx = table_p->buckets[oes_neigh_bucket(table_p, &key)]; idx != OES_NEIGH_NONE;
+         idx = table_p->entries[idx].hash_next) {
+        if (!oes_neigh_key_cmp(&table_p->entries[idx].ip, &key)) {
+            return idx;
+        }
+    }
+    return OES_NEIGH_NONE;
+}
+
+unsigned int
+oes_neigh_first(const struct oes_neigh_table *table_p)
+{
+    unsigned int idx = table_p->root;
+
+    if (idx == OES_NEIGH_NONE) {
+        return OES_NEIGH_NONE;
+    }
+    while (table_p->entries[idx].left != OES_NEIGH_NONE) {
+        idx = table_p->entries[idx].left;
+    }
+    return idx;
+}
+
+unsigned int
+oes_neigh_next(const struct oes_neigh_table *table_p,
+               const struct oes_ip_addr *ip_p)
+{
+    struct oes_ip_addr key;
+    unsigned int       idx = table_p->root, next = OES_NEIGH_NONE;
+
+    oes_neigh_key_set(&key, ip_p);
+    while (idx != OES_NEIGH_NONE) {
+        if (oes_neigh_key_cmp(&table_p->entries[idx].ip, &key) > 0) {
+            next = idx;
+            idx = table_p->entries[idx].left;
+        } else {
+            idx = table_p->entries[idx].right;
+        }
+    }
+    return next;
+}
+
+unsigned int
+oes_neigh_rif_first(const struct oes_neigh_table *table_p,
+                    unsigned int rif)
+{
+    return (rif < table_p->rif_cnt) ? table_p->rif_heads[rif] : OES_NEIGH_NONE;
+}
+
+/* Image section of a table, followed by the entries, the chain heads and the rif list heads. */
+struct oes_neigh_image {
+    unsigned int size;
+    unsigned int free_head;
+    unsigned int cnt;
+    unsigned int bucket_cnt;
+    unsigned int root;
+    unsigned int rif_cnt;
+    unsigned int prio_state;
+    unsigned int pad;
+};
+
+void
+oes_neigh_save(const struct oes_neigh_table *table_p,
+               struct oes_image_writer *writer_p)
+{
+    struct oes_neigh_image image;
+
+    memset(&image, 0, sizeof(image));
+    image.size = table_p->size;
+    image.free_head = table_p->free_head;
+    image.cnt = table_p->cnt;
+    image.bucket_cnt = table_p->bucket_cnt;
+    image.root = table_p->root;
+    image.rif_cnt = table_p->rif_cnt;
+    image.prio_state = table_p->prio_state;
+    oes_image_write(writer_p, &image, sizeof(image));
+    oes_image_write(writer_p, table_p->entries, table_p->size * sizeof(*table_p->entries));
+    oes_image_write(writer_p, table_p->buckets, table_p->bucket_cnt * sizeof(*table_p->buckets));
+    oes_image_write(writer_p, table_p->rif_heads, table_p->rif_cnt * sizeof(*table_p->rif_heads));
+}
+
+/* Copies the next cnt elements of an image into a new array, NULL and ok if cnt is 0. */
+static int
+oes_neigh_load_array(struct oes_image_reader *reader_p,
+                     size_t cnt,
+                     size_t elem_size,
+                     void **array_pp)
+{
+    const void *src_p;
+
+    *array_pp = NULL;
+    if (cnt == 0) {
+        return 1;
+    }
+    src_p = oes_image_read(reader_p, cnt * elem_size);
+    if (src_p != NULL) {
+        *array_pp = malloc(cnt * elem_size);
+    }
+    if (*array_pp == NULL) {
+        return 0;
+    }
+    memcpy(*array_pp, src_p, cnt * elem_size);
+    return 1;
+}
+
+oes_status_e
+oes_neigh_load(struct oes_neigh_table *table_p,
+               struct oes_image_reader *reader_p)
+{
+    const struct oes_neigh_image *image_p;
+    int                           ok;
+
+    oes_neigh_table_init(table_p);
+    image_p = oes_image_read(reader_p, sizeof(*image_p));
+    if ((image_p == NULL) || (image_p->size > OES_NEIGH_MAX_ENTRIES) || (image_p->cnt > image_p->size) ||
+        (image_p->bucket_cnt & (image_p->bucket_cnt - 1)) || (image_p->rif_cnt > OES_NEIGH_MAX_RIFS) ||
+        (image_p->prio_state == 0)) {
+        return OES_STATUS_ERROR;
+    }
+    ok = oes_neigh_load_array(reader_p, image_p->size, sizeof(*table_p->entries),
+                              (void **)&table_p->entries) &&
+         oes_neigh_load_array(reader_p, image_p->bucket_cnt, sizeof(*table_p->buckets),
+                              (void **)&table_p->buckets) &&
+         oes_neigh_load_array(reader_p, image_p->rif_cnt, sizeof(*table_p->rif_heads),
+                              (void **)&table_p->rif_heads) &&
+         (oes_activity_resize(&table_p->activity, 0, image_p->size) == OES_STATUS_SUCCESS);
+    table_p->size = image_p->size;
+    table_p->bucket_cnt = image_p->bucket_cnt;
+    table_p->rif_cnt = image_p->rif_cnt;
+    if (!ok) {
+        oes_neigh_table_deinit(table_p);
+        return reader_p->failed ? OES_STATUS_ERROR : OES_STATUS_NO_MEMORY;
+    }
+    table_p->free_head = image_p->free_head;
+    table_p->cnt = image_p->cnt;
+    table_p->root = image_p->root;
+    table_p->prio_state = image_p->prio_state;
+    return OES_STATUS_SUCCESS;
+}
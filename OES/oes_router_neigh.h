@@ -0,0 +1,222 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __OES_ROUTER_NEIGH_H__
+#define __OES_ROUTER_NEIGH_H__
+
+/************************************************
+ *  Neighbour table
+ *
+ *  Entries live in one array and are linked by index into three
+ *  structures: a hash on the IP address for exact lookup, a treap
+ *  ordered by (IP version, address) for GET_FIRST/GET_NEXT paging, and
+ *  a doubly linked list per router interface so deleting the
+ *  neighbours of a rif only touches those entries. Addresses are kept
+ *  with unused bytes zeroed. Activity is a bitmap indexed like the
+ *  entries, cleared when an entry is freed.
+ ***********************************************/
+
+#define OES_NEIGH_NONE                0xffffffff
+#define OES_NEIGH_MAX_ENTRIES         (1 << 20)
+#define OES_NEIGH_MAX_RIFS            (1 << 16)
+
+struct oes_neigh_entry {
+    struct oes_ip_addr ip;
+    struct ether_addr  mac;
+    unsigned char      action;           /**< enum oes_router_action */
+    unsigned int       rif;
+    unsigned int       hash_next;        /**< hash chain, or free list link */
+    unsigned int       rif_prev;
+    unsigned int       rif_next;
+    unsigned int       left;             /**< treap children */
+    unsigned int       right;
+    unsigned int       prio;             /**< treap heap priority, 0 while free */
+};
+
+struct oes_neigh_table {
+    struct oes_neigh_entry * entries;
+    unsigned int             size;
+    unsigned int             free_head;
+    unsigned int             cnt;
+    unsigned int           * buckets;     /**< hash chain heads */
+    unsigned int             bucket_cnt;  /**< power of 2 */
+    unsigned int             root;        /**< treap root */
+    unsigned int           * rif_heads;   /**< first neighbour per rif */
+    unsigned int             rif_cnt;
+    unsigned int             prio_state;
+    unsigned long long     * activity;    /**< bit per entry, see oes_router_activity.h */
+};
+
+/**
+ * This function initializes an empty neighbour table.
+ *
+ * @param[out] table_p - table
+ */
+void
+oes_neigh_table_init(struct oes_neigh_table * table_p);
+
+/**
+ * This function releases the table memory.
+ *
+ * @param[in] table_p - table
+ */
+void
+oes_neigh_table_deinit(struct oes_neigh_table * table_p);
+
+/**
+ * This function deletes every neighbour.
+ *
+ * @param[in] table_p - table
+ */
+void
+oes_neigh_flush(struct oes_neigh_table * table_p);
+
+/**
+ * This function adds a neighbour.
+ *
+ * @param[in] table_p - table
+ * @param[in] ip_p - neighbour address
+ * @param[in] rif - router interface, below OES_NEIGH_MAX_RIFS
+ * @param[out] idx_p - entry index
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_ENTRY_ALREADY_EXISTS if the address is in the table
+ * @return OES_STATUS_NO_MEMORY if out of memory
+ * @return OES_STATUS_NO_RESOURCES if the table is full
+ */
+oes_status_e
+oes_neigh_add(struct oes_neigh_table * table_p,
+              const struct oes_ip_addr * ip_p,
+              unsigned int rif,
+              unsigned int * idx_p);
+
+/**
+ * This function moves a neighbour to another router interface.
+ *
+ * @param[in] table_p - table
+ * @param[in] idx - entry index
+ * @param[in] rif - router interface, below OES_NEIGH_MAX_RIFS
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if rif is out of range
+ * @return OES_STATUS_NO_MEMORY if out of memory
+ */
+oes_status_e
+oes_neigh_rif_set(struct oes_neigh_table * table_p,
+                  unsigned int idx,
+                  unsigned int rif);
+
+/**
+ * This function deletes a neighbour.
+ *
+ * @param[in] table_p - table
+ * @param[in] idx - entry index
+ */
+void
+oes_neigh_delete(struct oes_neigh_table * table_p,
+                 unsigned int idx);
+
+/**
+ * This function finds the entry of an address.
+ *
+ * @param[in] table_p - table
+ * @param[in] ip_p - neighbour address
+ *
+ * @return entry index, or OES_NEIGH_NONE
+ */
+unsigned int
+oes_neigh_find(const struct oes_neigh_table * table_p,
+               const struct oes_ip_addr * ip_p);
+
+/**
+ * This function returns the first entry in address order.
+ *
+ * @param[in] table_p - table
+ *
+ * @return entry index, or OES_NEIGH_NONE if the table is empty
+ */
+unsigned int
+oes_neigh_first(const struct oes_neigh_table * table_p);
+
+/**
+ * This function returns the first entry ordered after an address,
+ * which does not have to be in the table.
+ *
+ * @param[in] table_p - table
+ * @param[in] ip_p - address to resume after
+ *
+ * @return entry index, or OES_NEIGH_NONE at the end
+ */
+unsigned int
+oes_neigh_next(const struct oes_neigh_table * table_p,
+               const struct oes_ip_addr * ip_p);
+
+/**
+ * This function returns the first neighbour of a router interface,
+ * the rest follow through rif_next.
+ *
+ * @param[in] table_p - table
+ * @param[in] rif - router interface
+ *
+ * @return entry index, or OES_NEIGH_NONE
+ */
+unsigned int
+oes_neigh_rif_first(const struct oes_neigh_table * table_p,
+                    unsigned int rif);
+
+struct oes_image_writer;
+struct oes_image_reader;
+
+/**
+ * This function writes a table to an image. The entries, hash chains,
+ * treap and rif lists are saved by index as they are; activity is not.
+ *
+ * @param[in] table_p - table
+ * @param[in] writer_p - image writer
+ */
+void
+oes_neigh_save(const struct oes_neigh_table * table_p,
+               struct oes_image_writer * writer_p);
+
+/**
+ * This function initializes a table from an image written by
+ * oes_neigh_save, keeping every entry index.
+ *
+ * @param[out] table_p - new table
+ * @param[in] reader_p - image reader
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_ERROR if the image is inconsistent
+ * @return OES_STATUS_NO_MEMORY if out of memory
+ */
+oes_status_e
+oes_neigh_load(struct oes_neigh_table * table_p,
+               struct oes_image_reader * reader_p);
+
+#endif /* __OES_ROUTER_NEIGH_H__ */
@@ -0,0 +1,1100 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_router_activity.h"
+#include "oes_router_image.h"
+#include "oes_router_nhg.h"
+
+#define OES_NHG_MIN_SIZE              64
+#define OES_NHG_STACK_MEMBERS         64
+#define OES_NHG_END                   0xffffffff
+#define OES_NHG_RES_NO_MEMBER         0xffff
+
+/* Orders next hops by family, then address. */
+static int
+oes_nhg_member_cmp(const void *a, const void *b)
+{
+    const struct oes_ip_addr *a_p = a;
+    const struct oes_ip_addr *b_p = b;
+
+    if (a_p->version != b_p->version) {
+        return (a_p->version < b_p->version) ? -1 : 1;
+    }
+    return memcmp(&a_p->addr, &b_p->addr, sizeof(a_p->addr));
+}
+
+/*
+ * Copies the list with unused address bytes zeroed and sorts it, so
+ * equal sets compare and hash equal byte for byte.
+ */
+static void
+oes_nhg_normalize(struct oes_ip_addr *dst_p,
+                  const struct oes_ip_addr *src_p,
+                  unsigned short cnt)
+{
+    unsigned short i;
+
+    memset(dst_p, 0, cnt * sizeof(*dst_p));
+    for (i = 0; i < cnt; i++) {
+        dst_p[i].version = src_p[i].version;
+        if (src_p[i].version == OES_IPV4) {
+            dst_p[i].addr.ipv4 = src_p[i].addr.ipv4;
+        } else {
+            dst_p[i].addr.ipv6 = src_p[i].addr.ipv6;
+        }
+    }
+    qsort(dst_p, cnt, sizeof(*dst_p), oes_nhg_member_cmp);
+}
+
+/* FNV-1a over the normalized members */
+static unsigned int
+oes_nhg_hash(const struct oes_ip_addr *members_p,
+             unsigned short cnt)
+{
+    const unsigned char *p = (const unsigned char *)members_p;
+    size_t               len = cnt * sizeof(*members_p);
+    unsigned int         hash = 2166136261U;
+
+    while (len--) {
+        hash = (hash ^ *p++) * 16777619U;
+    }
+    return hash;
+}
+
+static void
+oes_nhg_bucket_insert(struct oes_nhg_table *table_p,
+                      unsigned int nhg_id)
+{
+    unsigned int *head_p = &table_p->buckets[table_p->groups[nhg_id].hash & (table_p->bucket_cnt - 1)];
+
+    table_p->groups[nhg_id].next = *head_p;
+    *head_p = nhg_id;
+}
+
+static void
+oes_nhg_bucket_remove(struct oes_nhg_table *table_p,
+                      unsigned int nhg_id)
+{
+    unsigned int *link_p = &table_p->buckets[table_p->groups[nhg_id].hash & (table_p->bucket_cnt - 1)];
+
+    while (*link_p != nhg_id) {
+        link_p = &table_p->groups[*link_p].next;
+    }
+    *link_p = table_p->groups[nhg_id].next;
+}
+
+/* Keeps the chains at one group per bucket on average. */
+static void
+oes_nhg_buckets_grow(struct oes_nhg_table *table_p)
+{
+    unsigned int *buckets_p;
+    unsigned int  id;
+
+    if (table_p->cnt < table_p->bucket_cnt) {
+        return;
+    }
+    buckets_p = malloc(table_p->bucket_cnt * 2 * sizeof(*buckets_p));
+    if (buckets_p == NULL) {
+        /* longer chains, still correct */
+        return;
+    }
+    free(table_p->buckets);
+    table_p->buckets = buckets_p;
+    table_p->bucket_cnt *= 2;
+    memset(table_p->buckets, 0xff, table_p->bucket_cnt * sizeof(*table_p->buckets));
+    for (id = 1; id < table_p->size; id++) {
+        if (table_p->groups[id].refcnt) {
+            oes_nhg_bucket_insert(table_p, id);
+        }
+    }
+}
+
+static unsigned int
+oes_nhg_res_target(const struct oes_nhg *nhg_p,
+                   unsigned int member)
+{
+    return nhg_p->res_bucket_cnt / nhg_p->cnt + (member < nhg_p->res_bucket_cnt % nhg_p->cnt);
+}
+
+static void
+oes_nhg_res_free(struct oes_nhg *nhg_p)
+{
+    free(nhg_p->res_buckets);
+    free(nhg_p->res_activity);
+    nhg_p->res_buckets = NULL;
+    nhg_p->res_activity = NULL;
+    nhg_p->res_bucket_cnt = 0;
+}
+
+/*
+ * Sets the bucket owners of nhg_p from a previous member list and its
+ * bucket owners: buckets keep their member if it is still in the
+ * group, the others go to the least loaded members. old_buckets_p may
+ * be nhg_p->res_buckets.
+ */
+static oes_status_e
+oes_nhg_res_remap(struct oes_nhg *nhg_p,
+                  const struct oes_ip_addr *old_members_p,
+                  unsigned short old_cnt,
+                  const unsigned short *old_buckets_p)
+{
+    const struct oes_ip_addr *found_p;
+    unsigned short           *map_p;
+    unsigned int             *load_p;
+    unsigned int              b, m, best;
+
+    map_p = malloc(old_cnt * sizeof(*map_p));
+    load_p = calloc(nhg_p->cnt, sizeof(*load_p));
+    if ((map_p == NULL) || (load_p == NULL)) {
+        free(map_p);
+        free(load_p);
+        return OES_STATUS_NO_MEMORY;
+    }
+    for (m = 0; m < old_cnt; m++) {
+        found_p = bsearch(&old_members_p[m], nhg_p->members, nhg_p->cnt,
+                          sizeof(*nhg_p->members), oes_nhg_member_cmp);
+        map_p[m] = found_p ? (unsigned short)(found_p - nhg_p->members) : OES_NHG_RES_NO_MEMBER;
+    }
+    for (b = 0; b < nhg_p->res_bucket_cnt; b++) {
+        nhg_p->res_buckets[b] = map_p[old_buckets_p[b]];
+        if (nhg_p->res_buckets[b] != OES_NHG_RES_NO_MEMBER) {
+            load_p[nhg_p->res_buckets[b]]++;
+        }
+    }
+    for (b = 0; b < nhg_p->res_bucket_cnt; b++) {
+        if (nhg_p->res_buckets[b] != OES_NHG_RES_NO_MEMBER) {
+            continue;
+        }
+        for (best = 0, m = 1; m < nhg_p->cnt; m++) {
+            if (load_p[m] < load_p[best]) {
+                best = m;
+            }
+        }
+        nhg_p->res_buckets[b] = best;
+        load_p[best]++;
+    }
+    free(map_p);
+    free(load_p);
+    return OES_STATUS_SUCCESS;
+}
+
+/* Allocates the buckets of a new resilient group. */
+static oes_status_e
+oes_nhg_res_init(struct oes_nhg *nhg_p,
+                 unsigned int bucket_cnt,
+                 const struct oes_nhg *seed_p)
+{
+    unsigned int b;
+
+    nhg_p->res_buckets = malloc(bucket_cnt * sizeof(*nhg_p->res_buckets));
+    nhg_p->res_activity = calloc((bucket_cnt + 63) / 64, sizeof(*nhg_p->res_activity));
+    nhg_p->res_bucket_cnt = bucket_cnt;
+    if ((nhg_p->res_buckets == NULL) || (nhg_p->res_activity == NULL)) {
+        oes_nhg_res_free(nhg_p);
+        return OES_STATUS_NO_MEMORY;
+    }
+    if ((seed_p != NULL) && (seed_p->res_bucket_cnt == bucket_cnt)) {
+        if (oes_nhg_res_remap(nhg_p, seed_p->members, seed_p->cnt,
+                              seed_p->res_buckets) != OES_STATUS_SUCCESS) {
+            oes_nhg_res_free(nhg_p);
+            return OES_STATUS_NO_MEMORY;
+        }
+        return OES_STATUS_SUCCESS;
+    }
+    for (b = 0; b < bucket_cnt; b++) {
+        nhg_p->res_buckets[b] = b % nhg_p->cnt;
+    }
+    return OES_STATUS_SUCCESS;
+}
+
+static unsigned int
+oes_nhg_nh_bucket(const struct oes_nhg_table *table_p,
+                  const struct oes_ip_addr *ip_p)
+{
+    return oes_nhg_hash(ip_p, 1) & (table_p->nh_bucket_cnt - 1);
+}
+
+/* Finds the entry of a normalized next hop, OES_NHG_END if no group uses it. */
+static unsigned int
+oes_nhg_nh_find(const struct oes_nhg_table *table_p,
+                const struct oes_ip_addr *ip_p)
+{
+    unsigned int nh;
+
+    if (table_p->nh_cnt == 0) {
+        return OES_NHG_END;
+    }
+    for (nh = table_p->nh_buckets[oes_nhg_nh_bucket(table_p, ip_p)]; nh != OES_NHG_END;
+         nh = table_p->nhs[nh].hash_next) {
+        if (!memcmp(&table_p->nhs[nh].ip, ip_p, sizeof(*ip_p))) {
+            return nh;
+        }
+    }
+    return OES_NHG_END;
+}
+
+/* Keeps one next hop per chain on average, returns 0 if out of memory. */
+static int
+oes_nhg_nh_buckets_grow(struct oes_nhg_table *table_p)
+{
+    unsigned int *buckets_p, size, nh, b;
+
+    if (table_p->nh_cnt < table_p->nh_bucket_cnt) {
+        return 1;
+    }
+    size = table_p->nh_bucket_cnt ? table_p->nh_bucket_cnt * 2 : OES_NHG_MIN_SIZE;
+    buckets_p = malloc(size * sizeof(*buckets_p));
+    if (buckets_p == NULL) {
+        return table_p->nh_bucket_cnt != 0;
+    }
+    memset(buckets_p, 0xff, size * sizeof(*buckets_p));
+    free(table_p->nh_buckets);
+    table_p->nh_buckets = buckets_p;
+    table_p->nh_bucket_cnt = size;
+    for (nh = 0; nh < table_p->nh_size; nh++) {
+        if (table_p->nhs[nh].deps != OES_NHG_END) {
+            b = oes_nhg_nh_bucket(table_p, &table_p->nhs[nh].ip);
+            table_p->nhs[nh].hash_next = table_p->nh_buckets[b];
+            table_p->nh_buckets[b] = nh;
+        }
+    }
+    return 1;
+}
+
+/* Finds or creates the entry of a normalized next hop, OES_NHG_END if out of memory. */
+static unsigned int
+oes_nhg_nh_get(struct oes_nhg_table *table_p,
+               const struct oes_ip_addr *ip_p)
+{
+    struct oes_nhg_nh *nhs_p;
+    unsigned int       nh, size, b;
+
+    nh = oes_nhg_nh_find(table_p, ip_p);
+    if (nh != OES_NHG_END) {
+        return nh;
+    }
+    if (!oes_nhg_nh_buckets_grow(table_p)) {
+        return OES_NHG_END;
+    }
+    if (table_p->nh_free == OES_NHG_END) {
+        size = table_p->nh_size ? table_p->nh_size * 2 : OES_NHG_MIN_SIZE;
+        nhs_p = realloc(table_p->nhs, size * sizeof(*nhs_p));
+        if (nhs_p == NULL) {
+            return OES_NHG_END;
+        }
+        for (nh = size; nh-- > table_p->nh_size;) {
+            nhs_p[nh].deps = OES_NHG_END;
+            nhs_p[nh].hash_next = table_p->nh_free;
+            table_p->nh_free = nh;
+        }
+        table_p->nhs = nhs_p;
+        table_p->nh_size = size;
+    }
+    nh = table_p->nh_free;
+    table_p->nh_free = table_p->nhs[nh].hash_next;
+    table_p->nhs[nh].ip = *ip_p;
+    table_p->nhs[nh].resolved = (table_p->resolve_fn != NULL) &&
+                                table_p->resolve_fn(table_p->resolve_ctx_p, ip_p);
+    b = oes_nhg_nh_bucket(table_p, ip_p);
+    table_p->nhs[nh].hash_next = table_p->nh_buckets[b];
+    table_p->nh_buckets[b] = nh;
+    table_p->nh_cnt++;
+    return nh;
+}
+
+static void
+oes_nhg_nh_free(struct oes_nhg_table *table_p,
+                unsigned int nh)
+{
+    unsigned int *link_p = &table_p->nh_buckets[oes_nhg_nh_bucket(table_p, &table_p->nhs[nh].ip)];
+
+    while (*link_p != nh) {
+        link_p = &table_p->nhs[*link_p].hash_next;
+    }
+    *link_p = table_p->nhs[nh].hash_next;
+    table_p->nhs[nh].hash_next = table_p->nh_free;
+    table_p->nh_free = nh;
+    table_p->nh_cnt--;
+}
+
+/* Takes a dependency node, OES_NHG_END if out of memory. */
+static unsigned int
+oes_nhg_dep_alloc(struct oes_nhg_table *table_p)
+{
+    struct oes_nhg_dep *deps_p;
+    unsigned int        dep, size;
+
+    if (table_p->dep_free == OES_NHG_END) {
+        size = table_p->dep_size ? table_p->dep_size * 2 : OES_NHG_MIN_SIZE;
+        deps_p = realloc(table_p->deps, size * sizeof(*deps_p));
+        if (deps_p == NULL) {
+            return OES_NHG_END;
+        }
+        for (dep = size; dep-- > table_p->dep_size;) {
+            deps_p[dep].next = table_p->dep_free;
+            table_p->dep_free = dep;
+        }
+        table_p->deps = deps_p;
+        table_p->dep_size = size;
+    }
+    dep = table_p->dep_free;
+    table_p->dep_free = table_p->deps[dep].next;
+    return dep;
+}
+
+/* Removes one member slot of a group from its next hop. */
+static void
+oes_nhg_dep_unlink(struct oes_nhg_table *table_p,
+                   unsigned int nhg_id,
+                   const struct oes_ip_addr *ip_p)
+{
+    unsigned int  nh = oes_nhg_nh_find(table_p, ip_p);
+    unsigned int *link_p = &table_p->nhs[nh].deps;
+    unsigned int  dep;
+
+    while (table_p->deps[*link_p].nhg_id != nhg_id) {
+        link_p = &table_p->deps[*link_p].next;
+    }
+    dep = *link_p;
+    *link_p = table_p->deps[dep].next;
+    table_p->deps[dep].next = table_p->dep_free;
+    table_p->dep_free = dep;
+    if (table_p->nhs[nh].deps == OES_NHG_END) {
+        oes_nhg_nh_free(table_p, nh);
+    }
+}
+
+static void
+oes_nhg_deps_unlink(struct oes_nhg_table *table_p,
+                    unsigned int nhg_id,
+                    const struct oes_ip_addr *members_p,
+                    unsigned short cnt)
+{
+    unsigned short m;
+
+    for (m = 0; m < cnt; m++) {
+        oes_nhg_dep_unlink(table_p, nhg_id, &members_p[m]);
+    }
+}
+
+/* Puts every member slot of a group on the list of its next hop. */
+static oes_status_e
+oes_nhg_deps_link(struct oes_nhg_table *table_p,
+                  unsigned int nhg_id)
+{
+    struct oes_nhg *nhg_p = &table_p->groups[nhg_id];
+    unsigned int    nh, dep;
+    unsigned short  m;
+
+    for (m = 0; m < nhg_p->cnt; m++) {
+        nh = oes_nhg_nh_get(table_p, &nhg_p->members[m]);
+        dep = (nh == OES_NHG_END) ? OES_NHG_END : oes_nhg_dep_alloc(table_p);
+        if (dep == OES_NHG_END) {
+            if ((nh != OES_NHG_END) && (table_p->nhs[nh].deps == OES_NHG_END)) {
+                oes_nhg_nh_free(table_p, nh);
+            }
+            oes_nhg_deps_unlink(table_p, nhg_id, nhg_p->members, m);
+            return OES_STATUS_NO_MEMORY;
+        }
+        table_p->deps[dep].nhg_id = nhg_id;
+        table_p->deps[dep].next = table_p->nhs[nh].deps;
+        table_p->nhs[nh].deps = dep;
+    }
+    return OES_STATUS_SUCCESS;
+}
+
+static unsigned short
+oes_nhg_resolved_count(const struct oes_nhg_table *table_p,
+                       const struct oes_nhg *nhg_p)
+{
+    unsigned short m, cnt = 0;
+
+    for (m = 0; m < nhg_p->cnt; m++) {
+        cnt += table_p->nhs[oes_nhg_nh_find(table_p, &nhg_p->members[m])].resolved;
+    }
+    return cnt;
+}
+
+/* Forgets every next hop, the arrays stay allocated. */
+static void
+oes_nhg_deps_reset(struct oes_nhg_table *table_p)
+{
+    unsigned int i;
+
+    if (table_p->nh_buckets != NULL) {
+        memset(table_p->nh_buckets, 0xff, table_p->nh_bucket_cnt * sizeof(*table_p->nh_buckets));
+    }
+    table_p->nh_free = OES_NHG_END;
+    for (i = table_p->nh_size; i-- > 0;) {
+        table_p->nhs[i].deps = OES_NHG_END;
+        table_p->nhs[i].hash_next = table_p->nh_free;
+        table_p->nh_free = i;
+    }
+    table_p->nh_cnt = 0;
+    table_p->dep_free = OES_NHG_END;
+    for (i = table_p->dep_size; i-- > 0;) {
+        table_p->deps[i].next = table_p->dep_free;
+        table_p->dep_free = i;
+    }
+}
+
+/* Takes a group off the free list, returns OES_NHG_NONE if none is left. */
+static unsigned int
+oes_nhg_alloc(struct oes_nhg_table *table_p)
+{
+    struct oes_nhg *groups_p;
+    unsigned int    size, id;
+
+    if (table_p->free_head == OES_NHG_END) {
+        size = table_p->size * 2;
+        if (size > OES_NHG_MAX_GROUPS) {
+            return OES_NHG_NONE;
+        }
+        groups_p = realloc(table_p->groups, size * sizeof(*groups_p));
+        if (groups_p == NULL) {
+            return OES_NHG_NONE;
+        }
+        table_p->groups = groups_p;
+        memset(&table_p->groups[table_p->size], 0,
+               (size - table_p->size) * sizeof(*groups_p));
+        for (id = size; id-- > table_p->size;) {
+            table_p->groups[id].next = table_p->free_head;
+            table_p->free_head = id;
+        }
+        table_p->size = size;
+    }
+    id = table_p->free_head;
+    table_p->free_head = table_p->groups[id].next;
+    return id;
+}
+
+/* Puts every group but OES_NHG_NONE on the free list and empties the chains. */
+static void
+oes_nhg_reset(struct oes_nhg_table *table_p)
+{
+    unsigned int id;
+
+    memset(table_p->buckets, 0xff, table_p->bucket_cnt * sizeof(*table_p->buckets));
+    table_p->free_head = OES_NHG_END;
+    for (id = table_p->size; --id > 0;) {
+        table_p->groups[id].refcnt = 0;
+        table_p->groups[id].cnt = 0;
+        table_p->groups[id].members = NULL;
+        table_p->groups[id].res_bucket_cnt = 0;
+        table_p->groups[id].res_buckets = NULL;
+        table_p->groups[id].res_activity = NULL;
+        table_p->groups[id].resolved_cnt = 0;
+        table_p->groups[id].next = table_p->free_head;
+        table_p->free_head = id;
+    }
+    table_p->cnt = 0;
+    oes_nhg_deps_reset(table_p);
+}
+
+oes_status_e
+oes_nhg_table_init(struct oes_nhg_table *table_p,
+                   oes_nhg_resolve_fn resolve_fn,
+                   void *resolve_ctx_p)
+{
+    memset(table_p, 0, sizeof(*table_p));
+    table_p->resolve_fn = resolve_fn;
+    table_p->resolve_ctx_p = resolve_ctx_p;
+    table_p->groups = calloc(OES_NHG_MIN_SIZE, sizeof(*table_p->groups));
+    table_p->buckets = malloc(OES_NHG_MIN_SIZE * sizeof(*table_p->buckets));
+    if ((table_p->groups == NULL) || (table_p->buckets == NULL)) {
+        free(table_p->groups);
+        free(table_p->buckets);
+        return OES_STATUS_NO_MEMORY;
+    }
+    table_p->size = OES_NHG_MIN_SIZE;
+    table_p->bucket_cnt = OES_NHG_MIN_SIZE;
+    oes_nhg_reset(table_p);
+    return OES_STATUS_SUCCESS;
+}
+
+void
+oes_nhg_table_deinit(struct oes_nhg_table *table_p)
+{
+    unsigned int id;
+
+    for (id = 1; id < table_p->size; id++) {
+        free(table_p->groups[id].members);
+        oes_nhg_res_free(&table_p->groups[id]);
+    }
+    free(table_p->groups);
+    free(table_p->buckets);
+    free(table_p->nhs);
+    free(table_p->nh_buckets);
+    free(table_p->deps);
+    memset(table_p, 0, sizeof(*table_p));
+}
+
+void
+oes_nhg_table_flush(struct oes_nhg_table *table_p)
+{
+    unsigned int id;
+
+    for (id = 1; id < table_p->size; id++) {
+        free(table_p->groups[id].members);
+        oes_nhg_res_free(&table_p->groups[id]);
+    }
+    oes_nhg_reset(table_p);
+}
+
+/* Returns a malloc'ed copy of size bytes, NULL if size is 0 or out of memory. */
+static void *
+oes_nhg_dup(const void *src_p,
+            size_t size)
+{
+    void *dst_p;
+
+    if (size == 0) {
+        return NULL;
+    }
+    dst_p = malloc(size);
+    if (dst_p != NULL) {
+        memcpy(dst_p, src_p, size);
+    }
+    return dst_p;
+}
+
+/* Asks resolve_fn for every next hop in use and recounts the resolved members of every group. */
+static void
+oes_nhg_resolve_all(struct oes_nhg_table *table_p)
+{
+    unsigned int id, nh;
+
+    for (nh = 0; nh < table_p->nh_size; nh++) {
+        if (table_p->nhs[nh].deps != OES_NHG_END) {
+            table_p->nhs[nh].resolved = (table_p->resolve_fn != NULL) &&
+                                        table_p->resolve_fn(table_p->resolve_ctx_p, &table_p->nhs[nh].ip);
+        }
+    }
+    for (id = 1; id < table_p->size; id++) {
+        if (table_p->groups[id].refcnt) {
+            table_p->groups[id].resolved_cnt = oes_nhg_resolved_count(table_p, &table_p->groups[id]);
+        }
+    }
+}
+
+oes_status_e
+oes_nhg_table_clone(struct oes_nhg_table *table_p,
+                    const struct oes_nhg_table *src_p,
+                    oes_nhg_resolve_fn resolve_fn,
+                    void *resolve_ctx_p)
+{
+    const struct oes_nhg *src_nhg_p;
+    struct oes_nhg       *nhg_p;
+    unsigned int          id;
+    int                   failed = 0;
+
+    memcpy(table_p, src_p, sizeof(*table_p));
+    table_p->resolve_fn = resolve_fn;
+    table_p->resolve_ctx_p = resolve_ctx_p;
+    table_p->groups = calloc(src_p->size, sizeof(*table_p->groups));
+    table_p->buckets = oes_nhg_dup(src_p->buckets, src_p->bucket_cnt * sizeof(*src_p->buckets));
+    table_p->nhs = oes_nhg_dup(src_p->nhs, src_p->nh_size * sizeof(*src_p->nhs));
+    table_p->nh_buckets = oes_nhg_dup(src_p->nh_buckets, src_p->nh_bucket_cnt * sizeof(*src_p->nh_buckets));
+    table_p->deps = oes_nhg_dup(src_p->deps, src_p->dep_size * sizeof(*src_p->deps));
+    if ((table_p->groups == NULL) || (table_p->buckets == NULL) ||
+        ((table_p->nhs == NULL) && src_p->nh_size) ||
+        ((table_p->nh_buckets == NULL) && src_p->nh_bucket_cnt) ||
+        ((table_p->deps == NULL) && src_p->dep_size)) {
+        free(table_p->groups);
+        free(table_p->buckets);
+        free(table_p->nhs);
+        free(table_p->nh_buckets);
+        free(table_p->deps);
+        memset(table_p, 0, sizeof(*table_p));
+        return OES_STATUS_NO_MEMORY;
+    }
+
+    for (id = 1; id < src_p->size; id++) {
+        src_nhg_p = &src_p->groups[id];
+        nhg_p = &table_p->groups[id];
+        *nhg_p = *src_nhg_p;
+        nhg_p->members = NULL;
+        nhg_p->res_buckets = NULL;
+        nhg_p->res_activity = NULL;
+        if (src_nhg_p->refcnt == 0) {
+            continue;
+        }
+        nhg_p->members = oes_nhg_dup(src_nhg_p->members, src_nhg_p->cnt * sizeof(*src_nhg_p->members));
+        failed |= (nhg_p->members == NULL);
+        if (src_nhg_p->res_bucket_cnt) {
+            nhg_p->res_buckets = oes_nhg_dup(src_nhg_p->res_buckets,
+                                             src_nhg_p->res_bucket_cnt * sizeof(*src_nhg_p->res_buckets));
+            nhg_p->res_activity = calloc((src_nhg_p->res_bucket_cnt + 63) / 64,
+                                         sizeof(*nhg_p->res_activity));
+            failed |= (nhg_p->res_buckets == NULL) || (nhg_p->res_activity == NULL);
+        }
+    }
+    if (failed) {
+        oes_nhg_table_deinit(table_p);
+        return OES_STATUS_NO_MEMORY;
+    }
+
+    /* the clone resolves its next hops against its own neighbours */
+    oes_nhg_resolve_all(table_p);
+    return OES_STATUS_SUCCESS;
+}
+
+/* Finds or creates the group of a list, bucket_cnt 0 meaning a plain group. */
+static oes_status_e
+oes_nhg_intern(struct oes_nhg_table *table_p,
+               const struct oes_ip_addr *next_hop_list_p,
+               unsigned short next_hop_cnt,
+               unsigned int bucket_cnt,
+               unsigned int seed_nhg_id,
+               unsigned int *nhg_id_p)
+{
+    struct oes_ip_addr  stack_members[OES_NHG_STACK_MEMBERS];
+    struct oes_ip_addr *members_p = stack_members;
+    struct oes_nhg     *nhg_p;
+    unsigned int        hash, id;
+    oes_status_e        status;
+
+    if (next_hop_cnt == 0) {
+        *nhg_id_p = OES_NHG_NONE;
+        return OES_STATUS_SUCCESS;
+    }
+    if ((next_hop_cnt > OES_NHG_STACK_MEMBERS) &&
+        ((members_p = malloc(next_hop_cnt * sizeof(*members_p))) == NULL)) {
+        return OES_STATUS_NO_MEMORY;
+    }
+    oes_nhg_normalize(members_p, next_hop_list_p, next_hop_cnt);
+    hash = oes_nhg_hash(members_p, next_hop_cnt) ^ bucket_cnt;
+
+    for (id = table_p->buckets[hash & (table_p->bucket_cnt - 1)]; id != OES_NHG_END; id = nhg_p->next) {
+        nhg_p = &table_p->groups[id];
+        if ((nhg_p->hash == hash) && (nhg_p->cnt == next_hop_cnt) &&
+            (nhg_p->res_bucket_cnt == bucket_cnt) &&
+            !memcmp(nhg_p->members, members_p, next_hop_cnt * sizeof(*members_p))) {
+            nhg_p->refcnt++;
+            *nhg_id_p = id;
+            if (members_p != stack_members) {
+                free(members_p);
+            }
+            return OES_STATUS_SUCCESS;
+        }
+    }
+
+    if (members_p == stack_members) {
+        members_p = malloc(next_hop_cnt * sizeof(*members_p));
+        if (members_p == NULL) {
+            return OES_STATUS_NO_MEMORY;
+        }
+        memcpy(members_p, stack_members, next_hop_cnt * sizeof(*members_p));
+    }
+    id = oes_nhg_alloc(table_p);
+    if (id == OES_NHG_NONE) {
+        free(members_p);
+        return (table_p->size * 2 > OES_NHG_MAX_GROUPS) ? OES_STATUS_NO_RESOURCES : OES_STATUS_NO_MEMORY;
+    }
+    nhg_p = &table_p->groups[id];
+    nhg_p->hash = hash;
+    nhg_p->cnt = next_hop_cnt;
+    nhg_p->members = members_p;
+    status = oes_nhg_deps_link(table_p, id);
+    if ((status == OES_STATUS_SUCCESS) && bucket_cnt) {
+        status = oes_nhg_res_init(nhg_p, bucket_cnt, oes_nhg_entry(table_p, seed_nhg_id));
+        if (status != OES_STATUS_SUCCESS) {
+            oes_nhg_deps_unlink(table_p, id, members_p, next_hop_cnt);
+        }
+    }
+    if (status != OES_STATUS_SUCCESS) {
+        free(members_p);
+        nhg_p->members = NULL;
+        nhg_p->cnt = 0;
+        nhg_p->next = table_p->free_head;
+        table_p->free_head = id;
+        return status;
+    }
+    nhg_p->resolved_cnt = oes_nhg_resolved_count(table_p, nhg_p);
+    nhg_p->refcnt = 1;
+    table_p->cnt++;
+    oes_nhg_bucket_insert(table_p, id);
+    oes_nhg_buckets_grow(table_p);
+    *nhg_id_p = id;
+    return OES_STATUS_SUCCESS;
+}
+
+oes_status_e
+oes_nhg_get(struct oes_nhg_table *table_p,
+            const struct oes_ip_addr *next_hop_list_p,
+            unsigned short next_hop_cnt,
+            unsigned int *nhg_id_p)
+{
+    return oes_nhg_intern(table_p, next_hop_list_p, next_hop_cnt, 0, OES_NHG_NONE, nhg_id_p);
+}
+
+oes_status_e
+oes_nhg_res_get(struct oes_nhg_table *table_p,
+                const struct oes_ip_addr *next_hop_list_p,
+                unsigned short next_hop_cnt,
+                unsigned int bucket_cnt,
+                unsigned int seed_nhg_id,
+                unsigned int *nhg_id_p)
+{
+    if ((bucket_cnt == 0) || (bucket_cnt > OES_NHG_RES_MAX_BUCKETS) ||
+        (seed_nhg_id >= table_p->size)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    return oes_nhg_intern(table_p, next_hop_list_p, next_hop_cnt, bucket_cnt, seed_nhg_id, nhg_id_p);
+}
+
+unsigned int
+oes_nhg_res_rebalance(struct oes_nhg_table *table_p,
+                      unsigned int nhg_id,
+                      unsigned int max_moves,
+                      int force)
+{
+    struct oes_nhg *nhg_p;
+    unsigned int   *load_p;
+    unsigned int    b, m, under = 0, moves = 0;
+
+    if ((nhg_id == OES_NHG_NONE) || (nhg_id >= table_p->size)) {
+        return 0;
+    }
+    nhg_p = &table_p->groups[nhg_id];
+    if (!nhg_p->refcnt || !nhg_p->res_bucket_cnt) {
+        return 0;
+    }
+    load_p = calloc(nhg_p->cnt, sizeof(*load_p));
+    if (load_p == NULL) {
+        return 0;
+    }
+    for (b = 0; b < nhg_p->res_bucket_cnt; b++) {
+        load_p[nhg_p->res_buckets[b]]++;
+    }
+    for (b = 0; (b < nhg_p->res_bucket_cnt) && (moves < max_moves); b++) {
+        m = nhg_p->res_buckets[b];
+        if (load_p[m] <= oes_nhg_res_target(nhg_p, m)) {
+            continue;
+        }
+        if (!force && ((nhg_p->res_activity[b / 64] >> (b % 64)) & 1)) {
+            continue;
+        }
+        /* loads sum to the targets, so an over member implies an under one */
+        while (load_p[under] >= oes_nhg_res_target(nhg_p, under)) {
+            under++;
+        }
+        nhg_p->res_buckets[b] = under;
+        load_p[m]--;
+        load_p[under]++;
+        moves++;
+    }
+    /* a new idle period starts */
+    memset(nhg_p->res_activity, 0, (nhg_p->res_bucket_cnt + 63) / 64 * sizeof(*nhg_p->res_activity));
+    free(load_p);
+    return moves;
+}
+
+void
+oes_nhg_put(struct oes_nhg_table *table_p,
+            unsigned int nhg_id)
+{
+    struct oes_nhg *nhg_p;
+
+    if (nhg_id == OES_NHG_NONE) {
+        return;
+    }
+    nhg_p = &table_p->groups[nhg_id];
+    if (--nhg_p->refcnt) {
+        return;
+    }
+    oes_nhg_bucket_remove(table_p, nhg_id);
+    oes_nhg_deps_unlink(table_p, nhg_id, nhg_p->members, nhg_p->cnt);
+    free(nhg_p->members);
+    oes_nhg_res_free(nhg_p);
+    nhg_p->resolved_cnt = 0;
+    nhg_p->members = NULL;
+    nhg_p->cnt = 0;
+    nhg_p->next = table_p->free_head;
+    table_p->free_head = nhg_id;
+    table_p->cnt--;
+}
+
+oes_status_e
+oes_nhg_members_set(struct oes_nhg_table *table_p,
+                    unsigned int nhg_id,
+                    const struct oes_ip_addr *next_hop_list_p,
+                    unsigned short next_hop_cnt)
+{
+    struct oes_ip_addr *members_p, *old_members_p;
+    struct oes_nhg     *nhg_p;
+    unsigned short      old_cnt;
+    oes_status_e        status;
+
+    if ((nhg_id == OES_NHG_NONE) || (nhg_id >= table_p->size) ||
+        !table_p->groups[nhg_id].refcnt || (next_hop_list_p == NULL) || (next_hop_cnt == 0)) {
+        return OES_STATUS_PARAM_ERROR;
+    }
+    members_p = malloc(next_hop_cnt * sizeof(*members_p));
+    if (members_p == NULL) {
+        return OES_STATUS_NO_MEMORY;
+    }
+    oes_nhg_normalize(members_p, next_hop_list_p, next_hop_cnt);
+
+    nhg_p = &table_p->groups[nhg_id];
+    old_members_p = nhg_p->members;
+    old_cnt = nhg_p->cnt;
+    nhg_p->members = members_p;
+    nhg_p->cnt = next_hop_cnt;
+    status = oes_nhg_deps_link(table_p, nhg_id);
+    if ((status == OES_STATUS_SUCCESS) && nhg_p->res_bucket_cnt) {
+        status = oes_nhg_res_remap(nhg_p, old_members_p, old_cnt, nhg_p->res_buckets);
+        if (status != OES_STATUS_SUCCESS) {
+            oes_nhg_deps_unlink(table_p, nhg_id, members_p, next_hop_cnt);
+        }
+    }
+    if (status != OES_STATUS_SUCCESS) {
+        nhg_p->members = old_members_p;
+        nhg_p->cnt = old_cnt;
+        free(members_p);
+        return OES_STATUS_NO_MEMORY;
+    }
+    /* the new slots are linked first so shared next hops keep their entry */
+    oes_nhg_deps_unlink(table_p, nhg_id, old_members_p, old_cnt);
+    free(old_members_p);
+    nhg_p->resolved_cnt = oes_nhg_resolved_count(table_p, nhg_p);
+    oes_nhg_bucket_remove(table_p, nhg_id);
+    nhg_p->hash = oes_nhg_hash(members_p, next_hop_cnt) ^ nhg_p->res_bucket_cnt;
+    oes_nhg_bucket_insert(table_p, nhg_id);
+    return OES_STATUS_SUCCESS;
+}
+
+unsigned long long
+oes_nhg_mem_size(const struct oes_nhg_table *table_p)
+{
+    unsigned long long size = sizeof(*table_p) +
+                              (unsigned long long)table_p->size * sizeof(*table_p->groups) +
+                              (unsigned long long)table_p->bucket_cnt * sizeof(*table_p->buckets);
+    unsigned int       id;
+
+    for (id = 1; id < table_p->size; id++) {
+        size += table_p->groups[id].cnt * sizeof(*table_p->groups[id].members) +
+                table_p->groups[id].res_bucket_cnt * sizeof(*table_p->groups[id].res_buckets) +
+                (table_p->groups[id].res_bucket_cnt + 63) / 64 * sizeof(*table_p->groups[id].res_activity);
+    }
+    size += (unsigned long long)table_p->nh_size * sizeof(*table_p->nhs) +
+            (unsigned long long)table_p->nh_bucket_cnt * sizeof(*table_p->nh_buckets) +
+            (unsigned long long)table_p->dep_size * sizeof(*table_p->deps);
+    return size;
+}
+
+unsigned int
+oes_nhg_neigh_update(struct oes_nhg_table *table_p,
+                     const struct oes_ip_addr *next_hop_p,
+                     int resolved)
+{
+    struct oes_ip_addr ip;
+    struct oes_nhg    *nhg_p;
+    unsigned int       nh, dep, flipped = 0;
+
+    oes_nhg_normalize(&ip, next_hop_p, 1);
+    nh = oes_nhg_nh_find(table_p, &ip);
+    resolved = !!resolved;
+    if ((nh == OES_NHG_END) || (table_p->nhs[nh].resolved == resolved)) {
+        return 0;
+    }
+    table_p->nhs[nh].resolved = resolved;
+    for (dep = table_p->nhs[nh].deps; dep != OES_NHG_END; dep = table_p->deps[dep].next) {
+        nhg_p = &table_p->groups[table_p->deps[dep].nhg_id];
+        if (resolved) {
+            flipped += (nhg_p->resolved_cnt++ == 0);
+        } else {
+            flipped += (--nhg_p->resolved_cnt == 0);
+        }
+    }
+    return flipped;
+}
+
+/*
+ * Image section of a table. It is followed by the groups with their
+ * pointers cleared, the chain heads, the next hops, their chain heads
+ * and the dependencies, then the members and bucket owners of every
+ * group in use, in ID order.
+ */
+struct oes_nhg_image {
+    unsigned int size;
+    unsigned int free_head;
+    unsigned int cnt;
+    unsigned int bucket_cnt;
+    unsigned int nh_size;
+    unsigned int nh_free;
+    unsigned int nh_cnt;
+    unsigned int nh_bucket_cnt;
+    unsigned int dep_size;
+    unsigned int dep_free;
+};
+
+#define OES_NHG_IMAGE_BUF 256   /**< groups per image write */
+
+void
+oes_nhg_save(const struct oes_nhg_table *table_p,
+             struct oes_image_writer *writer_p)
+{
+    struct oes_nhg       groups[OES_NHG_IMAGE_BUF];
+    struct oes_nhg_image image;
+    const struct oes_nhg *nhg_p;
+    unsigned int          id, i, n;
+
+    memset(&image, 0, sizeof(image));
+    image.size = table_p->size;
+    image.free_head = table_p->free_head;
+    image.cnt = table_p->cnt;
+    image.bucket_cnt = table_p->bucket_cnt;
+    image.nh_size = table_p->nh_size;
+    image.nh_free = table_p->nh_free;
+    image.nh_cnt = table_p->nh_cnt;
+    image.nh_bucket_cnt = table_p->nh_bucket_cnt;
+    image.dep_size = table_p->dep_size;
+    image.dep_free = table_p->dep_free;
+    oes_image_write(writer_p, &image, sizeof(image));
+
+    for (id = 0; id < table_p->size; id += n) {
+        n = (table_p->size - id < OES_NHG_IMAGE_BUF) ? table_p->size - id : OES_NHG_IMAGE_BUF;
+        memcpy(groups, &table_p->groups[id], n * sizeof(groups[0]));
+        for (i = 0; i < n; i++) {
+            groups[i].members = NULL;
+            groups[i].res_buckets = NULL;
+            groups[i].res_activity = NULL;
+        }
+        oes_image_write(writer_p, groups, n * sizeof(groups[0]));
+    }
+    oes_image_write(writer_p, table_p->buckets, table_p->bucket_cnt * sizeof(*table_p->buckets));
+    oes_image_write(writer_p, table_p->nhs, table_p->nh_size * sizeof(*table_p->nhs));
+    oes_image_write(writer_p, table_p->nh_buckets, table_p->nh_bucket_cnt * sizeof(*table_p->nh_buckets));
+    oes_image_write(writer_p, table_p->deps, table_p->dep_size * sizeof(*table_p->deps));
+    for (id = 1; id < table_p->size; id++) {
+        nhg_p = &table_p->groups[id];
+        if (nhg_p->refcnt == 0) {
+            continue;
+        }
+        oes_image_write(writer_p, nhg_p->members, nhg_p->cnt * sizeof(*nhg_p->members));
+        oes_image_write(writer_p, nhg_p->res_buckets, nhg_p->res_bucket_cnt * sizeof(*nhg_p->res_buckets));
+    }
+}
+
+/* Returns a malloc'ed copy of the next size bytes of an image, NULL if size is 0, short or out of memory. */
+static void *
+oes_nhg_load_array(struct oes_image_reader *reader_p,
+                   size_t size)
+{
+    const void *src_p = oes_image_read(reader_p, size);
+
+    return (src_p == NULL) ? NULL : oes_nhg_dup(src_p, size);
+}
+
+oes_status_e
+oes_nhg_load(struct oes_nhg_table *table_p,
+             struct oes_image_reader *reader_p,
+             oes_nhg_resolve_fn resolve_fn,
+             void *resolve_ctx_p)
+{
+    const struct oes_nhg_image *image_p;
+    const struct oes_nhg       *groups_p;
+    struct oes_nhg             *nhg_p;
+    unsigned int                id;
+    int                         failed = 0;
+
+    memset(table_p, 0, sizeof(*table_p));
+    image_p = oes_image_read(reader_p, sizeof(*image_p));
+    if ((image_p == NULL) || (image_p->size == 0) || (image_p->size > OES_NHG_MAX_GROUPS) ||
+        (image_p->cnt >= image_p->size) || (image_p->bucket_cnt == 0) ||
+        (image_p->bucket_cnt & (image_p->bucket_cnt - 1)) ||
+        (image_p->nh_bucket_cnt & (image_p->nh_bucket_cnt - 1))) {
+        return OES_STATUS_ERROR;
+    }
+    groups_p = oes_image_read(reader_p, image_p->size * sizeof(*groups_p));
+    table_p->size = image_p->size;
+    table_p->free_head = image_p->free_head;
+    table_p->cnt = image_p->cnt;
+    table_p->bucket_cnt = image_p->bucket_cnt;
+    table_p->resolve_fn = resolve_fn;
+    table_p->resolve_ctx_p = resolve_ctx_p;
+    table_p->nh_size = image_p->nh_size;
+    table_p->nh_free = image_p->nh_free;
+    table_p->nh_cnt = image_p->nh_cnt;
+    table_p->nh_bucket_cnt = image_p->nh_bucket_cnt;
+    table_p->dep_size = image_p->dep_size;
+    table_p->dep_free = image_p->dep_free;
+    table_p->groups = calloc(table_p->size, sizeof(*table_p->groups));
+    table_p->buckets = oes_nhg_load_array(reader_p, table_p->bucket_cnt * sizeof(*table_p->buckets));
+    table_p->nhs = oes_nhg_load_array(reader_p, table_p->nh_size * sizeof(*table_p->nhs));
+    table_p->nh_buckets = oes_nhg_load_array(reader_p, table_p->nh_bucket_cnt * sizeof(*table_p->nh_buckets));
+    table_p->deps = oes_nhg_load_array(reader_p, table_p->dep_size * sizeof(*table_p->deps));
+    if ((groups_p == NULL) || (table_p->groups == NULL) || (table_p->buckets == NULL) ||
+        ((table_p->nhs == NULL) && table_p->nh_size) ||
+        ((table_p->nh_buckets == NULL) && table_p->nh_bucket_cnt) ||
+        ((table_p->deps == NULL) && table_p->dep_size)) {
+        free(table_p->groups);
+        free(table_p->buckets);
+        free(table_p->nhs);
+        free(table_p->nh_buckets);
+        free(table_p->deps);
+        memset(table_p, 0, sizeof(*table_p));
+        return reader_p->failed ? OES_STATUS_ERROR : OES_STATUS_NO_MEMORY;
+    }
+
+    for (id = 1; !failed && (id < table_p->size); id++) {
+        nhg_p = &table_p->groups[id];
+        *nhg_p = groups_p[id];
+        nhg_p->members = NULL;
+        nhg_p->res_buckets = NULL;
+        nhg_p->res_activity = NULL;
+        if (nhg_p->refcnt == 0) {
+            continue;
+        }
+        nhg_p->members = oes_nhg_load_array(reader_p, nhg_p->cnt * sizeof(*nhg_p->members));
+        failed |= (nhg_p->members == NULL);
+        if (nhg_p->res_bucket_cnt) {
+            nhg_p->res_buckets = oes_nhg_load_array(reader_p,
+                                                    nhg_p->res_bucket_cnt * sizeof(*nhg_p->res_buckets));
+            nhg_p->res_activity = calloc((nhg_p->res_bucket_cnt + 63) / 64, sizeof(*nhg_p->res_activity));
+            failed |= (nhg_p->res_buckets == NULL) || (nhg_p->res_activity == NULL);
+        }
+    }
+    if (failed) {
+        oes_nhg_table_deinit(table_p);
+        return reader_p->failed ? OES_STATUS_ERROR : OES_STATUS_NO_MEMORY;
+    }
+
+    /* next hop state is not saved, the neighbours are asked again */
+    oes_nhg_resolve_all(table_p);
+    return OES_STATUS_SUCCESS;
+}
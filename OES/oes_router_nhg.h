@@ -0,0 +1,375 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __OES_ROUTER_NHG_H__
+#define __OES_ROUTER_NHG_H__
+
+/************************************************
+ *  Next hop groups
+ *
+ *  Routes do not keep their own next hop list. The list is sorted and
+ *  interned into a reference counted group, so every route using the
+ *  same ECMP set points to the same group ID. Groups are found by a
+ *  hash on their sorted members. Group 0 (OES_NHG_NONE) is the empty
+ *  list and is never allocated.
+ *
+ *  A resilient group adds a fixed table of buckets, each owned by one
+ *  member. Flows hash to a bucket rather than straight to a member, so
+ *  losing a member only moves the flows of its own buckets. New
+ *  members get buckets through oes_nhg_res_rebalance, a few at a time,
+ *  preferring buckets no flow has used since the previous call.
+ *
+ *  The table also tracks which groups use each next hop, so a
+ *  neighbour resolving or going away updates the resolved member count
+ *  of just the groups that depend on it (oes_nhg_neigh_update), without
+ *  visiting routes.
+ ***********************************************/
+
+#define OES_NHG_NONE                  0
+#define OES_NHG_MAX_GROUPS            (1 << 24)
+#define OES_NHG_RES_MAX_BUCKETS       32768
+
+/* tells whether a next hop has a neighbour to forward to */
+typedef int (*oes_nhg_resolve_fn)(void * ctx_p, const struct oes_ip_addr * next_hop_p);
+
+struct oes_nhg {
+    unsigned int         refcnt;          /**< 0 while on the free list */
+    unsigned int         hash;
+    unsigned int         next;            /**< hash chain, or free list link */
+    unsigned short       cnt;
+    unsigned short       resolved_cnt;    /**< members with a resolved neighbour */
+    struct oes_ip_addr * members;         /**< sorted */
+    unsigned short       res_bucket_cnt;  /**< 0 for a plain group */
+    unsigned short     * res_buckets;     /**< member index per bucket */
+    unsigned long long * res_activity;    /**< bucket used since the last rebalance */
+};
+
+/* a next hop used by at least one group */
+struct oes_nhg_nh {
+    struct oes_ip_addr ip;
+    unsigned int       hash_next;         /**< hash chain, or free list link */
+    unsigned int       deps;              /**< first group using it */
+    unsigned char      resolved;
+};
+
+/* one member slot of a group, on the list of its next hop */
+struct oes_nhg_dep {
+    unsigned int nhg_id;
+    unsigned int next;
+};
+
+struct oes_nhg_table {
+    struct oes_nhg     * groups;          /**< indexed by group ID */
+    unsigned int         size;
+    unsigned int         free_head;
+    unsigned int         cnt;             /**< groups in use */
+    unsigned int       * buckets;         /**< hash chain heads */
+    unsigned int         bucket_cnt;      /**< power of 2 */
+    oes_nhg_resolve_fn   resolve_fn;
+    void               * resolve_ctx_p;
+    struct oes_nhg_nh  * nhs;
+    unsigned int         nh_size;
+    unsigned int         nh_free;
+    unsigned int         nh_cnt;
+    unsigned int       * nh_buckets;
+    unsigned int         nh_bucket_cnt;   /**< power of 2 */
+    struct oes_nhg_dep * deps;
+    unsigned int         dep_size;
+    unsigned int         dep_free;
+};
+
+/**
+ * This function initializes an empty next hop group table.
+ *
+ * @param[out] table_p - table
+ * @param[in] resolve_fn - asked for the state of a next hop when a
+ *       group starts using it, or NULL to start unresolved
+ * @param[in] resolve_ctx_p - passed to resolve_fn
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_NO_MEMORY if out of memory
+ */
+oes_status_e
+oes_nhg_table_init(struct oes_nhg_table * table_p,
+                   oes_nhg_resolve_fn resolve_fn,
+                   void * resolve_ctx_p);
+
+/**
+ * This function releases every group and the table memory.
+ *
+ * @param[in] table_p - table
+ */
+void
+oes_nhg_table_deinit(struct oes_nhg_table * table_p);
+
+/**
+ * This function initializes a table as a copy of another, keeping
+ * every group ID. The copy resolves its next hops with its own
+ * resolve_fn, and resilient groups start with no bucket activity.
+ *
+ * @param[out] table_p - new table
+ * @param[in] src_p - table to copy
+ * @param[in] resolve_fn - as for oes_nhg_table_init
+ * @param[in] resolve_ctx_p - passed to resolve_fn
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_NO_MEMORY if out of memory
+ */
+oes_status_e
+oes_nhg_table_clone(struct oes_nhg_table * table_p,
+                    const struct oes_nhg_table * src_p,
+                    oes_nhg_resolve_fn resolve_fn,
+                    void * resolve_ctx_p);
+
+/**
+ * This function releases every group, keeping the table empty and
+ * usable.
+ *
+ * @param[in] table_p - table
+ */
+void
+oes_nhg_table_flush(struct oes_nhg_table * table_p);
+
+/**
+ * This function takes a reference on the group holding a next hop
+ * list, creating the group if no route uses that list yet. Member
+ * order does not matter.
+ *
+ * @param[in] table_p - table
+ * @param[in] next_hop_list_p - next hops
+ * @param[in] next_hop_cnt - number of next hops, 0 gives OES_NHG_NONE
+ * @param[out] nhg_id_p - group ID
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_NO_MEMORY if out of memory
+ * @return OES_STATUS_NO_RESOURCES if the group table is full
+ */
+oes_status_e
+oes_nhg_get(struct oes_nhg_table * table_p,
+            const struct oes_ip_addr * next_hop_list_p,
+            unsigned short next_hop_cnt,
+            unsigned int * nhg_id_p);
+
+/**
+ * This function takes a reference on the resilient group holding a
+ * next hop list with bucket_cnt buckets. A new group starts from the
+ * bucket ownership of seed_nhg_id when that is a resilient group of
+ * the same size, typically the group the route used before: buckets
+ * of members still present keep their owner and only the rest are
+ * spread over the least loaded members.
+ *
+ * @param[in] table_p - table
+ * @param[in] next_hop_list_p - next hops
+ * @param[in] next_hop_cnt - number of next hops, 0 gives OES_NHG_NONE
+ * @param[in] bucket_cnt - number of buckets (1-OES_NHG_RES_MAX_BUCKETS)
+ * @param[in] seed_nhg_id - group to inherit bucket owners from, or OES_NHG_NONE
+ * @param[out] nhg_id_p - group ID
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_NO_MEMORY if out of memory
+ * @return OES_STATUS_NO_RESOURCES if the group table is full
+ */
+oes_status_e
+oes_nhg_res_get(struct oes_nhg_table * table_p,
+                const struct oes_ip_addr * next_hop_list_p,
+                unsigned short next_hop_cnt,
+                unsigned int bucket_cnt,
+                unsigned int seed_nhg_id,
+                unsigned int * nhg_id_p);
+
+/**
+ * This function moves at most max_moves buckets from members owning
+ * more than their share to members owning less. Buckets used since
+ * the previous call are left alone unless force is set. Calling it
+ * periodically paces the migration of flows to new members.
+ *
+ * @param[in] table_p - table
+ * @param[in] nhg_id - resilient group ID
+ * @param[in] max_moves - bucket move budget
+ * @param[in] force - move buckets even if in use
+ *
+ * @return number of buckets moved
+ */
+unsigned int
+oes_nhg_res_rebalance(struct oes_nhg_table * table_p,
+                      unsigned int nhg_id,
+                      unsigned int max_moves,
+                      int force);
+
+/**
+ * This function drops a reference taken by oes_nhg_get, freeing the
+ * group with its last reference.
+ *
+ * @param[in] table_p - table
+ * @param[in] nhg_id - group ID
+ */
+void
+oes_nhg_put(struct oes_nhg_table * table_p,
+            unsigned int nhg_id);
+
+/**
+ * This function takes one more reference on a group already held,
+ * dropped with oes_nhg_put.
+ *
+ * @param[in] table_p - table
+ * @param[in] nhg_id - group ID
+ */
+static inline void
+oes_nhg_hold(struct oes_nhg_table * table_p,
+             unsigned int nhg_id)
+{
+    if (nhg_id != OES_NHG_NONE) {
+        table_p->groups[nhg_id].refcnt++;
+    }
+}
+
+/**
+ * This function replaces the members of a group in place, so every
+ * route pointing to it moves to the new next hops at once. Resilient
+ * groups keep the owner of every bucket whose member stays. If another
+ * group already holds the new list both stay valid, later
+ * oes_nhg_get calls may return either.
+ *
+ * @param[in] table_p - table
+ * @param[in] nhg_id - group ID
+ * @param[in] next_hop_list_p - new next hops
+ * @param[in] next_hop_cnt - number of next hops, at least 1
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_PARAM_ERROR if any input parameter is invalid
+ * @return OES_STATUS_NO_MEMORY if out of memory
+ */
+oes_status_e
+oes_nhg_members_set(struct oes_nhg_table * table_p,
+                    unsigned int nhg_id,
+                    const struct oes_ip_addr * next_hop_list_p,
+                    unsigned short next_hop_cnt);
+
+/**
+ * This function records that a next hop resolved or stopped resolving,
+ * and updates the resolved member count of every group using it.
+ *
+ * @param[in] table_p - table
+ * @param[in] next_hop_p - next hop
+ * @param[in] resolved - new state
+ *
+ * @return number of groups that went from no resolved member to some,
+ *       or back
+ */
+unsigned int
+oes_nhg_neigh_update(struct oes_nhg_table * table_p,
+                     const struct oes_ip_addr * next_hop_p,
+                     int resolved);
+
+/**
+ * This function returns the group of an ID taken by oes_nhg_get, or
+ * NULL for OES_NHG_NONE.
+ *
+ * @param[in] table_p - table
+ * @param[in] nhg_id - group ID
+ *
+ * @return the group
+ */
+static inline const struct oes_nhg *
+oes_nhg_entry(const struct oes_nhg_table * table_p,
+              unsigned int nhg_id)
+{
+    return (nhg_id == OES_NHG_NONE) ? NULL : &table_p->groups[nhg_id];
+}
+
+/**
+ * This function picks the member index of a group for a flow hash, and
+ * marks the bucket used in a resilient group.
+ *
+ * @param[in] nhg_p - group
+ * @param[in] hash - flow hash
+ *
+ * @return member index
+ */
+static inline unsigned int
+oes_nhg_member(const struct oes_nhg * nhg_p,
+               unsigned int hash)
+{
+    unsigned int bucket;
+
+    if (!nhg_p->res_bucket_cnt) {
+        return (unsigned int)(((unsigned long long)hash * nhg_p->cnt) >> 32);
+    }
+    bucket = (unsigned int)(((unsigned long long)hash * nhg_p->res_bucket_cnt) >> 32);
+    oes_activity_mark(nhg_p->res_activity, bucket);
+    return nhg_p->res_buckets[bucket];
+}
+
+/**
+ * This function returns the memory used by the table in bytes.
+ *
+ * @param[in] table_p - table
+ *
+ * @return size in bytes
+ */
+unsigned long long
+oes_nhg_mem_size(const struct oes_nhg_table * table_p);
+
+struct oes_image_writer;
+struct oes_image_reader;
+
+/**
+ * This function writes a table to an image. Group IDs, hash chains and
+ * next hop dependencies are kept as they are, so no hash is computed
+ * again on load.
+ *
+ * @param[in] table_p - table
+ * @param[in] writer_p - image writer
+ */
+void
+oes_nhg_save(const struct oes_nhg_table * table_p,
+             struct oes_image_writer * writer_p);
+
+/**
+ * This function initializes a table from an image written by
+ * oes_nhg_save, keeping every group ID. As with oes_nhg_table_clone,
+ * next hops are resolved again and resilient groups start with no
+ * bucket activity.
+ *
+ * @param[out] table_p - new table
+ * @param[in] reader_p - image reader
+ * @param[in] resolve_fn - as for oes_nhg_table_init
+ * @param[in] resolve_ctx_p - passed to resolve_fn
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_ERROR if the image is inconsistent
+ * @return OES_STATUS_NO_MEMORY if out of memory
+ */
+oes_status_e
+oes_nhg_load(struct oes_nhg_table * table_p,
+             struct oes_image_reader * reader_p,
+             oes_nhg_resolve_fn resolve_fn,
+             void * resolve_ctx_p);
+
+#endif /* __OES_ROUTER_NHG_H__ */
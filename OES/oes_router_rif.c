@@ -0,0 +1,363 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <string.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_router_rif.h"
+
+#define OES_RIF_MAC_MIN_SIZE          256
+
+static unsigned int
+oes_rif_mac_hash(unsigned int rif,
+                 const struct ether_addr *mac_p)
+{
+    unsigned long long key = rif;
+    unsigned int       i;
+
+    for (i = 0; i < ETH_ALEN; i++) {
+        key = (key << 8) | mac_p->ether_addr_octet[i];
+    }
+    key *= 0x9e3779b97f4a7c15ULL;
+    return (unsigned int)(key >> 32);
+}
+
+static unsigned int *
+oes_rif_mac_bucket(const struct oes_rif_table *table_p,
+                   unsigned int rif,
+                   const struct ether_addr *mac_p)
+{
+    return &table_p->mac_buckets[oes_rif_mac_hash(rif, mac_p) & (table_p->mac_bucket_cnt - 1)];
+}
+
+/* Returns the map entry of an L2 interface, or NULL if its bridge has no table yet. */
+static unsigned short *
+oes_rif_map_entry(struct oes_rif_table *table_p,
+                  const struct oes_l3_interface *ifc_p)
+{
+    if (ifc_p->type == OES_INTERFACE_TYPE_ROUTER_PORT) {
+        return &table_p->port_rifs[ifc_p->ifc.port.port];
+    }
+    if (table_p->vlan_rifs[ifc_p->ifc.vlan.br_id] == NULL) {
+        return NULL;
+    }
+    return &table_p->vlan_rifs[ifc_p->ifc.vlan.br_id][ifc_p->ifc.vlan.vlan];
+}
+
+/*
+ * Claims the map entry of an L2 interface for a rif, allocating the
+ * table of its bridge if needed.
+ */
+static oes_status_e
+oes_rif_map_claim(struct oes_rif_table *table_p,
+                  const struct oes_l3_interface *ifc_p,
+                  unsigned int rif)
+{
+    unsigned short **vlan_rifs_pp;
+    unsigned short  *entry_p;
+
+    if (ifc_p->type == OES_INTERFACE_TYPE_VLAN) {
+        vlan_rifs_pp = &table_p->vlan_rifs[ifc_p->ifc.vlan.br_id];
+        if ((*vlan_rifs_pp == NULL) &&
+            ((*vlan_rifs_pp = calloc(OES_MAX_VLANS, sizeof(**vlan_rifs_pp))) == NULL)) {
+            return OES_STATUS_NO_MEMORY;
+        }
+    }
+    entry_p = oes_rif_map_entry(table_p, ifc_p);
+    if ((*entry_p != 0) && (*entry_p != rif + 1)) {
+        return OES_STATUS_ENTRY_ALREADY_EXISTS;
+    }
+    *entry_p = rif + 1;
+    return OES_STATUS_SUCCESS;
+}
+
+int
+oes_rif_ifc_valid(const struct oes_l3_interface *ifc_p)
+{
+    switch (ifc_p->type) {
+    case OES_INTERFACE_TYPE_ROUTER_PORT:
+        return ifc_p->ifc.port.port < OES_MAX_PORTS;
+
+    case OES_INTERFACE_TYPE_VLAN:
+        /* VLAN IDs 0 and 4095 are reserved */
+        return (ifc_p->ifc.vlan.br_id >= 0) && (ifc_p->ifc.vlan.br_id < OES_RIF_MAX_BRIDGES) &&
+               (ifc_p->ifc.vlan.vlan > 0) && (ifc_p->ifc.vlan.vlan < OES_MAX_VLANS - 1);
+
+    default:
+        return 0;
+    }
+}
+
+struct oes_rif *
+oes_rif_get(struct oes_rif_table *table_p,
+            unsigned int vrid,
+            unsigned int rif)
+{
+    if ((rif >= OES_RIF_MAX_RIFS) || !OES_BITMAP_TEST(table_p->used, rif) ||
+        (table_p->rifs[rif].vrid != vrid)) {
+        return NULL;
+    }
+    return &table_p->rifs[rif];
+}
+
+oes_status_e
+oes_rif_add(struct oes_rif_table *table_p,
+            unsigned int vrid,
+            const struct oes_l3_interface *ifc_p,
+            const struct oes_l3_interface_attributes *attr_p,
+            unsigned int *rif_p)
+{
+    struct oes_rif *rif_rec_p;
+    unsigned int    word, rif;
+    oes_status_e    status;
+
+    for (word = 0; word < OES_BITMAP_WORDS(OES_RIF_MAX_RIFS); word++) {
+        if (~table_p->used[word]) {
+            break;
+        }
+    }
+    if (word == OES_BITMAP_WORDS(OES_RIF_MAX_RIFS)) {
+        return OES_STATUS_NO_RESOURCES;
+    }
+    rif = word * OES_BITMAP_WORD_BITS + __builtin_ctzll(~table_p->used[word]);
+    status = oes_rif_map_claim(table_p, ifc_p, rif);
+    if (status != OES_STATUS_SUCCESS) {
+        return status;
+    }
+
+    rif_rec_p = &table_p->rifs[rif];
+    memset(rif_rec_p, 0, sizeof(*rif_rec_p));
+    rif_rec_p->vrid = vrid;
+    rif_rec_p->ifc = *ifc_p;
+    rif_rec_p->state.enable_ipv4 = 1;
+    rif_rec_p->state.enable_ipv6 = 1;
+    rif_rec_p->mac_head = OES_RIF_MAC_NONE;
+    OES_BITMAP_SET(table_p->used, rif);
+    oes_rif_attr_set(table_p, rif, attr_p);
+    table_p->cnt++;
+    *rif_p = rif;
+    return OES_STATUS_SUCCESS;
+}
+
+void
+oes_rif_attr_set(struct oes_rif_table *table_p,
+                 unsigned int rif,
+                 const struct oes_l3_interface_attributes *attr_p)
+{
+    table_p->rifs[rif].attr = *attr_p;
+    /* IP packets shorter than the limit fit, an MTU of 0 does not limit */
+    table_p->l3_limits[rif] = attr_p->mtu ? attr_p->mtu + 1U : OES_RIF_L3_UNLIMITED;
+}
+
+oes_status_e
+oes_rif_ifc_set(struct oes_rif_table *table_p,
+                unsigned int rif,
+                const struct oes_l3_interface *ifc_p)
+{
+    struct oes_rif *rif_rec_p = &table_p->rifs[rif];
+    unsigned short *old_p;
+    oes_status_e    status;
+
+    status = oes_rif_map_claim(table_p, ifc_p, rif);
+    if (status != OES_STATUS_SUCCESS) {
+        return status;
+    }
+    old_p = oes_rif_map_entry(table_p, &rif_rec_p->ifc);
+    if (old_p != oes_rif_map_entry(table_p, ifc_p)) {
+        *old_p = 0;
+    }
+    rif_rec_p->ifc = *ifc_p;
+    return OES_STATUS_SUCCESS;
+}
+
+void
+oes_rif_delete(struct oes_rif_table *table_p,
+               unsigned int rif)
+{
+    oes_rif_mac_flush(table_p, rif);
+    *oes_rif_map_entry(table_p, &table_p->rifs[rif].ifc) = 0;
+    OES_BITMAP_CLR(table_p->used, rif);
+    table_p->l3_limits[rif] = 0;
+    table_p->cnt--;
+}
+
+oes_status_e
+oes_rif_mac_reserve(struct oes_rif_table *table_p,
+                    unsigned int cnt)
+{
+    struct oes_rif_mac *macs_p;
+    unsigned int       *buckets_p, *bucket_p;
+    unsigned int        size, idx;
+
+    if (cnt > OES_RIF_MAX_MACS - table_p->mac_cnt) {
+        return OES_STATUS_NO_RESOURCES;
+    }
+    if (table_p->mac_cnt + cnt <= table_p->mac_size) {
+        return OES_STATUS_SUCCESS;
+    }
+
+    for (size = table_p->mac_size ? table_p->mac_size * 2 : OES_RIF_MAC_MIN_SIZE;
+         size < table_p->mac_cnt + cnt; size *= 2) {
+    }
+    /* one chain head per entry */
+    buckets_p = malloc(size * sizeof(*buckets_p));
+    if (buckets_p == NULL) {
+        return OES_STATUS_NO_MEMORY;
+    }
+    macs_p = realloc(table_p->macs, size * sizeof(*macs_p));
+    if (macs_p == NULL) {
+        free(buckets_p);
+        return OES_STATUS_NO_MEMORY;
+    }
+    table_p->macs = macs_p;
+    if (table_p->mac_size == 0) {
+        table_p->mac_free = OES_RIF_MAC_NONE;
+    }
+    for (idx = size; idx-- > table_p->mac_size;) {
+        macs_p[idx].in_use = 0;
+        macs_p[idx].hash_next = table_p->mac_free;
+        table_p->mac_free = idx;
+    }
+    table_p->mac_size = size;
+
+    memset(buckets_p, 0xff, size * sizeof(*buckets_p));
+    free(table_p->mac_buckets);
+    table_p->mac_buckets = buckets_p;
+    table_p->mac_bucket_cnt = size;
+    for (idx = 0; idx < size; idx++) {
+        if (macs_p[idx].in_use) {
+            bucket_p = oes_rif_mac_bucket(table_p, macs_p[idx].rif, &macs_p[idx].mac);
+            macs_p[idx].hash_next = *bucket_p;
+            *bucket_p = idx;
+        }
+    }
+    return OES_STATUS_SUCCESS;
+}
+
+unsigned int
+oes_rif_mac_find(const struct oes_rif_table *table_p,
+                 unsigned int rif,
+                 const struct ether_addr *mac_p)
+{
+    const struct oes_rif_mac *entry_p;
+    unsigned int              idx;
+
+    if (table_p->mac_cnt == 0) {
+        return OES_RIF_MAC_NONE;
+    }
+    for (idx = *oes_rif_mac_bucket(table_p, rif, mac_p); idx != OES_RIF_MAC_NONE;
+         idx = entry_p->hash_next) {
+        entry_p = &table_p->macs[idx];
+        if ((entry_p->rif == rif) && !memcmp(&entry_p->mac, mac_p, sizeof(*mac_p))) {
+            return idx;
+        }
+    }
+    return OES_RIF_MAC_NONE;
+}
+
+void
+oes_rif_mac_add(struct oes_rif_table *table_p,
+                unsigned int rif,
+                const struct ether_addr *mac_p)
+{
+    struct oes_rif     *rif_rec_p = &table_p->rifs[rif];
+    struct oes_rif_mac *entry_p;
+    unsigned int       *bucket_p, idx;
+
+    if (oes_rif_mac_find(table_p, rif, mac_p) != OES_RIF_MAC_NONE) {
+        return;
+    }
+    idx = table_p->mac_free;
+    entry_p = &table_p->macs[idx];
+    table_p->mac_free = entry_p->hash_next;
+
+    entry_p->mac = *mac_p;
+    entry_p->in_use = 1;
+    entry_p->rif = rif;
+    bucket_p = oes_rif_mac_bucket(table_p, rif, mac_p);
+    entry_p->hash_next = *bucket_p;
+    *bucket_p = idx;
+    entry_p->rif_prev = OES_RIF_MAC_NONE;
+    entry_p->rif_next = rif_rec_p->mac_head;
+    if (rif_rec_p->mac_head != OES_RIF_MAC_NONE) {
+        table_p->macs[rif_rec_p->mac_head].rif_prev = idx;
+    }
+    rif_rec_p->mac_head = idx;
+    rif_rec_p->mac_cnt++;
+    table_p->mac_cnt++;
+}
+
+void
+oes_rif_mac_delete(struct oes_rif_table *table_p,
+                   unsigned int idx)
+{
+    struct oes_rif_mac *entry_p = &table_p->macs[idx];
+    struct oes_rif     *rif_rec_p = &table_p->rifs[entry_p->rif];
+    unsigned int       *link_p = oes_rif_mac_bucket(table_p, entry_p->rif, &entry_p->mac);
+
+    while (*link_p != idx) {
+        link_p = &table_p->macs[*link_p].hash_next;
+    }
+    *link_p = entry_p->hash_next;
+    if (entry_p->rif_prev != OES_RIF_MAC_NONE) {
+        table_p->macs[entry_p->rif_prev].rif_next = entry_p->rif_next;
+    } else {
+        rif_rec_p->mac_head = entry_p->rif_next;
+    }
+    if (entry_p->rif_next != OES_RIF_MAC_NONE) {
+        table_p->macs[entry_p->rif_next].rif_prev = entry_p->rif_prev;
+    }
+    rif_rec_p->mac_cnt--;
+    table_p->mac_cnt--;
+
+    entry_p->in_use = 0;
+    entry_p->hash_next = table_p->mac_free;
+    table_p->mac_free = idx;
+}
+
+void
+oes_rif_mac_flush(struct oes_rif_table *table_p,
+                  unsigned int rif)
+{
+    while (table_p->rifs[rif].mac_head != OES_RIF_MAC_NONE) {
+        oes_rif_mac_delete(table_p, table_p->rifs[rif].mac_head);
+    }
+}
+
+int
+oes_rif_mac_match(const struct oes_rif_table *table_p,
+                  unsigned int rif,
+                  const struct ether_addr *mac_p)
+{
+    return !memcmp(&table_p->rifs[rif].attr.mac_addr, mac_p, sizeof(*mac_p)) ||
+           (oes_rif_mac_find(table_p, rif, mac_p) != OES_RIF_MAC_NONE);
+}
@@ -0,0 +1,269 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __OES_ROUTER_RIF_H__
+#define __OES_ROUTER_RIF_H__
+
+/************************************************
+ *  Router interface table
+ *
+ *  Router interfaces are numbered across all virtual routers, since
+ *  the ingress path knows the L2 interface of a packet before it knows
+ *  its virtual router. Each rif is a record indexed by its number. Two
+ *  direct-indexed maps give the rif owning an L2 interface: one entry
+ *  per port, and one table of OES_MAX_VLANS entries per bridge,
+ *  allocated with the first VLAN interface of the bridge. Map entries
+ *  hold rif + 1, so zeroed maps are empty.
+ *
+ *  Besides the MAC of its attributes, a rif answers to the MACs added
+ *  by oes_api_router_interface_mac_set. Those live in one array and are
+ *  linked by index into a hash on (rif, MAC) for the router MAC check,
+ *  and into a doubly linked list per rif for get and flush.
+ ***********************************************/
+
+#define OES_RIF_MAX_RIFS              4096
+#define OES_RIF_MAX_BRIDGES           4096
+#define OES_RIF_MAX_MACS              0xffff    /**< fits the unsigned short counts of the API */
+#define OES_RIF_MAC_NONE              0xffffffff
+#define OES_RIF_L3_UNLIMITED          0x10000   /**< l3_limits of an MTU of 0 */
+
+struct oes_rif {
+    unsigned int                        vrid;
+    struct oes_l3_interface             ifc;
+    struct oes_l3_interface_attributes  attr;
+    struct oes_l3_interface_admin_state state;
+    unsigned int                        mac_head;  /**< first added MAC */
+    unsigned int                        mac_cnt;
+};
+
+struct oes_rif_mac {
+    struct ether_addr mac;
+    unsigned char     in_use;
+    unsigned int      rif;
+    unsigned int      hash_next;         /**< hash chain, or free list link */
+    unsigned int      rif_prev;
+    unsigned int      rif_next;
+};
+
+struct oes_rif_table {
+    struct oes_rif       rifs[OES_RIF_MAX_RIFS];
+    unsigned long long   used[OES_BITMAP_WORDS(OES_RIF_MAX_RIFS)];
+    unsigned int         l3_limits[OES_RIF_MAX_RIFS];         /**< MTU + 1, 0 when free */
+    unsigned short       port_rifs[OES_MAX_PORTS];            /**< rif + 1 */
+    unsigned short     * vlan_rifs[OES_RIF_MAX_BRIDGES];      /**< rif + 1 per VLAN */
+    unsigned int         cnt;
+    struct oes_rif_mac * macs;
+    unsigned int         mac_size;
+    unsigned int         mac_free;
+    unsigned int         mac_cnt;
+    unsigned int       * mac_buckets;    /**< hash chain heads */
+    unsigned int         mac_bucket_cnt; /**< power of 2 */
+};
+
+/**
+ * This function checks an L2 interface a rif can sit on.
+ *
+ * @param[in] ifc_p - L2 interface
+ *
+ * @return 1 if the port, or the bridge and VLAN, are in range
+ */
+int
+oes_rif_ifc_valid(const struct oes_l3_interface * ifc_p);
+
+/**
+ * This function returns the rif owning an L2 interface.
+ *
+ * @param[in] table_p - table
+ * @param[in] ifc_p - L2 interface, see oes_rif_ifc_valid
+ *
+ * @return rif, or OES_ROUTER_RIF_INVALID
+ */
+static inline unsigned int
+oes_rif_find(const struct oes_rif_table * table_p,
+             const struct oes_l3_interface * ifc_p)
+{
+    const unsigned short *vlan_rifs_p;
+
+    if (ifc_p->type == OES_INTERFACE_TYPE_ROUTER_PORT) {
+        return table_p->port_rifs[ifc_p->ifc.port.port] - 1U;
+    }
+    vlan_rifs_p = table_p->vlan_rifs[ifc_p->ifc.vlan.br_id];
+    return vlan_rifs_p ? vlan_rifs_p[ifc_p->ifc.vlan.vlan] - 1U : OES_ROUTER_RIF_INVALID;
+}
+
+/**
+ * This function returns a rif of a virtual router.
+ *
+ * @param[in] table_p - table
+ * @param[in] vrid - virtual router
+ * @param[in] rif - router interface
+ *
+ * @return the rif record, or NULL if the virtual router has no such rif
+ */
+struct oes_rif *
+oes_rif_get(struct oes_rif_table * table_p,
+            unsigned int vrid,
+            unsigned int rif);
+
+/**
+ * This function adds a rif, both IP versions enabled.
+ *
+ * @param[in] table_p - table
+ * @param[in] vrid - virtual router
+ * @param[in] ifc_p - L2 interface, see oes_rif_ifc_valid
+ * @param[in] attr_p - interface attributes
+ * @param[out] rif_p - the lowest free rif
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_ENTRY_ALREADY_EXISTS if a rif owns the L2 interface
+ * @return OES_STATUS_NO_RESOURCES if every rif is in use
+ * @return OES_STATUS_NO_MEMORY if out of memory
+ */
+oes_status_e
+oes_rif_add(struct oes_rif_table * table_p,
+            unsigned int vrid,
+            const struct oes_l3_interface * ifc_p,
+            const struct oes_l3_interface_attributes * attr_p,
+            unsigned int * rif_p);
+
+/**
+ * This function sets the attributes of a rif in use.
+ *
+ * @param[in] table_p - table
+ * @param[in] rif - router interface in use
+ * @param[in] attr_p - interface attributes
+ */
+void
+oes_rif_attr_set(struct oes_rif_table * table_p,
+                 unsigned int rif,
+                 const struct oes_l3_interface_attributes * attr_p);
+
+/**
+ * This function moves a rif to another L2 interface.
+ *
+ * @param[in] table_p - table
+ * @param[in] rif - router interface in use
+ * @param[in] ifc_p - L2 interface, see oes_rif_ifc_valid
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_ENTRY_ALREADY_EXISTS if another rif owns the L2 interface
+ * @return OES_STATUS_NO_MEMORY if out of memory
+ */
+oes_status_e
+oes_rif_ifc_set(struct oes_rif_table * table_p,
+                unsigned int rif,
+                const struct oes_l3_interface * ifc_p);
+
+/**
+ * This function deletes a rif and its MACs.
+ *
+ * @param[in] table_p - table
+ * @param[in] rif - router interface in use
+ */
+void
+oes_rif_delete(struct oes_rif_table * table_p,
+               unsigned int rif);
+
+/**
+ * This function makes room for more MACs, so that adding up to cnt
+ * MACs does not fail.
+ *
+ * @param[in] table_p - table
+ * @param[in] cnt - MACs to add
+ *
+ * @return OES_STATUS_SUCCESS if operation completes successfully
+ * @return OES_STATUS_NO_RESOURCES if the table would exceed OES_RIF_MAX_MACS
+ * @return OES_STATUS_NO_MEMORY if out of memory
+ */
+oes_status_e
+oes_rif_mac_reserve(struct oes_rif_table * table_p,
+                    unsigned int cnt);
+
+/**
+ * This function finds a MAC added to a rif.
+ *
+ * @param[in] table_p - table
+ * @param[in] rif - router interface
+ * @param[in] mac_p - MAC address
+ *
+ * @return MAC entry index, or OES_RIF_MAC_NONE
+ */
+unsigned int
+oes_rif_mac_find(const struct oes_rif_table * table_p,
+                 unsigned int rif,
+                 const struct ether_addr * mac_p);
+
+/**
+ * This function adds a MAC to a rif, unless it is there already.
+ * Room must have been reserved (oes_rif_mac_reserve).
+ *
+ * @param[in] table_p - table
+ * @param[in] rif - router interface in use
+ * @param[in] mac_p - MAC address
+ */
+void
+oes_rif_mac_add(struct oes_rif_table * table_p,
+                unsigned int rif,
+                const struct ether_addr * mac_p);
+
+/**
+ * This function deletes a MAC entry.
+ *
+ * @param[in] table_p - table
+ * @param[in] idx - MAC entry index
+ */
+void
+oes_rif_mac_delete(struct oes_rif_table * table_p,
+                   unsigned int idx);
+
+/**
+ * This function deletes every MAC added to a rif.
+ *
+ * @param[in] table_p - table
+ * @param[in] rif - router interface in use
+ */
+void
+oes_rif_mac_flush(struct oes_rif_table * table_p,
+                  unsigned int rif);
+
+/**
+ * This function checks whether a rif answers to a MAC: the MAC of
+ * its attributes or one added to it.
+ *
+ * @param[in] table_p - table
+ * @param[in] rif - router interface in use
+ * @param[in] mac_p - MAC address
+ *
+ * @return 1 if the MAC is a router MAC of the rif
+ */
+int
+oes_rif_mac_match(const struct oes_rif_table * table_p,
+                  unsigned int rif,
+                  const struct ether_addr * mac_p);
+
+#endif /* __OES_ROUTER_RIF_H__ */
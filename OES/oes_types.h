@@ -29,6 +29,25 @@
 #ifndef OES_TYPES__
 #define OES_TYPES__
 
+/************************************************************************************************************/
+/**************************** define ************************************************************************/
+
+#define OES_MAX_PORTS       256   /**< logical ports are numbered 0 .. OES_MAX_PORTS - 1 */
+#define OES_MAX_VLANS       4096  /**< VLAN IDs are numbered 0 .. OES_MAX_VLANS - 1 */
+#define OES_STP_MAX_MSTI    64    /**< MSTIs are numbered 1 .. OES_STP_MAX_MSTI, 0 is the CIST */
+#define OES_LAG_MAX_GROUPS  64    /**< LAG ports are the last OES_LAG_MAX_GROUPS logical ports */
+#define OES_LAG_PORT_BASE   (OES_MAX_PORTS - OES_LAG_MAX_GROUPS)
+
+#define OES_BITMAP_WORD_BITS        64
+#define OES_BITMAP_WORDS(bits)      (((bits) + OES_BITMAP_WORD_BITS - 1) / OES_BITMAP_WORD_BITS)
+#define OES_BITMAP_SET(bm, bit)     ((bm)[(bit) / OES_BITMAP_WORD_BITS] |= 1ULL << ((bit) % OES_BITMAP_WORD_BITS))
+#define OES_BITMAP_CLR(bm, bit)     ((bm)[(bit) / OES_BITMAP_WORD_BITS] &= ~(1ULL << ((bit) % OES_BITMAP_WORD_BITS)))
+#define OES_BITMAP_TEST(bm, bit)    (((bm)[(bit) / OES_BITMAP_WORD_BITS] >> ((bit) % OES_BITMAP_WORD_BITS)) & 1ULL)
+
+#define OES_ROUTER_RIF_INVALID      0xffffffff  /**< no router interface */
+#define OES_ROUTER_NHG_NONE         0           /**< route without next hops */
+#define OES_ROUTER_MC_MAX_RIFS      1024        /**< multicast egress rifs are numbered 0 .. OES_ROUTER_MC_MAX_RIFS - 1 */
+
 /************************************************************************************************************/
 /**************************** enum ************************************************************************/
 
@@ -46,6 +65,9 @@ enum oes_access_cmd {
     OES_ACCESS_CMD_GET          = 14,
     OES_ACCESS_CMD_GET_FIRST    = 15,
     OES_ACCESS_CMD_GET_NEXT     = 16,
+    OES_ACCESS_CMD_GET_ACTIVITY = 17,
+    OES_ACCESS_CMD_READ         = 18,
+    OES_ACCESS_CMD_READ_CLEAR   = 19,
 };
 
 enum oes_span_type {
@@ -137,6 +159,15 @@ enum oes_router_action {
     OES_ROUTER_ACTION_FORWARD,
 };
 
+/* counted traffic of oes_api_router_interface_cntr_count, the value is the
+ * packets field index in struct oes_router_cntr, the bytes field is 2 later */
+enum oes_router_cntr_type {
+    OES_ROUTER_CNTR_INGRESS_UNICAST   = 0,
+    OES_ROUTER_CNTR_INGRESS_MULTICAST = 1,
+    OES_ROUTER_CNTR_EGRESS_UNICAST    = 4,
+    OES_ROUTER_CNTR_EGRESS_MULTICAST  = 5,
+};
+
 enum oes_interface_type {
     OES_INTERFACE_TYPE_VLAN,
     OES_INTERFACE_TYPE_ROUTER_PORT,
@@ -154,6 +185,12 @@ enum oes_event {
     OES_EVENT_ID_PORT,/**< port up/down*/
 };
 
+enum oes_event_notify_mode {
+    OES_EVENT_NOTIFY_EVERY_EVENT, /**< signal the fd on every queued event (default) */
+    OES_EVENT_NOTIFY_EDGE,        /**< signal the fd only when the queue turns non empty */
+    OES_EVENT_NOTIFY_HYBRID,      /**< as EDGE, and oes_api_event_recv busy polls before sleeping */
+};
+
 enum oes_l2_packet {
     OES_PACKET_STP,                     /**< ETHERNET L2 STP */
     OES_PACKET_LACP,                    /**< ETHERNET L2 LACP */
@@ -210,6 +247,73 @@ enum oes_fdb_event_type {
     OES_FDB_EVENT_FLUSH_PORT,
     OES_FDB_EVENT_FLUSH_PORT_VID
 };
+
+enum oes_vlan_tagging {
+    OES_VLAN_TAGGED_MEMBER,             /**< egress with the VLAN tag */
+    OES_VLAN_UNTAGGED_MEMBER,           /**< egress without a tag */
+    OES_VLAN_PRIO_TAGGED_MEMBER,        /**< egress with a priority tag, VID 0 */
+};
+
+enum oes_ingr_filter_mode {
+    OES_INGR_FILTER_DISABLE,
+    OES_INGR_FILTER_ENABLE,             /**< drop frames of VLANs the port is not a member of */
+};
+
+enum oes_vlan_frame_types {             /**< bit mask of accepted frames */
+    OES_VLAN_FRAME_TYPES_ALLOW_TAGGED       = 0x1,
+    OES_VLAN_FRAME_TYPES_ALLOW_UNTAGGED     = 0x2,
+    OES_VLAN_FRAME_TYPES_ALLOW_PRIO_TAGGED  = 0x4,
+    OES_VLAN_FRAME_TYPES_ALLOW_ALL          = 0x7,
+};
+
+enum oes_vlan_flood_type {
+    OES_VLAN_FLOOD_TYPE_UNKNOWN_UC,
+    OES_VLAN_FLOOD_TYPE_UNREG_MC,
+    OES_VLAN_FLOOD_TYPE_BC,
+};
+
+enum oes_vlan_flood_cmd {
+    OES_VLAN_FLOOD_CMD_FLOOD,
+    OES_VLAN_FLOOD_CMD_PRUNE,
+};
+
+enum oes_qinq_mode {
+    OES_QINQ_MODE_DISABLED,
+    OES_QINQ_MODE_ENABLED,
+};
+
+enum oes_qinq_outer_prio_mode {
+    OES_QINQ_OUTER_PRIO_MODE_DEFAULT,   /**< outer tag takes the port default priority */
+    OES_QINQ_OUTER_PRIO_MODE_INNER,     /**< outer tag takes the inner tag priority */
+};
+
+enum oes_vlan_drop_reason {
+    OES_VLAN_DROP_NONE,
+    OES_VLAN_DROP_MALFORMED,            /**< shorter than its Ethernet header */
+    OES_VLAN_DROP_FRAME_TYPE,           /**< frame type not accepted on the ingress port */
+    OES_VLAN_DROP_INGRESS_FILTER,       /**< ingress port not a member of the VLAN */
+    OES_VLAN_DROP_EGRESS_FILTER,        /**< egress port not a member of the VLAN */
+    OES_VLAN_DROP_NO_HEADROOM,          /**< no room to push the egress tag */
+};
+
+/* counted traffic of oes_api_vlan_cntr_count, the value is the packets
+ * field index in struct oes_vlan_cntr, the bytes field follows it */
+enum oes_vlan_cntr_type {
+    OES_VLAN_CNTR_RX    = 0,            /**< classified to the VLAN on ingress */
+    OES_VLAN_CNTR_TX    = 2,            /**< sent on egress */
+    OES_VLAN_CNTR_FLOOD = 4,            /**< flooded to the VLAN flood set */
+};
+
+enum oes_stp_mode {
+    OES_STP_MODE_MSTP,
+    OES_STP_MODE_RSTP,
+};
+
+enum oes_mstp_inst_port_state {
+    OES_MSTP_INST_PORT_STATE_DISCARDING,
+    OES_MSTP_INST_PORT_STATE_LEARNING,
+    OES_MSTP_INST_PORT_STATE_FORWARDING,
+};
 /************************************************************************************************************/
 /**************************** struct ************************************************************************/
 
@@ -261,6 +365,26 @@ struct oes_fdb_uc_mac_addr_params {
     enum oes_fdb_mac_entry_type entry_type;  /**< FDB Entry Type (dynamic/static)*/
 };
 
+struct oes_vlan_port { /**< member port of a VLAN, see oes_api_vlan_ports_set */
+    unsigned long log_port;               /**< logical port */
+    enum oes_vlan_tagging tagging;        /**< egress tagging */
+};
+
+struct oes_port_vlans { /**< VLAN of a port, see oes_api_vlan_port_multi_vlan_set */
+    unsigned short vid;                   /**< VLAN ID */
+    enum oes_vlan_tagging tagging;        /**< egress tagging */
+};
+
+struct oes_vlan_pkt { /**< frame of the VLAN stage, see oes_api_vlan_ingress_batch */
+    unsigned char  *data;                 /**< in/out: frame start, moved by a tag pop or push */
+    unsigned short  len;                  /**< in/out: frame length */
+    unsigned short  headroom;             /**< in/out: bytes free before data */
+    unsigned short  log_port;             /**< in: ingress port, or egress port on egress */
+    unsigned short  vid;                  /**< out: classified VLAN on ingress, in on egress */
+    unsigned char   pcp;                  /**< out: classified priority on ingress, in on egress */
+    unsigned char   drop;                 /**< out: enum oes_vlan_drop_reason */
+};
+
 struct oes_port_speed_capability {
     unsigned char enable_1GB_CX_SGMII;
     unsigned char enable_1GB_KX;
@@ -333,6 +457,13 @@ struct oes_l3_interface_admin_state {
     unsigned char  enable_ipv6;
 };
 
+struct oes_l3_interface_lookup_data { /**< ingress router interface, see oes_api_router_interface_lookup */
+    unsigned int  vrid;                   /**< virtual router of the rif */
+    unsigned int  rif;
+    unsigned char router_mac;             /**< destination MAC is a router MAC of the rif */
+    struct oes_l3_interface_admin_state admin_state;
+};
+
 
 struct oes_ip_addr {
     enum oes_ip_version version;
@@ -361,6 +492,48 @@ struct oes_uc_route_data {
     unsigned char activity;
 };
 
+struct oes_uc_route_ecmp_params { /**< route ECMP options, see oes_api_router_uc_route_set */
+    unsigned short resilient_bucket_cnt;  /**< 0 for plain hashing, else resilient hashing over this many buckets */
+};
+
+struct oes_uc_route_op { /**< one staged operation, see oes_api_router_uc_route_batch_set */
+    enum oes_access_cmd  access_cmd;      /**< ADD/EDIT/DELETE */
+    struct oes_ip_prefix  key;
+    struct oes_uc_route_data  data;       /**< ignored by DELETE */
+    const struct oes_uc_route_ecmp_params * ecmp_params_p; /**< NULL for plain hashing */
+};
+
+struct oes_uc_route_lookup_data { /**< software forwarding decision, see oes_api_router_uc_route_lookup */
+    enum oes_router_action  action;       /**< route action, or the neighbour action when forwarding */
+    struct oes_ip_addr  next_hop;         /**< ECMP member picked for the flow */
+    unsigned int  rif;                    /**< neighbour rif, OES_ROUTER_RIF_INVALID if unresolved */
+    struct ether_addr  mac_addr;          /**< neighbour MAC */
+};
+
+struct oes_uc_route_batch_lookup_data { /**< FIB decision, see oes_api_router_uc_route_lookup_batch */
+    unsigned int  nhg_id;                 /**< next hop group of the route, OES_ROUTER_NHG_NONE without next hops */
+    enum oes_router_action  action;       /**< effective route action */
+    unsigned char found;                  /**< 0 if no route matches, the other fields are then 0 */
+};
+
+struct oes_router_l3_pkt { /**< packet of the L3 checks, see oes_api_router_l3_check_batch */
+    enum oes_router_action  action;       /**< in: forwarding decision, out: after the TTL and MTU checks */
+    enum oes_l3_packet      trap_id;      /**< out: OES_PACKET_L3_TTLERROR or OES_PACKET_L3_MTUERROR */
+    unsigned int   egress_rif;
+    unsigned short l3_len;                /**< IP packet length */
+    unsigned char  ttl;                   /**< IPv4 TTL or IPv6 hop limit, decremented when forwarded */
+    unsigned char  l3_error;              /**< out: a check set the action, trap_id is valid */
+};
+
+struct oes_vlan_cntr {
+    unsigned long long  rx_packets;
+    unsigned long long  rx_bytes;
+    unsigned long long  tx_packets;
+    unsigned long long  tx_bytes;
+    unsigned long long  flood_packets;
+    unsigned long long  flood_bytes;
+};
+
 struct oes_router_cntr {
     unsigned long long  router_ingress_unicast_packets;
     unsigned long long  router_ingress_multicast_packets;
@@ -393,6 +566,13 @@ struct oes_mc_route_data {
     unsigned short rif_cnt;
 };
 
+struct oes_mc_route_lookup_data { /**< software forwarding decision, see oes_api_router_mc_route_lookup */
+    struct oes_mc_router_action  action;
+    unsigned char  star_g;                /**< matched the (*,G) route of the group */
+    unsigned short rif_cnt;               /**< egress rifs */
+    unsigned long long  egress_rifs[OES_BITMAP_WORDS(OES_ROUTER_MC_MAX_RIFS)];
+};
+
 struct oes_event_port {
     unsigned int       log_port;/**<! logical port */
     enum oes_port_oper_state port_state;/**<! operational state */
@@ -436,4 +616,18 @@ struct oes_event_info {
     union oes_event_data        event_info; /**<! event info */
 };
 
+struct oes_event_fd_params { /**< event channel options, see oes_api_event_fd_set */
+    enum oes_event_notify_mode notify_mode;  /**< fd wakeup policy */
+    unsigned int busy_poll_usec;             /**< HYBRID only: time to poll the queue before sleeping */
+};
+
+struct oes_event_filter { /**< per registration filter, see oes_api_event_register_set */
+    unsigned char enable_port;            /**< drop events whose port is not in port_bitmap */
+    unsigned char enable_vid;             /**< drop events whose vid is not in vid_bitmap */
+    unsigned char enable_fdb_event_type;  /**< drop FDB events whose type is not in fdb_event_type_mask */
+    unsigned long long port_bitmap[OES_BITMAP_WORDS(OES_MAX_PORTS)];  /**< bit per logical port */
+    unsigned long long vid_bitmap[OES_BITMAP_WORDS(OES_MAX_VLANS)];   /**< bit per VLAN ID */
+    unsigned int fdb_event_type_mask;     /**< bit (1 << oes_fdb_event_type) per accepted type */
+};
+
 #endif
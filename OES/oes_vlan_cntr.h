@@ -0,0 +1,171 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __OES_VLAN_CNTR_H__
+#define __OES_VLAN_CNTR_H__
+
+/************************************************
+ *  VLAN counters
+ *
+ *  Built like the router interface counters: every thread that counts
+ *  owns a slab and is its only writer, so an increment is a plain load
+ *  and store to a cache line of its own. A slab holds one 64 byte block
+ *  per (bridge, vid), laid out like struct oes_vlan_cntr and allocated
+ *  64 VLANs at a time on first use. Readers sum the blocks of all slabs,
+ *  one VLAN or a whole bridge in a pass over each slab.
+ *
+ *  Read-and-clear keeps the sums it cleared at as a base per bridge,
+ *  under a lock of its own rather than the VLAN configuration lock.
+ *  Slabs outlive their threads and go to the next thread to register.
+ ***********************************************/
+
+#define OES_VLAN_CNTR_MAX_BRIDGES     4096
+#define OES_VLAN_CNTR_CHUNK           64          /**< blocks per allocation */
+#define OES_VLAN_CNTR_CHUNKS          (OES_MAX_VLANS / OES_VLAN_CNTR_CHUNK)
+#define OES_VLAN_CNTR_FIELDS          6           /**< fields of struct oes_vlan_cntr */
+
+struct oes_vlan_cntr_block {
+    unsigned long long v[OES_VLAN_CNTR_FIELDS];   /**< indexed by enum oes_vlan_cntr_type */
+} __attribute__((aligned(64)));
+
+struct oes_vlan_cntr_slab {
+    struct oes_vlan_cntr_block ** chunks[OES_VLAN_CNTR_MAX_BRIDGES]; /**< chunk table per bridge, NULL until used */
+    struct oes_vlan_cntr_slab   * next;           /**< all slabs */
+    int                           in_use;         /**< owned by a live thread */
+};
+
+extern __thread struct oes_vlan_cntr_slab * oes_vlan_cntr_slab_self;
+
+/**
+ * This function returns the block of the calling thread for a VLAN,
+ * registering the thread and allocating on first use.
+ *
+ * @param[in] br_id - bridge, below OES_VLAN_CNTR_MAX_BRIDGES
+ * @param[in] vid - VLAN, below OES_MAX_VLANS
+ *
+ * @return block, or NULL if out of memory
+ */
+struct oes_vlan_cntr_block *
+oes_vlan_cntr_block_get(unsigned int br_id,
+                        unsigned int vid);
+
+/**
+ * This function adds to a block of the calling thread.
+ *
+ * @param[in] block_p - block, from the slab of the calling thread
+ * @param[in] type - rx, tx or flood
+ * @param[in] packets - packets
+ * @param[in] bytes - bytes
+ */
+static inline void
+oes_vlan_cntr_block_add(struct oes_vlan_cntr_block * block_p,
+                        enum oes_vlan_cntr_type type,
+                        unsigned int packets,
+                        unsigned long long bytes)
+{
+    unsigned long long *v = block_p->v;
+
+    /* only this thread writes the block, readers may load it at any time */
+    __atomic_store_n(&v[type], __atomic_load_n(&v[type], __ATOMIC_RELAXED) + packets, __ATOMIC_RELAXED);
+    __atomic_store_n(&v[type + 1], __atomic_load_n(&v[type + 1], __ATOMIC_RELAXED) + bytes,
+                     __ATOMIC_RELAXED);
+}
+
+/**
+ * This function returns the chunk table of the calling thread for a
+ * bridge, for a burst to look up once.
+ *
+ * @param[in] br_id - bridge, below OES_VLAN_CNTR_MAX_BRIDGES
+ *
+ * @return chunk table, or NULL until the thread counts on the bridge
+ */
+static inline struct oes_vlan_cntr_block **
+oes_vlan_cntr_chunks(unsigned int br_id)
+{
+    struct oes_vlan_cntr_slab *slab_p = oes_vlan_cntr_slab_self;
+
+    return (slab_p != NULL) ? slab_p->chunks[br_id] : NULL;
+}
+
+/**
+ * This function counts traffic in the slab of the calling thread.
+ *
+ * @param[in,out] chunks_pp - chunk table from oes_vlan_cntr_chunks, set
+ *       again when a first count allocates it
+ * @param[in] br_id - bridge, below OES_VLAN_CNTR_MAX_BRIDGES
+ * @param[in] vid - VLAN, below OES_MAX_VLANS
+ * @param[in] type - rx, tx or flood
+ * @param[in] packets - packets
+ * @param[in] bytes - bytes
+ */
+static inline void
+oes_vlan_cntr_add(struct oes_vlan_cntr_block *** chunks_pp,
+                  unsigned int br_id,
+                  unsigned int vid,
+                  enum oes_vlan_cntr_type type,
+                  unsigned int packets,
+                  unsigned long long bytes)
+{
+    struct oes_vlan_cntr_block *block_p;
+
+    if ((*chunks_pp != NULL) && ((*chunks_pp)[vid / OES_VLAN_CNTR_CHUNK] != NULL)) {
+        block_p = &(*chunks_pp)[vid / OES_VLAN_CNTR_CHUNK][vid % OES_VLAN_CNTR_CHUNK];
+    } else {
+        block_p = oes_vlan_cntr_block_get(br_id, vid);
+        if (block_p == NULL) {
+            return;
+        }
+        *chunks_pp = oes_vlan_cntr_chunks(br_id);
+    }
+    oes_vlan_cntr_block_add(block_p, type, packets, bytes);
+}
+
+/**
+ * This function sums the counters of a VLAN over all slabs.
+ *
+ * @param[in] br_id - bridge, below OES_VLAN_CNTR_MAX_BRIDGES
+ * @param[in] vid - VLAN, below OES_MAX_VLANS
+ * @param[out] v - OES_VLAN_CNTR_FIELDS sums
+ */
+void
+oes_vlan_cntr_sum(unsigned int br_id,
+                  unsigned int vid,
+                  unsigned long long * v);
+
+/**
+ * This function sums the counters of all VLANs of a bridge over all
+ * slabs, walking each slab once.
+ *
+ * @param[in] br_id - bridge, below OES_VLAN_CNTR_MAX_BRIDGES
+ * @param[out] v - OES_MAX_VLANS * OES_VLAN_CNTR_FIELDS sums, by VID
+ */
+void
+oes_vlan_cntr_sum_all(unsigned int br_id,
+                      unsigned long long * v);
+
+#endif /* __OES_VLAN_CNTR_H__ */
@@ -0,0 +1,88 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <string.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_vlan_member.h"
+#include "oes_vlan_flood.h"
+
+static void
+oes_vlan_flood_compute_vid(struct oes_vlan_flood              *flood_p,
+                           const struct oes_vlan_members      *members_p,
+                           const struct oes_vlan_flood_inputs *inputs_p,
+                           unsigned int                        vid)
+{
+    const unsigned long long *forwarding = inputs_p->forwarding[inputs_p->vid_msti[vid]];
+    unsigned long long        set[OES_VLAN_PORT_WORDS], lags[OES_VLAN_PORT_WORDS], bits, restrict_mask;
+    unsigned int              w, t, lag;
+    int                       restricted = OES_BITMAP_TEST(flood_p->restricted, vid);
+
+    for (w = 0; w < OES_VLAN_PORT_WORDS; w++) {
+        restrict_mask = restricted ? flood_p->flood_ports[vid][w] : ~0ULL;
+        set[w] = members_p->vlan_ports[vid][w] & restrict_mask & forwarding[w];
+        lags[w] = set[w] & inputs_p->lag_ports[w];
+        set[w] &= ~(inputs_p->lag_range[w] | inputs_p->lag_members[w]);
+    }
+    /* a LAG floods through one member, which may sit in any word */
+    for (w = 0; w < OES_VLAN_PORT_WORDS; w++) {
+        for (bits = lags[w]; bits; bits &= bits - 1) {
+            lag = w * OES_BITMAP_WORD_BITS + __builtin_ctzll(bits) - OES_LAG_PORT_BASE;
+            if (inputs_p->designated[lag] < OES_MAX_PORTS) {
+                OES_BITMAP_SET(set, inputs_p->designated[lag]);
+            }
+        }
+    }
+    for (t = 0; t < OES_VLAN_FLOOD_TYPES; t++) {
+        if (flood_p->pruned[vid] & (1 << t)) {
+            memset(flood_p->sets[vid][t], 0, sizeof(flood_p->sets[vid][t]));
+        } else {
+            memcpy(flood_p->sets[vid][t], set, sizeof(set));
+        }
+    }
+}
+
+void
+oes_vlan_flood_compute(struct oes_vlan_flood *flood_p,
+                       const struct oes_vlan_members *members_p,
+                       const struct oes_vlan_flood_inputs *inputs_p,
+                       const unsigned long long *vids)
+{
+    unsigned long long bits;
+    unsigned int       w;
+
+    for (w = 0; w < OES_VLAN_VID_WORDS; w++) {
+        for (bits = vids[w]; bits; bits &= bits - 1) {
+            oes_vlan_flood_compute_vid(flood_p, members_p, inputs_p,
+                                       w * OES_BITMAP_WORD_BITS + __builtin_ctzll(bits));
+        }
+    }
+}
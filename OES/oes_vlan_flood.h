@@ -0,0 +1,94 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __OES_VLAN_FLOOD_H__
+#define __OES_VLAN_FLOOD_H__
+
+/************************************************
+ *  VLAN flood sets
+ *
+ *  The ports a flood of each (VLAN, flood type) leaves through are kept
+ *  as a port bitmap, so the flood lookup is one row. A set is the VLAN
+ *  members, less the ports outside the VLAN flood ports when those are
+ *  set, less the ports not forwarding in the VLAN's spanning tree
+ *  instance, with each LAG replaced by its flood member and LAG member
+ *  ports themselves dropped. A pruned flood type has an empty set.
+ *  Sets are recomputed for the VLANs a change touches only.
+ ***********************************************/
+
+#define OES_VLAN_FLOOD_TYPES          (OES_VLAN_FLOOD_TYPE_BC + 1)
+
+struct oes_vlan_flood {
+    unsigned long long restricted[OES_VLAN_VID_WORDS];                  /**< VLANs with flood ports set */
+    unsigned long long flood_ports[OES_MAX_VLANS][OES_VLAN_PORT_WORDS];  /**< flood ports per VLAN */
+    unsigned char      pruned[OES_MAX_VLANS];                            /**< bit per pruned flood type */
+    unsigned long long sets[OES_MAX_VLANS][OES_VLAN_FLOOD_TYPES][OES_VLAN_PORT_WORDS];
+};
+
+/* the spanning tree and LAG state a recomputation reads */
+struct oes_vlan_flood_inputs {
+    unsigned char      vid_msti[OES_MAX_VLANS];
+    unsigned long long forwarding[OES_STP_MAX_MSTI + 1][OES_VLAN_PORT_WORDS];
+    unsigned long long lag_range[OES_VLAN_PORT_WORDS];    /**< every LAG port, in use or not */
+    unsigned long long lag_ports[OES_VLAN_PORT_WORDS];    /**< LAG ports in use */
+    unsigned long long lag_members[OES_VLAN_PORT_WORDS];
+    unsigned short     designated[OES_LAG_MAX_GROUPS];    /**< flood member per LAG, or OES_MAX_PORTS */
+};
+
+/**
+ * This function returns the flood set of a VLAN and flood type.
+ *
+ * @param[in] flood_p - flood sets
+ * @param[in] vid - VLAN ID
+ * @param[in] flood_type - flood type
+ *
+ * @return port bitmap of OES_VLAN_PORT_WORDS words
+ */
+static inline const unsigned long long *
+oes_vlan_flood_set(const struct oes_vlan_flood * flood_p,
+                   unsigned int vid,
+                   enum oes_vlan_flood_type flood_type)
+{
+    return flood_p->sets[vid][flood_type];
+}
+
+/**
+ * This function recomputes the flood sets of VLANs.
+ *
+ * @param[in] flood_p - flood sets
+ * @param[in] members_p - VLAN membership
+ * @param[in] inputs_p - spanning tree and LAG state
+ * @param[in] vids - bitmap of the VLANs to recompute
+ */
+void
+oes_vlan_flood_compute(struct oes_vlan_flood * flood_p,
+                       const struct oes_vlan_members * members_p,
+                       const struct oes_vlan_flood_inputs * inputs_p,
+                       const unsigned long long * vids);
+
+#endif /* __OES_VLAN_FLOOD_H__ */
@@ -0,0 +1,193 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <string.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_vlan_member.h"
+
+void
+oes_vlan_member_set(struct oes_vlan_members *members_p,
+                    unsigned int vid,
+                    unsigned int port,
+                    enum oes_vlan_tagging tagging)
+{
+    OES_BITMAP_SET(members_p->vlan_ports[vid], port);
+    OES_BITMAP_SET(members_p->port_vlans[port], vid);
+    OES_BITMAP_CLR(members_p->untagged[vid], port);
+    OES_BITMAP_CLR(members_p->prio_tagged[vid], port);
+    if (tagging == OES_VLAN_UNTAGGED_MEMBER) {
+        OES_BITMAP_SET(members_p->untagged[vid], port);
+    } else if (tagging == OES_VLAN_PRIO_TAGGED_MEMBER) {
+        OES_BITMAP_SET(members_p->prio_tagged[vid], port);
+    }
+}
+
+void
+oes_vlan_member_clear(struct oes_vlan_members *members_p,
+                      unsigned int vid,
+                      unsigned int port)
+{
+    OES_BITMAP_CLR(members_p->vlan_ports[vid], port);
+    OES_BITMAP_CLR(members_p->port_vlans[port], vid);
+    OES_BITMAP_CLR(members_p->untagged[vid], port);
+    OES_BITMAP_CLR(members_p->prio_tagged[vid], port);
+}
+
+void
+oes_vlan_members_clear_vid(struct oes_vlan_members *members_p,
+                           unsigned int vid)
+{
+    unsigned long long bits;
+    unsigned int       w;
+
+    for (w = 0; w < OES_VLAN_PORT_WORDS; w++) {
+        for (bits = members_p->vlan_ports[vid][w]; bits; bits &= bits - 1) {
+            OES_BITMAP_CLR(members_p->port_vlans[w * OES_BITMAP_WORD_BITS + __builtin_ctzll(bits)], vid);
+        }
+    }
+    memset(members_p->vlan_ports[vid], 0, sizeof(members_p->vlan_ports[vid]));
+    memset(members_p->untagged[vid], 0, sizeof(members_p->untagged[vid]));
+    memset(members_p->prio_tagged[vid], 0, sizeof(members_p->prio_tagged[vid]));
+}
+
+unsigned int
+oes_vlan_members_count(const struct oes_vlan_members *members_p,
+                       unsigned int vid)
+{
+    unsigned int w, cnt = 0;
+
+    for (w = 0; w < OES_VLAN_PORT_WORDS; w++) {
+        cnt += __builtin_popcountll(members_p->vlan_ports[vid][w]);
+    }
+    return cnt;
+}
+
+void
+oes_vlan_members_range_set(struct oes_vlan_members *members_p,
+                           unsigned int vid_first,
+                           unsigned int vid_last,
+                           const unsigned long long *ports,
+                           enum oes_vlan_tagging tagging)
+{
+    unsigned long long untagged = 0, prio_tagged = 0, bits;
+    unsigned int       vid, w;
+
+    if (tagging == OES_VLAN_UNTAGGED_MEMBER) {
+        untagged = ~0ULL;
+    } else if (tagging == OES_VLAN_PRIO_TAGGED_MEMBER) {
+        prio_tagged = ~0ULL;
+    }
+    for (w = 0; w < OES_VLAN_PORT_WORDS; w++) {
+        if (!ports[w]) {
+            continue;
+        }
+        for (vid = vid_first; vid <= vid_last; vid++) {
+            members_p->vlan_ports[vid][w] |= ports[w];
+            members_p->untagged[vid][w] = (members_p->untagged[vid][w] & ~ports[w]) | (ports[w] & untagged);
+            members_p->prio_tagged[vid][w] = (members_p->prio_tagged[vid][w] & ~ports[w]) |
+                                             (ports[w] & prio_tagged);
+        }
+        for (bits = ports[w]; bits; bits &= bits - 1) {
+            oes_vlan_bitmap_range_set(members_p->port_vlans[w * OES_BITMAP_WORD_BITS + __builtin_ctzll(bits)],
+                                      vid_first, vid_last);
+        }
+    }
+}
+
+void
+oes_vlan_members_range_clear(struct oes_vlan_members *members_p,
+                             unsigned int vid_first,
+                             unsigned int vid_last,
+                             const unsigned long long *ports)
+{
+    unsigned long long bits;
+    unsigned int       vid, w;
+
+    for (w = 0; w < OES_VLAN_PORT_WORDS; w++) {
+        if (!ports[w]) {
+            continue;
+        }
+        for (vid = vid_first; vid <= vid_last; vid++) {
+            members_p->vlan_ports[vid][w] &= ~ports[w];
+            members_p->untagged[vid][w] &= ~ports[w];
+            members_p->prio_tagged[vid][w] &= ~ports[w];
+        }
+        for (bits = ports[w]; bits; bits &= bits - 1) {
+            oes_vlan_bitmap_range_clear(members_p->port_vlans[w * OES_BITMAP_WORD_BITS + __builtin_ctzll(bits)],
+                                        vid_first, vid_last);
+        }
+    }
+}
+
+void
+oes_vlan_bitmap_range_set(unsigned long long *bitmap,
+                          unsigned int first,
+                          unsigned int last)
+{
+    unsigned int       first_w = first / OES_BITMAP_WORD_BITS;
+    unsigned int       last_w = last / OES_BITMAP_WORD_BITS;
+    unsigned long long first_mask = ~0ULL << (first % OES_BITMAP_WORD_BITS);
+    unsigned long long last_mask = ~0ULL >> (OES_BITMAP_WORD_BITS - 1 - last % OES_BITMAP_WORD_BITS);
+    unsigned int       w;
+
+    if (first_w == last_w) {
+        bitmap[first_w] |= first_mask & last_mask;
+        return;
+    }
+    bitmap[first_w] |= first_mask;
+    for (w = first_w + 1; w < last_w; w++) {
+        bitmap[w] = ~0ULL;
+    }
+    bitmap[last_w] |= last_mask;
+}
+
+void
+oes_vlan_bitmap_range_clear(unsigned long long *bitmap,
+                            unsigned int first,
+                            unsigned int last)
+{
+    unsigned int       first_w = first / OES_BITMAP_WORD_BITS;
+    unsigned int       last_w = last / OES_BITMAP_WORD_BITS;
+    unsigned long long first_mask = ~0ULL << (first % OES_BITMAP_WORD_BITS);
+    unsigned long long last_mask = ~0ULL >> (OES_BITMAP_WORD_BITS - 1 - last % OES_BITMAP_WORD_BITS);
+    unsigned int       w;
+
+    if (first_w == last_w) {
+        bitmap[first_w] &= ~(first_mask & last_mask);
+        return;
+    }
+    bitmap[first_w] &= ~first_mask;
+    for (w = first_w + 1; w < last_w; w++) {
+        bitmap[w] = 0;
+    }
+    bitmap[last_w] &= ~last_mask;
+}
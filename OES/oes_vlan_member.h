@@ -0,0 +1,221 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __OES_VLAN_MEMBER_H__
+#define __OES_VLAN_MEMBER_H__
+
+/************************************************
+ *  VLAN membership
+ *
+ *  The members of the VLANs of a bridge form a matrix of OES_MAX_VLANS
+ *  x OES_MAX_PORTS bits, kept both ways: a row of port words per VLAN,
+ *  for the forwarding checks and for the ports of a VLAN, and a row of
+ *  VLAN words per port, for the VLANs of a port. Every change updates
+ *  both. Egress tagging is two more VLAN-major matrices, untagged and
+ *  priority tagged, a member in neither being tagged. The ingress
+ *  filter and the egress tagging decision are each one bit test.
+ ***********************************************/
+
+#define OES_VLAN_VID_MIN              1
+#define OES_VLAN_VID_MAX              4094
+#define OES_VLAN_PORT_WORDS           OES_BITMAP_WORDS(OES_MAX_PORTS)
+#define OES_VLAN_VID_WORDS            OES_BITMAP_WORDS(OES_MAX_VLANS)
+
+struct oes_vlan_members {
+    unsigned long long vlan_ports[OES_MAX_VLANS][OES_VLAN_PORT_WORDS];   /**< member ports per VLAN */
+    unsigned long long untagged[OES_MAX_VLANS][OES_VLAN_PORT_WORDS];     /**< untagged ports per VLAN */
+    unsigned long long prio_tagged[OES_MAX_VLANS][OES_VLAN_PORT_WORDS];  /**< priority tagged ports per VLAN */
+    unsigned long long port_vlans[OES_MAX_PORTS][OES_VLAN_VID_WORDS];    /**< member VLANs per port */
+};
+
+/**
+ * This function tells whether a port is a member of a VLAN, the
+ * ingress filter check.
+ *
+ * @param[in] members_p - membership
+ * @param[in] vid - VLAN ID
+ * @param[in] port - logical port
+ *
+ * @return non zero if the port is a member
+ */
+static inline int
+oes_vlan_is_member(const struct oes_vlan_members * members_p,
+                   unsigned int vid,
+                   unsigned int port)
+{
+    return OES_BITMAP_TEST(members_p->vlan_ports[vid], port);
+}
+
+/**
+ * This function tells whether a member port sends a VLAN untagged, the
+ * egress tagging check.
+ *
+ * @param[in] members_p - membership
+ * @param[in] vid - VLAN ID
+ * @param[in] port - logical port
+ *
+ * @return non zero if frames leave the port untagged
+ */
+static inline int
+oes_vlan_is_untagged(const struct oes_vlan_members * members_p,
+                     unsigned int vid,
+                     unsigned int port)
+{
+    return OES_BITMAP_TEST(members_p->untagged[vid], port);
+}
+
+/**
+ * This function returns the egress tagging of a member port.
+ *
+ * @param[in] members_p - membership
+ * @param[in] vid - VLAN ID
+ * @param[in] port - logical port, a member of vid
+ *
+ * @return the tagging
+ */
+static inline enum oes_vlan_tagging
+oes_vlan_tagging_get(const struct oes_vlan_members * members_p,
+                     unsigned int vid,
+                     unsigned int port)
+{
+    if (OES_BITMAP_TEST(members_p->untagged[vid], port)) {
+        return OES_VLAN_UNTAGGED_MEMBER;
+    }
+    if (OES_BITMAP_TEST(members_p->prio_tagged[vid], port)) {
+        return OES_VLAN_PRIO_TAGGED_MEMBER;
+    }
+    return OES_VLAN_TAGGED_MEMBER;
+}
+
+/**
+ * This function adds a port to a VLAN, or changes its tagging if it
+ * is a member already.
+ *
+ * @param[in] members_p - membership
+ * @param[in] vid - VLAN ID
+ * @param[in] port - logical port
+ * @param[in] tagging - egress tagging
+ */
+void
+oes_vlan_member_set(struct oes_vlan_members * members_p,
+                    unsigned int vid,
+                    unsigned int port,
+                    enum oes_vlan_tagging tagging);
+
+/**
+ * This function removes a port from a VLAN.
+ *
+ * @param[in] members_p - membership
+ * @param[in] vid - VLAN ID
+ * @param[in] port - logical port
+ */
+void
+oes_vlan_member_clear(struct oes_vlan_members * members_p,
+                      unsigned int vid,
+                      unsigned int port);
+
+/**
+ * This function removes every port from a VLAN.
+ *
+ * @param[in] members_p - membership
+ * @param[in] vid - VLAN ID
+ */
+void
+oes_vlan_members_clear_vid(struct oes_vlan_members * members_p,
+                           unsigned int vid);
+
+/**
+ * This function adds ports to a range of VLANs, or changes their
+ * tagging where they are members already. The VLAN-major rows take
+ * the port words whole and the port-major rows are filled a word at a
+ * time.
+ *
+ * @param[in] members_p - membership
+ * @param[in] vid_first - first VLAN ID of the range
+ * @param[in] vid_last - last VLAN ID of the range, vid_first or above
+ * @param[in] ports - bitmap of the logical ports
+ * @param[in] tagging - egress tagging of the ports
+ */
+void
+oes_vlan_members_range_set(struct oes_vlan_members * members_p,
+                           unsigned int vid_first,
+                           unsigned int vid_last,
+                           const unsigned long long * ports,
+                           enum oes_vlan_tagging tagging);
+
+/**
+ * This function removes ports from a range of VLANs.
+ *
+ * @param[in] members_p - membership
+ * @param[in] vid_first - first VLAN ID of the range
+ * @param[in] vid_last - last VLAN ID of the range, vid_first or above
+ * @param[in] ports - bitmap of the logical ports
+ */
+void
+oes_vlan_members_range_clear(struct oes_vlan_members * members_p,
+                             unsigned int vid_first,
+                             unsigned int vid_last,
+                             const unsigned long long * ports);
+
+/**
+ * This function sets bits first to last of a bitmap.
+ *
+ * @param[in] bitmap - the bitmap
+ * @param[in] first - first bit
+ * @param[in] last - last bit, first or above
+ */
+void
+oes_vlan_bitmap_range_set(unsigned long long * bitmap,
+                          unsigned int first,
+                          unsigned int last);
+
+/**
+ * This function clears bits first to last of a bitmap.
+ *
+ * @param[in] bitmap - the bitmap
+ * @param[in] first - first bit
+ * @param[in] last - last bit, first or above
+ */
+void
+oes_vlan_bitmap_range_clear(unsigned long long * bitmap,
+                            unsigned int first,
+                            unsigned int last);
+
+/**
+ * This function counts the member ports of a VLAN.
+ *
+ * @param[in] members_p - membership
+ * @param[in] vid - VLAN ID
+ *
+ * @return number of member ports
+ */
+unsigned int
+oes_vlan_members_count(const struct oes_vlan_members * members_p,
+                       unsigned int vid);
+
+#endif /* __OES_VLAN_MEMBER_H__ */
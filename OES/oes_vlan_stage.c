@@ -0,0 +1,203 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <string.h>
+#include "oes_status.h"
+#include "oes_types.h"
+#include "oes_vlan_cntr.h"
+#include "oes_vlan_member.h"
+#include "oes_vlan_stage.h"
+
+#define OES_VLAN_CLASS_UNTAGGED       0
+#define OES_VLAN_CLASS_PRIO_TAGGED    1
+#define OES_VLAN_CLASS_TAGGED         2
+
+/* accepted frame type bit of each frame class */
+static const unsigned char oes_vlan_class_frame_type[] = {
+    OES_VLAN_FRAME_TYPES_ALLOW_UNTAGGED,
+    OES_VLAN_FRAME_TYPES_ALLOW_PRIO_TAGGED,
+    OES_VLAN_FRAME_TYPES_ALLOW_TAGGED,
+};
+
+void
+oes_vlan_port_stage_init(struct oes_vlan_port_stage *port_p,
+                         unsigned short default_vid)
+{
+    memset(port_p, 0, sizeof(*port_p));
+    port_p->pvid = default_vid;
+    port_p->frame_types = OES_VLAN_FRAME_TYPES_ALLOW_ALL;
+}
+
+/* Removes the tag after the MAC addresses. */
+static inline void
+oes_vlan_tag_pop(struct oes_vlan_pkt *pkt_p)
+{
+    unsigned long long dmac_smac;
+    unsigned int       smac_tail;
+
+    memcpy(&dmac_smac, pkt_p->data, sizeof(dmac_smac));
+    memcpy(&smac_tail, pkt_p->data + sizeof(dmac_smac), sizeof(smac_tail));
+    pkt_p->data += OES_VLAN_TAG_LEN;
+    memcpy(pkt_p->data, &dmac_smac, sizeof(dmac_smac));
+    memcpy(pkt_p->data + sizeof(dmac_smac), &smac_tail, sizeof(smac_tail));
+    pkt_p->len -= OES_VLAN_TAG_LEN;
+    pkt_p->headroom += OES_VLAN_TAG_LEN;
+}
+
+/* Inserts a tag after the MAC addresses. */
+static inline void
+oes_vlan_tag_push(struct oes_vlan_pkt *pkt_p, unsigned int tci)
+{
+    unsigned long long dmac_smac;
+    unsigned int       smac_tail, tag = htonl(((unsigned int)OES_VLAN_TPID << 16) | tci);
+
+    memcpy(&dmac_smac, pkt_p->data, sizeof(dmac_smac));
+    memcpy(&smac_tail, pkt_p->data + sizeof(dmac_smac), sizeof(smac_tail));
+    pkt_p->data -= OES_VLAN_TAG_LEN;
+    memcpy(pkt_p->data, &dmac_smac, sizeof(dmac_smac));
+    memcpy(pkt_p->data + sizeof(dmac_smac), &smac_tail, sizeof(smac_tail));
+    memcpy(pkt_p->data + OES_VLAN_MAC_LEN, &tag, sizeof(tag));
+    pkt_p->len += OES_VLAN_TAG_LEN;
+    pkt_p->headroom -= OES_VLAN_TAG_LEN;
+}
+
+static void
+oes_vlan_ingress_burst(unsigned int                      br_id,
+                       const struct oes_vlan_port_stage *ports_p,
+                       const struct oes_vlan_members    *members_p,
+                       struct oes_vlan_pkt              *pkt_list_p,
+                       unsigned int                      cnt)
+{
+    const struct oes_vlan_port_stage *port_p;
+    struct oes_vlan_cntr_block      **cntr_chunks_p = oes_vlan_cntr_chunks(br_id);
+    struct oes_vlan_pkt              *pkt_p;
+    unsigned int                      words[OES_VLAN_STAGE_BURST];
+    unsigned int                      i, word, tagged, tci, class, pop, vid, pcp, drop;
+
+    /* parse: TPID and TCI of each frame, or 0 for a frame too short to carry them */
+    for (i = 0; i < cnt; i++) {
+        word = 0;
+        if (pkt_list_p[i].len >= OES_VLAN_MAC_LEN + OES_VLAN_TAG_LEN) {
+            memcpy(&word, pkt_list_p[i].data + OES_VLAN_MAC_LEN, sizeof(word));
+        }
+        words[i] = ntohl(word);
+    }
+
+    for (i = 0; i < cnt; i++) {
+        pkt_p = &pkt_list_p[i];
+        port_p = &ports_p[pkt_p->log_port];
+        tagged = ((words[i] >> 16) == OES_VLAN_TPID) & (pkt_p->len >= ETHER_HDR_LEN + OES_VLAN_TAG_LEN);
+        tci = tagged ? (words[i] & 0xffff) : 0;
+        class = tagged ? (((tci & 0xfff) != 0) + OES_VLAN_CLASS_PRIO_TAGGED) : OES_VLAN_CLASS_UNTAGGED;
+
+        /* a Q-in-Q port keeps the tag and sends everything to its PVID */
+        pop = tagged & !port_p->qinq;
+        vid = (class == OES_VLAN_CLASS_TAGGED) && !port_p->qinq ? (tci & 0xfff) : port_p->pvid;
+        pcp = tci >> 13;
+        if (port_p->qinq && (port_p->outer_prio == OES_QINQ_OUTER_PRIO_MODE_DEFAULT)) {
+            pcp = 0;
+        }
+
+        drop = OES_VLAN_DROP_NONE;
+        if (pkt_p->len < ETHER_HDR_LEN) {
+            drop = OES_VLAN_DROP_MALFORMED;
+        } else if (!(port_p->frame_types & oes_vlan_class_frame_type[class])) {
+            drop = OES_VLAN_DROP_FRAME_TYPE;
+        } else if (port_p->ingr_filter && !oes_vlan_is_member(members_p, vid, pkt_p->log_port)) {
+            drop = OES_VLAN_DROP_INGRESS_FILTER;
+        }
+        pkt_p->vid = vid;
+        pkt_p->pcp = pcp;
+        pkt_p->drop = drop;
+        if (drop != OES_VLAN_DROP_NONE) {
+            continue;
+        }
+        oes_vlan_cntr_add(&cntr_chunks_p, br_id, vid, OES_VLAN_CNTR_RX, 1, pkt_p->len);
+        if (pop) {
+            oes_vlan_tag_pop(pkt_p);
+        }
+    }
+}
+
+void
+oes_vlan_ingress_bulk(unsigned int br_id,
+                      const struct oes_vlan_port_stage *ports_p,
+                      const struct oes_vlan_members *members_p,
+                      struct oes_vlan_pkt *pkt_list_p,
+                      unsigned int cnt)
+{
+    unsigned int i, n;
+
+    for (i = 0; i < cnt; i += n) {
+        n = (cnt - i < OES_VLAN_STAGE_BURST) ? cnt - i : OES_VLAN_STAGE_BURST;
+        oes_vlan_ingress_burst(br_id, ports_p, members_p, &pkt_list_p[i], n);
+    }
+}
+
+void
+oes_vlan_egress_bulk(unsigned int br_id,
+                     const struct oes_vlan_members *members_p,
+                     struct oes_vlan_pkt *pkt_list_p,
+                     unsigned int cnt)
+{
+    struct oes_vlan_cntr_block **cntr_chunks_p = oes_vlan_cntr_chunks(br_id);
+    struct oes_vlan_pkt         *pkt_p;
+    unsigned int                 i, port, vid, push;
+
+    for (i = 0; i < cnt; i++) {
+        pkt_p = &pkt_list_p[i];
+        port = pkt_p->log_port;
+        vid = pkt_p->vid;
+        push = !oes_vlan_is_untagged(members_p, vid, port);
+
+        /* the one branch, taken by all but frames dropped */
+        if (oes_vlan_is_member(members_p, vid, port) &
+            ((pkt_p->headroom >= OES_VLAN_TAG_LEN) | !push) &
+            (pkt_p->len >= ETHER_HDR_LEN)) {
+            pkt_p->drop = OES_VLAN_DROP_NONE;
+            if (push) {
+                /* a priority tagged member gets VID 0 */
+                oes_vlan_tag_push(pkt_p, (pkt_p->pcp << 13) |
+                                  (OES_BITMAP_TEST(members_p->prio_tagged[vid], port) ? 0 : vid));
+            }
+            oes_vlan_cntr_add(&cntr_chunks_p, br_id, vid, OES_VLAN_CNTR_TX, 1, pkt_p->len);
+            continue;
+        }
+        if (pkt_p->len < ETHER_HDR_LEN) {
+            pkt_p->drop = OES_VLAN_DROP_MALFORMED;
+        } else if (!oes_vlan_is_member(members_p, vid, port)) {
+            pkt_p->drop = OES_VLAN_DROP_EGRESS_FILTER;
+        } else {
+            pkt_p->drop = OES_VLAN_DROP_NO_HEADROOM;
+        }
+    }
+}
@@ -0,0 +1,107 @@
+/* This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING, or the Open Ethernet BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __OES_VLAN_STAGE_H__
+#define __OES_VLAN_STAGE_H__
+
+/************************************************
+ *  VLAN ingress and egress stage
+ *
+ *  Frames are carried between the two stages untagged, their VLAN and
+ *  priority in the packet. Ingress classifies a frame by its first tag
+ *  and the settings of its port, and pops that tag unless the port is
+ *  a Q-in-Q port, whose frames keep their tags and all go to the PVID.
+ *  Egress pushes a tag unless the port is an untagged member. A tag
+ *  moves the 12 bytes of MAC addresses by 4 in place, the payload is
+ *  never copied.
+ *
+ *  A burst is parsed first, the TPID and TCI of each frame loaded as
+ *  one word into per-burst arrays, then the decisions are taken with
+ *  masks and table loads rather than branches on the frame contents.
+ *
+ *  Frames that pass a stage are counted to their VLAN, rx with the
+ *  length received and tx with the length sent.
+ ***********************************************/
+
+#define OES_VLAN_TPID                 0x8100
+#define OES_VLAN_TAG_LEN              4
+#define OES_VLAN_MAC_LEN              12            /**< destination and source MAC */
+#define OES_VLAN_STAGE_BURST          32            /**< frames parsed per pass */
+
+struct oes_vlan_port_stage {
+    unsigned short pvid;             /**< in effect: pvid_cfg, or the bridge default VID */
+    unsigned short pvid_cfg;         /**< set by oes_api_vlan_port_pvid_set, 0 for none */
+    unsigned char  frame_types;      /**< enum oes_vlan_frame_types bits */
+    unsigned char  ingr_filter;      /**< enum oes_ingr_filter_mode */
+    unsigned char  qinq;             /**< enum oes_qinq_mode */
+    unsigned char  outer_prio;       /**< enum oes_qinq_outer_prio_mode */
+};
+
+/**
+ * This function sets a port to its defaults: PVID default_vid, all
+ * frame types accepted, no ingress filter and no Q-in-Q.
+ *
+ * @param[out] port_p - port settings
+ * @param[in] default_vid - bridge default VID
+ */
+void
+oes_vlan_port_stage_init(struct oes_vlan_port_stage * port_p,
+                         unsigned short default_vid);
+
+/**
+ * This function runs the ingress stage on a burst of frames.
+ *
+ * @param[in] br_id - bridge, below OES_VLAN_CNTR_MAX_BRIDGES
+ * @param[in] ports_p - settings of the OES_MAX_PORTS ports
+ * @param[in] members_p - VLAN membership, for the ingress filter
+ * @param[in,out] pkt_list_p - frames, with ingress ports below OES_MAX_PORTS
+ * @param[in] cnt - number of frames
+ */
+void
+oes_vlan_ingress_bulk(unsigned int br_id,
+                      const struct oes_vlan_port_stage * ports_p,
+                      const struct oes_vlan_members * members_p,
+                      struct oes_vlan_pkt * pkt_list_p,
+                      unsigned int cnt);
+
+/**
+ * This function runs the egress stage on a burst of frames.
+ *
+ * @param[in] br_id - bridge, below OES_VLAN_CNTR_MAX_BRIDGES
+ * @param[in] members_p - VLAN membership and tagging
+ * @param[in,out] pkt_list_p - frames, with egress ports below OES_MAX_PORTS
+ *       and VLANs below OES_MAX_VLANS
+ * @param[in] cnt - number of frames
+ */
+void
+oes_vlan_egress_bulk(unsigned int br_id,
+                     const struct oes_vlan_members * members_p,
+                     struct oes_vlan_pkt * pkt_list_p,
+                     unsigned int cnt);
+
+#endif /* __OES_VLAN_STAGE_H__ */